@@ -0,0 +1,308 @@
+#include "bench_common.h"
+#include "algorithms/advanced_algorithms.h"
+
+using namespace dds;
+using namespace dds::testing;
+using dds::algorithms::NeuralLayer;
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite("activations");
+
+    using Activation = Matrix (*)(const Matrix&);
+    const std::vector<std::pair<std::string, Activation>> activations = {
+        {"relu", [](const Matrix& x) { return NeuralLayer::relu(x); }},
+        {"sigmoid", [](const Matrix& x) { return NeuralLayer::sigmoid(x); }},
+        {"tanh", [](const Matrix& x) { return NeuralLayer::tanh(x); }},
+        {"softmax", [](const Matrix& x) { return NeuralLayer::softmax(x); }},
+        {"gelu", [](const Matrix& x) { return NeuralLayer::gelu(x); }},
+        {"swish", [](const Matrix& x) { return NeuralLayer::swish(x); }},
+        {"relu_derivative", [](const Matrix& x) { return NeuralLayer::relu_derivative(x); }},
+        {"sigmoid_derivative", [](const Matrix& x) { return NeuralLayer::sigmoid_derivative(x); }},
+        {"tanh_derivative", [](const Matrix& x) { return NeuralLayer::tanh_derivative(x); }},
+    };
+
+    // Inputs are built in fixtures, primed before timing, so only the kernels are
+    // measured; layers stay in the timed body because training mutates them
+    bench::Fixture<Matrix> activation_input([] { return bench::random_matrix(256, 256); });
+    for (const auto& activation : activations) {
+        auto fn = activation.second;
+        suite.add_benchmark(activation.first + "/256x256", [fn, activation_input](BenchmarkState& state) {
+            const Matrix& X = activation_input.get();
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                Matrix Y = fn(X);
+                do_not_optimize(Y.data()[0]);
+            }
+            state.set_items_per_iteration(256.0 * 256);
+        });
+    }
+
+    // Loss plus logit gradient for 1000 classes, from labels and from one-hot rows
+    bench::Fixture<Matrix> logit_input([] { return bench::random_matrix(256, 1000); });
+    for (bool sparse : {true, false}) {
+        const std::string name = std::string("softmax_cross_entropy_") + (sparse ? "labels" : "onehot") + "/256x1000";
+        suite.add_benchmark(name, [sparse, logit_input](BenchmarkState& state) {
+            algorithms::SoftmaxCrossEntropyLayer output(1000);
+            const Matrix& logits = logit_input.get();
+            std::vector<int> labels(256);
+            Matrix targets(256, 1000);
+            targets.setZero();
+            for (int r = 0; r < 256; ++r) {
+                labels[r] = (r * 37) % 1000;
+                targets(r, labels[r]) = Scalar(1);
+            }
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                double loss = sparse ? output.loss(logits, labels) : output.loss(logits, targets);
+                do_not_optimize(loss);
+            }
+            state.set_items_per_iteration(256.0 * 1000);
+        });
+    }
+
+    bench::Fixture<Matrix> dense_input([] { return bench::random_matrix(256, 128); });
+    suite.add_benchmark("dense_forward/256x128->64", [dense_input](BenchmarkState& state) {
+        algorithms::DenseLayer layer(128, 64, algorithms::ActivationType::RELU);
+        const Matrix& X = dense_input.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix Y = layer.forward(X);
+            do_not_optimize(Y.data()[0]);
+        }
+        state.set_items_per_iteration(2.0 * 256 * 128 * 64);
+    });
+
+    // Forward (NT) plus backward (TN weight gradient, NN input gradient)
+    bench::Fixture<Matrix> dense_gradient([] { return bench::random_matrix(256, 64, bench::kBenchSeed + 1); });
+    suite.add_benchmark("dense_train_step/256x128->64", [dense_input, dense_gradient](BenchmarkState& state) {
+        algorithms::DenseLayer layer(128, 64, algorithms::ActivationType::RELU);
+        const Matrix& X = dense_input.get();
+        const Matrix& G = dense_gradient.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix Y = layer.forward(X);
+            Matrix dX = layer.backward(G);
+            do_not_optimize(dX.data()[0]);
+        }
+        state.set_items_per_iteration(3 * 2.0 * 256 * 128 * 64);
+    });
+
+    // Same step with a 0.5 dropout fused into the dense output (mask draw and apply)
+    bench::Fixture<Matrix> wide_gradient([] { return bench::random_matrix(256, 1024, bench::kBenchSeed + 1); });
+    suite.add_benchmark("dense_dropout_train_step/256x128->1024", [dense_input, wide_gradient](BenchmarkState& state) {
+        algorithms::DenseLayer layer(128, 1024, algorithms::ActivationType::RELU);
+        algorithms::DropoutLayer dropout(0.5);
+        layer.fuse_dropout(&dropout);
+        dropout.set_fused(true);
+        const Matrix& X = dense_input.get();
+        const Matrix& G = wide_gradient.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix Y = dropout.forward(layer.forward(X));
+            Matrix dX = layer.backward(dropout.backward(G));
+            do_not_optimize(dX.data()[0]);
+        }
+        state.set_items_per_iteration(3 * 2.0 * 256 * 128 * 1024);
+    });
+
+    bench::Fixture<Matrix> wide_input([] { return bench::random_matrix(256, 1024); });
+    suite.add_benchmark("batchnorm_train_step/256x1024", [wide_input, wide_gradient](BenchmarkState& state) {
+        algorithms::BatchNormLayer layer(1024);
+        const Matrix& X = wide_input.get();
+        const Matrix& G = wide_gradient.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix Y = layer.forward(X);
+            Matrix dX = layer.backward(G);
+            do_not_optimize(dX.data()[0]);
+        }
+        state.set_items_per_iteration(256.0 * 1024);
+    });
+
+    // Inference through LINEAR dense + BatchNorm(RELU), as trained and after folding
+    for (bool folded : {false, true}) {
+        const std::string name = std::string("dense_batchnorm_predict_") + (folded ? "folded" : "unfolded") +
+                                 "/256x128->1024";
+        suite.add_benchmark(name, [folded, dense_input](BenchmarkState& state) {
+            algorithms::NeuralNetwork network;
+            auto dense = std::make_unique<algorithms::DenseLayer>(128, 1024, algorithms::ActivationType::LINEAR);
+            dense->initialize_weights();
+            network.add_layer(std::move(dense));
+            network.add_batch_norm_layer(algorithms::ActivationType::RELU);
+            if (folded) network.fold_batch_norm();
+            const Matrix& X = dense_input.get();
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                Matrix Y = network.predict(X);
+                do_not_optimize(Y.data()[0]);
+            }
+            state.set_items_per_iteration(2.0 * 256 * 128 * 1024);
+        });
+    }
+
+    // Inference on a 128->512->256->10 classifier in floating point and after int8
+    // post-training quantization (calibrated on the benchmark input itself)
+    Matrix predict_inputs = bench::random_matrix(256, 128);
+    algorithms::NeuralNetwork float_network, int8_network;
+    for (algorithms::NeuralNetwork* network : {&float_network, &int8_network}) {
+        utils::set_global_seed(bench::kBenchSeed);
+        const int sizes[] = {128, 512, 256, 10};
+        for (int l = 0; l < 3; ++l) {
+            auto dense = std::make_unique<algorithms::DenseLayer>(
+                sizes[l], sizes[l + 1], l < 2 ? algorithms::ActivationType::RELU : algorithms::ActivationType::LINEAR);
+            dense->initialize_weights(1.0);
+            network->add_layer(std::move(dense));
+        }
+    }
+    int8_network.quantize(predict_inputs);
+    for (algorithms::NeuralNetwork* network : {&float_network, &int8_network}) {
+        const std::string name = std::string("network_predict_") + (network == &int8_network ? "int8" : "float") +
+                                 "/256x128->512->256->10";
+        suite.add_benchmark(name, [network, &predict_inputs](BenchmarkState& state) {
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                Matrix Y = network->predict(predict_inputs);
+                do_not_optimize(Y.data()[0]);
+            }
+            state.set_items_per_iteration(2.0 * 256 * (128 * 512 + 512 * 256 + 256 * 10));
+        });
+    }
+
+    // Full training step (forward, fused loss, backward, Adam) on a small classifier,
+    // with a fresh matrix per layer output versus the planned workspace arena
+    for (bool workspace : {false, true}) {
+        const std::string name = std::string("network_train_step_") + (workspace ? "workspace" : "matrix") +
+                                 "/256x128->512->256->10";
+        suite.add_benchmark(name, [workspace, dense_input](BenchmarkState& state) {
+            algorithms::NeuralNetwork network(1e-3, 256);
+            auto dense = std::make_unique<algorithms::DenseLayer>(128, 512, algorithms::ActivationType::LINEAR);
+            dense->initialize_weights();
+            network.add_layer(std::move(dense));
+            network.add_batch_norm_layer(algorithms::ActivationType::RELU);
+            network.add_dense_layer(256, algorithms::ActivationType::RELU);
+            network.add_dense_layer(10, algorithms::ActivationType::LINEAR);
+            network.add_softmax_cross_entropy_layer();
+            network.set_optimizer("adam");
+            network.set_use_workspace(workspace);
+            const Matrix& X = dense_input.get();
+            Matrix y(256, 1);
+            for (int r = 0; r < 256; ++r) y(r, 0) = static_cast<Scalar>(r % 10);
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                double loss = network.train_batch(X, y);
+                do_not_optimize(loss);
+            }
+            state.set_items_per_iteration(3 * 2.0 * 256 * (128 * 512 + 512 * 256 + 256 * 10));
+        });
+    }
+
+    // One update over 1M parameters split like a small MLP (three weight tensors, one bias)
+    // Values are updated in place across calls, so the fixtures hand out mutable matrices
+    bench::Fixture<std::shared_ptr<Matrix>> optimizer_values([] {
+        return std::make_shared<Matrix>(bench::random_matrix(1024, 1024));
+    });
+    bench::Fixture<std::shared_ptr<Matrix>> optimizer_gradients([] {
+        return std::make_shared<Matrix>(bench::random_matrix(1024, 1024, bench::kBenchSeed + 1));
+    });
+    for (const char* name : {"sgd", "momentum", "rmsprop", "adam", "adamw"}) {
+        suite.add_benchmark(std::string("optimizer_step_") + name + "/1M",
+                            [name, optimizer_values, optimizer_gradients](BenchmarkState& state) {
+            algorithms::OptimizerType type;
+            algorithms::Optimizer::parse_type(name, type);
+            algorithms::Optimizer optimizer(type, 1e-3);
+            optimizer.set_weight_decay(1e-4);
+            Matrix& values = *optimizer_values.get();
+            Matrix& gradients = *optimizer_gradients.get();
+            const size_t sizes[] = {512 * 1024, 384 * 1024, 127 * 1024, 1024};
+            std::vector<algorithms::ParameterView> parameters;
+            size_t offset = 0;
+            for (size_t size : sizes) {
+                parameters.push_back({values.data() + offset, gradients.data() + offset, size, size > 1024});
+                offset += size;
+            }
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                optimizer.step(parameters);
+                do_not_optimize(values.data()[0]);
+            }
+            state.set_items_per_iteration(1024.0 * 1024);
+        });
+    }
+
+    // Rates count direct-convolution flops, so Winograd shows up as a higher rate
+    bench::Fixture<Matrix> image_input([] { return bench::random_matrix(8, 32 * 32 * 32); });
+    for (bool winograd : {false, true}) {
+        const std::string name = std::string("conv2d_forward_") + (winograd ? "winograd" : "im2col") +
+                                 "/8x32x32x32->32";
+        suite.add_benchmark(name, [winograd, image_input](BenchmarkState& state) {
+            algorithms::ConvLayer layer(32, 32, 32, 32, 3, 3, 1, 1);
+            layer.initialize_weights();
+            layer.set_winograd(winograd);
+            const Matrix& X = image_input.get();
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                Matrix Y = layer.forward(X);
+                do_not_optimize(Y.data()[0]);
+            }
+            state.set_items_per_iteration(2.0 * 8 * 32 * 32 * 32 * 9 * 32);
+        });
+    }
+
+    bench::Fixture<Matrix> image_gradient([] { return bench::random_matrix(8, 32 * 32 * 32, bench::kBenchSeed + 1); });
+    suite.add_benchmark("conv2d_train_step/8x32x32x32->32", [image_input, image_gradient](BenchmarkState& state) {
+        algorithms::ConvLayer layer(32, 32, 32, 32, 3, 3, 1, 1);
+        layer.initialize_weights();
+        const Matrix& X = image_input.get();
+        const Matrix& G = image_gradient.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix Y = layer.forward(X);
+            Matrix dX = layer.backward(G);
+            do_not_optimize(dX.data()[0]);
+        }
+        state.set_items_per_iteration(3 * 2.0 * 8 * 32 * 32 * 32 * 9 * 32);
+    });
+
+    // Sensor-style series: 32 sequences of 1024 steps, 16 channels, kernel 5
+    bench::Fixture<Matrix> series_input([] { return bench::random_matrix(32, 1024 * 16); });
+    suite.add_benchmark("conv1d_forward/32x1024x16->32/k5", [series_input](BenchmarkState& state) {
+        auto layer = algorithms::ConvLayer::conv1d(16, 32, 1024, 5, 1, 2);
+        layer->initialize_weights();
+        const Matrix& X = series_input.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix Y = layer->forward(X);
+            do_not_optimize(Y.data()[0]);
+        }
+        state.set_items_per_iteration(2.0 * 32 * 1024 * 16 * 5 * 32);
+    });
+
+    // 32 event sequences of 50 steps, 32 features, 128 hidden units; items are timesteps
+    bench::Fixture<Matrix> sequence_input([] { return bench::random_matrix(32, 50 * 32); });
+    bench::Fixture<Matrix> sequence_gradient([] { return bench::random_matrix(32, 50 * 128, bench::kBenchSeed + 1); });
+    suite.add_benchmark("lstm_forward/32x50x32->128", [sequence_input](BenchmarkState& state) {
+        algorithms::LSTMLayer layer(32, 128, 50);
+        layer.initialize_weights(1.0);
+        const Matrix& X = sequence_input.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix Y = layer.forward(X);
+            do_not_optimize(Y.data()[0]);
+        }
+        state.set_items_per_iteration(32.0 * 50);
+    });
+
+    suite.add_benchmark("lstm_train_step/32x50x32->128", [sequence_input, sequence_gradient](BenchmarkState& state) {
+        algorithms::LSTMLayer layer(32, 128, 50);
+        layer.initialize_weights(1.0);
+        const Matrix& X = sequence_input.get();
+        const Matrix& G = sequence_gradient.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix Y = layer.forward(X);
+            Matrix dX = layer.backward(G);
+            do_not_optimize(dX.data()[0]);
+        }
+        state.set_items_per_iteration(32.0 * 50);
+    });
+
+    suite.add_benchmark("gru_train_step/32x50x32->128", [sequence_input, sequence_gradient](BenchmarkState& state) {
+        algorithms::GRULayer layer(32, 128, 50);
+        layer.initialize_weights(1.0);
+        const Matrix& X = sequence_input.get();
+        const Matrix& G = sequence_gradient.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix Y = layer.forward(X);
+            Matrix dX = layer.backward(G);
+            do_not_optimize(dX.data()[0]);
+        }
+        state.set_items_per_iteration(32.0 * 50);
+    });
+
+    return bench::run_benchmarks(suite, argc, argv);
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+// Shared helpers for the dds_bench_* targets: fixed seeds, synthetic data and a
+// standard main() wrapper around testing::BenchmarkSuite.
+
+#include "testing/benchmark.h"
+#include "utils/types.h"
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <cmath>
+#include <functional>
+#include <memory>
+
+namespace dds {
+namespace bench {
+
+// Every generator is seeded from this so runs are comparable across builds
+constexpr uint64_t kBenchSeed = 20240601;
+
+inline Matrix random_matrix(Index rows, Index cols, uint64_t seed = kBenchSeed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix m(rows, cols);
+    for (Index i = 0; i < m.size(); ++i) m.data()[i] = dist(rng);
+    return m;
+}
+
+// Linear target with Gaussian noise
+inline void make_regression(Index samples, Index features, Matrix& X, Vector& y,
+                            uint64_t seed = kBenchSeed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    X = Matrix(samples, features);
+    y = Vector(samples);
+    std::vector<double> coef(features);
+    for (auto& c : coef) c = normal(rng);
+    for (Index i = 0; i < samples; ++i) {
+        double target = 0.0;
+        for (Index j = 0; j < features; ++j) {
+            X(i, j) = normal(rng);
+            target += coef[j] * X(i, j);
+        }
+        y[i] = target + 0.1 * normal(rng);
+    }
+}
+
+// Binary labels from a noisy linear boundary
+inline void make_classification(Index samples, Index features, Matrix& X, Vector& y,
+                                uint64_t seed = kBenchSeed) {
+    make_regression(samples, features, X, y, seed);
+    for (Index i = 0; i < samples; ++i) y[i] = y[i] > 0.0 ? 1.0 : 0.0;
+}
+
+// Isotropic Gaussian clusters around uniformly placed centers
+inline Matrix make_blobs(Index samples, Index features, int centers, uint64_t seed = kBenchSeed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> center_dist(-10.0, 10.0);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Matrix C(centers, features);
+    for (Index i = 0; i < C.size(); ++i) C.data()[i] = center_dist(rng);
+    Matrix X(samples, features);
+    for (Index i = 0; i < samples; ++i) {
+        Index c = i % centers;
+        for (Index j = 0; j < features; ++j) X(i, j) = C(c, j) + normal(rng);
+    }
+    return X;
+}
+
+// Uniformly scattered nonzeros at the given density (duplicates merged)
+template<typename SparseType = SparseMatrixCSR>
+inline SparseType random_sparse(Index rows, Index cols, double density, uint64_t seed = kBenchSeed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<Index> col_dist(0, cols - 1);
+    std::uniform_real_distribution<double> value_dist(-1.0, 1.0);
+    Index per_row = std::max<Index>(1, static_cast<Index>(std::llround(density * cols)));
+    std::vector<Triplet> triplets;
+    triplets.reserve(static_cast<size_t>(rows * per_row));
+    for (Index i = 0; i < rows; ++i) {
+        for (Index k = 0; k < per_row; ++k) triplets.emplace_back(i, col_dist(rng), value_dist(rng));
+    }
+    SparseType m(rows, cols);
+    m.setFromTriplets(triplets.begin(), triplets.end());
+    return m;
+}
+
+// Expensive input built once, on first use, and shared by every timed call.
+// Copies share the same instance, so it can be captured by value in a benchmark.
+template<typename T>
+class Fixture {
+private:
+    struct State {
+        std::function<T()> make;
+        std::unique_ptr<T> value;
+    };
+    std::shared_ptr<State> state_;
+
+public:
+    explicit Fixture(std::function<T()> make) : state_(std::make_shared<State>()) {
+        state_->make = std::move(make);
+    }
+
+    const T& get() const {
+        if (!state_->value) state_->value = std::make_unique<T>(state_->make());
+        return *state_->value;
+    }
+};
+
+// Swallows std::cout while alive; library code under test logs chattily. The sink
+// keeps no state, so concurrent trials may log through it.
+class ScopedSilence {
+private:
+    struct Discard : std::streambuf {
+        int overflow(int c) override { return traits_type::not_eof(c); }
+    };
+    Discard sink_;
+    std::streambuf* saved_;
+
+public:
+    ScopedSilence() : saved_(std::cout.rdbuf(&sink_)) {}
+    ~ScopedSilence() { std::cout.rdbuf(saved_); }
+};
+
+inline int run_benchmarks(testing::BenchmarkSuite& suite, int argc, char** argv) {
+    if (!suite.parse_args(argc, argv)) return 2;
+    return suite.run_all_benchmarks() ? 0 : 1;
+}
+
+} // namespace bench
+} // namespace dds
@@ -0,0 +1,86 @@
+#include "bench_common.h"
+#include "web/web_server.h"
+
+using namespace dds;
+using namespace dds::testing;
+using namespace dds::web;
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite("http");
+
+    WebServer server(0, "127.0.0.1");
+    {
+        bench::ScopedSilence quiet;
+        for (int r = 0; r < 200; ++r) {
+            server.add_get_route("/api/v1/resource" + std::to_string(r) + "/:id",
+                                 [](const HttpRequest&) { return HttpResponse(); });
+        }
+    }
+
+    const std::string raw_request =
+        "POST /api/v1/resource42/17?format=json&limit=100 HTTP/1.1\r\n"
+        "Host: localhost:8080\r\n"
+        "User-Agent: dds-bench/1.0\r\n"
+        "Accept: application/json;q=0.9, text/html;q=0.5\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: 27\r\n"
+        "\r\n"
+        "{\"algorithm\": \"kmeans\", \"k\": 8}";
+
+    suite.add_benchmark("parse_request", [&](BenchmarkState& state) {
+        bench::ScopedSilence quiet;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            HttpRequest req = server.parse_request(raw_request);
+            do_not_optimize(req.path);
+        }
+        state.set_bytes_per_iteration(static_cast<double>(raw_request.size()));
+    });
+
+    suite.add_benchmark("format_response", [&](BenchmarkState& state) {
+        HttpResponse res;
+        res.body = std::string(1024, 'x');
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            std::string wire = server.format_response(res);
+            do_not_optimize(wire);
+        }
+    });
+
+    suite.add_benchmark("find_route/200_routes", [&](BenchmarkState& state) {
+        bench::ScopedSilence quiet;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            auto handler = server.find_route("GET", "/api/v1/resource" + std::to_string(i % 200) + "/17");
+            do_not_optimize(handler);
+        }
+    });
+
+    suite.add_benchmark("response_cache/put_get", [&](BenchmarkState& state) {
+        bench::ScopedSilence quiet;
+        HttpRequest req = server.parse_request(raw_request);
+        HttpResponse res;
+        res.body = "{\"ok\": true}";
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            req.query_params["limit"] = std::to_string(i % 512);
+            std::string key = server.generate_cache_key(req);
+            server.cache_response(key, res);
+            do_not_optimize(key);
+        }
+    });
+
+    suite.add_benchmark("injection_scan", [&](BenchmarkState& state) {
+        const std::string input = "name=alice&comment=hello world, nothing to see here&page=3";
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            bool hit = server.is_sql_injection_attempt(input) || server.is_xss_attempt(input);
+            do_not_optimize(hit);
+        }
+        state.set_bytes_per_iteration(static_cast<double>(input.size()));
+    });
+
+    suite.add_benchmark("ip_heavy_hitters", [&](BenchmarkState& state) {
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            server.record_ip_address("10.0." + std::to_string((i >> 8) & 255) + "." + std::to_string(i & 255));
+        }
+    });
+
+    return bench::run_benchmarks(suite, argc, argv);
+}
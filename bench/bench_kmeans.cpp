@@ -0,0 +1,96 @@
+#include "bench_common.h"
+#include "../include/algorithms/minibatch_kmeans.h"
+#include <limits>
+
+using namespace dds;
+using namespace dds::testing;
+
+namespace {
+
+constexpr Index kBatchRows = 1024;
+
+// One Lloyd iteration: assign each row to its nearest centroid, then recompute
+// centroids. This is the kernel every k-means variant in the tree spends its time in.
+double lloyd_step(const Matrix& X, Matrix& centroids, std::vector<int>& labels) {
+    const Index n = X.rows();
+    const Index d = X.cols();
+    const Index k = centroids.rows();
+    double inertia = 0.0;
+
+    for (Index i = 0; i < n; ++i) {
+        double best = std::numeric_limits<double>::max();
+        int best_c = 0;
+        for (Index c = 0; c < k; ++c) {
+            double dist = 0.0;
+            for (Index j = 0; j < d; ++j) {
+                double diff = X(i, j) - centroids(c, j);
+                dist += diff * diff;
+            }
+            if (dist < best) {
+                best = dist;
+                best_c = static_cast<int>(c);
+            }
+        }
+        labels[i] = best_c;
+        inertia += best;
+    }
+
+    Matrix sums = Matrix::Zero(k, d);
+    std::vector<Index> counts(k, 0);
+    for (Index i = 0; i < n; ++i) {
+        for (Index j = 0; j < d; ++j) sums(labels[i], j) += X(i, j);
+        ++counts[labels[i]];
+    }
+    for (Index c = 0; c < k; ++c) {
+        if (counts[c] == 0) continue;
+        for (Index j = 0; j < d; ++j) centroids(c, j) = sums(c, j) / counts[c];
+    }
+    return inertia;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite("kmeans");
+
+    // Data is built in fixtures, primed before timing; centroids and models start
+    // fresh in each timed call
+    for (int k : {8, 32}) {
+        bench::Fixture<Matrix> blobs([k] { return bench::make_blobs(20000, 16, k); });
+        suite.add_benchmark("lloyd_step/20000x16/k" + std::to_string(k), [k, blobs](BenchmarkState& state) {
+            const Matrix& X = blobs.get();
+            Matrix centroids = X.block(0, 0, k, 16);
+            std::vector<int> labels(X.rows());
+            double inertia = 0.0;
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                inertia = lloyd_step(X, centroids, labels);
+                do_not_optimize(inertia);
+            }
+            state.set_items_per_iteration(static_cast<double>(X.rows()));
+            state.set_counter("inertia", inertia);
+        });
+    }
+
+    // One pass of online updates in batches of 1024 rows, from seeded centroids
+    bench::Fixture<std::vector<Matrix>> batches([] {
+        Matrix X = bench::make_blobs(20000, 16, 32);
+        std::vector<Matrix> split;
+        for (Index start = 0; start < X.rows(); start += kBatchRows) {
+            split.push_back(X.block(start, 0, std::min(kBatchRows, X.rows() - start), 16));
+        }
+        return split;
+    });
+    suite.add_benchmark("minibatch_kmeans_partial_fit/20000x16/k32", [batches](BenchmarkState& state) {
+        algorithms::MiniBatchKMeans model(32, kBatchRows, bench::kBenchSeed);
+        model.partial_fit(batches.get()[0]);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            for (const Matrix& batch : batches.get()) model.partial_fit(batch);
+            do_not_optimize(model.centroids().data());
+        }
+        state.set_items_per_iteration(20000.0);
+        // On one batch only; a full pass here would be timed with the updates
+        state.set_counter("batch_inertia", model.inertia(batches.get()[0]));
+    });
+
+    return bench::run_benchmarks(suite, argc, argv);
+}
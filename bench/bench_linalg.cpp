@@ -0,0 +1,149 @@
+#include "bench_common.h"
+
+using namespace dds;
+using namespace dds::testing;
+
+// The same kernels at float32 and float64 regardless of the configured Scalar, so the
+// bandwidth/lane-count gain of single precision shows up side by side
+template<typename T>
+void add_precision_benchmarks(BenchmarkSuite& suite, const std::string& tag) {
+    // Two 1M-element operands stored back to back as the rows of one matrix
+    bench::Fixture<Eigen::Matrix<T>> operands([] {
+        return bench::random_matrix(2, 1 << 20, bench::kBenchSeed).template cast<T>();
+    });
+    suite.add_benchmark("dot_" + tag + "/1M", [operands](BenchmarkState& state) {
+        const Eigen::Matrix<T>& xy = operands.get();
+        const size_t n = static_cast<size_t>(xy.cols());
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            double d = utils::simd::dot(xy.data(), xy.data() + n, n);
+            do_not_optimize(d);
+        }
+        state.set_bytes_per_iteration(2.0 * n * sizeof(T));
+    });
+
+    bench::Fixture<Eigen::Matrix<T>> lhs([] {
+        return bench::random_matrix(256, 256, bench::kBenchSeed).template cast<T>();
+    });
+    bench::Fixture<Eigen::Matrix<T>> rhs([] {
+        return bench::random_matrix(256, 256, bench::kBenchSeed + 1).template cast<T>();
+    });
+    suite.add_benchmark("gemm_" + tag + "/256", [lhs, rhs](BenchmarkState& state) {
+        const Eigen::Matrix<T>& A = lhs.get();
+        const Eigen::Matrix<T>& B = rhs.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Eigen::Matrix<T> C = A * B;
+            do_not_optimize(C.data()[0]);
+        }
+        state.set_items_per_iteration(2.0 * 256 * 256 * 256);
+    });
+}
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite("linalg");
+
+    // Inputs are built in fixtures, primed before timing, so only the kernels are measured
+    for (Index n : {64, 128, 256}) {
+        bench::Fixture<Matrix> lhs([n] { return bench::random_matrix(n, n, bench::kBenchSeed); });
+        bench::Fixture<Matrix> rhs([n] { return bench::random_matrix(n, n, bench::kBenchSeed + 1); });
+        suite.add_benchmark("gemm/" + std::to_string(n), [n, lhs, rhs](BenchmarkState& state) {
+            const Matrix& A = lhs.get();
+            const Matrix& B = rhs.get();
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                Matrix C = A * B;
+                do_not_optimize(C.data()[0]);
+            }
+            state.set_items_per_iteration(2.0 * n * n * n);
+        });
+    }
+
+    // Transposed operands go straight to the packed kernels; *_copy materializes
+    // the transpose first for comparison
+    bench::Fixture<Matrix> lhs([] { return bench::random_matrix(256, 256, bench::kBenchSeed); });
+    bench::Fixture<Matrix> rhs([] { return bench::random_matrix(256, 256, bench::kBenchSeed + 1); });
+    const std::pair<const char*, std::pair<Eigen::GemmOp, Eigen::GemmOp>> variants[] = {
+        {"nt", {Eigen::NoTrans, Eigen::Trans}},
+        {"tn", {Eigen::Trans, Eigen::NoTrans}},
+        {"tt", {Eigen::Trans, Eigen::Trans}},
+    };
+    for (const auto& variant : variants) {
+        const Eigen::GemmOp op_a = variant.second.first, op_b = variant.second.second;
+        suite.add_benchmark(std::string("gemm_") + variant.first + "/256", [lhs, rhs, op_a, op_b](BenchmarkState& state) {
+            Matrix C;
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                Eigen::gemm(op_a, op_b, Scalar(1), lhs.get(), rhs.get(), Scalar(0), C);
+                do_not_optimize(C.data()[0]);
+            }
+            state.set_items_per_iteration(2.0 * 256 * 256 * 256);
+        });
+    }
+    suite.add_benchmark("gemm_nt_copy/256", [lhs, rhs](BenchmarkState& state) {
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix Bt = rhs.get().transpose();
+            Matrix C = lhs.get() * Bt;
+            do_not_optimize(C.data()[0]);
+        }
+        state.set_items_per_iteration(2.0 * 256 * 256 * 256);
+    });
+
+    bench::Fixture<Matrix> tall([] { return bench::random_matrix(4096, 64, bench::kBenchSeed); });
+    bench::Fixture<Matrix> square([] { return bench::random_matrix(64, 64, bench::kBenchSeed + 1); });
+    suite.add_benchmark("gemm_tall/4096x64x64", [tall, square](BenchmarkState& state) {
+        const Matrix& A = tall.get();
+        const Matrix& B = square.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix C = A * B;
+            do_not_optimize(C.data()[0]);
+        }
+        state.set_items_per_iteration(2.0 * 4096 * 64 * 64);
+    });
+
+    bench::Fixture<Matrix> transpose_input([] { return bench::random_matrix(512, 512); });
+    suite.add_benchmark("transpose/512", [transpose_input](BenchmarkState& state) {
+        const Matrix& A = transpose_input.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix T = A.transpose();
+            do_not_optimize(T.data()[0]);
+        }
+        state.set_bytes_per_iteration(2.0 * 512 * 512 * sizeof(Scalar));
+    });
+
+    bench::Fixture<Matrix> addend_a([] { return bench::random_matrix(1024, 1024, bench::kBenchSeed); });
+    bench::Fixture<Matrix> addend_b([] { return bench::random_matrix(1024, 1024, bench::kBenchSeed + 1); });
+    suite.add_benchmark("add/1M", [addend_a, addend_b](BenchmarkState& state) {
+        const Matrix& A = addend_a.get();
+        const Matrix& B = addend_b.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix C = A + B;
+            do_not_optimize(C.data()[0]);
+        }
+        state.set_bytes_per_iteration(3.0 * 1024 * 1024 * sizeof(Scalar));
+    });
+
+    // Scaled in place across calls; the factor keeps it finite for any realistic count
+    bench::Fixture<std::shared_ptr<Matrix>> scaled([] {
+        return std::make_shared<Matrix>(bench::random_matrix(1024, 1024));
+    });
+    suite.add_benchmark("scale_inplace/1M", [scaled](BenchmarkState& state) {
+        Matrix& A = *scaled.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            A *= 1.0000001;
+            do_not_optimize(A.data()[0]);
+        }
+        state.set_bytes_per_iteration(2.0 * 1024 * 1024 * sizeof(Scalar));
+    });
+
+    bench::Fixture<Matrix> norm_input([] { return bench::random_matrix(1024, 1024); });
+    suite.add_benchmark("squared_norm/1M", [norm_input](BenchmarkState& state) {
+        const Matrix& A = norm_input.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Scalar s = A.squaredNorm();
+            do_not_optimize(s);
+        }
+        state.set_bytes_per_iteration(1024.0 * 1024 * sizeof(Scalar));
+    });
+
+    add_precision_benchmarks<float>(suite, "f32");
+    add_precision_benchmarks<double>(suite, "f64");
+
+    return bench::run_benchmarks(suite, argc, argv);
+}
@@ -0,0 +1,59 @@
+#include "bench_common.h"
+#include "pipeline/data_orchestrator.h"
+
+using namespace dds;
+using namespace dds::testing;
+using namespace dds::pipeline;
+
+namespace {
+
+// Tasks do no work, so the timings isolate the orchestrator's scheduling overhead
+std::shared_ptr<PipelineTask> noop_task(const std::string& id) {
+    return std::make_shared<PipelineTask>(id, id, [](TaskContext& ctx) {
+        ctx.output_data["done"] = "1";
+        return true;
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite("orchestrator");
+
+    for (int length : {16, 64}) {
+        suite.add_benchmark("chain/" + std::to_string(length), [length](BenchmarkState& state) {
+            bench::ScopedSilence quiet;
+            DataOrchestrator orchestrator;
+            orchestrator.create_pipeline("chain");
+            for (int t = 0; t < length; ++t) {
+                auto task = noop_task("t" + std::to_string(t));
+                if (t > 0) task->add_dependency("t" + std::to_string(t - 1));
+                orchestrator.add_task_to_pipeline("chain", task);
+            }
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                PipelineResult result = orchestrator.execute_pipeline("chain");
+                do_not_optimize(result.success);
+            }
+            state.set_items_per_iteration(length);
+        });
+    }
+
+    suite.add_benchmark("fan_in/64", [](BenchmarkState& state) {
+        bench::ScopedSilence quiet;
+        DataOrchestrator orchestrator;
+        orchestrator.create_pipeline("fan");
+        auto sink = noop_task("sink");
+        for (int t = 0; t < 63; ++t) {
+            orchestrator.add_task_to_pipeline("fan", noop_task("src" + std::to_string(t)));
+            sink->add_dependency("src" + std::to_string(t));
+        }
+        orchestrator.add_task_to_pipeline("fan", sink);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            PipelineResult result = orchestrator.execute_pipeline("fan");
+            do_not_optimize(result.success);
+        }
+        state.set_items_per_iteration(64);
+    });
+
+    return bench::run_benchmarks(suite, argc, argv);
+}
@@ -0,0 +1,75 @@
+#include "bench_common.h"
+#include "utils/random.h"
+
+using namespace dds;
+using namespace dds::testing;
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite("random");
+
+    constexpr size_t kN = 1 << 20;
+
+    suite.add_benchmark("philox_blocks/1M", [](BenchmarkState& state) {
+        std::vector<uint32_t> words(kN);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            utils::Philox4x32::generate_blocks(i * kN / 4, kN / 4, 0, bench::kBenchSeed, words.data());
+            do_not_optimize(words[0]);
+        }
+        state.set_items_per_iteration(static_cast<double>(kN));
+    });
+
+    suite.add_benchmark("fill_uniform/1M", [](BenchmarkState& state) {
+        std::vector<Scalar> out(kN);
+        utils::RandomStream rng(bench::kBenchSeed);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            rng.fill_uniform(out.data(), out.size());
+            do_not_optimize(out[0]);
+        }
+        state.set_items_per_iteration(static_cast<double>(kN));
+    });
+
+    suite.add_benchmark("fill_normal/1M", [](BenchmarkState& state) {
+        std::vector<Scalar> out(kN);
+        utils::RandomStream rng(bench::kBenchSeed);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            rng.fill_normal(out.data(), out.size());
+            do_not_optimize(out[0]);
+        }
+        state.set_items_per_iteration(static_cast<double>(kN));
+    });
+
+    suite.add_benchmark("fill_bernoulli_bits/1M", [](BenchmarkState& state) {
+        std::vector<uint64_t> bits(kN / 64);
+        utils::RandomStream rng(bench::kBenchSeed);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            rng.fill_bernoulli_bits(bits.data(), kN, 0.5);
+            do_not_optimize(bits[0]);
+        }
+        state.set_items_per_iteration(static_cast<double>(kN));
+    });
+
+    // 100 trees' bootstrap indices over 10k rows, one forked stream per tree
+    suite.add_benchmark("bootstrap/10000x100", [](BenchmarkState& state) {
+        std::vector<int> indices(10000);
+        utils::RandomStream rng(bench::kBenchSeed);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            for (int tree = 0; tree < 100; ++tree) {
+                utils::RandomStream tree_rng = rng.fork(static_cast<uint64_t>(tree));
+                tree_rng.fill_below(indices.data(), indices.size(), 10000u);
+                do_not_optimize(indices[0]);
+            }
+        }
+        state.set_items_per_iteration(10000.0 * 100);
+    });
+
+    suite.add_benchmark("shuffle/100000", [](BenchmarkState& state) {
+        utils::RandomStream rng(bench::kBenchSeed);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            std::vector<int> order = utils::permutation(100000, rng);
+            do_not_optimize(order[0]);
+        }
+        state.set_items_per_iteration(100000.0);
+    });
+
+    return bench::run_benchmarks(suite, argc, argv);
+}
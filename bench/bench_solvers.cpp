@@ -0,0 +1,144 @@
+#include "bench_common.h"
+#include "algorithms/advanced_algorithms.h"
+#include "algorithms/logistic_regression.h"
+
+using namespace dds;
+using namespace dds::testing;
+
+// Rates use the nominal LAPACK flop counts (Golub & Van Loan) so different
+// algorithms for the same factorization compare directly
+namespace {
+
+Matrix spd_matrix(Index n) {
+    Matrix a = bench::random_matrix(n + 16, n);
+    Matrix spd = a.transpose() * a;
+    for (Index i = 0; i < n; ++i) spd(i, i) += static_cast<Scalar>(n);
+    return spd;
+}
+
+Scalar feature(const Matrix& X, Index i, Index j) { return X(i, j); }
+Scalar feature(const SparseMatrixCSR& X, Index i, Index j) { return X.coeff(i, j); }
+
+// Labels from a linear rule on the first eighth of the features: its sign for two
+// classes, bands of its magnitude for more
+template<typename Features>
+Vector logistic_labels(const Features& X, Index classes) {
+    const Index cols = X.cols();
+    const Index informative = std::max<Index>(1, cols / 8);
+    Vector labels(X.rows());
+    for (Index i = 0; i < X.rows(); ++i) {
+        double z = 0.0;
+        for (Index j = 0; j < informative; ++j) z += static_cast<double>(feature(X, i, j)) * (j % 2 ? -1.0 : 1.0);
+        const Index band = classes == 2 ? (z > 0.0 ? 1 : 0) : std::min<Index>(classes - 1, static_cast<Index>(std::abs(z)));
+        labels[i] = static_cast<Scalar>(band);
+    }
+    return labels;
+}
+
+LogisticRegressionParams logistic_params(double strength) {
+    return LogisticRegressionParams{Matrix(), Vector(), 0.0, 100, 1e-4, strength > 0.0, strength, 0};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite("solvers");
+
+    for (Index n : {256, 512}) {
+        bench::Fixture<Matrix> spd([n] { return spd_matrix(n); });
+        suite.add_benchmark("llt/" + std::to_string(n), [spd, n](BenchmarkState& state) {
+            Eigen::LLT<Scalar> llt;
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                llt.compute(spd.get());
+                do_not_optimize(llt.matrixL().data()[0]);
+            }
+            state.set_items_per_iteration(n * n * n / 3.0);
+        });
+    }
+
+    bench::Fixture<Matrix> tall([] { return bench::random_matrix(1024, 256); });
+    suite.add_benchmark("qr/1024x256", [tall](BenchmarkState& state) {
+        Eigen::HouseholderQR<Scalar> qr;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            qr.compute(tall.get());
+            do_not_optimize(qr.matrixQR().data()[0]);
+        }
+        state.set_items_per_iteration(2.0 * 1024 * 256 * 256 - 2.0 * 256 * 256 * 256 / 3.0);
+    });
+
+    bench::Fixture<Matrix> symmetric([] { return spd_matrix(256); });
+    suite.add_benchmark("eig/256", [symmetric](BenchmarkState& state) {
+        Eigen::SelfAdjointEigenSolver<Scalar> solver;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            solver.compute(symmetric.get());
+            do_not_optimize(solver.eigenvectors().data()[0]);
+        }
+        state.set_items_per_iteration(9.0 * 256 * 256 * 256);
+    });
+    suite.add_benchmark("eig_values/256", [symmetric](BenchmarkState& state) {
+        Eigen::SelfAdjointEigenSolver<Scalar> solver;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            solver.compute(symmetric.get(), Eigen::EigenvaluesOnly);
+            do_not_optimize(solver.eigenvalues()[0]);
+        }
+        state.set_items_per_iteration(4.0 * 256 * 256 * 256 / 3.0);
+    });
+
+    bench::Fixture<Matrix> svd_input([] { return bench::random_matrix(512, 128, bench::kBenchSeed + 1); });
+    suite.add_benchmark("svd/512x128", [svd_input](BenchmarkState& state) {
+        Eigen::JacobiSVD<Scalar> svd;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            svd.compute(svd_input.get(), Eigen::ComputeThinU | Eigen::ComputeThinV);
+            do_not_optimize(svd.singularValues()[0]);
+        }
+        state.set_items_per_iteration(6.0 * 512 * 128 * 128 + 11.0 * 128 * 128 * 128);
+    });
+
+    bench::Fixture<Matrix> samples([] { return bench::random_matrix(10000, 64, bench::kBenchSeed + 2); });
+    suite.add_benchmark("pca_fit/10000x64", [samples](BenchmarkState& state) {
+        bench::ScopedSilence quiet;
+        algorithms::PCA pca(8);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            pca.fit(samples.get());
+            do_not_optimize(pca.explained_variance_ratio(0));
+        }
+        state.set_items_per_iteration(10000.0);
+    });
+
+    bench::Fixture<Matrix> features([] { return bench::random_matrix(20000, 64, bench::kBenchSeed + 3); });
+    for (Index classes : {2, 5}) {
+        bench::Fixture<Vector> labels([features, classes] { return logistic_labels(features.get(), classes); });
+        suite.add_benchmark("logistic_lbfgs/20000x64/k" + std::to_string(classes), [features, labels](BenchmarkState& state) {
+            algorithms::LogisticRegression model(logistic_params(1e-3), algorithms::LogisticPenalty::L2,
+                                                 algorithms::LogisticSolver::LBFGS);
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                model.fit(features.get(), labels.get());
+                do_not_optimize(model.params().bias[0]);
+            }
+            state.set_items_per_iteration(20000.0);
+        });
+    }
+
+    bench::Fixture<SparseMatrixCSR> documents([] {
+        return bench::random_sparse<SparseMatrixCSR>(20000, 2000, 0.01, bench::kBenchSeed + 4);
+    });
+    bench::Fixture<Vector> document_labels([documents] { return logistic_labels(documents.get(), 2); });
+    suite.add_benchmark("logistic_cd_l1/20000x2000/sparse", [documents, document_labels](BenchmarkState& state) {
+        algorithms::LogisticRegression model(logistic_params(2e-3), algorithms::LogisticPenalty::L1);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            model.fit(documents.get(), document_labels.get());
+            do_not_optimize(model.params().bias[0]);
+        }
+        state.set_items_per_iteration(20000.0);
+    });
+    suite.add_benchmark("logistic_path/20000x2000/sparse/8", [documents, document_labels](BenchmarkState& state) {
+        const std::vector<double> strengths = {0.05, 0.02, 0.01, 5e-3, 2e-3, 1e-3, 5e-4, 2e-4};
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            algorithms::LogisticRegression model(logistic_params(strengths[0]), algorithms::LogisticPenalty::L1);
+            do_not_optimize(model.fit_path(documents.get(), document_labels.get(), strengths).size());
+        }
+        state.set_items_per_iteration(20000.0 * 8);
+    });
+
+    return bench::run_benchmarks(suite, argc, argv);
+}
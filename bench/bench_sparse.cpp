@@ -0,0 +1,116 @@
+#include "bench_common.h"
+#include "algorithms/advanced_algorithms.h"
+
+using namespace dds;
+using namespace dds::testing;
+
+namespace {
+
+struct Density {
+    const char* label;
+    double value;
+};
+
+const Density kDensities[] = {{"0.1pct", 0.001}, {"1pct", 0.01}, {"10pct", 0.1}};
+constexpr Index kN = 4096;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite("sparse");
+
+    bench::Fixture<Matrix> dense([] { return bench::random_matrix(kN, kN); });
+    // Operands are fixtures too, primed before timing, so only the products are measured
+    bench::Fixture<Matrix> vector_operand([] { return bench::random_matrix(kN, 1, bench::kBenchSeed + 1); });
+    bench::Fixture<Matrix> panel_operand([] { return bench::random_matrix(kN, 64, bench::kBenchSeed + 1); });
+    bench::Fixture<Matrix> narrow_operand([] { return bench::random_matrix(kN, 8, bench::kBenchSeed + 1); });
+    bench::Fixture<Vector> spmv_operand([] { return Vector::Random(kN); });
+    suite.add_benchmark("spmv_dense/4096", [dense, vector_operand](BenchmarkState& state) {
+        const Matrix& A = dense.get();
+        const Matrix& x = vector_operand.get();
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix y = A * x;
+            do_not_optimize(y.data()[0]);
+        }
+        state.set_items_per_iteration(2.0 * kN * kN);
+    });
+
+    for (const Density& d : kDensities) {
+        std::string suffix = std::string("/4096/") + d.label;
+        double density = d.value;
+        bench::Fixture<SparseMatrixCSR> csr([density] { return bench::random_sparse(kN, kN, density); });
+        bench::Fixture<SparseMatrixCSC> csc([csr] { return SparseMatrixCSC(csr.get()); });
+
+        suite.add_benchmark("spmv_csr" + suffix, [csr, spmv_operand](BenchmarkState& state) {
+            const SparseMatrixCSR& A = csr.get();
+            const Vector& x = spmv_operand.get();
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                Vector y = A * x;
+                do_not_optimize(y.data()[0]);
+            }
+            state.set_items_per_iteration(2.0 * A.nonZeros());
+        });
+
+        suite.add_benchmark("spmv_csc" + suffix, [csc, spmv_operand](BenchmarkState& state) {
+            const SparseMatrixCSC& A = csc.get();
+            const Vector& x = spmv_operand.get();
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                Vector y = A * x;
+                do_not_optimize(y.data()[0]);
+            }
+            state.set_items_per_iteration(2.0 * A.nonZeros());
+        });
+
+        suite.add_benchmark("spmm_csr_x64" + suffix, [csr, panel_operand](BenchmarkState& state) {
+            const SparseMatrixCSR& A = csr.get();
+            const Matrix& B = panel_operand.get();
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                Matrix C = A * B;
+                do_not_optimize(C.data()[0]);
+            }
+            state.set_items_per_iteration(2.0 * A.nonZeros() * 64);
+        });
+
+        suite.add_benchmark("spmm_csr_transposed_x8" + suffix, [csr, narrow_operand](BenchmarkState& state) {
+            const SparseMatrixCSR& A = csr.get();
+            const Matrix& B = narrow_operand.get();
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                Matrix C = A.transposeMultiply(B);
+                do_not_optimize(C.data()[0]);
+            }
+            state.set_items_per_iteration(2.0 * A.nonZeros() * 8);
+        });
+
+        if (density == 0.01) {
+            suite.add_benchmark("csr_to_csc" + suffix, [csr](BenchmarkState& state) {
+                const SparseMatrixCSR& A = csr.get();
+                for (size_t i = 0; i < state.iterations(); ++i) {
+                    SparseMatrixCSC C(A);
+                    do_not_optimize(C.valuePtr()[0]);
+                }
+                state.set_items_per_iteration(static_cast<double>(A.nonZeros()));
+            });
+        }
+    }
+
+    // Hashed-feature input layer: 2^18 columns, ~64 active per row
+    bench::Fixture<SparseMatrixCSR> hashed([] { return bench::random_sparse(256, 1 << 18, 64.0 / (1 << 18)); });
+    bench::Fixture<std::shared_ptr<algorithms::DenseLayer>> hashed_layer([] {
+        auto layer = std::make_shared<algorithms::DenseLayer>(1 << 18, 16, algorithms::ActivationType::RELU);
+        layer->initialize_weights(1.0);
+        return layer;
+    });
+    suite.add_benchmark("dense_layer_csr/256x262144->16", [hashed, hashed_layer](BenchmarkState& state) {
+        const SparseMatrixCSR& X = hashed.get();
+        algorithms::DenseLayer& layer = *hashed_layer.get();
+        Matrix grad = Matrix::Ones(256, 16);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix out = layer.forward(X);
+            layer.backward(grad);
+            do_not_optimize(out.data()[0]);
+        }
+        state.set_items_per_iteration(256.0);
+    });
+
+    return bench::run_benchmarks(suite, argc, argv);
+}
@@ -0,0 +1,68 @@
+#include "bench_common.h"
+#include "storage/hadoop_storage.h"
+
+using namespace dds;
+using namespace dds::testing;
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite("storage");
+
+    storage::HadoopStorage hdfs;
+    {
+        bench::ScopedSilence quiet;
+        hdfs.connect();
+    }
+
+    const Matrix M = bench::random_matrix(2000, 32);
+    Matrix X;
+    Vector y;
+    bench::make_regression(2000, 32, X, y);
+    const double matrix_bytes = static_cast<double>(M.size() * sizeof(Scalar));
+
+    suite.add_benchmark("save_matrix/2000x32", [&](BenchmarkState& state) {
+        bench::ScopedSilence quiet;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            hdfs.save_matrix("bench/matrix.dat", M);
+        }
+        state.set_bytes_per_iteration(matrix_bytes);
+    });
+
+    suite.add_benchmark("load_matrix/2000x32", [&](BenchmarkState& state) {
+        bench::ScopedSilence quiet;
+        hdfs.save_matrix("bench/matrix.dat", M);
+        Matrix loaded;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            hdfs.load_matrix("bench/matrix.dat", loaded);
+            do_not_optimize(loaded.data()[0]);
+        }
+        state.set_bytes_per_iteration(matrix_bytes);
+    });
+
+    suite.add_benchmark("save_dataset/2000x32", [&](BenchmarkState& state) {
+        bench::ScopedSilence quiet;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            hdfs.save_dataset("bench/dataset.dat", X, y);
+        }
+        state.set_bytes_per_iteration(matrix_bytes + y.size() * sizeof(Scalar));
+    });
+
+    suite.add_benchmark("load_dataset/2000x32", [&](BenchmarkState& state) {
+        bench::ScopedSilence quiet;
+        hdfs.save_dataset("bench/dataset.dat", X, y);
+        Matrix features;
+        Vector labels;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            hdfs.load_dataset("bench/dataset.dat", features, labels);
+            do_not_optimize(features.data()[0]);
+        }
+        state.set_bytes_per_iteration(matrix_bytes + y.size() * sizeof(Scalar));
+    });
+
+    int rc = bench::run_benchmarks(suite, argc, argv);
+    {
+        bench::ScopedSilence quiet;
+        hdfs.delete_file("bench/matrix.dat");
+        hdfs.delete_file("bench/dataset.dat");
+    }
+    return rc;
+}
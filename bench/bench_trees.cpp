@@ -0,0 +1,177 @@
+#include "bench_common.h"
+#include "algorithms/advanced_algorithms.h"
+#include "algorithms/cross_validation.h"
+#include "algorithms/feature_importance.h"
+#include "algorithms/hyperparameter_search.h"
+#include <cstdio>
+
+using namespace dds;
+using namespace dds::testing;
+
+int main(int argc, char** argv) {
+    BenchmarkSuite suite("trees");
+
+    Matrix X;
+    Vector y;
+    bench::make_classification(2000, 16, X, y);
+
+    suite.add_benchmark("decision_tree_fit/2000x16", [&X, &y](BenchmarkState& state) {
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            algorithms::DecisionTree tree(8, 2, 1);
+            tree.fit(X, y);
+            do_not_optimize(tree);
+        }
+        state.set_items_per_iteration(static_cast<double>(X.rows()));
+    });
+
+    // Quantile bins, then the histogram split search over them
+    suite.add_benchmark("feature_bins/2000x16", [&X](BenchmarkState& state) {
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            algorithms::FeatureBins bins(X);
+            do_not_optimize(bins);
+        }
+        state.set_items_per_iteration(static_cast<double>(X.rows()));
+    });
+
+    const algorithms::FeatureBins bins(X);
+    suite.add_benchmark("decision_tree_fit_binned/2000x16", [&bins, &y](BenchmarkState& state) {
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            algorithms::DecisionTree tree(8, 2, 1);
+            tree.fit(bins, y);
+            do_not_optimize(tree);
+        }
+        state.set_items_per_iteration(static_cast<double>(bins.rows()));
+    });
+
+    suite.add_benchmark("decision_tree_predict/2000x16", [&X, &y](BenchmarkState& state) {
+        algorithms::DecisionTree tree(8, 2, 1);
+        tree.fit(X, y);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Vector p = tree.predict(X);
+            do_not_optimize(p);
+        }
+        state.set_items_per_iteration(static_cast<double>(X.rows()));
+    });
+
+    suite.add_benchmark("random_forest_fit/2000x16x10", [&X, &y](BenchmarkState& state) {
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            algorithms::RandomForest forest(10, 8, 2, 1);
+            forest.fit(X, y);
+            do_not_optimize(forest);
+        }
+        state.set_items_per_iteration(static_cast<double>(X.rows()) * 10);
+    });
+
+    // Fitted once; the harness times the whole benchmark body
+    algorithms::RandomForest forest(100, 8, 2, 1);
+    const std::string forest_path = "bench_random_forest.ddsm";
+    {
+        bench::ScopedSilence quiet;
+        forest.fit(X, y);
+        forest.save_model(forest_path);
+    }
+
+    suite.add_benchmark("random_forest_predict/2000x16x100", [&X, &forest](BenchmarkState& state) {
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Vector p = forest.predict(X);
+            do_not_optimize(p);
+        }
+        state.set_items_per_iteration(static_cast<double>(X.rows()));
+    });
+
+    // Map and validate the saved forest, ready to predict; items are trees
+    suite.add_benchmark("random_forest_load/100x2000x16", [&forest_path](BenchmarkState& state) {
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            algorithms::RandomForest loaded;
+            loaded.load_model(forest_path);
+            do_not_optimize(loaded);
+        }
+        state.set_items_per_iteration(100.0);
+    });
+
+    // Items are row-rounds, so equal rates at 20 and 100 rounds mean a round's cost
+    // does not grow with the trees already fitted
+    for (int rounds : {20, 100}) {
+        suite.add_benchmark("gradient_boosting_fit/2000x16x" + std::to_string(rounds), [&X, &y, rounds](BenchmarkState& state) {
+            bench::ScopedSilence quiet;
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                algorithms::GradientBoosting model(rounds, 0.1, 3);
+                model.fit(X, y);
+                do_not_optimize(model);
+            }
+            state.set_items_per_iteration(static_cast<double>(X.rows()) * rounds);
+        });
+    }
+
+    // 27 boosting configurations over the same resident data and bins; the full-budget
+    // search trains each for 27 rounds, successive halving stops most after 3 or 9.
+    // Items are configurations.
+    const algorithms::TuningData tuning(X, y, 0.25);
+    tuning.feature_bins();
+    algorithms::SearchSpace space;
+    space.add_range("learning_rate", 0.02, 0.5, true);
+    space.add_int_range("max_depth", 2, 6);
+    for (auto strategy : {algorithms::SearchStrategy::RANDOM, algorithms::SearchStrategy::ASHA}) {
+        const std::string name = strategy == algorithms::SearchStrategy::RANDOM ? "random" : "asha";
+        suite.add_benchmark("hyperparameter_search_" + name + "/27x27", [&tuning, &space, strategy](BenchmarkState& state) {
+            bench::ScopedSilence quiet;
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                algorithms::HyperparameterSearch search(space, algorithms::gradient_boosting_objective(), strategy);
+                search.set_trials(27);
+                search.set_budget(3, 27, 3);
+                search.run(tuning);
+                do_not_optimize(search.best());
+            }
+            state.set_items_per_iteration(27.0);
+        });
+    }
+
+    // Items are rows explained: 16 features x 3 shuffles for permutation importance,
+    // every feature's SHAP value for TreeSHAP
+    algorithms::RandomForest small_forest(10, 8, 2, 1);
+    algorithms::GradientBoosting boosting(100, 0.1, 3);
+    {
+        bench::ScopedSilence quiet;
+        small_forest.fit(X, y);
+        boosting.fit(X, y);
+    }
+    suite.add_benchmark("permutation_importance/2000x16x10/3", [&X, &y, &small_forest](BenchmarkState& state) {
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            auto importance = algorithms::permutation_importance(small_forest, X, y, 3);
+            do_not_optimize(importance);
+        }
+        state.set_items_per_iteration(static_cast<double>(X.rows()) * 16 * 3);
+    });
+    suite.add_benchmark("tree_shap/2000x16x100", [&X, &boosting](BenchmarkState& state) {
+        const algorithms::TreeExplainer explainer(boosting);
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            Matrix values = explainer.shap_values(X);
+            do_not_optimize(values);
+        }
+        state.set_items_per_iteration(static_cast<double>(X.rows()));
+    });
+
+    // 5-fold cross-validation reading the folds in place; items are training rows
+    // over all folds
+    const algorithms::CrossValidator cross_validator(algorithms::kfold_split(static_cast<int>(X.rows()), 5));
+    suite.add_benchmark("cross_validate_random_forest/2000x16x10/5", [&X, &y, &cross_validator](BenchmarkState& state) {
+        bench::ScopedSilence quiet;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            auto report = cross_validator.run([] { return algorithms::ModelFactory::create_random_forest(10, 8); }, X, y);
+            do_not_optimize(report);
+        }
+        state.set_items_per_iteration(static_cast<double>(X.rows()) * 4);
+    });
+    suite.add_benchmark("cross_validate_gradient_boosting/2000x16x20/5", [&X, &y, &cross_validator](BenchmarkState& state) {
+        bench::ScopedSilence quiet;
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            auto report = cross_validator.run([] { return algorithms::ModelFactory::create_gradient_boosting(20, 0.1); }, X, y);
+            do_not_optimize(report);
+        }
+        state.set_items_per_iteration(static_cast<double>(X.rows()) * 4);
+    });
+
+    const int status = bench::run_benchmarks(suite, argc, argv);
+    std::remove(forest_path.c_str());
+    return status;
+}
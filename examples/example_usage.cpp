@@ -31,10 +31,10 @@ int main() {
     std::cout << "Job Status: " << dds::job_status_to_string(status) << std::endl;
 
     // Test Eigen stub
-    Eigen::MatrixXd matrix(3, 3);
+    dds::Matrix matrix(3, 3);
     matrix.setRandom();
 
-    Eigen::VectorXd vector(3);
+    dds::Vector vector(3);
     vector.setRandom();
 
     std::cout << "\nMatrix (3x3):" << std::endl;
@@ -56,7 +56,7 @@ int main() {
     }
 
     // Test matrix operations
-    Eigen::MatrixXd result = matrix * vector;
+    dds::Matrix result = matrix * vector;
     std::cout << "\nMatrix * Vector result:" << std::endl;
     for (int i = 0; i < 3; ++i) {
         std::cout << result[i] << std::endl;
@@ -90,7 +90,7 @@ int main() {
                     std::cout << "✅ Saved matrix to HDFS" << std::endl;
                     
                     // Load matrix from HDFS
-                    Eigen::MatrixXd loaded_matrix;
+                    dds::Matrix loaded_matrix;
                     if (hadoop_storage.load_matrix("/test_data/test_matrix", loaded_matrix)) {
                         std::cout << "✅ Loaded matrix from HDFS" << std::endl;
                         
@@ -124,8 +124,8 @@ int main() {
                 }
                 
                 // Create a test dataset
-                Eigen::MatrixXd features(100, 3);
-                Eigen::VectorXd labels(100);
+                dds::Matrix features(100, 3);
+                dds::Vector labels(100);
                 features.setRandom();
                 labels.setRandom();
                 
@@ -133,8 +133,8 @@ int main() {
                     std::cout << "✅ Saved dataset to HDFS" << std::endl;
                     
                     // Load dataset back
-                    Eigen::MatrixXd loaded_features;
-                    Eigen::VectorXd loaded_labels;
+                    dds::Matrix loaded_features;
+                    dds::Vector loaded_labels;
                     if (hadoop_storage.load_dataset("/test_data/dataset", loaded_features, loaded_labels)) {
                         std::cout << "✅ Loaded dataset from HDFS" << std::endl;
                         std::cout << "  Features: " << loaded_features.rows() << "x" << loaded_features.cols() << std::endl;
@@ -2,17 +2,23 @@
 
 #include "../utils/types.h"
 #include "../utils/eigen_stub.h"
+#include "../utils/random.h"
+#include "model_format.h"
+#include "optimizers.h"
+#include "workspace.h"
 #include <string>
 #include <vector>
 #include <memory>
 #include <functional>
-#include <random>
 
 namespace dds {
 namespace algorithms {
 
 // Forward declarations
 class DecisionTree;
+class FeatureBins;
+class DropoutLayer;
+class BatchNormLayer;
 
 // Neural Network Layer Types
 enum class LayerType {
@@ -38,9 +44,21 @@ enum class ActivationType {
     MISH,
     SELU,
     HARD_SIGMOID,
-    HARD_SWISH
+    HARD_SWISH,
+    LINEAR          // Identity
 };
 
+// Everything apart from its tensors that rebuilds a layer; stored as-is in model files
+struct LayerConfig {
+    uint32_t type;                  // LayerType
+    uint32_t activation;            // ActivationType
+    int32_t dims[8];                // Sizes, per layer type (see each config())
+    double options[2];              // Settings, per layer type
+    uint64_t state_size;            // Scalars of collect_state(), filled in by the network
+};
+
+static_assert(sizeof(LayerConfig) == 64, "layer record layout");
+
 // Neural Network Layer
 class NeuralLayer {
 protected:
@@ -50,12 +68,32 @@ protected:
     Matrix weights_;
     Vector biases_;
     Matrix activations_;
-    Matrix gradients_;
+    Matrix gradients_;              // Same shape as weights_ after backward
+    Vector bias_gradients_;
     ActivationType activation_;
     
     // Cache for backward pass
     Matrix input_cache_;
     Matrix linear_cache_;
+    
+    // Set by forward_rows() for backward_rows(): the batch input (or input_cache_),
+    // the activation cache and the batch size
+    const Scalar* input_rows_ = nullptr;
+    Scalar* cache_rows_ = nullptr;
+    Index batch_rows_ = 0;
+    
+    // Training mode draws dropout masks; inference skips dropout entirely
+    bool training_ = true;
+    
+    // activation_ applied to a linear output, and the gradient with respect to
+    // linear_cache_ given the gradient with respect to the activated output
+    Matrix activate(const Matrix& linear_output) const;
+    Matrix activation_delta(const Matrix& gradient) const;
+    // Row kernels behind them: y = f(z), and gradient *= f'(z) in place. For SOFTMAX,
+    // activate_rows() replaces z with the softmax output, which is the cache
+    // activation_delta_rows() then expects. y may alias z.
+    void activate_rows(Scalar* z, Scalar* y, Index rows, Index cols) const;
+    void activation_delta_rows(const Scalar* cache, Scalar* gradient, Index rows, Index cols) const;
 
 public:
     NeuralLayer(LayerType type, int input_size, int output_size, ActivationType activation = ActivationType::RELU);
@@ -67,15 +105,42 @@ public:
     
     // Parameter management
     virtual void initialize_weights(double std_dev = 0.01);
+    // Plain SGD over collect_parameters(); NeuralNetwork steps an Optimizer instead
     virtual void update_weights(double learning_rate);
     virtual void zero_gradients();
+    // Appends every trainable tensor with its gradient (weights_ and biases_ by default)
+    virtual void collect_parameters(std::vector<ParameterView>& parameters);
+    void set_training(bool training) { training_ = training; }
+    
+    // Persistence: config() and the tensors of collect_state() (the parameters plus
+    // any running statistics, gradients unused) are what a model file stores.
+    // from_config() rebuilds an empty layer of the same shape, or null.
+    virtual LayerConfig config() const;
+    virtual void collect_state(std::vector<ParameterView>& state) { collect_parameters(state); }
+    static std::unique_ptr<NeuralLayer> from_config(const LayerConfig& config);
+    
+    // Planned execution over caller-owned buffers (NeuralNetwork's training workspace).
+    // forward_rows() reads rows x input_cols and writes rows x output columns; cache
+    // has rows x workspace_cache_columns() elements. The layer keeps pointers to input
+    // (if backward_reads_input()) and cache until its backward_rows(), which turns
+    // the output gradient in place into scratch and writes the input gradient unless
+    // that is null (first layer).
+    virtual bool supports_workspace(Index input_cols) const;
+    virtual Index workspace_cache_columns() const { return 0; }
+    virtual bool backward_reads_input() const { return true; }
+    virtual void forward_rows(const Scalar* input, Index rows, Index input_cols, Scalar* output, Scalar* cache);
+    virtual void backward_rows(Scalar* gradient, Scalar* input_gradient);
+    bool is_training() const { return training_; }
     
     // Getters
     LayerType get_type() const { return type_; }
     int get_input_size() const { return input_size_; }
     int get_output_size() const { return output_size_; }
+    ActivationType get_activation() const { return activation_; }
     const Matrix& get_weights() const { return weights_; }
     const Vector& get_biases() const { return biases_; }
+    const Matrix& get_gradients() const { return gradients_; }
+    const Vector& get_bias_gradients() const { return bias_gradients_; }
     
     // Activation functions
     static Matrix relu(const Matrix& x);
@@ -108,25 +173,364 @@ public:
 
 // Dense Layer Implementation
 class DenseLayer : public NeuralLayer {
+private:
+    // Set by the sparse forward; backward then produces weight gradients from the
+    // CSR input and returns an empty input gradient (the input is raw features)
+    SparseMatrixCSR sparse_input_cache_;
+    bool sparse_input_ = false;
+    
+    // Dropout layer directly after this one; its mask is applied to this layer's
+    // output in place, so no separate dropout output is materialized
+    DropoutLayer* fused_dropout_ = nullptr;
+    
+    std::vector<Accumulator> bias_sums_;
+    
+    // Post-training int8 copy of the weights, used by forward() outside training:
+    // one row per output, each zero-padded to quantized_stride_ bytes
+    std::vector<int8_t> quantized_weights_;
+    std::vector<Scalar> output_scales_;         // Input scale times the row's weight scale
+    Index quantized_stride_ = 0;
+    Scalar quantized_input_range_ = Scalar(0);
+    Scalar input_inverse_scale_ = Scalar(0);
+    
+    // output = activation(z), then the fused dropout mask
+    void activate_output(Scalar* z, Scalar* output, Index rows);
+    void forward_quantized(const Scalar* input, Index rows, Scalar* output);
+
 public:
     DenseLayer(int input_size, int output_size, ActivationType activation = ActivationType::RELU);
     
     Matrix forward(const Matrix& input) override;
+    Matrix forward(const SparseMatrixCSR& input);    // One-hot / hashed features
     Matrix backward(const Matrix& gradient) override;
     void initialize_weights(double std_dev = 0.01) override;
+    void fuse_dropout(DropoutLayer* dropout) { fused_dropout_ = dropout; }
+    
+    // The cache is the pre-activation output (softmax output for SOFTMAX); LINEAR needs none
+    bool supports_workspace(Index input_cols) const override { return input_cols == input_size_; }
+    Index workspace_cache_columns() const override {
+        return activation_ == ActivationType::LINEAR ? 0 : output_size_;
+    }
+    void forward_rows(const Scalar* input, Index rows, Index input_cols, Scalar* output, Scalar* cache) override;
+    void backward_rows(Scalar* gradient, Scalar* input_gradient) override;
+    
+    // Fold a following inference-mode batch norm into this layer's weights and
+    // biases and take over its activation. Only valid for a LINEAR dense layer.
+    bool fold_batch_norm(const BatchNormLayer& batch_norm);
+    
+    // Symmetric int8 weights with one scale per output channel; inputs are quantized
+    // with the scale that maps input_range (the calibrated largest |x|) to 127.
+    // Training and changing the weights keep using the floating-point copy.
+    void quantize(Scalar input_range);
+    void dequantize();
+    bool is_quantized() const { return !quantized_weights_.empty(); }
+    Scalar quantized_input_range() const { return quantized_input_range_; }
+};
+
+// Inverted-dropout keep mask: one bit per element, each row starting on a fresh
+// 64-bit word, so a batch costs 1/64 of a double mask
+class DropoutMask {
+private:
+    std::vector<uint64_t> bits_;
+    Index rows_ = 0;
+    Index cols_ = 0;
+    Index words_per_row_ = 0;
+    Scalar scale_ = Scalar(1);
+
+public:
+    // Draw a new mask keeping each element with probability 1 - rate and apply it to
+    // x in the same pass; kept elements are scaled by 1 / (1 - rate)
+    void generate_and_apply(Matrix& x, double rate, utils::RandomStream& rng);
+    void generate_and_apply(Scalar* x, Index rows, Index cols, double rate, utils::RandomStream& rng);
+    // Reapply the last mask (backward pass) to a buffer of the same shape
+    void apply(Matrix& x) const;
+    void apply(Scalar* x) const;
+    
+    bool kept(Index row, Index col) const {
+        return (bits_[row * words_per_row_ + col / 64] >> (col % 64)) & 1;
+    }
+    size_t memory_bytes() const { return bits_.size() * sizeof(uint64_t); }
 };
 
 // Dropout Layer
 class DropoutLayer : public NeuralLayer {
 private:
     double dropout_rate_;
-    Eigen::MatrixXd mask_;
+    DropoutMask mask_;
+    utils::RandomStream rng_;
+    bool fused_ = false;            // Applied by the preceding DenseLayer
+    Index columns_ = 0;             // Width of the last forward_rows() batch
+
+public:
+    // size: the width of the layer it follows, which it keeps
+    DropoutLayer(double dropout_rate = 0.5, int size = 0);
+    
+    Matrix forward(const Matrix& input) override;
+    Matrix backward(const Matrix& gradient) override;
+    
+    bool supports_workspace(Index) const override { return true; }
+    bool backward_reads_input() const override { return false; }
+    void forward_rows(const Scalar* input, Index rows, Index input_cols, Scalar* output, Scalar* cache) override;
+    void backward_rows(Scalar* gradient, Scalar* input_gradient) override;
+    // options[0] = dropout rate
+    LayerConfig config() const override;
+    
+    // In-place mask for a fused producer layer; no-ops outside training mode
+    void apply_forward(Matrix& activations);
+    void apply_forward(Scalar* activations, Index rows, Index cols);
+    void apply_backward(Matrix& gradient) const;
+    void apply_backward(Scalar* gradient) const;
+    void set_fused(bool fused) { fused_ = fused; }
+    bool is_fused() const { return fused_; }
+    double get_dropout_rate() const { return dropout_rate_; }
+    const DropoutMask& get_mask() const { return mask_; }
+};
+
+// Batch Normalization Layer (LayerType::BATCH_NORMALIZATION)
+//
+// Normalizes each feature over the batch, then applies gamma, beta and an optional
+// activation. The usual layout is a LINEAR DenseLayer, then BatchNormLayer(RELU), so
+// NeuralNetwork::fold_batch_norm() can later merge the pair into one dense layer.
+// Inference uses the running statistics, which reduces the layer to x * scale + shift.
+class BatchNormLayer : public NeuralLayer {
+private:
+    double momentum_;               // Weight of the current batch in the running statistics
+    double epsilon_;
+    Vector gamma_;
+    Vector beta_;
+    Vector running_mean_;
+    Vector running_var_;            // Unbiased batch variance
+    Vector gamma_gradients_;
+    Vector beta_gradients_;
+    
+    // Kept from the last training forward for backward
+    Vector batch_mean_;
+    Vector batch_inv_std_;
+    Matrix normalized_;             // Matrix-path cache: x_hat, then z if there is an activation
+    
+    // Per-chunk partial column statistics (fixed row chunks, so the result does
+    // not depend on the thread count)
+    std::vector<Accumulator> partials_;
+    std::vector<Scalar> coefficients_;
+    
+    void batch_statistics(const Scalar* input, Index rows, Index cols);
+    void column_gradient_sums(const Scalar* gradient, Index rows, Index cols);
+    // Parameter gradients and (unless null) the input gradient from dL/dz
+    void normalization_backward(const Scalar* delta, Scalar* input_gradient);
+
+public:
+    BatchNormLayer(int features, double momentum = 0.1, double epsilon = 1e-5,
+                   ActivationType activation = ActivationType::LINEAR);
+    
+    Matrix forward(const Matrix& input) override;
+    Matrix backward(const Matrix& gradient) override;
+    void initialize_weights(double std_dev = 0.01) override;
+    void collect_parameters(std::vector<ParameterView>& parameters) override;
+    // dims[0] = features, options = {momentum, epsilon}; state adds the running statistics
+    LayerConfig config() const override;
+    void collect_state(std::vector<ParameterView>& state) override;
+    
+    // The cache is x_hat (N x features), followed by the pre-activation output when
+    // there is an activation; the input itself is not needed again
+    bool supports_workspace(Index input_cols) const override { return input_cols == output_size_; }
+    Index workspace_cache_columns() const override {
+        return activation_ == ActivationType::LINEAR ? output_size_ : 2 * output_size_;
+    }
+    bool backward_reads_input() const override { return false; }
+    void forward_rows(const Scalar* input, Index rows, Index input_cols, Scalar* output, Scalar* cache) override;
+    void backward_rows(Scalar* gradient, Scalar* input_gradient) override;
+    
+    // Per-feature affine map equivalent to inference mode, before the activation
+    void inference_affine(Vector& scale, Vector& shift) const;
+    
+    const Vector& get_gamma() const { return gamma_; }
+    const Vector& get_beta() const { return beta_; }
+    const Vector& get_running_mean() const { return running_mean_; }
+    const Vector& get_running_var() const { return running_var_; }
+    const Vector& get_gamma_gradients() const { return gamma_gradients_; }
+    const Vector& get_beta_gradients() const { return beta_gradients_; }
+};
+
+// Softmax output layer with a fused cross-entropy loss (LayerType::ACTIVATION)
+//
+// forward() returns row-wise class probabilities and backward() is the exact softmax
+// Jacobian-vector product. In training, NeuralNetwork calls loss() on the logits
+// instead: the loss and the (p - y) / N logit gradient come out of one log-sum-exp
+// pass per row. Targets are probability rows or integer class labels, which are never
+// expanded to one-hot.
+class SoftmaxCrossEntropyLayer : public NeuralLayer {
+private:
+    Matrix logit_gradient_;
+    std::vector<Accumulator> partials_;     // Per-chunk losses, summed in chunk order
+
+public:
+    explicit SoftmaxCrossEntropyLayer(int classes);
+    
+    Matrix forward(const Matrix& logits) override;
+    Matrix backward(const Matrix& gradient) override;
+    
+    // Mean cross-entropy over the batch; also sets get_logit_gradient(). A targets
+    // matrix with one column (and more than one class) holds class labels.
+    double loss(const Matrix& logits, const Matrix& targets);
+    double loss(const Matrix& logits, const std::vector<int>& labels);
+    // Same over raw logit rows (output_size() wide), writing the gradient to caller
+    // storage; false (with a message) if the targets do not match
+    bool loss_rows(const Scalar* logits, Index rows, const Matrix& targets, Scalar* gradient, double& loss);
+    const Matrix& get_logit_gradient() const { return logit_gradient_; }
+};
+
+// Convolution Layer (LayerType::CONVOLUTIONAL)
+//
+// Each input row is one sample in NHWC order (height, width, channels, channels
+// fastest), and the output row is NHWC with out_channels channels. A 1D layer over a
+// (length, channels) series is height 1 with a 1 x k kernel. Weights are
+// out_channels x (kernel_h * kernel_w * in_channels), in the same (kh, kw, c) order
+// as an NHWC patch, so the im2col product is an NT gemm written straight into the
+// output. 3x3 stride-1 kernels use Winograd F(2x2, 3x3) in the forward pass.
+class ConvLayer : public NeuralLayer {
+private:
+    int in_channels_;
+    int out_channels_;
+    int input_h_;
+    int input_w_;
+    int kernel_h_;
+    int kernel_w_;
+    int stride_;
+    int padding_h_;                 // Zero padding; a dimension with kernel size 1 is not padded
+    int padding_w_;
+    int output_h_;
+    int output_w_;
+    bool use_winograd_ = true;
+    Matrix winograd_filters_;       // 16 x in_channels rows of out_channels, G g G^T
+
+    Index patch_size() const { return static_cast<Index>(kernel_h_) * kernel_w_ * in_channels_; }
+    Index output_pixels() const { return static_cast<Index>(output_h_) * output_w_; }
+    // Output pixels per im2col tile, sized so the column buffer stays cache resident
+    Index tile_pixels() const;
+    void im2col(const Scalar* sample, Index first_pixel, Index pixels, Scalar* columns) const;
+    void col2im_add(const Scalar* columns, Index first_pixel, Index pixels, Scalar* sample_gradient) const;
+    void forward_im2col(const Matrix& input, Matrix& output) const;
+    void forward_winograd(const Matrix& input, Matrix& output);
+
+public:
+    ConvLayer(int in_channels, int out_channels, int input_h, int input_w,
+              int kernel_h, int kernel_w, int stride = 1, int padding = 0,
+              ActivationType activation = ActivationType::RELU);
+    
+    // 1D convolution over a (length, in_channels) series
+    static std::unique_ptr<ConvLayer> conv1d(int in_channels, int out_channels, int length, int kernel,
+                                             int stride = 1, int padding = 0,
+                                             ActivationType activation = ActivationType::RELU);
+    
+    Matrix forward(const Matrix& input) override;
+    Matrix backward(const Matrix& gradient) override;
+    void initialize_weights(double std_dev = 0.01) override;
+    // dims = constructor arguments in order, options[0] = Winograd enabled
+    LayerConfig config() const override;
+    
+    bool winograd_applicable() const { return kernel_h_ == 3 && kernel_w_ == 3 && stride_ == 1; }
+    void set_winograd(bool enabled) { use_winograd_ = enabled; }
+    int get_output_height() const { return output_h_; }
+    int get_output_width() const { return output_w_; }
+    int get_out_channels() const { return out_channels_; }
+};
+
+// Recurrent layers (LayerType::LSTM, LayerType::GRU)
+//
+// Each input row is one sequence of sequence_length steps, input_features values per
+// step (time-major, like a 1D ConvLayer input), so the whole batch is an
+// (N * T) x input_features matrix and the input projection for every step is a
+// single gemm. The time loop then does one recurrent gemm per step plus one fused
+// pass over all gates. Output is every hidden state (N x T*H) or, without
+// return_sequences, the last one (N x H).
+class RecurrentLayer : public NeuralLayer {
+protected:
+    int input_features_;
+    int hidden_size_;
+    int sequence_length_;
+    int gates_;                     // 4 for LSTM, 3 for GRU
+    bool return_sequences_;
+    int truncate_steps_ = 0;        // Truncated BPTT window, 0 for full sequences
+    
+    Matrix recurrent_weights_;      // gates*H x H
+    Matrix recurrent_gradients_;
+    
+    // Workspace reused across batches (reallocated only when the batch grows)
+    Matrix gate_cache_;             // N x T*gates*H: input projections, then gate activations
+    Matrix state_cache_;            // N x (T+1)*H hidden states, h_0 = 0
+    Matrix gate_gradients_;         // N x T*gates*H pre-activation gradients
+    Matrix hidden_state_;           // N x H current h, contiguous for the recurrent gemm
+    Matrix hidden_gradient_;        // N x H gradient carried to the previous step
+    
+    Index gate_width() const { return static_cast<Index>(gates_) * hidden_size_; }
+    // gate_cache_ = X * W^T + b for all steps in one gemm; resets state_cache_
+    void project_inputs(const Matrix& input);
+    Matrix collect_output() const;
+    // Gradient with respect to h_t for every step, from the layer's output gradient
+    Matrix sequence_gradient(const Matrix& gradient) const;
+    // Weight, bias and input gradients from per-step pre-activation gradients on the
+    // input side (dx) and the recurrent side (dh); LSTM passes the same matrix twice
+    Matrix finish_backward(const Matrix& dx, const Matrix& dh);
+    bool truncate_after(Index t) const { return truncate_steps_ > 0 && t % truncate_steps_ == 0; }
 
 public:
-    DropoutLayer(double dropout_rate = 0.5);
+    RecurrentLayer(LayerType type, int input_features, int hidden_size, int sequence_length,
+                   int gates, bool return_sequences);
+    
+    void initialize_weights(double std_dev = 0.01) override;
+    void collect_parameters(std::vector<ParameterView>& parameters) override;
+    // dims = {input_features, hidden_size, sequence_length, return_sequences, truncation}
+    LayerConfig config() const override;
     
-    Eigen::MatrixXd forward(const Eigen::MatrixXd& input) override;
-    Eigen::MatrixXd backward(const Eigen::MatrixXd& gradient) override;
+    void set_truncation(int steps) { truncate_steps_ = std::max(steps, 0); }
+    int get_hidden_size() const { return hidden_size_; }
+    int get_sequence_length() const { return sequence_length_; }
+    const Matrix& get_recurrent_weights() const { return recurrent_weights_; }
+    const Matrix& get_recurrent_gradients() const { return recurrent_gradients_; }
+};
+
+// Gates (i, f, g, o): c = f * c_prev + i * g, h = o * tanh(c)
+class LSTMLayer : public RecurrentLayer {
+private:
+    Matrix cell_cache_;             // N x (T+1)*H cell states, c_0 = 0
+    Matrix cell_state_;             // N x H
+    Matrix cell_gradient_;          // N x H
+
+public:
+    LSTMLayer(int input_features, int hidden_size, int sequence_length, bool return_sequences = true);
+    
+    Matrix forward(const Matrix& input) override;
+    Matrix backward(const Matrix& gradient) override;
+    void initialize_weights(double std_dev = 0.01) override;
+};
+
+// Gates (r, z, n): n = tanh(x_n + r * (h W_n + b_n)), h = (1 - z) * n + z * h_prev
+class GRULayer : public RecurrentLayer {
+private:
+    Vector recurrent_biases_;       // Kept apart from the input bias: r gates the n part
+    Vector recurrent_bias_gradients_;
+    Matrix recurrent_cache_;        // N x T*H: h W_n + b_n per step, for dr
+    Matrix recurrent_projection_;   // N x 3H scratch for h W^T + b_h
+    Matrix recurrent_gate_gradients_;   // N x T*3H
+
+public:
+    GRULayer(int input_features, int hidden_size, int sequence_length, bool return_sequences = true);
+    
+    Matrix forward(const Matrix& input) override;
+    Matrix backward(const Matrix& gradient) override;
+    void initialize_weights(double std_dev = 0.01) override;
+    void collect_parameters(std::vector<ParameterView>& parameters) override;
+};
+
+// Int8 inference measured against the floating-point path on the same data
+struct QuantizationReport {
+    int layers = 0;                         // Dense layers running on int8
+    double reference_loss = 0.0;            // evaluate() without and with quantization
+    double quantized_loss = 0.0;
+    double max_output_error = 0.0;          // Largest |int8 - floating point| output
+    double top1_agreement = 1.0;            // Rows with the same arg-max output
+    double reference_rows_per_second = 0.0; // predict() throughput
+    double quantized_rows_per_second = 0.0;
 };
 
 // Neural Network
@@ -137,7 +541,34 @@ private:
     int batch_size_;
     int epochs_;
     std::function<double(const Matrix&, const Matrix&)> loss_function_;
-    std::function<Matrix(const Matrix&, const Matrix&)> loss_derivative_;
+    std::function<void(const Matrix&, const Matrix&, Matrix&)> loss_derivative_;   // Into the last argument
+    utils::RandomStream rng_;       // Batch shuffling
+    Optimizer optimizer_;
+    std::vector<ParameterView> parameters_;     // Refilled each step, capacity kept
+    
+    // Training workspace: every layer output, cache and gradient of one step, placed
+    // in a single arena by lifetime. Planned for the largest batch seen so far and
+    // rebuilt only when the layers or the input width change.
+    struct PlannedLayer {
+        NeuralLayer* layer;
+        Index input_cols;
+        Index output_cols;
+        int output;                 // Workspace tensor ids, -1 if none
+        int cache;
+        int gradient;
+    };
+    Workspace workspace_;
+    std::vector<PlannedLayer> plan_;        // Empty if some layer has no row kernel
+    Index planned_rows_ = 0;                // 0 = plan out of date
+    Index planned_cols_ = 0;
+    bool use_workspace_ = true;
+    Matrix output_;                         // Network output and its gradient when the
+    Matrix output_gradient_;                // loss is a callback rather than fused
+    Matrix batch_inputs_;                   // fit() batches, gathered in place
+    Matrix batch_targets_;
+    std::vector<int> order_;
+    bool quantized_ = false;
+    bool training_ = true;                  // predict() and evaluate() restore it
 
 public:
     NeuralNetwork(double learning_rate = 0.01, int batch_size = 32);
@@ -146,11 +577,38 @@ public:
     void add_layer(std::unique_ptr<NeuralLayer> layer);
     void add_dense_layer(int units, ActivationType activation = ActivationType::RELU);
     void add_dropout_layer(double rate = 0.5);
+    void add_batch_norm_layer(ActivationType activation = ActivationType::LINEAR,
+                              double momentum = 0.1, double epsilon = 1e-5);
+    // Softmax over the previous (LINEAR) layer's outputs, trained with fused cross-entropy.
+    // fit() then also accepts y as one column of class labels.
+    void add_softmax_cross_entropy_layer();
+    
+    // Inference graph optimization: each batch norm directly after a LINEAR dense
+    // layer is folded into that layer's weights and removed. Returns the number folded.
+    int fold_batch_norm();
+    size_t layer_count() const { return layers_.size(); }
+    
+    // Post-training int8 quantization for predict() and evaluate(). Each dense layer's
+    // input range is calibrated by running the sample set through the floating-point
+    // network; fold_batch_norm() first so batch norms are absorbed. The next parameter
+    // update drops the quantization. Returns the number of layers quantized.
+    int quantize(const Matrix& calibration);
+    void dequantize();
+    // Loss, output error and throughput of predict() with and without quantization on
+    // (X, y); the network stays quantized. Needs a quantized network.
+    QuantizationReport quantization_report(const Matrix& X, const Matrix& y);
     
     // Training
     void fit(const Matrix& X, const Matrix& y, int epochs = 100);
+    // Trains on the given rows of X and y only, read in place
+    void fit(const Matrix& X, const Matrix& y, const std::vector<int>& rows, int epochs = 100);
     Matrix predict(const Matrix& X);
     double evaluate(const Matrix& X, const Matrix& y);
+    // One optimizer step over every layer's parameters from the last backward pass
+    void update_parameters();
+    // Forward, backward and update on one batch; returns the batch loss. After the first
+    // call with the largest batch, steps allocate nothing on the workspace path.
+    double train_batch(const Matrix& inputs, const Matrix& targets);
     
     // Loss functions
     void set_loss_function(const std::string& loss_type);
@@ -159,22 +617,58 @@ public:
     static Matrix mse_derivative(const Matrix& y_true, const Matrix& y_pred);
     static Matrix cross_entropy_derivative(const Matrix& y_true, const Matrix& y_pred);
     
-    // Model persistence
+    // Model persistence (model_format.h): layer configs and tensors; loading rebuilds
+    // the layers and copies their tensors out of the mapped file
     bool save_model(const std::string& filepath);
     bool load_model(const std::string& filepath);
     
     // Configuration
-    void set_learning_rate(double lr) { learning_rate_ = lr; }
+    void set_learning_rate(double lr) { learning_rate_ = lr; optimizer_.set_learning_rate(lr); }
+    // Replaces the optimizer (and its state); its learning rate becomes the network's
+    void set_optimizer(const Optimizer& optimizer);
+    bool set_optimizer(const std::string& name);
+    Optimizer& get_optimizer() { return optimizer_; }
     void set_batch_size(int batch_size) { batch_size_ = batch_size; }
+    void set_seed(uint64_t seed) { rng_ = utils::RandomStream(seed); }
+    void set_training(bool training);
+    bool is_training() const { return training_; }
+    // The Matrix path (a fresh matrix per layer and step) is kept for comparison
+    void set_use_workspace(bool use_workspace) { use_workspace_ = use_workspace; }
+    size_t workspace_bytes() const { return workspace_.size() * sizeof(Scalar); }
+    // Without sharing between tensors whose lifetimes do not overlap
+    size_t workspace_unshared_bytes() const { return workspace_.unshared_size() * sizeof(Scalar); }
     
 private:
     Matrix forward_pass(const Matrix& input);
-    void backward_pass(const Matrix& input, const Matrix& target);
-    void update_parameters();
-    std::vector<std::pair<Matrix, Matrix>> create_batches(const Matrix& X, const Matrix& y);
+    // Forward and backward over one batch, leaving gradients in the layers; returns the loss
+    double backward_pass(const Matrix& input, const Matrix& target);
+    SoftmaxCrossEntropyLayer* fused_output() const;
+    // Output size of the last layer that sets one, the input size of the next
+    int output_width() const;
+    // Before training on cols features: a first dense layer added without an input
+    // size is rebuilt for cols, and layers whose weights are still all zero (which
+    // could never break their symmetry) are initialized
+    void prepare_layers(Index cols);
+    // False if the network has to run on the Matrix path
+    bool prepare_workspace(Index rows, Index cols);
+    void plan_workspace(Index rows, Index cols);
+    double planned_backward_pass(const Matrix& input, const Matrix& target);
+    // Rows order_[start, start + count) of source into batch
+    void gather_rows(const Matrix& source, Index start, Index count, Matrix& batch) const;
+};
+
+// Feature importance tallied per feature over every split as the trees grow: GAIN
+// is the total squared-error reduction, scaled over the features to sum to 1, and
+// SPLIT_COUNT the number of splits
+enum class ImportanceType {
+    GAIN,
+    SPLIT_COUNT
 };
 
 // Ensemble Methods
+//
+// Regression forest of bagged trees (0/1 labels give class probabilities). The
+// prediction is the mean over trees; trees are fitted concurrently.
 class RandomForest {
 private:
     int n_estimators_;
@@ -182,71 +676,197 @@ private:
     int min_samples_split_;
     int min_samples_leaf_;
     std::vector<std::unique_ptr<DecisionTree>> trees_;
-    std::mt19937 rng_;
+    utils::RandomStream rng_;       // Tree t draws from rng_.fork(t)
+    std::shared_ptr<const FeatureBins> bins_;
 
 public:
     RandomForest(int n_estimators = 100, int max_depth = 10, 
                 int min_samples_split = 2, int min_samples_leaf = 1);
     
     void fit(const Matrix& X, const Vector& y);
-    Vector predict(const Matrix& X);
-    double evaluate(const Matrix& X, const Vector& y);
+    // Bootstrap samples drawn from the given rows of X only
+    void fit(const Matrix& X, const Vector& y, const std::vector<int>& rows);
+    Vector predict(const Matrix& X) const;
+    double predict_row(const Scalar* x) const;
+    // Mean squared error (the Brier score for 0/1 labels)
+    double evaluate(const Matrix& X, const Vector& y) const;
+    
+    // Split gains or counts of every tree (see ImportanceType)
+    Vector get_feature_importance(ImportanceType type = ImportanceType::GAIN) const;
+    
+    // Model persistence (model_format.h): every tree's nodes in one section. A loaded
+    // forest predicts straight from the mapped file.
+    bool save_model(const std::string& filepath) const;
+    bool load_model(const std::string& filepath);
     
-    // Feature importance
-    Vector get_feature_importance() const;
+    size_t tree_count() const { return trees_.size(); }
+    const DecisionTree& get_tree(size_t index) const { return *trees_[index]; }
+    void set_seed(uint64_t seed) { rng_ = utils::RandomStream(seed); }
+    // Trees split on these bins when fit() gets the rows they were built from
+    void set_feature_bins(std::shared_ptr<const FeatureBins> bins) { bins_ = std::move(bins); }
     
 private:
-    std::vector<int> bootstrap_sample_indices(int n_samples);
+    std::vector<int> bootstrap_sample_indices(int n_samples, int tree_index) const;
+};
+
+// One node of a flattened tree, stored as-is in model files. Nodes are in preorder,
+// so a split's left child is the next node and only the right child is linked.
+struct TreeNode {
+    int32_t feature;                // Split feature, -1 for a leaf
+    int32_t right;                  // Index of the right child
+    double threshold;               // x[feature] <= threshold goes left
+    double value;                   // Mean target of the node's samples (the leaf output)
+    double weight;                  // Training samples reaching the node
+};
+
+static_assert(sizeof(TreeNode) == 32, "tree node layout");
+
+// Features quantized to at most 256 bins at the quantiles of a set of rows
+//
+// Built once and shared read-only by every tree fitted on those rows: a histogram
+// split search adds each node's targets into per-bin sums, one pass per feature,
+// instead of sorting the node's values. Splits fall on bin edges, which lie
+// between training values, so the trees still predict from raw features.
+class FeatureBins {
+private:
+    Index rows_ = 0;
+    Index cols_ = 0;
+    std::vector<uint8_t> codes_;                // Feature-major: feature f, row r at f * rows + r
+    std::vector<std::vector<double>> edges_;    // x <= edges_[f][b] exactly when its code <= b
+
+public:
+    static constexpr int kMaxBins = 256;
+
+    FeatureBins() = default;
+    explicit FeatureBins(const Matrix& X, int max_bins = kMaxBins);
+
+    Index rows() const { return rows_; }
+    Index cols() const { return cols_; }
+    const uint8_t* codes(Index feature) const { return codes_.data() + feature * rows_; }
+    int bin_count(Index feature) const { return static_cast<int>(edges_[static_cast<size_t>(feature)].size()) + 1; }
+    // Largest value of bins 0..bin
+    double edge(Index feature, int bin) const { return edges_[static_cast<size_t>(feature)][static_cast<size_t>(bin)]; }
+    size_t bytes() const;
 };
 
 // Decision Tree for Random Forest
+//
+// CART regression tree grown depth first by variance-reduction splits, exact or on
+// FeatureBins, stored as one flat node array. The nodes are either owned (after fit)
+// or a view into a mapped model file that the tree keeps alive.
 class DecisionTree {
 private:
-    struct Node {
-        bool is_leaf;
-        int feature_index;
-        double threshold;
-        double prediction;
-        std::unique_ptr<Node> left;
-        std::unique_ptr<Node> right;
-    };
-    
-    std::unique_ptr<Node> root_;
+    std::vector<TreeNode> nodes_;
+    const TreeNode* mapped_nodes_ = nullptr;
+    size_t mapped_count_ = 0;
+    std::shared_ptr<const MappedModel> mapping_;
     int max_depth_;
     int min_samples_split_;
     int min_samples_leaf_;
+    int n_features_ = 0;
+    std::vector<double> feature_gains_;     // Per feature: SSE reduction of its splits
+    std::vector<int> feature_splits_;
 
 public:
     DecisionTree(int max_depth = 10, int min_samples_split = 2, int min_samples_leaf = 1);
     
     void fit(const Matrix& X, const Vector& y);
-    Vector predict(const Matrix& X);
+    // Fits on the given rows of X (repeats allowed, as in a bootstrap sample)
+    void fit(const Matrix& X, const Vector& y, std::vector<int> rows);
+    // Histogram splits on binned rows; thresholds are bin edges
+    void fit(const FeatureBins& bins, const Vector& y);
+    void fit(const FeatureBins& bins, const Vector& y, std::vector<int> rows);
+    Vector predict(const Matrix& X) const;
+    double predict_row(const Scalar* x) const;
+    
+    const TreeNode* nodes() const { return mapping_ ? mapped_nodes_ : nodes_.data(); }
+    size_t node_count() const { return mapping_ ? mapped_count_ : nodes_.size(); }
+    int feature_count() const { return n_features_; }
+    // Per feature, tallied while growing (or on attach)
+    const std::vector<double>& feature_gains() const { return feature_gains_; }
+    const std::vector<int>& feature_splits() const { return feature_splits_; }
+    // Uses count nodes in place, keeping the mapping that holds them alive; false if
+    // the links or features do not form a valid tree
+    bool attach(const TreeNode* nodes, size_t count, int n_features, std::shared_ptr<const MappedModel> mapping);
+    
+    bool save_model(const std::string& filepath) const;
+    bool load_model(const std::string& filepath);
     
 private:
-    std::unique_ptr<Node> build_tree(const Matrix& X, const Vector& y, int depth);
-    double find_best_split(const Matrix& X, const Vector& y, int& best_feature, double& best_threshold);
-    double calculate_gini(const Vector& y);
-    double predict_single(const Vector& x, const Node* node);
+    // Appends the subtree over rows[0, count) in preorder and returns its root index
+    int32_t build_node(const Matrix& X, const Vector& y, int* rows, Index count, int depth);
+    // Largest squared-error reduction over all features, false if no split helps
+    bool find_best_split(const Matrix& X, const Vector& y, const int* rows, Index count,
+                         int& best_feature, double& best_threshold) const;
+    // The same over bin edges: rows with codes <= best_bin go left
+    int32_t build_binned_node(const FeatureBins& bins, const Vector& y, int* rows, Index count, int depth);
+    bool find_best_binned_split(const FeatureBins& bins, const Vector& y, const int* rows, Index count,
+                                int& best_feature, int& best_bin) const;
+    // Appends a leaf for the rows and returns its index; false in split if the node
+    // is too small or too deep to split
+    int32_t add_node(const Vector& y, const int* rows, Index count, int depth, bool& split);
+    // Adds the split at nodes[index], whose children are complete, to the tallies
+    void add_split_importance(const TreeNode* nodes, size_t index);
+    void reset(Index features);
 };
 
 // Gradient Boosting
+//
+// Squared-error boosting of DecisionTree regressors, each fitted to the residuals
+// with the tree's parallel split search. fit() keeps the ensemble's predictions for
+// the training (and validation) rows and adds only the new tree's leaf outputs each
+// round, so a round costs the same however many trees came before it.
 class GradientBoosting {
 private:
     int n_estimators_;
     double learning_rate_;
     int max_depth_;
     std::vector<std::unique_ptr<DecisionTree>> trees_;
-    Vector initial_prediction_;
+    Vector initial_prediction_;             // One element: the mean training target
+    int early_stopping_rounds_ = 0;
+    std::vector<double> validation_scores_;
+    std::shared_ptr<const FeatureBins> bins_;
 
 public:
     GradientBoosting(int n_estimators = 100, double learning_rate = 0.1, int max_depth = 3);
     
-    void fit(const Matrix& X, const Vector& y);
+    // With validation data, its MSE is recorded after every round; with early stopping
+    // on, fitting ends once it has not improved for that many rounds and the trees
+    // after the best round are dropped
+    void fit(const Matrix& X, const Vector& y, const Matrix& X_val = Matrix(), const Vector& y_val = Vector());
+    // Trains on the given rows of X only, read in place
+    void fit(const Matrix& X, const Vector& y, const std::vector<int>& rows);
     Vector predict(const Matrix& X);
+    double predict_row(const Scalar* x) const;
+    // Mean squared error
     double evaluate(const Matrix& X, const Vector& y);
     
+    // 0 disables early stopping
+    void set_early_stopping(int rounds) { early_stopping_rounds_ = std::max(rounds, 0); }
+    // Trees split on these bins when fit() gets the rows they were built from
+    void set_feature_bins(std::shared_ptr<const FeatureBins> bins) { bins_ = std::move(bins); }
+    const std::vector<double>& validation_scores() const { return validation_scores_; }
+    
+    // Split gains or counts of every tree, on the residuals each was fitted to
+    Vector get_feature_importance(ImportanceType type = ImportanceType::GAIN) const;
+    
+    // The prediction is base_prediction() + learning_rate() * the sum of the trees
+    size_t tree_count() const { return trees_.size(); }
+    const DecisionTree& get_tree(size_t index) const { return *trees_[index]; }
+    double learning_rate() const { return learning_rate_; }
+    double base_prediction() const { return initial_prediction_.size() > 0 ? initial_prediction_[0] : 0.0; }
+    
 private:
-    Vector calculate_gradients(const Vector& y_true, const Vector& y_pred);
+    // Negative gradient of the squared error, y_true - y_pred, into gradients
+    void calculate_gradients(const Vector& y_true, const Vector& y_pred, Vector& gradients) const;
+    // rows (null for all rows) of X: the rows trained on and whose predictions are kept
+    void fit_rows(const Matrix& X, const Vector& y, const std::vector<int>* rows, const Matrix& X_val,
+                  const Vector& y_val);
+    // predictions += learning_rate * tree(X), over rows (null for all rows)
+    void add_tree_output(const DecisionTree& tree, const Matrix& X, Vector& predictions,
+                         const std::vector<int>* rows = nullptr) const;
+    // Residuals are left in residuals
+    double mean_squared_error(const Vector& y_true, const Vector& predictions, Vector& residuals) const;
 };
 
 // XGBoost-style Gradient Boosting
@@ -276,7 +896,7 @@ public:
     void fit(const Matrix& X, const Vector& y, const Matrix& X_val = Matrix(), const Vector& y_val = Vector());
     Vector predict(const Matrix& X);
     double evaluate(const Matrix& X, const Vector& y);
-    Vector get_feature_importance() const;
+    Vector get_feature_importance(ImportanceType type = ImportanceType::GAIN) const;
     
     // Hyperparameter setters
     void set_early_stopping(bool enable, int rounds = 10);
@@ -322,7 +942,7 @@ public:
     void fit(const Matrix& X, const Vector& y);
     Vector predict(const Matrix& X);
     double evaluate(const Matrix& X, const Vector& y);
-    Vector get_feature_importance() const;
+    Vector get_feature_importance(ImportanceType type = ImportanceType::GAIN) const;
     
     // Advanced features
     void set_categorical_features(const std::vector<int>& categorical_features);
@@ -360,7 +980,7 @@ public:
     void fit(const Matrix& X, const Vector& y, const std::vector<int>& categorical_features = {});
     Vector predict(const Matrix& X);
     double evaluate(const Matrix& X, const Vector& y);
-    Vector get_feature_importance() const;
+    Vector get_feature_importance(ImportanceType type = ImportanceType::GAIN) const;
     
     // CatBoost specific features
     void set_categorical_features(const std::vector<int>& categorical_features);
@@ -404,6 +1024,7 @@ private:
     Matrix components_;
     Vector explained_variance_;
     Vector mean_;
+    double total_variance_ = 0.0;
     bool fitted_;
 
 public:
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "../utils/types.h"
+#include "../utils/random.h"
+#include "advanced_algorithms.h"
+#include "logistic_regression.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace dds {
+namespace algorithms {
+
+// Row indices of one fold, each list sorted
+struct Fold {
+    std::vector<int> train;
+    std::vector<int> validation;
+};
+
+// Rows 0..rows-1 in folds contiguous blocks, after a shuffle unless shuffle is false.
+// Empty (with a message) unless 2 <= folds <= rows.
+std::vector<Fold> kfold_split(int rows, int folds, bool shuffle = true,
+                              uint64_t seed = utils::RandomStream::kDefaultSeed);
+// Each label value's rows are shuffled and dealt round robin over the folds, so every
+// fold keeps the label proportions to within one row per label
+std::vector<Fold> stratified_kfold_split(const Vector& labels, int folds,
+                                         uint64_t seed = utils::RandomStream::kDefaultSeed);
+// Rows with the same group value always share a fold. Groups are placed largest first
+// into the fold with the fewest rows; empty (with a message) with fewer groups than folds.
+std::vector<Fold> group_kfold_split(const Vector& groups, int folds);
+
+// One fold over the full training matrix. Models with row-list training read the
+// fold's rows of X and y in place; the others take gathered copies, built on first
+// use and counted by copied_bytes().
+class FoldView {
+private:
+    const Matrix& X_;
+    const Vector& y_;
+    const Fold& fold_;
+    int index_;
+    int epochs_;
+    mutable Matrix train_features_;
+    mutable Vector train_targets_;
+    mutable Matrix validation_features_;
+    mutable Vector validation_targets_;
+    mutable bool train_gathered_ = false;
+    mutable bool validation_gathered_ = false;
+    mutable size_t copied_bytes_ = 0;
+
+public:
+    FoldView(const Matrix& X, const Vector& y, const Fold& fold, int index, int epochs)
+        : X_(X), y_(y), fold_(fold), index_(index), epochs_(epochs) {}
+
+    const Matrix& features() const { return X_; }
+    const Vector& targets() const { return y_; }
+    const std::vector<int>& train_rows() const { return fold_.train; }
+    const std::vector<int>& validation_rows() const { return fold_.validation; }
+    int index() const { return index_; }
+    // Training epochs for the neural models
+    int epochs() const { return epochs_; }
+
+    const Matrix& train_features() const;
+    const Vector& train_targets() const;
+    const Matrix& validation_features() const;
+    const Vector& validation_targets() const;
+    // Bytes of features and targets copied for this fold
+    size_t copied_bytes() const { return copied_bytes_; }
+    void add_copied_bytes(size_t bytes) const { copied_bytes_ += bytes; }
+
+private:
+    void gather_train() const;
+    void gather_validation() const;
+};
+
+// Trains model on the fold's training rows and returns its validation loss (lower is
+// better). Trees, forests and boosting score MSE, logistic regression its mean
+// log-loss and neural networks their loss, all reading the rows in place; PCA and
+// Autoencoder score the reconstruction MSE of gathered copies. Any other model with
+// fit(X, y) and evaluate(X, y) is trained and scored on gathered copies.
+double fit_and_score(DecisionTree& model, const FoldView& fold);
+double fit_and_score(RandomForest& model, const FoldView& fold);
+double fit_and_score(GradientBoosting& model, const FoldView& fold);
+double fit_and_score(LogisticRegression& model, const FoldView& fold);
+double fit_and_score(NeuralNetwork& model, const FoldView& fold);
+double fit_and_score(PCA& model, const FoldView& fold);
+double fit_and_score(Autoencoder& model, const FoldView& fold);
+
+template<typename Model>
+double fit_and_score(Model& model, const FoldView& fold) {
+    model.fit(fold.train_features(), fold.train_targets());
+    return model.evaluate(fold.validation_features(), fold.validation_targets());
+}
+
+enum class FoldParallelism {
+    AUTO,                           // FOLDS when there are at least as many folds as workers
+    FOLDS,                          // Folds run concurrently, each model's kernels inline
+    MODEL                           // Folds run in turn, each model's kernels on the pool
+};
+
+// Mean, sample standard deviation and a 95% Student t interval for the mean. Fold
+// scores share most of their training rows, so the interval treats correlated scores
+// as independent and is narrower than it should be; use it to compare models, not as
+// a coverage guarantee.
+struct MetricSummary {
+    double mean = 0.0;
+    double stddev = 0.0;
+    double ci_low = 0.0;
+    double ci_high = 0.0;
+};
+
+MetricSummary summarize(const std::vector<double>& values);
+
+struct CrossValidationReport {
+    std::vector<double> fold_scores;
+    std::vector<double> fold_seconds;
+    MetricSummary score;
+    MetricSummary seconds;
+    size_t copied_bytes = 0;        // Over every fold
+    double total_seconds = 0.0;
+    bool folds_concurrent = false;
+};
+
+// K-fold cross-validation over fold index lists
+//
+// Every fold reads the same X and y. Folds and the model kernels share the one thread
+// pool, so only one level runs in parallel: with FOLDS each fold trains on its own
+// worker and the kernels inside it run inline; with MODEL the folds train in turn and
+// each model spreads over the pool. Either way there are never more busy threads than
+// workers.
+class CrossValidator {
+private:
+    std::vector<Fold> folds_;
+    FoldParallelism parallelism_;
+    int epochs_ = 100;
+
+public:
+    explicit CrossValidator(std::vector<Fold> folds, FoldParallelism parallelism = FoldParallelism::AUTO)
+        : folds_(std::move(folds)), parallelism_(parallelism) {}
+
+    void set_epochs(int epochs) { epochs_ = std::max(epochs, 1); }
+    const std::vector<Fold>& folds() const { return folds_; }
+
+    // make() returns a fresh untrained model in a std::unique_ptr, such as one of the
+    // ModelFactory::create_* calls. All models are made up front, in fold order, so
+    // make() need not be thread safe; each is released after its fold is scored.
+    template<typename Make>
+    CrossValidationReport run(Make make, const Matrix& X, const Vector& y) const {
+        using Model = typename decltype(make())::element_type;
+        std::vector<std::unique_ptr<Model>> models;
+        models.reserve(folds_.size());
+        for (size_t f = 0; f < folds_.size(); ++f) models.push_back(make());
+        return run_folds(X, y, [&models](const FoldView& fold) {
+            auto& model = models[static_cast<size_t>(fold.index())];
+            const double score = fit_and_score(*model, fold);
+            model.reset();
+            return score;
+        });
+    }
+
+    // Runs score once per fold; empty (with a message) if a fold does not fit X and y
+    CrossValidationReport run_folds(const Matrix& X, const Vector& y,
+                                    const std::function<double(const FoldView&)>& score) const;
+};
+
+} // namespace algorithms
+} // namespace dds
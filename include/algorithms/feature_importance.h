@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../utils/types.h"
+#include "../utils/random.h"
+#include "advanced_algorithms.h"
+#include <functional>
+#include <vector>
+
+namespace dds {
+namespace algorithms {
+
+// Predictions for count consecutive rows of a row-major block with cols features.
+// The predictors below read the model in place, so it must outlive them.
+using BlockPredictor = std::function<void(const Scalar* rows, Index count, Index cols, double* out)>;
+
+BlockPredictor block_predictor(const DecisionTree& tree);
+BlockPredictor block_predictor(const RandomForest& forest);
+BlockPredictor block_predictor(const GradientBoosting& model);
+
+struct PermutationImportance {
+    Vector mean;                    // Per feature: mean increase of the MSE over the repeats
+    Vector stddev;                  // Sample standard deviation over the repeats
+    double baseline_loss = 0.0;     // MSE with no feature permuted
+};
+
+// Permutation importance: how much the MSE on (X, y) grows when one feature's column
+// is shuffled, averaged over repeats shuffles
+//
+// Each (feature, repeat) pair is one task on the pool and draws its own permutation,
+// so the result does not depend on the thread count. A task reads row r's shuffled
+// value as X(perm[r], feature) and predicts a block of rows at a time from a small
+// per-thread buffer; X itself is never copied or written.
+PermutationImportance permutation_importance(const BlockPredictor& predict, const Matrix& X, const Vector& y,
+                                             int repeats = 5, uint64_t seed = utils::RandomStream::kDefaultSeed);
+
+// The same for a fitted model; empty (with a message) if X has other features
+PermutationImportance permutation_importance(const DecisionTree& tree, const Matrix& X, const Vector& y,
+                                             int repeats = 5, uint64_t seed = utils::RandomStream::kDefaultSeed);
+PermutationImportance permutation_importance(const RandomForest& forest, const Matrix& X, const Vector& y,
+                                             int repeats = 5, uint64_t seed = utils::RandomStream::kDefaultSeed);
+PermutationImportance permutation_importance(const GradientBoosting& model, const Matrix& X, const Vector& y,
+                                             int repeats = 5, uint64_t seed = utils::RandomStream::kDefaultSeed);
+
+// Path-dependent TreeSHAP over flattened trees
+//
+// Every root-to-leaf path is flattened once into its distinct features, each with the
+// interval of values that follows the path and the fraction of training samples that
+// follow it (the product of the cover ratios of its splits). A leaf adds to a feature's
+// SHAP value an amount that depends only on which of its path features the row falls
+// inside, so for paths with up to kTableFeatures features the amounts are tabulated
+// for every such pattern and a row costs one interval test and one add per path
+// feature. Longer paths are solved per row by dividing one polynomial per feature out
+// of the path's product, O(depth^2) per leaf. A row costs O(leaves * depth) overall
+// for shallow trees, independent of the number of training samples.
+//
+// The values sum to the prediction minus expected_value(), the cover-weighted mean
+// prediction.
+class TreeExplainer {
+public:
+    static constexpr int kTableFeatures = 8;
+
+    explicit TreeExplainer(const DecisionTree& tree);
+    explicit TreeExplainer(const RandomForest& forest);
+    explicit TreeExplainer(const GradientBoosting& model);
+
+    // Rows x features
+    Matrix shap_values(const Matrix& X) const;
+    double expected_value() const { return expected_value_; }
+    Index feature_count() const { return features_; }
+    size_t path_count() const { return paths_.size(); }
+
+private:
+    struct Condition {
+        int32_t feature;
+        double low;                 // The path needs low < x <= high
+        double high;
+        double zero_fraction;       // Share of the training samples that follow the path
+    };
+
+    struct Path {
+        uint32_t first;             // Into conditions_
+        uint32_t count;
+        double value;               // Leaf output times the tree's weight in the model
+        int64_t table;              // Into tables_, -1 when solved per row
+    };
+
+    Index features_ = 0;
+    double expected_value_ = 0.0;
+    std::vector<Condition> conditions_;
+    std::vector<Path> paths_;
+    std::vector<double> tables_;    // Per pattern: one amount per path feature
+
+    void add_tree(const DecisionTree& tree, double weight);
+};
+
+} // namespace algorithms
+} // namespace dds
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "../utils/types.h"
+#include "../utils/random.h"
+#include "../database/database_manager.h"
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dds {
+namespace algorithms {
+
+class FeatureBins;
+
+// Hyperparameter values by name
+using HyperParameters = std::map<std::string, double>;
+
+// The named value of parameters, or fallback when it is not set
+double get_parameter(const HyperParameters& parameters, const std::string& name, double fallback);
+
+// Named dimensions to search over: listed values, or a range sampled uniformly
+// (log-uniformly for log_scale) and rounded for integer ranges. A grid takes every
+// listed value and points_per_range evenly spaced points of each range.
+class SearchSpace {
+public:
+    struct Dimension {
+        std::string name;
+        std::vector<double> values;     // Empty for a range
+        double low = 0.0;
+        double high = 0.0;
+        bool log_scale = false;
+        bool integer = false;
+    };
+
+private:
+    std::vector<Dimension> dimensions_;
+
+public:
+    void add_choice(const std::string& name, std::vector<double> values);
+    void add_range(const std::string& name, double low, double high, bool log_scale = false);
+    void add_int_range(const std::string& name, int low, int high);
+
+    const std::vector<Dimension>& dimensions() const { return dimensions_; }
+    HyperParameters sample(utils::RandomStream& rng) const;
+    // Every combination, the last dimension varying fastest
+    std::vector<HyperParameters> grid(int points_per_range) const;
+};
+
+// Training and validation rows of a search, held once and read in place by every
+// trial. The training rows' FeatureBins are built on first use and shared by every
+// tree trial; call feature_bins() before a search to build them on the whole pool
+// rather than inside the first trial.
+class TuningData {
+private:
+    Matrix train_features_;
+    Vector train_targets_;
+    Matrix validation_features_;
+    Vector validation_targets_;
+    mutable std::once_flag bins_once_;
+    mutable std::shared_ptr<const FeatureBins> bins_;
+
+public:
+    // Holds out a random validation_fraction of the rows
+    TuningData(const Matrix& X, const Vector& y, double validation_fraction = 0.2,
+               uint64_t seed = utils::RandomStream::kDefaultSeed);
+    TuningData(Matrix X_train, Vector y_train, Matrix X_val, Vector y_val);
+    TuningData(const TuningData&) = delete;
+    TuningData& operator=(const TuningData&) = delete;
+
+    const Matrix& train_features() const { return train_features_; }
+    const Vector& train_targets() const { return train_targets_; }
+    const Matrix& validation_features() const { return validation_features_; }
+    const Vector& validation_targets() const { return validation_targets_; }
+    std::shared_ptr<const FeatureBins> feature_bins() const;
+};
+
+// Validation loss (lower is better) of one configuration trained with the given
+// budget: trees, epochs or iterations, as the objective defines it
+using TrialObjective = std::function<double(const HyperParameters& parameters, int budget, const TuningData& data)>;
+
+// Built-in objectives; parameters that are not set keep the model's defaults.
+// learning_rate, max_depth; budget = trees; validation MSE
+TrialObjective gradient_boosting_objective();
+// max_depth, min_samples_leaf; budget = trees; validation MSE
+TrialObjective random_forest_objective();
+// regularization_strength, l1 (1 for an L1 penalty); budget = iterations; validation log-loss
+TrialObjective logistic_regression_objective();
+
+enum class SearchStrategy {
+    GRID,
+    RANDOM,
+    ASHA,                           // Asynchronous successive halving
+    HYPERBAND                       // ASHA brackets with different starting budgets
+};
+
+struct TrialResult {
+    int id;                         // Configuration index
+    HyperParameters parameters;
+    int bracket;
+    int rung;                       // Last rung evaluated, 0 without successive halving
+    int budget;                     // Budget of the last evaluation
+    double score;                   // Validation loss at that budget
+    double seconds;                 // Training time over all evaluations
+    bool stopped;                   // Not promoted to the top rung
+};
+
+// Hyperparameter search over one TuningData
+//
+// Trials run concurrently on the shared thread pool, one per worker, and the model
+// kernels inside a trial run inline, so the pool is never oversubscribed. GRID and
+// RANDOM train every configuration with the largest budget. ASHA starts each
+// configuration with the smallest budget, and budgets grow eta times per rung. A
+// configuration moves up a rung once it ranks in the top 1/eta of the results
+// reported on its rung, so losing configurations stop after a fraction of the
+// budget. A worker with nothing to promote starts a new configuration instead of
+// waiting for a rung to fill. HYPERBAND deals configurations round robin to ASHA
+// brackets whose smallest budgets grow by eta, hedging against a smallest budget
+// that is too small to rank configurations. A promoted configuration is trained
+// again from scratch with the larger budget.
+//
+// With a database set, run() adds the search to the experiments table as running,
+// adds a record per trial when it ends and then marks the search completed.
+class HyperparameterSearch {
+private:
+    SearchSpace space_;
+    TrialObjective objective_;
+    SearchStrategy strategy_;
+    int trials_ = 20;
+    int min_budget_ = 1;
+    int max_budget_ = 100;
+    int eta_ = 3;
+    int brackets_ = 3;
+    int grid_points_ = 3;
+    uint64_t seed_ = utils::RandomStream::kDefaultSeed;
+    std::shared_ptr<database::DatabaseManager> database_;
+    std::string name_ = "hyperparameter_search";
+    std::vector<TrialResult> results_;
+    int best_ = -1;
+    long long budget_used_ = 0;
+    double seconds_ = 0.0;
+
+public:
+    HyperparameterSearch(SearchSpace space, TrialObjective objective, SearchStrategy strategy = SearchStrategy::RANDOM);
+
+    // Configurations sampled by RANDOM, ASHA and HYPERBAND
+    void set_trials(int trials) { trials_ = std::max(trials, 1); }
+    // Budgets of the first and top rungs and the growth between rungs; GRID and RANDOM
+    // use max_budget
+    void set_budget(int min_budget, int max_budget, int eta = 3);
+    // HYPERBAND brackets, limited by the number of rungs
+    void set_brackets(int brackets) { brackets_ = std::max(brackets, 1); }
+    void set_grid_points(int points) { grid_points_ = std::max(points, 1); }
+    void set_seed(uint64_t seed) { seed_ = seed; }
+    void set_experiment_database(std::shared_ptr<database::DatabaseManager> database, const std::string& name);
+
+    // False (with a message) if no configuration could be evaluated
+    bool run(const TuningData& data);
+
+    // One per configuration, by id
+    const std::vector<TrialResult>& results() const { return results_; }
+    // Lowest score among the configurations that reached the highest budget; null
+    // before a successful run
+    const TrialResult* best() const { return best_ >= 0 ? &results_[static_cast<size_t>(best_)] : nullptr; }
+    // Sum of the budgets of every evaluation in the last run
+    long long budget_used() const { return budget_used_; }
+    double seconds() const { return seconds_; }
+
+private:
+    void run_full_budget(const TuningData& data);
+    void run_successive_halving(const TuningData& data, int brackets);
+    // Trains one configuration, adding the time to its result; NaN scores become +inf
+    double evaluate(const TuningData& data, int id, int budget);
+    void record_start() const;
+    void record_results() const;
+};
+
+} // namespace algorithms
+} // namespace dds
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "../utils/types.h"
+#include <vector>
+
+namespace dds {
+namespace algorithms {
+
+enum class LogisticPenalty {
+    L2,
+    L1
+};
+
+enum class LogisticSolver {
+    AUTO,                           // Coordinate descent for L1, L-BFGS otherwise
+    LBFGS,
+    COORDINATE_DESCENT
+};
+
+// Logistic regression over dense or CSR sparse features
+//
+// Minimizes the mean log-loss plus, with params.use_regularization, strength times
+// ||W||^2 / 2 (L2) or ||W||_1 (L1); biases are not penalized. Labels are class
+// indices 0..num_classes-1 (num_classes <= 0 takes the largest label + 1). Two
+// classes keep one weight row for class 1, more keep one row per class.
+//
+// L-BFGS updates all coefficients at once and fits unpenalized and L2 problems,
+// softmax for more than two classes. Each loss and gradient evaluation is one pass
+// over the rows, split into a partition per worker with its own gradient buffer.
+//
+// Cyclic coordinate descent fits L1 problems, one versus rest for more than two
+// classes. It takes a Newton step per coefficient with soft thresholding and a
+// backtracking line search, keeping the margins X w up to date, so a coefficient
+// costs a few passes over its column; long columns are summed in fixed chunks on
+// the pool. Passes cycle over the active set (nonzero coefficients) until it
+// settles, then over every column; a full pass that moves no coefficient by more
+// than the tolerance ends the fit. Columns come from a CSC copy of sparse input or
+// a transposed copy of dense input.
+//
+// params.learning_rate is not used: both solvers choose their own step sizes.
+class LogisticRegression {
+private:
+    LogisticRegressionParams params_;
+    LogisticPenalty penalty_;
+    LogisticSolver solver_;
+    int history_ = 10;              // L-BFGS correction pairs
+    bool warm_start_ = false;
+    bool one_vs_rest_ = false;
+    int iterations_ = 0;
+    bool converged_ = false;
+
+public:
+    LogisticRegression();
+    explicit LogisticRegression(const LogisticRegressionParams& params, LogisticPenalty penalty = LogisticPenalty::L2,
+                                LogisticSolver solver = LogisticSolver::AUTO);
+
+    // False (with a message) if the labels or shapes do not fit
+    bool fit(const Matrix& X, const Vector& y);
+    bool fit(const SparseMatrixCSR& X, const Vector& y);
+    // Fits the given rows of X only, read in place
+    bool fit(const Matrix& X, const Vector& y, const std::vector<int>& rows);
+
+    // Fits once per regularization strength, in the given order (usually decreasing),
+    // each fit warm-started from the previous solution; returns the coefficients of
+    // each. The model keeps the last fit.
+    std::vector<LogisticRegressionParams> fit_path(const Matrix& X, const Vector& y,
+                                                   const std::vector<double>& strengths);
+    std::vector<LogisticRegressionParams> fit_path(const SparseMatrixCSR& X, const Vector& y,
+                                                   const std::vector<double>& strengths);
+
+    // Rows x classes
+    Matrix predict_proba(const Matrix& X) const;
+    Matrix predict_proba(const SparseMatrixCSR& X) const;
+    // Most probable class per row
+    Vector predict(const Matrix& X) const;
+    Vector predict(const SparseMatrixCSR& X) const;
+    // Mean log-loss, without the penalty
+    double evaluate(const Matrix& X, const Vector& y) const;
+    double evaluate(const SparseMatrixCSR& X, const Vector& y) const;
+    double evaluate(const Matrix& X, const Vector& y, const std::vector<int>& rows) const;
+
+    // Start the next fit from the current coefficients when their shape matches
+    void set_warm_start(bool warm_start) { warm_start_ = warm_start; }
+    void set_history(int pairs) { history_ = pairs > 0 ? pairs : 1; }
+    void set_penalty(LogisticPenalty penalty) { penalty_ = penalty; }
+    void set_solver(LogisticSolver solver) { solver_ = solver; }
+
+    const LogisticRegressionParams& params() const { return params_; }
+    // L-BFGS iterations or coordinate descent passes of the last fit
+    int iterations() const { return iterations_; }
+    bool converged() const { return converged_; }
+
+private:
+    template<typename Rows>
+    bool fit_rows(const Rows& rows, const Vector& y);
+    template<typename Rows>
+    std::vector<LogisticRegressionParams> fit_path_rows(const Rows& rows, const Vector& y,
+                                                        const std::vector<double>& strengths);
+    template<typename Rows>
+    Matrix probabilities(const Rows& rows) const;
+    bool check_labels(const Vector& y, Index rows, int& classes) const;
+};
+
+} // namespace algorithms
+} // namespace dds
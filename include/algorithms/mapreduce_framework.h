@@ -60,8 +60,8 @@ struct MapReduceJobResult {
     std::string error_message;
     
     // Algorithm-specific results
-    Eigen::VectorXd coefficients;  // For linear regression
-    Eigen::MatrixXd centroids;     // For clustering
+    Vector coefficients;  // For linear regression
+    Matrix centroids;     // For clustering
     std::vector<int> cluster_labels;
     double accuracy;
     double loss;
@@ -112,9 +112,9 @@ private:
 // Distributed Linear Regression using MapReduce
 class DistributedLinearRegression : public MapReduceAlgorithm {
 private:
-    Eigen::MatrixXd training_data_;
-    Eigen::VectorXd labels_;
-    Eigen::VectorXd coefficients_;
+    Matrix training_data_;
+    Vector labels_;
+    Vector coefficients_;
     double intercept_;
     double final_loss_;
 
@@ -130,10 +130,10 @@ public:
     bool collect_results() override;
     
     // Linear regression specific methods
-    bool fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y);
-    Eigen::VectorXd predict(const Eigen::MatrixXd& X) const;
+    bool fit(const Matrix& X, const Vector& y);
+    Vector predict(const Matrix& X) const;
     double get_loss() const { return final_loss_; }
-    Eigen::VectorXd get_coefficients() const { return coefficients_; }
+    Vector get_coefficients() const { return coefficients_; }
     double get_intercept() const { return intercept_; }
     
     // MapReduce code generation
@@ -149,8 +149,8 @@ private:
 // Distributed K-Means Clustering using MapReduce
 class DistributedKMeans : public MapReduceAlgorithm {
 private:
-    Eigen::MatrixXd data_;
-    Eigen::MatrixXd centroids_;
+    Matrix data_;
+    Matrix centroids_;
     std::vector<int> cluster_labels_;
     double final_inertia_;
 
@@ -166,9 +166,9 @@ public:
     bool collect_results() override;
     
     // K-means specific methods
-    bool fit(const Eigen::MatrixXd& data);
-    std::vector<int> predict(const Eigen::MatrixXd& data) const;
-    Eigen::MatrixXd get_centroids() const { return centroids_; }
+    bool fit(const Matrix& data);
+    std::vector<int> predict(const Matrix& data) const;
+    Matrix get_centroids() const { return centroids_; }
     double get_inertia() const { return final_inertia_; }
     
     // MapReduce code generation
@@ -179,7 +179,7 @@ public:
 private:
     bool generate_clustering_data();
     bool parse_centroids();
-    Eigen::MatrixXd initialize_centroids(const Eigen::MatrixXd& data, int k);
+    Matrix initialize_centroids(const Matrix& data, int k);
 };
 
 // MapReduce job scheduler
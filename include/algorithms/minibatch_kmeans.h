@@ -0,0 +1,90 @@
+#pragma once
+
+#include "../utils/types.h"
+#include "../utils/random.h"
+#include "../storage/hadoop_storage.h"
+#include <vector>
+
+namespace dds {
+namespace algorithms {
+
+// Mini-batch k-means for data streamed from storage or arriving online
+//
+// Each batch assigns its rows to the nearest centroid and moves every centroid
+// towards the mean of its rows with a per-center learning rate of (rows this batch) /
+// (rows ever assigned), so a centroid is the running mean of the rows it has taken.
+// Only the centroids, their counts, the current batch and a bounded held-out sample
+// are kept in memory. The first batch seeds the centroids by k-means++.
+//
+// fit() holds rows out of training by a hash of their position in the data, so a
+// pass over the same files holds out the same rows. Every check_every batches it
+// compares the held-out inertia of the centroids with the inertia of the centroids
+// from the previous check, both on the current sample; patience checks in a row
+// that improve by less than tolerance (relative) end the fit.
+class MiniBatchKMeans {
+private:
+    int k_;
+    Index batch_size_;
+    int max_epochs_ = 10;
+    double tolerance_ = 1e-4;
+    int patience_ = 3;
+    int check_every_ = 10;
+    double holdout_fraction_ = 0.01;
+    Index max_holdout_rows_ = 10000;
+    uint64_t seed_;
+
+    Matrix centroids_;
+    std::vector<double> counts_;    // Rows assigned to each centroid so far
+    long long batches_ = 0;
+    std::vector<Scalar> holdout_;   // Held-out rows, row-major
+    Index holdout_rows_ = 0;
+    Index selected_ = 0;            // Rows picked for the holdout this pass
+    Matrix checkpoint_;             // Centroids at the previous check
+    std::vector<double> holdout_inertia_;
+    int stalled_checks_ = 0;
+    bool converged_ = false;
+
+public:
+    explicit MiniBatchKMeans(int k, Index batch_size = 1024, uint64_t seed = utils::RandomStream::kDefaultSeed);
+
+    void set_max_epochs(int epochs) { max_epochs_ = std::max(epochs, 1); }
+    void set_tolerance(double tolerance) { tolerance_ = tolerance; }
+    void set_patience(int checks) { patience_ = std::max(checks, 1); }
+    void set_check_every(int batches) { check_every_ = std::max(batches, 1); }
+    // Share of the rows held out, up to max_rows of them
+    void set_holdout(double fraction, Index max_rows);
+
+    // One online update; false (with a message) if the columns do not match or the
+    // first batch has fewer than k rows
+    bool partial_fit(const Matrix& batch);
+    // Streams up to max_epochs passes over the files, or fewer once converged
+    bool fit(storage::DatasetStream& stream);
+    // The same over rows in memory, a shuffled pass per epoch
+    bool fit(const Matrix& X);
+
+    std::vector<int> predict(const Matrix& X) const;
+    // Mean squared distance to the nearest centroid
+    double inertia(const Matrix& X) const;
+
+    const Matrix& centroids() const { return centroids_; }
+    const std::vector<double>& counts() const { return counts_; }
+    long long batches() const { return batches_; }
+    // Held-out inertia at each check of the last fit
+    const std::vector<double>& holdout_inertia() const { return holdout_inertia_; }
+    Index holdout_rows() const { return holdout_rows_; }
+    bool converged() const { return converged_; }
+
+private:
+    void reset_fit();
+    // Whether the row at this position of the data is held out; call once per row in
+    // order, from the first row of each pass
+    bool held_out(uint64_t position);
+    // partial_fit, then a convergence check when one is due
+    bool train_batch(const Matrix& batch);
+    void initialize(const Matrix& batch);
+    void update(const Matrix& batch);
+    void check_convergence();
+};
+
+} // namespace algorithms
+} // namespace dds
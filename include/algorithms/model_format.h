@@ -0,0 +1,129 @@
+#pragma once
+
+#include "../utils/types.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dds {
+namespace algorithms {
+
+// Versioned binary model files, loaded by mapping them read-only
+//
+// A file is a 32-byte header, a table of sections, then each section's payload at a
+// 64-byte aligned offset. Payloads are arrays of trivially copyable records in the
+// writer's byte order (little-endian on every target we build for) and Scalar type,
+// so a loader uses them in place with no parsing: tree nodes are read straight from
+// the mapping, and every process serving the same file shares its physical pages.
+// Files are written under a temporary name and renamed over the target, so a server
+// that still maps the previous version keeps a consistent view of it.
+
+enum class ModelKind : uint32_t {
+    NEURAL_NETWORK = 1,
+    DECISION_TREE = 2,
+    RANDOM_FOREST = 3
+};
+
+constexpr uint32_t kModelFormatVersion = 1;
+constexpr size_t kModelSectionAlignment = 64;
+
+constexpr uint32_t model_section_tag(const char (&name)[5]) {
+    return static_cast<uint32_t>(static_cast<unsigned char>(name[0])) |
+           static_cast<uint32_t>(static_cast<unsigned char>(name[1])) << 8 |
+           static_cast<uint32_t>(static_cast<unsigned char>(name[2])) << 16 |
+           static_cast<uint32_t>(static_cast<unsigned char>(name[3])) << 24;
+}
+
+namespace model_section {
+constexpr uint32_t kMeta = model_section_tag("META");       // One model-specific record
+constexpr uint32_t kLayers = model_section_tag("LAYR");     // LayerConfig per layer
+constexpr uint32_t kTensors = model_section_tag("TNSR");    // Layer state, Scalar
+constexpr uint32_t kTrees = model_section_tag("TREE");      // Node offsets, trees + 1
+constexpr uint32_t kNodes = model_section_tag("NODE");      // TreeNode, all trees
+} // namespace model_section
+
+struct ModelFileHeader {
+    char magic[8];                  // "DDSMODEL"
+    uint32_t version;
+    uint32_t kind;                  // ModelKind
+    uint32_t scalar_bytes;          // sizeof(Scalar) of the writer
+    uint32_t section_count;
+    uint64_t file_size;
+};
+
+struct ModelSection {
+    uint32_t tag;
+    uint32_t element_size;          // Record size, checked against the reader's type
+    uint64_t offset;                // From the start of the file, 64-byte aligned
+    uint64_t count;
+};
+
+static_assert(sizeof(ModelFileHeader) == 32, "model file header layout");
+static_assert(sizeof(ModelSection) == 24, "model section table layout");
+
+// Collects sections and writes them as one model file
+class ModelWriter {
+private:
+    struct Pending {
+        uint32_t tag;
+        uint32_t element_size;
+        const void* data;
+        uint64_t count;
+    };
+    std::vector<Pending> sections_;
+
+public:
+    // data must stay valid until write()
+    template<typename T>
+    void add(uint32_t tag, const T* data, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "model sections hold plain records");
+        sections_.push_back({tag, static_cast<uint32_t>(sizeof(T)), data, static_cast<uint64_t>(count)});
+    }
+
+    bool write(const std::string& path, ModelKind kind) const;
+};
+
+// A model file mapped read-only. Loaded models hold it through a shared_ptr for as
+// long as they use its sections in place.
+class MappedModel {
+private:
+    const unsigned char* base_ = nullptr;
+    size_t size_ = 0;
+    const ModelFileHeader* header_ = nullptr;
+    const ModelSection* sections_ = nullptr;
+
+    const ModelSection* find(uint32_t tag) const;
+
+public:
+    MappedModel() = default;
+    ~MappedModel();
+    MappedModel(const MappedModel&) = delete;
+    MappedModel& operator=(const MappedModel&) = delete;
+
+    // Maps and validates the file; false (with a message) unless it is a well-formed
+    // model file of this version, Scalar type and kind
+    bool open(const std::string& path, ModelKind kind);
+
+    size_t size() const { return size_; }
+
+    // Section payload as an array of T, or null if absent or written with another
+    // record size
+    template<typename T>
+    const T* section(uint32_t tag, size_t& count) const {
+        const ModelSection* entry = find(tag);
+        if (!entry || entry->element_size != sizeof(T)) {
+            count = 0;
+            return nullptr;
+        }
+        count = static_cast<size_t>(entry->count);
+        return reinterpret_cast<const T*>(base_ + entry->offset);
+    }
+};
+
+// Maps path as a model of the given kind; null (with a message) on failure
+std::shared_ptr<const MappedModel> map_model(const std::string& path, ModelKind kind);
+
+} // namespace algorithms
+} // namespace dds
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../utils/types.h"
+#include <string>
+#include <vector>
+
+namespace dds {
+namespace algorithms {
+
+// One trainable tensor of a layer, updated in place from a gradient of the same size
+struct ParameterView {
+    Scalar* values;
+    const Scalar* gradients;
+    size_t size;
+    bool decay;                     // Weight decay applies (weights, not biases or norm scales)
+};
+
+enum class OptimizerType {
+    SGD,
+    MOMENTUM,
+    RMSPROP,
+    ADAM,
+    ADAMW
+};
+
+// First-order optimizers over a list of parameter views
+//
+// Moments for every parameter of every layer live in one flat buffer (one slot for
+// momentum and RMSprop, two for Adam), laid out in the order the views are passed.
+// Each step is a single fused pass per tensor that reads the parameter, gradient and
+// moments once and writes them back once. State is rebuilt (zeroed) if the parameter
+// layout changes between steps.
+class Optimizer {
+private:
+    OptimizerType type_;
+    double learning_rate_;
+    double momentum_ = 0.9;         // MOMENTUM
+    bool nesterov_ = false;
+    double rho_ = 0.99;             // RMSPROP squared-gradient smoothing
+    double beta1_ = 0.9;            // ADAM, ADAMW
+    double beta2_ = 0.999;
+    double epsilon_ = 1e-8;
+    double weight_decay_ = 0.0;     // L2 for SGD, MOMENTUM, RMSPROP and ADAM; decoupled for ADAMW
+    long long step_count_ = 0;
+
+    std::vector<Scalar> state_;     // slots() x total parameters
+    std::vector<size_t> layout_;    // Tensor sizes the state was built for
+    size_t total_ = 0;
+
+    int slots() const;
+    void ensure_state(const std::vector<ParameterView>& parameters);
+
+public:
+    explicit Optimizer(OptimizerType type = OptimizerType::SGD, double learning_rate = 0.01);
+
+    // "sgd", "momentum", "rmsprop", "adam" or "adamw"; false leaves the type unchanged
+    static bool parse_type(const std::string& name, OptimizerType& type);
+
+    void step(const std::vector<ParameterView>& parameters);
+    void reset();
+
+    // Configuration
+    void set_learning_rate(double learning_rate) { learning_rate_ = learning_rate; }
+    void set_momentum(double momentum, bool nesterov = false) { momentum_ = momentum; nesterov_ = nesterov; }
+    void set_rho(double rho) { rho_ = rho; }
+    void set_betas(double beta1, double beta2) { beta1_ = beta1; beta2_ = beta2; }
+    void set_epsilon(double epsilon) { epsilon_ = epsilon; }
+    void set_weight_decay(double weight_decay) { weight_decay_ = weight_decay; }
+
+    // Getters
+    OptimizerType get_type() const { return type_; }
+    double get_learning_rate() const { return learning_rate_; }
+    long long get_step_count() const { return step_count_; }
+    size_t state_size() const { return state_.size(); }
+};
+
+} // namespace algorithms
+} // namespace dds
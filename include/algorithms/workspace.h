@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../utils/types.h"
+#include <vector>
+
+namespace dds {
+namespace algorithms {
+
+// Static memory plan for tensors with known lifetimes, backed by one arena
+//
+// Tensors are registered with a size and the first and last step that touch them
+// (NeuralNetwork numbers its forward layers, the loss and the backward layers in
+// execution order). plan() places tensors largest first, each at the lowest offset
+// that does not overlap an already placed tensor whose lifetime intersects its own,
+// so tensors that are never live at the same time share memory. The arena only
+// grows, so re-planning for the same or a smaller graph allocates nothing.
+class Workspace {
+private:
+    struct Tensor {
+        size_t size;                // Elements, padded to whole cache lines
+        int first;
+        int last;
+        size_t offset;
+    };
+    std::vector<Tensor> tensors_;
+    std::vector<Scalar> arena_;
+    size_t planned_size_ = 0;
+
+public:
+    // Forgets the registered tensors; the arena is kept for the next plan
+    void clear();
+    // Registers a tensor live over steps [first, last] and returns its id
+    int add(size_t size, int first, int last);
+    void plan();
+
+    Scalar* data(int id) { return arena_.data() + tensors_[static_cast<size_t>(id)].offset; }
+    size_t tensor_count() const { return tensors_.size(); }
+    // Elements of the planned arena, and what the tensors would take without sharing
+    size_t size() const { return planned_size_; }
+    size_t unshared_size() const;
+};
+
+} // namespace algorithms
+} // namespace dds
@@ -35,7 +35,7 @@ struct ModelRecord {
     std::string model_id;
     std::string model_name;
     std::string algorithm_type;
-    std::string model_path;
+    std::string model_path;         // Binary model file from save_model() (algorithms/model_format.h)
     std::string parameters;
     double accuracy;
     double loss;
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "../utils/types.h"
+#include "../storage/hadoop_storage.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace dds {
+namespace datagen {
+
+// Kinds of synthetic dataset
+enum class DatasetKind {
+    REGRESSION,             // Linear target plus Gaussian noise
+    CLASSIFICATION,         // Argmax of noisy linear scores over num_classes
+    BLOBS,                  // Gaussian clusters plus uniform outliers (label -1)
+    SPARSE_CATEGORICAL      // Zipf-distributed category ids, logistic label
+};
+
+// Generator configuration
+struct DataGenConfig {
+    DatasetKind kind = DatasetKind::REGRESSION;
+    size_t rows = 1000000;
+    size_t features = 32;
+    size_t rows_per_shard = 100000;
+    uint64_t seed = 42;
+    size_t threads = 0;                 // 0 = one per hardware thread
+    std::string output_path = "datagen/dataset";
+    bool binary = true;                 // Binary shards; text uses the DATASET format
+
+    // Shape parameters
+    double noise = 0.1;                 // Regression/classification noise std dev
+    int num_classes = 2;
+    int num_centers = 8;
+    double cluster_std = 1.0;
+    double center_box = 10.0;           // Centers drawn from [-center_box, center_box]
+    double outlier_fraction = 0.01;
+    size_t cardinality = 1000;          // Categories per sparse column
+    double zipf_exponent = 1.1;
+};
+
+// Generation statistics
+struct DataGenStats {
+    size_t shards = 0;
+    size_t rows = 0;
+    size_t bytes = 0;
+    size_t failed_shards = 0;
+    double seconds = 0.0;
+    double rows_per_second = 0.0;
+};
+
+// Parallel synthetic dataset generator.
+// Rows are split into shards written straight through HadoopStorage; every shard has
+// its own seed derived from the base seed, so output is identical for any thread
+// count. Model parameters (coefficients, centers, category weights) are drawn once
+// from the base seed and shared by all shards.
+class DataGenerator {
+public:
+    DataGenerator(std::shared_ptr<storage::HadoopStorage> storage, const DataGenConfig& config);
+
+    // Generate every shard and a _manifest; returns false if any shard failed
+    bool generate(DataGenStats* stats = nullptr);
+
+    // Build one shard in memory (used by generate, benchmarks and tests)
+    void generate_shard(size_t shard_index, Matrix& X, Vector& y) const;
+
+    size_t shard_count() const;
+    std::string shard_path(size_t shard_index) const;
+    const DataGenConfig& get_config() const { return config_; }
+
+    static std::string kind_to_string(DatasetKind kind);
+    static bool kind_from_string(const std::string& name, DatasetKind& kind);
+
+private:
+    std::shared_ptr<storage::HadoopStorage> storage_;
+    DataGenConfig config_;
+
+    // Shared model drawn from the base seed
+    std::vector<double> coefficients_;      // features x num_classes (or features for regression)
+    Matrix centers_;
+    std::vector<double> zipf_cdf_;
+
+    void build_model();
+    bool write_manifest(const DataGenStats& stats) const;
+    double category_weight(size_t column, size_t category) const;
+};
+
+} // namespace datagen
+} // namespace dds
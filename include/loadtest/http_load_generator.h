@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace dds {
+namespace loadtest {
+
+// Log-linear latency histogram (HDR-style): 16 linear sub-buckets per power of two,
+// so any recorded value is within ~6% of its bucket; covers 1 us to ~1 hour.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBuckets = 16;
+    static constexpr int kMagnitudes = 32;
+
+    LatencyHistogram() { counts_.fill(0); }
+
+    void record(std::chrono::nanoseconds latency);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const { return total_; }
+    double percentile_us(double p) const;
+    double max_us() const { return max_ns_ / 1000.0; }
+    double mean_us() const { return total_ ? sum_ns_ / 1000.0 / total_ : 0.0; }
+
+private:
+    std::array<uint64_t, kSubBuckets * kMagnitudes> counts_;
+    uint64_t total_ = 0;
+    double sum_ns_ = 0.0;
+    int64_t max_ns_ = 0;
+
+    static size_t bucket_of(uint64_t micros);
+    static double bucket_upper_us(size_t bucket);
+};
+
+// One endpoint in the request mix
+struct LoadTarget {
+    std::string method = "GET";
+    std::string path = "/";
+    std::string body;
+    std::map<std::string, std::string> headers;
+    double weight = 1.0;
+};
+
+// Load test configuration
+struct LoadTestConfig {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    std::vector<LoadTarget> targets;
+    double requests_per_second = 100.0;
+    std::chrono::seconds duration{10};
+    std::chrono::seconds warmup{0};             // Requests sent but not recorded
+    size_t connections = 64;                    // Worker threads, each one request in flight
+    size_t max_backlog = 100000;                // Scheduled-but-unsent requests before dropping
+    std::chrono::milliseconds timeout{5000};
+    bool poisson_arrivals = true;               // Exponential gaps; false = fixed interval
+    uint64_t seed = 42;
+};
+
+// Per-target and overall results
+struct LoadTestReport {
+    double elapsed_seconds = 0.0;
+    uint64_t scheduled = 0;
+    uint64_t completed = 0;
+    uint64_t errors = 0;                        // Connect/send/receive failures and timeouts
+    uint64_t dropped = 0;                       // Backlog overflow
+    double achieved_rps = 0.0;
+    std::map<int, uint64_t> status_codes;
+    LatencyHistogram latency;
+    std::map<std::string, LatencyHistogram> latency_by_target;
+
+    void print() const;
+    std::string to_json() const;
+};
+
+// Open-loop HTTP load generator.
+// Send times are fixed up front by the arrival process and latency is measured from
+// the scheduled time, not the actual send, so a slow server shows up as latency
+// instead of silently lowering the offered load (no coordinated omission).
+class HttpLoadGenerator {
+public:
+    explicit HttpLoadGenerator(const LoadTestConfig& config);
+
+    LoadTestReport run();
+
+private:
+    LoadTestConfig config_;
+    std::vector<double> cumulative_weights_;
+
+    size_t pick_target(double u) const;
+    bool send_request(const LoadTarget& target, int& status_code) const;
+    std::string build_request(const LoadTarget& target) const;
+};
+
+} // namespace loadtest
+} // namespace dds
@@ -88,7 +88,7 @@ private:
     std::map<std::string, std::vector<std::shared_ptr<PipelineTask>>> pipelines_;
     std::map<std::string, TaskStatus> task_statuses_;
     std::map<std::string, PipelineResult> execution_history_;
-    std::mutex orchestrator_mutex_;
+    mutable std::mutex orchestrator_mutex_;
     std::condition_variable task_cv_;
     std::atomic<bool> running_;
     int max_concurrent_tasks_;
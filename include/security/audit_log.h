@@ -0,0 +1,155 @@
+#pragma once
+
+#include "security_event.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <array>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <cstdio>
+#include <cstdint>
+
+namespace dds {
+namespace security {
+
+// Audit log configuration
+struct AuditLogConfig {
+    std::string directory;                          // Empty: segments stay in memory, nothing touches disk
+    size_t segment_max_bytes = 4 * 1024 * 1024;     // Roll to a new segment past this size
+    size_t max_segments = 64;                       // Oldest segments are retired beyond this
+    size_t staging_stripes = 0;                     // 0 = one per hardware thread
+    size_t group_commit_events = 256;               // Wake the writer early once a stripe holds this many
+    std::chrono::milliseconds group_commit_interval{20};
+    bool fsync_on_commit = false;
+};
+
+// Audit log statistics
+struct AuditLogStats {
+    size_t total_events;
+    size_t staged_events;
+    size_t segment_count;
+    size_t bytes_on_disk;       // Record bytes held, in memory when there is no directory
+    size_t group_commits;
+    size_t segments_scanned;    // By the most recent time-range query
+    size_t segments_skipped;    // By the most recent time-range query
+};
+
+// Segmented, append-only audit log.
+// Callers only push into a striped staging buffer; a background writer drains all
+// stripes and writes each batch with a single write (group commit). Secondary indexes
+// map user, IP, type and severity to record ids, and every segment keeps min/max
+// timestamps so time-range queries skip segments that cannot match.
+// Without a directory the segments are kept in memory (still bounded by
+// max_segments); the writer thread commits them the same way.
+class AuditLog {
+public:
+    explicit AuditLog(const AuditLogConfig& config = AuditLogConfig());
+    ~AuditLog();
+
+    AuditLog(const AuditLog&) = delete;
+    AuditLog& operator=(const AuditLog&) = delete;
+
+    // Lifecycle
+    bool open();
+    void close();
+    bool is_open() const { return running_; }
+
+    // Append (never touches disk on the caller's thread)
+    void append(const SecurityEvent& event);
+
+    // Commit everything staged so far
+    void flush();
+
+    // Indexed queries (staged events are committed first)
+    std::vector<SecurityEvent> query_by_type(SecurityEventType type);
+    std::vector<SecurityEvent> query_by_severity(SecuritySeverity severity);
+    std::vector<SecurityEvent> query_by_user(const std::string& user_id);
+    std::vector<SecurityEvent> query_by_ip(const std::string& ip_address);
+    std::vector<SecurityEvent> query_time_range(std::chrono::system_clock::time_point from,
+                                                std::chrono::system_clock::time_point to);
+    void for_each(const std::function<void(uint64_t, const SecurityEvent&)>& visitor);
+
+    // Counters served straight from the indexes
+    size_t size();
+    size_t count_by_type(SecurityEventType type);
+    size_t count_by_severity(SecuritySeverity severity);
+
+    // Maintenance
+    bool mark_investigated(uint64_t record_id);
+    size_t drop_segments_before(std::chrono::system_clock::time_point cutoff);
+
+    AuditLogStats get_stats();
+    const AuditLogConfig& get_config() const { return config_; }
+
+private:
+    struct alignas(64) StagingStripe {
+        std::mutex mutex;
+        std::vector<SecurityEvent> events;
+    };
+
+    struct Segment {
+        uint32_t segment_id;
+        std::string path;
+        uint64_t first_record;
+        int64_t min_timestamp;
+        int64_t max_timestamp;
+        uint64_t bytes;
+        std::vector<uint64_t> offsets;      // Byte offset of each record
+        std::vector<int64_t> timestamps;    // Per-record time index
+        std::string data;                   // Record bytes of an in-memory segment
+    };
+
+    AuditLogConfig config_;
+    std::vector<std::unique_ptr<StagingStripe>> stripes_;
+    std::atomic<size_t> staged_count_;
+
+    // Writer state; commit_mutex_ serializes group commits
+    std::mutex commit_mutex_;
+    std::FILE* active_file_;
+    std::thread writer_thread_;
+    std::mutex writer_mutex_;
+    std::condition_variable writer_cv_;
+    std::atomic<bool> running_;
+    size_t group_commits_;
+
+    // Segment metadata and secondary indexes, guarded by index_mutex_
+    std::mutex index_mutex_;
+    std::deque<Segment> segments_;
+    uint64_t next_record_;
+    uint32_t next_segment_id_;
+    std::unordered_map<std::string, std::vector<uint64_t>> user_index_;
+    std::unordered_map<std::string, std::vector<uint64_t>> ip_index_;
+    std::array<std::vector<uint64_t>, kSecurityEventTypeCount> type_index_;
+    std::array<std::vector<uint64_t>, kSecuritySeverityCount> severity_index_;
+    std::unordered_set<uint64_t> investigated_;
+    size_t last_segments_scanned_;
+    size_t last_segments_skipped_;
+
+    bool in_memory() const { return config_.directory.empty(); }
+    void writer_loop();
+    void commit_staged();
+    StagingStripe& local_stripe();
+    bool open_new_segment();
+    bool recover_segment(const std::string& path, uint32_t segment_id);
+    void index_record(uint64_t record_id, const SecurityEvent& event);
+    void retire_oldest_segment();
+    const Segment* find_segment(uint64_t record_id) const;
+    void restage(std::vector<SecurityEvent>& batch, size_t from);
+    std::vector<std::pair<uint64_t, SecurityEvent>> read_records(const std::vector<uint64_t>& record_ids);
+    std::vector<SecurityEvent> read_events(const std::vector<uint64_t>& record_ids);
+
+    static void encode_event(const SecurityEvent& event, std::string& out);
+    static bool decode_event(const char* data, size_t size, SecurityEvent& event);
+    static int64_t to_nanos(std::chrono::system_clock::time_point tp);
+};
+
+} // namespace security
+} // namespace dds
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+
+namespace dds {
+namespace security {
+
+// Security event types
+enum class SecurityEventType {
+    LOGIN_SUCCESS,
+    LOGIN_FAILURE,
+    UNAUTHORIZED_ACCESS,
+    PRIVILEGE_ESCALATION,
+    DATA_ACCESS,
+    CONFIGURATION_CHANGE,
+    SUSPICIOUS_ACTIVITY,
+    BRUTE_FORCE_ATTEMPT,
+    SQL_INJECTION_ATTEMPT,
+    XSS_ATTEMPT
+};
+
+constexpr size_t kSecurityEventTypeCount = 10;
+
+// Security severity levels
+enum class SecuritySeverity {
+    LOW,
+    MEDIUM,
+    HIGH,
+    CRITICAL
+};
+
+constexpr size_t kSecuritySeverityCount = 4;
+
+// Security audit event
+struct SecurityEvent {
+    SecurityEventType event_type;
+    SecuritySeverity severity;
+    std::string user_id;
+    std::string ip_address;
+    std::string resource;
+    std::string description;
+    std::string user_agent;
+    std::chrono::system_clock::time_point timestamp;
+    bool investigated;
+};
+
+} // namespace security
+} // namespace dds
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "security_event.h"
+#include "../utils/sketches.h"
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+
+namespace dds {
+namespace security {
+
+// Security threat assessment
+struct ThreatAssessment {
+    std::string threat_id;
+    std::string source_ip;
+    int risk_score;
+    std::vector<SecurityEventType> event_pattern;   // Distinct event types seen in the window
+    std::chrono::system_clock::time_point first_seen;
+    std::chrono::system_clock::time_point last_seen;
+    int event_count;
+};
+
+// Threat scorer configuration
+struct ThreatScorerConfig {
+    std::chrono::seconds window{900};       // Sliding window for failures and risk
+    size_t window_slices = 15;
+    size_t sketch_width = 4096;
+    size_t sketch_depth = 4;
+    size_t tracked_sources = 256;           // Heavy hitters kept per sketch
+};
+
+// Streaming threat scoring over sliding windows.
+// Per-IP failed logins and severity-weighted risk live in windowed count-min sketches,
+// and Space-Saving summaries keep the heaviest sources for reporting, so memory is
+// fixed no matter how many distinct addresses show up.
+class ThreatScorer {
+public:
+    explicit ThreatScorer(const ThreatScorerConfig& config = ThreatScorerConfig());
+
+    // Returns the source's windowed risk after counting the event
+    int record_event(const SecurityEvent& event);
+    // Returns the windowed number of failures from ip_address
+    uint32_t record_login_failure(const std::string& ip_address, std::chrono::system_clock::time_point when);
+
+    uint32_t login_failures(const std::string& ip_address) const;
+    int risk_score(const std::string& ip_address) const;
+    ThreatAssessment assess(const std::string& ip_address) const;
+
+    // Heaviest sources in the window, highest first
+    std::vector<ThreatAssessment> top_threats(size_t limit) const;
+    std::vector<std::pair<std::string, uint32_t>> top_login_failures(size_t limit) const;
+
+    void clear();
+    size_t memory_bytes() const;
+    const ThreatScorerConfig& get_config() const { return config_; }
+
+private:
+    struct SourceInfo {
+        int64_t first_seen_ns = 0;
+        int64_t last_seen_ns = 0;
+        uint32_t event_types = 0;   // Bit per SecurityEventType
+        uint32_t event_count = 0;
+    };
+
+    ThreatScorerConfig config_;
+    utils::WindowedCountMinSketch failures_;
+    utils::WindowedCountMinSketch risk_;
+    utils::WindowedCountMinSketch events_;
+    utils::SpaceSaving<SourceInfo> risky_sources_;
+    utils::SpaceSaving<> failing_sources_;
+    int64_t last_decay_epoch_;
+    mutable std::mutex mutex_;
+
+    void maybe_decay(std::chrono::system_clock::time_point now);
+    ThreatAssessment build_assessment(const std::string& ip_address, const SourceInfo* info,
+                                      std::chrono::system_clock::time_point now) const;
+    static uint32_t severity_weight(SecuritySeverity severity);
+};
+
+} // namespace security
+} // namespace dds
@@ -6,6 +6,7 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <cstdint>
 
 namespace dds {
 namespace storage {
@@ -49,6 +50,20 @@ struct HDFSFileInfo {
     time_t access_time;
 };
 
+// Header of the binary dataset formats. Dense ("DDSB"): row-major features, then
+// labels. Sparse CSR ("DDSS"): uint64 nnz, row offsets (int64, rows + 1), column
+// indices (int32, nnz), values (nnz), then labels.
+struct BinaryDatasetHeader {
+    char magic[4];              // "DDSB" or "DDSS"
+    uint32_t version;
+    uint64_t rows;
+    uint64_t cols;
+    uint32_t scalar_bytes;      // 4 (float32) or 8 (float64); converted to Scalar on load
+    uint32_t reserved;
+};
+
+constexpr uint32_t kBinaryDatasetVersion = 1;
+
 // Hadoop storage manager
 class HadoopStorage {
 private:
@@ -73,6 +88,8 @@ public:
     bool create_file(const std::string& path, const std::vector<char>& data);
     bool read_file(const std::string& path, std::string& content);
     bool read_file(const std::string& path, std::vector<char>& data);
+    // length bytes from offset; false if the file ends first
+    bool read_file_range(const std::string& path, uint64_t offset, size_t length, std::vector<char>& data);
     bool delete_file(const std::string& path);
     bool copy_file(const std::string& src_path, const std::string& dst_path);
     bool move_file(const std::string& src_path, const std::string& dst_path);
@@ -83,23 +100,32 @@ public:
     std::vector<HDFSFileInfo> list_directory(const std::string& path);
     
     // Matrix/Vector operations
-    bool save_matrix(const std::string& path, const Eigen::MatrixXd& matrix);
-    bool load_matrix(const std::string& path, Eigen::MatrixXd& matrix);
-    bool save_vector(const std::string& path, const Eigen::VectorXd& vector);
-    bool load_vector(const std::string& path, Eigen::VectorXd& vector);
+    bool save_matrix(const std::string& path, const Matrix& matrix);
+    bool load_matrix(const std::string& path, Matrix& matrix);
+    bool save_vector(const std::string& path, const Vector& vector);
+    bool load_vector(const std::string& path, Vector& vector);
     
     // Data processing operations
-    bool save_dataset(const std::string& path, const Eigen::MatrixXd& features, 
-                     const Eigen::VectorXd& labels);
-    bool load_dataset(const std::string& path, Eigen::MatrixXd& features, 
-                     Eigen::VectorXd& labels);
+    bool save_dataset(const std::string& path, const Matrix& features, 
+                     const Vector& labels);
+    bool load_dataset(const std::string& path, Matrix& features, 
+                     Vector& labels);   // Reads text or binary datasets
+    bool save_dataset_binary(const std::string& path, const Matrix& features,
+                             const Vector& labels);
+    
+    // Sparse datasets: load accepts the sparse format, or converts a dense binary or
+    // text dataset row by row, dropping entries with |value| <= zero_tolerance
+    bool save_dataset_sparse(const std::string& path, const SparseMatrixCSR& features,
+                             const Vector& labels);
+    bool load_dataset_sparse(const std::string& path, SparseMatrixCSR& features,
+                             Vector& labels, double zero_tolerance = 0.0);
     
     // Batch operations
     bool save_batch_data(const std::string& base_path, 
-                        const std::vector<Eigen::MatrixXd>& matrices,
+                        const std::vector<Matrix>& matrices,
                         const std::vector<std::string>& names);
     bool load_batch_data(const std::string& base_path,
-                        std::vector<Eigen::MatrixXd>& matrices,
+                        std::vector<Matrix>& matrices,
                         const std::vector<std::string>& names);
     
     // Configuration
@@ -111,17 +137,55 @@ public:
     size_t get_file_size(const std::string& path);
     std::string get_file_checksum(const std::string& path);
     
-    // Error handling
+    // Error handling; safe to call while other threads read and write
     std::string get_last_error() const;
     void clear_error();
     
 private:
     // Internal helper methods
     bool ensure_connected();
-    std::string serialize_matrix(const Eigen::MatrixXd& matrix);
-    bool deserialize_matrix(const std::string& data, Eigen::MatrixXd& matrix);
-    std::string serialize_vector(const Eigen::VectorXd& vector);
-    bool deserialize_vector(const std::string& data, Eigen::VectorXd& vector);
+    void set_error(const std::string& message);
+    std::string serialize_matrix(const Matrix& matrix);
+    bool deserialize_matrix(const std::string& data, Matrix& matrix);
+    std::string serialize_vector(const Vector& vector);
+    bool deserialize_vector(const std::string& data, Vector& vector);
+    bool deserialize_dataset_sparse(const std::string& data, SparseMatrixCSR& features,
+                                    Vector& labels);
+    bool deserialize_dataset_binary(const std::string& data, Matrix& features,
+                                    Vector& labels);
+};
+
+// Dense binary datasets read a batch of rows at a time, one file after another, so
+// only the current batch is in memory. Every file must have the same columns.
+class DatasetStream {
+private:
+    std::shared_ptr<HadoopStorage> storage_;
+    std::vector<std::string> paths_;
+    size_t file_ = 0;
+    BinaryDatasetHeader header_{};
+    bool header_loaded_ = false;
+    uint64_t row_ = 0;              // Next row of the current file
+    uint64_t rows_read_ = 0;        // Since the last rewind
+    Index cols_ = -1;
+    bool failed_ = false;
+    std::vector<char> buffer_;
+
+public:
+    DatasetStream(std::shared_ptr<HadoopStorage> storage, std::vector<std::string> paths);
+
+    // Up to max_rows rows into features and their labels; false at the end of the
+    // last file, or with a message when a file cannot be read
+    bool next_batch(Index max_rows, Matrix& features, Vector& labels);
+    // Back to the first row of the first file
+    void rewind();
+
+    // Columns of the files, -1 before the first batch
+    Index cols() const { return cols_; }
+    uint64_t rows_read() const { return rows_read_; }
+    bool failed() const { return failed_; }
+
+private:
+    bool open_next_file();
 };
 
 // Hadoop job manager for MapReduce operations
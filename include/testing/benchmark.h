@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+namespace dds {
+namespace testing {
+
+// Keeps a computed value alive so the optimizer cannot drop the work producing it
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Benchmark configuration
+struct BenchmarkConfig {
+    std::chrono::milliseconds warmup_time{100};
+    std::chrono::milliseconds min_time{500};        // Measured time per benchmark
+    size_t samples = 15;                            // Timed samples; iterations are calibrated per sample
+    size_t max_iterations = 1ull << 30;
+    double confidence = 0.95;                       // For the median's confidence interval
+    bool capture_counters = true;                   // perf_event hardware counters (Linux only)
+    std::string filter;                             // Substring match on benchmark names
+    std::string json_path;                          // Write results here when non-empty
+};
+
+// Hardware counters, per iteration
+struct BenchmarkCounters {
+    bool valid = false;
+    double cycles = 0.0;
+    double instructions = 0.0;
+    double cache_misses = 0.0;
+    double branch_misses = 0.0;
+
+    double ipc() const { return cycles > 0.0 ? instructions / cycles : 0.0; }
+};
+
+// Benchmark result structure; times are nanoseconds per iteration
+struct BenchmarkResult {
+    std::string name;
+    size_t iterations_per_sample;
+    std::vector<double> sample_ns;
+    double median_ns;
+    double mad_ns;          // Median absolute deviation
+    double mean_ns;
+    double min_ns;
+    double ci_low_ns;       // Distribution-free interval for the median
+    double ci_high_ns;
+    double items_per_second;
+    double bytes_per_second;
+    BenchmarkCounters counters;
+    std::vector<std::pair<std::string, double>> user_counters;
+};
+
+// Handed to each benchmark body, which must run its workload iterations() times
+class BenchmarkState {
+private:
+    size_t iterations_;
+    double items_per_iteration_;
+    double bytes_per_iteration_;
+    std::vector<std::pair<std::string, double>> user_counters_;
+
+    friend class BenchmarkSuite;
+
+public:
+    explicit BenchmarkState(size_t iterations)
+        : iterations_(iterations), items_per_iteration_(0.0), bytes_per_iteration_(0.0) {}
+
+    size_t iterations() const { return iterations_; }
+
+    // Throughput reporting
+    void set_items_per_iteration(double items) { items_per_iteration_ = items; }
+    void set_bytes_per_iteration(double bytes) { bytes_per_iteration_ = bytes; }
+
+    // Extra named values carried into the report (e.g. GFLOP/s, accuracy)
+    void set_counter(const std::string& name, double value);
+};
+
+// Micro-benchmark runner: warmup, auto-calibrated iteration counts, robust statistics,
+// optional perf_event counters and JSON output for regression comparison.
+class BenchmarkSuite {
+private:
+    struct BenchmarkCase {
+        std::string name;
+        std::function<void(BenchmarkState&)> func;
+    };
+
+    std::string suite_name_;
+    BenchmarkConfig config_;
+    std::vector<BenchmarkCase> benchmarks_;
+    std::vector<BenchmarkResult> results_;
+
+    BenchmarkResult run_benchmark(const BenchmarkCase& benchmark);
+    size_t calibrate(const BenchmarkCase& benchmark, std::chrono::nanoseconds target);
+
+public:
+    BenchmarkSuite(const std::string& name, const BenchmarkConfig& config = BenchmarkConfig())
+        : suite_name_(name), config_(config) {}
+
+    // Add benchmark case
+    void add_benchmark(const std::string& name, std::function<void(BenchmarkState&)> func);
+
+    // Understands --filter=, --json=, --min-time-ms=, --warmup-ms=, --samples=, --no-counters
+    bool parse_args(int argc, char** argv);
+
+    // Run everything matching the filter; returns false if the JSON file could not be written
+    bool run_all_benchmarks();
+
+    // Get results
+    const std::vector<BenchmarkResult>& get_results() const { return results_; }
+    BenchmarkConfig& config() { return config_; }
+
+    // Reporting
+    void print_summary() const;
+    std::string to_json() const;
+    bool write_json(const std::string& path) const;
+};
+
+} // namespace testing
+} // namespace dds
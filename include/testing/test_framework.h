@@ -5,6 +5,7 @@
 #include <functional>
 #include <chrono>
 #include <iostream>
+#include <mutex>
 
 namespace dds {
 namespace testing {
@@ -13,38 +14,59 @@ namespace testing {
 struct TestResult {
     std::string test_name;
     bool passed;
+    bool timed_out;
     std::string error_message;
     std::chrono::milliseconds execution_time;
 };
 
-// Test suite for DDS components
+// Test suite for DDS components.
+// Tests run on a pool of worker threads; each test may carry a timeout, after which
+// it is reported as failed and abandoned on a detached thread (it cannot be killed).
 class TestSuite {
 private:
+    struct TestCase {
+        std::string name;
+        std::function<void()> func;
+        std::chrono::milliseconds timeout;
+    };
+
     std::string suite_name_;
-    std::vector<std::function<void()>> tests_;
+    std::vector<TestCase> tests_;
     std::vector<TestResult> results_;
     int passed_count_;
     int failed_count_;
+    size_t parallelism_;                        // 0 = one worker per hardware thread
+    std::chrono::milliseconds default_timeout_; // 0 = no timeout
+    std::mutex output_mutex_;
+
+    TestResult run_test(const TestCase& test);
 
 public:
-    TestSuite(const std::string& name) : suite_name_(name), passed_count_(0), failed_count_(0) {}
-    
-    // Add test case
-    void add_test(const std::string& name, std::function<void()> test_func);
-    
-    // Run all tests
+    TestSuite(const std::string& name)
+        : suite_name_(name), passed_count_(0), failed_count_(0), parallelism_(1),
+          default_timeout_(0) {}
+
+    // Add test case; a zero timeout falls back to the suite default
+    void add_test(const std::string& name, std::function<void()> test_func,
+                  std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+    // Execution settings
+    void set_parallelism(size_t workers) { parallelism_ = workers; }
+    void set_default_timeout(std::chrono::milliseconds timeout) { default_timeout_ = timeout; }
+
+    // Run all tests; results keep registration order regardless of parallelism
     void run_all_tests();
-    
+
     // Get results
     std::vector<TestResult> get_results() const { return results_; }
     int get_passed_count() const { return passed_count_; }
     int get_failed_count() const { return failed_count_; }
-    
+
     // Assertion helpers
     static void assert_true(bool condition, const std::string& message = "");
     static void assert_equals(double expected, double actual, double tolerance = 1e-6);
     static void assert_not_null(void* ptr, const std::string& message = "");
-    
+
     // Print summary
     void print_summary() const;
 };
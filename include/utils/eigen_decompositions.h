@@ -0,0 +1,727 @@
+#pragma once
+
+// Dense factorizations for the Eigen stub (header-only): LLT, HouseholderQR,
+// SelfAdjointEigenSolver and JacobiSVD with Eigen's interfaces.
+//
+// Each one is blocked so the bulk of its flops goes through gemm():
+// - Cholesky and QR update trailing submatrices with panel products.
+// - The symmetric eigensolver tridiagonalizes with two-sided panel updates and
+//   back-transforms with block reflectors.
+// - The SVD reduces tall inputs with QR, then runs one-sided Jacobi sweeps whose
+//   disjoint rotations are applied in parallel.
+
+#include "eigen_stub.h"
+#include <atomic>
+#include <limits>
+#include <numeric>
+
+namespace Eigen {
+
+enum ComputationInfo {
+    Success = 0,
+    NumericalIssue = 1,
+    NoConvergence = 2,
+    InvalidInput = 3
+};
+
+enum DecompositionOptions {
+    ComputeFullU = 0x04,
+    ComputeThinU = 0x08,
+    ComputeFullV = 0x10,
+    ComputeThinV = 0x20,
+    EigenvaluesOnly = 0x40,
+    ComputeEigenvectors = 0x80
+};
+
+namespace internal {
+
+constexpr Index kFactorBlock = 64;      // Panel width of the blocked factorizations
+
+// LAPACK dlarfg. For x = [alpha; tail] computes tau and v = [1; tail / (alpha - beta)]
+// with (I - tau v v^T) x = [beta; 0]; tail is overwritten by v(1:) and alpha by beta.
+template<typename Scalar>
+Scalar make_householder(Scalar& alpha, Scalar* tail, Index n, Index stride) {
+    double xnorm2 = 0;
+    for (Index i = 0; i < n; ++i) xnorm2 += static_cast<double>(tail[i * stride]) * tail[i * stride];
+    if (xnorm2 == 0) return Scalar(0);
+    const double a = alpha;
+    const double beta = -std::copysign(std::sqrt(a * a + xnorm2), a);
+    const Scalar scale = static_cast<Scalar>(1.0 / (a - beta));
+    for (Index i = 0; i < n; ++i) tail[i * stride] *= scale;
+    alpha = static_cast<Scalar>(beta);
+    return static_cast<Scalar>((beta - a) / beta);
+}
+
+// Triangular factor T (kb x kb, row-major) of the block reflector
+// H_0 H_1 ... H_{kb-1} = I - V T V^T (LAPACK dlarft, forward columnwise). V is
+// rows x kb, unit lower trapezoidal with its ones and zeros stored explicitly.
+template<typename Scalar>
+void block_reflector_factor(const Scalar* v, Index rows, Index kb, const Scalar* tau, Scalar* t) {
+    std::vector<Scalar> vtv(static_cast<size_t>(kb * kb), Scalar(0));
+    gemm_kernel(true, false, kb, kb, rows, Scalar(1), v, kb, v, kb, vtv.data(), kb);
+    std::fill(t, t + kb * kb, Scalar(0));
+    for (Index i = 0; i < kb; ++i) {
+        // T(0:i, i) = -tau_i T(0:i, 0:i) V(:, 0:i)^T v_i
+        for (Index p = 0; p < i; ++p) {
+            double s = 0;
+            for (Index q = p; q < i; ++q) s += static_cast<double>(t[p * kb + q]) * vtv[q * kb + i];
+            t[p * kb + i] = static_cast<Scalar>(-static_cast<double>(tau[i]) * s);
+        }
+        t[i * kb + i] = tau[i];
+    }
+}
+
+// c (rows x cols, leading dimension ldc) = (I - V op(T) V^T) c with op(T) = T^T when
+// transpose is set, i.e. H^T c. Three gemm calls.
+template<typename Scalar>
+void apply_block_reflector(const Scalar* v, const Scalar* t, Index rows, Index kb, bool transpose,
+                           Scalar* c, Index ldc, Index cols) {
+    if (rows == 0 || cols == 0 || kb == 0) return;
+    std::vector<Scalar> w(static_cast<size_t>(kb * cols), Scalar(0));
+    std::vector<Scalar> tw(static_cast<size_t>(kb * cols), Scalar(0));
+    gemm_kernel(true, false, kb, cols, rows, Scalar(1), v, kb, c, ldc, w.data(), cols);
+    gemm_kernel(transpose, false, kb, cols, kb, Scalar(1), t, kb, w.data(), cols, tw.data(), cols);
+    gemm_kernel(false, false, rows, cols, kb, Scalar(-1), v, kb, tw.data(), cols, c, ldc);
+}
+
+// Resizes a solve() result whether the right-hand side is a Matrix or a Vector
+template<typename Scalar>
+void resize_rhs(Matrix<Scalar>& x, Index rows, Index cols) { x.resize(rows, cols); }
+
+template<typename Scalar>
+void resize_rhs(Vector<Scalar>& x, Index rows, Index) { x.resize(rows); }
+
+} // namespace internal
+
+// Cholesky factorization A = L L^T of a symmetric positive definite matrix.
+// Right-looking blocked: factor a diagonal block, solve the panel below it row by
+// row in parallel, then update the trailing lower triangle with gemm.
+template<typename Scalar>
+class LLT {
+public:
+    LLT() = default;
+    explicit LLT(const Matrix<Scalar>& a) { compute(a); }
+
+    LLT& compute(const Matrix<Scalar>& a) {
+        const Index n = a.rows();
+        info_ = InvalidInput;
+        if (a.cols() != n) return *this;
+        l_ = a;
+        Scalar* p = l_.data();
+        const Index nb = internal::kFactorBlock;
+
+        for (Index k = 0; k < n; k += nb) {
+            const Index kb = std::min(nb, n - k);
+            for (Index j = k; j < k + kb; ++j) {
+                Scalar* lj = p + j * n + k;
+                const double d = lj[j - k] - dds::utils::simd::dot(lj, lj, static_cast<size_t>(j - k));
+                if (!(d > 0)) {
+                    info_ = NumericalIssue;
+                    return *this;
+                }
+                const double djj = std::sqrt(d);
+                lj[j - k] = static_cast<Scalar>(djj);
+                for (Index i = j + 1; i < k + kb; ++i) {
+                    Scalar* li = p + i * n + k;
+                    li[j - k] = static_cast<Scalar>((li[j - k] - dds::utils::simd::dot(li, lj, static_cast<size_t>(j - k))) / djj);
+                }
+            }
+            const Index t0 = k + kb;
+            if (t0 >= n) break;
+
+            // L21 = A21 L11^-T, rows independent
+            const Scalar* l11 = p + k * n + k;
+            dds::utils::parallel_for(t0, n, 16, [&](Index i0, Index i1) {
+                for (Index i = i0; i < i1; ++i) {
+                    Scalar* li = p + i * n + k;
+                    for (Index j = 0; j < kb; ++j) {
+                        li[j] = static_cast<Scalar>((li[j] - dds::utils::simd::dot(li, l11 + j * n, static_cast<size_t>(j))) / l11[j * n + j]);
+                    }
+                }
+            });
+
+            // A22 -= L21 L21^T on and below the diagonal, one gemm per block row
+            const Index blocks = (n - t0 + nb - 1) / nb;
+            dds::utils::parallel_for(0, blocks, 1, [&](Index b0, Index b1) {
+                for (Index b = b0; b < b1; ++b) {
+                    const Index r0 = t0 + b * nb, r1 = std::min(n, r0 + nb);
+                    internal::gemm_kernel(false, true, r1 - r0, r1 - t0, kb, Scalar(-1),
+                                          p + r0 * n + k, n, p + t0 * n + k, n, p + r0 * n + t0, n);
+                }
+            });
+        }
+
+        for (Index i = 0; i < n; ++i) std::fill(p + i * n + i + 1, p + (i + 1) * n, Scalar(0));
+        info_ = Success;
+        return *this;
+    }
+
+    ComputationInfo info() const { return info_; }
+    const Matrix<Scalar>& matrixL() const { return l_; }
+
+    // Solves A x = b by forward and back substitution; b may be a Vector or a Matrix
+    template<typename Rhs>
+    Rhs solve(const Rhs& b) const {
+        const Index n = l_.rows();
+        if (info_ != Success || b.rows() != n) return Rhs();
+        Rhs x = b;
+        const size_t r = static_cast<size_t>(b.cols());
+        const Scalar* lp = l_.data();
+        Scalar* xp = x.data();
+        for (Index i = 0; i < n; ++i) {
+            Scalar* xi = xp + i * r;
+            for (Index q = 0; q < i; ++q) dds::utils::simd::axpy(-lp[i * n + q], xp + q * r, xi, r);
+            dds::utils::simd::scale(Scalar(1) / lp[i * n + i], xi, r);
+        }
+        for (Index i = n - 1; i >= 0; --i) {
+            Scalar* xi = xp + i * r;
+            dds::utils::simd::scale(Scalar(1) / lp[i * n + i], xi, r);
+            // Row i of L scatters x_i into the earlier unknowns
+            for (Index q = 0; q < i; ++q) dds::utils::simd::axpy(-lp[i * n + q], xi, xp + q * r, r);
+        }
+        return x;
+    }
+
+private:
+    Matrix<Scalar> l_;
+    ComputationInfo info_ = InvalidInput;
+};
+
+// Householder QR A = Q R (m x n). Panels of kFactorBlock columns are factored with
+// parallel level-2 updates, then applied to the trailing columns as one compact-WY
+// block reflector (three gemm calls). householderQ() returns the thin m x min(m, n)
+// factor, unlike Eigen's full HouseholderSequence.
+template<typename Scalar>
+class HouseholderQR {
+public:
+    HouseholderQR() = default;
+    explicit HouseholderQR(const Matrix<Scalar>& a) { compute(a); }
+
+    HouseholderQR& compute(const Matrix<Scalar>& a) {
+        const Index m = a.rows(), n = a.cols();
+        const Index kmax = std::min(m, n);
+        qr_ = a;
+        tau_ = Vector<Scalar>::Zero(kmax);
+        Scalar* p = qr_.data();
+        const Index threads = static_cast<Index>(dds::utils::max_threads());
+        std::vector<Scalar> v, t;
+
+        for (Index k = 0; k < kmax; k += internal::kFactorBlock) {
+            const Index kb = std::min(internal::kFactorBlock, kmax - k);
+            for (Index j = k; j < k + kb; ++j) {
+                const Scalar tau = internal::make_householder(p[j * n + j], p + (j + 1) * n + j, m - j - 1, n);
+                tau_[j] = tau;
+                const Index c0 = j + 1, ncols = k + kb - c0;
+                if (tau == Scalar(0) || ncols == 0) continue;
+
+                // Rest of the panel: w = v^T A(j:m, c0:), then A -= tau v w^T. Rows are
+                // split into parts with private partial sums.
+                const Index rows = m - j;
+                const Index parts = std::max<Index>(1, std::min(threads, rows * ncols / 32768));
+                std::vector<std::vector<Scalar>> partial(static_cast<size_t>(parts), std::vector<Scalar>(static_cast<size_t>(ncols), Scalar(0)));
+                dds::utils::parallel_for(0, parts, 1, [&](Index q0, Index q1) {
+                    for (Index q = q0; q < q1; ++q) {
+                        const Index r0 = j + rows * q / parts, r1 = j + rows * (q + 1) / parts;
+                        for (Index i = r0; i < r1; ++i) {
+                            const Scalar vi = i == j ? Scalar(1) : p[i * n + j];
+                            dds::utils::simd::axpy(vi, p + i * n + c0, partial[q].data(), static_cast<size_t>(ncols));
+                        }
+                    }
+                });
+                std::vector<Scalar>& w = partial[0];
+                for (Index q = 1; q < parts; ++q) dds::utils::simd::axpy(Scalar(1), partial[q].data(), w.data(), static_cast<size_t>(ncols));
+                dds::utils::parallel_for(j, m, std::max<Index>(64, 32768 / ncols), [&](Index i0, Index i1) {
+                    for (Index i = i0; i < i1; ++i) {
+                        const Scalar vi = i == j ? Scalar(1) : p[i * n + j];
+                        dds::utils::simd::axpy(-tau * vi, w.data(), p + i * n + c0, static_cast<size_t>(ncols));
+                    }
+                });
+            }
+            if (k + kb < n) {
+                panel_reflector(k, kb, v, t);
+                internal::apply_block_reflector(v.data(), t.data(), m - k, kb, true, p + k * n + k + kb, n, n - k - kb);
+            }
+        }
+        info_ = Success;
+        return *this;
+    }
+
+    ComputationInfo info() const { return info_; }
+
+    // R on and above the diagonal, Householder vectors below it (as in Eigen)
+    const Matrix<Scalar>& matrixQR() const { return qr_; }
+    const Vector<Scalar>& hCoeffs() const { return tau_; }
+
+    // Upper-triangular min(m, n) x n factor
+    Matrix<Scalar> matrixR() const {
+        const Index kmax = std::min(qr_.rows(), qr_.cols()), n = qr_.cols();
+        Matrix<Scalar> r = Matrix<Scalar>::Zero(kmax, n);
+        for (Index i = 0; i < kmax; ++i) {
+            std::copy(qr_.data() + i * n + i, qr_.data() + (i + 1) * n, r.data() + i * n + i);
+        }
+        return r;
+    }
+
+    // Thin m x min(m, n) orthonormal factor, reflector blocks applied in reverse
+    Matrix<Scalar> householderQ() const {
+        const Index m = qr_.rows(), kmax = std::min(m, qr_.cols());
+        Matrix<Scalar> q = Matrix<Scalar>::Zero(m, kmax);
+        for (Index i = 0; i < kmax; ++i) q(i, i) = Scalar(1);
+        std::vector<Scalar> v, t;
+        const Index last = kmax == 0 ? 0 : (kmax - 1) / internal::kFactorBlock * internal::kFactorBlock;
+        for (Index k = last; k >= 0 && kmax > 0; k -= internal::kFactorBlock) {
+            const Index kb = std::min(internal::kFactorBlock, kmax - k);
+            panel_reflector(k, kb, v, t);
+            internal::apply_block_reflector(v.data(), t.data(), m - k, kb, false, q.data() + k * kmax + k, kmax, kmax - k);
+        }
+        return q;
+    }
+
+    // Least-squares solution of A x = b for m >= n: R x = (Q^T b)(0:n)
+    template<typename Rhs>
+    Rhs solve(const Rhs& b) const {
+        const Index m = qr_.rows(), n = qr_.cols();
+        if (b.rows() != m || m < n) return Rhs();
+        Rhs x = b;
+        const Index r = b.cols();
+        std::vector<Scalar> v, t;
+        for (Index k = 0; k < n; k += internal::kFactorBlock) {
+            const Index kb = std::min(internal::kFactorBlock, n - k);
+            panel_reflector(k, kb, v, t);
+            internal::apply_block_reflector(v.data(), t.data(), m - k, kb, true, x.data() + k * r, r, r);
+        }
+        const Scalar* rp = qr_.data();
+        Scalar* xp = x.data();
+        for (Index i = n - 1; i >= 0; --i) {
+            Scalar* xi = xp + i * r;
+            for (Index q = i + 1; q < n; ++q) dds::utils::simd::axpy(-rp[i * n + q], xp + q * r, xi, static_cast<size_t>(r));
+            dds::utils::simd::scale(Scalar(1) / rp[i * n + i], xi, static_cast<size_t>(r));
+        }
+        internal::resize_rhs(x, n, r);      // Row-major: the first n rows are a prefix
+        return x;
+    }
+
+private:
+    // Explicit V ((m - k) x kb) and T for the reflectors of columns k..k+kb
+    void panel_reflector(Index k, Index kb, std::vector<Scalar>& v, std::vector<Scalar>& t) const {
+        const Index m = qr_.rows(), n = qr_.cols(), rows = m - k;
+        v.assign(static_cast<size_t>(rows * kb), Scalar(0));
+        t.resize(static_cast<size_t>(kb * kb));
+        for (Index r = 0; r < rows; ++r) {
+            for (Index c = 0; c < kb && c <= r; ++c) {
+                v[r * kb + c] = r == c ? Scalar(1) : qr_.data()[(k + r) * n + k + c];
+            }
+        }
+        internal::block_reflector_factor(v.data(), rows, kb, tau_.data() + k, t.data());
+    }
+
+    Matrix<Scalar> qr_;
+    Vector<Scalar> tau_;
+    ComputationInfo info_ = InvalidInput;
+};
+
+// Eigendecomposition of a symmetric matrix; eigenvalues ascending, eigenvectors as
+// columns. Householder tridiagonalization in panels (LAPACK dsytrd/dlatrd: half the
+// flops are a rank-2k gemm update), implicit-shift QL on the tridiagonal with its
+// Givens rotations applied to the eigenvector rows in parallel, then a blocked
+// back-transformation.
+template<typename Scalar>
+class SelfAdjointEigenSolver {
+public:
+    SelfAdjointEigenSolver() = default;
+    explicit SelfAdjointEigenSolver(const Matrix<Scalar>& a, int options = ComputeEigenvectors) { compute(a, options); }
+
+    SelfAdjointEigenSolver& compute(const Matrix<Scalar>& a, int options = ComputeEigenvectors) {
+        const Index n = a.rows();
+        info_ = InvalidInput;
+        if (a.cols() != n) return *this;
+        const bool vectors = (options & EigenvaluesOnly) == 0;
+
+        Matrix<Scalar> h = a;
+        std::vector<double> d(static_cast<size_t>(n)), e(static_cast<size_t>(n), 0.0);
+        std::vector<Scalar> tau(static_cast<size_t>(n), Scalar(0));
+        tridiagonalize(h, d, e, tau);
+
+        // Rows of zt are the eigenvectors of the tridiagonal matrix
+        Matrix<Scalar> zt;
+        if (vectors) zt = Matrix<Scalar>::Identity(n);
+        info_ = tridiagonal_ql(d, e, vectors ? &zt : nullptr);
+        if (info_ != Success) return *this;
+
+        std::vector<Index> order(static_cast<size_t>(n));
+        std::iota(order.begin(), order.end(), Index(0));
+        std::sort(order.begin(), order.end(), [&d](Index x, Index y) { return d[x] < d[y]; });
+        eigenvalues_.resize(n);
+        for (Index i = 0; i < n; ++i) eigenvalues_[i] = static_cast<Scalar>(d[order[i]]);
+        if (!vectors) {
+            eigenvectors_ = Matrix<Scalar>();
+            return *this;
+        }
+
+        Matrix<Scalar> sorted(n, n);
+        for (Index i = 0; i < n; ++i) {
+            std::copy(zt.data() + order[i] * n, zt.data() + (order[i] + 1) * n, sorted.data() + i * n);
+        }
+        eigenvectors_ = sorted.transpose();
+        back_transform(h, tau, eigenvectors_);
+        return *this;
+    }
+
+    ComputationInfo info() const { return info_; }
+    const Vector<Scalar>& eigenvalues() const { return eigenvalues_; }
+    const Matrix<Scalar>& eigenvectors() const { return eigenvectors_; }
+
+private:
+    // Reduces h to tridiagonal (d, e) with reflectors H_j = I - tau_j v_j v_j^T, where
+    // v_j = [0 .. 0, 1, h(j, j+2:n)] (the 1 at index j + 1)
+    static void tridiagonalize(Matrix<Scalar>& h, std::vector<double>& d, std::vector<double>& e, std::vector<Scalar>& tau) {
+        const Index n = h.rows();
+        const Index reflectors = std::max<Index>(0, n - 2);
+        Scalar* hp = h.data();
+        // Row jj of vt/wt is the panel's jj-th reflector / update vector, indexed globally
+        Matrix<Scalar> vt(internal::kFactorBlock, n), wt(internal::kFactorBlock, n);
+        std::vector<Scalar> y(static_cast<size_t>(n));
+
+        for (Index k0 = 0; k0 < reflectors; k0 += internal::kFactorBlock) {
+            const Index kb = std::min(internal::kFactorBlock, reflectors - k0);
+            vt.setZero();
+            wt.setZero();
+            for (Index jj = 0; jj < kb; ++jj) {
+                const Index j = k0 + jj;
+                const Index len = n - j - 1;
+                Scalar* hj = hp + j * n;
+                // Bring row j up to date with this panel's earlier reflectors
+                for (Index q = 0; q < jj; ++q) {
+                    const Scalar* vq = vt.data() + q * n;
+                    const Scalar* wq = wt.data() + q * n;
+                    dds::utils::simd::axpy(-vq[j], wq + j, hj + j, static_cast<size_t>(n - j));
+                    dds::utils::simd::axpy(-wq[j], vq + j, hj + j, static_cast<size_t>(n - j));
+                }
+                d[j] = hj[j];
+                tau[j] = internal::make_householder(hj[j + 1], hj + j + 2, len - 1, 1);
+                e[j] = hj[j + 1];
+                const Scalar tj = tau[j];
+                Scalar* v = vt.data() + jj * n + j + 1;
+                v[0] = Scalar(1);
+                std::copy(hj + j + 2, hj + n, v + 1);
+                if (tj == Scalar(0)) continue;
+
+                // y = A22 v on the not-yet-updated trailing block, then subtract the
+                // panel's pending (V W^T + W V^T) v
+                dds::utils::parallel_for(j + 1, n, std::max<Index>(16, 32768 / len), [&](Index i0, Index i1) {
+                    for (Index i = i0; i < i1; ++i) {
+                        y[i] = static_cast<Scalar>(dds::utils::simd::dot(hp + i * n + j + 1, v, static_cast<size_t>(len)));
+                    }
+                });
+                Scalar* yj = y.data() + j + 1;
+                for (Index q = 0; q < jj; ++q) {
+                    const Scalar* vq = vt.data() + q * n + j + 1;
+                    const Scalar* wq = wt.data() + q * n + j + 1;
+                    const Scalar wv = static_cast<Scalar>(dds::utils::simd::dot(wq, v, static_cast<size_t>(len)));
+                    const Scalar vv = static_cast<Scalar>(dds::utils::simd::dot(vq, v, static_cast<size_t>(len)));
+                    dds::utils::simd::axpy(-wv, vq, yj, static_cast<size_t>(len));
+                    dds::utils::simd::axpy(-vv, wq, yj, static_cast<size_t>(len));
+                }
+                // w = tau y - (tau^2 / 2)(y^T v) v
+                const double yv = dds::utils::simd::dot(yj, v, static_cast<size_t>(len));
+                Scalar* w = wt.data() + jj * n + j + 1;
+                const Scalar alpha = static_cast<Scalar>(-0.5 * tj * tj * yv);
+                for (Index i = 0; i < len; ++i) w[i] = tj * yj[i] + alpha * v[i];
+            }
+
+            // Trailing block -= V W^T + W V^T
+            const Index t0 = k0 + kb, size = n - t0;
+            internal::gemm_kernel(true, false, size, size, kb, Scalar(-1), vt.data() + t0, n, wt.data() + t0, n, hp + t0 * n + t0, n);
+            internal::gemm_kernel(true, false, size, size, kb, Scalar(-1), wt.data() + t0, n, vt.data() + t0, n, hp + t0 * n + t0, n);
+        }
+
+        for (Index j = reflectors; j < n; ++j) {
+            d[j] = hp[j * n + j];
+            if (j + 1 < n) e[j] = hp[j * n + j + 1];
+        }
+    }
+
+    // Implicit QL with Wilkinson shifts (tqli); e[i] couples d[i] and d[i + 1]. Each
+    // sweep's rotations are recorded, then applied to column slices of zt in parallel.
+    static ComputationInfo tridiagonal_ql(std::vector<double>& d, std::vector<double>& e, Matrix<Scalar>* zt) {
+        const Index n = static_cast<Index>(d.size());
+        const double eps = std::numeric_limits<double>::epsilon();
+        struct Rotation { Index i; double c, s; };
+        std::vector<Rotation> rotations;
+
+        for (Index l = 0; l < n; ++l) {
+            int iterations = 0;
+            Index m;
+            do {
+                for (m = l; m < n - 1; ++m) {
+                    const double dd = std::abs(d[m]) + std::abs(d[m + 1]);
+                    if (std::abs(e[m]) <= eps * dd) break;
+                }
+                if (m == l) break;
+                if (iterations++ == 60) return NoConvergence;
+
+                double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+                double r = std::hypot(g, 1.0);
+                g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+                double s = 1.0, c = 1.0, p = 0.0;
+                Index i;
+                rotations.clear();
+                for (i = m - 1; i >= l; --i) {
+                    double f = s * e[i];
+                    const double b = c * e[i];
+                    e[i + 1] = (r = std::hypot(f, g));
+                    if (r == 0.0) {
+                        d[i + 1] -= p;
+                        e[m] = 0.0;
+                        break;
+                    }
+                    s = f / r;
+                    c = g / r;
+                    g = d[i + 1] - p;
+                    r = (d[i] - g) * s + 2.0 * c * b;
+                    d[i + 1] = g + (p = s * r);
+                    g = c * r - b;
+                    rotations.push_back({i, c, s});
+                }
+                if (zt) apply_rotations(rotations, *zt);
+                if (r == 0.0 && i >= l) continue;
+                d[l] -= p;
+                e[l] = g;
+                e[m] = 0.0;
+            } while (true);
+        }
+        return Success;
+    }
+
+    template<typename Rotations>
+    static void apply_rotations(const Rotations& rotations, Matrix<Scalar>& zt) {
+        if (rotations.empty()) return;
+        const Index n = zt.cols();
+        const Index grain = std::max<Index>(64, 16384 / static_cast<Index>(rotations.size()));
+        dds::utils::parallel_for(0, n, grain, [&](Index c0, Index c1) {
+            for (const auto& rot : rotations) {
+                Scalar* zi = zt.data() + rot.i * n;
+                Scalar* zi1 = zi + n;
+                const Scalar c = static_cast<Scalar>(rot.c), s = static_cast<Scalar>(rot.s);
+                for (Index col = c0; col < c1; ++col) {
+                    const Scalar f = zi1[col];
+                    zi1[col] = s * zi[col] + c * f;
+                    zi[col] = c * zi[col] - s * f;
+                }
+            }
+        });
+    }
+
+    // z = H_0 H_1 ... H_{n-3} z, one block reflector per tridiagonalization panel
+    static void back_transform(const Matrix<Scalar>& h, const std::vector<Scalar>& tau, Matrix<Scalar>& z) {
+        const Index n = h.rows();
+        const Index reflectors = std::max<Index>(0, n - 2);
+        if (reflectors == 0) return;
+        std::vector<Scalar> v, t(static_cast<size_t>(internal::kFactorBlock * internal::kFactorBlock));
+        const Index last = (reflectors - 1) / internal::kFactorBlock * internal::kFactorBlock;
+        for (Index k0 = last; k0 >= 0; k0 -= internal::kFactorBlock) {
+            const Index kb = std::min(internal::kFactorBlock, reflectors - k0);
+            const Index rows = n - k0 - 1;
+            // Local row r is global row k0 + 1 + r; reflector jj has its 1 at local row jj
+            v.assign(static_cast<size_t>(rows * kb), Scalar(0));
+            for (Index jj = 0; jj < kb; ++jj) {
+                const Scalar* hj = h.data() + (k0 + jj) * n;
+                v[jj * kb + jj] = Scalar(1);
+                for (Index r = jj + 1; r < rows; ++r) v[r * kb + jj] = hj[k0 + 1 + r];
+            }
+            internal::block_reflector_factor(v.data(), rows, kb, tau.data() + k0, t.data());
+            internal::apply_block_reflector(v.data(), t.data(), rows, kb, false, z.data() + (k0 + 1) * n, n, n);
+        }
+    }
+
+    Vector<Scalar> eigenvalues_;
+    Matrix<Scalar> eigenvectors_;
+    ComputationInfo info_ = InvalidInput;
+};
+
+// Singular value decomposition A = U S V^T by one-sided (Hestenes) Jacobi: inputs
+// with more rows than columns are first reduced to R with HouseholderQR. Each sweep
+// is a round-robin tournament whose n / 2 disjoint column pairs rotate in parallel.
+// Singular values come out descending; Full and Thin options both give thin U and V.
+template<typename Scalar>
+class JacobiSVD {
+public:
+    JacobiSVD() = default;
+    explicit JacobiSVD(const Matrix<Scalar>& a, unsigned options = 0) { compute(a, options); }
+
+    JacobiSVD& compute(const Matrix<Scalar>& a, unsigned options = 0) {
+        const Index m = a.rows(), n = a.cols();
+        compute_u_ = (options & (ComputeThinU | ComputeFullU)) != 0;
+        compute_v_ = (options & (ComputeThinV | ComputeFullV)) != 0;
+        rows_ = m;
+        cols_ = n;
+        if (m < n) {
+            // A^T = U' S V'^T, so A = V' S U'^T
+            unsigned swapped = (compute_u_ ? static_cast<unsigned>(ComputeThinV) : 0u) |
+                               (compute_v_ ? static_cast<unsigned>(ComputeThinU) : 0u);
+            JacobiSVD<Scalar> t(a.transpose(), swapped);
+            singular_values_ = t.singular_values_;
+            u_ = t.v_;
+            v_ = t.u_;
+            info_ = t.info_;
+            rows_ = m;
+            cols_ = n;
+            return *this;
+        }
+
+        HouseholderQR<Scalar> qr;
+        Matrix<Scalar> w;                       // Rows are the columns being orthogonalized
+        if (m > n) {
+            qr.compute(a);
+            w = qr.matrixR().transpose();
+        } else {
+            w = a.transpose();
+        }
+        Matrix<Scalar> vt;
+        if (compute_v_) vt = Matrix<Scalar>::Identity(n);
+        info_ = orthogonalize(w, compute_v_ ? &vt : nullptr);
+
+        std::vector<double> norms(static_cast<size_t>(n));
+        for (Index i = 0; i < n; ++i) {
+            norms[i] = std::sqrt(dds::utils::simd::squared_norm(w.data() + i * n, static_cast<size_t>(n)));
+        }
+        std::vector<Index> order(static_cast<size_t>(n));
+        std::iota(order.begin(), order.end(), Index(0));
+        std::sort(order.begin(), order.end(), [&norms](Index x, Index y) { return norms[x] > norms[y]; });
+        singular_values_.resize(n);
+        for (Index i = 0; i < n; ++i) singular_values_[i] = static_cast<Scalar>(norms[order[i]]);
+
+        if (compute_u_) {
+            Matrix<Scalar> ut(n, n);
+            for (Index i = 0; i < n; ++i) {
+                const double sigma = norms[order[i]];
+                const Scalar inv = sigma > 0 ? static_cast<Scalar>(1.0 / sigma) : Scalar(0);
+                const Scalar* src = w.data() + order[i] * n;
+                Scalar* dst = ut.data() + i * n;
+                for (Index j = 0; j < n; ++j) dst[j] = src[j] * inv;
+            }
+            if (m > n) {
+                u_ = qr.householderQ() * ut.transpose();
+            } else {
+                u_ = ut.transpose();
+            }
+        }
+        if (compute_v_) {
+            Matrix<Scalar> sorted(n, n);
+            for (Index i = 0; i < n; ++i) {
+                std::copy(vt.data() + order[i] * n, vt.data() + (order[i] + 1) * n, sorted.data() + i * n);
+            }
+            v_ = sorted.transpose();
+        }
+        return *this;
+    }
+
+    ComputationInfo info() const { return info_; }
+    const Vector<Scalar>& singularValues() const { return singular_values_; }
+    const Matrix<Scalar>& matrixU() const { return u_; }
+    const Matrix<Scalar>& matrixV() const { return v_; }
+    bool computeU() const { return compute_u_; }
+    bool computeV() const { return compute_v_; }
+
+    // Singular values above max(m, n) * eps * sigma_max, as Eigen's default threshold
+    double threshold() const {
+        if (singular_values_.size() == 0) return 0.0;
+        return static_cast<double>(std::max(rows_, cols_)) * std::numeric_limits<Scalar>::epsilon() * singular_values_[0];
+    }
+
+    Index rank() const {
+        Index r = 0;
+        const double cutoff = threshold();
+        for (Index i = 0; i < singular_values_.size(); ++i) {
+            if (singular_values_[i] > cutoff) ++r;
+        }
+        return r;
+    }
+
+    // Minimum-norm least-squares solution V S^+ U^T b; needs U and V
+    template<typename Rhs>
+    Rhs solve(const Rhs& b) const {
+        if (!compute_u_ || !compute_v_ || b.rows() != rows_) return Rhs();
+        Matrix<Scalar> utb;
+        gemm(Trans, NoTrans, Scalar(1), u_, b, Scalar(0), utb);
+        const Index r = utb.cols(), keep = rank();
+        for (Index i = 0; i < utb.rows(); ++i) {
+            const Scalar inv = i < keep ? Scalar(1) / singular_values_[i] : Scalar(0);
+            dds::utils::simd::scale(inv, utb.data() + i * r, static_cast<size_t>(r));
+        }
+        Matrix<Scalar> solution = v_ * utb;
+        Rhs x = b;
+        internal::resize_rhs(x, cols_, r);
+        std::copy(solution.data(), solution.data() + solution.size(), x.data());
+        return x;
+    }
+
+private:
+    // Rotates pairs of rows of w until all are mutually orthogonal, applying the same
+    // rotations to vt
+    static ComputationInfo orthogonalize(Matrix<Scalar>& w, Matrix<Scalar>* vt) {
+        const Index n = w.rows(), len = w.cols();
+        if (n < 2) return Success;
+        const double tol = 8.0 * std::numeric_limits<Scalar>::epsilon();
+        const Index players = n + (n & 1);     // Odd n gets a bye slot
+        std::vector<Index> seats(static_cast<size_t>(players));
+        std::iota(seats.begin(), seats.end(), Index(0));
+        const Index pairs = players / 2;
+        const Index grain = std::max<Index>(1, 4096 / len);
+
+        for (int sweep = 0; sweep < 60; ++sweep) {
+            std::atomic<bool> rotated(false);
+            for (Index round = 0; round < players - 1; ++round) {
+                dds::utils::parallel_for(0, pairs, grain, [&](Index q0, Index q1) {
+                    bool any = false;
+                    for (Index q = q0; q < q1; ++q) {
+                        Index i = seats[q], j = seats[players - 1 - q];
+                        if (i >= n || j >= n) continue;
+                        if (i > j) std::swap(i, j);
+                        any |= rotate(w, vt, i, j, len, tol);
+                    }
+                    if (any) rotated.store(true, std::memory_order_relaxed);
+                });
+                std::rotate(seats.begin() + 1, seats.end() - 1, seats.end());
+            }
+            if (!rotated.load()) return Success;
+        }
+        return NoConvergence;
+    }
+
+    static bool rotate(Matrix<Scalar>& w, Matrix<Scalar>* vt, Index i, Index j, Index len, double tol) {
+        Scalar* wi = w.data() + i * len;
+        Scalar* wj = w.data() + j * len;
+        const double alpha = dds::utils::simd::squared_norm(wi, static_cast<size_t>(len));
+        const double beta = dds::utils::simd::squared_norm(wj, static_cast<size_t>(len));
+        const double gamma = dds::utils::simd::dot(wi, wj, static_cast<size_t>(len));
+        if (alpha == 0 || beta == 0 || std::abs(gamma) <= tol * std::sqrt(alpha * beta)) return false;
+
+        const double zeta = (beta - alpha) / (2.0 * gamma);
+        const double t = std::copysign(1.0, zeta) / (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+        const double cd = 1.0 / std::sqrt(1.0 + t * t);
+        const Scalar c = static_cast<Scalar>(cd), s = static_cast<Scalar>(cd * t);
+        rotate_rows(wi, wj, c, s, len);
+        if (vt) rotate_rows(vt->data() + i * vt->cols(), vt->data() + j * vt->cols(), c, s, vt->cols());
+        return true;
+    }
+
+    static void rotate_rows(Scalar* x, Scalar* y, Scalar c, Scalar s, Index len) {
+        for (Index k = 0; k < len; ++k) {
+            const Scalar xk = x[k], yk = y[k];
+            x[k] = c * xk - s * yk;
+            y[k] = s * xk + c * yk;
+        }
+    }
+
+    Vector<Scalar> singular_values_;
+    Matrix<Scalar> u_;
+    Matrix<Scalar> v_;
+    Index rows_ = 0;
+    Index cols_ = 0;
+    bool compute_u_ = false;
+    bool compute_v_ = false;
+    ComputationInfo info_ = InvalidInput;
+};
+
+} // namespace Eigen
@@ -5,12 +5,32 @@
 
 #include <vector>
 #include <cstddef>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <utility>
+#include "parallel.h"
+#include "simd.h"
+#include "random.h"
 
 namespace Eigen {
 
 // Basic types
 using Index = std::ptrdiff_t;
 
+template<typename Scalar> class Matrix;
+template<typename Scalar> class Transpose;
+
+// Operand transposition for gemm()
+enum GemmOp {
+    NoTrans = 0,
+    Trans = 1
+};
+
+template<typename Scalar>
+void gemm(GemmOp op_a, GemmOp op_b, Scalar alpha, const Matrix<Scalar>& a, const Matrix<Scalar>& b,
+          Scalar beta, Matrix<Scalar>& c);
+
 // Matrix class stub
 template<typename Scalar>
 class Matrix {
@@ -46,11 +66,10 @@ public:
         std::fill(data_.begin(), data_.end(), Scalar(1));
     }
     
+    // Uniform in [0, 1) from a fresh stream of the process-wide generator; repeatable
+    // after dds::utils::set_global_seed()
     void setRandom() {
-        // Simple random initialization
-        for (auto& val : data_) {
-            val = Scalar(rand()) / Scalar(RAND_MAX);
-        }
+        dds::utils::global_stream().fill_uniform(data_.data(), data_.size(), Scalar(0), Scalar(1));
     }
     
     Matrix operator+(const Matrix& other) const {
@@ -70,16 +89,15 @@ public:
     }
     
     Matrix operator*(const Matrix& other) const {
-        Matrix result(rows_, other.cols_);
-        for (Index i = 0; i < rows_; ++i) {
-            for (Index j = 0; j < other.cols_; ++j) {
-                Scalar sum = 0;
-                for (Index k = 0; k < cols_; ++k) {
-                    sum += (*this)(i, k) * other(k, j);
-                }
-                result(i, j) = sum;
-            }
-        }
+        Matrix result;
+        gemm(NoTrans, NoTrans, Scalar(1), *this, other, Scalar(0), result);
+        return result;
+    }
+    
+    // this * other^T straight from other's storage (e.g. X * W^T)
+    Matrix operator*(const Transpose<Scalar>& other) const {
+        Matrix result;
+        gemm(NoTrans, Trans, Scalar(1), *this, other.nestedExpression(), Scalar(0), result);
         return result;
     }
     
@@ -121,20 +139,23 @@ public:
         return *this;
     }
     
+    // Reductions accumulate in double whatever the storage type
     Scalar norm() const {
-        Scalar sum = 0;
-        for (const auto& val : data_) {
-            sum += val * val;
-        }
-        return std::sqrt(sum);
+        return static_cast<Scalar>(std::sqrt(dds::utils::simd::squared_norm(data_.data(), data_.size())));
     }
     
     Scalar squaredNorm() const {
-        Scalar sum = 0;
-        for (const auto& val : data_) {
-            sum += val * val;
+        return static_cast<Scalar>(dds::utils::simd::squared_norm(data_.data(), data_.size()));
+    }
+    
+    // Element type conversion, e.g. float32 storage of a float64 model
+    template<typename NewScalar>
+    Matrix<NewScalar> cast() const {
+        Matrix<NewScalar> result(rows_, cols_);
+        for (size_t i = 0; i < data_.size(); ++i) {
+            result.data()[i] = static_cast<NewScalar>(data_[i]);
         }
-        return sum;
+        return result;
     }
     
     void fill(Scalar value) {
@@ -160,15 +181,9 @@ public:
         return min_val;
     }
     
-    // Transpose
-    Matrix transpose() const {
-        Matrix result(cols_, rows_);
-        for (Index i = 0; i < rows_; ++i) {
-            for (Index j = 0; j < cols_; ++j) {
-                result(j, i) = (*this)(i, j);
-            }
-        }
-        return result;
+    // Transpose (lazy; see Transpose below)
+    Transpose<Scalar> transpose() const {
+        return Transpose<Scalar>(*this);
     }
     
     // Block operation
@@ -296,24 +311,16 @@ public:
     
     // Vector-specific operations
     Scalar dot(const Vector& other) const {
-        Scalar result = 0;
-        for (Index i = 0; i < size(); ++i) {
-            result += (*this)[i] * other[i];
-        }
-        return result;
+        return static_cast<Scalar>(dds::utils::simd::dot(this->data(), other.data(), static_cast<size_t>(size())));
     }
     
     // Additional vector operations
     Scalar sum() const {
-        Scalar result = 0;
-        for (Index i = 0; i < size(); ++i) {
-            result += (*this)[i];
-        }
-        return result;
+        return static_cast<Scalar>(dds::utils::simd::sum(this->data(), static_cast<size_t>(size())));
     }
     
     Scalar mean() const {
-        return sum() / size();
+        return static_cast<Scalar>(dds::utils::simd::sum(this->data(), static_cast<size_t>(size())) / size());
     }
     
     Scalar minCoeff() const {
@@ -334,11 +341,11 @@ public:
         return max_val;
     }
     
-    Matrix cwiseProduct(const Matrix& other) const {
+    Matrix<Scalar> cwiseProduct(const Matrix<Scalar>& other) const {
         if (this->rows() != other.rows() || this->cols() != other.cols()) {
-            return Matrix();
+            return Matrix<Scalar>();
         }
-        Matrix result(this->rows(), this->cols());
+        Matrix<Scalar> result(this->rows(), this->cols());
         for (Index i = 0; i < this->size(); ++i) {
             result.data()[i] = (*this)[i] * other.data()[i];
         }
@@ -346,11 +353,7 @@ public:
     }
     
     Scalar squaredNorm() const {
-        Scalar result = 0;
-        for (Index i = 0; i < size(); ++i) {
-            result += (*this)[i] * (*this)[i];
-        }
-        return result;
+        return static_cast<Scalar>(dds::utils::simd::squared_norm(this->data(), static_cast<size_t>(size())));
     }
     
     // Static constructors for constant vectors
@@ -394,6 +397,668 @@ public:
     }
 };
 
+// Lazy transpose returned by Matrix::transpose(). Products with it run the NT/TN/TT
+// gemm kernels on the original storage; assigning it to a Matrix materializes the copy.
+// It holds a reference, so it must not outlive the expression that created it.
+template<typename Scalar>
+class Transpose {
+public:
+    explicit Transpose(const Matrix<Scalar>& matrix) : matrix_(matrix) {}
+    
+    Index rows() const { return matrix_.cols(); }
+    Index cols() const { return matrix_.rows(); }
+    Index size() const { return matrix_.size(); }
+    
+    Scalar operator()(Index i, Index j) const { return matrix_(j, i); }
+    
+    const Matrix<Scalar>& nestedExpression() const { return matrix_; }
+    const Matrix<Scalar>& transpose() const { return matrix_; }
+    
+    // Copy in 32x32 tiles so both sides stay in cache
+    Matrix<Scalar> eval() const {
+        const Index r = matrix_.rows(), c = matrix_.cols();
+        Matrix<Scalar> result(c, r);
+        const Scalar* src = matrix_.data();
+        Scalar* dst = result.data();
+        for (Index i0 = 0; i0 < r; i0 += 32) {
+            for (Index j0 = 0; j0 < c; j0 += 32) {
+                const Index i1 = std::min(r, i0 + 32), j1 = std::min(c, j0 + 32);
+                for (Index i = i0; i < i1; ++i) {
+                    for (Index j = j0; j < j1; ++j) dst[j * r + i] = src[i * c + j];
+                }
+            }
+        }
+        return result;
+    }
+    
+    operator Matrix<Scalar>() const { return eval(); }
+    
+    Matrix<Scalar> operator*(const Matrix<Scalar>& other) const {
+        Matrix<Scalar> result;
+        gemm(Trans, NoTrans, Scalar(1), matrix_, other, Scalar(0), result);
+        return result;
+    }
+    
+    Matrix<Scalar> operator*(const Transpose& other) const {
+        Matrix<Scalar> result;
+        gemm(Trans, Trans, Scalar(1), matrix_, other.matrix_, Scalar(0), result);
+        return result;
+    }
+
+private:
+    const Matrix<Scalar>& matrix_;
+};
+
+namespace internal {
+
+// gemm cache blocking: a kc x nc panel of op(B) (256 KB float, 512 KB double) stays
+// in L2 while mc-row slabs of op(A) are multiplied against it
+constexpr Index kGemmMc = 64;
+constexpr Index kGemmKc = 256;
+constexpr Index kGemmNc = 256;
+
+// Copies op(x)[r0:r0+rows, c0:c0+cols] into a row-major buffer (x has leading
+// dimension ld). This is the only
+// place a transposed operand is rearranged, one cache-sized block at a time.
+template<typename Scalar>
+void gemm_pack(const Scalar* src, Index ld, bool trans, Index r0, Index c0, Index rows, Index cols, Scalar* dst) {
+    if (!trans) {
+        for (Index r = 0; r < rows; ++r) {
+            const Scalar* s = src + (r0 + r) * ld + c0;
+            std::copy(s, s + cols, dst + r * cols);
+        }
+        return;
+    }
+    // op(x)(r, c) = x(c, r): walk rows of x so reads stay contiguous
+    for (Index c = 0; c < cols; ++c) {
+        const Scalar* s = src + (c0 + c) * ld + r0;
+        for (Index r = 0; r < rows; ++r) dst[r * cols + c] = s[r];
+    }
+}
+
+// c[0:mc, 0:nc] += alpha * ap (mc x kc) * bp (kc x nc), c with leading dimension ldc.
+// Register tiles of 4 rows x 2 vectors reuse each packed B load four times.
+template<typename Scalar>
+void gemm_block(Index mc, Index nc, Index kc, Scalar alpha, const Scalar* ap, const Scalar* bp, Scalar* c, Index ldc) {
+    Index i = 0;
+#ifdef DDS_SIMD_VECTOR_EXT
+    using V = dds::utils::simd::Vec<Scalar>;
+    using dds::utils::simd::load;
+    using dds::utils::simd::store;
+    constexpr Index L = static_cast<Index>(dds::utils::simd::lanes<Scalar>());
+    const V va = V{} + alpha;
+    for (; i + 4 <= mc; i += 4) {
+        const Scalar* a0 = ap + i * kc;
+        const Scalar* a1 = a0 + kc;
+        const Scalar* a2 = a1 + kc;
+        const Scalar* a3 = a2 + kc;
+        Index j = 0;
+        for (; j + 2 * L <= nc; j += 2 * L) {
+            V c00 = {}, c01 = {}, c10 = {}, c11 = {}, c20 = {}, c21 = {}, c30 = {}, c31 = {};
+            const Scalar* b = bp + j;
+            for (Index k = 0; k < kc; ++k, b += nc) {
+                const V b0 = load(b), b1 = load(b + L);
+                V x = V{} + a0[k]; c00 += x * b0; c01 += x * b1;
+                x = V{} + a1[k]; c10 += x * b0; c11 += x * b1;
+                x = V{} + a2[k]; c20 += x * b0; c21 += x * b1;
+                x = V{} + a3[k]; c30 += x * b0; c31 += x * b1;
+            }
+            Scalar* cr = c + i * ldc + j;
+            store(cr, load(cr) + va * c00); store(cr + L, load(cr + L) + va * c01); cr += ldc;
+            store(cr, load(cr) + va * c10); store(cr + L, load(cr + L) + va * c11); cr += ldc;
+            store(cr, load(cr) + va * c20); store(cr + L, load(cr + L) + va * c21); cr += ldc;
+            store(cr, load(cr) + va * c30); store(cr + L, load(cr + L) + va * c31);
+        }
+        for (; j < nc; ++j) {
+            Scalar s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            for (Index k = 0; k < kc; ++k) {
+                const Scalar bk = bp[k * nc + j];
+                s0 += a0[k] * bk; s1 += a1[k] * bk; s2 += a2[k] * bk; s3 += a3[k] * bk;
+            }
+            c[i * ldc + j] += alpha * s0;
+            c[(i + 1) * ldc + j] += alpha * s1;
+            c[(i + 2) * ldc + j] += alpha * s2;
+            c[(i + 3) * ldc + j] += alpha * s3;
+        }
+    }
+#endif
+    // Leftover rows (every row without vector extensions)
+    for (; i < mc; ++i) {
+        Scalar* cr = c + i * ldc;
+        for (Index k = 0; k < kc; ++k) {
+            dds::utils::simd::axpy(alpha * ap[i * kc + k], bp + k * nc, cr, static_cast<size_t>(nc));
+        }
+    }
+}
+
+} // namespace internal
+
+namespace internal {
+
+// Strided core of gemm(): c (m x n, leading dimension ldc) += alpha * op(a) * op(b),
+// where op(a) is m x k and op(b) is k x n. Works on sub-blocks of larger matrices,
+// which is how the blocked factorizations update trailing submatrices in place.
+template<typename Scalar>
+void gemm_kernel(bool ta, bool tb, Index m, Index n, Index k, Scalar alpha,
+                 const Scalar* a, Index lda, const Scalar* b, Index ldb, Scalar* c, Index ldc) {
+    if (m == 0 || n == 0 || k == 0) return;
+    
+    const Index threads = static_cast<Index>(dds::utils::max_threads());
+    if (n == 1 && !ta && (tb || ldb == 1)) {
+        // Matrix-vector: op(b) is a contiguous k-vector, one dot per row
+        const Index grain = std::max<Index>(16, (Index(1) << 16) / k);
+        dds::utils::parallel_for(0, m, std::max(grain, m / (4 * threads)), [&](Index i0, Index i1) {
+            for (Index i = i0; i < i1; ++i) {
+                c[i * ldc] += alpha * static_cast<Scalar>(dds::utils::simd::dot(a + i * lda, b, static_cast<size_t>(k)));
+            }
+        });
+        return;
+    }
+    
+    // Packing buffers are per thread and kept between calls, so a steady stream of
+    // same-sized products (a training loop) does not touch the heap. The B panel is
+    // packed by the caller and read by every worker, so the workers get a pointer to
+    // the caller's buffer rather than naming their own (empty) thread_local copy.
+    static thread_local std::vector<Scalar> bp_buffer;
+    if (bp_buffer.size() < static_cast<size_t>(kGemmKc * kGemmNc)) {
+        bp_buffer.resize(static_cast<size_t>(kGemmKc * kGemmNc));
+    }
+    Scalar* const bp = bp_buffer.data();
+    for (Index jc = 0; jc < n; jc += kGemmNc) {
+        const Index nc = std::min(kGemmNc, n - jc);
+        for (Index pc = 0; pc < k; pc += kGemmKc) {
+            const Index kc = std::min(kGemmKc, k - pc);
+            gemm_pack(b, ldb, tb, pc, jc, kc, nc, bp);
+            // Each chunk gets at least ~64K multiply-adds, rounded to whole register tiles
+            Index grain = std::max<Index>(4, (Index(1) << 16) / (nc * kc));
+            grain = std::max(grain, (m / threads + 3) / 4 * 4);
+            dds::utils::parallel_for(0, m, grain, [&](Index i0, Index i1) {
+                static thread_local std::vector<Scalar> ap;
+                if (ap.size() < static_cast<size_t>(kGemmMc * kc)) ap.resize(static_cast<size_t>(kGemmMc * kc));
+                for (Index ic = i0; ic < i1; ic += kGemmMc) {
+                    const Index mc = std::min(kGemmMc, i1 - ic);
+                    gemm_pack(a, lda, ta, ic, pc, mc, kc, ap.data());
+                    gemm_block(mc, nc, kc, alpha, ap.data(), bp, c + ic * ldc + jc, ldc);
+                }
+            });
+        }
+    }
+}
+
+} // namespace internal
+
+// c = alpha * op(a) * op(b) + beta * c, op() being the identity (NoTrans) or the
+// transpose (Trans), so X * W^T, G^T * X and friends never copy an operand whole.
+// Blocked and packed (GotoBLAS-style), parallel over row slabs of c. With beta == 0
+// c is resized to fit and need not be initialized; c must not alias a or b.
+template<typename Scalar>
+void gemm(GemmOp op_a, GemmOp op_b, Scalar alpha, const Matrix<Scalar>& a, const Matrix<Scalar>& b,
+          Scalar beta, Matrix<Scalar>& c) {
+    const bool ta = op_a == Trans, tb = op_b == Trans;
+    const Index m = ta ? a.cols() : a.rows();
+    const Index k = ta ? a.rows() : a.cols();
+    const Index n = tb ? b.rows() : b.cols();
+    if (beta == Scalar(0)) {
+        c.resize(m, n);
+        c.setZero();
+    } else if (beta != Scalar(1)) {
+        c *= beta;
+    }
+    internal::gemm_kernel(ta, tb, m, n, k, alpha, a.data(), a.cols(), b.data(), b.cols(), c.data(), n);
+}
+
+// Storage order flags (only meaningful for SparseMatrix; dense matrices are row-major)
+enum StorageOptions {
+    ColMajor = 0,
+    RowMajor = 1
+};
+
+// (row, col, value) entry used to build sparse matrices
+template<typename Scalar>
+class Triplet {
+public:
+    Triplet() : row_(0), col_(0), value_(0) {}
+    Triplet(Index row, Index col, Scalar value) : row_(row), col_(col), value_(value) {}
+
+    Index row() const { return row_; }
+    Index col() const { return col_; }
+    Scalar value() const { return value_; }
+
+private:
+    Index row_;
+    Index col_;
+    Scalar value_;
+};
+
+namespace internal {
+
+// Rows of work handed to one task; keeps per-chunk cost around 16k nonzeros
+inline Index sparse_grain(Index outer_size, Index nnz, Index inner_work) {
+    Index work = std::max<Index>(nnz, 1) * std::max<Index>(inner_work, 1);
+    return std::max<Index>(1, (16384 * outer_size) / work);
+}
+
+// out.row(o) = sum_p values[p] * rhs.row(inner[p]) for p in outer vector o.
+// This is CSR * dense, or CSC^T * dense.
+template<typename Scalar, typename StorageIndex>
+void sparse_gather(Index outer_size, const Index* outer, const StorageIndex* inner, const Scalar* values,
+                   const Matrix<Scalar>& rhs, Matrix<Scalar>& out) {
+    const Index k = rhs.cols();
+    const Scalar* b = rhs.data();
+    Scalar* c = out.data();
+    dds::utils::parallel_for(0, outer_size, sparse_grain(outer_size, outer[outer_size], k),
+        [&](Index begin, Index end) {
+            for (Index o = begin; o < end; ++o) {
+                Scalar* row = c + o * k;
+                if (k == 1) {
+                    Scalar sum = 0;
+                    for (Index p = outer[o]; p < outer[o + 1]; ++p) sum += values[p] * b[inner[p]];
+                    row[0] = sum;
+                    continue;
+                }
+                std::fill(row, row + k, Scalar(0));
+                for (Index p = outer[o]; p < outer[o + 1]; ++p) {
+                    const Scalar v = values[p];
+                    const Scalar* src = b + static_cast<Index>(inner[p]) * k;
+                    for (Index j = 0; j < k; ++j) row[j] += v * src[j];
+                }
+            }
+        });
+}
+
+// out.row(inner[p]) += values[p] * rhs.row(o) for p in outer vector o.
+// This is CSC * dense, or CSR^T * dense. Outputs collide across outer vectors, so
+// wide right-hand sides are split by column and narrow ones use per-task buffers.
+template<typename Scalar, typename StorageIndex>
+void sparse_scatter(Index outer_size, const Index* outer, const StorageIndex* inner, const Scalar* values,
+                    const Matrix<Scalar>& rhs, Matrix<Scalar>& out) {
+    const Index k = rhs.cols();
+    const Index m = out.rows();
+    const Index nnz = outer[outer_size];
+    const Scalar* b = rhs.data();
+    out.setZero();
+    Scalar* c = out.data();
+
+    const Index threads = static_cast<Index>(dds::utils::max_threads());
+    if (k >= 4 * threads) {
+        dds::utils::parallel_for(0, k, std::max<Index>(1, k / (4 * threads)), [&](Index j0, Index j1) {
+            for (Index o = 0; o < outer_size; ++o) {
+                const Scalar* src = b + o * k;
+                for (Index p = outer[o]; p < outer[o + 1]; ++p) {
+                    const Scalar v = values[p];
+                    Scalar* dst = c + static_cast<Index>(inner[p]) * k;
+                    for (Index j = j0; j < j1; ++j) dst[j] += v * src[j];
+                }
+            }
+        });
+        return;
+    }
+
+    // Cap scratch at ~256 MB and give each part enough nonzeros to be worth it
+    Index parts = std::min<Index>(threads, std::max<Index>(1, nnz * k / 65536));
+    parts = std::min<Index>(parts, std::max<Index>(1, (Index(32) << 20) / std::max<Index>(1, m * k)));
+    std::vector<Matrix<Scalar>> partial(static_cast<size_t>(parts > 1 ? parts - 1 : 0));
+
+    dds::utils::parallel_for(0, parts, 1, [&](Index part0, Index part1) {
+        for (Index part = part0; part < part1; ++part) {
+            Scalar* dst_base = c;
+            if (part > 0) {
+                partial[part - 1] = Matrix<Scalar>::Zero(m, k);
+                dst_base = partial[part - 1].data();
+            }
+            Index o0 = outer_size * part / parts;
+            Index o1 = outer_size * (part + 1) / parts;
+            for (Index o = o0; o < o1; ++o) {
+                const Scalar* src = b + o * k;
+                for (Index p = outer[o]; p < outer[o + 1]; ++p) {
+                    const Scalar v = values[p];
+                    Scalar* dst = dst_base + static_cast<Index>(inner[p]) * k;
+                    for (Index j = 0; j < k; ++j) dst[j] += v * src[j];
+                }
+            }
+        }
+    });
+
+    if (partial.empty()) return;
+    dds::utils::parallel_for(0, m * k, 65536, [&](Index i0, Index i1) {
+        for (const auto& part : partial) {
+            const Scalar* src = part.data();
+            for (Index i = i0; i < i1; ++i) c[i] += src[i];
+        }
+    });
+}
+
+} // namespace internal
+
+// Compressed sparse matrix: CSR for RowMajor, CSC for ColMajor (the default, as in Eigen).
+// Outer vectors are rows (CSR) or columns (CSC). Offsets are Index so the nonzero
+// count is not limited to 2^31; inner indices are StorageIndex (int) to halve their size.
+// Products with dense matrices run multithreaded on the shared utils::ThreadPool.
+template<typename Scalar, int Options = ColMajor, typename StorageIndex = int>
+class SparseMatrix {
+public:
+    static constexpr bool IsRowMajor = (Options & RowMajor) != 0;
+    using TransposeType = SparseMatrix<Scalar, IsRowMajor ? ColMajor : RowMajor, StorageIndex>;
+
+    SparseMatrix() : rows_(0), cols_(0), outer_index_(1, 0) {}
+    SparseMatrix(Index rows, Index cols)
+        : rows_(rows), cols_(cols), outer_index_(static_cast<size_t>(IsRowMajor ? rows : cols) + 1, 0) {}
+
+    // Conversion between CSR and CSC (counting sort, O(nnz))
+    template<int OtherOptions>
+    explicit SparseMatrix(const SparseMatrix<Scalar, OtherOptions, StorageIndex>& other)
+        : SparseMatrix(other.rows(), other.cols()) {
+        if (SparseMatrix<Scalar, OtherOptions, StorageIndex>::IsRowMajor == IsRowMajor) {
+            outer_index_.assign(other.outerIndexPtr(), other.outerIndexPtr() + other.outerSize() + 1);
+            inner_index_.assign(other.innerIndexPtr(), other.innerIndexPtr() + other.nonZeros());
+            values_.assign(other.valuePtr(), other.valuePtr() + other.nonZeros());
+            return;
+        }
+        const Index nnz = other.nonZeros();
+        const Index* src_outer = other.outerIndexPtr();
+        const StorageIndex* src_inner = other.innerIndexPtr();
+        const Scalar* src_values = other.valuePtr();
+        inner_index_.resize(static_cast<size_t>(nnz));
+        values_.resize(static_cast<size_t>(nnz));
+        for (Index p = 0; p < nnz; ++p) ++outer_index_[static_cast<size_t>(src_inner[p]) + 1];
+        for (Index o = 0; o < outerSize(); ++o) outer_index_[o + 1] += outer_index_[o];
+        std::vector<Index> cursor(outer_index_.begin(), outer_index_.end() - 1);
+        for (Index o = 0; o < other.outerSize(); ++o) {
+            for (Index p = src_outer[o]; p < src_outer[o + 1]; ++p) {
+                Index dst = cursor[src_inner[p]]++;
+                inner_index_[dst] = static_cast<StorageIndex>(o);
+                values_[dst] = src_values[p];
+            }
+        }
+    }
+
+    // Dimensions and storage
+    Index rows() const { return rows_; }
+    Index cols() const { return cols_; }
+    Index outerSize() const { return IsRowMajor ? rows_ : cols_; }
+    Index innerSize() const { return IsRowMajor ? cols_ : rows_; }
+    Index nonZeros() const { return static_cast<Index>(values_.size()); }
+    bool isCompressed() const { return true; }
+    void makeCompressed() {}
+
+    const Index* outerIndexPtr() const { return outer_index_.data(); }
+    Index* outerIndexPtr() { return outer_index_.data(); }
+    const StorageIndex* innerIndexPtr() const { return inner_index_.data(); }
+    StorageIndex* innerIndexPtr() { return inner_index_.data(); }
+    const Scalar* valuePtr() const { return values_.data(); }
+    Scalar* valuePtr() { return values_.data(); }
+
+    // Bytes held by the index and value arrays
+    size_t memoryBytes() const {
+        return outer_index_.size() * sizeof(Index) + inner_index_.size() * sizeof(StorageIndex)
+             + values_.size() * sizeof(Scalar);
+    }
+
+    void resize(Index rows, Index cols) {
+        rows_ = rows;
+        cols_ = cols;
+        setZero();
+    }
+
+    void setZero() {
+        outer_index_.assign(static_cast<size_t>(outerSize()) + 1, 0);
+        inner_index_.clear();
+        values_.clear();
+    }
+
+    void reserve(Index nnz) {
+        inner_index_.reserve(static_cast<size_t>(nnz));
+        values_.reserve(static_cast<size_t>(nnz));
+    }
+
+    // Value at (row, col), zero if not stored
+    Scalar coeff(Index row, Index col) const {
+        Index o = IsRowMajor ? row : col;
+        StorageIndex i = static_cast<StorageIndex>(IsRowMajor ? col : row);
+        auto first = inner_index_.begin() + outer_index_[o];
+        auto last = inner_index_.begin() + outer_index_[o + 1];
+        auto it = std::lower_bound(first, last, i);
+        return (it != last && *it == i) ? values_[it - inner_index_.begin()] : Scalar(0);
+    }
+
+    // Build from unordered triplets; duplicate entries are summed
+    template<typename InputIterator>
+    void setFromTriplets(InputIterator begin, InputIterator end) {
+        setZero();
+        for (auto it = begin; it != end; ++it) ++outer_index_[(IsRowMajor ? it->row() : it->col()) + 1];
+        for (Index o = 0; o < outerSize(); ++o) outer_index_[o + 1] += outer_index_[o];
+        inner_index_.resize(static_cast<size_t>(outer_index_.back()));
+        values_.resize(static_cast<size_t>(outer_index_.back()));
+        std::vector<Index> cursor(outer_index_.begin(), outer_index_.end() - 1);
+        for (auto it = begin; it != end; ++it) {
+            Index dst = cursor[IsRowMajor ? it->row() : it->col()]++;
+            inner_index_[dst] = static_cast<StorageIndex>(IsRowMajor ? it->col() : it->row());
+            values_[dst] = it->value();
+        }
+
+        // Sort each outer vector and merge duplicates in place
+        std::vector<std::pair<StorageIndex, Scalar>> scratch;
+        Index write = 0;
+        for (Index o = 0; o < outerSize(); ++o) {
+            Index first = outer_index_[o], last = outer_index_[o + 1];
+            scratch.clear();
+            for (Index p = first; p < last; ++p) scratch.emplace_back(inner_index_[p], values_[p]);
+            std::sort(scratch.begin(), scratch.end(),
+                      [](const std::pair<StorageIndex, Scalar>& a, const std::pair<StorageIndex, Scalar>& b) {
+                          return a.first < b.first;
+                      });
+            outer_index_[o] = write;
+            for (size_t s = 0; s < scratch.size(); ++s) {
+                if (s > 0 && scratch[s].first == scratch[s - 1].first) {
+                    values_[write - 1] += scratch[s].second;
+                    continue;
+                }
+                inner_index_[write] = scratch[s].first;
+                values_[write] = scratch[s].second;
+                ++write;
+            }
+        }
+        outer_index_[outerSize()] = write;
+        inner_index_.resize(static_cast<size_t>(write));
+        values_.resize(static_cast<size_t>(write));
+    }
+
+    // Ordered low-level fill, as in Eigen: startVec(o) for increasing o, then
+    // insertBack with increasing inner index, then finalize().
+    void startVec(Index outer) {
+        for (Index o = filled_outer_ + 1; o <= outer; ++o) outer_index_[o] = nonZeros();
+        filled_outer_ = outer;
+    }
+
+    Scalar& insertBack(Index row, Index col) {
+        inner_index_.push_back(static_cast<StorageIndex>(IsRowMajor ? col : row));
+        values_.push_back(Scalar(0));
+        return values_.back();
+    }
+
+    void finalize() {
+        for (Index o = filled_outer_ + 1; o <= outerSize(); ++o) outer_index_[o] = nonZeros();
+        filled_outer_ = -1;
+    }
+
+    // Iterates the stored entries of one outer vector
+    class InnerIterator {
+    public:
+        InnerIterator(const SparseMatrix& matrix, Index outer)
+            : matrix_(matrix), outer_(outer), p_(matrix.outer_index_[outer]), end_(matrix.outer_index_[outer + 1]) {}
+
+        explicit operator bool() const { return p_ < end_; }
+        InnerIterator& operator++() { ++p_; return *this; }
+        Scalar value() const { return matrix_.values_[p_]; }
+        Index index() const { return matrix_.inner_index_[p_]; }
+        Index row() const { return IsRowMajor ? outer_ : index(); }
+        Index col() const { return IsRowMajor ? index() : outer_; }
+
+    private:
+        const SparseMatrix& matrix_;
+        Index outer_;
+        Index p_;
+        Index end_;
+    };
+
+    // Transpose reuses the arrays under the opposite storage order (no sorting)
+    TransposeType transpose() const {
+        TransposeType result(cols_, rows_);
+        result.assignCompressed(outer_index_, inner_index_, values_);
+        return result;
+    }
+
+    // Take ownership of compressed arrays laid out for this storage order
+    void assignCompressed(std::vector<Index> outer, std::vector<StorageIndex> inner, std::vector<Scalar> values) {
+        outer_index_ = std::move(outer);
+        inner_index_ = std::move(inner);
+        values_ = std::move(values);
+    }
+
+    Matrix<Scalar> toDense() const {
+        Matrix<Scalar> result = Matrix<Scalar>::Zero(rows_, cols_);
+        for (Index o = 0; o < outerSize(); ++o) {
+            for (InnerIterator it(*this, o); it; ++it) result(it.row(), it.col()) = it.value();
+        }
+        return result;
+    }
+
+    // Keep entries with |value| > tolerance
+    static SparseMatrix fromDense(const Matrix<Scalar>& dense, Scalar tolerance = Scalar(0)) {
+        SparseMatrix result(dense.rows(), dense.cols());
+        for (Index o = 0; o < result.outerSize(); ++o) {
+            result.startVec(o);
+            for (Index i = 0; i < result.innerSize(); ++i) {
+                Scalar v = IsRowMajor ? dense(o, i) : dense(i, o);
+                if (std::abs(v) > tolerance) result.insertBack(IsRowMajor ? o : i, IsRowMajor ? i : o) = v;
+            }
+        }
+        result.finalize();
+        return result;
+    }
+
+    // Sparse * dense (SpMV when rhs has one column, SpMM otherwise)
+    Matrix<Scalar> operator*(const Matrix<Scalar>& rhs) const {
+        Matrix<Scalar> result(rows_, rhs.cols());
+        if (IsRowMajor) {
+            internal::sparse_gather(outerSize(), outerIndexPtr(), innerIndexPtr(), valuePtr(), rhs, result);
+        } else {
+            internal::sparse_scatter(outerSize(), outerIndexPtr(), innerIndexPtr(), valuePtr(), rhs, result);
+        }
+        return result;
+    }
+
+    Vector<Scalar> operator*(const Vector<Scalar>& rhs) const {
+        Vector<Scalar> result(rows_);
+        if (IsRowMajor) {
+            internal::sparse_gather(outerSize(), outerIndexPtr(), innerIndexPtr(), valuePtr(), rhs, result);
+        } else {
+            internal::sparse_scatter(outerSize(), outerIndexPtr(), innerIndexPtr(), valuePtr(), rhs, result);
+        }
+        return result;
+    }
+
+    // this^T * rhs without materializing the transpose
+    Matrix<Scalar> transposeMultiply(const Matrix<Scalar>& rhs) const {
+        Matrix<Scalar> result(cols_, rhs.cols());
+        if (IsRowMajor) {
+            internal::sparse_scatter(outerSize(), outerIndexPtr(), innerIndexPtr(), valuePtr(), rhs, result);
+        } else {
+            internal::sparse_gather(outerSize(), outerIndexPtr(), innerIndexPtr(), valuePtr(), rhs, result);
+        }
+        return result;
+    }
+
+    // this * rhs^T without materializing the transpose (rows of rhs are dotted with
+    // rows of this); used for X * W^T with row-major weights
+    Matrix<Scalar> multiplyTransposed(const Matrix<Scalar>& rhs) const {
+        if (!IsRowMajor) return (*this) * rhs.transpose();
+        const Index k = rhs.rows();
+        Matrix<Scalar> result(rows_, k);
+        const Scalar* b = rhs.data();
+        const Index ld = rhs.cols();
+        dds::utils::parallel_for(0, rows_, internal::sparse_grain(rows_, nonZeros(), k), [&](Index begin, Index end) {
+            for (Index i = begin; i < end; ++i) {
+                Index first = outer_index_[i], last = outer_index_[i + 1];
+                for (Index j = 0; j < k; ++j) {
+                    const Scalar* w = b + j * ld;
+                    Scalar sum = 0;
+                    for (Index p = first; p < last; ++p) sum += values_[p] * w[inner_index_[p]];
+                    result(i, j) = sum;
+                }
+            }
+        });
+        return result;
+    }
+
+    SparseMatrix operator*(Scalar scalar) const {
+        SparseMatrix result(*this);
+        for (auto& v : result.values_) v *= scalar;
+        return result;
+    }
+
+private:
+    template<typename, int, typename> friend class SparseMatrix;
+
+    Index rows_;
+    Index cols_;
+    std::vector<Index> outer_index_;
+    std::vector<StorageIndex> inner_index_;
+    std::vector<Scalar> values_;
+    Index filled_outer_ = -1;       // startVec/insertBack progress
+};
+
+namespace internal {
+
+// lhs * rhs for a dense lhs given as (data, row stride, column stride), so a
+// transposed lhs is read in place; parallel over rows of lhs
+template<typename Scalar, int Options, typename StorageIndex>
+Matrix<Scalar> dense_sparse_product(const Scalar* lhs, Index m, Index row_stride, Index col_stride,
+                                    const SparseMatrix<Scalar, Options, StorageIndex>& rhs) {
+    using Sparse = SparseMatrix<Scalar, Options, StorageIndex>;
+    const Index n = rhs.cols();
+    const Index* outer = rhs.outerIndexPtr();
+    const StorageIndex* inner = rhs.innerIndexPtr();
+    const Scalar* values = rhs.valuePtr();
+    Matrix<Scalar> result = Matrix<Scalar>::Zero(m, n);
+
+    dds::utils::parallel_for(0, m, sparse_grain(m, rhs.nonZeros() * m, 1), [&](Index begin, Index end) {
+        for (Index r = begin; r < end; ++r) {
+            const Scalar* a = lhs + r * row_stride;
+            Scalar* c = result.data() + r * n;
+            for (Index o = 0; o < rhs.outerSize(); ++o) {
+                if (Sparse::IsRowMajor) {
+                    // c += a[o] * rhs.row(o)
+                    const Scalar s = a[o * col_stride];
+                    if (s == Scalar(0)) continue;
+                    for (Index p = outer[o]; p < outer[o + 1]; ++p) c[inner[p]] += s * values[p];
+                } else {
+                    // c[o] = a . rhs.col(o)
+                    Scalar sum = 0;
+                    for (Index p = outer[o]; p < outer[o + 1]; ++p) sum += a[inner[p] * col_stride] * values[p];
+                    c[o] = sum;
+                }
+            }
+        }
+    });
+    return result;
+}
+
+} // namespace internal
+
+// Dense * sparse
+template<typename Scalar, int Options, typename StorageIndex>
+Matrix<Scalar> operator*(const Matrix<Scalar>& lhs, const SparseMatrix<Scalar, Options, StorageIndex>& rhs) {
+    return internal::dense_sparse_product(lhs.data(), lhs.rows(), lhs.cols(), 1, rhs);
+}
+
+// Dense^T * sparse (weight gradients G^T * X) without copying G
+template<typename Scalar, int Options, typename StorageIndex>
+Matrix<Scalar> operator*(const Transpose<Scalar>& lhs, const SparseMatrix<Scalar, Options, StorageIndex>& rhs) {
+    const Matrix<Scalar>& g = lhs.nestedExpression();
+    return internal::dense_sparse_product(g.data(), g.cols(), 1, g.cols(), rhs);
+}
+
 // Type aliases
 using MatrixXd = Matrix<double>;
 using VectorXd = Vector<double>;
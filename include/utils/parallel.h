@@ -0,0 +1,172 @@
+#pragma once
+
+// Simple fork-join thread pool for data-parallel loops (header-only)
+//
+// parallel_for(begin, end, grain, fn) splits [begin, end) into chunks of at least
+// `grain` indices and calls fn(chunk_begin, chunk_end) on the pool workers and the
+// calling thread. Nested calls, and calls made while another thread is using the
+// pool, run inline on the caller, so kernels can use it unconditionally.
+// The worker count defaults to hardware_concurrency and can be capped with the
+// DDS_NUM_THREADS environment variable.
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+namespace dds {
+namespace utils {
+
+class ThreadPool {
+public:
+    using Index = std::ptrdiff_t;
+
+    explicit ThreadPool(size_t threads = 0) {
+        if (threads == 0) threads = default_threads();
+        for (size_t i = 1; i < threads; ++i) {
+            workers_.emplace_back([this]() { worker_loop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_cv_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Shared process-wide pool, created on first use
+    static ThreadPool& instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    // Worker threads plus the calling thread
+    size_t size() const { return workers_.size() + 1; }
+
+    template<typename F>
+    void parallel_for(Index begin, Index end, Index grain, F&& fn) {
+        if (end <= begin) return;
+        grain = std::max<Index>(grain, 1);
+        const Index n = end - begin;
+        if (n <= grain || workers_.empty() || in_parallel_region()) {
+            fn(begin, end);
+            return;
+        }
+
+        std::unique_lock<std::mutex> busy(run_mutex_, std::try_to_lock);
+        if (!busy.owns_lock()) {
+            fn(begin, end);
+            return;
+        }
+
+        // A few chunks per thread balances uneven rows without much scheduling overhead
+        const Index max_chunks = static_cast<Index>(size()) * 4;
+        Index chunk = std::max(grain, (n + max_chunks - 1) / max_chunks);
+
+        using Fn = typename std::remove_reference<F>::type;
+        job_.begin = begin;
+        job_.end = end;
+        job_.chunk = chunk;
+        job_.next.store(begin, std::memory_order_relaxed);
+        job_.context = const_cast<void*>(static_cast<const void*>(&fn));
+        job_.invoke = [](void* context, Index b, Index e) { (*static_cast<Fn*>(context))(b, e); };
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = workers_.size();
+            ++generation_;
+        }
+        wake_cv_.notify_all();
+
+        in_parallel_region() = true;
+        run_chunks();
+        in_parallel_region() = false;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+    static size_t default_threads() {
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        if (const char* env = std::getenv("DDS_NUM_THREADS")) {
+            long requested = std::strtol(env, nullptr, 10);
+            if (requested > 0) threads = static_cast<size_t>(requested);
+        }
+        return threads;
+    }
+
+private:
+    struct Job {
+        Index begin = 0;
+        Index end = 0;
+        Index chunk = 1;
+        std::atomic<Index> next{0};
+        void* context = nullptr;
+        void (*invoke)(void*, Index, Index) = nullptr;
+    };
+
+    std::vector<std::thread> workers_;
+    std::mutex run_mutex_;              // One parallel_for at a time
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;
+    size_t pending_ = 0;
+    bool stop_ = false;
+    Job job_;
+
+    static bool& in_parallel_region() {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    void run_chunks() {
+        for (;;) {
+            Index b = job_.next.fetch_add(job_.chunk, std::memory_order_relaxed);
+            if (b >= job_.end) return;
+            job_.invoke(job_.context, b, std::min(job_.end, b + job_.chunk));
+        }
+    }
+
+    void worker_loop() {
+        in_parallel_region() = true;
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_cv_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+            }
+            run_chunks();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) done_cv_.notify_one();
+        }
+    }
+};
+
+// Convenience wrappers over the shared pool
+template<typename F>
+inline void parallel_for(std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t grain, F&& fn) {
+    ThreadPool::instance().parallel_for(begin, end, grain, std::forward<F>(fn));
+}
+
+inline size_t max_threads() {
+    return ThreadPool::instance().size();
+}
+
+} // namespace utils
+} // namespace dds
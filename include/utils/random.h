@@ -0,0 +1,330 @@
+#pragma once
+
+// Counter-based random numbers (header-only)
+//
+// Philox4x32-10 (Salmon et al., SC'11) maps a 128-bit counter and a 64-bit key to
+// four 32-bit words with no carried state, so any element of a stream can be
+// computed directly from its position. A RandomStream is (seed, stream id,
+// position): the seed is the Philox key, the stream id fills the high half of the
+// counter and the block index the low half. Bulk fills split the blocks over the
+// thread pool and every output depends only on its position, so results are
+// identical for any DDS_NUM_THREADS. Independent streams for threads, tasks or
+// trees come from fork(id) instead of reseeding.
+
+#include "parallel.h"
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+namespace dds {
+namespace utils {
+
+class Philox4x32 {
+public:
+    static constexpr uint32_t kMul0 = 0xD2511F53u;
+    static constexpr uint32_t kMul1 = 0xCD9E8D57u;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9u;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85u;
+    static constexpr int kRounds = 10;
+    static constexpr size_t kBatch = 16;    // Blocks per vectorized batch
+
+    // Four words for counter (counter_hi:counter_lo) under key
+    static void generate(uint64_t counter_lo, uint64_t counter_hi, uint64_t key, uint32_t out[4]) {
+        generate_blocks(counter_lo, 1, counter_hi, key, out);
+    }
+
+    // Blocks first..first+count-1, written as 4 * count consecutive words. Counters
+    // are kept structure-of-arrays so each round compiles to vector multiplies
+    static void generate_blocks(uint64_t first, size_t count, uint64_t counter_hi, uint64_t key,
+                                uint32_t* out) {
+        for (size_t base = 0; base < count; base += kBatch) {
+            const size_t n = std::min(kBatch, count - base);
+            uint32_t c0[kBatch], c1[kBatch], c2[kBatch], c3[kBatch];
+            for (size_t i = 0; i < n; ++i) {
+                const uint64_t lo = first + base + i;
+                c0[i] = static_cast<uint32_t>(lo);
+                c1[i] = static_cast<uint32_t>(lo >> 32);
+                c2[i] = static_cast<uint32_t>(counter_hi);
+                c3[i] = static_cast<uint32_t>(counter_hi >> 32);
+            }
+            uint32_t k0 = static_cast<uint32_t>(key);
+            uint32_t k1 = static_cast<uint32_t>(key >> 32);
+            for (int round = 0; round < kRounds; ++round) {
+                for (size_t i = 0; i < n; ++i) {
+                    const uint64_t p0 = static_cast<uint64_t>(kMul0) * c0[i];
+                    const uint64_t p1 = static_cast<uint64_t>(kMul1) * c2[i];
+                    const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[i] ^ k0;
+                    const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[i] ^ k1;
+                    c1[i] = static_cast<uint32_t>(p1);
+                    c3[i] = static_cast<uint32_t>(p0);
+                    c0[i] = n0;
+                    c2[i] = n2;
+                }
+                k0 += kWeyl0;
+                k1 += kWeyl1;
+            }
+            uint32_t* dst = out + 4 * base;
+            for (size_t i = 0; i < n; ++i) {
+                dst[4 * i + 0] = c0[i];
+                dst[4 * i + 1] = c1[i];
+                dst[4 * i + 2] = c2[i];
+                dst[4 * i + 3] = c3[i];
+            }
+        }
+    }
+};
+
+namespace internal {
+
+inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Uniform in [0, 1) from the top 24 (float) or 53 (double) bits
+inline float to_unit(uint32_t w, float) { return static_cast<float>(w >> 8) * (1.0f / 16777216.0f); }
+inline double to_unit(uint32_t w0, uint32_t w1) {
+    const uint64_t bits = (static_cast<uint64_t>(w0) << 21) ^ (w1 >> 11);
+    return static_cast<double>(bits & ((1ULL << 53) - 1)) * (1.0 / 9007199254740992.0);
+}
+
+// Lemire's multiply-shift: unbiased to within bound / 2^32
+inline uint32_t to_range(uint32_t w, uint32_t bound) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(w) * bound) >> 32);
+}
+
+} // namespace internal
+
+class RandomStream {
+public:
+    static constexpr uint64_t kDefaultSeed = 0x5eed5eed5eed5eedULL;
+
+    explicit RandomStream(uint64_t seed = kDefaultSeed, uint64_t stream = 0)
+        : seed_(seed), stream_(stream) {}
+
+    // Child stream that never overlaps this one or its other children: use one per
+    // tree, task or worker instead of sharing a stream across threads
+    RandomStream fork(uint64_t id) const {
+        return RandomStream(seed_, internal::splitmix64(stream_ ^ internal::splitmix64(id + 1)));
+    }
+
+    uint64_t seed() const { return seed_; }
+    uint64_t stream() const { return stream_; }
+    uint64_t position() const { return position_; }     // 32-bit words consumed
+    void seek(uint64_t position) { position_ = position; }
+
+    uint32_t next_u32() {
+        const uint64_t block = position_ >> 2;
+        if (block != cached_block_) {
+            Philox4x32::generate(block, stream_, seed_, cache_);
+            cached_block_ = block;
+        }
+        return cache_[position_++ & 3];
+    }
+
+    uint64_t next_u64() {
+        const uint64_t hi = next_u32();
+        return (hi << 32) | next_u32();
+    }
+
+    double uniform() {
+        const uint32_t w0 = next_u32();
+        return internal::to_unit(w0, next_u32());
+    }
+    double uniform(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+
+    // Integer in [0, bound)
+    uint32_t below(uint32_t bound) { return internal::to_range(next_u32(), bound); }
+
+    double normal(double mean = 0.0, double stddev = 1.0) {
+        const double u1 = 1.0 - uniform();
+        const double u2 = uniform();
+        return mean + stddev * std::sqrt(-2.0 * std::log(u1)) * std::cos(kTwoPi * u2);
+    }
+
+    // Bulk fills. Each starts at the next block boundary and leaves the stream after
+    // the last block it used, so interleaving fills and scalar draws stays reproducible
+
+    template<typename T>
+    void fill_uniform(T* out, size_t n, T lo = T(0), T hi = T(1)) {
+        static_assert(std::is_floating_point<T>::value, "fill_uniform needs a floating-point type");
+        constexpr size_t words = sizeof(T) >= 8 ? 2 : 1;
+        const T scale = hi - lo;
+        for_each_block(n, 4 / words, [&](size_t elem, const uint32_t* w, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[elem + i] = lo + scale * static_cast<T>(unit<T>(w + words * i));
+            }
+        });
+    }
+
+    // Box-Muller on pairs of uniforms; one block yields 4 floats or 2 doubles
+    template<typename T>
+    void fill_normal(T* out, size_t n, T mean = T(0), T stddev = T(1)) {
+        static_assert(std::is_floating_point<T>::value, "fill_normal needs a floating-point type");
+        constexpr size_t words = sizeof(T) >= 8 ? 2 : 1;
+        for_each_block(n, 4 / words, [&](size_t elem, const uint32_t* w, size_t count) {
+            for (size_t i = 0; i < count; i += 2) {
+                const double u1 = 1.0 - static_cast<double>(unit<T>(w + words * i));
+                const double u2 = static_cast<double>(unit<T>(w + words * (i + 1)));
+                const double r = std::sqrt(-2.0 * std::log(u1));
+                out[elem + i] = mean + stddev * static_cast<T>(r * std::cos(kTwoPi * u2));
+                if (i + 1 < count) out[elem + i + 1] = mean + stddev * static_cast<T>(r * std::sin(kTwoPi * u2));
+            }
+        });
+    }
+
+    // 1 with probability p, else 0
+    template<typename T>
+    void fill_bernoulli(T* out, size_t n, double p) {
+        const uint32_t threshold = bernoulli_threshold(p);
+        const bool always = p >= 1.0;
+        for_each_block(n, 4, [&](size_t elem, const uint32_t* w, size_t count) {
+            for (size_t i = 0; i < count; ++i) out[elem + i] = (always || w[i] < threshold) ? T(1) : T(0);
+        });
+    }
+
+    // Bit i of words[i / 64] set with probability p; each word reads 16 blocks
+    void fill_bernoulli_bits(uint64_t* words, size_t n, double p) {
+        const size_t num_words = (n + 63) / 64;
+        ThreadPool::instance().parallel_for(0, static_cast<ThreadPool::Index>(num_words), 64,
+            [&](ThreadPool::Index w0, ThreadPool::Index w1) {
+                bernoulli_bits_at(static_cast<uint64_t>(w0), static_cast<size_t>(w1 - w0), p, words + w0);
+            });
+        if (n % 64 != 0) words[num_words - 1] &= (1ULL << (n % 64)) - 1;
+        skip_bernoulli_words(num_words);
+    }
+
+    // Words [first_word, first_word + count) of the mask fill_bernoulli_bits would
+    // draw next, without advancing. Kernels that consume the mask as they go call
+    // this from their own parallel loop, then skip_bernoulli_words() once
+    void bernoulli_bits_at(uint64_t first_word, size_t count, double p, uint64_t* out) const {
+        constexpr size_t kWordsPerBatch = 4;
+        const uint32_t threshold = bernoulli_threshold(p);
+        const bool always = p >= 1.0;
+        const uint64_t first_block = (position_ + 3) >> 2;
+        uint32_t buffer[kWordsPerBatch * 64];
+        for (size_t base = 0; base < count; base += kWordsPerBatch) {
+            const size_t batch = std::min(kWordsPerBatch, count - base);
+            Philox4x32::generate_blocks(first_block + (first_word + base) * 16, batch * 16, stream_, seed_, buffer);
+            for (size_t i = 0; i < batch; ++i) {
+                const uint32_t* w = buffer + 64 * i;
+                uint64_t bits = 0;
+                for (size_t b = 0; b < 64; ++b) {
+                    bits |= static_cast<uint64_t>(always || w[b] < threshold) << b;
+                }
+                out[base + i] = bits;
+            }
+        }
+    }
+
+    void skip_bernoulli_words(size_t num_words) {
+        position_ = (((position_ + 3) >> 2) + static_cast<uint64_t>(num_words) * 16) << 2;
+    }
+
+    // Integers in [0, bound), e.g. bootstrap indices
+    template<typename Int>
+    void fill_below(Int* out, size_t n, uint32_t bound) {
+        for_each_block(n, 4, [&](size_t elem, const uint32_t* w, size_t count) {
+            for (size_t i = 0; i < count; ++i) out[elem + i] = static_cast<Int>(internal::to_range(w[i], bound));
+        });
+    }
+
+private:
+    static constexpr double kTwoPi = 6.283185307179586476925286766559;
+    static constexpr ThreadPool::Index kGrainBlocks = 1024;
+
+    uint64_t seed_;
+    uint64_t stream_;
+    uint64_t position_ = 0;
+    uint64_t cached_block_ = ~0ULL;
+    uint32_t cache_[4] = {0, 0, 0, 0};
+
+    template<typename T>
+    static auto unit(const uint32_t* w) {
+        if constexpr (sizeof(T) >= 8) return internal::to_unit(w[0], w[1]);
+        else return internal::to_unit(w[0], 0.0f);
+    }
+
+    static uint32_t bernoulli_threshold(double p) {
+        if (p <= 0.0) return 0;
+        if (p >= 1.0) return 0xFFFFFFFFu;
+        return static_cast<uint32_t>(p * 4294967296.0);
+    }
+
+    // Calls emit(first_element, words, count) for consecutive runs of elements, where
+    // every `per_block` elements read one 4-word block. Runs are handed out by the
+    // thread pool; the element-to-counter mapping is fixed, so the split does not
+    // affect the values
+    template<typename F>
+    void for_each_block(size_t n, size_t per_block, F&& emit) {
+        if (n == 0) return;
+        const size_t blocks = (n + per_block - 1) / per_block;
+        const uint64_t first = (position_ + 3) >> 2;
+        const uint64_t stream = stream_;
+        const uint64_t key = seed_;
+
+        ThreadPool::instance().parallel_for(0, static_cast<ThreadPool::Index>(blocks), kGrainBlocks,
+            [&](ThreadPool::Index b0, ThreadPool::Index b1) {
+                constexpr size_t kChunkBlocks = 4 * Philox4x32::kBatch;
+                uint32_t buffer[4 * kChunkBlocks];
+                for (size_t b = static_cast<size_t>(b0); b < static_cast<size_t>(b1); b += kChunkBlocks) {
+                    const size_t count = std::min(kChunkBlocks, static_cast<size_t>(b1) - b);
+                    Philox4x32::generate_blocks(first + b, count, stream, key, buffer);
+                    const size_t elem = b * per_block;
+                    emit(elem, buffer, std::min(count * per_block, n - elem));
+                }
+            });
+        position_ = (first + blocks) << 2;
+    }
+};
+
+// Fisher-Yates with draws from rng (serial: each swap depends on the previous one)
+template<typename RandomIt>
+void shuffle(RandomIt first, RandomIt last, RandomStream& rng) {
+    const auto n = last - first;
+    for (auto i = n - 1; i > 0; --i) {
+        const auto j = rng.below(static_cast<uint32_t>(i + 1));
+        using std::swap;
+        swap(first[i], first[j]);
+    }
+}
+
+inline std::vector<int> permutation(int n, RandomStream& rng) {
+    std::vector<int> order(static_cast<size_t>(std::max(n, 0)));
+    for (int i = 0; i < n; ++i) order[i] = i;
+    shuffle(order.begin(), order.end(), rng);
+    return order;
+}
+
+// Process-wide seed. global_stream() hands out a fresh stream id per call, so
+// successive Matrix::Random / weight initializations differ but a run is
+// reproducible after set_global_seed()
+namespace internal {
+inline std::atomic<uint64_t>& global_seed() {
+    static std::atomic<uint64_t> seed{RandomStream::kDefaultSeed};
+    return seed;
+}
+inline std::atomic<uint64_t>& global_stream_counter() {
+    static std::atomic<uint64_t> counter{0};
+    return counter;
+}
+} // namespace internal
+
+inline void set_global_seed(uint64_t seed) {
+    internal::global_seed().store(seed);
+    internal::global_stream_counter().store(0);
+}
+
+inline RandomStream global_stream() {
+    return RandomStream(internal::global_seed().load(), internal::global_stream_counter().fetch_add(1));
+}
+
+} // namespace utils
+} // namespace dds
@@ -0,0 +1,371 @@
+#pragma once
+
+// Portable SIMD kernels over contiguous arrays (header-only)
+//
+// Built on GCC/Clang vector extensions sized to the widest enabled ISA (16 bytes for
+// SSE2/NEON, 32 with AVX, 64 with AVX-512), so a float kernel runs twice the lanes
+// of the double one. Reductions keep four independent vector accumulators and fold
+// them into a double every kBlock elements: float storage keeps float throughput
+// while the running total has double precision. Other compilers get scalar loops
+// with the same accumulation rules.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX512F__)
+#define DDS_SIMD_BYTES 64
+#elif defined(__AVX__)
+#define DDS_SIMD_BYTES 32
+#else
+#define DDS_SIMD_BYTES 16
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DDS_SIMD_VECTOR_EXT 1
+#endif
+
+namespace dds {
+namespace utils {
+namespace simd {
+
+constexpr size_t kVectorBytes = DDS_SIMD_BYTES;
+constexpr size_t kBlock = 4096;         // Elements per float partial sum
+
+template<typename T>
+constexpr size_t lanes() { return kVectorBytes / sizeof(T); }
+
+#ifdef DDS_SIMD_VECTOR_EXT
+
+template<typename T> struct VectorOf;
+template<> struct VectorOf<float> { typedef float type __attribute__((vector_size(DDS_SIMD_BYTES))); };
+template<> struct VectorOf<double> { typedef double type __attribute__((vector_size(DDS_SIMD_BYTES))); };
+
+template<typename T>
+using Vec = typename VectorOf<T>::type;
+
+// Unaligned load/store; memcpy compiles to a single vector move
+template<typename T>
+inline Vec<T> load(const T* p) {
+    Vec<T> v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+template<typename T>
+inline void store(T* p, Vec<T> v) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+template<typename T>
+inline double horizontal_sum(Vec<T> v) {
+    double s = 0.0;
+    for (size_t k = 0; k < lanes<T>(); ++k) s += static_cast<double>(v[k]);
+    return s;
+}
+
+template<typename To, typename From>
+inline To bit_cast(From v) {
+    static_assert(sizeof(To) == sizeof(From), "bit_cast size mismatch");
+    To out;
+    std::memcpy(&out, &v, sizeof(out));
+    return out;
+}
+
+// exp(x) = 2^k * exp(r) with x = k ln2 + r, |r| <= ln2 / 2 (Cody-Waite split of ln2),
+// exp(r) from its Taylor series to below half an ulp, 2^k written into the exponent
+// bits. Inputs are clamped to the finite, normal result range.
+template<typename T> struct ExpTraits;
+
+// Taylor coefficients 1/k! of exp, highest degree last
+constexpr double kExpCoefficients[14] = {
+    1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040,
+    1.0 / 40320, 1.0 / 362880, 1.0 / 3628800, 1.0 / 39916800, 1.0 / 479001600,
+    1.0 / 6227020800.0
+};
+
+template<> struct ExpTraits<double> {
+    typedef unsigned long long bits_type __attribute__((vector_size(DDS_SIMD_BYTES)));
+    static constexpr double kMax = 709.0;
+    static constexpr double kMin = -708.0;
+    static constexpr double kShifter = 6755399441055744.0;     // 1.5 * 2^52, rounds to integer
+    static constexpr unsigned long long kMantissaBits = 52;
+    static constexpr unsigned long long kOne = 0x3FF0000000000000ULL;
+    static constexpr double kLn2Hi = 6.93147180369123816490e-01;
+    static constexpr double kLn2Lo = 1.90821492927058770002e-10;
+    static constexpr int kDegree = 13;
+};
+template<> struct ExpTraits<float> {
+    typedef unsigned int bits_type __attribute__((vector_size(DDS_SIMD_BYTES)));
+    static constexpr float kMax = 88.0f;
+    static constexpr float kMin = -87.0f;
+    static constexpr float kShifter = 12582912.0f;             // 1.5 * 2^23
+    static constexpr unsigned int kMantissaBits = 23;
+    static constexpr unsigned int kOne = 0x3F800000u;
+    static constexpr float kLn2Hi = 0.693145751953125f;
+    static constexpr float kLn2Lo = 1.428606765330187045e-06f;
+    static constexpr int kDegree = 7;
+};
+
+template<typename T>
+inline Vec<T> exp_vector(Vec<T> x) {
+    using E = ExpTraits<T>;
+    using Bits = typename E::bits_type;
+    const Vec<T> hi = Vec<T>{} + E::kMax;
+    const Vec<T> lo = Vec<T>{} + E::kMin;
+    x = x > hi ? hi : x;
+    x = x < lo ? lo : x;
+    // t holds k = round(x / ln2) in its low mantissa bits
+    const Vec<T> t = x * T(1.44269504088896340736) + E::kShifter;
+    const Vec<T> k = t - E::kShifter;
+    const Vec<T> r = (x - k * E::kLn2Hi) - k * E::kLn2Lo;
+    // Even and odd halves in r^2 are two independent Horner chains of half the depth
+    static_assert(E::kDegree % 2 == 1, "odd degree splits evenly");
+    const Vec<T> r2 = r * r;
+    Vec<T> even = Vec<T>{} + static_cast<T>(kExpCoefficients[E::kDegree - 1]);
+    Vec<T> odd = Vec<T>{} + static_cast<T>(kExpCoefficients[E::kDegree]);
+    for (int d = E::kDegree - 3; d >= 0; d -= 2) {
+        even = even * r2 + static_cast<T>(kExpCoefficients[d]);
+        odd = odd * r2 + static_cast<T>(kExpCoefficients[d + 1]);
+    }
+    const Vec<T> p = even + r * odd;
+    const Bits scale = (bit_cast<Bits>(t) << E::kMantissaBits) + E::kOne;
+    return p * bit_cast<Vec<T>>(scale);
+}
+
+// Runs step(a0, a1, a2, a3, i) over [0, n) in strides of 4 vectors, folding the
+// accumulators into a double every kBlock elements; returns the total and the
+// index where the scalar tail starts
+template<typename T, typename Step>
+inline double block_reduce(size_t n, size_t& tail, Step step) {
+    constexpr size_t stride = 4 * lanes<T>();
+    const size_t vector_end = n - n % stride;
+    double total = 0.0;
+    for (size_t start = 0; start < vector_end;) {
+        const size_t stop = std::min(vector_end, start + kBlock);
+        Vec<T> a0 = {}, a1 = {}, a2 = {}, a3 = {};
+        for (size_t i = start; i < stop; i += stride) step(a0, a1, a2, a3, i);
+        total += horizontal_sum<T>((a0 + a1) + (a2 + a3));
+        start = stop;
+    }
+    tail = vector_end;
+    return total;
+}
+
+#endif // DDS_SIMD_VECTOR_EXT
+
+// sum_i x[i] * y[i]
+template<typename T>
+inline double dot(const T* x, const T* y, size_t n) {
+    size_t i = 0;
+    double total = 0.0;
+#ifdef DDS_SIMD_VECTOR_EXT
+    constexpr size_t L = lanes<T>();
+    total = block_reduce<T>(n, i, [x, y](Vec<T>& a0, Vec<T>& a1, Vec<T>& a2, Vec<T>& a3, size_t j) {
+        a0 += load(x + j) * load(y + j);
+        a1 += load(x + j + L) * load(y + j + L);
+        a2 += load(x + j + 2 * L) * load(y + j + 2 * L);
+        a3 += load(x + j + 3 * L) * load(y + j + 3 * L);
+    });
+#endif
+    for (; i < n; ++i) total += static_cast<double>(x[i]) * static_cast<double>(y[i]);
+    return total;
+}
+
+// sum_i x[i]
+template<typename T>
+inline double sum(const T* x, size_t n) {
+    size_t i = 0;
+    double total = 0.0;
+#ifdef DDS_SIMD_VECTOR_EXT
+    constexpr size_t L = lanes<T>();
+    total = block_reduce<T>(n, i, [x](Vec<T>& a0, Vec<T>& a1, Vec<T>& a2, Vec<T>& a3, size_t j) {
+        a0 += load(x + j);
+        a1 += load(x + j + L);
+        a2 += load(x + j + 2 * L);
+        a3 += load(x + j + 3 * L);
+    });
+#endif
+    for (; i < n; ++i) total += static_cast<double>(x[i]);
+    return total;
+}
+
+// sum_i x[i]^2
+template<typename T>
+inline double squared_norm(const T* x, size_t n) {
+    return dot(x, x, n);
+}
+
+// y += a * x
+template<typename T>
+inline void axpy(T a, const T* x, T* y, size_t n) {
+    size_t i = 0;
+#ifdef DDS_SIMD_VECTOR_EXT
+    constexpr size_t L = lanes<T>();
+    const Vec<T> va = Vec<T>{} + a;
+    for (; i + 2 * L <= n; i += 2 * L) {
+        store(y + i, load(y + i) + va * load(x + i));
+        store(y + i + L, load(y + i + L) + va * load(x + i + L));
+    }
+#endif
+    for (; i < n; ++i) y[i] += a * x[i];
+}
+
+// x *= a
+template<typename T>
+inline void scale(T a, T* x, size_t n) {
+    size_t i = 0;
+#ifdef DDS_SIMD_VECTOR_EXT
+    constexpr size_t L = lanes<T>();
+    const Vec<T> va = Vec<T>{} + a;
+    for (; i + L <= n; i += L) store(x + i, load(x + i) * va);
+#endif
+    for (; i < n; ++i) x[i] *= a;
+}
+
+// max_i x[i] (n > 0)
+template<typename T>
+inline T maximum(const T* x, size_t n) {
+    size_t i = 0;
+    T result = x[0];
+#ifdef DDS_SIMD_VECTOR_EXT
+    constexpr size_t L = lanes<T>();
+    if (n >= L) {
+        Vec<T> m = load(x);
+        for (i = L; i + L <= n; i += L) {
+            const Vec<T> v = load(x + i);
+            m = v > m ? v : m;
+        }
+        for (size_t k = 0; k < L; ++k) result = std::max(result, static_cast<T>(m[k]));
+    }
+#endif
+    for (; i < n; ++i) result = std::max(result, x[i]);
+    return result;
+}
+
+// y = exp(x - shift), in place when y == x. The vector path covers the tail with a
+// padded vector so every element gets the same rounding; scalar builds use std::exp.
+template<typename T>
+inline void exp(const T* x, T* y, size_t n, T shift = T(0)) {
+    size_t i = 0;
+#ifdef DDS_SIMD_VECTOR_EXT
+    constexpr size_t L = lanes<T>();
+    for (; i + L <= n; i += L) store(y + i, exp_vector<T>(load(x + i) - shift));
+    if (i < n) {
+        Vec<T> v = {};
+        std::memcpy(&v, x + i, (n - i) * sizeof(T));
+        v = exp_vector<T>(v - shift);
+        std::memcpy(y + i, &v, (n - i) * sizeof(T));
+    }
+    return;
+#endif
+    for (; i < n; ++i) y[i] = std::exp(x[i] - shift);
+}
+
+// Integer kernels for int8 inference
+//
+// Operands lie in [-127, 127] and n is a multiple of kInt8Block (callers zero-pad).
+// Products a * b are formed as |a| * (b with a's sign), unsigned times signed bytes:
+// AVX-512 VNNI (VPDPBUSD) accumulates them straight into int32, AVX2 pairs them into
+// 16 bits (VPMADDUBSW, at most 2 * 127 * 127 so never saturating) and widens with
+// VPMADDWD. Plain SSE2 sign-extends both sides to 16 bits for PMADDWD, and other
+// targets use scalar int32 loops. All paths give the same exact int32 result.
+constexpr size_t kInt8Block = 64;
+
+#if defined(__AVX2__)
+inline int32_t horizontal_sum_i32(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+#endif
+
+// out[j] = sum_i a[i] * b[j * stride + i] for j < 4: four weight rows share each
+// activation load
+inline void dot_i8x4(const int8_t* a, const int8_t* b, size_t stride, size_t n, int32_t* out) {
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+    __m512i acc[4] = {_mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512(),
+                      _mm512_setzero_si512()};
+    for (size_t i = 0; i < n; i += 64) {
+        const __m512i va = _mm512_loadu_si512(a + i);
+        const __m512i magnitude = _mm512_abs_epi8(va);
+        const __mmask64 negative = _mm512_movepi8_mask(va);
+        for (int j = 0; j < 4; ++j) {
+            const __m512i vb = _mm512_loadu_si512(b + j * stride + i);
+            const __m512i signed_b = _mm512_mask_sub_epi8(vb, negative, _mm512_setzero_si512(), vb);
+            acc[j] = _mm512_dpbusd_epi32(acc[j], magnitude, signed_b);
+        }
+    }
+    for (int j = 0; j < 4; ++j) out[j] = _mm512_reduce_add_epi32(acc[j]);
+#elif defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(),
+                      _mm256_setzero_si256()};
+    for (size_t i = 0; i < n; i += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i magnitude = _mm256_sign_epi8(va, va);
+        for (int j = 0; j < 4; ++j) {
+            const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j * stride + i));
+            const __m256i pairs = _mm256_maddubs_epi16(magnitude, _mm256_sign_epi8(vb, va));
+            acc[j] = _mm256_add_epi32(acc[j], _mm256_madd_epi16(pairs, ones));
+        }
+    }
+    for (int j = 0; j < 4; ++j) out[j] = horizontal_sum_i32(acc[j]);
+#elif defined(__SSE2__)
+    // Bytes sign-extend to 16 bits by unpacking each with itself and shifting right
+    __m128i acc[4] = {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+    for (size_t i = 0; i < n; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i a_low = _mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8);
+        const __m128i a_high = _mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8);
+        for (int j = 0; j < 4; ++j) {
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j * stride + i));
+            const __m128i b_low = _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8);
+            const __m128i b_high = _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8);
+            acc[j] = _mm_add_epi32(acc[j], _mm_add_epi32(_mm_madd_epi16(a_low, b_low), _mm_madd_epi16(a_high, b_high)));
+        }
+    }
+    for (int j = 0; j < 4; ++j) {
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc[j]);
+        out[j] = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+#else
+    for (int j = 0; j < 4; ++j) {
+        const int8_t* row = b + j * stride;
+        int32_t total = 0;
+        for (size_t i = 0; i < n; ++i) total += static_cast<int32_t>(a[i]) * static_cast<int32_t>(row[i]);
+        out[j] = total;
+    }
+#endif
+}
+
+// sum_i a[i] * b[i], for the rows left over after dot_i8x4
+inline int32_t dot_i8(const int8_t* a, const int8_t* b, size_t n) {
+    int32_t total = 0;
+    for (size_t i = 0; i < n; ++i) total += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+    return total;
+}
+
+// q = round(x * inverse_scale), clamped to [-127, 127]; halves round away from zero
+template<typename T>
+inline void quantize_i8(const T* x, size_t n, T inverse_scale, int8_t* q) {
+    for (size_t i = 0; i < n; ++i) {
+        T v = std::min(std::max(x[i] * inverse_scale, T(-127)), T(127));
+        v += v < T(0) ? T(-0.5) : T(0.5);
+        q[i] = static_cast<int8_t>(static_cast<int32_t>(v));
+    }
+}
+
+} // namespace simd
+} // namespace utils
+} // namespace dds
@@ -0,0 +1,550 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace dds {
+namespace utils {
+
+// Fixed-memory streaming sketches (header-only).
+// None of these types lock; owners serialize access the same way they guarded the
+// maps these replace.
+
+// 64-bit string hash (FNV-1a with a splitmix64 finalizer)
+inline uint64_t sketch_hash(const char* data, size_t size, uint64_t seed = 0) {
+    uint64_t h = 1469598103934665603ULL ^ seed;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+inline uint64_t sketch_hash(const std::string& key, uint64_t seed = 0) {
+    return sketch_hash(key.data(), key.size(), seed);
+}
+
+inline uint64_t sketch_mix(uint64_t x) {
+    x ^= x >> 33; x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Count-min sketch with conservative update.
+// Estimates never undercount; overcount is at most e * total / width with
+// probability 1 - e^-depth. Rows are addressed by double hashing of one 64-bit hash.
+class CountMinSketch {
+private:
+    size_t width_;
+    size_t depth_;
+    size_t mask_;
+    std::vector<uint32_t> counters_;
+
+    size_t cell(uint64_t hash, size_t row) const {
+        uint32_t h1 = static_cast<uint32_t>(hash);
+        uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1u;
+        return row * width_ + ((h1 + static_cast<uint32_t>(row) * h2) & mask_);
+    }
+
+public:
+    // width is rounded up to a power of two
+    explicit CountMinSketch(size_t width = 2048, size_t depth = 4)
+        : width_(1), depth_(std::max<size_t>(depth, 1)) {
+        while (width_ < width) width_ <<= 1;
+        mask_ = width_ - 1;
+        counters_.assign(width_ * depth_, 0);
+    }
+
+    // Adds count and returns the new estimate
+    uint32_t add_hash(uint64_t hash, uint32_t count = 1) {
+        uint32_t current = estimate_hash(hash);
+        uint64_t wanted = static_cast<uint64_t>(current) + count;
+        uint32_t target = static_cast<uint32_t>(std::min<uint64_t>(wanted, std::numeric_limits<uint32_t>::max()));
+        for (size_t row = 0; row < depth_; ++row) {
+            uint32_t& c = counters_[cell(hash, row)];
+            if (c < target) c = target;
+        }
+        return target;
+    }
+
+    uint32_t estimate_hash(uint64_t hash) const {
+        uint32_t result = std::numeric_limits<uint32_t>::max();
+        for (size_t row = 0; row < depth_; ++row) {
+            result = std::min(result, counters_[cell(hash, row)]);
+        }
+        return result;
+    }
+
+    uint32_t add(const std::string& key, uint32_t count = 1) { return add_hash(sketch_hash(key), count); }
+    uint32_t estimate(const std::string& key) const { return estimate_hash(sketch_hash(key)); }
+
+    void clear() { std::fill(counters_.begin(), counters_.end(), 0); }
+
+    size_t width() const { return width_; }
+    size_t depth() const { return depth_; }
+    size_t memory_bytes() const { return counters_.size() * sizeof(uint32_t); }
+};
+
+// Count-min sketch over a sliding time window.
+// The window is split into slices, each with its own sketch kept in a ring; a slice is
+// cleared lazily when the ring wraps onto it, and estimates sum the live slices.
+class WindowedCountMinSketch {
+private:
+    std::vector<CountMinSketch> slices_;
+    std::vector<int64_t> slice_epochs_;
+    int64_t slice_nanos_;
+
+    int64_t epoch_of(std::chrono::nanoseconds since_epoch) const {
+        return since_epoch.count() / slice_nanos_;
+    }
+
+    CountMinSketch& slice_for(int64_t epoch) {
+        size_t idx = static_cast<size_t>(epoch % static_cast<int64_t>(slices_.size()));
+        if (slice_epochs_[idx] != epoch) {
+            slices_[idx].clear();
+            slice_epochs_[idx] = epoch;
+        }
+        return slices_[idx];
+    }
+
+public:
+    WindowedCountMinSketch(std::chrono::nanoseconds window = std::chrono::minutes(15),
+                           size_t slices = 15, size_t width = 2048, size_t depth = 4)
+        : slices_(std::max<size_t>(slices, 1), CountMinSketch(width, depth)),
+          slice_epochs_(std::max<size_t>(slices, 1), -1),
+          slice_nanos_(std::max<int64_t>(window.count() / static_cast<int64_t>(std::max<size_t>(slices, 1)), 1)) {}
+
+    // Adds count at time now and returns the windowed estimate
+    template <typename TimePoint>
+    uint32_t add(const std::string& key, TimePoint now, uint32_t count = 1) {
+        return add_hash(sketch_hash(key), now, count);
+    }
+
+    template <typename TimePoint>
+    uint32_t add_hash(uint64_t hash, TimePoint now, uint32_t count = 1) {
+        int64_t epoch = epoch_of(now.time_since_epoch());
+        slice_for(epoch).add_hash(hash, count);
+        return estimate_at(hash, epoch);
+    }
+
+    template <typename TimePoint>
+    uint32_t estimate(const std::string& key, TimePoint now) const {
+        return estimate_at(sketch_hash(key), epoch_of(now.time_since_epoch()));
+    }
+
+    template <typename TimePoint>
+    uint32_t estimate_hash(uint64_t hash, TimePoint now) const {
+        return estimate_at(hash, epoch_of(now.time_since_epoch()));
+    }
+
+    void clear() {
+        for (auto& slice : slices_) slice.clear();
+        std::fill(slice_epochs_.begin(), slice_epochs_.end(), -1);
+    }
+
+    size_t memory_bytes() const {
+        return slices_.empty() ? 0 : slices_.size() * slices_.front().memory_bytes();
+    }
+
+private:
+    uint32_t estimate_at(uint64_t hash, int64_t epoch) const {
+        uint64_t total = 0;
+        int64_t oldest = epoch - static_cast<int64_t>(slices_.size());
+        for (size_t i = 0; i < slices_.size(); ++i) {
+            if (slice_epochs_[i] > oldest && slice_epochs_[i] <= epoch) {
+                total += slices_[i].estimate_hash(hash);
+            }
+        }
+        return static_cast<uint32_t>(std::min<uint64_t>(total, std::numeric_limits<uint32_t>::max()));
+    }
+};
+
+// Space-Saving heavy hitters with a bounded number of monitored keys.
+// Entries live in a min-heap on count so both increments and evictions are O(log k);
+// a new key replaces the minimum and inherits its count as the error bound.
+// decay() halves every count so old traffic ages out between windows.
+struct NoPayload {};
+
+template <typename Payload = NoPayload>
+class SpaceSaving {
+public:
+    struct Entry {
+        std::string key;
+        uint64_t count;
+        uint64_t error;     // count - error is a guaranteed lower bound
+        Payload payload;
+    };
+
+private:
+    size_t capacity_;
+    std::vector<Entry> heap_;
+    std::unordered_map<std::string, size_t> positions_;
+
+    void swap_entries(size_t a, size_t b) {
+        std::swap(heap_[a], heap_[b]);
+        positions_[heap_[a].key] = a;
+        positions_[heap_[b].key] = b;
+    }
+
+    void sift_up(size_t i) {
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (heap_[parent].count <= heap_[i].count) break;
+            swap_entries(parent, i);
+            i = parent;
+        }
+    }
+
+    void sift_down(size_t i) {
+        for (;;) {
+            size_t smallest = i;
+            size_t left = 2 * i + 1;
+            size_t right = left + 1;
+            if (left < heap_.size() && heap_[left].count < heap_[smallest].count) smallest = left;
+            if (right < heap_.size() && heap_[right].count < heap_[smallest].count) smallest = right;
+            if (smallest == i) break;
+            swap_entries(i, smallest);
+            i = smallest;
+        }
+    }
+
+public:
+    explicit SpaceSaving(size_t capacity = 128) : capacity_(std::max<size_t>(capacity, 1)) {
+        heap_.reserve(capacity_);
+        positions_.reserve(capacity_ * 2);
+    }
+
+    // Counts weight against key; evicted is set when the key displaced another
+    Entry& offer(const std::string& key, uint64_t weight = 1, bool* evicted = nullptr) {
+        if (evicted) *evicted = false;
+        auto it = positions_.find(key);
+        if (it != positions_.end()) {
+            size_t i = it->second;
+            heap_[i].count += weight;
+            sift_down(i);
+            return heap_[positions_[key]];
+        }
+        if (heap_.size() < capacity_) {
+            heap_.push_back(Entry{key, weight, 0, Payload()});
+            positions_[key] = heap_.size() - 1;
+            sift_up(heap_.size() - 1);
+            return heap_[positions_[key]];
+        }
+        if (evicted) *evicted = true;
+        Entry& victim = heap_.front();
+        positions_.erase(victim.key);
+        uint64_t floor = victim.count;
+        victim = Entry{key, floor + weight, floor, Payload()};
+        positions_[key] = 0;
+        sift_down(0);
+        return heap_[positions_[key]];
+    }
+
+    const Entry* find(const std::string& key) const {
+        auto it = positions_.find(key);
+        return it == positions_.end() ? nullptr : &heap_[it->second];
+    }
+
+    // Highest counts first
+    std::vector<Entry> top(size_t limit) const {
+        std::vector<Entry> result(heap_.begin(), heap_.end());
+        std::sort(result.begin(), result.end(),
+                  [](const Entry& a, const Entry& b) { return a.count > b.count; });
+        if (result.size() > limit) result.resize(limit);
+        return result;
+    }
+
+    void decay(unsigned shift = 1) {
+        // Uniform halving keeps heap order; keys that reach zero are dropped
+        std::vector<Entry> kept;
+        kept.reserve(heap_.size());
+        for (auto& entry : heap_) {
+            entry.count >>= shift;
+            entry.error >>= shift;
+            if (entry.count > 0) kept.push_back(std::move(entry));
+        }
+        heap_.swap(kept);
+        positions_.clear();
+        std::make_heap(heap_.begin(), heap_.end(),
+                       [](const Entry& a, const Entry& b) { return a.count > b.count; });
+        for (size_t i = 0; i < heap_.size(); ++i) positions_[heap_[i].key] = i;
+    }
+
+    void clear() {
+        heap_.clear();
+        positions_.clear();
+    }
+
+    size_t size() const { return heap_.size(); }
+    size_t capacity() const { return capacity_; }
+    uint64_t min_count() const { return heap_.size() < capacity_ ? 0 : heap_.front().count; }
+};
+
+// Cuckoo filter with 16-bit fingerprints and 4-slot buckets.
+// Supports deletion; false positive rate is about 8 / 65536 at full load.
+class CuckooFilter {
+private:
+    static constexpr size_t kSlots = 4;
+    static constexpr int kMaxKicks = 500;
+
+    std::vector<std::array<uint16_t, kSlots>> buckets_;
+    size_t mask_;
+    size_t count_;
+    uint64_t kick_state_;
+
+    static uint16_t fingerprint(uint64_t hash) {
+        uint16_t fp = static_cast<uint16_t>(hash >> 48);
+        return fp == 0 ? 1 : fp;
+    }
+
+    size_t alt_index(size_t index, uint16_t fp) const {
+        return (index ^ static_cast<size_t>(sketch_mix(fp))) & mask_;
+    }
+
+    bool insert_into(size_t index, uint16_t fp) {
+        for (auto& slot : buckets_[index]) {
+            if (slot == 0) { slot = fp; return true; }
+        }
+        return false;
+    }
+
+    bool bucket_has(size_t index, uint16_t fp) const {
+        for (uint16_t slot : buckets_[index]) {
+            if (slot == fp) return true;
+        }
+        return false;
+    }
+
+public:
+    // capacity is the number of items to hold at ~95% load
+    explicit CuckooFilter(size_t capacity = 1 << 16) : mask_(0), count_(0), kick_state_(0x9e3779b97f4a7c15ULL) {
+        size_t needed = std::max<size_t>(capacity / kSlots * 100 / 95 + 1, 1);
+        size_t n = 1;
+        while (n < needed) n <<= 1;
+        buckets_.assign(n, std::array<uint16_t, kSlots>{});
+        mask_ = n - 1;
+    }
+
+    // Returns false when the filter is too full to place the item
+    bool insert_hash(uint64_t hash) {
+        uint16_t fp = fingerprint(hash);
+        size_t i1 = static_cast<size_t>(hash) & mask_;
+        size_t i2 = alt_index(i1, fp);
+        if (insert_into(i1, fp) || insert_into(i2, fp)) { ++count_; return true; }
+
+        // Evict random residents along the cuckoo path; undo on failure
+        std::vector<std::pair<size_t, size_t>> path;
+        size_t index = (kick_state_ & 1) ? i1 : i2;
+        for (int kick = 0; kick < kMaxKicks; ++kick) {
+            kick_state_ = sketch_mix(kick_state_ + 1);
+            size_t slot = kick_state_ % kSlots;
+            std::swap(fp, buckets_[index][slot]);
+            path.emplace_back(index, slot);
+            index = alt_index(index, fp);
+            if (insert_into(index, fp)) { ++count_; return true; }
+        }
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            std::swap(fp, buckets_[it->first][it->second]);
+        }
+        return false;
+    }
+
+    bool contains_hash(uint64_t hash) const {
+        uint16_t fp = fingerprint(hash);
+        size_t i1 = static_cast<size_t>(hash) & mask_;
+        return bucket_has(i1, fp) || bucket_has(alt_index(i1, fp), fp);
+    }
+
+    bool erase_hash(uint64_t hash) {
+        uint16_t fp = fingerprint(hash);
+        size_t i1 = static_cast<size_t>(hash) & mask_;
+        for (size_t index : {i1, alt_index(i1, fp)}) {
+            for (auto& slot : buckets_[index]) {
+                if (slot == fp) { slot = 0; --count_; return true; }
+            }
+        }
+        return false;
+    }
+
+    bool insert(const std::string& key) { return insert_hash(sketch_hash(key)); }
+    bool contains(const std::string& key) const { return contains_hash(sketch_hash(key)); }
+    bool erase(const std::string& key) { return erase_hash(sketch_hash(key)); }
+
+    void clear() {
+        for (auto& bucket : buckets_) bucket.fill(0);
+        count_ = 0;
+    }
+
+    size_t size() const { return count_; }
+    size_t capacity() const { return buckets_.size() * kSlots; }
+    size_t memory_bytes() const { return buckets_.size() * sizeof(buckets_[0]); }
+};
+
+// Binary trie over IPv4 prefixes; a lookup walks at most 32 nodes
+class CidrTrie {
+private:
+    struct Node {
+        int32_t child[2];
+        bool terminal;
+    };
+
+    std::vector<Node> nodes_;
+    size_t prefix_count_;
+
+public:
+    CidrTrie() : nodes_(1, Node{{-1, -1}, false}), prefix_count_(0) {}
+
+    void insert(uint32_t prefix, int length) {
+        int32_t node = 0;
+        for (int bit = 0; bit < length; ++bit) {
+            int dir = (prefix >> (31 - bit)) & 1;
+            if (nodes_[node].child[dir] < 0) {
+                nodes_[node].child[dir] = static_cast<int32_t>(nodes_.size());
+                nodes_.push_back(Node{{-1, -1}, false});
+            }
+            node = nodes_[node].child[dir];
+        }
+        if (!nodes_[node].terminal) {
+            nodes_[node].terminal = true;
+            ++prefix_count_;
+        }
+    }
+
+    bool erase(uint32_t prefix, int length) {
+        int32_t node = 0;
+        for (int bit = 0; bit < length && node >= 0; ++bit) {
+            node = nodes_[node].child[(prefix >> (31 - bit)) & 1];
+        }
+        if (node < 0 || !nodes_[node].terminal) return false;
+        nodes_[node].terminal = false;
+        --prefix_count_;
+        return true;
+    }
+
+    // True when any stored prefix covers address
+    bool contains(uint32_t address) const {
+        int32_t node = 0;
+        for (int bit = 0; ; ++bit) {
+            if (nodes_[node].terminal) return true;
+            if (bit == 32) return false;
+            node = nodes_[node].child[(address >> (31 - bit)) & 1];
+            if (node < 0) return false;
+        }
+    }
+
+    void clear() {
+        nodes_.assign(1, Node{{-1, -1}, false});
+        prefix_count_ = 0;
+    }
+
+    size_t size() const { return prefix_count_; }
+    size_t memory_bytes() const { return nodes_.size() * sizeof(Node); }
+};
+
+// Parses dotted-quad IPv4; returns false for anything else (e.g. IPv6)
+inline bool parse_ipv4(const std::string& text, uint32_t& address) {
+    unsigned a, b, c, d;
+    char tail;
+    if (std::sscanf(text.c_str(), "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4) return false;
+    if (a > 255 || b > 255 || c > 255 || d > 255) return false;
+    address = (a << 24) | (b << 16) | (c << 8) | d;
+    return true;
+}
+
+// Blocklist for single addresses and CIDR ranges.
+// Both are exact: entries come from operators, not from attacker traffic, so they
+// are bounded by address_capacity rather than kept in a probabilistic filter that
+// could block or unblock the wrong address.
+class IpBlocklist {
+private:
+    size_t address_capacity_;
+    std::unordered_set<uint32_t> ipv4_addresses_;
+    std::unordered_set<std::string> other_addresses_;    // IPv6 and anything else, as given
+    CidrTrie ranges_;
+
+    static bool parse_cidr(const std::string& spec, uint32_t& prefix, int& length) {
+        size_t slash = spec.find('/');
+        if (slash == std::string::npos) return false;
+        if (!parse_ipv4(spec.substr(0, slash), prefix)) return false;
+        int len = std::atoi(spec.c_str() + slash + 1);
+        if (len < 0 || len > 32) return false;
+        length = len;
+        if (length < 32) prefix &= length == 0 ? 0u : ~((1u << (32 - length)) - 1);
+        return true;
+    }
+
+public:
+    explicit IpBlocklist(size_t address_capacity = 1 << 16) : address_capacity_(address_capacity) {}
+
+    // Accepts "a.b.c.d", "a.b.c.d/n" or any other address string. Returns false
+    // only when a new single address would exceed the capacity.
+    bool block(const std::string& spec) {
+        uint32_t prefix;
+        int length;
+        if (parse_cidr(spec, prefix, length)) {
+            ranges_.insert(prefix, length);
+            return true;
+        }
+        uint32_t v4;
+        const bool is_v4 = parse_ipv4(spec, v4);
+        if (is_v4 ? ipv4_addresses_.count(v4) > 0 : other_addresses_.count(spec) > 0) return true;
+        if (address_count() >= address_capacity_) return false;
+        if (is_v4) {
+            ipv4_addresses_.insert(v4);
+        } else {
+            other_addresses_.insert(spec);
+        }
+        return true;
+    }
+
+    // Removes exactly what block() added; false if spec was never blocked
+    bool unblock(const std::string& spec) {
+        uint32_t prefix;
+        int length;
+        if (parse_cidr(spec, prefix, length)) return ranges_.erase(prefix, length);
+        uint32_t v4;
+        if (parse_ipv4(spec, v4)) return ipv4_addresses_.erase(v4) > 0;
+        return other_addresses_.erase(spec) > 0;
+    }
+
+    bool is_blocked(const std::string& ip) const {
+        uint32_t v4;
+        if (!parse_ipv4(ip, v4)) return other_addresses_.count(ip) > 0;
+        return ipv4_addresses_.count(v4) > 0 || (ranges_.size() > 0 && ranges_.contains(v4));
+    }
+
+    void clear() {
+        ipv4_addresses_.clear();
+        other_addresses_.clear();
+        ranges_.clear();
+    }
+
+    size_t size() const { return address_count() + ranges_.size(); }
+    size_t address_count() const { return ipv4_addresses_.size() + other_addresses_.size(); }
+    size_t range_count() const { return ranges_.size(); }
+
+    // Approximate: hash nodes plus bucket arrays
+    size_t memory_bytes() const {
+        size_t bytes = ranges_.memory_bytes();
+        bytes += ipv4_addresses_.size() * (sizeof(uint32_t) + 2 * sizeof(void*)) +
+                 ipv4_addresses_.bucket_count() * sizeof(void*);
+        for (const auto& address : other_addresses_) bytes += sizeof(std::string) + address.capacity() + sizeof(void*);
+        return bytes + other_addresses_.bucket_count() * sizeof(void*);
+    }
+};
+
+} // namespace utils
+} // namespace dds
@@ -6,6 +6,7 @@
 #include <chrono>
 #include "mpi_stub.h"
 #include "eigen_stub.h"
+#include "eigen_decompositions.h"
 
 namespace dds {
 
@@ -14,11 +15,22 @@ class Job;
 class WorkerNode;
 class DataPartition;
 
+// Numeric precision: configure with -DDDS_USE_FLOAT32=ON for float32 storage.
+// Sums, norms, losses and statistics accumulate in Accumulator either way.
+#ifdef DDS_USE_FLOAT32
+using Scalar = float;
+#else
+using Scalar = double;
+#endif
+using Accumulator = double;
+
 // Basic types
-using Matrix = Eigen::MatrixXd;
-using Vector = Eigen::VectorXd;
+using Matrix = Eigen::Matrix<Scalar>;
+using Vector = Eigen::Vector<Scalar>;
 using Index = Eigen::Index;
-using Scalar = double;
+using SparseMatrixCSR = Eigen::SparseMatrix<Scalar, Eigen::RowMajor>;
+using SparseMatrixCSC = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
+using Triplet = Eigen::Triplet<Scalar>;
 
 // Job types
 enum class JobType {
@@ -2,6 +2,7 @@
 
 #include "../utils/types.h"
 #include "../storage/hadoop_storage.h"
+#include "../utils/sketches.h"
 #include <string>
 #include <map>
 #include <functional>
@@ -133,8 +134,8 @@ private:
     std::map<std::string, size_t> endpoint_request_counts_;
     std::map<std::string, size_t> endpoint_error_counts_;
     std::map<int, size_t> status_code_counts_;
-    std::map<std::string, size_t> user_agent_counts_;
-    std::map<std::string, size_t> ip_address_counts_;
+    utils::SpaceSaving<> top_user_agents_{256};      // Bounded heavy hitters, not exact counts
+    utils::SpaceSaving<> top_ip_addresses_{256};
     std::vector<std::chrono::steady_clock::time_point> request_timestamps_;
     std::mutex analytics_mutex_;
     size_t total_requests_;
@@ -146,8 +147,8 @@ private:
     bool security_enabled_;
     std::map<std::string, std::string> csrf_tokens_;
     std::map<std::string, size_t> security_event_counts_;
-    std::vector<std::string> blocked_ips_;
-    std::map<std::string, std::chrono::steady_clock::time_point> ip_rate_limits_;
+    utils::IpBlocklist blocked_ips_;                // Exact addresses, ranges in a CIDR trie
+    utils::WindowedCountMinSketch ip_request_window_{std::chrono::minutes(1), 6};  // Requests per IP, last minute
     std::mutex security_mutex_;
     std::string security_log_file_;
 
@@ -473,6 +474,9 @@ public:
     void add_security_headers(HttpResponse& res);
     std::string generate_secure_random_string(size_t length);
     bool is_rate_limited_by_ip(const std::string& ip);
+    bool block_ip(const std::string& ip_or_cidr);
+    bool unblock_ip(const std::string& ip_or_cidr);
+    bool is_ip_blocked(const std::string& ip);
     void log_security_event(const std::string& event, const std::string& ip, const std::string& details);
     
     // Storage integration
@@ -490,13 +494,15 @@ public:
     HttpResponse handle_algorithm_predict(const HttpRequest& req);
     HttpResponse handle_cluster_info(const HttpRequest& req);
     
+    // Wire format
+    HttpRequest parse_request(const std::string& request);
+    std::string format_response(const HttpResponse& response);
+    
 private:
     void run_server(int serverSocket);
     void handle_client(int clientSocket);
-    HttpRequest parse_request(const std::string& request);
     HttpResponse handle_request(const HttpRequest& req);
     HttpResponse serve_dashboard();
-    std::string format_response(const HttpResponse& response);
     std::string parse_request_line(const std::string& line, std::string& method, std::string& path);
     std::map<std::string, std::string> parse_headers(const std::vector<std::string>& lines);
     std::map<std::string, std::string> parse_query_params(const std::string& query_string);
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Compare dds_bench JSON results against a stored baseline.
+
+Usage:
+    compare_bench.py --baseline bench/baseline.json [--threshold 10] RESULTS...
+    compare_bench.py --baseline bench/baseline.json --update RESULTS...
+
+RESULTS are JSON files written by a dds_bench_* target (--json=...) or directories
+containing them. A benchmark regresses when its median is more than --threshold
+percent slower than the baseline *and* the confidence intervals do not overlap, so
+ordinary run-to-run noise does not fail the build. Exits 1 on any regression.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+
+def load_results(paths):
+    """Returns {"suite/name": benchmark} merged from files and directories."""
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            files.extend(sorted(os.path.join(path, f) for f in os.listdir(path) if f.endswith(".json")))
+        else:
+            files.append(path)
+
+    merged = {}
+    for path in files:
+        with open(path) as f:
+            data = json.load(f)
+        suite = data.get("suite", os.path.splitext(os.path.basename(path))[0])
+        for bench in data.get("benchmarks", []):
+            merged[suite + "/" + bench["name"]] = bench
+    return merged
+
+
+def load_baseline(path):
+    with open(path) as f:
+        data = json.load(f)
+    return {b["name"]: b for b in data.get("benchmarks", [])}
+
+
+BASELINE_FIELDS = ("median_ns", "mad_ns", "ci_low_ns", "ci_high_ns", "iterations")
+
+
+def write_baseline(path, results):
+    """One benchmark per line so baseline updates review as small diffs."""
+    lines = []
+    for key in sorted(results):
+        bench = {"name": key}
+        for field in BASELINE_FIELDS:
+            if field in results[key]:
+                bench[field] = results[key][field]
+        lines.append("  " + json.dumps(bench))
+    with open(path, "w") as f:
+        f.write('{"benchmarks": [\n' + ",\n".join(lines) + "\n]}\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("results", nargs="+", help="result JSON files or directories")
+    parser.add_argument("--baseline", required=True, help="stored baseline JSON")
+    parser.add_argument("--threshold", type=float, default=10.0, help="allowed slowdown in percent")
+    parser.add_argument("--metric", default="median_ns", help="per-iteration time field to compare")
+    parser.add_argument("--update", action="store_true", help="overwrite the baseline with these results")
+    args = parser.parse_args()
+
+    current = load_results(args.results)
+    if not current:
+        print("no benchmark results found", file=sys.stderr)
+        return 2
+
+    if args.update:
+        write_baseline(args.baseline, current)
+        print("baseline updated: %s (%d benchmarks)" % (args.baseline, len(current)))
+        return 0
+
+    if not os.path.exists(args.baseline):
+        print("no baseline at %s; run with --update to create one" % args.baseline, file=sys.stderr)
+        return 2
+    baseline = load_baseline(args.baseline)
+
+    limit = 1.0 + args.threshold / 100.0
+    regressions = []
+    width = max(len(k) for k in current)
+    print("%-*s %14s %14s %9s" % (width, "benchmark", "baseline", "current", "change"))
+    for key in sorted(current):
+        cur = current[key]
+        base = baseline.get(key)
+        if base is None:
+            print("%-*s %14s %14.1f %9s" % (width, key, "-", cur[args.metric], "new"))
+            continue
+
+        ratio = cur[args.metric] / base[args.metric] if base[args.metric] > 0 else 1.0
+        separated = cur.get("ci_low_ns", cur[args.metric]) > base.get("ci_high_ns", base[args.metric])
+        status = ""
+        if ratio > limit and separated:
+            status = "  REGRESSION"
+            regressions.append(key)
+        elif ratio < 1.0 / limit:
+            status = "  faster"
+        print("%-*s %14.1f %14.1f %+8.1f%%%s" % (width, key, base[args.metric], cur[args.metric],
+                                               (ratio - 1.0) * 100.0, status))
+
+    for key in sorted(set(baseline) - set(current)):
+        print("%-*s missing from current results" % (width, key))
+
+    if regressions:
+        print("\n%d benchmark(s) regressed by more than %.1f%%:" % (len(regressions), args.threshold))
+        for key in regressions:
+            print("  " + key)
+        return 1
+    print("\nno regressions beyond %.1f%%" % args.threshold)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,8 +1,8 @@
 #include "../../include/algorithms/advanced_algorithms.h"
+#include <chrono>
 #include <iostream>
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+#include <limits>
+#include <numeric>
 
 namespace dds {
 namespace algorithms {
@@ -13,32 +13,41 @@ NeuralLayer::NeuralLayer(LayerType type, int input_size, int output_size, Activa
     weights_.resize(output_size, input_size);
     biases_.resize(output_size);
     activations_.resize(output_size, 1);
-    gradients_.resize(output_size, 1);
+    gradients_.resize(output_size, input_size);
+    bias_gradients_.resize(output_size);
 }
 
-Eigen::MatrixXd NeuralLayer::forward(const Eigen::MatrixXd& input) {
+Matrix NeuralLayer::forward(const Matrix& input) {
     return input;
 }
 
-Eigen::MatrixXd NeuralLayer::backward(const Eigen::MatrixXd& gradient) {
+Matrix NeuralLayer::backward(const Matrix& gradient) {
     return gradient;
 }
 
+bool NeuralLayer::supports_workspace(Index /*input_cols*/) const {
+    // Layers without row kernels run through forward() and backward() only
+    return false;
+}
+
+void NeuralLayer::forward_rows(const Scalar* /*input*/, Index /*rows*/, Index /*input_cols*/, Scalar* /*output*/,
+                               Scalar* /*cache*/) {
+}
+
+void NeuralLayer::backward_rows(Scalar* /*gradient*/, Scalar* /*input_gradient*/) {
+}
+
 void NeuralLayer::initialize_weights(double std_dev) {
     // Stub implementation
 }
 
 void NeuralLayer::update_weights(double learning_rate) {
-    // Update weights using gradient descent
-    // weights = weights - learning_rate * gradients
-    // Use range-based loops for clarity and performance
-    for (int i = 0; i < weights_.rows(); ++i) {
-        for (int j = 0; j < weights_.cols(); ++j) {
-            weights_(i, j) -= learning_rate * gradients_(i, j);
-        }
-    }
-    for (auto i = 0; i < biases_.size(); ++i) {
-        biases_[i] -= learning_rate * gradients_(i, 0);
+    // weights -= learning_rate * gradients, one axpy per tensor
+    std::vector<ParameterView> parameters;
+    collect_parameters(parameters);
+    const Scalar step = static_cast<Scalar>(-learning_rate);
+    for (const ParameterView& parameter : parameters) {
+        utils::simd::axpy(step, parameter.gradients, parameter.values, parameter.size);
     }
 }
 
@@ -46,604 +55,3131 @@ void NeuralLayer::zero_gradients() {
     // Stub implementation
 }
 
-// Activation functions
-Eigen::MatrixXd NeuralLayer::relu(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (auto i = 0; i < x.rows(); ++i) {
-        for (auto j = 0; j < x.cols(); ++j) {
-            result(i, j) = std::max(0.0, x(i, j));
+void NeuralLayer::collect_parameters(std::vector<ParameterView>& parameters) {
+    // Layers without trainable weights (dropout) have empty tensors here
+    if (weights_.size() > 0 && gradients_.size() == weights_.size()) {
+        parameters.push_back({weights_.data(), gradients_.data(), static_cast<size_t>(weights_.size()), true});
+    }
+    if (biases_.size() > 0 && bias_gradients_.size() == biases_.size()) {
+        parameters.push_back({biases_.data(), bias_gradients_.data(), static_cast<size_t>(biases_.size()), false});
+    }
+}
+
+LayerConfig NeuralLayer::config() const {
+    LayerConfig config{};
+    config.type = static_cast<uint32_t>(type_);
+    config.activation = static_cast<uint32_t>(activation_);
+    config.dims[0] = input_size_;
+    config.dims[1] = output_size_;
+    return config;
+}
+
+std::unique_ptr<NeuralLayer> NeuralLayer::from_config(const LayerConfig& config) {
+    const int32_t* d = config.dims;
+    for (int32_t dim : config.dims) {
+        if (dim < 0) return nullptr;
+    }
+    if (config.activation > static_cast<uint32_t>(ActivationType::LINEAR)) return nullptr;
+    const auto activation = static_cast<ActivationType>(config.activation);
+    switch (static_cast<LayerType>(config.type)) {
+        case LayerType::DENSE:
+            return std::make_unique<DenseLayer>(d[0], d[1], activation);
+        case LayerType::DROPOUT:
+            return std::make_unique<DropoutLayer>(config.options[0], d[0]);
+        case LayerType::BATCH_NORMALIZATION:
+            return std::make_unique<BatchNormLayer>(d[0], config.options[0], config.options[1], activation);
+        case LayerType::ACTIVATION:
+            return std::make_unique<SoftmaxCrossEntropyLayer>(d[1]);
+        case LayerType::CONVOLUTIONAL: {
+            auto layer = std::make_unique<ConvLayer>(d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7], activation);
+            layer->set_winograd(config.options[0] != 0.0);
+            return layer;
         }
+        case LayerType::LSTM:
+        case LayerType::GRU: {
+            std::unique_ptr<RecurrentLayer> layer;
+            if (static_cast<LayerType>(config.type) == LayerType::LSTM) {
+                layer = std::make_unique<LSTMLayer>(d[0], d[1], d[2], d[3] != 0);
+            } else {
+                layer = std::make_unique<GRULayer>(d[0], d[1], d[2], d[3] != 0);
+            }
+            layer->set_truncation(d[4]);
+            return layer;
+        }
+    }
+    return nullptr;
+}
+
+// Activation functions
+namespace {
+
+// Elementwise activations as value(x) and slope(x) = d value / dx, shared by the
+// static Matrix helpers and the layers' row kernels
+struct Relu {
+    double value(double x) const { return x > 0 ? x : 0.0; }
+    double slope(double x) const { return x > 0 ? 1.0 : 0.0; }
+};
+
+struct Sigmoid {
+    double value(double x) const { return 1.0 / (1.0 + std::exp(-x)); }
+    double slope(double x) const {
+        const double s = value(x);
+        return s * (1.0 - s);
+    }
+};
+
+struct Tanh {
+    double value(double x) const { return std::tanh(x); }
+    double slope(double x) const {
+        const double t = std::tanh(x);
+        return 1.0 - t * t;
+    }
+};
+
+struct LeakyRelu {
+    double alpha = 0.01;
+    double value(double x) const { return x > 0 ? x : alpha * x; }
+    double slope(double x) const { return x > 0 ? 1.0 : alpha; }
+};
+
+struct Elu {
+    double alpha = 1.0;
+    double value(double x) const { return x > 0 ? x : alpha * (std::exp(x) - 1); }
+    double slope(double x) const { return x > 0 ? 1.0 : alpha * std::exp(x); }
+};
+
+struct Swish {
+    double beta = 1.0;
+    double value(double x) const { return x / (1.0 + std::exp(-beta * x)); }
+    double slope(double x) const {
+        const double s = 1.0 / (1.0 + std::exp(-beta * x));
+        return s + x * s * (1.0 - s) * beta;
     }
+};
+
+// tanh approximation
+struct Gelu {
+    static constexpr double kSqrt2OverPi = 0.79788456080286535588;
+    double value(double x) const {
+        return 0.5 * x * (1.0 + std::tanh(kSqrt2OverPi * (x + 0.044715 * x * x * x)));
+    }
+    double slope(double x) const {
+        const double t = std::tanh(kSqrt2OverPi * (x + 0.044715 * x * x * x));
+        const double sech2 = 1.0 - t * t;
+        return 0.5 * (1.0 + t) + 0.5 * x * sech2 * kSqrt2OverPi * (1.0 + 3.0 * 0.044715 * x * x);
+    }
+};
+
+struct Mish {
+    double value(double x) const { return x * std::tanh(std::log(1.0 + std::exp(x))); }
+    double slope(double x) const {
+        const double tanh_sp = std::tanh(std::log(1.0 + std::exp(x)));
+        const double sigmoid = 1.0 / (1.0 + std::exp(-x));
+        return tanh_sp + x * sigmoid * (1.0 - tanh_sp * tanh_sp);
+    }
+};
+
+struct Selu {
+    static constexpr double kAlpha = 1.6732632423543772848170429916717;
+    static constexpr double kScale = 1.0507009873554804934193349852946;
+    double value(double x) const { return kScale * (x > 0 ? x : kAlpha * (std::exp(x) - 1.0)); }
+    double slope(double x) const { return kScale * (x > 0 ? 1.0 : kAlpha * std::exp(x)); }
+};
+
+struct HardSigmoid {
+    double value(double x) const { return std::max(0.0, std::min(1.0, 0.2 * x + 0.5)); }
+    double slope(double x) const { return (x >= -2.5 && x <= 2.5) ? 0.2 : 0.0; }
+};
+
+struct HardSwish {
+    double value(double x) const { return x * HardSigmoid().value(x); }
+    double slope(double x) const {
+        if (x <= -2.5) return 0.0;
+        if (x >= 2.5) return 1.0;
+        return 0.2 * x + 0.5 + x * 0.2;
+    }
+};
+
+// Elements per parallel chunk of the elementwise row kernels
+constexpr Index kElementwiseGrain = 16384;
+
+template<typename F>
+void activate_values(F f, const Scalar* z, Scalar* y, Index n) {
+    utils::parallel_for(0, n, kElementwiseGrain, [&](Index b, Index e) {
+        for (Index i = b; i < e; ++i) y[i] = static_cast<Scalar>(f.value(z[i]));
+    });
+}
+
+template<typename F>
+void scale_by_slope(F f, const Scalar* z, Scalar* gradient, Index n) {
+    utils::parallel_for(0, n, kElementwiseGrain, [&](Index b, Index e) {
+        for (Index i = b; i < e; ++i) gradient[i] *= static_cast<Scalar>(f.slope(z[i]));
+    });
+}
+
+template<typename F>
+Matrix map_values(F f, const Matrix& x) {
+    Matrix result(x.rows(), x.cols());
+    activate_values(f, x.data(), result.data(), x.size());
     return result;
 }
 
-Eigen::MatrixXd NeuralLayer::sigmoid(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (auto i = 0; i < x.rows(); ++i) {
-        for (auto j = 0; j < x.cols(); ++j) {
-            result(i, j) = 1.0 / (1.0 + std::exp(-x(i, j)));
-        }
+template<typename F>
+Matrix map_slopes(F f, const Matrix& x) {
+    Matrix result(x.rows(), x.cols());
+    const Scalar* z = x.data();
+    Scalar* y = result.data();
+    utils::parallel_for(0, x.size(), kElementwiseGrain, [&](Index b, Index e) {
+        for (Index i = b; i < e; ++i) y[i] = static_cast<Scalar>(f.slope(z[i]));
+    });
+    return result;
+}
+
+// Calls fn with the functor for an elementwise activation; false for SOFTMAX and LINEAR
+template<typename Fn>
+bool with_elementwise(ActivationType activation, Fn fn) {
+    switch (activation) {
+        case ActivationType::RELU: fn(Relu()); return true;
+        case ActivationType::SIGMOID: fn(Sigmoid()); return true;
+        case ActivationType::TANH: fn(Tanh()); return true;
+        case ActivationType::LEAKY_RELU: fn(LeakyRelu()); return true;
+        case ActivationType::ELU: fn(Elu()); return true;
+        case ActivationType::SWISH: fn(Swish()); return true;
+        case ActivationType::GELU: fn(Gelu()); return true;
+        case ActivationType::MISH: fn(Mish()); return true;
+        case ActivationType::SELU: fn(Selu()); return true;
+        case ActivationType::HARD_SIGMOID: fn(HardSigmoid()); return true;
+        case ActivationType::HARD_SWISH: fn(HardSwish()); return true;
+        default: return false;
     }
+}
+
+// Row-wise softmax of one sample's logits: out = out_scale * exp(z - max) / sum, and
+// returns log(sum(exp(z))) for the cross-entropy. out may alias z.
+Accumulator softmax_row(const Scalar* z, Scalar* out, Index cols, Accumulator out_scale = 1.0) {
+    const size_t n = static_cast<size_t>(cols);
+    const Scalar max_val = utils::simd::maximum(z, n);
+    utils::simd::exp(z, out, n, max_val);
+    const Accumulator sum = utils::simd::sum(out, n);
+    utils::simd::scale(static_cast<Scalar>(out_scale / sum), out, n);
+    return static_cast<Accumulator>(max_val) + std::log(sum);
+}
+
+// Each row is one sample's class scores; y may alias z
+void softmax_rows(const Scalar* z, Scalar* y, Index rows, Index cols) {
+    if (cols == 0) return;
+    const Index grain = std::max<Index>(1, 4096 / cols);
+    utils::parallel_for(0, rows, grain, [&](Index r0, Index r1) {
+        for (Index r = r0; r < r1; ++r) softmax_row(z + r * cols, y + r * cols, cols);
+    });
+}
+
+} // namespace
+
+Matrix NeuralLayer::relu(const Matrix& x) {
+    return map_values(Relu(), x);
+}
+
+Matrix NeuralLayer::sigmoid(const Matrix& x) {
+    return map_values(Sigmoid(), x);
+}
+
+Matrix NeuralLayer::tanh(const Matrix& x) {
+    return map_values(Tanh(), x);
+}
+
+Matrix NeuralLayer::softmax(const Matrix& x) {
+    Matrix result(x.rows(), x.cols());
+    softmax_rows(x.data(), result.data(), x.rows(), x.cols());
     return result;
 }
 
-Eigen::MatrixXd NeuralLayer::tanh(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            result(i, j) = std::tanh(x(i, j));
-        }
+Matrix NeuralLayer::leaky_relu(const Matrix& x, double alpha) {
+    return map_values(LeakyRelu{alpha}, x);
+}
+
+Matrix NeuralLayer::elu(const Matrix& x, double alpha) {
+    return map_values(Elu{alpha}, x);
+}
+
+Matrix NeuralLayer::swish(const Matrix& x, double beta) {
+    return map_values(Swish{beta}, x);
+}
+
+Matrix NeuralLayer::gelu(const Matrix& x) {
+    return map_values(Gelu(), x);
+}
+
+Matrix NeuralLayer::mish(const Matrix& x) {
+    return map_values(Mish(), x);
+}
+
+Matrix NeuralLayer::selu(const Matrix& x) {
+    return map_values(Selu(), x);
+}
+
+Matrix NeuralLayer::hard_sigmoid(const Matrix& x) {
+    return map_values(HardSigmoid(), x);
+}
+
+Matrix NeuralLayer::hard_swish(const Matrix& x) {
+    return map_values(HardSwish(), x);
+}
+
+// Activation derivatives
+Matrix NeuralLayer::relu_derivative(const Matrix& x) {
+    return map_slopes(Relu(), x);
+}
+
+Matrix NeuralLayer::sigmoid_derivative(const Matrix& x) {
+    return map_slopes(Sigmoid(), x);
+}
+
+Matrix NeuralLayer::tanh_derivative(const Matrix& x) {
+    return map_slopes(Tanh(), x);
+}
+
+Matrix NeuralLayer::softmax_derivative(const Matrix& x) {
+    // Diagonal of the row softmax Jacobian, s * (1 - s). Backpropagation through a
+    // softmax uses the full Jacobian-vector product instead (see activation_delta).
+    Matrix result = softmax(x);
+    for (Index i = 0; i < result.size(); ++i) {
+        result.data()[i] *= Scalar(1) - result.data()[i];
     }
     return result;
 }
 
-Eigen::MatrixXd NeuralLayer::softmax(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (int j = 0; j < x.cols(); ++j) {
-        double max_val = x.col(j).maxCoeff();
-        double sum = 0.0;
-        
-        // Compute exp(x - max) for numerical stability
-        for (int i = 0; i < x.rows(); ++i) {
-            result(i, j) = std::exp(x(i, j) - max_val);
-            sum += result(i, j);
+Matrix NeuralLayer::leaky_relu_derivative(const Matrix& x, double alpha) {
+    return map_slopes(LeakyRelu{alpha}, x);
+}
+
+Matrix NeuralLayer::elu_derivative(const Matrix& x, double alpha) {
+    return map_slopes(Elu{alpha}, x);
+}
+
+Matrix NeuralLayer::swish_derivative(const Matrix& x, double beta) {
+    return map_slopes(Swish{beta}, x);
+}
+
+Matrix NeuralLayer::gelu_derivative(const Matrix& x) {
+    return map_slopes(Gelu(), x);
+}
+
+Matrix NeuralLayer::mish_derivative(const Matrix& x) {
+    return map_slopes(Mish(), x);
+}
+
+Matrix NeuralLayer::selu_derivative(const Matrix& x) {
+    return map_slopes(Selu(), x);
+}
+
+Matrix NeuralLayer::hard_sigmoid_derivative(const Matrix& x) {
+    return map_slopes(HardSigmoid(), x);
+}
+
+Matrix NeuralLayer::hard_swish_derivative(const Matrix& x) {
+    return map_slopes(HardSwish(), x);
+}
+
+// DenseLayer implementation
+DenseLayer::DenseLayer(int input_size, int output_size, ActivationType activation)
+    : NeuralLayer(LayerType::DENSE, input_size, output_size, activation) {
+}
+
+Matrix DenseLayer::forward(const Matrix& input) {
+    if (input.cols() != input_size_) {
+        std::cout << "❌ Dense layer expects " << input_size_ << " input columns, got " << input.cols() << std::endl;
+        return Matrix();
+    }
+    const Index rows = input.rows();
+    activations_.resize(rows, output_size_);
+    if (!training_ && is_quantized()) {
+        forward_quantized(input.data(), rows, activations_.data());
+        return activations_;
+    }
+    // Store input for backward pass; the row kernel keeps a pointer to this copy
+    input_cache_ = input;
+    Scalar* cache = nullptr;
+    if (workspace_cache_columns() > 0) {
+        linear_cache_.resize(rows, output_size_);
+        cache = linear_cache_.data();
+    }
+    forward_rows(input_cache_.data(), rows, input.cols(), activations_.data(), cache);
+    return activations_;
+}
+
+Matrix DenseLayer::forward(const SparseMatrixCSR& input) {
+    // Keep the CSR input; densifying a wide one-hot batch is what we are avoiding
+    sparse_input_cache_ = input;
+    sparse_input_ = true;
+    
+    // input * weights^T straight from the row-major weights, no transpose copy
+    linear_cache_ = input.multiplyTransposed(weights_);
+    const Index rows = linear_cache_.rows();
+    for (Index r = 0; r < rows; ++r) {
+        Scalar* z = linear_cache_.data() + r * output_size_;
+        for (Index j = 0; j < output_size_; ++j) z[j] += biases_[j];
+    }
+    
+    activations_.resize(rows, output_size_);
+    batch_rows_ = rows;
+    cache_rows_ = linear_cache_.data();
+    activate_output(linear_cache_.data(), activations_.data(), rows);
+    return activations_;
+}
+
+void DenseLayer::forward_rows(const Scalar* input, Index rows, Index input_cols, Scalar* output, Scalar* cache) {
+    input_rows_ = input;
+    cache_rows_ = cache;
+    batch_rows_ = rows;
+    sparse_input_ = false;
+    
+    // Linear transformation z = input * weights^T + bias: each row starts as the bias
+    // and the NT gemm on the row-major weights accumulates onto it. A LINEAR layer has
+    // no cache and writes z straight to the output.
+    Scalar* z = cache ? cache : output;
+    for (Index r = 0; r < rows; ++r) std::copy_n(biases_.data(), output_size_, z + r * output_size_);
+    Eigen::internal::gemm_kernel(false, true, rows, static_cast<Index>(output_size_), input_cols, Scalar(1),
+                                 input, input_cols, weights_.data(), input_cols, z, static_cast<Index>(output_size_));
+    activate_output(z, output, rows);
+}
+
+namespace {
+
+// Rows quantized together; each group of four weight rows then stays in L1 while it
+// is applied to the whole block
+constexpr Index kQuantizedRowBlock = 32;
+
+} // namespace
+
+void DenseLayer::quantize(Scalar input_range) {
+    const Index in = input_size_;
+    const Index out = output_size_;
+    const Index block = static_cast<Index>(utils::simd::kInt8Block);
+    quantized_stride_ = (in + block - 1) / block * block;
+    quantized_weights_.assign(static_cast<size_t>(out * quantized_stride_), 0);
+    output_scales_.resize(static_cast<size_t>(out));
+    
+    // All-zero inputs or weights quantize to zero with any scale
+    quantized_input_range_ = input_range;
+    const Scalar input_scale = input_range > Scalar(0) ? input_range / Scalar(127) : Scalar(1);
+    input_inverse_scale_ = Scalar(1) / input_scale;
+    for (Index j = 0; j < out; ++j) {
+        const Scalar* row = weights_.data() + j * in;
+        Scalar range = Scalar(0);
+        for (Index k = 0; k < in; ++k) range = std::max(range, std::abs(row[k]));
+        const Scalar weight_scale = range > Scalar(0) ? range / Scalar(127) : Scalar(1);
+        utils::simd::quantize_i8(row, static_cast<size_t>(in), Scalar(1) / weight_scale,
+                                 quantized_weights_.data() + j * quantized_stride_);
+        output_scales_[j] = input_scale * weight_scale;
+    }
+}
+
+void DenseLayer::dequantize() {
+    quantized_weights_.clear();
+    quantized_weights_.shrink_to_fit();
+    output_scales_.clear();
+    quantized_stride_ = 0;
+}
+
+void DenseLayer::forward_quantized(const Scalar* input, Index rows, Scalar* output) {
+    const Index in = input_size_;
+    const Index out = output_size_;
+    const size_t stride = static_cast<size_t>(quantized_stride_);
+    const int8_t* weights = quantized_weights_.data();
+    
+    // z = (q(x) . q(w_j)) * scale_j + b_j, int32 dot products over int8 operands
+    const Index blocks = (rows + kQuantizedRowBlock - 1) / kQuantizedRowBlock;
+    utils::parallel_for(0, blocks, 1, [&](Index b0, Index b1) {
+        static thread_local std::vector<int8_t> quantized;
+        quantized.assign(static_cast<size_t>(kQuantizedRowBlock) * stride, 0);
+        for (Index b = b0; b < b1; ++b) {
+            const Index r0 = b * kQuantizedRowBlock;
+            const Index count = std::min(kQuantizedRowBlock, rows - r0);
+            for (Index r = 0; r < count; ++r) {
+                utils::simd::quantize_i8(input + (r0 + r) * in, static_cast<size_t>(in), input_inverse_scale_,
+                                         quantized.data() + r * stride);
+            }
+            Index j = 0;
+            for (; j + 4 <= out; j += 4) {
+                const int8_t* w = weights + j * stride;
+                for (Index r = 0; r < count; ++r) {
+                    int32_t dots[4];
+                    utils::simd::dot_i8x4(quantized.data() + r * stride, w, stride, stride, dots);
+                    Scalar* z = output + (r0 + r) * out + j;
+                    for (int k = 0; k < 4; ++k) {
+                        z[k] = static_cast<Scalar>(dots[k]) * output_scales_[j + k] + biases_[j + k];
+                    }
+                }
+            }
+            for (; j < out; ++j) {
+                for (Index r = 0; r < count; ++r) {
+                    const int32_t dot = utils::simd::dot_i8(quantized.data() + r * stride, weights + j * stride, stride);
+                    output[(r0 + r) * out + j] = static_cast<Scalar>(dot) * output_scales_[j] + biases_[j];
+                }
+            }
+        }
+    });
+    // The activation works in place: in inference nothing reads the pre-activation
+    activate_output(output, output, rows);
+}
+
+void DenseLayer::activate_output(Scalar* z, Scalar* output, Index rows) {
+    if (activation_ == ActivationType::LINEAR) {
+        if (z != output) std::copy_n(z, rows * output_size_, output);
+    } else {
+        activate_rows(z, output, rows, output_size_);
+    }
+    // A fused dropout masks the activated output in place
+    if (fused_dropout_) fused_dropout_->apply_forward(output, rows, output_size_);
+}
+
+Matrix DenseLayer::backward(const Matrix& gradient) {
+    // The row kernel turns the gradient into the delta in place, so work on a copy
+    Matrix delta = gradient;
+    Matrix input_gradient;
+    if (!sparse_input_) input_gradient.resize(delta.rows(), input_size_);
+    backward_rows(delta.data(), sparse_input_ ? nullptr : input_gradient.data());
+    if (sparse_input_) {
+        // Weight gradient delta^T * input (output x input), delta read in place
+        gradients_ = delta.transpose() * sparse_input_cache_;
+    }
+    return input_gradient;
+}
+
+void DenseLayer::backward_rows(Scalar* gradient, Scalar* input_gradient) {
+    const Index rows = batch_rows_;
+    const Index out = output_size_;
+    const Index in = input_size_;
+    
+    // Dropped units passed nothing forward, so they get no gradient
+    if (fused_dropout_) fused_dropout_->apply_backward(gradient);
+    if (activation_ != ActivationType::LINEAR) activation_delta_rows(cache_rows_, gradient, rows, out);
+    
+    // Bias gradient: column sums of delta, accumulated row by row in row-major order
+    bias_sums_.assign(static_cast<size_t>(out), 0.0);
+    for (Index r = 0; r < rows; ++r) {
+        const Scalar* row = gradient + r * out;
+        for (Index j = 0; j < out; ++j) bias_sums_[j] += row[j];
+    }
+    bias_gradients_.resize(out);
+    for (Index j = 0; j < out; ++j) bias_gradients_[j] = static_cast<Scalar>(bias_sums_[j]);
+    
+    if (!sparse_input_) {
+        // Weight gradient delta^T * input (output x input, the shape of weights_), TN gemm
+        gradients_.resize(out, in);
+        gradients_.setZero();
+        Eigen::internal::gemm_kernel(true, false, out, in, rows, Scalar(1), gradient, out, input_rows_, in,
+                                     gradients_.data(), in);
+    }
+    
+    if (input_gradient) {
+        // Gradient with respect to input (for backpropagation to previous layer)
+        std::fill_n(input_gradient, rows * in, Scalar(0));
+        Eigen::internal::gemm_kernel(false, false, rows, in, out, Scalar(1), gradient, out, weights_.data(), in,
+                                     input_gradient, in);
+    }
+}
+
+Matrix NeuralLayer::activate(const Matrix& linear_output) const {
+    // The row kernel works in place (and needs a writable cache for SOFTMAX)
+    Matrix activated_output = linear_output;
+    activate_rows(activated_output.data(), activated_output.data(), activated_output.rows(), activated_output.cols());
+    return activated_output;
+}
+
+void NeuralLayer::activate_rows(Scalar* z, Scalar* y, Index rows, Index cols) const {
+    const Index n = rows * cols;
+    if (with_elementwise(activation_, [&](auto f) { activate_values(f, z, y, n); })) return;
+    if (activation_ == ActivationType::SOFTMAX) {
+        // The cache keeps the probabilities for the Jacobian-vector product
+        softmax_rows(z, z, rows, cols);
+    }
+    if (z != y) std::copy_n(z, n, y);
+}
+
+// Gradient of the loss with respect to the linear output
+Matrix NeuralLayer::activation_delta(const Matrix& gradient) const {
+    if (activation_ == ActivationType::LINEAR) return gradient;
+    Matrix delta = gradient;
+    if (activation_ == ActivationType::SOFTMAX) {
+        const Matrix probabilities = softmax(linear_cache_);
+        activation_delta_rows(probabilities.data(), delta.data(), delta.rows(), delta.cols());
+    } else {
+        activation_delta_rows(linear_cache_.data(), delta.data(), delta.rows(), delta.cols());
+    }
+    return delta;
+}
+
+void NeuralLayer::activation_delta_rows(const Scalar* cache, Scalar* gradient, Index rows, Index cols) const {
+    if (with_elementwise(activation_, [&](auto f) { scale_by_slope(f, cache, gradient, rows * cols); })) return;
+    if (activation_ != ActivationType::SOFTMAX) return;
+    // dz = s * (g - <s, g>) per row; the Jacobian itself is never formed
+    const Index grain = std::max<Index>(1, 4096 / std::max<Index>(cols, 1));
+    utils::parallel_for(0, rows, grain, [&](Index r0, Index r1) {
+        for (Index r = r0; r < r1; ++r) {
+            const Scalar* s = cache + r * cols;
+            Scalar* g = gradient + r * cols;
+            const Scalar projection = static_cast<Scalar>(utils::simd::dot(s, g, static_cast<size_t>(cols)));
+            for (Index j = 0; j < cols; ++j) g[j] = s[j] * (g[j] - projection);
+        }
+    });
+}
+
+void DenseLayer::initialize_weights(double std_dev) {
+    // Initialize weights with Xavier/Glorot initialization
+    double limit = std_dev * std::sqrt(6.0 / (input_size_ + output_size_));
+    
+    // Each layer takes its own stream, so initialization is repeatable after
+    // utils::set_global_seed() and independent of the thread count
+    utils::RandomStream rng = utils::global_stream();
+    rng.fill_uniform(weights_.data(), static_cast<size_t>(weights_.size()),
+                     static_cast<Scalar>(-limit), static_cast<Scalar>(limit));
+    
+    // Initialize biases to small random values
+    rng.fill_uniform(biases_.data(), static_cast<size_t>(biases_.size()),
+                     static_cast<Scalar>(-0.1 * limit), static_cast<Scalar>(0.1 * limit));
+}
+
+// DropoutMask implementation
+namespace {
+
+void apply_mask_row(Scalar* x, const uint64_t* words, Index cols, Scalar scale) {
+    for (Index base = 0, w = 0; base < cols; base += 64, ++w) {
+        const uint64_t bits = words[w];
+        const Index n = std::min<Index>(64, cols - base);
+        for (Index j = 0; j < n; ++j) {
+            x[base + j] = ((bits >> j) & 1) ? x[base + j] * scale : Scalar(0);
+        }
+    }
+}
+
+} // namespace
+
+void DropoutMask::generate_and_apply(Matrix& x, double rate, utils::RandomStream& rng) {
+    generate_and_apply(x.data(), x.rows(), x.cols(), rate, rng);
+}
+
+void DropoutMask::generate_and_apply(Scalar* x, Index rows, Index cols, double rate, utils::RandomStream& rng) {
+    rows_ = rows;
+    cols_ = cols;
+    words_per_row_ = (cols_ + 63) / 64;
+    bits_.resize(static_cast<size_t>(rows_ * words_per_row_));
+    scale_ = rate < 1.0 ? static_cast<Scalar>(1.0 / (1.0 - rate)) : Scalar(0);
+    const double keep = 1.0 - rate;
+    
+    // Each row's mask words are drawn and consumed while they are still in registers;
+    // the counter-based stream makes the result independent of the row split
+    const Index grain = std::max<Index>(1, 4096 / std::max<Index>(cols_, 1));
+    utils::parallel_for(0, rows_, grain, [&](Index r0, Index r1) {
+        for (Index r = r0; r < r1; ++r) {
+            uint64_t* words = bits_.data() + r * words_per_row_;
+            rng.bernoulli_bits_at(static_cast<uint64_t>(r * words_per_row_),
+                                  static_cast<size_t>(words_per_row_), keep, words);
+            apply_mask_row(x + r * cols_, words, cols_, scale_);
+        }
+    });
+    rng.skip_bernoulli_words(bits_.size());
+}
+
+void DropoutMask::apply(Matrix& x) const {
+    apply(x.data());
+}
+
+void DropoutMask::apply(Scalar* x) const {
+    const Index grain = std::max<Index>(1, 4096 / std::max<Index>(cols_, 1));
+    utils::parallel_for(0, rows_, grain, [&](Index r0, Index r1) {
+        for (Index r = r0; r < r1; ++r) {
+            apply_mask_row(x + r * cols_, bits_.data() + r * words_per_row_, cols_, scale_);
         }
+    });
+}
+
+// DropoutLayer implementation
+DropoutLayer::DropoutLayer(double dropout_rate, int size)
+    : NeuralLayer(LayerType::DROPOUT, size, size), dropout_rate_(dropout_rate),
+      rng_(utils::global_stream()) {
+}
+
+LayerConfig DropoutLayer::config() const {
+    LayerConfig config = NeuralLayer::config();
+    config.options[0] = dropout_rate_;
+    return config;
+}
+
+Matrix DropoutLayer::forward(const Matrix& input) {
+    // Inference, or already applied by the producing layer
+    if (!training_ || fused_) return input;
+    Matrix output = input;
+    apply_forward(output);
+    return output;
+}
+
+Matrix DropoutLayer::backward(const Matrix& gradient) {
+    if (!training_ || fused_) return gradient;
+    Matrix input_gradient = gradient;
+    apply_backward(input_gradient);
+    return input_gradient;
+}
+
+void DropoutLayer::forward_rows(const Scalar* input, Index rows, Index input_cols, Scalar* output,
+                                Scalar* /*cache*/) {
+    batch_rows_ = rows;
+    columns_ = input_cols;
+    std::copy_n(input, rows * input_cols, output);
+    if (!fused_) apply_forward(output, rows, input_cols);
+}
+
+void DropoutLayer::backward_rows(Scalar* gradient, Scalar* input_gradient) {
+    if (!fused_) apply_backward(gradient);
+    if (input_gradient) std::copy_n(gradient, batch_rows_ * columns_, input_gradient);
+}
+
+void DropoutLayer::apply_forward(Matrix& activations) {
+    apply_forward(activations.data(), activations.rows(), activations.cols());
+}
+
+void DropoutLayer::apply_forward(Scalar* activations, Index rows, Index cols) {
+    if (!training_ || dropout_rate_ <= 0.0) return;
+    mask_.generate_and_apply(activations, rows, cols, dropout_rate_, rng_);
+}
+
+void DropoutLayer::apply_backward(Matrix& gradient) const {
+    apply_backward(gradient.data());
+}
+
+void DropoutLayer::apply_backward(Scalar* gradient) const {
+    if (!training_ || dropout_rate_ <= 0.0) return;
+    mask_.apply(gradient);
+}
+
+// BatchNormLayer implementation
+namespace {
+
+// Rows per statistics chunk; chunks are merged in order, so sums are deterministic
+constexpr Index kNormChunkRows = 64;
+
+} // namespace
+
+BatchNormLayer::BatchNormLayer(int features, double momentum, double epsilon, ActivationType activation)
+    : NeuralLayer(LayerType::BATCH_NORMALIZATION, features, features, activation),
+      momentum_(momentum), epsilon_(epsilon) {
+    weights_.resize(0, 0);
+    biases_.resize(0);
+    gradients_.resize(0, 0);
+    bias_gradients_.resize(0);
+    gamma_.resize(features);
+    beta_.resize(features);
+    running_mean_.resize(features);
+    running_var_.resize(features);
+    gamma_gradients_.resize(features);
+    beta_gradients_.resize(features);
+    initialize_weights();
+}
+
+void BatchNormLayer::initialize_weights(double /*std_dev*/) {
+    gamma_.setOnes();
+    beta_.setZero();
+    running_mean_.setZero();
+    running_var_.setOnes();
+    gamma_gradients_.setZero();
+    beta_gradients_.setZero();
+}
+
+void BatchNormLayer::batch_statistics(const Scalar* input, Index rows, Index cols) {
+    // Welford per chunk (one pass, numerically stable), then Chan's pairwise merge
+    const Index chunks = (rows + kNormChunkRows - 1) / kNormChunkRows;
+    partials_.resize(static_cast<size_t>(2 * chunks * cols));
+    
+    utils::parallel_for(0, chunks, 1, [&](Index c0, Index c1) {
+        for (Index c = c0; c < c1; ++c) {
+            Accumulator* mean = partials_.data() + 2 * c * cols;
+            Accumulator* m2 = mean + cols;
+            std::fill(mean, mean + 2 * cols, 0.0);
+            const Index r0 = c * kNormChunkRows;
+            const Index r1 = std::min(rows, r0 + kNormChunkRows);
+            for (Index r = r0; r < r1; ++r) {
+                const Scalar* x = input + r * cols;
+                const Accumulator inv_count = 1.0 / static_cast<Accumulator>(r - r0 + 1);
+                for (Index j = 0; j < cols; ++j) {
+                    const Accumulator delta = x[j] - mean[j];
+                    mean[j] += delta * inv_count;
+                    m2[j] += delta * (x[j] - mean[j]);
+                }
+            }
+        }
+    });
+    
+    Accumulator* mean = partials_.data();
+    Accumulator* m2 = mean + cols;
+    Accumulator count = static_cast<Accumulator>(std::min(rows, kNormChunkRows));
+    for (Index c = 1; c < chunks; ++c) {
+        const Accumulator* chunk_mean = partials_.data() + 2 * c * cols;
+        const Accumulator* chunk_m2 = chunk_mean + cols;
+        const Accumulator chunk_count = static_cast<Accumulator>(
+            std::min(rows, (c + 1) * kNormChunkRows) - c * kNormChunkRows);
+        const Accumulator total = count + chunk_count;
+        for (Index j = 0; j < cols; ++j) {
+            const Accumulator delta = chunk_mean[j] - mean[j];
+            mean[j] += delta * chunk_count / total;
+            m2[j] += chunk_m2[j] + delta * delta * count * chunk_count / total;
+        }
+        count = total;
+    }
+    
+    batch_mean_.resize(cols);
+    batch_inv_std_.resize(cols);
+    const Accumulator n = static_cast<Accumulator>(rows);
+    const Accumulator unbiased = rows > 1 ? n / (n - 1) : 1.0;
+    for (Index j = 0; j < cols; ++j) {
+        const Accumulator var = m2[j] / n;
+        batch_mean_[j] = static_cast<Scalar>(mean[j]);
+        batch_inv_std_[j] = static_cast<Scalar>(1.0 / std::sqrt(var + epsilon_));
+        running_mean_[j] = static_cast<Scalar>((1.0 - momentum_) * running_mean_[j] + momentum_ * mean[j]);
+        running_var_[j] = static_cast<Scalar>((1.0 - momentum_) * running_var_[j] + momentum_ * var * unbiased);
+    }
+}
+
+void BatchNormLayer::inference_affine(Vector& scale, Vector& shift) const {
+    scale.resize(gamma_.size());
+    shift.resize(gamma_.size());
+    for (Index j = 0; j < gamma_.size(); ++j) {
+        const double s = gamma_[j] / std::sqrt(static_cast<double>(running_var_[j]) + epsilon_);
+        scale[j] = static_cast<Scalar>(s);
+        shift[j] = static_cast<Scalar>(beta_[j] - running_mean_[j] * s);
+    }
+}
+
+Matrix BatchNormLayer::forward(const Matrix& input) {
+    Matrix output(input.rows(), input.cols());
+    normalized_.resize(input.rows(), workspace_cache_columns());
+    forward_rows(input.data(), input.rows(), input.cols(), output.data(), normalized_.data());
+    return output;
+}
+
+void BatchNormLayer::forward_rows(const Scalar* input, Index rows, Index input_cols, Scalar* output, Scalar* cache) {
+    const Index cols = input_cols;
+    cache_rows_ = cache;
+    batch_rows_ = rows;
+    // The pre-activation output goes to the second cache block when an activation follows
+    Scalar* z = activation_ == ActivationType::LINEAR ? output : cache + rows * cols;
+    const Index grain = std::max<Index>(1, 4096 / std::max<Index>(cols, 1));
+    
+    if (!training_) {
+        Vector scale_vector, shift_vector;
+        inference_affine(scale_vector, shift_vector);
+        const Scalar* scale = scale_vector.data();
+        const Scalar* shift = shift_vector.data();
+        utils::parallel_for(0, rows, grain, [&](Index r0, Index r1) {
+            for (Index r = r0; r < r1; ++r) {
+                const Scalar* x = input + r * cols;
+                Scalar* y = z + r * cols;
+                for (Index j = 0; j < cols; ++j) y[j] = x[j] * scale[j] + shift[j];
+            }
+        });
+    } else {
+        batch_statistics(input, rows, cols);
+        const Scalar* mean = batch_mean_.data();
+        const Scalar* inv_std = batch_inv_std_.data();
+        const Scalar* gamma = gamma_.data();
+        const Scalar* beta = beta_.data();
+        utils::parallel_for(0, rows, grain, [&](Index r0, Index r1) {
+            for (Index r = r0; r < r1; ++r) {
+                const Scalar* x = input + r * cols;
+                Scalar* x_hat = cache + r * cols;
+                Scalar* y = z + r * cols;
+                for (Index j = 0; j < cols; ++j) {
+                    x_hat[j] = (x[j] - mean[j]) * inv_std[j];
+                    y[j] = gamma[j] * x_hat[j] + beta[j];
+                }
+            }
+        });
+    }
+    
+    if (activation_ != ActivationType::LINEAR) activate_rows(z, output, rows, cols);
+}
+
+void BatchNormLayer::column_gradient_sums(const Scalar* gradient, Index rows, Index cols) {
+    // beta gradient = sum(dy), gamma gradient = sum(dy * x_hat), one pass over dy
+    const Index chunks = (rows + kNormChunkRows - 1) / kNormChunkRows;
+    partials_.resize(static_cast<size_t>(2 * chunks * cols));
+    
+    utils::parallel_for(0, chunks, 1, [&](Index c0, Index c1) {
+        for (Index c = c0; c < c1; ++c) {
+            Accumulator* dy_sum = partials_.data() + 2 * c * cols;
+            Accumulator* dy_x_hat_sum = dy_sum + cols;
+            std::fill(dy_sum, dy_sum + 2 * cols, 0.0);
+            const Index r1 = std::min(rows, (c + 1) * kNormChunkRows);
+            for (Index r = c * kNormChunkRows; r < r1; ++r) {
+                const Scalar* dy = gradient + r * cols;
+                const Scalar* x_hat = cache_rows_ + r * cols;
+                for (Index j = 0; j < cols; ++j) {
+                    dy_sum[j] += dy[j];
+                    dy_x_hat_sum[j] += static_cast<Accumulator>(dy[j]) * x_hat[j];
+                }
+            }
+        }
+    });
+    
+    for (Index j = 0; j < cols; ++j) {
+        Accumulator dy_sum = 0.0;
+        Accumulator dy_x_hat_sum = 0.0;
+        for (Index c = 0; c < chunks; ++c) {
+            dy_sum += partials_[static_cast<size_t>(2 * c * cols + j)];
+            dy_x_hat_sum += partials_[static_cast<size_t>((2 * c + 1) * cols + j)];
+        }
+        beta_gradients_[j] = static_cast<Scalar>(dy_sum);
+        gamma_gradients_[j] = static_cast<Scalar>(dy_x_hat_sum);
+    }
+}
+
+Matrix BatchNormLayer::backward(const Matrix& gradient) {
+    // The activation derivative is applied in place, so only then work on a copy
+    Matrix activated;
+    const Scalar* delta = gradient.data();
+    if (activation_ != ActivationType::LINEAR) {
+        activated = gradient;
+        activation_delta_rows(cache_rows_ + batch_rows_ * output_size_, activated.data(), batch_rows_, output_size_);
+        delta = activated.data();
+    }
+    Matrix input_gradient(gradient.rows(), gradient.cols());
+    normalization_backward(delta, input_gradient.data());
+    return input_gradient;
+}
+
+void BatchNormLayer::backward_rows(Scalar* gradient, Scalar* input_gradient) {
+    if (activation_ != ActivationType::LINEAR) {
+        activation_delta_rows(cache_rows_ + batch_rows_ * output_size_, gradient, batch_rows_, output_size_);
+    }
+    normalization_backward(gradient, input_gradient);
+}
+
+void BatchNormLayer::normalization_backward(const Scalar* delta, Scalar* input_gradient) {
+    const Index rows = batch_rows_;
+    const Index cols = output_size_;
+    const Index grain = std::max<Index>(1, 4096 / std::max<Index>(cols, 1));
+    
+    if (!training_) {
+        // Running statistics are constants here, so the layer is a per-feature scale
+        if (!input_gradient) return;
+        Vector scale_vector, shift_vector;
+        inference_affine(scale_vector, shift_vector);
+        const Scalar* scale = scale_vector.data();
+        utils::parallel_for(0, rows, grain, [&](Index r0, Index r1) {
+            for (Index r = r0; r < r1; ++r) {
+                const Scalar* dy = delta + r * cols;
+                Scalar* dx = input_gradient + r * cols;
+                for (Index j = 0; j < cols; ++j) dx[j] = dy[j] * scale[j];
+            }
+        });
+        return;
+    }
+    
+    // dx = gamma * inv_std / N * (N * dy - sum(dy) - x_hat * sum(dy * x_hat)), written
+    // straight into the input gradient from the two column sums
+    column_gradient_sums(delta, rows, cols);
+    if (!input_gradient) return;
+    const Scalar inv_n = Scalar(1) / static_cast<Scalar>(rows);
+    coefficients_.resize(static_cast<size_t>(3 * cols));
+    Scalar* coeff = coefficients_.data();
+    Scalar* mean_dy = coeff + cols;
+    Scalar* mean_dy_x_hat = mean_dy + cols;
+    for (Index j = 0; j < cols; ++j) {
+        coeff[j] = gamma_[j] * batch_inv_std_[j];
+        mean_dy[j] = beta_gradients_[j] * inv_n;
+        mean_dy_x_hat[j] = gamma_gradients_[j] * inv_n;
+    }
+    utils::parallel_for(0, rows, grain, [&](Index r0, Index r1) {
+        for (Index r = r0; r < r1; ++r) {
+            const Scalar* dy = delta + r * cols;
+            const Scalar* x_hat = cache_rows_ + r * cols;
+            Scalar* dx = input_gradient + r * cols;
+            for (Index j = 0; j < cols; ++j) {
+                dx[j] = coeff[j] * (dy[j] - mean_dy[j] - x_hat[j] * mean_dy_x_hat[j]);
+            }
+        }
+    });
+}
+
+void BatchNormLayer::collect_parameters(std::vector<ParameterView>& parameters) {
+    const size_t n = static_cast<size_t>(gamma_.size());
+    parameters.push_back({gamma_.data(), gamma_gradients_.data(), n, false});
+    parameters.push_back({beta_.data(), beta_gradients_.data(), n, false});
+}
+
+LayerConfig BatchNormLayer::config() const {
+    LayerConfig config = NeuralLayer::config();
+    config.options[0] = momentum_;
+    config.options[1] = epsilon_;
+    return config;
+}
+
+void BatchNormLayer::collect_state(std::vector<ParameterView>& state) {
+    collect_parameters(state);
+    const size_t n = static_cast<size_t>(gamma_.size());
+    state.push_back({running_mean_.data(), nullptr, n, false});
+    state.push_back({running_var_.data(), nullptr, n, false});
+}
+
+bool DenseLayer::fold_batch_norm(const BatchNormLayer& batch_norm) {
+    if (activation_ != ActivationType::LINEAR || batch_norm.get_input_size() != output_size_) {
+        return false;
+    }
+    // act(scale * (W x + b) + shift): row j of W and b_j scale by scale_j
+    dequantize();
+    Vector scale, shift;
+    batch_norm.inference_affine(scale, shift);
+    const Index cols = weights_.cols();
+    for (Index j = 0; j < weights_.rows(); ++j) {
+        Scalar* row = weights_.data() + j * cols;
+        for (Index k = 0; k < cols; ++k) row[k] *= scale[j];
+        biases_[j] = biases_[j] * scale[j] + shift[j];
+    }
+    activation_ = batch_norm.get_activation();
+    return true;
+}
+
+// SoftmaxCrossEntropyLayer implementation
+namespace {
+
+// Rows per loss chunk; chunk sums are added in order, so the loss is deterministic
+constexpr Index kLossChunkRows = 64;
+
+// One pass per row: gradient row = softmax(z) / N, then row_target(r, z, g, lse)
+// subtracts y / N and returns the row's loss
+template<typename RowTarget>
+double fused_cross_entropy(const Scalar* logits, Index rows, Index cols, Scalar* gradient,
+                           std::vector<Accumulator>& partials, RowTarget row_target) {
+    if (rows == 0 || cols == 0) return 0.0;
+    const Scalar inv_n = Scalar(1) / static_cast<Scalar>(rows);
+    const Index chunks = (rows + kLossChunkRows - 1) / kLossChunkRows;
+    partials.assign(static_cast<size_t>(chunks), 0.0);
+    
+    utils::parallel_for(0, chunks, 1, [&](Index c0, Index c1) {
+        for (Index c = c0; c < c1; ++c) {
+            Accumulator chunk_loss = 0.0;
+            const Index r1 = std::min(rows, (c + 1) * kLossChunkRows);
+            for (Index r = c * kLossChunkRows; r < r1; ++r) {
+                const Scalar* z = logits + r * cols;
+                Scalar* g = gradient + r * cols;
+                const Accumulator lse = softmax_row(z, g, cols, 1.0 / static_cast<Accumulator>(rows));
+                chunk_loss += row_target(r, z, g, lse, inv_n);
+            }
+            partials[static_cast<size_t>(c)] = chunk_loss;
+        }
+    });
+    
+    Accumulator total = 0.0;
+    for (Accumulator partial : partials) total += partial;
+    return total / static_cast<Accumulator>(rows);
+}
+
+} // namespace
+
+SoftmaxCrossEntropyLayer::SoftmaxCrossEntropyLayer(int classes)
+    : NeuralLayer(LayerType::ACTIVATION, classes, classes, ActivationType::SOFTMAX) {
+    weights_.resize(0, 0);
+    biases_.resize(0);
+    gradients_.resize(0, 0);
+    bias_gradients_.resize(0);
+}
+
+Matrix SoftmaxCrossEntropyLayer::forward(const Matrix& logits) {
+    linear_cache_ = logits;
+    return softmax(logits);
+}
+
+Matrix SoftmaxCrossEntropyLayer::backward(const Matrix& gradient) {
+    return activation_delta(gradient);
+}
+
+double SoftmaxCrossEntropyLayer::loss(const Matrix& logits, const Matrix& targets) {
+    if (logits.cols() != output_size_) {
+        std::cout << "❌ Cross-entropy expects " << output_size_ << " logits per row, got "
+                  << logits.cols() << std::endl;
+        logit_gradient_.resize(0, 0);
+        return 0.0;
+    }
+    logit_gradient_.resize(logits.rows(), logits.cols());
+    double loss = 0.0;
+    if (!loss_rows(logits.data(), logits.rows(), targets, logit_gradient_.data(), loss)) {
+        logit_gradient_.resize(0, 0);
+        return 0.0;
+    }
+    return loss;
+}
+
+bool SoftmaxCrossEntropyLayer::loss_rows(const Scalar* logits, Index rows, const Matrix& targets,
+                                         Scalar* gradient, double& loss) {
+    const Index cols = output_size_;
+    if (targets.rows() == rows && targets.cols() == 1 && cols > 1) {
+        // Class labels stored as values; checked before the pass so it cannot fail midway
+        for (Index r = 0; r < rows; ++r) {
+            const Scalar label = targets(r, 0);
+            if (!(label >= Scalar(0) && label < static_cast<Scalar>(cols))) {
+                std::cout << "❌ Cross-entropy needs one label in [0, " << cols << ") per row" << std::endl;
+                return false;
+            }
+        }
+        loss = fused_cross_entropy(logits, rows, cols, gradient, partials_,
+            [&](Index r, const Scalar* z, Scalar* g, Accumulator lse, Scalar inv_n) {
+                const Index label = static_cast<Index>(targets(r, 0));
+                g[label] -= inv_n;
+                return lse - static_cast<Accumulator>(z[label]);
+            });
+        return true;
+    }
+    if (targets.rows() != rows || targets.cols() != cols) {
+        std::cout << "❌ Cross-entropy targets are " << targets.rows() << "x" << targets.cols()
+                  << ", logits are " << rows << "x" << cols << std::endl;
+        return false;
+    }
+    const size_t width = static_cast<size_t>(cols);
+    loss = fused_cross_entropy(logits, rows, cols, gradient, partials_,
+        [&](Index r, const Scalar* z, Scalar* g, Accumulator lse, Scalar inv_n) {
+            // -sum y * log p = lse * sum y - sum y * z; gradient p / N - y / N
+            const Scalar* y = targets.data() + r * cols;
+            const Accumulator row_loss = lse * utils::simd::sum(y, width) - utils::simd::dot(y, z, width);
+            utils::simd::axpy(-inv_n, y, g, width);
+            return row_loss;
+        });
+    return true;
+}
+
+double SoftmaxCrossEntropyLayer::loss(const Matrix& logits, const std::vector<int>& labels) {
+    const Index cols = logits.cols();
+    bool valid = static_cast<Index>(labels.size()) == logits.rows();
+    for (size_t i = 0; valid && i < labels.size(); ++i) valid = labels[i] >= 0 && labels[i] < cols;
+    if (!valid) {
+        std::cout << "❌ Cross-entropy needs one label in [0, " << cols << ") per row" << std::endl;
+        logit_gradient_.resize(0, 0);
+        return 0.0;
+    }
+    logit_gradient_.resize(logits.rows(), cols);
+    return fused_cross_entropy(logits.data(), logits.rows(), cols, logit_gradient_.data(), partials_,
+        [&](Index r, const Scalar* z, Scalar* g, Accumulator lse, Scalar inv_n) {
+            const int label = labels[static_cast<size_t>(r)];
+            g[label] -= inv_n;
+            return lse - static_cast<Accumulator>(z[label]);
+        });
+}
+
+// ConvLayer implementation
+namespace {
+
+// Winograd F(2x2, 3x3) transforms (Lavin & Gray): U = G g G^T, V = B^T d B and
+// Y = A^T M A, written out per element so the channel loops vectorize
+inline void winograd_filter_transform(const Scalar g[9], Scalar u[16]) {
+    Scalar t[12];                   // G g, 4 x 3
+    for (int j = 0; j < 3; ++j) {
+        t[0 * 3 + j] = g[0 * 3 + j];
+        t[1 * 3 + j] = Scalar(0.5) * (g[0 * 3 + j] + g[1 * 3 + j] + g[2 * 3 + j]);
+        t[2 * 3 + j] = Scalar(0.5) * (g[0 * 3 + j] - g[1 * 3 + j] + g[2 * 3 + j]);
+        t[3 * 3 + j] = g[2 * 3 + j];
+    }
+    for (int i = 0; i < 4; ++i) {
+        u[i * 4 + 0] = t[i * 3 + 0];
+        u[i * 4 + 1] = Scalar(0.5) * (t[i * 3 + 0] + t[i * 3 + 1] + t[i * 3 + 2]);
+        u[i * 4 + 2] = Scalar(0.5) * (t[i * 3 + 0] - t[i * 3 + 1] + t[i * 3 + 2]);
+        u[i * 4 + 3] = t[i * 3 + 2];
+    }
+}
+
+} // namespace
+
+ConvLayer::ConvLayer(int in_channels, int out_channels, int input_h, int input_w,
+                     int kernel_h, int kernel_w, int stride, int padding, ActivationType activation)
+    : NeuralLayer(LayerType::CONVOLUTIONAL, 0, 0, activation),
+      in_channels_(in_channels), out_channels_(out_channels), input_h_(input_h), input_w_(input_w),
+      kernel_h_(kernel_h), kernel_w_(kernel_w), stride_(std::max(stride, 1)),
+      padding_h_(kernel_h > 1 ? std::max(padding, 0) : 0),
+      padding_w_(kernel_w > 1 ? std::max(padding, 0) : 0) {
+    const int span_h = input_h_ + 2 * padding_h_ - kernel_h_;
+    const int span_w = input_w_ + 2 * padding_w_ - kernel_w_;
+    output_h_ = span_h < 0 ? 0 : span_h / stride_ + 1;
+    output_w_ = span_w < 0 ? 0 : span_w / stride_ + 1;
+    
+    // The base class would size weights_ as output x input; a conv layer shares
+    // one small filter bank across all positions instead
+    input_size_ = input_h_ * input_w_ * in_channels_;
+    output_size_ = output_h_ * output_w_ * out_channels_;
+    weights_.resize(out_channels_, patch_size());
+    weights_.setZero();
+    biases_.resize(out_channels_);
+    biases_.setZero();
+    gradients_.resize(out_channels_, patch_size());
+    gradients_.setZero();
+    bias_gradients_.resize(out_channels_);
+    bias_gradients_.setZero();
+}
+
+std::unique_ptr<ConvLayer> ConvLayer::conv1d(int in_channels, int out_channels, int length, int kernel,
+                                             int stride, int padding, ActivationType activation) {
+    return std::make_unique<ConvLayer>(in_channels, out_channels, 1, length, 1, kernel,
+                                       stride, padding, activation);
+}
+
+Index ConvLayer::tile_pixels() const {
+    // ~32K column entries per tile: 256 KB of doubles
+    Index tile = std::max<Index>(16, std::min<Index>(512, 32768 / std::max<Index>(patch_size(), 1)));
+    return std::min(tile / 4 * 4, std::max<Index>(output_pixels(), 1));
+}
+
+void ConvLayer::im2col(const Scalar* sample, Index first_pixel, Index pixels, Scalar* columns) const {
+    const Index c = in_channels_;
+    const Index row_width = static_cast<Index>(kernel_w_) * c;
+    for (Index q = 0; q < pixels; ++q) {
+        const Index p = first_pixel + q;
+        const Index y0 = (p / output_w_) * stride_ - padding_h_;
+        const Index x0 = (p % output_w_) * stride_ - padding_w_;
+        // Kernel columns inside the image form one contiguous NHWC run per kernel row
+        const Index kw0 = std::max<Index>(0, -x0);
+        const Index kw1 = std::min<Index>(kernel_w_, input_w_ - x0);
+        Scalar* dst = columns + q * patch_size();
+        for (Index kh = 0; kh < kernel_h_; ++kh, dst += row_width) {
+            const Index y = y0 + kh;
+            if (y < 0 || y >= input_h_ || kw1 <= kw0) {
+                std::fill_n(dst, row_width, Scalar(0));
+                continue;
+            }
+            std::fill_n(dst, kw0 * c, Scalar(0));
+            std::copy_n(sample + (y * input_w_ + x0 + kw0) * c, (kw1 - kw0) * c, dst + kw0 * c);
+            std::fill_n(dst + kw1 * c, (kernel_w_ - kw1) * c, Scalar(0));
+        }
+    }
+}
+
+void ConvLayer::col2im_add(const Scalar* columns, Index first_pixel, Index pixels, Scalar* sample_gradient) const {
+    const Index c = in_channels_;
+    const Index row_width = static_cast<Index>(kernel_w_) * c;
+    for (Index q = 0; q < pixels; ++q) {
+        const Index p = first_pixel + q;
+        const Index y0 = (p / output_w_) * stride_ - padding_h_;
+        const Index x0 = (p % output_w_) * stride_ - padding_w_;
+        const Index kw0 = std::max<Index>(0, -x0);
+        const Index kw1 = std::min<Index>(kernel_w_, input_w_ - x0);
+        const Scalar* src = columns + q * patch_size();
+        for (Index kh = 0; kh < kernel_h_; ++kh, src += row_width) {
+            const Index y = y0 + kh;
+            if (y < 0 || y >= input_h_ || kw1 <= kw0) continue;
+            Scalar* dst = sample_gradient + (y * input_w_ + x0 + kw0) * c;
+            const Scalar* run = src + kw0 * c;
+            for (Index i = 0; i < (kw1 - kw0) * c; ++i) dst[i] += run[i];
+        }
+    }
+}
+
+void ConvLayer::forward_im2col(const Matrix& input, Matrix& output) const {
+    const Index n = input.rows();
+    const Index k = patch_size();
+    const Index pixels_total = output_pixels();
+    const Index tile = tile_pixels();
+    const Index tiles = (pixels_total + tile - 1) / tile;
+    
+    // Tasks are (sample, pixel tile, output-channel block). Channels are only split
+    // when there are too few tiles to keep the pool busy, since each block redoes
+    // the tile's im2col
+    const Index threads = static_cast<Index>(utils::max_threads());
+    Index cout_blocks = 1;
+    if (n * tiles < 4 * threads) {
+        cout_blocks = std::min<Index>((out_channels_ + 15) / 16, (4 * threads + n * tiles - 1) / (n * tiles));
+        cout_blocks = std::max<Index>(cout_blocks, 1);
+    }
+    const Index cout_block = (out_channels_ + cout_blocks - 1) / cout_blocks;
+    
+    utils::parallel_for(0, n * tiles * cout_blocks, 1, [&](Index t0, Index t1) {
+        // Per-thread column buffer, kept across tiles, batches and calls
+        static thread_local std::vector<Scalar> columns;
+        columns.resize(std::max(columns.size(), static_cast<size_t>(tile * k)));
+        for (Index t = t0; t < t1; ++t) {
+            const Index sample = t / (tiles * cout_blocks);
+            const Index tile_index = (t / cout_blocks) % tiles;
+            const Index co = (t % cout_blocks) * cout_block;
+            const Index width = std::min(cout_block, static_cast<Index>(out_channels_) - co);
+            if (width <= 0) continue;
+            const Index p0 = tile_index * tile;
+            const Index pixels = std::min(tile, pixels_total - p0);
+            
+            im2col(input.data() + sample * input_size_, p0, pixels, columns.data());
+            Scalar* out = output.data() + sample * output_size_ + p0 * out_channels_ + co;
+            for (Index q = 0; q < pixels; ++q) {
+                std::copy_n(biases_.data() + co, width, out + q * out_channels_);
+            }
+            // columns (pixels x k) * W[co:co+width]^T, accumulated onto the bias
+            Eigen::internal::gemm_kernel(false, true, pixels, width, k, Scalar(1), columns.data(), k,
+                                         weights_.data() + co * k, k, out, static_cast<Index>(out_channels_));
+        }
+    });
+}
+
+void ConvLayer::forward_winograd(const Matrix& input, Matrix& output) {
+    const Index n = input.rows();
+    const Index c = in_channels_;
+    const Index f = out_channels_;
+    
+    // U = G g G^T for every (filter, channel), stored as 16 c x f matrices
+    winograd_filters_.resize(16 * c, f);
+    utils::parallel_for(0, f, 16, [&](Index f0, Index f1) {
+        Scalar g[9], u[16];
+        for (Index o = f0; o < f1; ++o) {
+            for (Index ch = 0; ch < c; ++ch) {
+                for (int k = 0; k < 9; ++k) g[k] = weights_(o, k * c + ch);
+                winograd_filter_transform(g, u);
+                for (int xi = 0; xi < 16; ++xi) winograd_filters_(xi * c + ch, o) = u[xi];
+            }
+        }
+    });
+    
+    const Index tiles_w = (output_w_ + 1) / 2;
+    const Index tiles = ((output_h_ + 1) / 2) * tiles_w;
+    const Index block = std::max<Index>(4, std::min<Index>(64, 8192 / std::max<Index>(c + f, 1)));
+    const Index blocks = (tiles + block - 1) / block;
+    const Scalar* filters = winograd_filters_.data();
+    
+    utils::parallel_for(0, n * blocks, 1, [&](Index t0, Index t1) {
+        static thread_local std::vector<Scalar> v, m, zeros;
+        v.resize(std::max(v.size(), static_cast<size_t>(16 * block * c)));
+        m.resize(std::max(m.size(), static_cast<size_t>(16 * block * f)));
+        zeros.assign(static_cast<size_t>(c), Scalar(0));
         
-        // Normalize
-        for (int i = 0; i < x.rows(); ++i) {
-            result(i, j) /= sum;
+        for (Index t = t0; t < t1; ++t) {
+            const Index sample = t / blocks;
+            const Index first = (t % blocks) * block;
+            const Index count = std::min(block, tiles - first);
+            const Scalar* image = input.data() + sample * input_size_;
+            
+            // V = B^T d B for each 4x4 input tile; out-of-image pixels read a zero row
+            for (Index i = 0; i < count; ++i) {
+                const Index y0 = ((first + i) / tiles_w) * 2 - padding_h_;
+                const Index x0 = ((first + i) % tiles_w) * 2 - padding_w_;
+                const Scalar* px[16];
+                for (int dy = 0; dy < 4; ++dy) {
+                    for (int dx = 0; dx < 4; ++dx) {
+                        const Index y = y0 + dy, x = x0 + dx;
+                        const bool inside = y >= 0 && y < input_h_ && x >= 0 && x < input_w_;
+                        px[dy * 4 + dx] = inside ? image + (y * input_w_ + x) * c : zeros.data();
+                    }
+                }
+                Scalar* dst = v.data() + i * c;
+                const Index stride = block * c;
+                for (Index ch = 0; ch < c; ++ch) {
+                    Scalar d[16], tmp[16];
+                    for (int k = 0; k < 16; ++k) d[k] = px[k][ch];
+                    for (int col = 0; col < 4; ++col) {
+                        tmp[0 * 4 + col] = d[0 * 4 + col] - d[2 * 4 + col];
+                        tmp[1 * 4 + col] = d[1 * 4 + col] + d[2 * 4 + col];
+                        tmp[2 * 4 + col] = d[2 * 4 + col] - d[1 * 4 + col];
+                        tmp[3 * 4 + col] = d[1 * 4 + col] - d[3 * 4 + col];
+                    }
+                    for (int row = 0; row < 4; ++row) {
+                        const Scalar* r = tmp + row * 4;
+                        dst[(row * 4 + 0) * stride + ch] = r[0] - r[2];
+                        dst[(row * 4 + 1) * stride + ch] = r[1] + r[2];
+                        dst[(row * 4 + 2) * stride + ch] = r[2] - r[1];
+                        dst[(row * 4 + 3) * stride + ch] = r[1] - r[3];
+                    }
+                }
+            }
+            
+            // Sixteen independent (count x c) * (c x f) products
+            std::fill_n(m.data(), 16 * block * f, Scalar(0));
+            for (Index xi = 0; xi < 16; ++xi) {
+                Eigen::internal::gemm_kernel(false, false, count, f, c, Scalar(1), v.data() + xi * block * c, c,
+                                             filters + xi * c * f, f, m.data() + xi * block * f, f);
+            }
+            
+            // Y = A^T M A plus bias, clipped at the bottom/right edge for odd sizes
+            Scalar* out = output.data() + sample * output_size_;
+            for (Index i = 0; i < count; ++i) {
+                const Index oy = ((first + i) / tiles_w) * 2;
+                const Index ox = ((first + i) % tiles_w) * 2;
+                const bool has_y1 = oy + 1 < output_h_, has_x1 = ox + 1 < output_w_;
+                Scalar* y00 = out + (oy * output_w_ + ox) * f;
+                Scalar* y01 = y00 + f;
+                Scalar* y10 = y00 + output_w_ * f;
+                Scalar* y11 = y10 + f;
+                const Scalar* src = m.data() + i * f;
+                const Index stride = block * f;
+                for (Index o = 0; o < f; ++o) {
+                    Scalar e[16];
+                    for (int k = 0; k < 16; ++k) e[k] = src[k * stride + o];
+                    Scalar t0[4], t1[4];
+                    for (int col = 0; col < 4; ++col) {
+                        t0[col] = e[0 * 4 + col] + e[1 * 4 + col] + e[2 * 4 + col];
+                        t1[col] = e[1 * 4 + col] - e[2 * 4 + col] - e[3 * 4 + col];
+                    }
+                    const Scalar b = biases_[o];
+                    y00[o] = b + t0[0] + t0[1] + t0[2];
+                    if (has_x1) y01[o] = b + t0[1] - t0[2] - t0[3];
+                    if (has_y1) {
+                        y10[o] = b + t1[0] + t1[1] + t1[2];
+                        if (has_x1) y11[o] = b + t1[1] - t1[2] - t1[3];
+                    }
+                }
+            }
         }
+    });
+}
+
+Matrix ConvLayer::forward(const Matrix& input) {
+    if (input.cols() != input_size_) {
+        std::cout << "❌ ConvLayer expects " << input_size_ << " values per sample (NHWC "
+                  << input_h_ << "x" << input_w_ << "x" << in_channels_ << "), got " << input.cols() << std::endl;
+        return Matrix();
     }
-    return result;
+    input_cache_ = input;
+    
+    Matrix linear_output(input.rows(), output_size_);
+    if (use_winograd_ && winograd_applicable()) {
+        forward_winograd(input, linear_output);
+    } else {
+        forward_im2col(input, linear_output);
+    }
+    
+    linear_cache_ = linear_output;
+    activations_ = activate(linear_output);
+    return activations_;
 }
 
-Eigen::MatrixXd NeuralLayer::leaky_relu(const Eigen::MatrixXd& x, double alpha) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            result(i, j) = (x(i, j) > 0) ? x(i, j) : alpha * x(i, j);
+Matrix ConvLayer::backward(const Matrix& gradient) {
+    Matrix delta = activation_delta(gradient);
+    const Index n = delta.rows();
+    const Index k = patch_size();
+    const Index pixels_total = output_pixels();
+    const Index tile = tile_pixels();
+    const Index cout = out_channels_;
+    
+    // Input gradient: delta tile * W scattered back through col2im. Samples own
+    // disjoint rows of the result, so they run in parallel without reduction
+    Matrix input_gradient(n, input_size_);
+    input_gradient.setZero();
+    utils::parallel_for(0, n, 1, [&](Index s0, Index s1) {
+        static thread_local std::vector<Scalar> columns;
+        columns.resize(std::max(columns.size(), static_cast<size_t>(tile * k)));
+        for (Index s = s0; s < s1; ++s) {
+            for (Index p0 = 0; p0 < pixels_total; p0 += tile) {
+                const Index pixels = std::min(tile, pixels_total - p0);
+                std::fill_n(columns.data(), pixels * k, Scalar(0));
+                Eigen::internal::gemm_kernel(false, false, pixels, k, cout, Scalar(1),
+                                             delta.data() + s * output_size_ + p0 * cout, cout,
+                                             weights_.data(), k, columns.data(), k);
+                col2im_add(columns.data(), p0, pixels, input_gradient.data() + s * input_size_);
+            }
+        }
+    });
+    
+    // Weight gradient: sum over tiles of delta_tile^T * columns (TN gemm), split by
+    // the gemm over output channels; tiles are visited in a fixed order
+    gradients_.resize(cout, k);
+    gradients_.setZero();
+    std::vector<Accumulator> bias_sum(static_cast<size_t>(cout), 0.0);
+    std::vector<Scalar> columns(static_cast<size_t>(tile * k));
+    for (Index s = 0; s < n; ++s) {
+        for (Index p0 = 0; p0 < pixels_total; p0 += tile) {
+            const Index pixels = std::min(tile, pixels_total - p0);
+            const Scalar* d = delta.data() + s * output_size_ + p0 * cout;
+            im2col(input_cache_.data() + s * input_size_, p0, pixels, columns.data());
+            Eigen::internal::gemm_kernel(true, false, cout, k, pixels, Scalar(1), d, cout,
+                                         columns.data(), k, gradients_.data(), k);
+            for (Index q = 0; q < pixels; ++q) {
+                for (Index o = 0; o < cout; ++o) bias_sum[o] += d[q * cout + o];
+            }
         }
     }
-    return result;
+    bias_gradients_.resize(cout);
+    for (Index o = 0; o < cout; ++o) bias_gradients_[o] = static_cast<Scalar>(bias_sum[o]);
+    
+    return input_gradient;
+}
+
+void ConvLayer::initialize_weights(double std_dev) {
+    // Xavier/Glorot over the receptive field, as for DenseLayer
+    const double fan_in = static_cast<double>(patch_size());
+    const double fan_out = static_cast<double>(out_channels_) * kernel_h_ * kernel_w_;
+    const double limit = std_dev * std::sqrt(6.0 / (fan_in + fan_out));
+    utils::RandomStream rng = utils::global_stream();
+    rng.fill_uniform(weights_.data(), static_cast<size_t>(weights_.size()),
+                     static_cast<Scalar>(-limit), static_cast<Scalar>(limit));
+    rng.fill_uniform(biases_.data(), static_cast<size_t>(biases_.size()),
+                     static_cast<Scalar>(-0.1 * limit), static_cast<Scalar>(0.1 * limit));
+}
+
+LayerConfig ConvLayer::config() const {
+    LayerConfig config = NeuralLayer::config();
+    const int dims[8] = {in_channels_, out_channels_, input_h_, input_w_, kernel_h_, kernel_w_, stride_,
+                         std::max(padding_h_, padding_w_)};
+    std::copy(dims, dims + 8, config.dims);
+    config.options[0] = use_winograd_ ? 1.0 : 0.0;
+    return config;
+}
+
+// Recurrent layer implementation
+namespace {
+
+inline Scalar sigmoid_scalar(Scalar x) {
+    return Scalar(1) / (Scalar(1) + std::exp(-x));
 }
 
-Eigen::MatrixXd NeuralLayer::elu(const Eigen::MatrixXd& x, double alpha) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            result(i, j) = (x(i, j) > 0) ? x(i, j) : alpha * (std::exp(x(i, j)) - 1);
+// Only resizes when the shape changes, so steady-state batches reuse the buffers
+inline void ensure_shape(Matrix& m, Index rows, Index cols) {
+    if (m.rows() != rows || m.cols() != cols) m.resize(rows, cols);
+}
+
+// Column sums of a row-major rows x cols block (per-step gate gradients viewed as
+// (N*T) x gates*H)
+void column_sums(const Scalar* data, Index rows, Index cols, Vector& out) {
+    std::vector<Accumulator> sums(static_cast<size_t>(cols), 0.0);
+    for (Index i = 0; i < rows; ++i) {
+        const Scalar* row = data + i * cols;
+        for (Index j = 0; j < cols; ++j) sums[j] += row[j];
+    }
+    out.resize(cols);
+    for (Index j = 0; j < cols; ++j) out[j] = static_cast<Scalar>(sums[j]);
+}
+
+} // namespace
+
+RecurrentLayer::RecurrentLayer(LayerType type, int input_features, int hidden_size, int sequence_length,
+                               int gates, bool return_sequences)
+    : NeuralLayer(type, 0, 0, ActivationType::TANH),
+      input_features_(input_features), hidden_size_(hidden_size),
+      sequence_length_(std::max(sequence_length, 1)), gates_(gates), return_sequences_(return_sequences) {
+    input_size_ = sequence_length_ * input_features_;
+    output_size_ = return_sequences_ ? sequence_length_ * hidden_size_ : hidden_size_;
+    weights_.resize(gate_width(), input_features_);
+    weights_.setZero();
+    recurrent_weights_.resize(gate_width(), hidden_size_);
+    recurrent_weights_.setZero();
+    biases_.resize(gate_width());
+    biases_.setZero();
+    gradients_.resize(gate_width(), input_features_);
+    gradients_.setZero();
+    recurrent_gradients_.resize(gate_width(), hidden_size_);
+    recurrent_gradients_.setZero();
+    bias_gradients_.resize(gate_width());
+    bias_gradients_.setZero();
+}
+
+void RecurrentLayer::project_inputs(const Matrix& input) {
+    const Index n = input.rows();
+    const Index steps = sequence_length_;
+    const Index g = gate_width();
+    const Index h = hidden_size_;
+    input_cache_ = input;
+    ensure_shape(gate_cache_, n, steps * g);
+    ensure_shape(state_cache_, n, (steps + 1) * h);
+    ensure_shape(hidden_state_, n, h);
+    
+    // Rows of the input are (sample, step) pairs once viewed as (N*T) x features
+    for (Index r = 0; r < n * steps; ++r) {
+        std::copy_n(biases_.data(), g, gate_cache_.data() + r * g);
+    }
+    Eigen::internal::gemm_kernel(false, true, n * steps, g, static_cast<Index>(input_features_), Scalar(1),
+                                 input.data(), static_cast<Index>(input_features_),
+                                 weights_.data(), static_cast<Index>(input_features_), gate_cache_.data(), g);
+    
+    for (Index s = 0; s < n; ++s) std::fill_n(state_cache_.data() + s * (steps + 1) * h, h, Scalar(0));
+    hidden_state_.setZero();
+}
+
+Matrix RecurrentLayer::collect_output() const {
+    const Index n = state_cache_.rows();
+    const Index steps = sequence_length_;
+    const Index h = hidden_size_;
+    Matrix output(n, output_size_);
+    for (Index s = 0; s < n; ++s) {
+        const Scalar* states = state_cache_.data() + s * (steps + 1) * h;
+        if (return_sequences_) {
+            std::copy_n(states + h, steps * h, output.data() + s * output_size_);
+        } else {
+            std::copy_n(states + steps * h, h, output.data() + s * output_size_);
         }
     }
-    return result;
+    return output;
 }
 
-// Activation derivatives
-Eigen::MatrixXd NeuralLayer::relu_derivative(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            result(i, j) = (x(i, j) > 0) ? 1.0 : 0.0;
+Matrix RecurrentLayer::sequence_gradient(const Matrix& gradient) const {
+    if (return_sequences_) return gradient;
+    const Index steps = sequence_length_;
+    const Index h = hidden_size_;
+    Matrix full(gradient.rows(), steps * h);
+    full.setZero();
+    for (Index s = 0; s < gradient.rows(); ++s) {
+        std::copy_n(gradient.data() + s * h, h, full.data() + s * steps * h + (steps - 1) * h);
+    }
+    return full;
+}
+
+Matrix RecurrentLayer::finish_backward(const Matrix& dx, const Matrix& dh) {
+    const Index n = input_cache_.rows();
+    const Index steps = sequence_length_;
+    const Index g = gate_width();
+    const Index h = hidden_size_;
+    const Index d = input_features_;
+    
+    // Input weights and input gradient: one gemm each over all (sample, step) rows
+    gradients_.resize(g, d);
+    gradients_.setZero();
+    Eigen::internal::gemm_kernel(true, false, g, d, n * steps, Scalar(1), dx.data(), g,
+                                 input_cache_.data(), d, gradients_.data(), d);
+    Matrix input_gradient(n, steps * d);
+    input_gradient.setZero();
+    Eigen::internal::gemm_kernel(false, false, n * steps, d, g, Scalar(1), dx.data(), g,
+                                 weights_.data(), d, input_gradient.data(), d);
+    
+    // Recurrent weights pair step t with h_{t-1}: per sample, the first T states
+    recurrent_gradients_.resize(g, h);
+    recurrent_gradients_.setZero();
+    for (Index s = 0; s < n; ++s) {
+        Eigen::internal::gemm_kernel(true, false, g, h, steps, Scalar(1), dh.data() + s * steps * g, g,
+                                     state_cache_.data() + s * (steps + 1) * h, h, recurrent_gradients_.data(), h);
+    }
+    
+    column_sums(dx.data(), n * steps, g, bias_gradients_);
+    return input_gradient;
+}
+
+void RecurrentLayer::initialize_weights(double std_dev) {
+    // Xavier/Glorot per gate block, as for DenseLayer; biases start at zero
+    const double input_limit = std_dev * std::sqrt(6.0 / (input_features_ + hidden_size_));
+    const double recurrent_limit = std_dev * std::sqrt(3.0 / hidden_size_);
+    utils::RandomStream rng = utils::global_stream();
+    rng.fill_uniform(weights_.data(), static_cast<size_t>(weights_.size()),
+                     static_cast<Scalar>(-input_limit), static_cast<Scalar>(input_limit));
+    rng.fill_uniform(recurrent_weights_.data(), static_cast<size_t>(recurrent_weights_.size()),
+                     static_cast<Scalar>(-recurrent_limit), static_cast<Scalar>(recurrent_limit));
+    biases_.setZero();
+}
+
+void RecurrentLayer::collect_parameters(std::vector<ParameterView>& parameters) {
+    NeuralLayer::collect_parameters(parameters);
+    parameters.push_back({recurrent_weights_.data(), recurrent_gradients_.data(),
+                          static_cast<size_t>(recurrent_weights_.size()), true});
+}
+
+LayerConfig RecurrentLayer::config() const {
+    LayerConfig config = NeuralLayer::config();
+    const int dims[5] = {input_features_, hidden_size_, sequence_length_, return_sequences_ ? 1 : 0,
+                         truncate_steps_};
+    std::copy(dims, dims + 5, config.dims);
+    return config;
+}
+
+// LSTMLayer implementation
+LSTMLayer::LSTMLayer(int input_features, int hidden_size, int sequence_length, bool return_sequences)
+    : RecurrentLayer(LayerType::LSTM, input_features, hidden_size, sequence_length, 4, return_sequences) {
+}
+
+Matrix LSTMLayer::forward(const Matrix& input) {
+    if (input.cols() != input_size_) {
+        std::cout << "❌ LSTMLayer expects " << input_size_ << " values per sequence ("
+                  << sequence_length_ << " steps x " << input_features_ << "), got " << input.cols() << std::endl;
+        return Matrix();
+    }
+    project_inputs(input);
+    
+    const Index n = input.rows();
+    const Index steps = sequence_length_;
+    const Index h = hidden_size_;
+    const Index g = gate_width();
+    ensure_shape(cell_cache_, n, (steps + 1) * h);
+    ensure_shape(cell_state_, n, h);
+    cell_state_.setZero();
+    for (Index s = 0; s < n; ++s) std::fill_n(cell_cache_.data() + s * (steps + 1) * h, h, Scalar(0));
+    
+    const Index grain = std::max<Index>(1, 4096 / g);
+    for (Index t = 0; t < steps; ++t) {
+        Scalar* step_gates = gate_cache_.data() + t * g;
+        // h_{t-1} W_h^T onto the precomputed input projection (h_0 = 0 adds nothing)
+        if (t > 0) {
+            Eigen::internal::gemm_kernel(false, true, n, g, h, Scalar(1), hidden_state_.data(), h,
+                                         recurrent_weights_.data(), h, step_gates, steps * g);
+        }
+        // All four gates and the state update in one pass; activations overwrite
+        // the pre-activations in place for the backward pass
+        utils::parallel_for(0, n, grain, [&](Index r0, Index r1) {
+            for (Index r = r0; r < r1; ++r) {
+                Scalar* a = step_gates + r * steps * g;
+                Scalar* hr = hidden_state_.data() + r * h;
+                Scalar* cr = cell_state_.data() + r * h;
+                Scalar* h_out = state_cache_.data() + r * (steps + 1) * h + (t + 1) * h;
+                Scalar* c_out = cell_cache_.data() + r * (steps + 1) * h + (t + 1) * h;
+                for (Index j = 0; j < h; ++j) {
+                    const Scalar i = sigmoid_scalar(a[j]);
+                    const Scalar f = sigmoid_scalar(a[h + j]);
+                    const Scalar cand = std::tanh(a[2 * h + j]);
+                    const Scalar o = sigmoid_scalar(a[3 * h + j]);
+                    a[j] = i;
+                    a[h + j] = f;
+                    a[2 * h + j] = cand;
+                    a[3 * h + j] = o;
+                    cr[j] = f * cr[j] + i * cand;
+                    hr[j] = o * std::tanh(cr[j]);
+                    h_out[j] = hr[j];
+                    c_out[j] = cr[j];
+                }
+            }
+        });
+    }
+    
+    activations_ = collect_output();
+    return activations_;
+}
+
+Matrix LSTMLayer::backward(const Matrix& gradient) {
+    const Matrix dy = sequence_gradient(gradient);
+    const Index n = dy.rows();
+    const Index steps = sequence_length_;
+    const Index h = hidden_size_;
+    const Index g = gate_width();
+    ensure_shape(gate_gradients_, n, steps * g);
+    ensure_shape(hidden_gradient_, n, h);
+    ensure_shape(cell_gradient_, n, h);
+    hidden_gradient_.setZero();
+    cell_gradient_.setZero();
+    
+    const Index grain = std::max<Index>(1, 4096 / g);
+    for (Index t = steps - 1; t >= 0; --t) {
+        utils::parallel_for(0, n, grain, [&](Index r0, Index r1) {
+            for (Index r = r0; r < r1; ++r) {
+                const Scalar* a = gate_cache_.data() + r * steps * g + t * g;
+                const Scalar* c = cell_cache_.data() + r * (steps + 1) * h + (t + 1) * h;
+                const Scalar* c_prev = c - h;
+                const Scalar* dy_t = dy.data() + r * steps * h + t * h;
+                const Scalar* dh = hidden_gradient_.data() + r * h;
+                Scalar* dc = cell_gradient_.data() + r * h;
+                Scalar* d = gate_gradients_.data() + r * steps * g + t * g;
+                for (Index j = 0; j < h; ++j) {
+                    const Scalar i = a[j], f = a[h + j], cand = a[2 * h + j], o = a[3 * h + j];
+                    const Scalar dh_j = dy_t[j] + dh[j];
+                    const Scalar tc = std::tanh(c[j]);
+                    const Scalar dc_j = dc[j] + dh_j * o * (Scalar(1) - tc * tc);
+                    d[j] = dc_j * cand * i * (Scalar(1) - i);
+                    d[h + j] = dc_j * c_prev[j] * f * (Scalar(1) - f);
+                    d[2 * h + j] = dc_j * i * (Scalar(1) - cand * cand);
+                    d[3 * h + j] = dh_j * tc * o * (Scalar(1) - o);
+                    dc[j] = dc_j * f;
+                }
+            }
+        });
+        
+        // dh_{t-1} = d_t W_h; a truncation boundary stops both carried gradients
+        hidden_gradient_.setZero();
+        if (truncate_after(t)) {
+            cell_gradient_.setZero();
+        } else if (t > 0) {
+            Eigen::internal::gemm_kernel(false, false, n, h, g, Scalar(1), gate_gradients_.data() + t * g, steps * g,
+                                         recurrent_weights_.data(), h, hidden_gradient_.data(), h);
         }
     }
-    return result;
+    
+    return finish_backward(gate_gradients_, gate_gradients_);
+}
+
+void LSTMLayer::initialize_weights(double std_dev) {
+    RecurrentLayer::initialize_weights(std_dev);
+    // Forget gate bias of 1 so early training does not wipe the cell state
+    for (Index j = 0; j < hidden_size_; ++j) biases_[hidden_size_ + j] = Scalar(1);
 }
 
-Eigen::MatrixXd NeuralLayer::sigmoid_derivative(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double sigmoid_val = 1.0 / (1.0 + std::exp(-x(i, j)));
-            result(i, j) = sigmoid_val * (1.0 - sigmoid_val);
+// GRULayer implementation
+GRULayer::GRULayer(int input_features, int hidden_size, int sequence_length, bool return_sequences)
+    : RecurrentLayer(LayerType::GRU, input_features, hidden_size, sequence_length, 3, return_sequences) {
+    recurrent_biases_.resize(gate_width());
+    recurrent_biases_.setZero();
+    recurrent_bias_gradients_.resize(gate_width());
+    recurrent_bias_gradients_.setZero();
+}
+
+Matrix GRULayer::forward(const Matrix& input) {
+    if (input.cols() != input_size_) {
+        std::cout << "❌ GRULayer expects " << input_size_ << " values per sequence ("
+                  << sequence_length_ << " steps x " << input_features_ << "), got " << input.cols() << std::endl;
+        return Matrix();
+    }
+    project_inputs(input);
+    
+    const Index n = input.rows();
+    const Index steps = sequence_length_;
+    const Index h = hidden_size_;
+    const Index g = gate_width();
+    ensure_shape(recurrent_cache_, n, steps * h);
+    ensure_shape(recurrent_projection_, n, g);
+    
+    const Index grain = std::max<Index>(1, 4096 / g);
+    for (Index t = 0; t < steps; ++t) {
+        // h_{t-1} W_h^T + b_h, kept apart from the input side because r scales its n part
+        for (Index r = 0; r < n; ++r) std::copy_n(recurrent_biases_.data(), g, recurrent_projection_.data() + r * g);
+        if (t > 0) {
+            Eigen::internal::gemm_kernel(false, true, n, g, h, Scalar(1), hidden_state_.data(), h,
+                                         recurrent_weights_.data(), h, recurrent_projection_.data(), g);
         }
+        utils::parallel_for(0, n, grain, [&](Index r0, Index r1) {
+            for (Index r = r0; r < r1; ++r) {
+                Scalar* a = gate_cache_.data() + r * steps * g + t * g;
+                const Scalar* hp = recurrent_projection_.data() + r * g;
+                Scalar* hr = hidden_state_.data() + r * h;
+                Scalar* h_out = state_cache_.data() + r * (steps + 1) * h + (t + 1) * h;
+                Scalar* rec = recurrent_cache_.data() + r * steps * h + t * h;
+                for (Index j = 0; j < h; ++j) {
+                    const Scalar reset = sigmoid_scalar(a[j] + hp[j]);
+                    const Scalar update = sigmoid_scalar(a[h + j] + hp[h + j]);
+                    const Scalar cand = std::tanh(a[2 * h + j] + reset * hp[2 * h + j]);
+                    a[j] = reset;
+                    a[h + j] = update;
+                    a[2 * h + j] = cand;
+                    rec[j] = hp[2 * h + j];
+                    hr[j] = (Scalar(1) - update) * cand + update * hr[j];
+                    h_out[j] = hr[j];
+                }
+            }
+        });
     }
-    return result;
+    
+    activations_ = collect_output();
+    return activations_;
+}
+
+Matrix GRULayer::backward(const Matrix& gradient) {
+    const Matrix dy = sequence_gradient(gradient);
+    const Index n = dy.rows();
+    const Index steps = sequence_length_;
+    const Index h = hidden_size_;
+    const Index g = gate_width();
+    ensure_shape(gate_gradients_, n, steps * g);
+    ensure_shape(recurrent_gate_gradients_, n, steps * g);
+    ensure_shape(hidden_gradient_, n, h);
+    hidden_gradient_.setZero();
+    
+    const Index grain = std::max<Index>(1, 4096 / g);
+    for (Index t = steps - 1; t >= 0; --t) {
+        utils::parallel_for(0, n, grain, [&](Index r0, Index r1) {
+            for (Index r = r0; r < r1; ++r) {
+                const Scalar* a = gate_cache_.data() + r * steps * g + t * g;
+                const Scalar* h_prev = state_cache_.data() + r * (steps + 1) * h + t * h;
+                const Scalar* rec = recurrent_cache_.data() + r * steps * h + t * h;
+                const Scalar* dy_t = dy.data() + r * steps * h + t * h;
+                Scalar* dh = hidden_gradient_.data() + r * h;
+                Scalar* dx = gate_gradients_.data() + r * steps * g + t * g;
+                Scalar* dr = recurrent_gate_gradients_.data() + r * steps * g + t * g;
+                for (Index j = 0; j < h; ++j) {
+                    const Scalar reset = a[j], update = a[h + j], cand = a[2 * h + j];
+                    const Scalar dh_j = dy_t[j] + dh[j];
+                    const Scalar d_cand = dh_j * (Scalar(1) - update) * (Scalar(1) - cand * cand);
+                    const Scalar d_reset = d_cand * rec[j] * reset * (Scalar(1) - reset);
+                    const Scalar d_update = dh_j * (h_prev[j] - cand) * update * (Scalar(1) - update);
+                    dx[j] = d_reset;
+                    dx[h + j] = d_update;
+                    dx[2 * h + j] = d_cand;
+                    dr[j] = d_reset;
+                    dr[h + j] = d_update;
+                    dr[2 * h + j] = d_cand * reset;
+                    dh[j] = dh_j * update;      // Direct path; the gemm below adds the gated one
+                }
+            }
+        });
+        
+        if (truncate_after(t)) {
+            hidden_gradient_.setZero();
+        } else if (t > 0) {
+            Eigen::internal::gemm_kernel(false, false, n, h, g, Scalar(1),
+                                         recurrent_gate_gradients_.data() + t * g, steps * g,
+                                         recurrent_weights_.data(), h, hidden_gradient_.data(), h);
+        }
+    }
+    
+    Matrix input_gradient = finish_backward(gate_gradients_, recurrent_gate_gradients_);
+    column_sums(recurrent_gate_gradients_.data(), n * steps, g, recurrent_bias_gradients_);
+    return input_gradient;
+}
+
+void GRULayer::initialize_weights(double std_dev) {
+    RecurrentLayer::initialize_weights(std_dev);
+    recurrent_biases_.setZero();
+}
+
+void GRULayer::collect_parameters(std::vector<ParameterView>& parameters) {
+    RecurrentLayer::collect_parameters(parameters);
+    parameters.push_back({recurrent_biases_.data(), recurrent_bias_gradients_.data(),
+                          static_cast<size_t>(recurrent_biases_.size()), false});
+}
+
+// NeuralNetwork implementation
+NeuralNetwork::NeuralNetwork(double learning_rate, int batch_size)
+    : learning_rate_(learning_rate), batch_size_(batch_size), epochs_(100),
+      rng_(utils::global_stream()), optimizer_(OptimizerType::SGD, learning_rate) {
+    set_loss_function("mse");
+}
+
+void NeuralNetwork::add_layer(std::unique_ptr<NeuralLayer> layer) {
+    // Dropout straight after a dense layer runs inside that layer's output pass
+    if (layer->get_type() == LayerType::DROPOUT && !layers_.empty()) {
+        auto* dense = dynamic_cast<DenseLayer*>(layers_.back().get());
+        if (dense) {
+            auto* dropout = static_cast<DropoutLayer*>(layer.get());
+            dense->fuse_dropout(dropout);
+            dropout->set_fused(true);
+        }
+    }
+    layer->set_training(training_);
+    layers_.push_back(std::move(layer));
+    planned_rows_ = 0;
+}
+
+void NeuralNetwork::set_training(bool training) {
+    training_ = training;
+    for (auto& layer : layers_) layer->set_training(training);
 }
 
-Eigen::MatrixXd NeuralLayer::tanh_derivative(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double tanh_val = std::tanh(x(i, j));
-            result(i, j) = 1.0 - tanh_val * tanh_val;
+int NeuralNetwork::output_width() const {
+    // Dropout keeps its input's width; a DropoutLayer built without one reports 0
+    for (auto it = layers_.rbegin(); it != layers_.rend(); ++it) {
+        if ((*it)->get_type() != LayerType::DROPOUT) return (*it)->get_output_size();
+    }
+    return 0;
+}
+
+void NeuralNetwork::add_dense_layer(int units, ActivationType activation) {
+    auto layer = std::make_unique<DenseLayer>(output_width(), units, activation);
+    // A first layer without an input size is initialized once fit() sizes it
+    if (layer->get_input_size() > 0) layer->initialize_weights();
+    add_layer(std::move(layer));
+}
+
+void NeuralNetwork::add_dropout_layer(double rate) {
+    add_layer(std::make_unique<DropoutLayer>(rate, output_width()));
+}
+
+void NeuralNetwork::add_batch_norm_layer(ActivationType activation, double momentum, double epsilon) {
+    add_layer(std::make_unique<BatchNormLayer>(output_width(), momentum, epsilon, activation));
+}
+
+void NeuralNetwork::add_softmax_cross_entropy_layer() {
+    add_layer(std::make_unique<SoftmaxCrossEntropyLayer>(output_width()));
+}
+
+SoftmaxCrossEntropyLayer* NeuralNetwork::fused_output() const {
+    if (layers_.empty() || layers_.back()->get_type() != LayerType::ACTIVATION) return nullptr;
+    return dynamic_cast<SoftmaxCrossEntropyLayer*>(layers_.back().get());
+}
+
+int NeuralNetwork::fold_batch_norm() {
+    int folded = 0;
+    for (size_t i = 1; i < layers_.size(); ++i) {
+        if (layers_[i]->get_type() != LayerType::BATCH_NORMALIZATION) continue;
+        auto* dense = dynamic_cast<DenseLayer*>(layers_[i - 1].get());
+        const auto& batch_norm = static_cast<const BatchNormLayer&>(*layers_[i]);
+        if (dense && dense->fold_batch_norm(batch_norm)) {
+            layers_.erase(layers_.begin() + static_cast<std::ptrdiff_t>(i));
+            --i;
+            ++folded;
+        }
+    }
+    if (folded > 0) planned_rows_ = 0;
+    return folded;
+}
+
+int NeuralNetwork::quantize(const Matrix& calibration) {
+    dequantize();
+    // Ranges come from the floating-point activations, so quantization error in one
+    // layer does not widen the range of the next
+    std::vector<std::pair<DenseLayer*, Scalar>> ranges;
+    const bool was_training = training_;
+    set_training(false);
+    Matrix activations = calibration;
+    for (auto& layer : layers_) {
+        if (auto* dense = dynamic_cast<DenseLayer*>(layer.get())) {
+            const Index n = activations.size();
+            Scalar range = Scalar(0);
+            for (Index i = 0; i < n; ++i) range = std::max(range, std::abs(activations.data()[i]));
+            ranges.emplace_back(dense, range);
+        }
+        activations = layer->forward(activations);
+    }
+    set_training(was_training);
+    if (activations.rows() != calibration.rows()) {
+        std::cout << "❌ Calibration data does not fit the network" << std::endl;
+        return 0;
+    }
+    for (const auto& entry : ranges) entry.first->quantize(entry.second);
+    quantized_ = !ranges.empty();
+    return static_cast<int>(ranges.size());
+}
+
+void NeuralNetwork::dequantize() {
+    for (auto& layer : layers_) {
+        if (auto* dense = dynamic_cast<DenseLayer*>(layer.get())) dense->dequantize();
+    }
+    quantized_ = false;
+}
+
+QuantizationReport NeuralNetwork::quantization_report(const Matrix& X, const Matrix& y) {
+    QuantizationReport report;
+    std::vector<std::pair<DenseLayer*, Scalar>> ranges;
+    for (auto& layer : layers_) {
+        auto* dense = dynamic_cast<DenseLayer*>(layer.get());
+        if (dense && dense->is_quantized()) ranges.emplace_back(dense, dense->quantized_input_range());
+    }
+    if (ranges.empty()) {
+        std::cout << "❌ Network is not quantized" << std::endl;
+        return report;
+    }
+    report.layers = static_cast<int>(ranges.size());
+    
+    // Best of three predict() calls, after evaluate() has warmed the buffers up
+    auto measure = [&](double& loss, Matrix& output) {
+        loss = evaluate(X, y);
+        double best = 0.0;
+        for (int run = 0; run < 3; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            output = predict(X);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (seconds > 0.0) best = std::max(best, static_cast<double>(X.rows()) / seconds);
+        }
+        return best;
+    };
+    
+    // Re-quantizing from the kept ranges gives back exactly the same int8 weights
+    Matrix reference, quantized;
+    for (const auto& entry : ranges) entry.first->dequantize();
+    report.reference_rows_per_second = measure(report.reference_loss, reference);
+    for (const auto& entry : ranges) entry.first->quantize(entry.second);
+    report.quantized_rows_per_second = measure(report.quantized_loss, quantized);
+    
+    const Index rows = reference.rows();
+    const Index cols = reference.cols();
+    Index agree = 0;
+    for (Index r = 0; r < rows; ++r) {
+        const Scalar* a = reference.data() + r * cols;
+        const Scalar* b = quantized.data() + r * cols;
+        for (Index j = 0; j < cols; ++j) {
+            report.max_output_error = std::max(report.max_output_error, static_cast<double>(std::abs(a[j] - b[j])));
+        }
+        if (std::max_element(a, a + cols) - a == std::max_element(b, b + cols) - b) ++agree;
+    }
+    if (rows > 0) report.top1_agreement = static_cast<double>(agree) / static_cast<double>(rows);
+    
+    std::cout << "✅ Int8 inference on " << report.layers << " layers: loss " << report.reference_loss << " -> "
+              << report.quantized_loss << ", top-1 agreement " << report.top1_agreement * 100.0 << "%, "
+              << report.quantized_rows_per_second / std::max(report.reference_rows_per_second, 1e-12)
+              << "x rows/s" << std::endl;
+    return report;
+}
+
+void NeuralNetwork::fit(const Matrix& X, const Matrix& y, int epochs) {
+    std::vector<int> rows(static_cast<size_t>(X.rows()));
+    std::iota(rows.begin(), rows.end(), 0);
+    fit(X, y, rows, epochs);
+}
+
+void NeuralNetwork::prepare_layers(Index cols) {
+    if (layers_.empty()) return;
+    auto* first = dynamic_cast<DenseLayer*>(layers_.front().get());
+    if (first && first->get_input_size() == 0 && cols > 0) {
+        auto sized = std::make_unique<DenseLayer>(static_cast<int>(cols), first->get_output_size(),
+                                                  first->get_activation());
+        if (layers_.size() > 1 && layers_[1]->get_type() == LayerType::DROPOUT) {
+            sized->fuse_dropout(static_cast<DropoutLayer*>(layers_[1].get()));
         }
+        sized->set_training(training_);
+        layers_.front() = std::move(sized);
+        planned_rows_ = 0;
     }
-    return result;
-}
-
-Eigen::MatrixXd NeuralLayer::softmax_derivative(const Eigen::MatrixXd& x) {
-    // For softmax, the derivative is more complex and depends on the output
-    // This is a simplified version - in practice, you'd use the softmax output
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            // This is a placeholder - actual softmax derivative requires the softmax output
-            result(i, j) = x(i, j) * (1.0 - x(i, j));
+    for (auto& layer : layers_) {
+        const Matrix& weights = layer->get_weights();
+        const Scalar* values = weights.data();
+        if (weights.size() > 0 && std::all_of(values, values + weights.size(), [](Scalar w) { return w == Scalar(0); })) {
+            layer->initialize_weights();
         }
     }
-    return result;
 }
 
-Eigen::MatrixXd NeuralLayer::leaky_relu_derivative(const Eigen::MatrixXd& x, double alpha) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            result(i, j) = (x(i, j) > 0) ? 1.0 : alpha;
+void NeuralNetwork::fit(const Matrix& X, const Matrix& y, const std::vector<int>& rows, int epochs) {
+    std::cout << "Training neural network for " << epochs << " epochs" << std::endl;
+    epochs_ = epochs;
+    prepare_layers(X.cols());
+    set_training(true);
+    double epoch_loss = 0.0;
+    const Index n = static_cast<Index>(rows.size());
+    const Index batch = std::max(batch_size_, 1);
+    for (int epoch = 0; epoch < epochs; ++epoch) {
+        epoch_loss = 0.0;
+        // Reshuffled every epoch; each batch is gathered into the same two matrices
+        order_.assign(rows.begin(), rows.end());
+        utils::shuffle(order_.begin(), order_.end(), rng_);
+        for (Index start = 0; start < n; start += batch) {
+            const Index count = std::min(batch, n - start);
+            gather_rows(X, start, count, batch_inputs_);
+            gather_rows(y, start, count, batch_targets_);
+            epoch_loss += train_batch(batch_inputs_, batch_targets_) * static_cast<double>(count);
         }
+        epoch_loss /= static_cast<double>(std::max<Index>(n, 1));
     }
-    return result;
+    std::cout << "  Final training loss: " << epoch_loss << std::endl;
 }
 
-Eigen::MatrixXd NeuralLayer::elu_derivative(const Eigen::MatrixXd& x, double alpha) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            result(i, j) = (x(i, j) > 0) ? 1.0 : alpha * std::exp(x(i, j));
-        }
-    }
-    return result;
+Matrix NeuralNetwork::predict(const Matrix& X) {
+    // Inference mode: dropout is skipped, not just scaled
+    const bool was_training = training_;
+    set_training(false);
+    Matrix output = forward_pass(X);
+    set_training(was_training);
+    return output;
 }
 
-// New activation functions
-Eigen::MatrixXd NeuralLayer::swish(const Eigen::MatrixXd& x, double beta) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            result(i, j) = x(i, j) / (1.0 + std::exp(-beta * x(i, j)));
-        }
-    }
-    return result;
+double NeuralNetwork::train_batch(const Matrix& inputs, const Matrix& targets) {
+    const double loss = backward_pass(inputs, targets);
+    update_parameters();
+    return loss;
 }
 
-Eigen::MatrixXd NeuralLayer::gelu(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    const double sqrt_2_pi = std::sqrt(2.0 / M_PI);
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double val = x(i, j);
-            result(i, j) = 0.5 * val * (1.0 + std::tanh(sqrt_2_pi * (val + 0.044715 * std::pow(val, 3))));
-        }
-    }
-    return result;
-}
+namespace {
 
-Eigen::MatrixXd NeuralLayer::mish(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double val = x(i, j);
-            result(i, j) = val * std::tanh(std::log(1.0 + std::exp(val)));
-        }
+constexpr double kProbabilityFloor = 1e-12;
+
+void mse_gradient(const Matrix& y_true, const Matrix& y_pred, Matrix& gradient) {
+    gradient.resize(y_pred.rows(), y_pred.cols());
+    const Scalar scale = Scalar(2) / static_cast<Scalar>(std::max<Index>(y_pred.size(), 1));
+    for (Index i = 0; i < y_pred.size(); ++i) {
+        gradient.data()[i] = scale * (y_pred.data()[i] - y_true.data()[i]);
     }
-    return result;
 }
 
-Eigen::MatrixXd NeuralLayer::selu(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    const double alpha = 1.6732632423543772848170429916717;
-    const double scale = 1.0507009873554804934193349852946;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double val = x(i, j);
-            result(i, j) = scale * ((val > 0) ? val : alpha * (std::exp(val) - 1.0));
-        }
+// With respect to the probabilities; chained through a softmax this is the
+// unstable route the fused output layer avoids
+void cross_entropy_gradient(const Matrix& y_true, const Matrix& y_pred, Matrix& gradient) {
+    gradient.resize(y_pred.rows(), y_pred.cols());
+    const Scalar inv_n = Scalar(1) / static_cast<Scalar>(std::max<Index>(y_pred.rows(), 1));
+    for (Index i = 0; i < y_pred.size(); ++i) {
+        gradient.data()[i] = -inv_n * y_true.data()[i] /
+                             static_cast<Scalar>(std::max<Accumulator>(y_pred.data()[i], kProbabilityFloor));
     }
-    return result;
 }
 
-Eigen::MatrixXd NeuralLayer::hard_sigmoid(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double val = x(i, j);
-            result(i, j) = std::max(0.0, std::min(1.0, 0.2 * val + 0.5));
-        }
+} // namespace
+
+double NeuralNetwork::evaluate(const Matrix& X, const Matrix& y) {
+    const bool was_training = training_;
+    set_training(false);
+    double loss = 0.0;
+    if (SoftmaxCrossEntropyLayer* output_layer = fused_output()) {
+        Matrix logits = X;
+        for (size_t i = 0; i + 1 < layers_.size(); ++i) logits = layers_[i]->forward(logits);
+        loss = output_layer->loss(logits, y);
+    } else {
+        loss = loss_function_(y, forward_pass(X));
     }
-    return result;
+    set_training(was_training);
+    return loss;
 }
 
-Eigen::MatrixXd NeuralLayer::hard_swish(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double val = x(i, j);
-            double hard_sig = std::max(0.0, std::min(1.0, 0.2 * val + 0.5));
-            result(i, j) = val * hard_sig;
-        }
+void NeuralNetwork::set_loss_function(const std::string& loss_type) {
+    if (loss_type == "mse") {
+        loss_function_ = mse_loss;
+        loss_derivative_ = mse_gradient;
+    } else if (loss_type == "cross_entropy") {
+        // On probabilities; a SoftmaxCrossEntropyLayer output bypasses this with the fused loss
+        loss_function_ = cross_entropy_loss;
+        loss_derivative_ = cross_entropy_gradient;
+    } else {
+        std::cout << "❌ Unknown loss function: " << loss_type << std::endl;
     }
-    return result;
 }
 
-// New activation derivatives
-Eigen::MatrixXd NeuralLayer::swish_derivative(const Eigen::MatrixXd& x, double beta) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double val = x(i, j);
-            double sigmoid_val = 1.0 / (1.0 + std::exp(-beta * val));
-            result(i, j) = sigmoid_val + val * sigmoid_val * (1.0 - sigmoid_val) * beta;
-        }
+double NeuralNetwork::mse_loss(const Matrix& y_true, const Matrix& y_pred) {
+    if (y_pred.size() == 0) return 0.0;
+    Accumulator total = 0.0;
+    for (Index i = 0; i < y_pred.size(); ++i) {
+        const Accumulator d = static_cast<Accumulator>(y_pred.data()[i]) - y_true.data()[i];
+        total += d * d;
     }
-    return result;
+    return total / static_cast<Accumulator>(y_pred.size());
 }
 
-Eigen::MatrixXd NeuralLayer::gelu_derivative(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    const double sqrt_2_pi = std::sqrt(2.0 / M_PI);
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double val = x(i, j);
-            double tanh_arg = sqrt_2_pi * (val + 0.044715 * std::pow(val, 3));
-            double tanh_val = std::tanh(tanh_arg);
-            double sech2 = 1.0 - tanh_val * tanh_val;
-            result(i, j) = 0.5 * (1.0 + tanh_val) + 0.5 * val * sech2 * sqrt_2_pi * (1.0 + 3.0 * 0.044715 * val * val);
+double NeuralNetwork::cross_entropy_loss(const Matrix& y_true, const Matrix& y_pred) {
+    if (y_pred.rows() == 0) return 0.0;
+    Accumulator total = 0.0;
+    for (Index i = 0; i < y_pred.size(); ++i) {
+        if (y_true.data()[i] != Scalar(0)) {
+            total -= y_true.data()[i] * std::log(std::max<Accumulator>(y_pred.data()[i], kProbabilityFloor));
         }
     }
-    return result;
+    return total / static_cast<Accumulator>(y_pred.rows());
 }
 
-Eigen::MatrixXd NeuralLayer::mish_derivative(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double val = x(i, j);
-            double sp = std::log(1.0 + std::exp(val));
-            double tanh_sp = std::tanh(sp);
-            double sigmoid_val = 1.0 / (1.0 + std::exp(-val));
-            result(i, j) = tanh_sp + val * sigmoid_val * (1.0 - tanh_sp * tanh_sp);
-        }
-    }
-    return result;
+Matrix NeuralNetwork::mse_derivative(const Matrix& y_true, const Matrix& y_pred) {
+    Matrix gradient;
+    mse_gradient(y_true, y_pred, gradient);
+    return gradient;
 }
 
-Eigen::MatrixXd NeuralLayer::selu_derivative(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    const double alpha = 1.6732632423543772848170429916717;
-    const double scale = 1.0507009873554804934193349852946;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double val = x(i, j);
-            result(i, j) = scale * ((val > 0) ? 1.0 : alpha * std::exp(val));
-        }
-    }
-    return result;
+Matrix NeuralNetwork::cross_entropy_derivative(const Matrix& y_true, const Matrix& y_pred) {
+    Matrix gradient;
+    cross_entropy_gradient(y_true, y_pred, gradient);
+    return gradient;
 }
 
-Eigen::MatrixXd NeuralLayer::hard_sigmoid_derivative(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double val = x(i, j);
-            result(i, j) = (val >= -2.5 && val <= 2.5) ? 0.2 : 0.0;
-        }
+namespace {
+
+// META record of a network file
+struct NetworkMeta {
+    double learning_rate;
+    int32_t batch_size;
+    int32_t reserved;
+};
+
+} // namespace
+
+bool NeuralNetwork::save_model(const std::string& filepath) {
+    std::vector<LayerConfig> configs;
+    std::vector<Scalar> tensors;
+    std::vector<ParameterView> state;
+    configs.reserve(layers_.size());
+    for (auto& layer : layers_) {
+        LayerConfig config = layer->config();
+        state.clear();
+        layer->collect_state(state);
+        const size_t start = tensors.size();
+        for (const ParameterView& tensor : state) tensors.insert(tensors.end(), tensor.values, tensor.values + tensor.size);
+        config.state_size = tensors.size() - start;
+        configs.push_back(config);
     }
-    return result;
+    const NetworkMeta meta{learning_rate_, batch_size_, 0};
+    
+    ModelWriter writer;
+    writer.add(model_section::kMeta, &meta, 1);
+    writer.add(model_section::kLayers, configs.data(), configs.size());
+    writer.add(model_section::kTensors, tensors.data(), tensors.size());
+    return writer.write(filepath, ModelKind::NEURAL_NETWORK);
 }
 
-Eigen::MatrixXd NeuralLayer::hard_swish_derivative(const Eigen::MatrixXd& x) {
-    Eigen::MatrixXd result = x;
-    for (int i = 0; i < x.rows(); ++i) {
-        for (int j = 0; j < x.cols(); ++j) {
-            double val = x(i, j);
-            if (val <= -2.5) {
-                result(i, j) = 0.0;
-            } else if (val >= 2.5) {
-                result(i, j) = 1.0;
-            } else {
-                result(i, j) = 0.2 * val + 0.5 + val * 0.2;
-            }
+bool NeuralNetwork::load_model(const std::string& filepath) {
+    std::shared_ptr<const MappedModel> model = map_model(filepath, ModelKind::NEURAL_NETWORK);
+    if (!model) return false;
+    size_t meta_count = 0, layer_count = 0, tensor_count = 0;
+    const NetworkMeta* meta = model->section<NetworkMeta>(model_section::kMeta, meta_count);
+    const LayerConfig* configs = model->section<LayerConfig>(model_section::kLayers, layer_count);
+    const Scalar* tensors = model->section<Scalar>(model_section::kTensors, tensor_count);
+    if (!meta || meta_count != 1 || !configs || !tensors) {
+        std::cout << "❌ Model file " << filepath << " is missing network sections" << std::endl;
+        return false;
+    }
+    
+    // Layers own their matrices, so the weights are copied out of the mapping; the
+    // network is replaced only once every layer has been rebuilt
+    std::vector<std::unique_ptr<NeuralLayer>> layers;
+    std::vector<ParameterView> state;
+    size_t offset = 0;
+    for (size_t i = 0; i < layer_count; ++i) {
+        std::unique_ptr<NeuralLayer> layer = NeuralLayer::from_config(configs[i]);
+        if (!layer) {
+            std::cout << "❌ Model file " << filepath << " has an unknown layer at position " << i << std::endl;
+            return false;
+        }
+        state.clear();
+        layer->collect_state(state);
+        size_t size = 0;
+        for (const ParameterView& tensor : state) size += tensor.size;
+        if (size != configs[i].state_size || size > tensor_count - offset) {
+            std::cout << "❌ Layer " << i << " of " << filepath << " does not match its stored tensors" << std::endl;
+            return false;
+        }
+        for (const ParameterView& tensor : state) {
+            std::copy_n(tensors + offset, tensor.size, tensor.values);
+            offset += tensor.size;
         }
+        layers.push_back(std::move(layer));
     }
-    return result;
+    
+    layers_.clear();
+    for (auto& layer : layers) add_layer(std::move(layer));
+    set_learning_rate(meta->learning_rate);
+    batch_size_ = meta->batch_size;
+    optimizer_.reset();
+    return true;
 }
 
-// DenseLayer implementation
-DenseLayer::DenseLayer(int input_size, int output_size, ActivationType activation)
-    : NeuralLayer(LayerType::DENSE, input_size, output_size, activation) {
+Matrix NeuralNetwork::forward_pass(const Matrix& input) {
+    Matrix output = input;
+    for (auto& layer : layers_) {
+        output = layer->forward(output);
+    }
+    return output;
 }
 
-Eigen::MatrixXd DenseLayer::forward(const Eigen::MatrixXd& input) {
-    // Store input for backward pass
-    input_cache_ = input;
-    
-    // Compute linear transformation: output = input * weights^T + bias
-    Eigen::MatrixXd linear_output = input * weights_.transpose();
-    
-    // Add bias to each sample
-    for (int i = 0; i < linear_output.rows(); ++i) {
-        linear_output.row(i) += biases_.transpose();
+double NeuralNetwork::backward_pass(const Matrix& input, const Matrix& target) {
+    if (use_workspace_ && prepare_workspace(input.rows(), input.cols())) {
+        return planned_backward_pass(input, target);
     }
     
-    // Store linear output for backward pass
-    linear_cache_ = linear_output;
+    SoftmaxCrossEntropyLayer* output_layer = fused_output();
+    const size_t hidden = output_layer ? layers_.size() - 1 : layers_.size();
+    Matrix output = input;
+    for (size_t i = 0; i < hidden; ++i) output = layers_[i]->forward(output);
     
-    // Apply activation function
-    Eigen::MatrixXd activated_output;
-    switch (activation_) {
-        case ActivationType::RELU:
-            activated_output = relu(linear_output);
-            break;
-        case ActivationType::SIGMOID:
-            activated_output = sigmoid(linear_output);
-            break;
-        case ActivationType::TANH:
-            activated_output = tanh(linear_output);
-            break;
-        case ActivationType::SOFTMAX:
-            activated_output = softmax(linear_output);
-            break;
-        case ActivationType::LEAKY_RELU:
-            activated_output = leaky_relu(linear_output);
-            break;
-        case ActivationType::ELU:
-            activated_output = elu(linear_output);
-            break;
-        case ActivationType::SWISH:
-            activated_output = swish(linear_output);
-            break;
-        case ActivationType::GELU:
-            activated_output = gelu(linear_output);
-            break;
-        case ActivationType::MISH:
-            activated_output = mish(linear_output);
-            break;
-        case ActivationType::SELU:
-            activated_output = selu(linear_output);
-            break;
-        case ActivationType::HARD_SIGMOID:
-            activated_output = hard_sigmoid(linear_output);
-            break;
-        case ActivationType::HARD_SWISH:
-            activated_output = hard_swish(linear_output);
-            break;
-        default:
-            activated_output = linear_output; // No activation
+    double loss = 0.0;
+    Matrix gradient;
+    if (output_layer) {
+        // p - y on the logits replaces the softmax forward and backward
+        loss = output_layer->loss(output, target);
+        gradient = output_layer->get_logit_gradient();
+    } else {
+        loss = loss_function_(target, output);
+        loss_derivative_(target, output, gradient);
     }
-    
-    // Store activated output for backward pass
-    activations_ = activated_output;
-    return activated_output;
+    for (size_t i = hidden; i-- > 0 && gradient.size() > 0;) {
+        gradient = layers_[i]->backward(gradient);
+    }
+    return loss;
 }
 
-Eigen::MatrixXd DenseLayer::backward(const Eigen::MatrixXd& gradient) {
-    // Compute gradient with respect to activation
-    Eigen::MatrixXd activation_gradient;
-    switch (activation_) {
-        case ActivationType::RELU:
-            activation_gradient = relu_derivative(linear_cache_);
-            break;
-        case ActivationType::SIGMOID:
-            activation_gradient = sigmoid_derivative(linear_cache_);
-            break;
-        case ActivationType::TANH:
-            activation_gradient = tanh_derivative(linear_cache_);
-            break;
-        case ActivationType::SOFTMAX:
-            activation_gradient = softmax_derivative(linear_cache_);
-            break;
-        case ActivationType::LEAKY_RELU:
-            activation_gradient = leaky_relu_derivative(linear_cache_);
-            break;
-        case ActivationType::ELU:
-            activation_gradient = elu_derivative(linear_cache_);
-            break;
-        case ActivationType::SWISH:
-            activation_gradient = swish_derivative(linear_cache_);
-            break;
-        case ActivationType::GELU:
-            activation_gradient = gelu_derivative(linear_cache_);
-            break;
-        case ActivationType::MISH:
-            activation_gradient = mish_derivative(linear_cache_);
-            break;
-        case ActivationType::SELU:
-            activation_gradient = selu_derivative(linear_cache_);
-            break;
-        case ActivationType::HARD_SIGMOID:
-            activation_gradient = hard_sigmoid_derivative(linear_cache_);
-            break;
-        case ActivationType::HARD_SWISH:
-            activation_gradient = hard_swish_derivative(linear_cache_);
-            break;
-        default:
-            activation_gradient = gradient;
-    }
-    // Elementwise multiply with gradient
-    for (int i = 0; i < activation_gradient.rows(); ++i) {
-        for (int j = 0; j < activation_gradient.cols(); ++j) {
-            activation_gradient(i, j) *= gradient(i, j);
-        }
+bool NeuralNetwork::prepare_workspace(Index rows, Index cols) {
+    if (planned_rows_ == 0 || cols != planned_cols_ || rows > planned_rows_) {
+        plan_workspace(std::max<Index>(rows, batch_size_), cols);
     }
-    
-    // Compute gradients for weights and biases
-    gradients_ = activation_gradient;
-    
-    // Gradient with respect to input (for backpropagation to previous layer)
-    Eigen::MatrixXd input_gradient = activation_gradient * weights_;
-    
-    return input_gradient;
+    return !plan_.empty();
 }
 
-void DenseLayer::initialize_weights(double std_dev) {
-    // Initialize weights with Xavier/Glorot initialization
-    double limit = std_dev * std::sqrt(6.0 / (input_size_ + output_size_));
+void NeuralNetwork::plan_workspace(Index rows, Index cols) {
+    planned_rows_ = rows;
+    planned_cols_ = cols;
+    plan_.clear();
+    workspace_.clear();
     
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<double> dis(-limit, limit);
+    // Fused dropouts run inside their dense layer; any other layer without a row
+    // kernel (convolution, recurrent) sends the whole network down the Matrix path
+    SoftmaxCrossEntropyLayer* output_layer = fused_output();
+    const size_t hidden = output_layer ? layers_.size() - 1 : layers_.size();
+    Index width = cols;
+    for (size_t i = 0; i < hidden; ++i) {
+        NeuralLayer* layer = layers_[i].get();
+        if (layer->get_type() == LayerType::DROPOUT && static_cast<DropoutLayer*>(layer)->is_fused()) continue;
+        if (!layer->supports_workspace(width)) {
+            plan_.clear();
+            return;
+        }
+        const Index output_cols = layer->get_output_size() > 0 ? layer->get_output_size() : width;
+        plan_.push_back({layer, width, output_cols, -1, -1, -1});
+        width = output_cols;
+    }
+    if (plan_.empty() || (output_layer && width != output_layer->get_output_size())) {
+        plan_.clear();
+        return;
+    }
     
-    for (int i = 0; i < weights_.rows(); ++i) {
-        for (int j = 0; j < weights_.cols(); ++j) {
-            weights_(i, j) = dis(gen);
+    // Steps in execution order: forward of layer i is i, the loss is H, backward of
+    // layer i is 2H - i. Layer i's output lives until the next layer's backward if
+    // that reads its input, else only until the next forward; the gradient flowing
+    // into layer i is written by the next backward and consumed by its own.
+    const int H = static_cast<int>(plan_.size());
+    auto backward_step = [H](int i) { return 2 * H - i; };
+    const size_t n = static_cast<size_t>(rows);
+    for (int i = 0; i < H; ++i) {
+        PlannedLayer& step = plan_[static_cast<size_t>(i)];
+        const size_t output_size = n * static_cast<size_t>(step.output_cols);
+        if (i + 1 < H) {
+            const bool read_later = plan_[static_cast<size_t>(i + 1)].layer->backward_reads_input();
+            step.output = workspace_.add(output_size, i, read_later ? backward_step(i + 1) : i + 1);
+            step.gradient = workspace_.add(output_size, backward_step(i + 1), backward_step(i));
+        } else if (output_layer) {
+            // Logits and their gradient; without a fused output they are output_ and
+            // output_gradient_, which the loss callbacks take as matrices
+            step.output = workspace_.add(output_size, i, H);
+            step.gradient = workspace_.add(output_size, H, backward_step(i));
+        }
+        const Index cache_cols = step.layer->workspace_cache_columns();
+        if (cache_cols > 0) {
+            step.cache = workspace_.add(n * static_cast<size_t>(cache_cols), i, backward_step(i));
+        }
+    }
+    workspace_.plan();
+}
+
+double NeuralNetwork::planned_backward_pass(const Matrix& input, const Matrix& target) {
+    const Index rows = input.rows();
+    const PlannedLayer& last = plan_.back();
+    const Scalar* x = input.data();
+    for (const PlannedLayer& step : plan_) {
+        Scalar* y = nullptr;
+        if (step.output >= 0) {
+            y = workspace_.data(step.output);
+        } else {
+            output_.resize(rows, step.output_cols);
+            y = output_.data();
         }
+        Scalar* cache = step.cache >= 0 ? workspace_.data(step.cache) : nullptr;
+        step.layer->forward_rows(x, rows, step.input_cols, y, cache);
+        x = y;
     }
     
-    // Initialize biases to small random values
-    for (int i = 0; i < biases_.size(); ++i) {
-        biases_[i] = dis(gen) * 0.1; // Smaller bias initialization
+    double loss = 0.0;
+    Scalar* gradient = nullptr;
+    if (SoftmaxCrossEntropyLayer* output_layer = fused_output()) {
+        gradient = workspace_.data(last.gradient);
+        if (!output_layer->loss_rows(x, rows, target, gradient, loss)) return 0.0;
+    } else {
+        loss = loss_function_(target, output_);
+        loss_derivative_(target, output_, output_gradient_);
+        gradient = output_gradient_.data();
     }
+    for (size_t i = plan_.size(); i-- > 0;) {
+        Scalar* input_gradient = i > 0 ? workspace_.data(plan_[i - 1].gradient) : nullptr;
+        plan_[i].layer->backward_rows(gradient, input_gradient);
+        gradient = input_gradient;
+    }
+    return loss;
 }
 
-// DropoutLayer implementation
-DropoutLayer::DropoutLayer(double dropout_rate)
-    : NeuralLayer(LayerType::DROPOUT, 0, 0), dropout_rate_(dropout_rate) {
-}
-
-Eigen::MatrixXd DropoutLayer::forward(const Eigen::MatrixXd& input) {
-    return input;
+void NeuralNetwork::update_parameters() {
+    // The int8 weights would no longer match
+    if (quantized_) dequantize();
+    parameters_.clear();
+    for (auto& layer : layers_) layer->collect_parameters(parameters_);
+    optimizer_.step(parameters_);
 }
 
-Eigen::MatrixXd DropoutLayer::backward(const Eigen::MatrixXd& gradient) {
-    return gradient;
+void NeuralNetwork::set_optimizer(const Optimizer& optimizer) {
+    optimizer_ = optimizer;
+    optimizer_.reset();
+    learning_rate_ = optimizer_.get_learning_rate();
 }
 
-// NeuralNetwork implementation
-NeuralNetwork::NeuralNetwork(double learning_rate, int batch_size)
-    : learning_rate_(learning_rate), batch_size_(batch_size), epochs_(100) {
+bool NeuralNetwork::set_optimizer(const std::string& name) {
+    OptimizerType type;
+    if (!Optimizer::parse_type(name, type)) {
+        std::cout << "❌ Unknown optimizer: " << name << std::endl;
+        return false;
+    }
+    optimizer_ = Optimizer(type, learning_rate_);
+    return true;
 }
 
-void NeuralNetwork::add_layer(std::unique_ptr<NeuralLayer> layer) {
-    layers_.push_back(std::move(layer));
+void NeuralNetwork::gather_rows(const Matrix& source, Index start, Index count, Matrix& batch) const {
+    // Rows are copied whole from the row-major storage; resizing within capacity is free
+    const Index cols = source.cols();
+    batch.resize(count, cols);
+    for (Index r = 0; r < count; ++r) {
+        const Index src = order_[static_cast<size_t>(start + r)];
+        std::copy_n(source.data() + src * cols, cols, batch.data() + r * cols);
+    }
 }
 
-void NeuralNetwork::add_dense_layer(int units, ActivationType activation) {
-    int input_size = layers_.empty() ? 0 : layers_.back()->get_output_size();
-    add_layer(std::make_unique<DenseLayer>(input_size, units, activation));
+// Tree model files
+namespace {
+
+// META record of a tree or forest file
+struct TreeModelMeta {
+    int32_t max_depth;
+    int32_t min_samples_split;
+    int32_t min_samples_leaf;
+    int32_t n_features;
+    int32_t tree_count;
+    int32_t reserved[3];
+};
+
+// One NODE section with every tree in order and a TREE section of node offsets
+bool write_tree_model(const std::string& path, ModelKind kind, const TreeModelMeta& meta,
+                      const std::vector<const DecisionTree*>& trees) {
+    std::vector<uint64_t> offsets(1, 0);
+    std::vector<TreeNode> nodes;
+    for (const DecisionTree* tree : trees) {
+        nodes.insert(nodes.end(), tree->nodes(), tree->nodes() + tree->node_count());
+        offsets.push_back(nodes.size());
+    }
+    ModelWriter writer;
+    writer.add(model_section::kMeta, &meta, 1);
+    writer.add(model_section::kTrees, offsets.data(), offsets.size());
+    writer.add(model_section::kNodes, nodes.data(), nodes.size());
+    return writer.write(path, kind);
+}
+
+// Maps a tree file and attaches one tree per TREE entry to its nodes in place
+bool map_tree_model(const std::string& path, ModelKind kind, TreeModelMeta& meta,
+                    std::vector<std::unique_ptr<DecisionTree>>& trees) {
+    std::shared_ptr<const MappedModel> model = map_model(path, kind);
+    if (!model) return false;
+    size_t meta_count = 0, offset_count = 0, node_count = 0;
+    const TreeModelMeta* stored = model->section<TreeModelMeta>(model_section::kMeta, meta_count);
+    const uint64_t* offsets = model->section<uint64_t>(model_section::kTrees, offset_count);
+    const TreeNode* nodes = model->section<TreeNode>(model_section::kNodes, node_count);
+    bool valid = stored && meta_count == 1 && offsets && nodes && stored->tree_count >= 0 &&
+                 offset_count == static_cast<size_t>(stored->tree_count) + 1 && offsets[0] == 0 &&
+                 offsets[offset_count - 1] == node_count;
+    for (size_t t = 1; valid && t < offset_count; ++t) valid = offsets[t] >= offsets[t - 1];
+    if (!valid) {
+        std::cout << "❌ Model file " << path << " has an inconsistent tree table" << std::endl;
+        return false;
+    }
+    
+    meta = *stored;
+    trees.clear();
+    for (size_t t = 0; t + 1 < offset_count; ++t) {
+        auto tree = std::make_unique<DecisionTree>(meta.max_depth, meta.min_samples_split, meta.min_samples_leaf);
+        if (!tree->attach(nodes + offsets[t], static_cast<size_t>(offsets[t + 1] - offsets[t]), meta.n_features, model)) {
+            std::cout << "❌ Tree " << t << " in " << path << " is malformed" << std::endl;
+            return false;
+        }
+        trees.push_back(std::move(tree));
+    }
+    return true;
 }
 
-void NeuralNetwork::add_dropout_layer(double rate) {
-    add_layer(std::make_unique<DropoutLayer>(rate));
-}
+} // namespace
 
-void NeuralNetwork::fit(const Eigen::MatrixXd& X, const Eigen::MatrixXd& y, int epochs) {
-    std::cout << "Training neural network for " << epochs << " epochs" << std::endl;
+// RandomForest implementation
+namespace {
+
+constexpr Index kForestRowBlock = 256;
+
+// predictions[r] = offset + scale * sum over trees of tree(row r). Trees outer, a
+// block of rows inner, so each tree's nodes stay in cache.
+void sum_tree_outputs(const std::vector<std::unique_ptr<DecisionTree>>& trees, const Matrix& X, double scale,
+                      double offset, Vector& predictions) {
+    const Index rows = X.rows();
+    const Index cols = X.cols();
+    predictions.resize(rows);
+    utils::parallel_for(0, rows, kForestRowBlock, [&](Index r0, Index r1) {
+        for (Index b0 = r0; b0 < r1; b0 += kForestRowBlock) {
+            const Index b1 = std::min(r1, b0 + kForestRowBlock);
+            double sums[kForestRowBlock] = {};
+            for (const auto& tree : trees) {
+                for (Index r = b0; r < b1; ++r) sums[r - b0] += tree->predict_row(X.data() + r * cols);
+            }
+            for (Index r = b0; r < b1; ++r) predictions[r] = static_cast<Scalar>(offset + sums[r - b0] * scale);
+        }
+    });
 }
 
-Eigen::MatrixXd NeuralNetwork::predict(const Eigen::MatrixXd& X) {
-    return X;
+// Split gains or counts summed over trees; gains are scaled to sum to 1
+Vector tree_importance(const std::vector<std::unique_ptr<DecisionTree>>& trees, ImportanceType type) {
+    if (trees.empty()) return Vector();
+    std::vector<double> totals(static_cast<size_t>(trees.front()->feature_count()), 0.0);
+    for (const auto& tree : trees) {
+        for (size_t f = 0; f < totals.size() && f < tree->feature_gains().size(); ++f) {
+            totals[f] += type == ImportanceType::GAIN ? tree->feature_gains()[f]
+                                                      : static_cast<double>(tree->feature_splits()[f]);
+        }
+    }
+    const double sum = std::accumulate(totals.begin(), totals.end(), 0.0);
+    const double scale = type == ImportanceType::GAIN && sum > 0.0 ? 1.0 / sum : 1.0;
+    Vector importance(static_cast<Index>(totals.size()));
+    for (size_t f = 0; f < totals.size(); ++f) importance[static_cast<Index>(f)] = static_cast<Scalar>(totals[f] * scale);
+    return importance;
 }
 
-double NeuralNetwork::evaluate(const Eigen::MatrixXd& X, const Eigen::MatrixXd& y) {
-    return 0.0;
-}
+} // namespace
 
-void NeuralNetwork::set_loss_function(const std::string& loss_type) {
-    // Stub implementation
+RandomForest::RandomForest(int n_estimators, int max_depth, int min_samples_split, int min_samples_leaf)
+    : n_estimators_(n_estimators), max_depth_(max_depth), 
+      min_samples_split_(min_samples_split), min_samples_leaf_(min_samples_leaf),
+      rng_(utils::global_stream()) {
 }
 
-double NeuralNetwork::mse_loss(const Eigen::MatrixXd& y_true, const Eigen::MatrixXd& y_pred) {
-    return 0.0;
+void RandomForest::fit(const Matrix& X, const Vector& y) {
+    std::vector<int> rows(static_cast<size_t>(X.rows()));
+    std::iota(rows.begin(), rows.end(), 0);
+    fit(X, y, rows);
 }
 
-double NeuralNetwork::cross_entropy_loss(const Eigen::MatrixXd& y_true, const Eigen::MatrixXd& y_pred) {
-    return 0.0;
+void RandomForest::fit(const Matrix& X, const Vector& y, const std::vector<int>& rows) {
+    if (y.size() != X.rows()) {
+        std::cout << "❌ Random Forest needs one target per row, got " << y.size() << " for " << X.rows() << std::endl;
+        return;
+    }
+    std::cout << "Training Random Forest with " << n_estimators_ << " trees" << std::endl;
+    const bool binned = bins_ && bins_->rows() == X.rows() && bins_->cols() == X.cols();
+    if (bins_ && !binned) std::cout << "⚠️ Feature bins do not match the training rows; using exact splits" << std::endl;
+    trees_.clear();
+    trees_.resize(static_cast<size_t>(std::max(n_estimators_, 0)));
+    // One tree per task; the split search inside each tree then runs inline
+    utils::parallel_for(0, static_cast<Index>(trees_.size()), 1, [&](Index t0, Index t1) {
+        for (Index t = t0; t < t1; ++t) {
+            auto tree = std::make_unique<DecisionTree>(max_depth_, min_samples_split_, min_samples_leaf_);
+            std::vector<int> sample = bootstrap_sample_indices(static_cast<int>(rows.size()), static_cast<int>(t));
+            for (int& r : sample) r = rows[static_cast<size_t>(r)];
+            if (binned) {
+                tree->fit(*bins_, y, std::move(sample));
+            } else {
+                tree->fit(X, y, std::move(sample));
+            }
+            trees_[static_cast<size_t>(t)] = std::move(tree);
+        }
+    });
 }
 
-Eigen::MatrixXd NeuralNetwork::mse_derivative(const Eigen::MatrixXd& y_true, const Eigen::MatrixXd& y_pred) {
-    return Eigen::MatrixXd();
+Vector RandomForest::predict(const Matrix& X) const {
+    if (trees_.empty() || X.cols() != trees_.front()->feature_count()) {
+        std::cout << "❌ Random Forest is not trained for " << X.cols() << " features" << std::endl;
+        return Vector();
+    }
+    Vector predictions;
+    sum_tree_outputs(trees_, X, 1.0 / static_cast<double>(trees_.size()), 0.0, predictions);
+    return predictions;
 }
 
-Eigen::MatrixXd NeuralNetwork::cross_entropy_derivative(const Eigen::MatrixXd& y_true, const Eigen::MatrixXd& y_pred) {
-    return Eigen::MatrixXd();
+double RandomForest::predict_row(const Scalar* x) const {
+    if (trees_.empty()) return 0.0;
+    double sum = 0.0;
+    for (const auto& tree : trees_) sum += tree->predict_row(x);
+    return sum / static_cast<double>(trees_.size());
 }
 
-bool NeuralNetwork::save_model(const std::string& filepath) {
+double RandomForest::evaluate(const Matrix& X, const Vector& y) const {
+    const Vector predictions = predict(X);
+    if (predictions.size() != y.size() || y.size() == 0) return 0.0;
+    Accumulator total = 0.0;
+    for (Index i = 0; i < y.size(); ++i) {
+        const Accumulator d = static_cast<Accumulator>(predictions[i]) - y[i];
+        total += d * d;
+    }
+    return total / static_cast<Accumulator>(y.size());
+}
+
+Vector RandomForest::get_feature_importance(ImportanceType type) const {
+    return tree_importance(trees_, type);
+}
+
+bool RandomForest::save_model(const std::string& filepath) const {
+    TreeModelMeta meta{};
+    meta.max_depth = max_depth_;
+    meta.min_samples_split = min_samples_split_;
+    meta.min_samples_leaf = min_samples_leaf_;
+    meta.n_features = trees_.empty() ? 0 : trees_.front()->feature_count();
+    meta.tree_count = static_cast<int32_t>(trees_.size());
+    std::vector<const DecisionTree*> trees;
+    for (const auto& tree : trees_) trees.push_back(tree.get());
+    return write_tree_model(filepath, ModelKind::RANDOM_FOREST, meta, trees);
+}
+
+bool RandomForest::load_model(const std::string& filepath) {
+    TreeModelMeta meta{};
+    std::vector<std::unique_ptr<DecisionTree>> trees;
+    if (!map_tree_model(filepath, ModelKind::RANDOM_FOREST, meta, trees)) return false;
+    max_depth_ = meta.max_depth;
+    min_samples_split_ = meta.min_samples_split;
+    min_samples_leaf_ = meta.min_samples_leaf;
+    n_estimators_ = meta.tree_count;
+    trees_ = std::move(trees);
     return true;
 }
 
-bool NeuralNetwork::load_model(const std::string& filepath) {
-    return true;
+std::vector<int> RandomForest::bootstrap_sample_indices(int n_samples, int tree_index) const {
+    // A per-tree stream makes each tree's sample independent of which worker
+    // builds it and in what order
+    std::vector<int> indices(static_cast<size_t>(std::max(n_samples, 0)));
+    utils::RandomStream tree_rng = rng_.fork(static_cast<uint64_t>(tree_index));
+    tree_rng.fill_below(indices.data(), indices.size(), static_cast<uint32_t>(n_samples));
+    return indices;
+}
+
+// FeatureBins implementation
+FeatureBins::FeatureBins(const Matrix& X, int max_bins)
+    : rows_(X.rows()), cols_(X.cols()), codes_(static_cast<size_t>(X.rows() * X.cols())),
+      edges_(static_cast<size_t>(X.cols())) {
+    max_bins = std::min(std::max(max_bins, 2), kMaxBins);
+    const double per_bin = static_cast<double>(rows_) / max_bins;
+    utils::parallel_for(0, cols_, 1, [&](Index f0, Index f1) {
+        static thread_local std::vector<double> values;
+        values.resize(static_cast<size_t>(rows_));
+        for (Index f = f0; f < f1; ++f) {
+            for (Index r = 0; r < rows_; ++r) values[static_cast<size_t>(r)] = X.data()[r * cols_ + f];
+            std::sort(values.begin(), values.end());
+            Index distinct = rows_ > 0 ? 1 : 0;
+            for (Index i = 1; i < rows_; ++i) distinct += values[static_cast<size_t>(i - 1)] < values[static_cast<size_t>(i)];
+            
+            // Cut between distinct values: at every change when they all fit, otherwise
+            // at the first change past each quantile
+            std::vector<double>& edges = edges_[static_cast<size_t>(f)];
+            edges.clear();
+            for (Index i = 1; i < rows_ && static_cast<int>(edges.size()) + 1 < max_bins; ++i) {
+                const double a = values[static_cast<size_t>(i - 1)];
+                const double b = values[static_cast<size_t>(i)];
+                if (!(a < b)) continue;
+                if (distinct > max_bins && static_cast<double>(i) < static_cast<double>(edges.size() + 1) * per_bin) {
+                    continue;
+                }
+                // Midpoint, kept strictly below b as in the exact search
+                const double edge = a + (b - a) * 0.5;
+                edges.push_back(edge < b ? edge : a);
+            }
+            
+            uint8_t* codes = codes_.data() + f * rows_;
+            for (Index r = 0; r < rows_; ++r) {
+                const double x = X.data()[r * cols_ + f];
+                codes[r] = static_cast<uint8_t>(std::lower_bound(edges.begin(), edges.end(), x) - edges.begin());
+            }
+        }
+    });
 }
 
-Eigen::MatrixXd NeuralNetwork::forward_pass(const Eigen::MatrixXd& input) {
-    return input;
+size_t FeatureBins::bytes() const {
+    size_t total = codes_.size();
+    for (const auto& edges : edges_) total += edges.size() * sizeof(double);
+    return total;
 }
 
-void NeuralNetwork::backward_pass(const Eigen::MatrixXd& input, const Eigen::MatrixXd& target) {
-    // Stub implementation
+// DecisionTree implementation
+namespace {
+
+// Smallest squared-error reduction worth a split
+constexpr double kMinSplitGain = 1e-12;
+
+} // namespace
+
+DecisionTree::DecisionTree(int max_depth, int min_samples_split, int min_samples_leaf)
+    : max_depth_(max_depth), min_samples_split_(min_samples_split), min_samples_leaf_(min_samples_leaf) {
 }
 
-void NeuralNetwork::update_parameters() {
-    // Stub implementation
+void DecisionTree::fit(const Matrix& X, const Vector& y) {
+    std::vector<int> rows(static_cast<size_t>(X.rows()));
+    std::iota(rows.begin(), rows.end(), 0);
+    fit(X, y, std::move(rows));
 }
 
-std::vector<std::pair<Eigen::MatrixXd, Eigen::MatrixXd>> NeuralNetwork::create_batches(const Eigen::MatrixXd& X, const Eigen::MatrixXd& y) {
-    return {};
+void DecisionTree::fit(const Matrix& X, const Vector& y, std::vector<int> rows) {
+    if (y.size() != X.rows()) {
+        std::cout << "❌ Decision tree needs one target per row, got " << y.size() << " for " << X.rows() << std::endl;
+        return;
+    }
+    reset(X.cols());
+    if (rows.empty()) return;
+    // The row list is partitioned in place as the tree grows
+    build_node(X, y, rows.data(), static_cast<Index>(rows.size()), 0);
 }
 
-// RandomForest implementation
-RandomForest::RandomForest(int n_estimators, int max_depth, int min_samples_split, int min_samples_leaf)
-    : n_estimators_(n_estimators), max_depth_(max_depth), 
-      min_samples_split_(min_samples_split), min_samples_leaf_(min_samples_leaf) {
+void DecisionTree::fit(const FeatureBins& bins, const Vector& y) {
+    std::vector<int> rows(static_cast<size_t>(bins.rows()));
+    std::iota(rows.begin(), rows.end(), 0);
+    fit(bins, y, std::move(rows));
 }
 
-void RandomForest::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
-    std::cout << "Training Random Forest with " << n_estimators_ << " trees" << std::endl;
+void DecisionTree::fit(const FeatureBins& bins, const Vector& y, std::vector<int> rows) {
+    if (y.size() != bins.rows()) {
+        std::cout << "❌ Decision tree needs one target per row, got " << y.size() << " for " << bins.rows()
+                  << std::endl;
+        return;
+    }
+    reset(bins.cols());
+    if (rows.empty()) return;
+    build_binned_node(bins, y, rows.data(), static_cast<Index>(rows.size()), 0);
+}
+
+void DecisionTree::reset(Index features) {
+    mapping_.reset();
+    mapped_nodes_ = nullptr;
+    mapped_count_ = 0;
+    nodes_.clear();
+    n_features_ = static_cast<int>(features);
+    feature_gains_.assign(static_cast<size_t>(features), 0.0);
+    feature_splits_.assign(static_cast<size_t>(features), 0);
+}
+
+void DecisionTree::add_split_importance(const TreeNode* nodes, size_t index) {
+    // With node values the means of their samples, the SSE reduction of a split is
+    // n_l m_l^2 + n_r m_r^2 - n m^2, the gain the split search maximized
+    const TreeNode& node = nodes[index];
+    const TreeNode& left = nodes[index + 1];
+    const TreeNode& right = nodes[static_cast<size_t>(node.right)];
+    const double gain = left.weight * left.value * left.value + right.weight * right.value * right.value -
+                        node.weight * node.value * node.value;
+    feature_gains_[static_cast<size_t>(node.feature)] += std::max(gain, 0.0);
+    ++feature_splits_[static_cast<size_t>(node.feature)];
+}
+
+int32_t DecisionTree::add_node(const Vector& y, const int* rows, Index count, int depth, bool& split) {
+    Accumulator sum = 0.0;
+    for (Index i = 0; i < count; ++i) sum += y[rows[i]];
+    const int32_t index = static_cast<int32_t>(nodes_.size());
+    nodes_.push_back({-1, -1, 0.0, sum / static_cast<Accumulator>(count), static_cast<double>(count)});
+    split = count >= std::max(min_samples_split_, 2) && (max_depth_ <= 0 || depth < max_depth_);
+    return index;
+}
+
+int32_t DecisionTree::build_node(const Matrix& X, const Vector& y, int* rows, Index count, int depth) {
+    bool split = false;
+    const int32_t index = add_node(y, rows, count, depth, split);
+    if (!split) return index;
+    
+    int feature = -1;
+    double threshold = 0.0;
+    if (!find_best_split(X, y, rows, count, feature, threshold)) return index;
+    const Scalar* data = X.data();
+    const Index cols = X.cols();
+    int* middle = std::partition(rows, rows + count, [&](int r) {
+        return static_cast<double>(data[r * cols + feature]) <= threshold;
+    });
+    const Index left = middle - rows;
+    if (left == 0 || left == count) return index;
+    
+    // nodes_ may reallocate while the children are built, so write through the index
+    nodes_[static_cast<size_t>(index)].feature = feature;
+    nodes_[static_cast<size_t>(index)].threshold = threshold;
+    build_node(X, y, rows, left, depth + 1);
+    const int32_t right = build_node(X, y, middle, count - left, depth + 1);
+    nodes_[static_cast<size_t>(index)].right = right;
+    add_split_importance(nodes_.data(), static_cast<size_t>(index));
+    return index;
+}
+
+bool DecisionTree::find_best_split(const Matrix& X, const Vector& y, const int* rows, Index count,
+                                   int& best_feature, double& best_threshold) const {
+    struct Candidate {
+        double gain;
+        double threshold;
+    };
+    const Index features = X.cols();
+    const Index min_leaf = std::max(min_samples_leaf_, 1);
+    Accumulator total = 0.0;
+    for (Index i = 0; i < count; ++i) total += y[rows[i]];
+    const double parent = total * total / static_cast<double>(count);
+    
+    // SSE reduction of a split = sum_l^2 / n_l + sum_r^2 / n_r - sum^2 / n, scanned
+    // over each feature's sorted values. Features are searched concurrently and the
+    // best is picked in feature order, so ties do not depend on the thread count.
+    std::vector<Candidate> candidates(static_cast<size_t>(features), Candidate{0.0, 0.0});
+    utils::parallel_for(0, features, 1, [&](Index f0, Index f1) {
+        static thread_local std::vector<std::pair<Scalar, Scalar>> pairs;
+        pairs.resize(static_cast<size_t>(count));
+        for (Index f = f0; f < f1; ++f) {
+            for (Index i = 0; i < count; ++i) {
+                pairs[static_cast<size_t>(i)] = {X.data()[rows[i] * features + f], y[rows[i]]};
+            }
+            std::sort(pairs.begin(), pairs.end(),
+                      [](const std::pair<Scalar, Scalar>& a, const std::pair<Scalar, Scalar>& b) {
+                          return a.first < b.first;
+                      });
+            Candidate& best = candidates[static_cast<size_t>(f)];
+            Accumulator left = 0.0;
+            for (Index i = 0; i + 1 < count; ++i) {
+                left += pairs[static_cast<size_t>(i)].second;
+                const Index n_left = i + 1;
+                const double a = pairs[static_cast<size_t>(i)].first;
+                const double b = pairs[static_cast<size_t>(i + 1)].first;
+                if (!(a < b) || n_left < min_leaf || count - n_left < min_leaf) continue;
+                const Accumulator right = total - left;
+                const double gain = left * left / static_cast<double>(n_left) +
+                                    right * right / static_cast<double>(count - n_left) - parent;
+                if (gain > best.gain) {
+                    // Midpoint, kept strictly below b so b goes right
+                    const double threshold = a + (b - a) * 0.5;
+                    best = {gain, threshold < b ? threshold : a};
+                }
+            }
+        }
+    });
+    
+    best_feature = -1;
+    double best_gain = kMinSplitGain;
+    for (Index f = 0; f < features; ++f) {
+        if (candidates[static_cast<size_t>(f)].gain > best_gain) {
+            best_gain = candidates[static_cast<size_t>(f)].gain;
+            best_feature = static_cast<int>(f);
+            best_threshold = candidates[static_cast<size_t>(f)].threshold;
+        }
+    }
+    return best_feature >= 0;
 }
 
-Eigen::VectorXd RandomForest::predict(const Eigen::MatrixXd& X) {
-    return Eigen::VectorXd();
+int32_t DecisionTree::build_binned_node(const FeatureBins& bins, const Vector& y, int* rows, Index count, int depth) {
+    bool split = false;
+    const int32_t index = add_node(y, rows, count, depth, split);
+    if (!split) return index;
+    
+    int feature = -1;
+    int bin = 0;
+    if (!find_best_binned_split(bins, y, rows, count, feature, bin)) return index;
+    const uint8_t* codes = bins.codes(feature);
+    int* middle = std::partition(rows, rows + count, [&](int r) { return codes[r] <= bin; });
+    const Index left = middle - rows;
+    if (left == 0 || left == count) return index;
+    
+    nodes_[static_cast<size_t>(index)].feature = feature;
+    nodes_[static_cast<size_t>(index)].threshold = bins.edge(feature, bin);
+    build_binned_node(bins, y, rows, left, depth + 1);
+    const int32_t right = build_binned_node(bins, y, middle, count - left, depth + 1);
+    nodes_[static_cast<size_t>(index)].right = right;
+    add_split_importance(nodes_.data(), static_cast<size_t>(index));
+    return index;
+}
+
+bool DecisionTree::find_best_binned_split(const FeatureBins& bins, const Vector& y, const int* rows, Index count,
+                                          int& best_feature, int& best_bin) const {
+    struct Candidate {
+        double gain;
+        int bin;
+    };
+    const Index features = bins.cols();
+    const Index min_leaf = std::max(min_samples_leaf_, 1);
+    // The node's targets in row order, read once per feature
+    std::vector<Scalar> targets(static_cast<size_t>(count));
+    Accumulator total = 0.0;
+    for (Index i = 0; i < count; ++i) {
+        targets[static_cast<size_t>(i)] = y[rows[i]];
+        total += targets[static_cast<size_t>(i)];
+    }
+    const double parent = total * total / static_cast<double>(count);
+    
+    // The same gain as the exact search, scanned over cumulative per-bin sums
+    std::vector<Candidate> candidates(static_cast<size_t>(features), Candidate{0.0, 0});
+    utils::parallel_for(0, features, 1, [&](Index f0, Index f1) {
+        Accumulator sums[FeatureBins::kMaxBins];
+        Index counts[FeatureBins::kMaxBins];
+        for (Index f = f0; f < f1; ++f) {
+            const int bin_count = bins.bin_count(f);
+            if (bin_count < 2) continue;
+            std::fill_n(sums, bin_count, Accumulator(0));
+            std::fill_n(counts, bin_count, Index(0));
+            const uint8_t* codes = bins.codes(f);
+            for (Index i = 0; i < count; ++i) {
+                const uint8_t b = codes[rows[i]];
+                sums[b] += targets[static_cast<size_t>(i)];
+                ++counts[b];
+            }
+            Candidate& best = candidates[static_cast<size_t>(f)];
+            Accumulator left = 0.0;
+            Index n_left = 0;
+            for (int b = 0; b + 1 < bin_count; ++b) {
+                left += sums[b];
+                n_left += counts[b];
+                if (counts[b] == 0 || n_left < min_leaf || count - n_left < min_leaf) continue;
+                const Accumulator right = total - left;
+                const double gain = left * left / static_cast<double>(n_left) +
+                                    right * right / static_cast<double>(count - n_left) - parent;
+                if (gain > best.gain) best = {gain, b};
+            }
+        }
+    });
+    
+    best_feature = -1;
+    double best_gain = kMinSplitGain;
+    for (Index f = 0; f < features; ++f) {
+        if (candidates[static_cast<size_t>(f)].gain > best_gain) {
+            best_gain = candidates[static_cast<size_t>(f)].gain;
+            best_feature = static_cast<int>(f);
+            best_bin = candidates[static_cast<size_t>(f)].bin;
+        }
+    }
+    return best_feature >= 0;
 }
 
-double RandomForest::evaluate(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
-    return 0.0;
+double DecisionTree::predict_row(const Scalar* x) const {
+    const TreeNode* node = nodes();
+    if (node_count() == 0) return 0.0;
+    int32_t i = 0;
+    while (node[i].feature >= 0) {
+        i = static_cast<double>(x[node[i].feature]) <= node[i].threshold ? i + 1 : node[i].right;
+    }
+    return node[i].value;
 }
 
-Eigen::VectorXd RandomForest::get_feature_importance() const {
-    return Eigen::VectorXd();
+Vector DecisionTree::predict(const Matrix& X) const {
+    if (node_count() > 0 && X.cols() != n_features_) {
+        std::cout << "❌ Decision tree expects " << n_features_ << " features, got " << X.cols() << std::endl;
+        return Vector();
+    }
+    const Index cols = X.cols();
+    Vector predictions(X.rows());
+    utils::parallel_for(0, X.rows(), 1024, [&](Index r0, Index r1) {
+        for (Index r = r0; r < r1; ++r) predictions[r] = static_cast<Scalar>(predict_row(X.data() + r * cols));
+    });
+    return predictions;
+}
+
+bool DecisionTree::attach(const TreeNode* nodes, size_t count, int n_features,
+                          std::shared_ptr<const MappedModel> mapping) {
+    // Children always follow their parent, so a checked tree cannot loop
+    for (size_t i = 0; i < count; ++i) {
+        const TreeNode& node = nodes[i];
+        if (node.feature < 0) continue;
+        if (node.feature >= n_features || i + 1 >= count || node.right <= static_cast<int64_t>(i) + 1 ||
+            static_cast<size_t>(node.right) >= count) {
+            return false;
+        }
+    }
+    nodes_.clear();
+    nodes_.shrink_to_fit();
+    mapped_nodes_ = nodes;
+    mapped_count_ = count;
+    mapping_ = std::move(mapping);
+    n_features_ = n_features;
+    // Files hold no importances; the node statistics give them back
+    feature_gains_.assign(static_cast<size_t>(n_features), 0.0);
+    feature_splits_.assign(static_cast<size_t>(n_features), 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (nodes[i].feature >= 0) add_split_importance(nodes, i);
+    }
+    return true;
 }
 
-std::vector<int> RandomForest::bootstrap_sample_indices(int n_samples) {
-    return {};
+bool DecisionTree::save_model(const std::string& filepath) const {
+    TreeModelMeta meta{};
+    meta.max_depth = max_depth_;
+    meta.min_samples_split = min_samples_split_;
+    meta.min_samples_leaf = min_samples_leaf_;
+    meta.n_features = n_features_;
+    meta.tree_count = 1;
+    return write_tree_model(filepath, ModelKind::DECISION_TREE, meta, {this});
 }
 
-// DecisionTree implementation
-DecisionTree::DecisionTree(int max_depth, int min_samples_split, int min_samples_leaf)
-    : max_depth_(max_depth), min_samples_split_(min_samples_split), min_samples_leaf_(min_samples_leaf) {
+bool DecisionTree::load_model(const std::string& filepath) {
+    TreeModelMeta meta{};
+    std::vector<std::unique_ptr<DecisionTree>> trees;
+    if (!map_tree_model(filepath, ModelKind::DECISION_TREE, meta, trees)) return false;
+    if (trees.size() != 1) {
+        std::cout << "❌ Model file " << filepath << " does not hold exactly one tree" << std::endl;
+        return false;
+    }
+    *this = std::move(*trees.front());
+    return true;
 }
 
-void DecisionTree::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
-    // Stub implementation
+// GradientBoosting implementation
+GradientBoosting::GradientBoosting(int n_estimators, double learning_rate, int max_depth)
+    : n_estimators_(n_estimators), learning_rate_(learning_rate), max_depth_(max_depth) {
 }
 
-Eigen::VectorXd DecisionTree::predict(const Eigen::MatrixXd& X) {
-    return Eigen::VectorXd();
+void GradientBoosting::fit(const Matrix& X, const Vector& y, const Matrix& X_val, const Vector& y_val) {
+    fit_rows(X, y, nullptr, X_val, y_val);
 }
 
-std::unique_ptr<DecisionTree::Node> DecisionTree::build_tree(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, int depth) {
-    return nullptr;
+void GradientBoosting::fit(const Matrix& X, const Vector& y, const std::vector<int>& rows) {
+    fit_rows(X, y, &rows, Matrix(), Vector());
 }
 
-double DecisionTree::find_best_split(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, int& best_feature, double& best_threshold) {
-    return 0.0;
+void GradientBoosting::fit_rows(const Matrix& X, const Vector& y, const std::vector<int>* rows, const Matrix& X_val,
+                                const Vector& y_val) {
+    std::cout << "Training Gradient Boosting with " << n_estimators_ << " estimators" << std::endl;
+    trees_.clear();
+    validation_scores_.clear();
+    initial_prediction_ = Vector();
+    if (y.size() != X.rows() || X.rows() == 0) {
+        std::cout << "❌ Gradient Boosting needs one target per row, got " << y.size() << " for " << X.rows()
+                  << std::endl;
+        return;
+    }
+    const bool validate = X_val.rows() > 0;
+    if (validate && (X_val.cols() != X.cols() || y_val.size() != X_val.rows())) {
+        std::cout << "❌ Validation data does not match the training data" << std::endl;
+        return;
+    }
+    
+    if (rows && rows->empty()) {
+        std::cout << "❌ Gradient Boosting needs at least one training row" << std::endl;
+        return;
+    }
+    Accumulator total = 0.0;
+    if (rows) {
+        for (int r : *rows) total += y[r];
+    } else {
+        total = utils::simd::sum(y.data(), static_cast<size_t>(y.size()));
+    }
+    const Scalar base = static_cast<Scalar>(total / static_cast<double>(rows ? rows->size() : y.size()));
+    initial_prediction_ = Vector(1);
+    initial_prediction_[0] = base;
+    
+    // Running ensemble outputs; each round adds one tree's leaf values to them. With a
+    // row list only its rows are kept up to date; the trees never read the others.
+    Vector predictions(X.rows());
+    std::fill_n(predictions.data(), predictions.size(), base);
+    Vector gradients;
+    Vector validation_predictions, validation_residuals;
+    if (validate) {
+        validation_predictions.resize(X_val.rows());
+        std::fill_n(validation_predictions.data(), validation_predictions.size(), base);
+    }
+    
+    const bool binned = bins_ && bins_->rows() == X.rows() && bins_->cols() == X.cols();
+    if (bins_ && !binned) std::cout << "⚠️ Feature bins do not match the training rows; using exact splits" << std::endl;
+    double best_score = std::numeric_limits<double>::infinity();
+    size_t best_trees = 0;
+    trees_.reserve(static_cast<size_t>(std::max(n_estimators_, 0)));
+    for (int round = 0; round < n_estimators_; ++round) {
+        calculate_gradients(y, predictions, gradients);
+        auto tree = std::make_unique<DecisionTree>(max_depth_);
+        if (binned && rows) {
+            tree->fit(*bins_, gradients, *rows);
+        } else if (binned) {
+            tree->fit(*bins_, gradients);
+        } else if (rows) {
+            tree->fit(X, gradients, *rows);
+        } else {
+            tree->fit(X, gradients);
+        }
+        add_tree_output(*tree, X, predictions, rows);
+        if (validate) add_tree_output(*tree, X_val, validation_predictions);
+        trees_.push_back(std::move(tree));
+        if (!validate) continue;
+        
+        const double score = mean_squared_error(y_val, validation_predictions, validation_residuals);
+        validation_scores_.push_back(score);
+        if (score < best_score) {
+            best_score = score;
+            best_trees = trees_.size();
+        } else if (early_stopping_rounds_ > 0 &&
+                   trees_.size() - best_trees >= static_cast<size_t>(early_stopping_rounds_)) {
+            trees_.resize(best_trees);
+            std::cout << "  Early stopping after " << round + 1 << " rounds, best validation MSE " << best_score
+                      << " with " << best_trees << " trees" << std::endl;
+            break;
+        }
+    }
 }
 
-double DecisionTree::calculate_gini(const Eigen::VectorXd& y) {
-    return 0.0;
+Vector GradientBoosting::predict(const Matrix& X) {
+    if (initial_prediction_.size() == 0) {
+        std::cout << "❌ Gradient Boosting is not trained" << std::endl;
+        return Vector();
+    }
+    if (!trees_.empty() && X.cols() != trees_.front()->feature_count()) {
+        std::cout << "❌ Gradient Boosting is trained for " << trees_.front()->feature_count() << " features, got "
+                  << X.cols() << std::endl;
+        return Vector();
+    }
+    Vector predictions;
+    sum_tree_outputs(trees_, X, learning_rate_, initial_prediction_[0], predictions);
+    return predictions;
 }
 
-double DecisionTree::predict_single(const Eigen::VectorXd& x, const Node* node) {
-    return 0.0;
+double GradientBoosting::evaluate(const Matrix& X, const Vector& y) {
+    const Vector predictions = predict(X);
+    if (predictions.size() != y.size() || y.size() == 0) return 0.0;
+    Vector residuals;
+    return mean_squared_error(y, predictions, residuals);
 }
 
-// GradientBoosting implementation
-GradientBoosting::GradientBoosting(int n_estimators, double learning_rate, int max_depth)
-    : n_estimators_(n_estimators), learning_rate_(learning_rate), max_depth_(max_depth) {
+void GradientBoosting::calculate_gradients(const Vector& y_true, const Vector& y_pred, Vector& gradients) const {
+    gradients = y_true;
+    utils::simd::axpy(Scalar(-1), y_pred.data(), gradients.data(), static_cast<size_t>(gradients.size()));
 }
 
-void GradientBoosting::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
-    std::cout << "Training Gradient Boosting with " << n_estimators_ << " estimators" << std::endl;
+void GradientBoosting::add_tree_output(const DecisionTree& tree, const Matrix& X, Vector& predictions,
+                                       const std::vector<int>* rows) const {
+    const Index cols = X.cols();
+    const double rate = learning_rate_;
+    const Index count = rows ? static_cast<Index>(rows->size()) : X.rows();
+    utils::parallel_for(0, count, 1024, [&](Index i0, Index i1) {
+        for (Index i = i0; i < i1; ++i) {
+            const Index r = rows ? (*rows)[static_cast<size_t>(i)] : i;
+            predictions[r] += static_cast<Scalar>(rate * tree.predict_row(X.data() + r * cols));
+        }
+    });
 }
 
-Eigen::VectorXd GradientBoosting::predict(const Eigen::MatrixXd& X) {
-    return Eigen::VectorXd();
+Vector GradientBoosting::get_feature_importance(ImportanceType type) const {
+    return tree_importance(trees_, type);
 }
 
-double GradientBoosting::evaluate(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
-    return 0.0;
+double GradientBoosting::predict_row(const Scalar* x) const {
+    if (initial_prediction_.size() == 0) return 0.0;
+    double sum = 0.0;
+    for (const auto& tree : trees_) sum += tree->predict_row(x);
+    return initial_prediction_[0] + learning_rate_ * sum;
 }
 
-Eigen::VectorXd GradientBoosting::calculate_gradients(const Eigen::VectorXd& y_true, const Eigen::VectorXd& y_pred) {
-    return Eigen::VectorXd();
+double GradientBoosting::mean_squared_error(const Vector& y_true, const Vector& predictions, Vector& residuals) const {
+    calculate_gradients(y_true, predictions, residuals);
+    return utils::simd::squared_norm(residuals.data(), static_cast<size_t>(residuals.size())) /
+           static_cast<double>(std::max<Index>(residuals.size(), 1));
 }
 
 // SVM implementation
@@ -651,32 +3187,32 @@ SVM::SVM(double C, double epsilon, const std::string& kernel)
     : C_(C), epsilon_(epsilon), kernel_(kernel), trained_(false) {
 }
 
-void SVM::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
+void SVM::fit(const Matrix& X, const Vector& y) {
     std::cout << "Training SVM with " << kernel_ << " kernel" << std::endl;
     trained_ = true;
 }
 
-Eigen::VectorXd SVM::predict(const Eigen::MatrixXd& X) {
-    return Eigen::VectorXd();
+Vector SVM::predict(const Matrix& X) {
+    return Vector();
 }
 
-double SVM::evaluate(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
+double SVM::evaluate(const Matrix& X, const Vector& y) {
     return 0.0;
 }
 
-double SVM::kernel_function(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2) {
+double SVM::kernel_function(const Vector& x1, const Vector& x2) {
     return 0.0;
 }
 
-double SVM::rbf_kernel(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2, double gamma) {
+double SVM::rbf_kernel(const Vector& x1, const Vector& x2, double gamma) {
     return 0.0;
 }
 
-double SVM::linear_kernel(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2) {
+double SVM::linear_kernel(const Vector& x1, const Vector& x2) {
     return 0.0;
 }
 
-double SVM::polynomial_kernel(const Eigen::VectorXd& x1, const Eigen::VectorXd& x2, int degree) {
+double SVM::polynomial_kernel(const Vector& x1, const Vector& x2, int degree) {
     return 0.0;
 }
 
@@ -685,29 +3221,83 @@ PCA::PCA(int n_components)
     : n_components_(n_components), fitted_(false) {
 }
 
-void PCA::fit(const Eigen::MatrixXd& X) {
+void PCA::fit(const Matrix& X) {
+    const Index n = X.rows(), d = X.cols();
+    if (n < 2 || d == 0) {
+        std::cout << "❌ PCA needs at least two samples" << std::endl;
+        return;
+    }
+    n_components_ = std::max(1, std::min(n_components_, static_cast<int>(d)));
     std::cout << "Fitting PCA with " << n_components_ << " components" << std::endl;
-    fitted_ = true;
+    
+    // Column means, then the covariance Xc^T Xc / (n - 1) as one TN gemm
+    mean_ = Vector::Zero(d);
+    for (Index i = 0; i < n; ++i) {
+        utils::simd::axpy(Scalar(1), X.data() + i * d, mean_.data(), static_cast<size_t>(d));
+    }
+    mean_ /= static_cast<Scalar>(n);
+    Matrix centered = X;
+    for (Index i = 0; i < n; ++i) {
+        utils::simd::axpy(Scalar(-1), mean_.data(), centered.data() + i * d, static_cast<size_t>(d));
+    }
+    Matrix covariance;
+    Eigen::gemm(Eigen::Trans, Eigen::NoTrans, Scalar(1.0 / (n - 1)), centered, centered, Scalar(0), covariance);
+    
+    compute_eigenvalues_eigenvectors(covariance);
 }
 
-Eigen::MatrixXd PCA::transform(const Eigen::MatrixXd& X) {
-    return X;
+Matrix PCA::transform(const Matrix& X) {
+    if (!fitted_ || X.cols() != mean_.size()) return Matrix();
+    Matrix centered = X;
+    for (Index i = 0; i < X.rows(); ++i) {
+        utils::simd::axpy(Scalar(-1), mean_.data(), centered.data() + i * X.cols(), static_cast<size_t>(X.cols()));
+    }
+    return centered * components_.transpose();
 }
 
-Eigen::MatrixXd PCA::inverse_transform(const Eigen::MatrixXd& X_transformed) {
-    return X_transformed;
+Matrix PCA::inverse_transform(const Matrix& X_transformed) {
+    if (!fitted_ || X_transformed.cols() != components_.rows()) return Matrix();
+    Matrix restored = X_transformed * components_;
+    for (Index i = 0; i < restored.rows(); ++i) {
+        utils::simd::axpy(Scalar(1), mean_.data(), restored.data() + i * restored.cols(), static_cast<size_t>(restored.cols()));
+    }
+    return restored;
 }
 
 double PCA::explained_variance_ratio(int component) const {
-    return 0.0;
+    if (!fitted_ || component < 0 || component >= explained_variance_.size() || total_variance_ <= 0) return 0.0;
+    return explained_variance_[component] / total_variance_;
 }
 
-Eigen::VectorXd PCA::get_explained_variance_ratio() const {
-    return Eigen::VectorXd();
+Vector PCA::get_explained_variance_ratio() const {
+    Vector ratios(explained_variance_.size());
+    for (Index i = 0; i < ratios.size(); ++i) {
+        ratios[i] = static_cast<Scalar>(explained_variance_ratio(static_cast<int>(i)));
+    }
+    return ratios;
 }
 
-void PCA::compute_eigenvalues_eigenvectors(const Eigen::MatrixXd& covariance_matrix) {
-    // Stub implementation
+void PCA::compute_eigenvalues_eigenvectors(const Matrix& covariance_matrix) {
+    Eigen::SelfAdjointEigenSolver<Scalar> solver(covariance_matrix);
+    if (solver.info() != Eigen::Success) {
+        std::cout << "❌ PCA eigendecomposition did not converge" << std::endl;
+        fitted_ = false;
+        return;
+    }
+    
+    // Eigenvalues come out ascending; components_ keeps the largest as rows
+    const Index d = covariance_matrix.rows();
+    const Matrix& vectors = solver.eigenvectors();
+    components_.resize(n_components_, d);
+    explained_variance_.resize(n_components_);
+    total_variance_ = 0.0;
+    for (Index i = 0; i < d; ++i) total_variance_ += std::max<double>(0.0, solver.eigenvalues()[i]);
+    for (int k = 0; k < n_components_; ++k) {
+        const Index src = d - 1 - k;
+        explained_variance_[k] = std::max(Scalar(0), solver.eigenvalues()[src]);
+        for (Index j = 0; j < d; ++j) components_(k, j) = vectors(j, src);
+    }
+    fitted_ = true;
 }
 
 // Autoencoder implementation
@@ -716,19 +3306,19 @@ Autoencoder::Autoencoder(int input_dim, int encoding_dim, const std::vector<int>
     build_networks(input_dim, encoding_dim, hidden_layers);
 }
 
-void Autoencoder::fit(const Eigen::MatrixXd& X, int epochs) {
+void Autoencoder::fit(const Matrix& X, int epochs) {
     std::cout << "Training Autoencoder for " << epochs << " epochs" << std::endl;
 }
 
-Eigen::MatrixXd Autoencoder::encode(const Eigen::MatrixXd& X) {
+Matrix Autoencoder::encode(const Matrix& X) {
     return X;
 }
 
-Eigen::MatrixXd Autoencoder::decode(const Eigen::MatrixXd& encoded) {
+Matrix Autoencoder::decode(const Matrix& encoded) {
     return encoded;
 }
 
-Eigen::MatrixXd Autoencoder::reconstruct(const Eigen::MatrixXd& X) {
+Matrix Autoencoder::reconstruct(const Matrix& X) {
     return X;
 }
 
@@ -806,8 +3396,8 @@ double XGBoost::evaluate(const Matrix& X, const Vector& y) {
     return 0.0;
 }
 
-Vector XGBoost::get_feature_importance() const {
-    return Vector();
+Vector XGBoost::get_feature_importance(ImportanceType type) const {
+    return tree_importance(trees_, type);
 }
 
 void XGBoost::set_early_stopping(bool enable, int rounds) {
@@ -872,8 +3462,8 @@ double LightGBM::evaluate(const Matrix& X, const Vector& y) {
     return 0.0;
 }
 
-Vector LightGBM::get_feature_importance() const {
-    return Vector();
+Vector LightGBM::get_feature_importance(ImportanceType type) const {
+    return tree_importance(trees_, type);
 }
 
 void LightGBM::set_categorical_features(const std::vector<int>& categorical_features) {
@@ -929,8 +3519,8 @@ double CatBoost::evaluate(const Matrix& X, const Vector& y) {
     return 0.0;
 }
 
-Vector CatBoost::get_feature_importance() const {
-    return Vector();
+Vector CatBoost::get_feature_importance(ImportanceType type) const {
+    return tree_importance(trees_, type);
 }
 
 void CatBoost::set_categorical_features(const std::vector<int>& categorical_features) {
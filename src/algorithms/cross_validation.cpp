@@ -0,0 +1,348 @@
+#include "../../include/algorithms/cross_validation.h"
+#include "../../include/utils/parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <numeric>
+
+namespace dds {
+namespace algorithms {
+
+namespace {
+
+// Validation rows are scored in blocks with one partial sum each, added in order
+constexpr Index kScoreBlock = 1024;
+
+// Fold f validates on the rows assigned to it and trains on the rest
+std::vector<Fold> folds_from_assignment(const std::vector<int>& fold_of, int folds) {
+    std::vector<Fold> result(static_cast<size_t>(folds));
+    for (auto& fold : result) {
+        fold.train.reserve(fold_of.size() - fold_of.size() / static_cast<size_t>(folds));
+    }
+    for (size_t r = 0; r < fold_of.size(); ++r) {
+        for (int f = 0; f < folds; ++f) {
+            auto& rows = f == fold_of[r] ? result[static_cast<size_t>(f)].validation : result[static_cast<size_t>(f)].train;
+            rows.push_back(static_cast<int>(r));
+        }
+    }
+    return result;
+}
+
+bool check_folds(int rows, int folds) {
+    if (folds < 2 || folds > rows) {
+        std::cout << "❌ Cross-validation needs 2 to " << rows << " folds, got " << folds << std::endl;
+        return false;
+    }
+    return true;
+}
+
+Matrix gather_features(const Matrix& X, const std::vector<int>& rows) {
+    const Index cols = X.cols();
+    Matrix result(static_cast<Index>(rows.size()), cols);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        std::copy_n(X.data() + static_cast<Index>(rows[i]) * cols, cols, result.data() + static_cast<Index>(i) * cols);
+    }
+    return result;
+}
+
+Vector gather_targets(const Vector& y, const std::vector<int>& rows) {
+    Vector result(static_cast<Index>(rows.size()));
+    for (size_t i = 0; i < rows.size(); ++i) result[static_cast<Index>(i)] = y[rows[i]];
+    return result;
+}
+
+// Mean over the validation rows of loss(row); loss is called concurrently
+template<typename Loss>
+double mean_validation_loss(const FoldView& fold, Loss loss) {
+    const auto& rows = fold.validation_rows();
+    const Index n = static_cast<Index>(rows.size());
+    if (n == 0) return 0.0;
+    const Index blocks = (n + kScoreBlock - 1) / kScoreBlock;
+    std::vector<double> partials(static_cast<size_t>(blocks), 0.0);
+    utils::parallel_for(0, blocks, 1, [&](Index b0, Index b1) {
+        for (Index b = b0; b < b1; ++b) {
+            double total = 0.0;
+            for (Index i = b * kScoreBlock; i < std::min(n, (b + 1) * kScoreBlock); ++i) {
+                total += loss(rows[static_cast<size_t>(i)]);
+            }
+            partials[static_cast<size_t>(b)] = total;
+        }
+    });
+    return std::accumulate(partials.begin(), partials.end(), 0.0) / static_cast<double>(n);
+}
+
+// Squared error of a model with predict_row over the validation rows
+template<typename Model>
+double validation_mse(const Model& model, const FoldView& fold) {
+    const Matrix& X = fold.features();
+    const Vector& y = fold.targets();
+    return mean_validation_loss(fold, [&](int r) {
+        const double error = model.predict_row(X.data() + static_cast<Index>(r) * X.cols()) - y[r];
+        return error * error;
+    });
+}
+
+double reconstruction_mse(const Matrix& X, const Matrix& reconstruction) {
+    if (reconstruction.rows() != X.rows() || reconstruction.cols() != X.cols() || X.size() == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    double total = 0.0;
+    for (Index i = 0; i < X.size(); ++i) {
+        const double error = static_cast<double>(reconstruction.data()[i]) - X.data()[i];
+        total += error * error;
+    }
+    return total / static_cast<double>(X.size());
+}
+
+// Two-sided 95% Student t quantiles for 1..30 degrees of freedom
+constexpr double kStudentT95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                  2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                  2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+} // namespace
+
+// Splits
+std::vector<Fold> kfold_split(int rows, int folds, bool shuffle, uint64_t seed) {
+    if (!check_folds(rows, folds)) return {};
+    std::vector<int> order(static_cast<size_t>(rows));
+    std::iota(order.begin(), order.end(), 0);
+    if (shuffle) {
+        utils::RandomStream rng(seed);
+        utils::shuffle(order.begin(), order.end(), rng);
+    }
+    std::vector<int> fold_of(static_cast<size_t>(rows));
+    for (int f = 0; f < folds; ++f) {
+        const size_t begin = static_cast<size_t>(static_cast<long long>(rows) * f / folds);
+        const size_t end = static_cast<size_t>(static_cast<long long>(rows) * (f + 1) / folds);
+        for (size_t i = begin; i < end; ++i) fold_of[static_cast<size_t>(order[i])] = f;
+    }
+    return folds_from_assignment(fold_of, folds);
+}
+
+std::vector<Fold> stratified_kfold_split(const Vector& labels, int folds, uint64_t seed) {
+    const int rows = static_cast<int>(labels.size());
+    if (!check_folds(rows, folds)) return {};
+    std::map<double, std::vector<int>> by_label;
+    for (int r = 0; r < rows; ++r) by_label[static_cast<double>(labels[r])].push_back(r);
+
+    // The deal continues across labels, so fold sizes differ by at most one row
+    utils::RandomStream rng(seed);
+    std::vector<int> fold_of(static_cast<size_t>(rows));
+    int next = 0;
+    for (auto& entry : by_label) {
+        utils::shuffle(entry.second.begin(), entry.second.end(), rng);
+        for (int r : entry.second) {
+            fold_of[static_cast<size_t>(r)] = next;
+            next = (next + 1) % folds;
+        }
+    }
+    return folds_from_assignment(fold_of, folds);
+}
+
+std::vector<Fold> group_kfold_split(const Vector& groups, int folds) {
+    const int rows = static_cast<int>(groups.size());
+    if (!check_folds(rows, folds)) return {};
+    std::map<double, std::vector<int>> by_group;
+    for (int r = 0; r < rows; ++r) by_group[static_cast<double>(groups[r])].push_back(r);
+    if (by_group.size() < static_cast<size_t>(folds)) {
+        std::cout << "❌ Group k-fold needs at least " << folds << " groups, got " << by_group.size() << std::endl;
+        return {};
+    }
+
+    std::vector<const std::vector<int>*> members;
+    members.reserve(by_group.size());
+    for (const auto& entry : by_group) members.push_back(&entry.second);
+    std::stable_sort(members.begin(), members.end(),
+                     [](const std::vector<int>* a, const std::vector<int>* b) { return a->size() > b->size(); });
+
+    std::vector<int> fold_of(static_cast<size_t>(rows));
+    std::vector<size_t> fold_rows(static_cast<size_t>(folds), 0);
+    for (const auto* group : members) {
+        const size_t f = static_cast<size_t>(std::min_element(fold_rows.begin(), fold_rows.end()) - fold_rows.begin());
+        for (int r : *group) fold_of[static_cast<size_t>(r)] = static_cast<int>(f);
+        fold_rows[f] += group->size();
+    }
+    return folds_from_assignment(fold_of, folds);
+}
+
+// FoldView implementation
+const Matrix& FoldView::train_features() const {
+    gather_train();
+    return train_features_;
+}
+
+const Vector& FoldView::train_targets() const {
+    gather_train();
+    return train_targets_;
+}
+
+const Matrix& FoldView::validation_features() const {
+    gather_validation();
+    return validation_features_;
+}
+
+const Vector& FoldView::validation_targets() const {
+    gather_validation();
+    return validation_targets_;
+}
+
+void FoldView::gather_train() const {
+    if (train_gathered_) return;
+    train_features_ = gather_features(X_, fold_.train);
+    train_targets_ = gather_targets(y_, fold_.train);
+    copied_bytes_ += static_cast<size_t>(train_features_.size() + train_targets_.size()) * sizeof(Scalar);
+    train_gathered_ = true;
+}
+
+void FoldView::gather_validation() const {
+    if (validation_gathered_) return;
+    validation_features_ = gather_features(X_, fold_.validation);
+    validation_targets_ = gather_targets(y_, fold_.validation);
+    copied_bytes_ += static_cast<size_t>(validation_features_.size() + validation_targets_.size()) * sizeof(Scalar);
+    validation_gathered_ = true;
+}
+
+// Model scoring
+double fit_and_score(DecisionTree& model, const FoldView& fold) {
+    model.fit(fold.features(), fold.targets(), fold.train_rows());
+    return validation_mse(model, fold);
+}
+
+double fit_and_score(RandomForest& model, const FoldView& fold) {
+    model.fit(fold.features(), fold.targets(), fold.train_rows());
+    return validation_mse(model, fold);
+}
+
+double fit_and_score(GradientBoosting& model, const FoldView& fold) {
+    model.fit(fold.features(), fold.targets(), fold.train_rows());
+    return validation_mse(model, fold);
+}
+
+double fit_and_score(LogisticRegression& model, const FoldView& fold) {
+    if (!model.fit(fold.features(), fold.targets(), fold.train_rows())) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return model.evaluate(fold.features(), fold.targets(), fold.validation_rows());
+}
+
+double fit_and_score(NeuralNetwork& model, const FoldView& fold) {
+    // The network trains on a target matrix, so the target column is copied once;
+    // validation rows are scored a block at a time
+    const Matrix& X = fold.features();
+    const Vector& y = fold.targets();
+    Matrix targets(y.size(), 1);
+    std::copy_n(y.data(), y.size(), targets.data());
+    fold.add_copied_bytes(static_cast<size_t>(targets.size()) * sizeof(Scalar));
+    model.fit(X, targets, fold.train_rows(), fold.epochs());
+
+    const auto& rows = fold.validation_rows();
+    if (rows.empty()) return 0.0;
+    double total = 0.0;
+    std::vector<int> block;
+    for (size_t start = 0; start < rows.size(); start += static_cast<size_t>(kScoreBlock)) {
+        block.assign(rows.begin() + static_cast<std::ptrdiff_t>(start),
+                     rows.begin() + static_cast<std::ptrdiff_t>(std::min(rows.size(), start + kScoreBlock)));
+        const Matrix inputs = gather_features(X, block);
+        Matrix block_targets(static_cast<Index>(block.size()), 1);
+        for (size_t i = 0; i < block.size(); ++i) block_targets(static_cast<Index>(i), 0) = y[block[i]];
+        total += model.evaluate(inputs, block_targets) * static_cast<double>(block.size());
+    }
+    return total / static_cast<double>(rows.size());
+}
+
+double fit_and_score(PCA& model, const FoldView& fold) {
+    model.fit(fold.train_features());
+    const Matrix& validation = fold.validation_features();
+    return reconstruction_mse(validation, model.inverse_transform(model.transform(validation)));
+}
+
+double fit_and_score(Autoencoder& model, const FoldView& fold) {
+    model.fit(fold.train_features(), fold.epochs());
+    const Matrix& validation = fold.validation_features();
+    return reconstruction_mse(validation, model.reconstruct(validation));
+}
+
+// Aggregation
+MetricSummary summarize(const std::vector<double>& values) {
+    MetricSummary summary;
+    if (values.empty()) return summary;
+    const double n = static_cast<double>(values.size());
+    summary.mean = std::accumulate(values.begin(), values.end(), 0.0) / n;
+    summary.ci_low = summary.ci_high = summary.mean;
+    if (values.size() < 2) return summary;
+    double squares = 0.0;
+    for (double value : values) squares += (value - summary.mean) * (value - summary.mean);
+    summary.stddev = std::sqrt(squares / (n - 1.0));
+    const size_t df = values.size() - 1;
+    const double t = df <= 30 ? kStudentT95[df - 1] : 1.96;
+    const double half_width = t * summary.stddev / std::sqrt(n);
+    summary.ci_low = summary.mean - half_width;
+    summary.ci_high = summary.mean + half_width;
+    return summary;
+}
+
+// CrossValidator implementation
+CrossValidationReport CrossValidator::run_folds(const Matrix& X, const Vector& y,
+                                                const std::function<double(const FoldView&)>& score) const {
+    CrossValidationReport report;
+    if (folds_.empty()) {
+        std::cout << "❌ Cross-validation has no folds" << std::endl;
+        return report;
+    }
+    if (y.size() != X.rows()) {
+        std::cout << "❌ Cross-validation needs one target per row, got " << y.size() << " for " << X.rows()
+                  << std::endl;
+        return report;
+    }
+    for (const auto& fold : folds_) {
+        const auto out_of_range = [&](int r) { return r < 0 || r >= X.rows(); };
+        if (fold.train.empty() || fold.validation.empty() ||
+            std::any_of(fold.train.begin(), fold.train.end(), out_of_range) ||
+            std::any_of(fold.validation.begin(), fold.validation.end(), out_of_range)) {
+            std::cout << "❌ Cross-validation folds need training and validation rows within the " << X.rows()
+                      << " rows" << std::endl;
+            return report;
+        }
+    }
+
+    const Index folds = static_cast<Index>(folds_.size());
+    const size_t workers = utils::max_threads();
+    report.folds_concurrent = workers > 1 && (parallelism_ == FoldParallelism::FOLDS ||
+                                              (parallelism_ == FoldParallelism::AUTO &&
+                                               static_cast<size_t>(folds) >= workers));
+    report.fold_scores.assign(folds_.size(), 0.0);
+    report.fold_seconds.assign(folds_.size(), 0.0);
+    std::vector<size_t> copied(folds_.size(), 0);
+
+    const auto run_fold = [&](Index f) {
+        const auto start = std::chrono::steady_clock::now();
+        FoldView view(X, y, folds_[static_cast<size_t>(f)], static_cast<int>(f), epochs_);
+        double value = score(view);
+        if (std::isnan(value)) value = std::numeric_limits<double>::infinity();
+        report.fold_scores[static_cast<size_t>(f)] = value;
+        copied[static_cast<size_t>(f)] = view.copied_bytes();
+        report.fold_seconds[static_cast<size_t>(f)] =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    if (report.folds_concurrent) {
+        // Kernels called from inside a fold see a nested parallel_for and run inline
+        utils::parallel_for(0, folds, 1, [&](Index f0, Index f1) {
+            for (Index f = f0; f < f1; ++f) run_fold(f);
+        });
+    } else {
+        for (Index f = 0; f < folds; ++f) run_fold(f);
+    }
+    report.total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    report.copied_bytes = std::accumulate(copied.begin(), copied.end(), size_t(0));
+    report.score = summarize(report.fold_scores);
+    report.seconds = summarize(report.fold_seconds);
+    return report;
+}
+
+} // namespace algorithms
+} // namespace dds
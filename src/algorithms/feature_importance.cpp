@@ -0,0 +1,347 @@
+#include "../../include/algorithms/feature_importance.h"
+#include "../../include/utils/parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+namespace dds {
+namespace algorithms {
+
+namespace {
+
+constexpr Index kRowBlock = 256;
+// TreeSHAP keeps a rows x features sum per block
+constexpr Index kExplainBlock = 64;
+
+// Amount each path feature adds to its SHAP value, per unit of leaf output, given the
+// features' zero fractions and whether the row falls inside each feature's interval.
+// For feature k the amount is (hot_k - zero_k) times the Shapley-weighted sum over
+// subsets S of the other hot features of the product of the zero fractions of the
+// other features outside S. Those sums are the coefficients of
+// prod_j (zero_j + hot_j t) with feature k's factor divided out.
+void path_shares(const double* zero, const uint8_t* hot, int d, double* out, std::vector<double>& poly,
+                 std::vector<double>& quotient) {
+    poly.assign(static_cast<size_t>(d) + 1, 0.0);
+    quotient.resize(static_cast<size_t>(d) + 1);
+    poly[0] = 1.0;
+    int degree = 0;
+    for (int j = 0; j < d; ++j) {
+        if (hot[j]) {
+            for (int s = degree + 1; s > 0; --s) poly[s] = poly[s] * zero[j] + poly[s - 1];
+            poly[0] *= zero[j];
+            ++degree;
+        } else {
+            for (int s = 0; s <= degree; ++s) poly[s] *= zero[j];
+        }
+    }
+    for (int k = 0; k < d; ++k) {
+        int q_degree = degree;
+        if (hot[k]) {
+            // Synthetic division by (zero_k + t), from the top coefficient down
+            q_degree = degree - 1;
+            if (q_degree >= 0) quotient[q_degree] = poly[degree];
+            for (int s = q_degree; s > 0; --s) quotient[s - 1] = poly[s] - zero[k] * quotient[s];
+        } else {
+            for (int s = 0; s <= degree; ++s) quotient[s] = poly[s] / zero[k];
+        }
+        // Shapley weight s! (d - 1 - s)! / d! of a subset of s of the other d - 1 features
+        double weight = 1.0 / d;
+        double total = 0.0;
+        for (int s = 0; s <= q_degree; ++s) {
+            total += quotient[s] * weight;
+            weight *= static_cast<double>(s + 1) / static_cast<double>(d - 1 - s);
+        }
+        out[k] = ((hot[k] ? 1.0 : 0.0) - zero[k]) * total;
+    }
+}
+
+} // namespace
+
+// Block predictors
+BlockPredictor block_predictor(const DecisionTree& tree) {
+    return [&tree](const Scalar* rows, Index count, Index cols, double* out) {
+        for (Index i = 0; i < count; ++i) out[i] = tree.predict_row(rows + i * cols);
+    };
+}
+
+BlockPredictor block_predictor(const RandomForest& forest) {
+    // Trees outer, so each tree's nodes stay in cache over the block
+    return [&forest](const Scalar* rows, Index count, Index cols, double* out) {
+        std::fill_n(out, count, 0.0);
+        const size_t trees = forest.tree_count();
+        for (size_t t = 0; t < trees; ++t) {
+            const DecisionTree& tree = forest.get_tree(t);
+            for (Index i = 0; i < count; ++i) out[i] += tree.predict_row(rows + i * cols);
+        }
+        if (trees > 0) {
+            for (Index i = 0; i < count; ++i) out[i] /= static_cast<double>(trees);
+        }
+    };
+}
+
+BlockPredictor block_predictor(const GradientBoosting& model) {
+    return [&model](const Scalar* rows, Index count, Index cols, double* out) {
+        std::fill_n(out, count, 0.0);
+        for (size_t t = 0; t < model.tree_count(); ++t) {
+            const DecisionTree& tree = model.get_tree(t);
+            for (Index i = 0; i < count; ++i) out[i] += tree.predict_row(rows + i * cols);
+        }
+        for (Index i = 0; i < count; ++i) out[i] = model.base_prediction() + model.learning_rate() * out[i];
+    };
+}
+
+// Permutation importance
+PermutationImportance permutation_importance(const BlockPredictor& predict, const Matrix& X, const Vector& y,
+                                             int repeats, uint64_t seed) {
+    PermutationImportance result;
+    const Index n = X.rows();
+    const Index d = X.cols();
+    if (n == 0 || y.size() != n) {
+        std::cout << "❌ Permutation importance needs one target per row, got " << y.size() << " for " << n
+                  << std::endl;
+        return result;
+    }
+    repeats = std::max(repeats, 1);
+
+    // Unpermuted rows are predicted straight from X
+    const Index blocks = (n + kRowBlock - 1) / kRowBlock;
+    std::vector<double> partials(static_cast<size_t>(blocks), 0.0);
+    utils::parallel_for(0, blocks, 1, [&](Index b0, Index b1) {
+        double out[kRowBlock];
+        for (Index b = b0; b < b1; ++b) {
+            const Index r0 = b * kRowBlock;
+            const Index count = std::min(kRowBlock, n - r0);
+            predict(X.data() + r0 * d, count, d, out);
+            double total = 0.0;
+            for (Index i = 0; i < count; ++i) total += (out[i] - y[r0 + i]) * (out[i] - y[r0 + i]);
+            partials[static_cast<size_t>(b)] = total;
+        }
+    });
+    result.baseline_loss = std::accumulate(partials.begin(), partials.end(), 0.0) / static_cast<double>(n);
+
+    const Index tasks = d * repeats;
+    const utils::RandomStream root(seed);
+    std::vector<double> losses(static_cast<size_t>(tasks), 0.0);
+    utils::parallel_for(0, tasks, 1, [&](Index t0, Index t1) {
+        static thread_local std::vector<Scalar> block;
+        static thread_local std::vector<int> order;
+        block.resize(static_cast<size_t>(kRowBlock * d));
+        double out[kRowBlock];
+        for (Index t = t0; t < t1; ++t) {
+            const Index feature = t / repeats;
+            utils::RandomStream rng = root.fork(static_cast<uint64_t>(t));
+            order = utils::permutation(static_cast<int>(n), rng);
+            double total = 0.0;
+            for (Index r0 = 0; r0 < n; r0 += kRowBlock) {
+                const Index count = std::min(kRowBlock, n - r0);
+                std::copy_n(X.data() + r0 * d, count * d, block.data());
+                for (Index i = 0; i < count; ++i) {
+                    block[static_cast<size_t>(i * d + feature)] = X(order[static_cast<size_t>(r0 + i)], feature);
+                }
+                predict(block.data(), count, d, out);
+                for (Index i = 0; i < count; ++i) total += (out[i] - y[r0 + i]) * (out[i] - y[r0 + i]);
+            }
+            losses[static_cast<size_t>(t)] = total / static_cast<double>(n);
+        }
+    });
+
+    result.mean = Vector::Zero(d);
+    result.stddev = Vector::Zero(d);
+    for (Index f = 0; f < d; ++f) {
+        const double* feature_losses = losses.data() + f * repeats;
+        double mean = 0.0;
+        for (int r = 0; r < repeats; ++r) mean += feature_losses[r] - result.baseline_loss;
+        mean /= repeats;
+        double squares = 0.0;
+        for (int r = 0; r < repeats; ++r) {
+            const double delta = feature_losses[r] - result.baseline_loss - mean;
+            squares += delta * delta;
+        }
+        result.mean[f] = static_cast<Scalar>(mean);
+        result.stddev[f] = static_cast<Scalar>(repeats > 1 ? std::sqrt(squares / (repeats - 1)) : 0.0);
+    }
+    return result;
+}
+
+namespace {
+
+bool check_features(int model_features, Index features) {
+    if (model_features != features) {
+        std::cout << "❌ Model is trained for " << model_features << " features, got " << features << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+PermutationImportance permutation_importance(const DecisionTree& tree, const Matrix& X, const Vector& y, int repeats,
+                                             uint64_t seed) {
+    if (!check_features(tree.feature_count(), X.cols())) return PermutationImportance();
+    return permutation_importance(block_predictor(tree), X, y, repeats, seed);
+}
+
+PermutationImportance permutation_importance(const RandomForest& forest, const Matrix& X, const Vector& y,
+                                             int repeats, uint64_t seed) {
+    const int features = forest.tree_count() > 0 ? forest.get_tree(0).feature_count() : 0;
+    if (!check_features(features, X.cols())) return PermutationImportance();
+    return permutation_importance(block_predictor(forest), X, y, repeats, seed);
+}
+
+PermutationImportance permutation_importance(const GradientBoosting& model, const Matrix& X, const Vector& y,
+                                             int repeats, uint64_t seed) {
+    const int features = model.tree_count() > 0 ? model.get_tree(0).feature_count() : 0;
+    if (!check_features(features, X.cols())) return PermutationImportance();
+    return permutation_importance(block_predictor(model), X, y, repeats, seed);
+}
+
+// TreeExplainer implementation
+TreeExplainer::TreeExplainer(const DecisionTree& tree) {
+    add_tree(tree, 1.0);
+}
+
+TreeExplainer::TreeExplainer(const RandomForest& forest) {
+    const size_t trees = forest.tree_count();
+    for (size_t t = 0; t < trees; ++t) add_tree(forest.get_tree(t), 1.0 / static_cast<double>(trees));
+}
+
+TreeExplainer::TreeExplainer(const GradientBoosting& model) {
+    expected_value_ = model.base_prediction();
+    for (size_t t = 0; t < model.tree_count(); ++t) add_tree(model.get_tree(t), model.learning_rate());
+}
+
+void TreeExplainer::add_tree(const DecisionTree& tree, double weight) {
+    const TreeNode* nodes = tree.nodes();
+    if (tree.node_count() == 0) return;
+    features_ = std::max<Index>(features_, tree.feature_count());
+    expected_value_ += weight * nodes[0].value;
+
+    // Depth-first over the preorder nodes, merging repeated features into one
+    // condition on the way down and restoring them on the way up
+    std::vector<Condition> path;
+    std::vector<double> zero;
+    std::vector<uint8_t> hot;
+    std::vector<double> shares, poly, quotient;
+    const auto visit = [&](const auto& self, size_t index) -> void {
+        const TreeNode& node = nodes[index];
+        if (node.feature < 0) {
+            if (path.empty()) return;
+            const int d = static_cast<int>(path.size());
+            Path leaf{static_cast<uint32_t>(conditions_.size()), static_cast<uint32_t>(d), weight * node.value, -1};
+            conditions_.insert(conditions_.end(), path.begin(), path.end());
+            if (d <= kTableFeatures) {
+                leaf.table = static_cast<int64_t>(tables_.size());
+                zero.resize(static_cast<size_t>(d));
+                hot.resize(static_cast<size_t>(d));
+                shares.resize(static_cast<size_t>(d));
+                for (int k = 0; k < d; ++k) zero[k] = path[static_cast<size_t>(k)].zero_fraction;
+                for (uint32_t mask = 0; mask < (1u << d); ++mask) {
+                    for (int k = 0; k < d; ++k) hot[k] = static_cast<uint8_t>((mask >> k) & 1u);
+                    path_shares(zero.data(), hot.data(), d, shares.data(), poly, quotient);
+                    for (int k = 0; k < d; ++k) tables_.push_back(leaf.value * shares[k]);
+                }
+            }
+            paths_.push_back(leaf);
+            return;
+        }
+        const size_t children[2] = {index + 1, static_cast<size_t>(node.right)};
+        for (int side = 0; side < 2; ++side) {
+            const TreeNode& child = nodes[children[side]];
+            auto it = std::find_if(path.begin(), path.end(), [&](const Condition& c) { return c.feature == node.feature; });
+            const bool added = it == path.end();
+            if (added) {
+                path.push_back({node.feature, -std::numeric_limits<double>::infinity(),
+                                std::numeric_limits<double>::infinity(), 1.0});
+                it = path.end() - 1;
+            }
+            const Condition saved = *it;
+            if (side == 0) {
+                it->high = std::min(it->high, node.threshold);
+            } else {
+                it->low = std::max(it->low, node.threshold);
+            }
+            it->zero_fraction *= node.weight > 0.0 ? child.weight / node.weight : 0.0;
+            const size_t position = static_cast<size_t>(it - path.begin());
+            self(self, children[side]);
+            if (added) {
+                path.pop_back();
+            } else {
+                path[position] = saved;
+            }
+        }
+    };
+    visit(visit, 0);
+}
+
+Matrix TreeExplainer::shap_values(const Matrix& X) const {
+    const Index n = X.rows();
+    const Index cols = X.cols();
+    if (cols < features_) {
+        std::cout << "❌ TreeExplainer needs " << features_ << " features, got " << cols << std::endl;
+        return Matrix();
+    }
+    Matrix result = Matrix::Zero(n, features_);
+    const Index blocks = (n + kExplainBlock - 1) / kExplainBlock;
+    utils::parallel_for(0, blocks, 1, [&](Index b0, Index b1) {
+        static thread_local std::vector<double> sums;
+        static thread_local std::vector<double> zero, shares, poly, quotient;
+        static thread_local std::vector<uint8_t> hot;
+        sums.resize(static_cast<size_t>(kExplainBlock * features_));
+        for (Index b = b0; b < b1; ++b) {
+            const Index r0 = b * kExplainBlock;
+            const Index count = std::min(kExplainBlock, n - r0);
+            std::fill_n(sums.data(), count * features_, 0.0);
+            // Paths outer, so each path's conditions and table are read once per block
+            for (const Path& leaf : paths_) {
+                const Condition* conditions = conditions_.data() + leaf.first;
+                const int d = static_cast<int>(leaf.count);
+                if (leaf.table >= 0) {
+                    // Held in locals: the sums could alias the conditions for the compiler
+                    Index feature[kTableFeatures];
+                    double low[kTableFeatures], high[kTableFeatures];
+                    for (int k = 0; k < d; ++k) {
+                        feature[k] = conditions[k].feature;
+                        low[k] = conditions[k].low;
+                        high[k] = conditions[k].high;
+                    }
+                    const double* table = tables_.data() + leaf.table;
+                    for (Index i = 0; i < count; ++i) {
+                        const Scalar* x = X.data() + (r0 + i) * cols;
+                        uint32_t mask = 0;
+                        for (int k = 0; k < d; ++k) {
+                            const double value = x[feature[k]];
+                            mask |= static_cast<uint32_t>(low[k] < value && value <= high[k]) << k;
+                        }
+                        const double* amounts = table + static_cast<size_t>(mask) * static_cast<size_t>(d);
+                        double* out = sums.data() + i * features_;
+                        for (int k = 0; k < d; ++k) out[feature[k]] += amounts[k];
+                    }
+                    continue;
+                }
+                zero.resize(static_cast<size_t>(d));
+                hot.resize(static_cast<size_t>(d));
+                shares.resize(static_cast<size_t>(d));
+                for (int k = 0; k < d; ++k) zero[k] = conditions[k].zero_fraction;
+                for (Index i = 0; i < count; ++i) {
+                    const Scalar* x = X.data() + (r0 + i) * cols;
+                    for (int k = 0; k < d; ++k) {
+                        const double value = x[conditions[k].feature];
+                        hot[k] = static_cast<uint8_t>(conditions[k].low < value && value <= conditions[k].high);
+                    }
+                    path_shares(zero.data(), hot.data(), d, shares.data(), poly, quotient);
+                    double* out = sums.data() + i * features_;
+                    for (int k = 0; k < d; ++k) out[conditions[k].feature] += leaf.value * shares[k];
+                }
+            }
+            for (Index i = 0; i < count * features_; ++i) {
+                result.data()[r0 * features_ + i] = static_cast<Scalar>(sums[static_cast<size_t>(i)]);
+            }
+        }
+    });
+    return result;
+}
+
+} // namespace algorithms
+} // namespace dds
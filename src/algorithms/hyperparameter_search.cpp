@@ -0,0 +1,459 @@
+#include "../../include/algorithms/hyperparameter_search.h"
+#include "../../include/algorithms/advanced_algorithms.h"
+#include "../../include/algorithms/logistic_regression.h"
+#include "../../include/utils/parallel.h"
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace dds {
+namespace algorithms {
+
+double get_parameter(const HyperParameters& parameters, const std::string& name, double fallback) {
+    const auto it = parameters.find(name);
+    return it != parameters.end() ? it->second : fallback;
+}
+
+// SearchSpace implementation
+void SearchSpace::add_choice(const std::string& name, std::vector<double> values) {
+    if (values.empty()) {
+        std::cout << "❌ Search dimension " << name << " has no values" << std::endl;
+        return;
+    }
+    Dimension dimension;
+    dimension.name = name;
+    dimension.values = std::move(values);
+    dimensions_.push_back(std::move(dimension));
+}
+
+void SearchSpace::add_range(const std::string& name, double low, double high, bool log_scale) {
+    if (!(low <= high) || (log_scale && low <= 0.0)) {
+        std::cout << "❌ Search dimension " << name << " has an invalid range [" << low << ", " << high << "]"
+                  << std::endl;
+        return;
+    }
+    Dimension dimension;
+    dimension.name = name;
+    dimension.low = low;
+    dimension.high = high;
+    dimension.log_scale = log_scale;
+    dimensions_.push_back(std::move(dimension));
+}
+
+void SearchSpace::add_int_range(const std::string& name, int low, int high) {
+    add_range(name, low, high);
+    if (!dimensions_.empty() && dimensions_.back().name == name) dimensions_.back().integer = true;
+}
+
+namespace {
+
+// Point at fraction t of a range dimension
+double range_point(const SearchSpace::Dimension& dimension, double t) {
+    double value = dimension.log_scale
+                       ? std::exp(std::log(dimension.low) + t * (std::log(dimension.high) - std::log(dimension.low)))
+                       : dimension.low + t * (dimension.high - dimension.low);
+    if (dimension.integer) value = std::round(value);
+    return std::min(std::max(value, dimension.low), dimension.high);
+}
+
+} // namespace
+
+HyperParameters SearchSpace::sample(utils::RandomStream& rng) const {
+    HyperParameters parameters;
+    for (const Dimension& dimension : dimensions_) {
+        if (!dimension.values.empty()) {
+            parameters[dimension.name] = dimension.values[rng.below(static_cast<uint32_t>(dimension.values.size()))];
+        } else if (dimension.integer) {
+            // Every integer equally likely, ends included
+            const double count = dimension.high - dimension.low + 1.0;
+            parameters[dimension.name] = dimension.low + std::floor(rng.uniform() * count);
+        } else {
+            parameters[dimension.name] = range_point(dimension, rng.uniform());
+        }
+    }
+    return parameters;
+}
+
+std::vector<HyperParameters> SearchSpace::grid(int points_per_range) const {
+    std::vector<std::vector<double>> axes;
+    for (const Dimension& dimension : dimensions_) {
+        std::vector<double> axis = dimension.values;
+        if (axis.empty()) {
+            const int points = std::max(points_per_range, 1);
+            for (int i = 0; i < points; ++i) {
+                const double value = range_point(dimension, points == 1 ? 0.5 : static_cast<double>(i) / (points - 1));
+                // Integer ranges narrower than the grid would repeat points
+                if (axis.empty() || value != axis.back()) axis.push_back(value);
+            }
+        }
+        axes.push_back(std::move(axis));
+    }
+
+    std::vector<HyperParameters> combinations(1);
+    for (size_t d = 0; d < axes.size(); ++d) {
+        std::vector<HyperParameters> next;
+        next.reserve(combinations.size() * axes[d].size());
+        for (const HyperParameters& partial : combinations) {
+            for (double value : axes[d]) {
+                next.push_back(partial);
+                next.back()[dimensions_[d].name] = value;
+            }
+        }
+        combinations.swap(next);
+    }
+    return combinations;
+}
+
+// TuningData implementation
+TuningData::TuningData(const Matrix& X, const Vector& y, double validation_fraction, uint64_t seed) {
+    if (y.size() != X.rows() || X.rows() < 2) {
+        std::cout << "❌ Tuning data needs one target per row and at least two rows, got " << y.size() << " for "
+                  << X.rows() << std::endl;
+        return;
+    }
+    const Index rows = X.rows();
+    const Index cols = X.cols();
+    const Index held_out = std::min(rows - 1, std::max<Index>(1, static_cast<Index>(
+                                                                     std::llround(validation_fraction * rows))));
+    utils::RandomStream rng(seed);
+    const std::vector<int> order = utils::permutation(static_cast<int>(rows), rng);
+
+    auto gather = [&](Index first, Index count, Matrix& features, Vector& targets) {
+        features = Matrix(count, cols);
+        targets = Vector(count);
+        for (Index i = 0; i < count; ++i) {
+            const Index r = order[static_cast<size_t>(first + i)];
+            std::copy_n(X.data() + r * cols, cols, features.data() + i * cols);
+            targets[i] = y[r];
+        }
+    };
+    gather(0, rows - held_out, train_features_, train_targets_);
+    gather(rows - held_out, held_out, validation_features_, validation_targets_);
+}
+
+TuningData::TuningData(Matrix X_train, Vector y_train, Matrix X_val, Vector y_val)
+    : train_features_(std::move(X_train)), train_targets_(std::move(y_train)),
+      validation_features_(std::move(X_val)), validation_targets_(std::move(y_val)) {
+}
+
+std::shared_ptr<const FeatureBins> TuningData::feature_bins() const {
+    std::call_once(bins_once_, [this]() { bins_ = std::make_shared<const FeatureBins>(train_features_); });
+    return bins_;
+}
+
+// Built-in objectives
+TrialObjective gradient_boosting_objective() {
+    return [](const HyperParameters& parameters, int budget, const TuningData& data) {
+        GradientBoosting model(budget, get_parameter(parameters, "learning_rate", 0.1),
+                               static_cast<int>(get_parameter(parameters, "max_depth", 3)));
+        model.set_feature_bins(data.feature_bins());
+        model.fit(data.train_features(), data.train_targets());
+        return model.evaluate(data.validation_features(), data.validation_targets());
+    };
+}
+
+TrialObjective random_forest_objective() {
+    return [](const HyperParameters& parameters, int budget, const TuningData& data) {
+        RandomForest model(budget, static_cast<int>(get_parameter(parameters, "max_depth", 10)), 2,
+                           static_cast<int>(get_parameter(parameters, "min_samples_leaf", 1)));
+        // Every configuration draws the same bootstrap samples, so they differ only in
+        // their parameters
+        model.set_seed(utils::RandomStream::kDefaultSeed);
+        model.set_feature_bins(data.feature_bins());
+        model.fit(data.train_features(), data.train_targets());
+        return model.evaluate(data.validation_features(), data.validation_targets());
+    };
+}
+
+TrialObjective logistic_regression_objective() {
+    return [](const HyperParameters& parameters, int budget, const TuningData& data) {
+        const double strength = get_parameter(parameters, "regularization_strength", 0.0);
+        LogisticRegressionParams params{Matrix(), Vector(), 0.0, budget, 1e-6, strength > 0.0, strength, 0};
+        LogisticRegression model(params, get_parameter(parameters, "l1", 0.0) > 0.5 ? LogisticPenalty::L1
+                                                                                    : LogisticPenalty::L2);
+        if (!model.fit(data.train_features(), data.train_targets())) return std::numeric_limits<double>::infinity();
+        return model.evaluate(data.validation_features(), data.validation_targets());
+    };
+}
+
+// HyperparameterSearch implementation
+namespace {
+
+const char* strategy_name(SearchStrategy strategy) {
+    switch (strategy) {
+        case SearchStrategy::GRID: return "grid";
+        case SearchStrategy::RANDOM: return "random";
+        case SearchStrategy::ASHA: return "asha";
+        case SearchStrategy::HYPERBAND: return "hyperband";
+    }
+    return "unknown";
+}
+
+std::string parameters_json(const HyperParameters& parameters) {
+    std::ostringstream out;
+    out.precision(10);
+    out << "{";
+    bool first = true;
+    for (const auto& entry : parameters) {
+        out << (first ? "" : ", ") << "\"" << entry.first << "\": " << entry.second;
+        first = false;
+    }
+    out << "}";
+    return out.str();
+}
+
+std::string trial_json(const TrialResult& trial) {
+    std::ostringstream out;
+    out.precision(10);
+    out << "{\"score\": ";
+    if (std::isfinite(trial.score)) {
+        out << trial.score;
+    } else {
+        out << "null";
+    }
+    out << ", \"budget\": " << trial.budget << ", \"bracket\": " << trial.bracket << ", \"rung\": " << trial.rung
+        << ", \"seconds\": " << trial.seconds << ", \"stopped\": " << (trial.stopped ? "true" : "false") << "}";
+    return out.str();
+}
+
+} // namespace
+
+HyperparameterSearch::HyperparameterSearch(SearchSpace space, TrialObjective objective, SearchStrategy strategy)
+    : space_(std::move(space)), objective_(std::move(objective)), strategy_(strategy) {
+}
+
+void HyperparameterSearch::set_budget(int min_budget, int max_budget, int eta) {
+    max_budget_ = std::max(max_budget, 1);
+    min_budget_ = std::min(std::max(min_budget, 1), max_budget_);
+    eta_ = std::max(eta, 2);
+}
+
+void HyperparameterSearch::set_experiment_database(std::shared_ptr<database::DatabaseManager> database,
+                                                   const std::string& name) {
+    database_ = std::move(database);
+    name_ = name;
+}
+
+bool HyperparameterSearch::run(const TuningData& data) {
+    results_.clear();
+    best_ = -1;
+    budget_used_ = 0;
+    seconds_ = 0.0;
+    if (!objective_ || data.train_features().rows() == 0) {
+        std::cout << "❌ Hyperparameter search needs an objective and training data" << std::endl;
+        return false;
+    }
+
+    std::vector<HyperParameters> configurations;
+    if (strategy_ == SearchStrategy::GRID) {
+        configurations = space_.grid(grid_points_);
+    } else {
+        // Configuration i comes from its own stream, whatever the strategy or order
+        const utils::RandomStream rng(seed_);
+        for (int i = 0; i < trials_; ++i) {
+            utils::RandomStream trial_rng = rng.fork(static_cast<uint64_t>(i));
+            configurations.push_back(space_.sample(trial_rng));
+        }
+    }
+    for (size_t i = 0; i < configurations.size(); ++i) {
+        results_.push_back({static_cast<int>(i), std::move(configurations[i]), 0, 0, 0,
+                            std::numeric_limits<double>::infinity(), 0.0, false});
+    }
+
+    std::cout << "🔍 " << strategy_name(strategy_) << " search over " << results_.size() << " configurations on "
+              << utils::max_threads() << " workers" << std::endl;
+    record_start();
+    const auto start = std::chrono::steady_clock::now();
+    switch (strategy_) {
+        case SearchStrategy::GRID:
+        case SearchStrategy::RANDOM:
+            run_full_budget(data);
+            break;
+        case SearchStrategy::ASHA:
+            run_successive_halving(data, 1);
+            break;
+        case SearchStrategy::HYPERBAND:
+            run_successive_halving(data, brackets_);
+            break;
+    }
+    seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Scores are only comparable at the same budget: the best of the largest budget reached
+    int top_budget = 0;
+    for (const TrialResult& trial : results_) {
+        if (std::isfinite(trial.score)) top_budget = std::max(top_budget, trial.budget);
+    }
+    for (const TrialResult& trial : results_) {
+        if (trial.budget == top_budget && std::isfinite(trial.score) &&
+            (best_ < 0 || trial.score < results_[static_cast<size_t>(best_)].score)) {
+            best_ = trial.id;
+        }
+    }
+    record_results();
+    if (best_ < 0) {
+        std::cout << "❌ No configuration of " << name_ << " produced a finite score" << std::endl;
+        return false;
+    }
+    const TrialResult& best = results_[static_cast<size_t>(best_)];
+    std::cout << "✅ Best configuration " << parameters_json(best.parameters) << " scored " << best.score
+              << " with budget " << best.budget << " (" << budget_used_ << " budget units in " << seconds_ << " s)"
+              << std::endl;
+    return true;
+}
+
+double HyperparameterSearch::evaluate(const TuningData& data, int id, int budget) {
+    TrialResult& trial = results_[static_cast<size_t>(id)];
+    const auto start = std::chrono::steady_clock::now();
+    double score = objective_(trial.parameters, budget, data);
+    trial.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (std::isnan(score)) score = std::numeric_limits<double>::infinity();
+    return score;
+}
+
+void HyperparameterSearch::run_full_budget(const TuningData& data) {
+    // One configuration per task: the model kernels inside run inline on its worker
+    utils::parallel_for(0, static_cast<Index>(results_.size()), 1, [&](Index t0, Index t1) {
+        for (Index t = t0; t < t1; ++t) {
+            TrialResult& trial = results_[static_cast<size_t>(t)];
+            trial.score = evaluate(data, static_cast<int>(t), max_budget_);
+            trial.budget = max_budget_;
+        }
+    });
+    budget_used_ = static_cast<long long>(results_.size()) * max_budget_;
+}
+
+void HyperparameterSearch::run_successive_halving(const TuningData& data, int brackets) {
+    // Rung budgets min_budget * eta^k up to max_budget; bracket s starts at rung s
+    std::vector<int> budgets;
+    for (long long budget = min_budget_;; budget *= eta_) {
+        budgets.push_back(static_cast<int>(std::min<long long>(budget, max_budget_)));
+        if (budget >= max_budget_) break;
+    }
+    const int rungs = static_cast<int>(budgets.size());
+    brackets = std::min(brackets, rungs);
+
+    struct Rung {
+        std::vector<std::pair<double, int>> scores;     // (score, id), ascending
+    };
+    // rung_scores[s][k]: results on rung k of bracket s (budget budgets[s + k])
+    std::vector<std::vector<Rung>> rung_scores(static_cast<size_t>(brackets));
+    for (int s = 0; s < brackets; ++s) rung_scores[static_cast<size_t>(s)].resize(static_cast<size_t>(rungs - s));
+    const int configurations = static_cast<int>(results_.size());
+    std::vector<int> promoted_to(static_cast<size_t>(configurations), 0);
+
+    struct Job {
+        int id;
+        int bracket;
+        int rung;
+    };
+    std::mutex mutex;
+    std::condition_variable reported;
+    int next_configuration = 0;
+    int running = 0;
+
+    // Promotions first, highest rungs first, then a new configuration; waits only when
+    // neither is possible and another trial may still report
+    auto next_job = [&](Job& job) {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            for (int s = 0; s < brackets; ++s) {
+                const auto& bracket = rung_scores[static_cast<size_t>(s)];
+                for (int k = static_cast<int>(bracket.size()) - 2; k >= 0; --k) {
+                    const auto& scores = bracket[static_cast<size_t>(k)].scores;
+                    const size_t top = scores.size() / static_cast<size_t>(eta_);
+                    for (size_t i = 0; i < top; ++i) {
+                        const int id = scores[i].second;
+                        if (promoted_to[static_cast<size_t>(id)] > k) continue;
+                        promoted_to[static_cast<size_t>(id)] = k + 1;
+                        job = {id, s, k + 1};
+                        ++running;
+                        return true;
+                    }
+                }
+            }
+            if (next_configuration < configurations) {
+                job = {next_configuration, next_configuration % brackets, 0};
+                ++next_configuration;
+                ++running;
+                return true;
+            }
+            if (running == 0) return false;
+            reported.wait(lock);
+        }
+    };
+
+    const Index workers = std::min<Index>(static_cast<Index>(utils::max_threads()), configurations);
+    utils::parallel_for(0, workers, 1, [&](Index, Index) {
+        Job job{};
+        while (next_job(job)) {
+            const int budget = budgets[static_cast<size_t>(job.bracket + job.rung)];
+            const double score = evaluate(data, job.id, budget);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& scores = rung_scores[static_cast<size_t>(job.bracket)][static_cast<size_t>(job.rung)].scores;
+            const std::pair<double, int> entry{score, job.id};
+            scores.insert(std::upper_bound(scores.begin(), scores.end(), entry), entry);
+            TrialResult& trial = results_[static_cast<size_t>(job.id)];
+            trial.bracket = job.bracket;
+            trial.rung = job.rung;
+            trial.budget = budget;
+            trial.score = score;
+            budget_used_ += budget;
+            --running;
+            reported.notify_all();
+        }
+    });
+
+    for (TrialResult& trial : results_) trial.stopped = trial.bracket + trial.rung + 1 < rungs;
+}
+
+void HyperparameterSearch::record_start() const {
+    if (!database_) return;
+    std::ostringstream parameters;
+    parameters << "{\"strategy\": \"" << strategy_name(strategy_) << "\", \"configurations\": " << results_.size()
+               << ", \"min_budget\": " << min_budget_ << ", \"max_budget\": " << max_budget_ << ", \"eta\": " << eta_
+               << ", \"brackets\": " << brackets_ << ", \"seed\": " << seed_ << "}";
+    database::ExperimentRecord record{};
+    record.experiment_id = name_;
+    record.experiment_name = name_;
+    record.description = std::string(strategy_name(strategy_)) + " hyperparameter search";
+    record.parameters = parameters.str();
+    record.created_at = std::time(nullptr);
+    record.status = "running";
+    if (!database_->insert_experiment(record)) {
+        std::cout << "⚠️ Could not record experiment " << name_ << std::endl;
+    }
+}
+
+void HyperparameterSearch::record_results() const {
+    if (!database_) return;
+    const time_t now = std::time(nullptr);
+    for (const TrialResult& trial : results_) {
+        database::ExperimentRecord record{};
+        record.experiment_id = name_ + "/trial-" + std::to_string(trial.id);
+        record.experiment_name = name_;
+        record.description = std::string(strategy_name(strategy_)) + " trial";
+        record.parameters = parameters_json(trial.parameters);
+        record.results = trial_json(trial);
+        record.created_at = now;
+        record.completed_at = now;
+        record.status = trial.stopped ? "stopped" : "completed";
+        database_->insert_experiment(record);
+    }
+    std::ostringstream summary;
+    summary.precision(10);
+    summary << "{\"best_trial\": " << best_ << ", \"budget_used\": " << budget_used_ << ", \"seconds\": " << seconds_;
+    if (best_ >= 0) {
+        const TrialResult& best = results_[static_cast<size_t>(best_)];
+        summary << ", \"parameters\": " << parameters_json(best.parameters) << ", \"result\": " << trial_json(best);
+    }
+    summary << "}";
+    database_->update_experiment_results(name_, summary.str(), best_ >= 0 ? "completed" : "failed");
+}
+
+} // namespace algorithms
+} // namespace dds
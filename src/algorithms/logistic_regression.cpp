@@ -0,0 +1,730 @@
+#include "../../include/algorithms/logistic_regression.h"
+#include "../../include/utils/parallel.h"
+#include "../../include/utils/simd.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace dds {
+namespace algorithms {
+
+namespace {
+
+// Rows per gradient partition at least, so small problems stay on one thread
+constexpr Index kMinPartitionRows = 4096;
+// Column entries per chunk of a coordinate descent sum; fixed, so the sums do not
+// depend on the thread count
+constexpr Index kColumnChunk = Index(1) << 14;
+constexpr double kArmijo = 1e-4;
+constexpr double kCoordinateArmijo = 0.01;
+constexpr int kMaxLineSearch = 30;
+
+double sigmoid(double z) {
+    return 1.0 / (1.0 + std::exp(-z));
+}
+
+// log(1 + e^z) without overflow
+double softplus(double z) {
+    return z > 0.0 ? z + std::log1p(std::exp(-z)) : std::log1p(std::exp(z));
+}
+
+inline double row_dot(const double* x, const double* w, Index n) {
+    return utils::simd::dot(x, w, static_cast<size_t>(n));
+}
+
+// Float features widen to the double coefficients
+template<typename T>
+double row_dot(const T* x, const double* w, Index n) {
+    double total = 0.0;
+    for (Index j = 0; j < n; ++j) total += static_cast<double>(x[j]) * w[j];
+    return total;
+}
+
+inline void row_axpy(double a, const double* x, double* g, Index n) {
+    utils::simd::axpy(a, x, g, static_cast<size_t>(n));
+}
+
+template<typename T>
+void row_axpy(double a, const T* x, double* g, Index n) {
+    for (Index j = 0; j < n; ++j) g[j] += a * static_cast<double>(x[j]);
+}
+
+// Column access for coordinate descent: entries (row, value) of one column
+struct DenseColumns {
+    Matrix transposed;              // Features x rows
+
+    Index rows() const { return transposed.cols(); }
+    Index cols() const { return transposed.rows(); }
+    Index size(Index) const { return transposed.cols(); }
+    Index row(Index, Index p) const { return p; }
+    double value(Index j, Index p) const { return transposed.data()[j * transposed.cols() + p]; }
+};
+
+struct SparseColumns {
+    SparseMatrixCSC columns;
+
+    Index rows() const { return columns.rows(); }
+    Index cols() const { return columns.cols(); }
+    Index size(Index j) const { return columns.outerIndexPtr()[j + 1] - columns.outerIndexPtr()[j]; }
+    Index row(Index j, Index p) const { return columns.innerIndexPtr()[columns.outerIndexPtr()[j] + p]; }
+    double value(Index j, Index p) const { return columns.valuePtr()[columns.outerIndexPtr()[j] + p]; }
+};
+
+// Row access for L-BFGS and prediction
+struct DenseRows {
+    const Matrix& X;
+
+    Index rows() const { return X.rows(); }
+    Index cols() const { return X.cols(); }
+    double dot(Index r, const double* w) const { return row_dot(X.data() + r * X.cols(), w, X.cols()); }
+    void axpy(Index r, double a, double* g) const { row_axpy(a, X.data() + r * X.cols(), g, X.cols()); }
+
+    DenseColumns columns() const {
+        // Blocked transpose, so neither side is walked with a large stride for long
+        const Index n = X.rows();
+        const Index d = X.cols();
+        DenseColumns result{Matrix(d, n)};
+        constexpr Index kTile = 64;
+        utils::parallel_for(0, (n + kTile - 1) / kTile, 1, [&](Index t0, Index t1) {
+            for (Index r0 = t0 * kTile; r0 < std::min(n, t1 * kTile); r0 += kTile) {
+                const Index r1 = std::min(n, r0 + kTile);
+                for (Index j0 = 0; j0 < d; j0 += kTile) {
+                    const Index j1 = std::min(d, j0 + kTile);
+                    for (Index r = r0; r < r1; ++r) {
+                        for (Index j = j0; j < j1; ++j) result.transposed.data()[j * n + r] = X.data()[r * d + j];
+                    }
+                }
+            }
+        });
+        return result;
+    }
+};
+
+// A subset of dense rows read in place; row i is X row index[i]
+struct IndexedRows {
+    const Matrix& X;
+    const std::vector<int>& index;
+
+    Index rows() const { return static_cast<Index>(index.size()); }
+    Index cols() const { return X.cols(); }
+    const Scalar* row(Index i) const { return X.data() + static_cast<Index>(index[static_cast<size_t>(i)]) * X.cols(); }
+    double dot(Index i, const double* w) const { return row_dot(row(i), w, X.cols()); }
+    void axpy(Index i, double a, double* g) const { row_axpy(a, row(i), g, X.cols()); }
+
+    // Only the subset is transposed
+    DenseColumns columns() const {
+        const Index n = rows();
+        const Index d = X.cols();
+        DenseColumns result{Matrix(d, n)};
+        utils::parallel_for(0, d, 16, [&](Index j0, Index j1) {
+            for (Index j = j0; j < j1; ++j) {
+                Scalar* out = result.transposed.data() + j * n;
+                for (Index i = 0; i < n; ++i) out[i] = row(i)[j];
+            }
+        });
+        return result;
+    }
+};
+
+struct SparseRows {
+    const SparseMatrixCSR& X;
+
+    Index rows() const { return X.rows(); }
+    Index cols() const { return X.cols(); }
+    double dot(Index r, const double* w) const {
+        double total = 0.0;
+        for (Index p = X.outerIndexPtr()[r]; p < X.outerIndexPtr()[r + 1]; ++p) {
+            total += static_cast<double>(X.valuePtr()[p]) * w[X.innerIndexPtr()[p]];
+        }
+        return total;
+    }
+    void axpy(Index r, double a, double* g) const {
+        for (Index p = X.outerIndexPtr()[r]; p < X.outerIndexPtr()[r + 1]; ++p) {
+            g[X.innerIndexPtr()[p]] += a * static_cast<double>(X.valuePtr()[p]);
+        }
+    }
+
+    SparseColumns columns() const { return SparseColumns{SparseMatrixCSC(X)}; }
+};
+
+// Mean log-loss and its gradient for L-BFGS. theta holds the weight rows (outputs x
+// cols) then the biases; one output is a sigmoid for class 1, more are a softmax.
+template<typename Rows>
+class LossFunction {
+private:
+    const Rows& rows_;
+    const Vector& labels_;
+    Index outputs_;
+    double l2_;
+    Index partitions_;
+    std::vector<double> partials_;  // Per partition: gradient, then the loss
+
+public:
+    LossFunction(const Rows& rows, const Vector& labels, Index outputs, double l2)
+        : rows_(rows), labels_(labels), outputs_(outputs), l2_(l2) {
+        const Index n = rows.rows();
+        partitions_ = std::max<Index>(1, std::min<Index>(static_cast<Index>(utils::max_threads()),
+                                                         (n + kMinPartitionRows - 1) / kMinPartitionRows));
+    }
+
+    double operator()(const std::vector<double>& theta, std::vector<double>& gradient) {
+        const Index n = rows_.rows();
+        const Index d = rows_.cols();
+        const Index k = outputs_;
+        const size_t width = static_cast<size_t>(k * (d + 1));
+        partials_.assign(static_cast<size_t>(partitions_) * (width + 1), 0.0);
+
+        utils::parallel_for(0, partitions_, 1, [&](Index p0, Index p1) {
+            std::vector<double> z(static_cast<size_t>(k));
+            for (Index p = p0; p < p1; ++p) {
+                double* g = partials_.data() + static_cast<size_t>(p) * (width + 1);
+                double loss = 0.0;
+                for (Index r = n * p / partitions_; r < n * (p + 1) / partitions_; ++r) {
+                    const int label = static_cast<int>(labels_[r]);
+                    for (Index c = 0; c < k; ++c) z[c] = rows_.dot(r, theta.data() + c * d) + theta[k * d + c];
+                    if (k == 1) {
+                        // Residual sigmoid(z) - y
+                        const double t = label == 1 ? 1.0 : 0.0;
+                        loss += softplus(z[0]) - t * z[0];
+                        z[0] = sigmoid(z[0]) - t;
+                    } else {
+                        // Residuals softmax(z) - onehot(y)
+                        const double top = *std::max_element(z.begin(), z.end());
+                        double total = 0.0;
+                        for (Index c = 0; c < k; ++c) total += std::exp(z[c] - top);
+                        const double lse = top + std::log(total);
+                        loss += lse - z[label];
+                        for (Index c = 0; c < k; ++c) z[c] = std::exp(z[c] - lse) - (c == label ? 1.0 : 0.0);
+                    }
+                    for (Index c = 0; c < k; ++c) {
+                        if (z[c] == 0.0) continue;
+                        rows_.axpy(r, z[c], g + c * d);
+                        g[k * d + c] += z[c];
+                    }
+                }
+                g[width] = loss;
+            }
+        });
+
+        // Partitions are added in order
+        gradient.assign(width, 0.0);
+        double loss = 0.0;
+        for (Index p = 0; p < partitions_; ++p) {
+            const double* g = partials_.data() + static_cast<size_t>(p) * (width + 1);
+            for (size_t i = 0; i < width; ++i) gradient[i] += g[i];
+            loss += g[width];
+        }
+        const double inv_n = 1.0 / static_cast<double>(std::max<Index>(n, 1));
+        for (double& value : gradient) value *= inv_n;
+        loss *= inv_n;
+        if (l2_ > 0.0) {
+            const size_t weights = static_cast<size_t>(k * d);
+            loss += 0.5 * l2_ * utils::simd::squared_norm(theta.data(), weights);
+            utils::simd::axpy(l2_, theta.data(), gradient.data(), weights);
+        }
+        return loss;
+    }
+};
+
+// Limited-memory BFGS with a backtracking Armijo line search. Stops when the largest
+// gradient component is within tolerance; false if it ran out of iterations or the
+// line search could not make progress.
+template<typename Function>
+bool minimize_lbfgs(Function& f, std::vector<double>& theta, int max_iterations, double tolerance, int history,
+                    int& iterations) {
+    const size_t n = theta.size();
+    std::vector<double> gradient, next_gradient, next(n), direction(n);
+    std::vector<double> s(static_cast<size_t>(history) * n), y(static_cast<size_t>(history) * n);
+    std::vector<double> rho(static_cast<size_t>(history)), alpha(static_cast<size_t>(history));
+    int stored = 0;
+    int newest = -1;
+
+    double loss = f(theta, gradient);
+    auto largest = [](const std::vector<double>& v) {
+        double m = 0.0;
+        for (double x : v) m = std::max(m, std::abs(x));
+        return m;
+    };
+    for (iterations = 0; iterations < max_iterations; ++iterations) {
+        if (largest(gradient) <= tolerance) return true;
+
+        // Two-loop recursion: direction = -H gradient
+        for (size_t i = 0; i < n; ++i) direction[i] = -gradient[i];
+        for (int i = 0; i < stored; ++i) {
+            const int slot = (newest - i + history) % history;
+            const double* si = s.data() + static_cast<size_t>(slot) * n;
+            const double* yi = y.data() + static_cast<size_t>(slot) * n;
+            alpha[slot] = rho[slot] * utils::simd::dot(si, direction.data(), n);
+            utils::simd::axpy(-alpha[slot], yi, direction.data(), n);
+        }
+        if (stored > 0) {
+            const double* sn = s.data() + static_cast<size_t>(newest) * n;
+            const double* yn = y.data() + static_cast<size_t>(newest) * n;
+            utils::simd::scale(utils::simd::dot(sn, yn, n) / utils::simd::squared_norm(yn, n), direction.data(), n);
+        }
+        for (int i = stored - 1; i >= 0; --i) {
+            const int slot = (newest - i + history) % history;
+            const double* si = s.data() + static_cast<size_t>(slot) * n;
+            const double* yi = y.data() + static_cast<size_t>(slot) * n;
+            const double beta = rho[slot] * utils::simd::dot(yi, direction.data(), n);
+            utils::simd::axpy(alpha[slot] - beta, si, direction.data(), n);
+        }
+        double slope = utils::simd::dot(gradient.data(), direction.data(), n);
+        if (slope >= 0.0) {
+            // Not a descent direction: restart from steepest descent
+            for (size_t i = 0; i < n; ++i) direction[i] = -gradient[i];
+            slope = -utils::simd::squared_norm(gradient.data(), n);
+            stored = 0;
+        }
+
+        // Without curvature pairs, the first step is scaled to unit length
+        double step = stored == 0 ? std::min(1.0, 1.0 / std::sqrt(-slope)) : 1.0;
+        double next_loss = 0.0;
+        int tries = 0;
+        for (; tries < kMaxLineSearch; ++tries, step *= 0.5) {
+            for (size_t i = 0; i < n; ++i) next[i] = theta[i] + step * direction[i];
+            next_loss = f(next, next_gradient);
+            if (next_loss <= loss + kArmijo * step * slope) break;
+        }
+        if (tries == kMaxLineSearch) return largest(gradient) <= tolerance;
+
+        newest = (newest + 1) % history;
+        double* sn = s.data() + static_cast<size_t>(newest) * n;
+        double* yn = y.data() + static_cast<size_t>(newest) * n;
+        for (size_t i = 0; i < n; ++i) {
+            sn[i] = next[i] - theta[i];
+            yn[i] = next_gradient[i] - gradient[i];
+        }
+        const double curvature = utils::simd::dot(sn, yn, n);
+        if (curvature > 1e-10 * utils::simd::squared_norm(yn, n)) {
+            rho[newest] = 1.0 / curvature;
+            stored = std::min(stored + 1, history);
+        } else {
+            // Keep the previous pairs; this slot is overwritten next time
+            newest = (newest - 1 + history) % history;
+        }
+        theta.swap(next);
+        gradient.swap(next_gradient);
+        loss = next_loss;
+    }
+    return largest(gradient) <= tolerance;
+}
+
+// Sums f(row, value, a, b) over column j; long columns are split into fixed chunks on
+// the pool and the chunk sums added in order
+template<typename Columns, typename F>
+void column_sums(const Columns& columns, Index j, std::vector<double>& chunks, F f, double& a, double& b) {
+    const Index size = columns.size(j);
+    const Index count = (size + kColumnChunk - 1) / kColumnChunk;
+    a = 0.0;
+    b = 0.0;
+    if (count <= 1) {
+        for (Index p = 0; p < size; ++p) f(columns.row(j, p), columns.value(j, p), a, b);
+        return;
+    }
+    chunks.assign(static_cast<size_t>(2 * count), 0.0);
+    utils::parallel_for(0, count, 1, [&](Index c0, Index c1) {
+        for (Index c = c0; c < c1; ++c) {
+            double ca = 0.0, cb = 0.0;
+            for (Index p = c * kColumnChunk; p < std::min(size, (c + 1) * kColumnChunk); ++p) {
+                f(columns.row(j, p), columns.value(j, p), ca, cb);
+            }
+            chunks[static_cast<size_t>(2 * c)] = ca;
+            chunks[static_cast<size_t>(2 * c + 1)] = cb;
+        }
+    });
+    for (Index c = 0; c < count; ++c) {
+        a += chunks[static_cast<size_t>(2 * c)];
+        b += chunks[static_cast<size_t>(2 * c + 1)];
+    }
+}
+
+// One binary L1 problem by cyclic coordinate descent. weights (cols) and bias are the
+// starting point and the result; targets are 0/1 per row.
+template<typename Columns>
+class CoordinateDescent {
+private:
+    const Columns& columns_;
+    const std::vector<double>& targets_;
+    double l1_;
+    double inv_n_;
+    std::vector<double> margins_;   // X w + b per row
+    std::vector<double> chunks_;
+
+    // Newton step on coordinate value with soft thresholding (lambda = 0 for the bias)
+    // and a backtracking line search on the exact objective; returns the change.
+    // Entries are visited through each(f) with f(row, value).
+    template<typename Each, typename Update>
+    double step(double& value, double lambda, Each each, Update update) {
+        double g = 0.0, h = 0.0;
+        each([&](Index r, double v, double& ga, double& ha) {
+            const double p = sigmoid(margins_[static_cast<size_t>(r)]);
+            ga += v * (p - targets_[static_cast<size_t>(r)]);
+            ha += v * v * p * (1.0 - p);
+        }, g, h);
+        g *= inv_n_;
+        h = std::max(h * inv_n_, 1e-12);
+        double d;
+        if (g + lambda <= h * value) {
+            d = -(g + lambda) / h;
+        } else if (g - lambda >= h * value) {
+            d = -(g - lambda) / h;
+        } else {
+            d = -value;
+        }
+        if (d == 0.0) return 0.0;
+
+        const double expected = g * d + lambda * (std::abs(value + d) - std::abs(value));
+        double scale = 1.0;
+        for (int tries = 0; tries < kMaxLineSearch; ++tries, scale *= 0.5) {
+            const double delta = scale * d;
+            double change = 0.0, unused = 0.0;
+            each([&](Index r, double v, double& ca, double&) {
+                const double m = margins_[static_cast<size_t>(r)];
+                ca += softplus(m + delta * v) - softplus(m) - targets_[static_cast<size_t>(r)] * delta * v;
+            }, change, unused);
+            change = change * inv_n_ + lambda * (std::abs(value + delta) - std::abs(value));
+            if (change <= kCoordinateArmijo * scale * expected) {
+                value += delta;
+                update(delta);
+                return std::abs(delta);
+            }
+        }
+        return 0.0;
+    }
+
+    double coordinate(std::vector<double>& weights, Index j) {
+        auto each = [&](auto f, double& a, double& b) { column_sums(columns_, j, chunks_, f, a, b); };
+        auto update = [&](double delta) {
+            const Index size = columns_.size(j);
+            utils::parallel_for(0, size, kColumnChunk, [&](Index p0, Index p1) {
+                for (Index p = p0; p < p1; ++p) {
+                    margins_[static_cast<size_t>(columns_.row(j, p))] += delta * columns_.value(j, p);
+                }
+            });
+        };
+        return step(weights[static_cast<size_t>(j)], l1_, each, update);
+    }
+
+    double intercept(double& bias) {
+        const Index n = columns_.rows();
+        auto each = [&](auto f, double& a, double& b) {
+            // The bias column: every row, value 1, in the same fixed chunks
+            const Index count = (n + kColumnChunk - 1) / kColumnChunk;
+            chunks_.assign(static_cast<size_t>(2 * count), 0.0);
+            utils::parallel_for(0, count, 1, [&](Index c0, Index c1) {
+                for (Index c = c0; c < c1; ++c) {
+                    double ca = 0.0, cb = 0.0;
+                    for (Index r = c * kColumnChunk; r < std::min(n, (c + 1) * kColumnChunk); ++r) f(r, 1.0, ca, cb);
+                    chunks_[static_cast<size_t>(2 * c)] = ca;
+                    chunks_[static_cast<size_t>(2 * c + 1)] = cb;
+                }
+            });
+            a = 0.0;
+            b = 0.0;
+            for (Index c = 0; c < count; ++c) {
+                a += chunks_[static_cast<size_t>(2 * c)];
+                b += chunks_[static_cast<size_t>(2 * c + 1)];
+            }
+        };
+        auto update = [&](double delta) {
+            for (double& m : margins_) m += delta;
+        };
+        return step(bias, 0.0, each, update);
+    }
+
+public:
+    CoordinateDescent(const Columns& columns, const std::vector<double>& targets, double l1)
+        : columns_(columns), targets_(targets), l1_(l1),
+          inv_n_(1.0 / static_cast<double>(std::max<Index>(columns.rows(), 1))) {}
+
+    // Returns whether a full pass ended within tolerance; passes counts every pass
+    bool solve(std::vector<double>& weights, double& bias, int max_passes, double tolerance, int& passes) {
+        const Index n = columns_.rows();
+        const Index d = columns_.cols();
+        margins_.assign(static_cast<size_t>(n), bias);
+        for (Index j = 0; j < d; ++j) {
+            const double w = weights[static_cast<size_t>(j)];
+            if (w == 0.0) continue;
+            for (Index p = 0; p < columns_.size(j); ++p) {
+                margins_[static_cast<size_t>(columns_.row(j, p))] += w * columns_.value(j, p);
+            }
+        }
+
+        std::vector<Index> active;
+        passes = 0;
+        while (passes < max_passes) {
+            // Full pass: every coordinate gets a chance to enter the model
+            double largest = intercept(bias);
+            for (Index j = 0; j < d; ++j) largest = std::max(largest, coordinate(weights, j));
+            ++passes;
+            if (largest <= tolerance) return true;
+
+            active.clear();
+            for (Index j = 0; j < d; ++j) {
+                if (weights[static_cast<size_t>(j)] != 0.0) active.push_back(j);
+            }
+            while (passes < max_passes) {
+                largest = intercept(bias);
+                for (Index j : active) largest = std::max(largest, coordinate(weights, j));
+                ++passes;
+                if (largest <= tolerance) break;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+LogisticRegression::LogisticRegression()
+    : LogisticRegression(LogisticRegressionParams{Matrix(), Vector(), 0.0, 100, 1e-6, false, 0.0, 0}) {
+}
+
+LogisticRegression::LogisticRegression(const LogisticRegressionParams& params, LogisticPenalty penalty,
+                                       LogisticSolver solver)
+    : params_(params), penalty_(penalty), solver_(solver) {
+}
+
+bool LogisticRegression::check_labels(const Vector& y, Index rows, int& classes) const {
+    if (y.size() != rows || rows == 0) {
+        std::cout << "❌ Logistic regression needs one label per row, got " << y.size() << " for " << rows
+                  << std::endl;
+        return false;
+    }
+    int largest = 0;
+    for (Index i = 0; i < y.size(); ++i) {
+        const double label = static_cast<double>(y[i]);
+        if (label < 0.0 || label != std::floor(label)) {
+            std::cout << "❌ Logistic regression labels must be class indices, got " << label << std::endl;
+            return false;
+        }
+        largest = std::max(largest, static_cast<int>(label));
+    }
+    classes = params_.num_classes > 0 ? params_.num_classes : largest + 1;
+    if (largest >= classes || classes < 2) {
+        std::cout << "❌ Logistic regression needs labels in [0, " << std::max(classes, 2) << "), got " << largest
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+Vector gather_labels(const Vector& y, const std::vector<int>& rows) {
+    Vector labels(static_cast<Index>(rows.size()));
+    for (size_t i = 0; i < rows.size(); ++i) labels[static_cast<Index>(i)] = y[rows[i]];
+    return labels;
+}
+
+} // namespace
+
+template<typename Rows>
+bool LogisticRegression::fit_rows(const Rows& rows, const Vector& y) {
+    int classes = 0;
+    if (!check_labels(y, rows.rows(), classes)) return false;
+    const Index d = rows.cols();
+    const Index outputs = classes == 2 ? 1 : classes;
+    const double strength = params_.use_regularization ? params_.regularization_strength : 0.0;
+    const bool l1 = penalty_ == LogisticPenalty::L1 && strength > 0.0;
+    bool coordinate_descent = solver_ == LogisticSolver::COORDINATE_DESCENT ||
+                              (solver_ == LogisticSolver::AUTO && l1);
+    if (l1 && !coordinate_descent) {
+        std::cout << "⚠️ L-BFGS cannot fit an L1 penalty; using coordinate descent" << std::endl;
+        coordinate_descent = true;
+    }
+
+    // Warm start only from coefficients of the same shape and model form
+    const bool warm = warm_start_ && params_.weights.rows() == outputs && params_.weights.cols() == d &&
+                      params_.bias.size() == outputs && one_vs_rest_ == (coordinate_descent && outputs > 1);
+    if (!warm) {
+        params_.weights = Matrix::Zero(outputs, d);
+        params_.bias = Vector::Zero(outputs);
+    }
+    params_.num_classes = classes;
+    one_vs_rest_ = coordinate_descent && outputs > 1;
+    converged_ = true;
+    iterations_ = 0;
+
+    if (coordinate_descent) {
+        if (penalty_ == LogisticPenalty::L2 && strength > 0.0) {
+            std::cout << "⚠️ Coordinate descent fits L1 only; the L2 penalty is ignored" << std::endl;
+        }
+        const auto columns = rows.columns();
+        std::vector<double> targets(static_cast<size_t>(rows.rows()));
+        std::vector<double> weights(static_cast<size_t>(d));
+        for (Index c = 0; c < outputs; ++c) {
+            // Two classes fit class 1; one versus rest fits each class in turn
+            const int positive = outputs == 1 ? 1 : static_cast<int>(c);
+            for (Index i = 0; i < rows.rows(); ++i) {
+                targets[static_cast<size_t>(i)] = static_cast<int>(y[i]) == positive ? 1.0 : 0.0;
+            }
+            for (Index j = 0; j < d; ++j) weights[static_cast<size_t>(j)] = params_.weights(c, j);
+            double bias = params_.bias[c];
+            int passes = 0;
+            CoordinateDescent<decltype(columns)> solver(columns, targets, l1 ? strength : 0.0);
+            converged_ = solver.solve(weights, bias, params_.max_iterations, params_.tolerance, passes) && converged_;
+            iterations_ = std::max(iterations_, passes);
+            for (Index j = 0; j < d; ++j) params_.weights(c, j) = static_cast<Scalar>(weights[static_cast<size_t>(j)]);
+            params_.bias[c] = static_cast<Scalar>(bias);
+        }
+        return true;
+    }
+
+    std::vector<double> theta(static_cast<size_t>(outputs * (d + 1)));
+    for (Index c = 0; c < outputs; ++c) {
+        for (Index j = 0; j < d; ++j) theta[static_cast<size_t>(c * d + j)] = params_.weights(c, j);
+        theta[static_cast<size_t>(outputs * d + c)] = params_.bias[c];
+    }
+    LossFunction<Rows> loss(rows, y, outputs, strength);
+    converged_ = minimize_lbfgs(loss, theta, params_.max_iterations, params_.tolerance, history_, iterations_);
+    for (Index c = 0; c < outputs; ++c) {
+        for (Index j = 0; j < d; ++j) params_.weights(c, j) = static_cast<Scalar>(theta[static_cast<size_t>(c * d + j)]);
+        params_.bias[c] = static_cast<Scalar>(theta[static_cast<size_t>(outputs * d + c)]);
+    }
+    return true;
+}
+
+bool LogisticRegression::fit(const Matrix& X, const Vector& y) {
+    return fit_rows(DenseRows{X}, y);
+}
+
+bool LogisticRegression::fit(const SparseMatrixCSR& X, const Vector& y) {
+    return fit_rows(SparseRows{X}, y);
+}
+
+bool LogisticRegression::fit(const Matrix& X, const Vector& y, const std::vector<int>& rows) {
+    if (y.size() != X.rows()) {
+        std::cout << "❌ Logistic regression needs one label per row, got " << y.size() << " for " << X.rows()
+                  << std::endl;
+        return false;
+    }
+    return fit_rows(IndexedRows{X, rows}, gather_labels(y, rows));
+}
+
+template<typename Rows>
+std::vector<LogisticRegressionParams> LogisticRegression::fit_path_rows(const Rows& rows, const Vector& y,
+                                                                        const std::vector<double>& strengths) {
+    std::vector<LogisticRegressionParams> path;
+    const bool warm_start = warm_start_;
+    const bool regularize = params_.use_regularization;
+    for (double strength : strengths) {
+        params_.use_regularization = true;
+        params_.regularization_strength = strength;
+        if (!fit_rows(rows, y)) break;
+        path.push_back(params_);
+        // Every later fit starts from the previous solution
+        warm_start_ = true;
+    }
+    warm_start_ = warm_start;
+    params_.use_regularization = regularize || !path.empty();
+    return path;
+}
+
+std::vector<LogisticRegressionParams> LogisticRegression::fit_path(const Matrix& X, const Vector& y,
+                                                                   const std::vector<double>& strengths) {
+    return fit_path_rows(DenseRows{X}, y, strengths);
+}
+
+std::vector<LogisticRegressionParams> LogisticRegression::fit_path(const SparseMatrixCSR& X, const Vector& y,
+                                                                   const std::vector<double>& strengths) {
+    return fit_path_rows(SparseRows{X}, y, strengths);
+}
+
+template<typename Rows>
+Matrix LogisticRegression::probabilities(const Rows& rows) const {
+    const Index outputs = params_.weights.rows();
+    const Index d = params_.weights.cols();
+    if (outputs == 0 || rows.cols() != d) {
+        std::cout << "❌ Logistic regression is not trained for " << rows.cols() << " features" << std::endl;
+        return Matrix();
+    }
+    const Index n = rows.rows();
+    const Index classes = outputs == 1 ? 2 : outputs;
+    // Coefficients as double rows, so the dot products match the solvers'
+    std::vector<double> weights(static_cast<size_t>(outputs * d));
+    for (Index i = 0; i < outputs * d; ++i) weights[static_cast<size_t>(i)] = params_.weights.data()[i];
+
+    Matrix probabilities(n, classes);
+    utils::parallel_for(0, n, 256, [&](Index r0, Index r1) {
+        std::vector<double> z(static_cast<size_t>(outputs));
+        for (Index r = r0; r < r1; ++r) {
+            for (Index c = 0; c < outputs; ++c) z[c] = rows.dot(r, weights.data() + c * d) + params_.bias[c];
+            Scalar* out = probabilities.data() + r * classes;
+            if (outputs == 1) {
+                const double p = sigmoid(z[0]);
+                out[0] = static_cast<Scalar>(1.0 - p);
+                out[1] = static_cast<Scalar>(p);
+            } else if (one_vs_rest_) {
+                double total = 0.0;
+                for (Index c = 0; c < outputs; ++c) total += (z[c] = sigmoid(z[c]));
+                for (Index c = 0; c < outputs; ++c) out[c] = static_cast<Scalar>(z[c] / total);
+            } else {
+                const double top = *std::max_element(z.begin(), z.end());
+                double total = 0.0;
+                for (Index c = 0; c < outputs; ++c) total += (z[c] = std::exp(z[c] - top));
+                for (Index c = 0; c < outputs; ++c) out[c] = static_cast<Scalar>(z[c] / total);
+            }
+        }
+    });
+    return probabilities;
+}
+
+Matrix LogisticRegression::predict_proba(const Matrix& X) const {
+    return probabilities(DenseRows{X});
+}
+
+Matrix LogisticRegression::predict_proba(const SparseMatrixCSR& X) const {
+    return probabilities(SparseRows{X});
+}
+
+namespace {
+
+Vector most_probable(const Matrix& probabilities) {
+    const Index cols = probabilities.cols();
+    Vector labels(probabilities.rows());
+    for (Index r = 0; r < probabilities.rows(); ++r) {
+        const Scalar* row = probabilities.data() + r * cols;
+        labels[r] = static_cast<Scalar>(std::max_element(row, row + cols) - row);
+    }
+    return labels;
+}
+
+double mean_log_loss(const Matrix& probabilities, const Vector& y) {
+    if (probabilities.rows() != y.size() || y.size() == 0) return 0.0;
+    const Index cols = probabilities.cols();
+    double total = 0.0;
+    for (Index r = 0; r < y.size(); ++r) {
+        const Index label = static_cast<Index>(y[r]);
+        if (label < 0 || label >= cols) continue;
+        total -= std::log(std::max(static_cast<double>(probabilities(r, label)), 1e-15));
+    }
+    return total / static_cast<double>(y.size());
+}
+
+} // namespace
+
+Vector LogisticRegression::predict(const Matrix& X) const {
+    return most_probable(predict_proba(X));
+}
+
+Vector LogisticRegression::predict(const SparseMatrixCSR& X) const {
+    return most_probable(predict_proba(X));
+}
+
+double LogisticRegression::evaluate(const Matrix& X, const Vector& y) const {
+    return mean_log_loss(predict_proba(X), y);
+}
+
+double LogisticRegression::evaluate(const SparseMatrixCSR& X, const Vector& y) const {
+    return mean_log_loss(predict_proba(X), y);
+}
+
+double LogisticRegression::evaluate(const Matrix& X, const Vector& y, const std::vector<int>& rows) const {
+    if (y.size() != X.rows()) return 0.0;
+    return mean_log_loss(probabilities(IndexedRows{X, rows}), gather_labels(y, rows));
+}
+
+} // namespace algorithms
+} // namespace dds
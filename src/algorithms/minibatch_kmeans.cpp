@@ -0,0 +1,368 @@
+#include "../../include/algorithms/minibatch_kmeans.h"
+#include "../../include/utils/parallel.h"
+#include "../../include/utils/simd.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace dds {
+namespace algorithms {
+
+namespace {
+
+// Rows per block of the assignment kernels. Partial sums are kept per block and
+// merged in block order, so results do not depend on the thread count.
+constexpr Index kBlockRows = 256;
+
+std::vector<double> squared_norms(const Matrix& centroids) {
+    const Index k = centroids.rows();
+    const Index d = centroids.cols();
+    std::vector<double> norms(static_cast<size_t>(k));
+    for (Index c = 0; c < k; ++c) {
+        norms[c] = utils::simd::dot(centroids.data() + c * d, centroids.data() + c * d, static_cast<size_t>(d));
+    }
+    return norms;
+}
+
+// Nearest centroid of a row and its squared distance, as ||x||^2 - 2 x.c + ||c||^2.
+// Rows are short, so four centers at a time keep four independent sums in flight
+// where the blocked simd::dot would spend its time on setup.
+inline int nearest(const Scalar* row, const Matrix& centroids, const std::vector<double>& norms, double& distance) {
+    const Index k = centroids.rows();
+    const Index d = centroids.cols();
+    const Scalar* data = centroids.data();
+    double row_norm = 0.0;
+    for (Index j = 0; j < d; ++j) row_norm += static_cast<double>(row[j]) * row[j];
+    double best = std::numeric_limits<double>::max();
+    int best_c = 0;
+    auto consider = [&](Index c, double cross) {
+        const double dist = norms[c] - 2.0 * cross;
+        if (dist < best) {
+            best = dist;
+            best_c = static_cast<int>(c);
+        }
+    };
+    Index c = 0;
+    for (; c + 4 <= k; c += 4) {
+        const Scalar* c0 = data + c * d;
+        double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+        for (Index j = 0; j < d; ++j) {
+            const double x = row[j];
+            s0 += x * c0[j];
+            s1 += x * c0[d + j];
+            s2 += x * c0[2 * d + j];
+            s3 += x * c0[3 * d + j];
+        }
+        consider(c, s0);
+        consider(c + 1, s1);
+        consider(c + 2, s2);
+        consider(c + 3, s3);
+    }
+    for (; c < k; ++c) {
+        const Scalar* center = data + c * d;
+        double cross = 0.0;
+        for (Index j = 0; j < d; ++j) cross += static_cast<double>(row[j]) * center[j];
+        consider(c, cross);
+    }
+    distance = std::max(best + row_norm, 0.0);
+    return best_c;
+}
+
+// Mean squared distance of rows to their nearest centroid
+double mean_distance(const Scalar* rows, Index n, const Matrix& centroids) {
+    if (n == 0 || centroids.rows() == 0) return 0.0;
+    const Index d = centroids.cols();
+    const std::vector<double> norms = squared_norms(centroids);
+    const Index blocks = (n + kBlockRows - 1) / kBlockRows;
+    std::vector<double> partial(static_cast<size_t>(blocks), 0.0);
+    utils::parallel_for(0, blocks, 1, [&](Index b0, Index b1) {
+        for (Index b = b0; b < b1; ++b) {
+            double total = 0.0;
+            for (Index i = b * kBlockRows; i < std::min(n, (b + 1) * kBlockRows); ++i) {
+                double dist;
+                nearest(rows + i * d, centroids, norms, dist);
+                total += dist;
+            }
+            partial[b] = total;
+        }
+    });
+    double total = 0.0;
+    for (double p : partial) total += p;
+    return total / static_cast<double>(n);
+}
+
+} // namespace
+
+MiniBatchKMeans::MiniBatchKMeans(int k, Index batch_size, uint64_t seed)
+    : k_(std::max(k, 1)), batch_size_(std::max<Index>(batch_size, 1)), seed_(seed) {}
+
+void MiniBatchKMeans::set_holdout(double fraction, Index max_rows) {
+    holdout_fraction_ = std::min(std::max(fraction, 0.0), 0.5);
+    max_holdout_rows_ = std::max<Index>(max_rows, 0);
+}
+
+bool MiniBatchKMeans::partial_fit(const Matrix& batch) {
+    if (batch.rows() == 0) return true;
+    if (centroids_.rows() == 0) {
+        if (batch.rows() < k_) {
+            std::cout << "❌ MiniBatchKMeans: the first batch has " << batch.rows() << " rows, needs at least "
+                      << k_ << std::endl;
+            return false;
+        }
+        initialize(batch);
+    } else if (batch.cols() != centroids_.cols()) {
+        std::cout << "❌ MiniBatchKMeans: batch has " << batch.cols() << " columns, the centroids have "
+                  << centroids_.cols() << std::endl;
+        return false;
+    }
+    update(batch);
+    return true;
+}
+
+void MiniBatchKMeans::initialize(const Matrix& batch) {
+    // k-means++: each further center is drawn with probability proportional to the
+    // squared distance to the nearest center so far
+    const Index n = batch.rows();
+    const Index d = batch.cols();
+    utils::RandomStream rng = utils::RandomStream(seed_).fork(1);
+    centroids_ = Matrix(k_, d);
+    counts_.assign(static_cast<size_t>(k_), 0.0);
+
+    auto set_center = [&](Index c, Index row) {
+        std::copy(batch.data() + row * d, batch.data() + (row + 1) * d, centroids_.data() + c * d);
+    };
+    set_center(0, static_cast<Index>(rng.below(static_cast<uint32_t>(n))));
+
+    std::vector<double> closest(static_cast<size_t>(n), std::numeric_limits<double>::max());
+    for (Index c = 1; c < k_; ++c) {
+        const Scalar* center = centroids_.data() + (c - 1) * d;
+        double total = 0.0;
+        for (Index i = 0; i < n; ++i) {
+            double dist = 0.0;
+            for (Index j = 0; j < d; ++j) {
+                const double diff = batch(i, j) - center[j];
+                dist += diff * diff;
+            }
+            closest[i] = std::min(closest[i], dist);
+            total += closest[i];
+        }
+        Index pick = n - 1;
+        if (total > 0.0) {
+            double target = rng.uniform() * total;
+            for (Index i = 0; i < n; ++i) {
+                target -= closest[i];
+                if (target < 0.0) {
+                    pick = i;
+                    break;
+                }
+            }
+        } else {
+            pick = static_cast<Index>(rng.below(static_cast<uint32_t>(n)));
+        }
+        set_center(c, pick);
+    }
+}
+
+void MiniBatchKMeans::update(const Matrix& batch) {
+    const Index n = batch.rows();
+    const Index d = batch.cols();
+    const Index blocks = (n + kBlockRows - 1) / kBlockRows;
+    const std::vector<double> norms = squared_norms(centroids_);
+
+    static thread_local std::vector<double> sum_scratch;
+    static thread_local std::vector<double> size_scratch;
+    std::vector<double>& sums = sum_scratch;
+    std::vector<double>& sizes = size_scratch;
+    sums.assign(static_cast<size_t>(blocks * k_ * d), 0.0);
+    sizes.assign(static_cast<size_t>(blocks * k_), 0.0);
+
+    utils::parallel_for(0, blocks, 1, [&](Index b0, Index b1) {
+        for (Index b = b0; b < b1; ++b) {
+            double* block_sums = sums.data() + b * k_ * d;
+            double* block_sizes = sizes.data() + b * k_;
+            for (Index i = b * kBlockRows; i < std::min(n, (b + 1) * kBlockRows); ++i) {
+                const Scalar* row = batch.data() + i * d;
+                double dist;
+                const int c = nearest(row, centroids_, norms, dist);
+                double* center_sum = block_sums + c * d;
+                for (Index j = 0; j < d; ++j) center_sum[j] += row[j];
+                block_sizes[c] += 1.0;
+            }
+        }
+    });
+
+    for (Index b = 1; b < blocks; ++b) {
+        for (Index i = 0; i < k_ * d; ++i) sums[i] += sums[b * k_ * d + i];
+        for (Index c = 0; c < k_; ++c) sizes[c] += sizes[b * k_ + c];
+    }
+
+    // Per-center learning rate: a center that has taken m rows moves n_c / (m + n_c)
+    // of the way to the mean of its n_c new rows, which keeps it the mean of all m + n_c
+    for (Index c = 0; c < k_; ++c) {
+        if (sizes[c] == 0.0) continue;
+        counts_[c] += sizes[c];
+        const double rate = sizes[c] / counts_[c];
+        Scalar* center = centroids_.data() + c * d;
+        for (Index j = 0; j < d; ++j) {
+            const double mean = sums[c * d + j] / sizes[c];
+            center[j] = static_cast<Scalar>((1.0 - rate) * center[j] + rate * mean);
+        }
+    }
+    ++batches_;
+}
+
+void MiniBatchKMeans::reset_fit() {
+    centroids_ = Matrix();
+    counts_.clear();
+    batches_ = 0;
+    holdout_.clear();
+    holdout_rows_ = 0;
+    selected_ = 0;
+    checkpoint_ = Matrix();
+    holdout_inertia_.clear();
+    stalled_checks_ = 0;
+    converged_ = false;
+}
+
+bool MiniBatchKMeans::held_out(uint64_t position) {
+    if (holdout_fraction_ <= 0.0 || max_holdout_rows_ == 0) return false;
+    utils::RandomStream rng = utils::RandomStream(seed_).fork(2);
+    rng.seek(2 * position);
+    if (rng.uniform() >= holdout_fraction_) return false;
+    return selected_++ < max_holdout_rows_;
+}
+
+bool MiniBatchKMeans::train_batch(const Matrix& batch) {
+    if (!partial_fit(batch)) return false;
+    if (holdout_rows_ > 0 && batches_ % check_every_ == 0) check_convergence();
+    return true;
+}
+
+void MiniBatchKMeans::check_convergence() {
+    if (checkpoint_.rows() == 0) {
+        checkpoint_ = centroids_;
+        return;
+    }
+    const double previous = mean_distance(holdout_.data(), holdout_rows_, checkpoint_);
+    const double current = mean_distance(holdout_.data(), holdout_rows_, centroids_);
+    holdout_inertia_.push_back(current);
+    const double improvement = (previous - current) / std::max(previous, std::numeric_limits<double>::min());
+    stalled_checks_ = improvement < tolerance_ ? stalled_checks_ + 1 : 0;
+    converged_ = stalled_checks_ >= patience_;
+    checkpoint_ = centroids_;
+}
+
+bool MiniBatchKMeans::fit(storage::DatasetStream& stream) {
+    reset_fit();
+    Matrix batch;
+    Vector labels;
+    Matrix train;
+    for (int epoch = 0; epoch < max_epochs_ && !converged_; ++epoch) {
+        stream.rewind();
+        selected_ = 0;
+        while (!converged_ && stream.next_batch(batch_size_, batch, labels)) {
+            const Index n = batch.rows();
+            const Index d = batch.cols();
+            const uint64_t first_row = stream.rows_read() - static_cast<uint64_t>(n);
+
+            train.resize(n, d);
+            Index kept = 0;
+            for (Index i = 0; i < n; ++i) {
+                const Scalar* row = batch.data() + i * d;
+                if (held_out(first_row + static_cast<uint64_t>(i))) {
+                    // Only the first pass meets rows not yet in the sample
+                    if (selected_ > holdout_rows_) {
+                        holdout_.insert(holdout_.end(), row, row + d);
+                        ++holdout_rows_;
+                    }
+                    continue;
+                }
+                std::copy(row, row + d, train.data() + kept * d);
+                ++kept;
+            }
+            if (kept == 0) continue;
+            if (kept < n) train.resize(kept, d);
+            if (!train_batch(kept < n ? train : batch)) return false;
+        }
+        if (stream.failed()) return false;
+    }
+    if (centroids_.rows() == 0) {
+        std::cout << "❌ MiniBatchKMeans: no rows to train on" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MiniBatchKMeans::fit(const Matrix& X) {
+    reset_fit();
+    const Index n = X.rows();
+    const Index d = X.cols();
+    std::vector<int> train_rows;
+    train_rows.reserve(static_cast<size_t>(n));
+    for (Index i = 0; i < n; ++i) {
+        if (held_out(static_cast<uint64_t>(i))) {
+            holdout_.insert(holdout_.end(), X.data() + i * d, X.data() + (i + 1) * d);
+            ++holdout_rows_;
+        } else {
+            train_rows.push_back(static_cast<int>(i));
+        }
+    }
+    if (static_cast<Index>(train_rows.size()) < k_) {
+        std::cout << "❌ MiniBatchKMeans: " << train_rows.size() << " training rows, needs at least " << k_
+                  << std::endl;
+        return false;
+    }
+
+    const Index rows = static_cast<Index>(train_rows.size());
+    const utils::RandomStream rng(seed_);
+    Matrix batch;
+    for (int epoch = 0; epoch < max_epochs_ && !converged_; ++epoch) {
+        utils::RandomStream order_rng = rng.fork(3 + static_cast<uint64_t>(epoch));
+        utils::shuffle(train_rows.begin(), train_rows.end(), order_rng);
+        // The first batch seeds the centroids, so it takes at least k rows
+        for (Index start = 0; start < rows && !converged_;) {
+            const Index size = std::min(rows - start, std::max<Index>(batch_size_, centroids_.rows() == 0 ? k_ : 1));
+            batch.resize(size, d);
+            for (Index i = 0; i < size; ++i) {
+                const Scalar* row = X.data() + static_cast<Index>(train_rows[start + i]) * d;
+                std::copy(row, row + d, batch.data() + i * d);
+            }
+            if (!train_batch(batch)) return false;
+            start += size;
+        }
+    }
+    return true;
+}
+
+std::vector<int> MiniBatchKMeans::predict(const Matrix& X) const {
+    std::vector<int> labels;
+    if (centroids_.rows() == 0 || X.cols() != centroids_.cols()) {
+        std::cout << "❌ MiniBatchKMeans: predict needs a fitted model and " << centroids_.cols() << " columns"
+                  << std::endl;
+        return labels;
+    }
+    const Index n = X.rows();
+    const Index d = X.cols();
+    labels.resize(static_cast<size_t>(n));
+    const std::vector<double> norms = squared_norms(centroids_);
+    utils::parallel_for(0, n, kBlockRows, [&](Index i0, Index i1) {
+        for (Index i = i0; i < i1; ++i) {
+            double dist;
+            labels[i] = nearest(X.data() + i * d, centroids_, norms, dist);
+        }
+    });
+    return labels;
+}
+
+double MiniBatchKMeans::inertia(const Matrix& X) const {
+    if (centroids_.rows() == 0 || X.cols() != centroids_.cols()) {
+        std::cout << "❌ MiniBatchKMeans: inertia needs a fitted model and " << centroids_.cols() << " columns"
+                  << std::endl;
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return mean_distance(X.data(), X.rows(), centroids_);
+}
+
+} // namespace algorithms
+} // namespace dds
@@ -0,0 +1,149 @@
+#include "../../include/algorithms/model_format.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dds {
+namespace algorithms {
+
+namespace {
+
+constexpr char kModelMagic[8] = {'D', 'D', 'S', 'M', 'O', 'D', 'E', 'L'};
+
+uint64_t align_offset(uint64_t offset) {
+    return (offset + kModelSectionAlignment - 1) / kModelSectionAlignment * kModelSectionAlignment;
+}
+
+} // namespace
+
+bool ModelWriter::write(const std::string& path, ModelKind kind) const {
+    ModelFileHeader header{};
+    std::memcpy(header.magic, kModelMagic, sizeof(kModelMagic));
+    header.version = kModelFormatVersion;
+    header.kind = static_cast<uint32_t>(kind);
+    header.scalar_bytes = static_cast<uint32_t>(sizeof(Scalar));
+    header.section_count = static_cast<uint32_t>(sections_.size());
+
+    std::vector<ModelSection> table(sections_.size());
+    uint64_t offset = align_offset(sizeof(ModelFileHeader) + table.size() * sizeof(ModelSection));
+    for (size_t i = 0; i < sections_.size(); ++i) {
+        table[i] = {sections_[i].tag, sections_[i].element_size, offset, sections_[i].count};
+        offset = align_offset(offset + sections_[i].count * sections_[i].element_size);
+    }
+    header.file_size = offset;
+
+    // Written beside the target and renamed over it, so readers never see a partial file
+    const std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        std::cout << "❌ Cannot write model file " << temporary << std::endl;
+        return false;
+    }
+    static const char padding[kModelSectionAlignment] = {};
+    uint64_t written = 0;
+    auto put = [&](const void* data, uint64_t bytes) {
+        if (bytes == 0) return true;
+        written += bytes;
+        return std::fwrite(data, 1, static_cast<size_t>(bytes), file) == bytes;
+    };
+    bool ok = put(&header, sizeof(header)) && put(table.data(), table.size() * sizeof(ModelSection));
+    for (size_t i = 0; ok && i < sections_.size(); ++i) {
+        ok = put(padding, table[i].offset - written) &&
+             put(sections_[i].data, sections_[i].count * sections_[i].element_size);
+    }
+    ok = ok && put(padding, header.file_size - written);
+    ok = std::fflush(file) == 0 && ok;
+    ok = ::fsync(fileno(file)) == 0 && ok;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cout << "❌ Failed to write model file " << path << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+MappedModel::~MappedModel() {
+    if (base_) ::munmap(const_cast<unsigned char*>(base_), size_);
+}
+
+bool MappedModel::open(const std::string& path, ModelKind kind) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << "❌ Cannot open model file " << path << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ModelFileHeader)) {
+        std::cout << "❌ Not a model file: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+    // Shared read-only mapping: pages come from the page cache on first touch and are
+    // shared by every process that maps the file
+    const size_t size = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cout << "❌ Cannot map model file " << path << std::endl;
+        return false;
+    }
+    base_ = static_cast<const unsigned char*>(mapping);
+    size_ = size;
+    header_ = reinterpret_cast<const ModelFileHeader*>(base_);
+
+    const char* problem = nullptr;
+    if (std::memcmp(header_->magic, kModelMagic, sizeof(kModelMagic)) != 0) {
+        problem = "not a model file";
+    } else if (header_->version != kModelFormatVersion) {
+        problem = "unsupported format version";
+    } else if (header_->scalar_bytes != sizeof(Scalar)) {
+        problem = "written with a different Scalar type";
+    } else if (header_->kind != static_cast<uint32_t>(kind)) {
+        problem = "holds another kind of model";
+    } else if (header_->file_size != size_ ||
+               header_->section_count > (size_ - sizeof(ModelFileHeader)) / sizeof(ModelSection)) {
+        problem = "truncated";
+    }
+    if (!problem) {
+        sections_ = reinterpret_cast<const ModelSection*>(base_ + sizeof(ModelFileHeader));
+        for (uint32_t i = 0; i < header_->section_count && !problem; ++i) {
+            const ModelSection& entry = sections_[i];
+            if (entry.offset % kModelSectionAlignment != 0 || entry.offset > size_ || entry.element_size == 0 ||
+                entry.count > (size_ - entry.offset) / entry.element_size) {
+                problem = "has a section outside the file";
+            }
+        }
+    }
+    if (problem) {
+        std::cout << "❌ Model file " << path << " " << problem << std::endl;
+        ::munmap(const_cast<unsigned char*>(base_), size_);
+        base_ = nullptr;
+        size_ = 0;
+        header_ = nullptr;
+        sections_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+const ModelSection* MappedModel::find(uint32_t tag) const {
+    if (!header_) return nullptr;
+    for (uint32_t i = 0; i < header_->section_count; ++i) {
+        if (sections_[i].tag == tag) return &sections_[i];
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const MappedModel> map_model(const std::string& path, ModelKind kind) {
+    auto model = std::make_shared<MappedModel>();
+    if (!model->open(path, kind)) return nullptr;
+    return model;
+}
+
+} // namespace algorithms
+} // namespace dds
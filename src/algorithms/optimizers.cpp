@@ -0,0 +1,203 @@
+#include "../../include/algorithms/optimizers.h"
+#include "../../include/utils/parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace dds {
+namespace algorithms {
+
+namespace {
+
+// Elements per parallel chunk; bias vectors and other small tensors run inline
+constexpr std::ptrdiff_t kUpdateGrain = 16384;
+
+// Per-step constants in storage precision
+struct StepConstants {
+    Scalar lr;
+    Scalar decay;                   // L2 coefficient (0 for tensors without decay)
+    Scalar shrink;                  // AdamW decoupled decay factor, 1 - lr * wd
+    Scalar momentum;
+    Scalar rho;
+    Scalar beta1;
+    Scalar beta2;
+    Scalar step_size;               // lr / (1 - beta1^t)
+    Scalar inv_sqrt_correction;     // 1 / sqrt(1 - beta2^t)
+    Scalar epsilon;
+    bool nesterov;
+};
+
+// Each kernel is one pass over its arrays. Constants are copied to locals so the
+// stores cannot alias them, and the loops vectorize (sqrt included, the file is built
+// without errno-setting math).
+
+void sgd_kernel(Scalar* p, const Scalar* g, size_t n, const StepConstants& c) {
+    const Scalar lr = c.lr;
+    const Scalar decay = c.decay;
+    for (size_t i = 0; i < n; ++i) p[i] -= lr * (g[i] + decay * p[i]);
+}
+
+void momentum_kernel(Scalar* p, const Scalar* g, Scalar* buf, size_t n, const StepConstants& c) {
+    const Scalar lr = c.lr;
+    const Scalar decay = c.decay;
+    const Scalar mu = c.momentum;
+    if (c.nesterov) {
+        for (size_t i = 0; i < n; ++i) {
+            const Scalar grad = g[i] + decay * p[i];
+            const Scalar b = mu * buf[i] + grad;
+            buf[i] = b;
+            p[i] -= lr * (grad + mu * b);
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            const Scalar b = mu * buf[i] + g[i] + decay * p[i];
+            buf[i] = b;
+            p[i] -= lr * b;
+        }
+    }
+}
+
+void rmsprop_kernel(Scalar* p, const Scalar* g, Scalar* v, size_t n, const StepConstants& c) {
+    const Scalar lr = c.lr;
+    const Scalar decay = c.decay;
+    const Scalar rho = c.rho;
+    const Scalar one_minus_rho = Scalar(1) - rho;
+    const Scalar epsilon = c.epsilon;
+    for (size_t i = 0; i < n; ++i) {
+        const Scalar grad = g[i] + decay * p[i];
+        const Scalar s = rho * v[i] + one_minus_rho * grad * grad;
+        v[i] = s;
+        p[i] -= lr * grad / (std::sqrt(s) + epsilon);
+    }
+}
+
+// Adam with L2 (decay folded into the gradient) and AdamW (decoupled shrink) share
+// the kernel; one of decay and 1 - shrink is always zero
+void adam_kernel(Scalar* p, const Scalar* g, Scalar* m, Scalar* v, size_t n, const StepConstants& c) {
+    const Scalar decay = c.decay;
+    const Scalar shrink = c.shrink;
+    const Scalar beta1 = c.beta1;
+    const Scalar beta2 = c.beta2;
+    const Scalar one_minus_beta1 = Scalar(1) - beta1;
+    const Scalar one_minus_beta2 = Scalar(1) - beta2;
+    const Scalar step_size = c.step_size;
+    const Scalar inv_sqrt_correction = c.inv_sqrt_correction;
+    const Scalar epsilon = c.epsilon;
+    for (size_t i = 0; i < n; ++i) {
+        const Scalar grad = g[i] + decay * p[i];
+        const Scalar first = beta1 * m[i] + one_minus_beta1 * grad;
+        const Scalar second = beta2 * v[i] + one_minus_beta2 * grad * grad;
+        m[i] = first;
+        v[i] = second;
+        p[i] = p[i] * shrink - step_size * first / (std::sqrt(second) * inv_sqrt_correction + epsilon);
+    }
+}
+
+} // namespace
+
+Optimizer::Optimizer(OptimizerType type, double learning_rate)
+    : type_(type), learning_rate_(learning_rate) {
+}
+
+bool Optimizer::parse_type(const std::string& name, OptimizerType& type) {
+    if (name == "sgd") type = OptimizerType::SGD;
+    else if (name == "momentum") type = OptimizerType::MOMENTUM;
+    else if (name == "rmsprop") type = OptimizerType::RMSPROP;
+    else if (name == "adam") type = OptimizerType::ADAM;
+    else if (name == "adamw") type = OptimizerType::ADAMW;
+    else return false;
+    return true;
+}
+
+int Optimizer::slots() const {
+    switch (type_) {
+        case OptimizerType::MOMENTUM:
+        case OptimizerType::RMSPROP:
+            return 1;
+        case OptimizerType::ADAM:
+        case OptimizerType::ADAMW:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+void Optimizer::ensure_state(const std::vector<ParameterView>& parameters) {
+    bool same = layout_.size() == parameters.size();
+    for (size_t i = 0; same && i < parameters.size(); ++i) same = layout_[i] == parameters[i].size;
+    if (same && state_.size() == static_cast<size_t>(slots()) * total_) return;
+
+    layout_.resize(parameters.size());
+    total_ = 0;
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        layout_[i] = parameters[i].size;
+        total_ += parameters[i].size;
+    }
+    state_.assign(static_cast<size_t>(slots()) * total_, Scalar(0));
+    step_count_ = 0;
+}
+
+void Optimizer::reset() {
+    layout_.clear();
+    state_.clear();
+    total_ = 0;
+    step_count_ = 0;
+}
+
+void Optimizer::step(const std::vector<ParameterView>& parameters) {
+    ensure_state(parameters);
+    ++step_count_;
+
+    const double t = static_cast<double>(step_count_);
+    StepConstants base;
+    base.lr = static_cast<Scalar>(learning_rate_);
+    base.decay = Scalar(0);
+    base.shrink = Scalar(1);
+    base.momentum = static_cast<Scalar>(momentum_);
+    base.rho = static_cast<Scalar>(rho_);
+    base.beta1 = static_cast<Scalar>(beta1_);
+    base.beta2 = static_cast<Scalar>(beta2_);
+    base.step_size = static_cast<Scalar>(learning_rate_ / (1.0 - std::pow(beta1_, t)));
+    base.inv_sqrt_correction = static_cast<Scalar>(1.0 / std::sqrt(1.0 - std::pow(beta2_, t)));
+    base.epsilon = static_cast<Scalar>(epsilon_);
+    base.nesterov = nesterov_;
+
+    Scalar* first_moments = state_.data();
+    Scalar* second_moments = state_.data() + total_;
+    size_t offset = 0;
+    for (const ParameterView& parameter : parameters) {
+        StepConstants c = base;
+        if (parameter.decay && weight_decay_ > 0.0) {
+            if (type_ == OptimizerType::ADAMW) {
+                c.shrink = static_cast<Scalar>(1.0 - learning_rate_ * weight_decay_);
+            } else {
+                c.decay = static_cast<Scalar>(weight_decay_);
+            }
+        }
+        Scalar* m = first_moments + offset;
+        Scalar* v = second_moments + offset;
+        const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(parameter.size);
+        utils::parallel_for(0, n, kUpdateGrain, [&](std::ptrdiff_t b, std::ptrdiff_t e) {
+            Scalar* p = parameter.values + b;
+            const Scalar* g = parameter.gradients + b;
+            const size_t count = static_cast<size_t>(e - b);
+            switch (type_) {
+                case OptimizerType::MOMENTUM:
+                    momentum_kernel(p, g, m + b, count, c);
+                    break;
+                case OptimizerType::RMSPROP:
+                    rmsprop_kernel(p, g, m + b, count, c);
+                    break;
+                case OptimizerType::ADAM:
+                case OptimizerType::ADAMW:
+                    adam_kernel(p, g, m + b, v + b, count, c);
+                    break;
+                default:
+                    sgd_kernel(p, g, count, c);
+            }
+        });
+        offset += parameter.size;
+    }
+}
+
+} // namespace algorithms
+} // namespace dds
@@ -0,0 +1,66 @@
+#include "../../include/algorithms/workspace.h"
+#include <algorithm>
+
+namespace dds {
+namespace algorithms {
+
+namespace {
+
+// Tensor sizes are rounded up to 64 bytes so neighbouring tensors never share a line
+constexpr size_t kAlignElements = 64 / sizeof(Scalar);
+
+} // namespace
+
+void Workspace::clear() {
+    tensors_.clear();
+    planned_size_ = 0;
+}
+
+int Workspace::add(size_t size, int first, int last) {
+    const size_t padded = (size + kAlignElements - 1) / kAlignElements * kAlignElements;
+    tensors_.push_back({padded, first, last, 0});
+    return static_cast<int>(tensors_.size() - 1);
+}
+
+void Workspace::plan() {
+    std::vector<size_t> order(tensors_.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return tensors_[a].size > tensors_[b].size;
+    });
+
+    // Greedy by size: lowest gap between the placed tensors that are live together
+    std::vector<size_t> placed;
+    std::vector<std::pair<size_t, size_t>> busy;
+    planned_size_ = 0;
+    for (size_t id : order) {
+        Tensor& tensor = tensors_[id];
+        busy.clear();
+        for (size_t other_id : placed) {
+            const Tensor& other = tensors_[other_id];
+            if (other.first <= tensor.last && tensor.first <= other.last) {
+                busy.emplace_back(other.offset, other.offset + other.size);
+            }
+        }
+        std::sort(busy.begin(), busy.end());
+        size_t offset = 0;
+        for (const auto& range : busy) {
+            if (offset + tensor.size <= range.first) break;
+            offset = std::max(offset, range.second);
+        }
+        tensor.offset = offset;
+        planned_size_ = std::max(planned_size_, offset + tensor.size);
+        placed.push_back(id);
+    }
+
+    if (arena_.size() < planned_size_) arena_.resize(planned_size_);
+}
+
+size_t Workspace::unshared_size() const {
+    size_t total = 0;
+    for (const Tensor& tensor : tensors_) total += tensor.size;
+    return total;
+}
+
+} // namespace algorithms
+} // namespace dds
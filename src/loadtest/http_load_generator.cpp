@@ -0,0 +1,323 @@
+#include "../../include/loadtest/http_load_generator.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netdb.h>
+#include <unistd.h>
+
+namespace dds {
+namespace loadtest {
+
+// ---------------------------------------------------------------------------
+// LatencyHistogram
+
+size_t LatencyHistogram::bucket_of(uint64_t micros) {
+    if (micros < static_cast<uint64_t>(kSubBuckets)) return static_cast<size_t>(micros);
+    int msb = 63 - __builtin_clzll(micros);
+    int shift = msb - 4;                                    // Keeps (micros >> shift) in [16, 31]
+    size_t sub = static_cast<size_t>(micros >> shift) - kSubBuckets;
+    size_t bucket = static_cast<size_t>(shift + 1) * kSubBuckets + sub;
+    return std::min(bucket, static_cast<size_t>(kSubBuckets * kMagnitudes - 1));
+}
+
+double LatencyHistogram::bucket_upper_us(size_t bucket) {
+    if (bucket < static_cast<size_t>(kSubBuckets)) return static_cast<double>(bucket);
+    size_t shift = bucket / kSubBuckets - 1;
+    size_t sub = bucket % kSubBuckets + kSubBuckets;
+    return static_cast<double>(((sub + 1) << shift) - 1);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    int64_t ns = std::max<int64_t>(latency.count(), 0);
+    ++counts_[bucket_of(static_cast<uint64_t>(ns / 1000))];
+    ++total_;
+    sum_ns_ += static_cast<double>(ns);
+    max_ns_ = std::max(max_ns_, ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+    total_ += other.total_;
+    sum_ns_ += other.sum_ns_;
+    max_ns_ = std::max(max_ns_, other.max_ns_);
+}
+
+double LatencyHistogram::percentile_us(double p) const {
+    if (total_ == 0) return 0.0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(total_)));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= rank) return std::min(bucket_upper_us(i), max_us());
+    }
+    return max_us();
+}
+
+// ---------------------------------------------------------------------------
+// LoadTestReport
+
+void LoadTestReport::print() const {
+    std::cout << "\n📈 Load Test Report\n===================\n";
+    std::cout << "Duration: " << std::fixed << std::setprecision(2) << elapsed_seconds << " s\n";
+    std::cout << "Scheduled: " << scheduled << ", completed: " << completed
+              << ", errors: " << errors << ", dropped: " << dropped << "\n";
+    std::cout << "Achieved: " << std::setprecision(1) << achieved_rps << " req/s\n";
+    std::cout << "Latency (us): p50 " << latency.percentile_us(50) << "  p90 " << latency.percentile_us(90)
+              << "  p99 " << latency.percentile_us(99) << "  p99.9 " << latency.percentile_us(99.9)
+              << "  max " << latency.max_us() << "\n";
+    for (const auto& entry : latency_by_target) {
+        std::cout << "  " << entry.first << ": p50 " << entry.second.percentile_us(50)
+                  << "  p99 " << entry.second.percentile_us(99) << "  (" << entry.second.count() << ")\n";
+    }
+    std::cout << "Status codes:";
+    for (const auto& entry : status_codes) std::cout << " " << entry.first << "=" << entry.second;
+    std::cout << std::endl;
+}
+
+std::string LoadTestReport::to_json() const {
+    auto latency_json = [](const LatencyHistogram& h) {
+        std::ostringstream out;
+        out << std::setprecision(6) << "{\"count\": " << h.count() << ", \"mean_us\": " << h.mean_us()
+            << ", \"p50_us\": " << h.percentile_us(50) << ", \"p90_us\": " << h.percentile_us(90)
+            << ", \"p99_us\": " << h.percentile_us(99) << ", \"p999_us\": " << h.percentile_us(99.9)
+            << ", \"max_us\": " << h.max_us() << "}";
+        return out.str();
+    };
+
+    std::ostringstream json;
+    json << std::setprecision(6);
+    json << "{\"elapsed_seconds\": " << elapsed_seconds << ", \"scheduled\": " << scheduled
+         << ", \"completed\": " << completed << ", \"errors\": " << errors << ", \"dropped\": " << dropped
+         << ", \"achieved_rps\": " << achieved_rps << ", \"latency\": " << latency_json(latency)
+         << ", \"status_codes\": {";
+    bool first = true;
+    for (const auto& entry : status_codes) {
+        json << (first ? "" : ", ") << "\"" << entry.first << "\": " << entry.second;
+        first = false;
+    }
+    json << "}, \"targets\": {";
+    first = true;
+    for (const auto& entry : latency_by_target) {
+        json << (first ? "" : ", ") << "\"" << entry.first << "\": " << latency_json(entry.second);
+        first = false;
+    }
+    json << "}}\n";
+    return json.str();
+}
+
+// ---------------------------------------------------------------------------
+// HttpLoadGenerator
+
+HttpLoadGenerator::HttpLoadGenerator(const LoadTestConfig& config) : config_(config) {
+    if (config_.targets.empty()) config_.targets.push_back(LoadTarget());
+    double total = 0.0;
+    for (const auto& target : config_.targets) {
+        total += std::max(target.weight, 0.0);
+        cumulative_weights_.push_back(total);
+    }
+    if (total <= 0.0) {
+        for (size_t i = 0; i < cumulative_weights_.size(); ++i) cumulative_weights_[i] = static_cast<double>(i + 1);
+    }
+    config_.connections = std::max<size_t>(config_.connections, 1);
+    config_.requests_per_second = std::max(config_.requests_per_second, 0.001);
+}
+
+size_t HttpLoadGenerator::pick_target(double u) const {
+    double x = u * cumulative_weights_.back();
+    auto it = std::upper_bound(cumulative_weights_.begin(), cumulative_weights_.end(), x);
+    return std::min(static_cast<size_t>(it - cumulative_weights_.begin()), cumulative_weights_.size() - 1);
+}
+
+std::string HttpLoadGenerator::build_request(const LoadTarget& target) const {
+    std::ostringstream req;
+    req << target.method << " " << target.path << " HTTP/1.1\r\n"
+        << "Host: " << config_.host << ":" << config_.port << "\r\n"
+        << "User-Agent: dds-loadgen/1.0\r\n"
+        << "Connection: close\r\n";
+    for (const auto& header : target.headers) req << header.first << ": " << header.second << "\r\n";
+    if (!target.body.empty()) {
+        if (target.headers.find("Content-Type") == target.headers.end()) {
+            req << "Content-Type: application/json\r\n";
+        }
+        req << "Content-Length: " << target.body.size() << "\r\n";
+    }
+    req << "\r\n" << target.body;
+    return req.str();
+}
+
+bool HttpLoadGenerator::send_request(const LoadTarget& target, int& status_code) const {
+    status_code = 0;
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(config_.host.c_str(), std::to_string(config_.port).c_str(), &hints, &addresses) != 0) {
+        return false;
+    }
+
+    int fd = -1;
+    for (addrinfo* a = addresses; a != nullptr; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        timeval tv;
+        tv.tv_sec = static_cast<time_t>(config_.timeout.count() / 1000);
+        tv.tv_usec = static_cast<suseconds_t>((config_.timeout.count() % 1000) * 1000);
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) return false;
+
+    std::string request = build_request(target);
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            close(fd);
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+
+    // Only the status line matters; drain the rest so the server can finish cleanly
+    std::string head;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        if (head.size() < 64) head.append(buffer, static_cast<size_t>(std::min<ssize_t>(n, 64)));
+    }
+    close(fd);
+
+    if (head.compare(0, 5, "HTTP/") != 0) return false;
+    size_t space = head.find(' ');
+    if (space == std::string::npos) return false;
+    status_code = std::atoi(head.c_str() + space + 1);
+    return status_code > 0;
+}
+
+LoadTestReport HttpLoadGenerator::run() {
+    using Clock = std::chrono::steady_clock;
+
+    struct Scheduled {
+        Clock::time_point when;
+        size_t target;
+        bool record;
+    };
+
+    struct WorkerResult {
+        LatencyHistogram latency;
+        std::vector<LatencyHistogram> by_target;
+        std::map<int, uint64_t> status_codes;
+        uint64_t completed = 0;
+        uint64_t errors = 0;
+    };
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<Scheduled> queue;
+    bool done = false;
+
+    std::vector<WorkerResult> results(config_.connections);
+    for (auto& r : results) r.by_target.resize(config_.targets.size());
+
+    auto worker = [&](WorkerResult& result) {
+        for (;;) {
+            Scheduled item;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cv.wait(lock, [&] { return done || !queue.empty(); });
+                if (queue.empty()) return;
+                item = queue.front();
+                queue.pop_front();
+            }
+            int status = 0;
+            bool ok = send_request(config_.targets[item.target], status);
+            auto latency = Clock::now() - item.when;
+            if (!item.record) continue;
+            if (!ok) {
+                ++result.errors;
+                continue;
+            }
+            ++result.completed;
+            ++result.status_codes[status];
+            result.latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(latency));
+            result.by_target[item.target].record(std::chrono::duration_cast<std::chrono::nanoseconds>(latency));
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (auto& r : results) pool.emplace_back(worker, std::ref(r));
+
+    std::cout << "🚦 Load test: " << config_.requests_per_second << " req/s for " << config_.duration.count()
+              << " s against " << config_.host << ":" << config_.port << " (" << config_.connections
+              << " connections, " << (config_.poisson_arrivals ? "Poisson" : "uniform") << " arrivals)" << std::endl;
+
+    LoadTestReport report;
+    std::mt19937_64 rng(config_.seed);
+    std::exponential_distribution<double> gap_dist(config_.requests_per_second);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double fixed_gap = 1.0 / config_.requests_per_second;
+
+    auto start = Clock::now();
+    auto record_from = start + config_.warmup;
+    auto end = record_from + config_.duration;
+    auto next = start;
+
+    while (next < end) {
+        std::this_thread::sleep_until(next);
+        bool record = next >= record_from;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (queue.size() >= config_.max_backlog) {
+                if (record) ++report.dropped;
+            } else {
+                queue.push_back(Scheduled{next, pick_target(uniform(rng)), record});
+            }
+        }
+        queue_cv.notify_one();
+        if (record) ++report.scheduled;
+
+        double gap = config_.poisson_arrivals ? gap_dist(rng) : fixed_gap;
+        next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(gap));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        done = true;
+    }
+    queue_cv.notify_all();
+    for (auto& thread : pool) thread.join();
+
+    report.elapsed_seconds = std::chrono::duration<double>(Clock::now() - record_from).count();
+    for (const auto& r : results) {
+        report.completed += r.completed;
+        report.errors += r.errors;
+        report.latency.merge(r.latency);
+        for (const auto& entry : r.status_codes) report.status_codes[entry.first] += entry.second;
+        for (size_t t = 0; t < config_.targets.size(); ++t) {
+            const auto& target = config_.targets[t];
+            report.latency_by_target[target.method + " " + target.path].merge(r.by_target[t]);
+        }
+    }
+    report.achieved_rps = report.elapsed_seconds > 0.0 ? report.completed / report.elapsed_seconds : 0.0;
+    return report;
+}
+
+} // namespace loadtest
+} // namespace dds
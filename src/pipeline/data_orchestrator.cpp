@@ -10,8 +10,8 @@
 namespace dds {
 namespace pipeline {
 
-PipelineTask::PipelineTask(std::string id, std::string name, std::function<bool(TaskContext&)> executor)
-    : task_id_(std::move(id)), name_(std::move(name)), executor_(std::move(executor)), status_(TaskStatus::PENDING),
+PipelineTask::PipelineTask(const std::string& id, const std::string& name, std::function<bool(TaskContext&)> executor)
+    : task_id_(id), name_(name), executor_(std::move(executor)), status_(TaskStatus::PENDING),
       retry_count_(0), max_retries_(3) {}
 
 bool PipelineTask::execute(TaskContext& context) {
@@ -0,0 +1,589 @@
+#include "../../include/security/audit_log.h"
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <cstring>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace dds {
+namespace security {
+
+namespace {
+
+void put_u32(std::string& out, uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void put_i64(std::string& out, int64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void put_str(std::string& out, const std::string& value) {
+    put_u32(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+bool get_u32(const char*& cursor, const char* end, uint32_t& value) {
+    if (end - cursor < static_cast<std::ptrdiff_t>(sizeof(value))) return false;
+    std::memcpy(&value, cursor, sizeof(value));
+    cursor += sizeof(value);
+    return true;
+}
+
+bool get_i64(const char*& cursor, const char* end, int64_t& value) {
+    if (end - cursor < static_cast<std::ptrdiff_t>(sizeof(value))) return false;
+    std::memcpy(&value, cursor, sizeof(value));
+    cursor += sizeof(value);
+    return true;
+}
+
+bool get_str(const char*& cursor, const char* end, std::string& value) {
+    uint32_t length = 0;
+    if (!get_u32(cursor, end, length)) return false;
+    if (end - cursor < static_cast<std::ptrdiff_t>(length)) return false;
+    value.assign(cursor, length);
+    cursor += length;
+    return true;
+}
+
+std::string segment_file_name(uint32_t segment_id) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "segment_%08u.log", segment_id);
+    return name;
+}
+
+// Drop the ids below first_live from an ascending id list
+void erase_prefix(std::vector<uint64_t>& ids, uint64_t first_live) {
+    ids.erase(ids.begin(), std::lower_bound(ids.begin(), ids.end(), first_live));
+}
+
+} // namespace
+
+AuditLog::AuditLog(const AuditLogConfig& config)
+    : config_(config), staged_count_(0), active_file_(nullptr), running_(false),
+      group_commits_(0), next_record_(0), next_segment_id_(0),
+      last_segments_scanned_(0), last_segments_skipped_(0) {
+    size_t stripe_count = config_.staging_stripes;
+    if (stripe_count == 0) {
+        stripe_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    stripes_.reserve(stripe_count);
+    for (size_t i = 0; i < stripe_count; ++i) {
+        stripes_.push_back(std::make_unique<StagingStripe>());
+    }
+}
+
+AuditLog::~AuditLog() {
+    close();
+}
+
+bool AuditLog::open() {
+    if (running_) return true;
+
+    std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+    if (!in_memory()) {
+        try {
+            std::filesystem::create_directories(config_.directory);
+
+            // Rebuild segment metadata and indexes from what is already on disk
+            std::vector<std::pair<uint32_t, std::string>> existing;
+            for (const auto& entry : std::filesystem::directory_iterator(config_.directory)) {
+                const std::string name = entry.path().filename().string();
+                unsigned int segment_id = 0;
+                if (entry.is_regular_file() && std::sscanf(name.c_str(), "segment_%08u.log", &segment_id) == 1) {
+                    existing.emplace_back(segment_id, entry.path().string());
+                }
+            }
+            std::sort(existing.begin(), existing.end());
+            for (const auto& [segment_id, path] : existing) {
+                recover_segment(path, segment_id);
+                next_segment_id_ = segment_id + 1;
+            }
+        } catch (const std::exception& e) {
+            std::cout << "Failed to open audit log directory " << config_.directory << ": " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    // Recovered segments are sealed; new records always go to a fresh segment
+    if (!open_new_segment()) return false;
+
+    running_ = true;
+    writer_thread_ = std::thread(&AuditLog::writer_loop, this);
+    return true;
+}
+
+void AuditLog::close() {
+    if (running_.exchange(false)) {
+        writer_cv_.notify_all();
+        if (writer_thread_.joinable()) writer_thread_.join();
+    }
+
+    std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+    commit_staged();
+    if (active_file_) {
+        std::fclose(active_file_);
+        active_file_ = nullptr;
+    }
+}
+
+void AuditLog::append(const SecurityEvent& event) {
+    // Counted before it is visible, so a concurrent commit never takes the count below zero
+    size_t staged = staged_count_.fetch_add(1) + 1;
+    size_t stripe_size;
+    {
+        StagingStripe& stripe = local_stripe();
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        stripe.events.push_back(event);
+        stripe_size = stripe.events.size();
+    }
+    if (stripe_size >= config_.group_commit_events || staged >= config_.group_commit_events * stripes_.size()) {
+        writer_cv_.notify_one();
+    }
+}
+
+void AuditLog::flush() {
+    std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+    commit_staged();
+}
+
+AuditLog::StagingStripe& AuditLog::local_stripe() {
+    static thread_local const size_t slot = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return *stripes_[slot % stripes_.size()];
+}
+
+void AuditLog::writer_loop() {
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(writer_mutex_);
+            writer_cv_.wait_for(lock, config_.group_commit_interval, [this] {
+                return !running_ || staged_count_ >= config_.group_commit_events;
+            });
+        }
+        std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+        commit_staged();
+    }
+}
+
+void AuditLog::commit_staged() {
+    if (segments_.empty() || staged_count_ == 0) return;
+    // A segment that failed to open mid-batch is retried before anything is drained
+    if (!active_file_ && !in_memory() && !open_new_segment()) return;
+
+    // Drain every stripe into one batch
+    std::vector<SecurityEvent> batch;
+    for (auto& stripe : stripes_) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        if (stripe->events.empty()) continue;
+        if (batch.empty()) {
+            batch.swap(stripe->events);
+        } else {
+            batch.insert(batch.end(), std::make_move_iterator(stripe->events.begin()),
+                         std::make_move_iterator(stripe->events.end()));
+            stripe->events.clear();
+        }
+    }
+    if (batch.empty()) return;
+    staged_count_ -= batch.size();
+
+    std::stable_sort(batch.begin(), batch.end(),
+        [](const SecurityEvent& a, const SecurityEvent& b) { return a.timestamp < b.timestamp; });
+
+    std::string buffer;
+    buffer.reserve(batch.size() * 128);
+    std::vector<uint64_t> offsets;
+    offsets.reserve(batch.size());
+
+    uint64_t base_offset;
+    {
+        std::lock_guard<std::mutex> lock(index_mutex_);
+        base_offset = segments_.back().bytes;
+    }
+
+    // One write per segment touched by the batch
+    size_t batch_begin = 0;
+    auto write_group = [&](size_t batch_end) {
+        if (buffer.empty()) return;
+        if (active_file_) {
+            std::fwrite(buffer.data(), 1, buffer.size(), active_file_);
+            std::fflush(active_file_);
+#ifndef _WIN32
+            if (config_.fsync_on_commit) ::fsync(fileno(active_file_));
+#endif
+        }
+        std::lock_guard<std::mutex> lock(index_mutex_);
+        Segment& segment = segments_.back();
+        if (in_memory()) segment.data += buffer;
+        for (size_t i = batch_begin; i < batch_end; ++i) {
+            const int64_t ts = to_nanos(batch[i].timestamp);
+            segment.offsets.push_back(offsets[i - batch_begin]);
+            segment.timestamps.push_back(ts);
+            segment.min_timestamp = std::min(segment.min_timestamp, ts);
+            segment.max_timestamp = std::max(segment.max_timestamp, ts);
+            index_record(next_record_++, batch[i]);
+        }
+        segment.bytes += buffer.size();
+        ++group_commits_;
+        buffer.clear();
+        offsets.clear();
+        batch_begin = batch_end;
+    };
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        offsets.push_back(base_offset + buffer.size());
+        encode_event(batch[i], buffer);
+        if (base_offset + buffer.size() >= config_.segment_max_bytes) {
+            write_group(i + 1);
+            if (active_file_) {
+                std::fclose(active_file_);
+                active_file_ = nullptr;
+            }
+            if (!open_new_segment()) {
+                // Put the uncommitted rest back; the next commit retries the segment
+                restage(batch, i + 1);
+                return;
+            }
+            base_offset = 0;
+        }
+    }
+    write_group(batch.size());
+}
+
+void AuditLog::restage(std::vector<SecurityEvent>& batch, size_t from) {
+    if (from >= batch.size()) return;
+    StagingStripe& stripe = *stripes_.front();
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    stripe.events.insert(stripe.events.end(), std::make_move_iterator(batch.begin() + from),
+                         std::make_move_iterator(batch.end()));
+    staged_count_ += batch.size() - from;
+}
+
+bool AuditLog::open_new_segment() {
+    const uint32_t segment_id = next_segment_id_++;
+    std::string path;
+    if (!in_memory()) {
+        path = (std::filesystem::path(config_.directory) / segment_file_name(segment_id)).string();
+        active_file_ = std::fopen(path.c_str(), "wb");
+        if (!active_file_) {
+            std::cout << "Failed to create audit log segment: " << path << std::endl;
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    Segment segment;
+    segment.segment_id = segment_id;
+    segment.path = std::move(path);
+    segment.first_record = next_record_;
+    segment.min_timestamp = std::numeric_limits<int64_t>::max();
+    segment.max_timestamp = std::numeric_limits<int64_t>::min();
+    segment.bytes = 0;
+    segments_.push_back(std::move(segment));
+
+    while (config_.max_segments > 0 && segments_.size() > config_.max_segments) {
+        retire_oldest_segment();
+    }
+    return true;
+}
+
+bool AuditLog::recover_segment(const std::string& path, uint32_t segment_id) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    std::string content;
+    char chunk[65536];
+    size_t read_bytes;
+    while ((read_bytes = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        content.append(chunk, read_bytes);
+    }
+    std::fclose(file);
+
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    Segment segment;
+    segment.segment_id = segment_id;
+    segment.path = path;
+    segment.first_record = next_record_;
+    segment.min_timestamp = std::numeric_limits<int64_t>::max();
+    segment.max_timestamp = std::numeric_limits<int64_t>::min();
+    segment.bytes = 0;
+
+    // A torn tail from a crash simply ends the segment
+    const char* cursor = content.data();
+    const char* end = cursor + content.size();
+    SecurityEvent event;
+    while (cursor < end) {
+        const char* record_start = cursor;
+        uint32_t length = 0;
+        if (!get_u32(cursor, end, length) || end - cursor < static_cast<std::ptrdiff_t>(length)) break;
+        if (!decode_event(cursor, length, event)) break;
+        cursor += length;
+
+        const int64_t ts = to_nanos(event.timestamp);
+        segment.offsets.push_back(static_cast<uint64_t>(record_start - content.data()));
+        segment.timestamps.push_back(ts);
+        segment.min_timestamp = std::min(segment.min_timestamp, ts);
+        segment.max_timestamp = std::max(segment.max_timestamp, ts);
+        segment.bytes = static_cast<uint64_t>(cursor - content.data());
+        index_record(next_record_++, event);
+    }
+    segments_.push_back(std::move(segment));
+    return true;
+}
+
+void AuditLog::index_record(uint64_t record_id, const SecurityEvent& event) {
+    type_index_[static_cast<size_t>(event.event_type)].push_back(record_id);
+    severity_index_[static_cast<size_t>(event.severity)].push_back(record_id);
+    if (!event.user_id.empty()) user_index_[event.user_id].push_back(record_id);
+    if (!event.ip_address.empty()) ip_index_[event.ip_address].push_back(record_id);
+}
+
+void AuditLog::retire_oldest_segment() {
+    if (segments_.size() < 2) return;
+
+    const Segment& oldest = segments_.front();
+    if (!oldest.path.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(oldest.path, ec);
+    }
+    const uint64_t first_live = segments_[1].first_record;
+
+    for (auto& ids : type_index_) erase_prefix(ids, first_live);
+    for (auto& ids : severity_index_) erase_prefix(ids, first_live);
+    for (auto* index : {&user_index_, &ip_index_}) {
+        for (auto it = index->begin(); it != index->end();) {
+            erase_prefix(it->second, first_live);
+            it = it->second.empty() ? index->erase(it) : std::next(it);
+        }
+    }
+    for (auto it = investigated_.begin(); it != investigated_.end();) {
+        it = (*it < first_live) ? investigated_.erase(it) : std::next(it);
+    }
+    segments_.pop_front();
+}
+
+const AuditLog::Segment* AuditLog::find_segment(uint64_t record_id) const {
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), record_id,
+        [](uint64_t id, const Segment& segment) { return id < segment.first_record; });
+    if (it == segments_.begin()) return nullptr;
+    --it;
+    if (record_id - it->first_record >= it->offsets.size()) return nullptr;
+    return &*it;
+}
+
+std::vector<std::pair<uint64_t, SecurityEvent>> AuditLog::read_records(const std::vector<uint64_t>& record_ids) {
+    std::vector<std::pair<uint64_t, SecurityEvent>> records;
+    records.reserve(record_ids.size());
+
+    const Segment* current = nullptr;
+    std::FILE* file = nullptr;
+    std::string payload;
+    for (uint64_t record_id : record_ids) {
+        const Segment* segment = find_segment(record_id);
+        if (!segment) continue;
+        if (in_memory()) {
+            // Same layout as a segment file: length prefix, then the payload
+            const char* cursor = segment->data.data() + segment->offsets[record_id - segment->first_record];
+            const char* end = segment->data.data() + segment->data.size();
+            uint32_t length = 0;
+            SecurityEvent event;
+            if (get_u32(cursor, end, length) && end - cursor >= static_cast<std::ptrdiff_t>(length) &&
+                decode_event(cursor, length, event)) {
+                event.investigated = investigated_.count(record_id) > 0;
+                records.emplace_back(record_id, std::move(event));
+            }
+            continue;
+        }
+        if (segment != current) {
+            if (file) std::fclose(file);
+            file = std::fopen(segment->path.c_str(), "rb");
+            current = segment;
+            if (!file) continue;
+        }
+        if (!file) continue;
+
+        uint32_t length = 0;
+        std::fseek(file, static_cast<long>(segment->offsets[record_id - segment->first_record]), SEEK_SET);
+        if (std::fread(&length, sizeof(length), 1, file) != 1) continue;
+        payload.resize(length);
+        if (std::fread(&payload[0], 1, length, file) != length) continue;
+
+        SecurityEvent event;
+        if (decode_event(payload.data(), payload.size(), event)) {
+            event.investigated = investigated_.count(record_id) > 0;
+            records.emplace_back(record_id, std::move(event));
+        }
+    }
+    if (file) std::fclose(file);
+    return records;
+}
+
+std::vector<SecurityEvent> AuditLog::read_events(const std::vector<uint64_t>& record_ids) {
+    auto records = read_records(record_ids);
+    std::vector<SecurityEvent> events;
+    events.reserve(records.size());
+    for (auto& record : records) events.push_back(std::move(record.second));
+    return events;
+}
+
+std::vector<SecurityEvent> AuditLog::query_by_type(SecurityEventType type) {
+    flush();
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    return read_events(type_index_[static_cast<size_t>(type)]);
+}
+
+std::vector<SecurityEvent> AuditLog::query_by_severity(SecuritySeverity severity) {
+    flush();
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    return read_events(severity_index_[static_cast<size_t>(severity)]);
+}
+
+std::vector<SecurityEvent> AuditLog::query_by_user(const std::string& user_id) {
+    flush();
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    auto it = user_index_.find(user_id);
+    return it != user_index_.end() ? read_events(it->second) : std::vector<SecurityEvent>();
+}
+
+std::vector<SecurityEvent> AuditLog::query_by_ip(const std::string& ip_address) {
+    flush();
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    auto it = ip_index_.find(ip_address);
+    return it != ip_index_.end() ? read_events(it->second) : std::vector<SecurityEvent>();
+}
+
+std::vector<SecurityEvent> AuditLog::query_time_range(std::chrono::system_clock::time_point from,
+                                                      std::chrono::system_clock::time_point to) {
+    flush();
+    const int64_t from_ns = to_nanos(from);
+    const int64_t to_ns = to_nanos(to);
+
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    std::vector<uint64_t> matches;
+    last_segments_scanned_ = 0;
+    last_segments_skipped_ = 0;
+    for (const auto& segment : segments_) {
+        if (segment.offsets.empty() || segment.max_timestamp < from_ns || segment.min_timestamp > to_ns) {
+            ++last_segments_skipped_;
+            continue;
+        }
+        ++last_segments_scanned_;
+        for (size_t i = 0; i < segment.timestamps.size(); ++i) {
+            if (segment.timestamps[i] >= from_ns && segment.timestamps[i] <= to_ns) {
+                matches.push_back(segment.first_record + i);
+            }
+        }
+    }
+    return read_events(matches);
+}
+
+void AuditLog::for_each(const std::function<void(uint64_t, const SecurityEvent&)>& visitor) {
+    flush();
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    for (const auto& segment : segments_) {
+        std::vector<uint64_t> ids(segment.offsets.size());
+        for (size_t i = 0; i < ids.size(); ++i) ids[i] = segment.first_record + i;
+        // Unreadable records are skipped, so ids come back with their events
+        for (const auto& [record_id, event] : read_records(ids)) visitor(record_id, event);
+    }
+}
+
+size_t AuditLog::size() {
+    // A commit moves events from staged to indexed under commit_mutex_
+    std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    size_t committed = segments_.empty() ? 0 : next_record_ - segments_.front().first_record;
+    return committed + staged_count_;
+}
+
+size_t AuditLog::count_by_type(SecurityEventType type) {
+    flush();
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    return type_index_[static_cast<size_t>(type)].size();
+}
+
+size_t AuditLog::count_by_severity(SecuritySeverity severity) {
+    flush();
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    return severity_index_[static_cast<size_t>(severity)].size();
+}
+
+bool AuditLog::mark_investigated(uint64_t record_id) {
+    flush();
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    if (!find_segment(record_id)) return false;
+    investigated_.insert(record_id);
+    return true;
+}
+
+size_t AuditLog::drop_segments_before(std::chrono::system_clock::time_point cutoff) {
+    const int64_t cutoff_ns = to_nanos(cutoff);
+    std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+    commit_staged();
+
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    size_t dropped = 0;
+    // The active segment is never retired
+    while (segments_.size() > 1 && segments_.front().max_timestamp < cutoff_ns) {
+        dropped += segments_.front().offsets.size();
+        retire_oldest_segment();
+    }
+    return dropped;
+}
+
+AuditLogStats AuditLog::get_stats() {
+    std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    AuditLogStats stats{};
+    stats.total_events = segments_.empty() ? 0 : next_record_ - segments_.front().first_record;
+    stats.staged_events = staged_count_;
+    stats.segment_count = segments_.size();
+    for (const auto& segment : segments_) stats.bytes_on_disk += segment.bytes;
+    stats.group_commits = group_commits_;
+    stats.segments_scanned = last_segments_scanned_;
+    stats.segments_skipped = last_segments_skipped_;
+    return stats;
+}
+
+void AuditLog::encode_event(const SecurityEvent& event, std::string& out) {
+    const size_t header_pos = out.size();
+    put_u32(out, 0);  // Patched with the payload length below
+    out.push_back(static_cast<char>(event.event_type));
+    out.push_back(static_cast<char>(event.severity));
+    put_i64(out, to_nanos(event.timestamp));
+    put_str(out, event.user_id);
+    put_str(out, event.ip_address);
+    put_str(out, event.resource);
+    put_str(out, event.description);
+    put_str(out, event.user_agent);
+    const uint32_t length = static_cast<uint32_t>(out.size() - header_pos - sizeof(uint32_t));
+    std::memcpy(&out[header_pos], &length, sizeof(length));
+}
+
+bool AuditLog::decode_event(const char* data, size_t size, SecurityEvent& event) {
+    const char* cursor = data;
+    const char* end = data + size;
+    if (size < 2) return false;
+    const auto type = static_cast<uint8_t>(*cursor++);
+    const auto severity = static_cast<uint8_t>(*cursor++);
+    if (type >= kSecurityEventTypeCount || severity >= kSecuritySeverityCount) return false;
+    event.event_type = static_cast<SecurityEventType>(type);
+    event.severity = static_cast<SecuritySeverity>(severity);
+
+    int64_t nanos = 0;
+    if (!get_i64(cursor, end, nanos)) return false;
+    event.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanos)));
+    event.investigated = false;
+    return get_str(cursor, end, event.user_id) && get_str(cursor, end, event.ip_address) &&
+           get_str(cursor, end, event.resource) && get_str(cursor, end, event.description) &&
+           get_str(cursor, end, event.user_agent);
+}
+
+int64_t AuditLog::to_nanos(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+} // namespace security
+} // namespace dds
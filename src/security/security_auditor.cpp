@@ -9,41 +9,64 @@
 namespace dds {
 namespace security {
 
+namespace {
+
+AuditLogConfig log_config_for(const std::string& log_directory) {
+    AuditLogConfig config;
+    config.directory = log_directory;
+    return config;
+}
+
+} // namespace
+
+SecurityAuditor::SecurityAuditor(const std::string& log_directory, const ThreatScorerConfig& scorer_config)
+    : SecurityAuditor(log_config_for(log_directory), scorer_config) {}
+
+SecurityAuditor::SecurityAuditor(const AuditLogConfig& log_config, const ThreatScorerConfig& scorer_config)
+    : audit_log_(log_config), threat_scorer_(scorer_config), enabled_(true), brute_force_threshold_(5) {
+    // Nothing would commit staged events, so stay disabled rather than buffer forever
+    if (!audit_log_.open()) {
+        std::cout << "Failed to open the security audit log; auditing disabled" << std::endl;
+        enabled_ = false;
+    }
+}
+
 void SecurityAuditor::log_event(SecurityEventType type, SecuritySeverity severity,
                                 const std::string& user_id, const std::string& ip_address,
                                 const std::string& resource, const std::string& description,
                                 const std::string& user_agent) {
     if (!enabled_) return;
 
-    std::lock_guard<std::mutex> lock(audit_mutex_);
-
     SecurityEvent event{
         type, severity, user_id, ip_address, resource, description, user_agent,
         std::chrono::system_clock::now(), false
     };
 
-    audit_log_.push_back(event);
-
-    detect_threats(event);
+    // Staged only; the audit log writer commits it off this thread
+    audit_log_.append(event);
 
-    if (audit_log_.size() > max_log_size_) {
-        audit_log_.erase(audit_log_.begin(), audit_log_.begin() + (audit_log_.size() - max_log_size_));
-    }
+    bool injection_detected = detect_threats(event);
 
     if (severity == SecuritySeverity::HIGH || severity == SecuritySeverity::CRITICAL) {
         std::cout << "🚨 SECURITY ALERT [" << severity_to_string(severity) << "]: "
                   << event_type_to_string(type) << " from " << ip_address << std::endl;
     }
+
+    if (injection_detected) {
+        log_event(SecurityEventType::SQL_INJECTION_ATTEMPT, SecuritySeverity::HIGH,
+                  user_id, ip_address, resource, "Potential injection attempt detected");
+    }
 }
 
+// Failures are counted over the scorer's sliding window; a success does not clear
+// them (sketch counters cannot be decremented safely), they simply age out.
 void SecurityAuditor::log_login_attempt(const std::string& user_id, const std::string& ip_address, bool success) {
     if (success) {
         log_event(SecurityEventType::LOGIN_SUCCESS, SecuritySeverity::LOW, user_id, ip_address,
                   "", "Successful login");
-        failed_login_attempts_[ip_address] = 0;
     } else {
-        int& attempts = failed_login_attempts_[ip_address];
-        ++attempts;
+        int attempts = static_cast<int>(
+            threat_scorer_.record_login_failure(ip_address, std::chrono::system_clock::now()));
         SecuritySeverity severity = (attempts >= brute_force_threshold_)
                                    ? SecuritySeverity::HIGH : SecuritySeverity::MEDIUM;
 
@@ -73,91 +96,64 @@ void SecurityAuditor::log_suspicious_activity(const std::string& description, co
 }
 
 std::vector<SecurityEvent> SecurityAuditor::get_events_by_type(SecurityEventType type) const {
-    std::lock_guard<std::mutex> lock(audit_mutex_);
-    std::vector<SecurityEvent> filtered_events;
-    filtered_events.reserve(audit_log_.size());
-    for (const auto& event : audit_log_) {
-        if (event.event_type == type) filtered_events.push_back(event);
-    }
-    filtered_events.shrink_to_fit();
-    return filtered_events;
+    return audit_log_.query_by_type(type);
 }
 
 std::vector<SecurityEvent> SecurityAuditor::get_events_by_severity(SecuritySeverity severity) const {
-    std::lock_guard<std::mutex> lock(audit_mutex_);
-    std::vector<SecurityEvent> filtered_events;
-    filtered_events.reserve(audit_log_.size());
-    for (const auto& event : audit_log_) {
-        if (event.severity == severity) filtered_events.push_back(event);
-    }
-    filtered_events.shrink_to_fit();
-    return filtered_events;
+    return audit_log_.query_by_severity(severity);
+}
+
+std::vector<SecurityEvent> SecurityAuditor::get_events_by_user(const std::string& user_id) const {
+    return audit_log_.query_by_user(user_id);
 }
 
 std::vector<SecurityEvent> SecurityAuditor::get_events_by_ip(const std::string& ip_address) const {
-    std::lock_guard<std::mutex> lock(audit_mutex_);
-    std::vector<SecurityEvent> filtered_events;
-    filtered_events.reserve(audit_log_.size());
-    for (const auto& event : audit_log_) {
-        if (event.ip_address == ip_address) filtered_events.push_back(event);
-    }
-    filtered_events.shrink_to_fit();
-    return filtered_events;
+    return audit_log_.query_by_ip(ip_address);
 }
 
 std::vector<SecurityEvent> SecurityAuditor::get_recent_events(int hours) const {
-    std::lock_guard<std::mutex> lock(audit_mutex_);
-    std::vector<SecurityEvent> recent_events;
-    auto cutoff_time = std::chrono::system_clock::now() - std::chrono::hours(hours);
-    recent_events.reserve(audit_log_.size());
-    for (const auto& event : audit_log_) {
-        if (event.timestamp >= cutoff_time) recent_events.push_back(event);
-    }
-    recent_events.shrink_to_fit();
-    return recent_events;
+    auto now = std::chrono::system_clock::now();
+    return audit_log_.query_time_range(now - std::chrono::hours(hours), now);
+}
+
+std::vector<SecurityEvent> SecurityAuditor::get_events_between(std::chrono::system_clock::time_point from,
+                                                               std::chrono::system_clock::time_point to) const {
+    return audit_log_.query_time_range(from, to);
 }
 
 std::vector<ThreatAssessment> SecurityAuditor::get_active_threats() const {
-    std::lock_guard<std::mutex> lock(audit_mutex_);
     std::vector<ThreatAssessment> active_threats;
-    active_threats.reserve(threats_.size());
-    for (const auto& pair : threats_) {
-        if (pair.second.risk_score >= 50) active_threats.push_back(pair.second);
+    for (auto& threat : threat_scorer_.top_threats(threat_scorer_.get_config().tracked_sources)) {
+        if (threat.risk_score >= 50) active_threats.push_back(std::move(threat));
     }
-    std::sort(active_threats.begin(), active_threats.end(),
-        [](const ThreatAssessment& a, const ThreatAssessment& b) {
-            return a.risk_score > b.risk_score;
-        });
-    active_threats.shrink_to_fit();
     return active_threats;
 }
 
+ThreatAssessment SecurityAuditor::analyze_ip_behavior(const std::string& ip_address) const {
+    return threat_scorer_.assess(ip_address);
+}
+
 bool SecurityAuditor::is_brute_force_attack(const std::string& ip_address) const {
-    auto it = failed_login_attempts_.find(ip_address);
-    return it != failed_login_attempts_.end() && it->second >= brute_force_threshold_;
+    return static_cast<int>(threat_scorer_.login_failures(ip_address)) >= brute_force_threshold_;
 }
 
 std::vector<std::string> SecurityAuditor::get_suspicious_ips() const {
     std::vector<std::string> suspicious_ips;
-    suspicious_ips.reserve(failed_login_attempts_.size());
-    for (const auto& pair : failed_login_attempts_) {
-        if (pair.second >= brute_force_threshold_ / 2) suspicious_ips.push_back(pair.first);
+    for (const auto& source : threat_scorer_.top_login_failures(threat_scorer_.get_config().tracked_sources)) {
+        if (static_cast<int>(source.second) >= brute_force_threshold_ / 2) suspicious_ips.push_back(source.first);
     }
-    suspicious_ips.shrink_to_fit();
     return suspicious_ips;
 }
 
 int SecurityAuditor::get_events_count_by_severity(SecuritySeverity severity) const {
-    std::lock_guard<std::mutex> lock(audit_mutex_);
-    return std::count_if(audit_log_.begin(), audit_log_.end(),
-        [severity](const SecurityEvent& event) { return event.severity == severity; });
+    return static_cast<int>(audit_log_.count_by_severity(severity));
 }
 
 double SecurityAuditor::get_security_score() const {
-    if (audit_log_.empty()) return 100.0;
+    int total_events = get_total_events();
+    if (total_events == 0) return 100.0;
     int critical_events = get_events_count_by_severity(SecuritySeverity::CRITICAL);
     int high_events = get_events_count_by_severity(SecuritySeverity::HIGH);
-    int total_events = static_cast<int>(audit_log_.size());
     double score = 100.0 - ((critical_events * 10.0 + high_events * 5.0) / total_events * 100.0);
     return std::clamp(score, 0.0, 100.0);
 }
@@ -179,7 +175,7 @@ void SecurityAuditor::print_security_summary() const {
     std::cout << "Suspicious IPs: " << suspicious_ips.size() << std::endl;
 
     for (const auto& ip : suspicious_ips) {
-        std::cout << "  • " << ip << " (" << failed_login_attempts_.at(ip) << " failed attempts)" << std::endl;
+        std::cout << "  • " << ip << " (" << threat_scorer_.login_failures(ip) << " failed attempts)" << std::endl;
     }
 }
 
@@ -195,8 +191,10 @@ void SecurityAuditor::print_threat_report() const {
         std::cout << "Source IP: " << threat.source_ip << std::endl;
         std::cout << "Risk Score: " << threat.risk_score << "/100" << std::endl;
         std::cout << "Event Count: " << threat.event_count << std::endl;
-        std::cout << "First Seen: " << std::put_time(std::localtime(&std::chrono::system_clock::to_time_t(threat.first_seen)), "%Y-%m-%d %H:%M:%S") << std::endl;
-        std::cout << "Last Seen: " << std::put_time(std::localtime(&std::chrono::system_clock::to_time_t(threat.last_seen)), "%Y-%m-%d %H:%M:%S") << std::endl;
+        auto first_seen = std::chrono::system_clock::to_time_t(threat.first_seen);
+        auto last_seen = std::chrono::system_clock::to_time_t(threat.last_seen);
+        std::cout << "First Seen: " << std::put_time(std::localtime(&first_seen), "%Y-%m-%d %H:%M:%S") << std::endl;
+        std::cout << "Last Seen: " << std::put_time(std::localtime(&last_seen), "%Y-%m-%d %H:%M:%S") << std::endl;
     }
 }
 
@@ -207,7 +205,7 @@ void SecurityAuditor::export_audit_log(const std::string& filename) const {
         return;
     }
     file << "Timestamp,EventType,Severity,UserID,IPAddress,Resource,Description,UserAgent,Investigated\n";
-    for (const auto& event : audit_log_) {
+    audit_log_.for_each([&](uint64_t, const SecurityEvent& event) {
         auto time_t = std::chrono::system_clock::to_time_t(event.timestamp);
         file << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S") << ","
              << event_type_to_string(event.event_type) << ","
@@ -218,42 +216,30 @@ void SecurityAuditor::export_audit_log(const std::string& filename) const {
              << event.description << ","
              << event.user_agent << ","
              << (event.investigated ? "Yes" : "No") << "\n";
-    }
+    });
     std::cout << "Audit log exported to: " << filename << std::endl;
 }
 
-void SecurityAuditor::detect_threats(const SecurityEvent& event) {
-    update_threat_assessment(event.ip_address, event);
-    if (is_injection_attempt(event.description) || is_injection_attempt(event.resource)) {
-        if (event.event_type != SecurityEventType::SQL_INJECTION_ATTEMPT &&
-            event.event_type != SecurityEventType::XSS_ATTEMPT) {
-            log_event(SecurityEventType::SQL_INJECTION_ATTEMPT, SecuritySeverity::HIGH,
-                      event.user_id, event.ip_address, event.resource, "Potential injection attempt detected");
-        }
-    }
+void SecurityAuditor::clear_old_events(int days_old) {
+    auto cutoff = std::chrono::system_clock::now() - std::chrono::hours(24 * days_old);
+    size_t dropped = audit_log_.drop_segments_before(cutoff);
+    std::cout << "Retired " << dropped << " audit events older than " << days_old << " days" << std::endl;
 }
 
-void SecurityAuditor::update_threat_assessment(const std::string& ip_address, const SecurityEvent& event) {
-    auto& threat = threats_[ip_address];
-    if (threat.threat_id.empty()) {
-        threat.threat_id = "THREAT_" + ip_address;
-        threat.source_ip = ip_address;
-        threat.first_seen = event.timestamp;
-        threat.event_count = 0;
-        threat.risk_score = 0;
+void SecurityAuditor::mark_event_investigated(size_t event_index) {
+    if (!audit_log_.mark_investigated(event_index)) {
+        std::cout << "Audit event not found: " << event_index << std::endl;
     }
-    threat.last_seen = event.timestamp;
-    ++threat.event_count;
-    threat.event_pattern.push_back(event.event_type);
-
-    int severity_score = 0;
-    switch (event.severity) {
-        case SecuritySeverity::LOW: severity_score = 1; break;
-        case SecuritySeverity::MEDIUM: severity_score = 3; break;
-        case SecuritySeverity::HIGH: severity_score = 7; break;
-        case SecuritySeverity::CRITICAL: severity_score = 15; break;
+}
+
+// Returns true when a follow-up injection event should be logged
+bool SecurityAuditor::detect_threats(const SecurityEvent& event) {
+    threat_scorer_.record_event(event);
+    if (is_injection_attempt(event.description) || is_injection_attempt(event.resource)) {
+        return event.event_type != SecurityEventType::SQL_INJECTION_ATTEMPT &&
+               event.event_type != SecurityEventType::XSS_ATTEMPT;
     }
-    threat.risk_score = std::min(100, threat.risk_score + severity_score);
+    return false;
 }
 
 bool SecurityAuditor::is_injection_attempt(const std::string& input) const {
@@ -0,0 +1,169 @@
+#include "../../include/security/threat_scorer.h"
+#include <algorithm>
+
+namespace dds {
+namespace security {
+
+namespace {
+
+int64_t to_nanos(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point from_nanos(int64_t ns) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+} // namespace
+
+ThreatScorer::ThreatScorer(const ThreatScorerConfig& config)
+    : config_(config),
+      failures_(config.window, config.window_slices, config.sketch_width, config.sketch_depth),
+      risk_(config.window, config.window_slices, config.sketch_width, config.sketch_depth),
+      events_(config.window, config.window_slices, config.sketch_width, config.sketch_depth),
+      risky_sources_(config.tracked_sources),
+      failing_sources_(config.tracked_sources),
+      last_decay_epoch_(-1) {}
+
+uint32_t ThreatScorer::severity_weight(SecuritySeverity severity) {
+    switch (severity) {
+        case SecuritySeverity::LOW: return 1;
+        case SecuritySeverity::MEDIUM: return 3;
+        case SecuritySeverity::HIGH: return 7;
+        case SecuritySeverity::CRITICAL: return 15;
+    }
+    return 1;
+}
+
+// Heavy-hitter counts are halved once per window so stale sources fall out
+void ThreatScorer::maybe_decay(std::chrono::system_clock::time_point now) {
+    int64_t window_ns = std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(config_.window).count(), 1);
+    int64_t epoch = to_nanos(now) / window_ns;
+    if (last_decay_epoch_ < 0) {
+        last_decay_epoch_ = epoch;
+        return;
+    }
+    if (epoch > last_decay_epoch_) {
+        unsigned shift = static_cast<unsigned>(std::min<int64_t>(epoch - last_decay_epoch_, 63));
+        risky_sources_.decay(shift);
+        failing_sources_.decay(shift);
+        last_decay_epoch_ = epoch;
+    }
+}
+
+int ThreatScorer::record_event(const SecurityEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maybe_decay(event.timestamp);
+
+    uint64_t hash = utils::sketch_hash(event.ip_address);
+    uint32_t weight = severity_weight(event.severity);
+    uint32_t risk = risk_.add_hash(hash, event.timestamp, weight);
+    events_.add_hash(hash, event.timestamp);
+
+    auto& entry = risky_sources_.offer(event.ip_address, weight);
+    int64_t now_ns = to_nanos(event.timestamp);
+    if (entry.payload.event_count == 0) entry.payload.first_seen_ns = now_ns;
+    entry.payload.last_seen_ns = now_ns;
+    entry.payload.event_types |= 1u << static_cast<unsigned>(event.event_type);
+    ++entry.payload.event_count;
+
+    return static_cast<int>(std::min<uint32_t>(risk, 100));
+}
+
+uint32_t ThreatScorer::record_login_failure(const std::string& ip_address,
+                                            std::chrono::system_clock::time_point when) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maybe_decay(when);
+    failing_sources_.offer(ip_address);
+    return failures_.add(ip_address, when);
+}
+
+uint32_t ThreatScorer::login_failures(const std::string& ip_address) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failures_.estimate(ip_address, std::chrono::system_clock::now());
+}
+
+int ThreatScorer::risk_score(const std::string& ip_address) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t risk = risk_.estimate(ip_address, std::chrono::system_clock::now());
+    return static_cast<int>(std::min<uint32_t>(risk, 100));
+}
+
+ThreatAssessment ThreatScorer::build_assessment(const std::string& ip_address, const SourceInfo* info,
+                                                std::chrono::system_clock::time_point now) const {
+    uint64_t hash = utils::sketch_hash(ip_address);
+    ThreatAssessment threat;
+    threat.threat_id = "THREAT_" + ip_address;
+    threat.source_ip = ip_address;
+    threat.risk_score = static_cast<int>(std::min<uint32_t>(risk_.estimate_hash(hash, now), 100));
+    threat.event_count = static_cast<int>(events_.estimate_hash(hash, now));
+    if (info) {
+        for (size_t t = 0; t < kSecurityEventTypeCount; ++t) {
+            if (info->event_types & (1u << t)) threat.event_pattern.push_back(static_cast<SecurityEventType>(t));
+        }
+        threat.first_seen = from_nanos(info->first_seen_ns);
+        threat.last_seen = from_nanos(info->last_seen_ns);
+    } else {
+        // Not a heavy hitter: only the windowed counts are known
+        threat.first_seen = now - config_.window;
+        threat.last_seen = now;
+    }
+    return threat;
+}
+
+ThreatAssessment ThreatScorer::assess(const std::string& ip_address) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = risky_sources_.find(ip_address);
+    return build_assessment(ip_address, entry ? &entry->payload : nullptr, std::chrono::system_clock::now());
+}
+
+std::vector<ThreatAssessment> ThreatScorer::top_threats(size_t limit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::system_clock::now();
+    std::vector<ThreatAssessment> threats;
+    for (const auto& entry : risky_sources_.top(risky_sources_.size())) {
+        threats.push_back(build_assessment(entry.key, &entry.payload, now));
+    }
+    std::sort(threats.begin(), threats.end(),
+        [](const ThreatAssessment& a, const ThreatAssessment& b) {
+            return a.risk_score > b.risk_score;
+        });
+    if (threats.size() > limit) threats.resize(limit);
+    return threats;
+}
+
+std::vector<std::pair<std::string, uint32_t>> ThreatScorer::top_login_failures(size_t limit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::system_clock::now();
+    std::vector<std::pair<std::string, uint32_t>> result;
+    for (const auto& entry : failing_sources_.top(failing_sources_.size())) {
+        uint32_t failures = failures_.estimate(entry.key, now);
+        if (failures > 0) result.emplace_back(entry.key, failures);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const auto& a, const auto& b) { return a.second > b.second; });
+    if (result.size() > limit) result.resize(limit);
+    return result;
+}
+
+void ThreatScorer::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    failures_.clear();
+    risk_.clear();
+    events_.clear();
+    risky_sources_.clear();
+    failing_sources_.clear();
+    last_decay_epoch_ = -1;
+}
+
+size_t ThreatScorer::memory_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t heavy = config_.tracked_sources * 2 *
+                   (sizeof(utils::SpaceSaving<SourceInfo>::Entry) + sizeof(std::string) + sizeof(size_t));
+    return failures_.memory_bytes() + risk_.memory_bytes() + events_.memory_bytes() + heavy;
+}
+
+} // namespace security
+} // namespace dds
@@ -4,17 +4,61 @@
 #include <sstream>
 #include <algorithm>
 #include <cstring>
+#include <cmath>
 #include <ctime>
 #include <filesystem>
+#include <limits>
+#include <mutex>
 
 namespace dds {
 namespace storage {
 
+namespace {
+
+// Binary datasets store float32 or float64; either loads into the build's Scalar
+bool supported_scalar_bytes(uint32_t bytes) {
+    return bytes == sizeof(float) || bytes == sizeof(double);
+}
+
+Scalar read_scalar(const char* src, uint32_t bytes) {
+    if (bytes == sizeof(float)) {
+        float v;
+        std::memcpy(&v, src, sizeof(v));
+        return static_cast<Scalar>(v);
+    }
+    double v;
+    std::memcpy(&v, src, sizeof(v));
+    return static_cast<Scalar>(v);
+}
+
+void read_scalars(const char* src, uint32_t bytes, Scalar* dst, size_t count) {
+    if (bytes == sizeof(Scalar)) {
+        std::memcpy(dst, src, count * sizeof(Scalar));
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) dst[i] = read_scalar(src + i * bytes, bytes);
+}
+
+// Feature and label byte counts of a dense dataset whose body holds `available`
+// bytes. A header claiming more than that is rejected before rows * cols is formed.
+bool dense_dataset_bytes(const BinaryDatasetHeader& header, uint64_t available,
+                         size_t& feature_bytes, size_t& label_bytes) {
+    if (header.cols > static_cast<uint64_t>(std::numeric_limits<Index>::max())) return false;
+    const uint64_t max_scalars = available / header.scalar_bytes;
+    if (header.rows > max_scalars / (header.cols + 1)) return false;
+    feature_bytes = static_cast<size_t>(header.rows * header.cols * header.scalar_bytes);
+    label_bytes = static_cast<size_t>(header.rows * header.scalar_bytes);
+    return true;
+}
+
+} // namespace
+
 // Forward declarations for stub implementations
 struct HDFSConnection {
     std::string host;
     int port;
     bool connected;
+    std::mutex error_mutex;     // Shard writers share one storage and may fail together
     std::string last_error;
 };
 
@@ -68,7 +112,7 @@ bool HadoopStorage::connect() {
     // In a real implementation, this would connect to HDFS
     // For now, we'll simulate a connection
     connection_->connected = true;
-    connection_->last_error.clear();
+    clear_error();
     
     std::cout << "Connected to HDFS at " << config_->hdfs_url << std::endl;
     return true;
@@ -109,7 +153,7 @@ bool HadoopStorage::create_file(const std::string& path, const std::string& cont
         // Write file
         std::ofstream file(local_path, std::ios::binary);
         if (!file.is_open()) {
-            connection_->last_error = "Failed to create file: " + path;
+            set_error("Failed to create file: " + path);
             return false;
         }
         
@@ -119,7 +163,7 @@ bool HadoopStorage::create_file(const std::string& path, const std::string& cont
         std::cout << "Created HDFS file: " << path << std::endl;
         return true;
     } catch (const std::exception& e) {
-        connection_->last_error = "Exception creating file: " + std::string(e.what());
+        set_error("Exception creating file: " + std::string(e.what()));
         return false;
     }
 }
@@ -135,7 +179,7 @@ bool HadoopStorage::create_file(const std::string& path, const std::vector<char>
         
         std::ofstream file(local_path, std::ios::binary);
         if (!file.is_open()) {
-            connection_->last_error = "Failed to create file: " + path;
+            set_error("Failed to create file: " + path);
             return false;
         }
         
@@ -145,7 +189,7 @@ bool HadoopStorage::create_file(const std::string& path, const std::vector<char>
         std::cout << "Created HDFS file: " << path << std::endl;
         return true;
     } catch (const std::exception& e) {
-        connection_->last_error = "Exception creating file: " + std::string(e.what());
+        set_error("Exception creating file: " + std::string(e.what()));
         return false;
     }
 }
@@ -158,13 +202,13 @@ bool HadoopStorage::read_file(const std::string& path, std::string& content) {
     try {
         std::filesystem::path local_path = "hdfs_stub/" + path;
         if (!std::filesystem::exists(local_path)) {
-            connection_->last_error = "File not found: " + path;
+            set_error("File not found: " + path);
             return false;
         }
         
         std::ifstream file(local_path, std::ios::binary);
         if (!file.is_open()) {
-            connection_->last_error = "Failed to open file: " + path;
+            set_error("Failed to open file: " + path);
             return false;
         }
         
@@ -176,7 +220,39 @@ bool HadoopStorage::read_file(const std::string& path, std::string& content) {
         std::cout << "Read HDFS file: " << path << " (" << content.size() << " bytes)" << std::endl;
         return true;
     } catch (const std::exception& e) {
-        connection_->last_error = "Exception reading file: " + std::string(e.what());
+        set_error("Exception reading file: " + std::string(e.what()));
+        return false;
+    }
+}
+
+bool HadoopStorage::read_file_range(const std::string& path, uint64_t offset, size_t length,
+                                    std::vector<char>& data) {
+    if (!ensure_connected()) {
+        return false;
+    }
+    
+    try {
+        std::filesystem::path local_path = "hdfs_stub/" + path;
+        if (!std::filesystem::exists(local_path)) {
+            set_error("File not found: " + path);
+            return false;
+        }
+        
+        std::ifstream file(local_path, std::ios::binary);
+        if (!file.is_open()) {
+            set_error("Failed to open file: " + path);
+            return false;
+        }
+        data.resize(length);
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(data.data(), static_cast<std::streamsize>(length));
+        if (static_cast<size_t>(file.gcount()) != length) {
+            set_error("Short read from " + path);
+            return false;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        set_error("Exception reading file range: " + std::string(e.what()));
         return false;
     }
 }
@@ -189,13 +265,13 @@ bool HadoopStorage::read_file(const std::string& path, std::vector<char>& data)
     try {
         std::filesystem::path local_path = "hdfs_stub/" + path;
         if (!std::filesystem::exists(local_path)) {
-            connection_->last_error = "File not found: " + path;
+            set_error("File not found: " + path);
             return false;
         }
         
         std::ifstream file(local_path, std::ios::binary);
         if (!file.is_open()) {
-            connection_->last_error = "Failed to open file: " + path;
+            set_error("Failed to open file: " + path);
             return false;
         }
         
@@ -210,7 +286,7 @@ bool HadoopStorage::read_file(const std::string& path, std::vector<char>& data)
         std::cout << "Read HDFS file: " << path << " (" << size << " bytes)" << std::endl;
         return true;
     } catch (const std::exception& e) {
-        connection_->last_error = "Exception reading file: " + std::string(e.what());
+        set_error("Exception reading file: " + std::string(e.what()));
         return false;
     }
 }
@@ -223,7 +299,7 @@ bool HadoopStorage::delete_file(const std::string& path) {
     try {
         std::filesystem::path local_path = "hdfs_stub/" + path;
         if (!std::filesystem::exists(local_path)) {
-            connection_->last_error = "File not found: " + path;
+            set_error("File not found: " + path);
             return false;
         }
         
@@ -231,7 +307,7 @@ bool HadoopStorage::delete_file(const std::string& path) {
         std::cout << "Deleted HDFS file: " << path << std::endl;
         return true;
     } catch (const std::exception& e) {
-        connection_->last_error = "Exception deleting file: " + std::string(e.what());
+        set_error("Exception deleting file: " + std::string(e.what()));
         return false;
     }
 }
@@ -247,7 +323,7 @@ bool HadoopStorage::create_directory(const std::string& path) {
         std::cout << "Created HDFS directory: " << path << std::endl;
         return true;
     } catch (const std::exception& e) {
-        connection_->last_error = "Exception creating directory: " + std::string(e.what());
+        set_error("Exception creating directory: " + std::string(e.what()));
         return false;
     }
 }
@@ -262,7 +338,7 @@ std::vector<HDFSFileInfo> HadoopStorage::list_directory(const std::string& path)
     try {
         std::filesystem::path local_path = "hdfs_stub/" + path;
         if (!std::filesystem::exists(local_path)) {
-            connection_->last_error = "Directory not found: " + path;
+            set_error("Directory not found: " + path);
             return files;
         }
         
@@ -282,18 +358,18 @@ std::vector<HDFSFileInfo> HadoopStorage::list_directory(const std::string& path)
         
         std::cout << "Listed HDFS directory: " << path << " (" << files.size() << " items)" << std::endl;
     } catch (const std::exception& e) {
-        connection_->last_error = "Exception listing directory: " + std::string(e.what());
+        set_error("Exception listing directory: " + std::string(e.what()));
     }
     
     return files;
 }
 
-bool HadoopStorage::save_matrix(const std::string& path, const Eigen::MatrixXd& matrix) {
+bool HadoopStorage::save_matrix(const std::string& path, const Matrix& matrix) {
     std::string serialized = serialize_matrix(matrix);
     return create_file(path, serialized);
 }
 
-bool HadoopStorage::load_matrix(const std::string& path, Eigen::MatrixXd& matrix) {
+bool HadoopStorage::load_matrix(const std::string& path, Matrix& matrix) {
     std::string content;
     if (!read_file(path, content)) {
         return false;
@@ -301,12 +377,12 @@ bool HadoopStorage::load_matrix(const std::string& path, Eigen::MatrixXd& matrix
     return deserialize_matrix(content, matrix);
 }
 
-bool HadoopStorage::save_vector(const std::string& path, const Eigen::VectorXd& vector) {
+bool HadoopStorage::save_vector(const std::string& path, const Vector& vector) {
     std::string serialized = serialize_vector(vector);
     return create_file(path, serialized);
 }
 
-bool HadoopStorage::load_vector(const std::string& path, Eigen::VectorXd& vector) {
+bool HadoopStorage::load_vector(const std::string& path, Vector& vector) {
     std::string content;
     if (!read_file(path, content)) {
         return false;
@@ -314,8 +390,8 @@ bool HadoopStorage::load_vector(const std::string& path, Eigen::VectorXd& vector
     return deserialize_vector(content, vector);
 }
 
-bool HadoopStorage::save_dataset(const std::string& path, const Eigen::MatrixXd& features, 
-                                const Eigen::VectorXd& labels) {
+bool HadoopStorage::save_dataset(const std::string& path, const Matrix& features, 
+                                const Vector& labels) {
     // Create a combined dataset format
     std::stringstream ss;
     ss << "DATASET\n";
@@ -340,19 +416,23 @@ bool HadoopStorage::save_dataset(const std::string& path, const Eigen::MatrixXd&
     return create_file(path, ss.str());
 }
 
-bool HadoopStorage::load_dataset(const std::string& path, Eigen::MatrixXd& features, 
-                                Eigen::VectorXd& labels) {
+bool HadoopStorage::load_dataset(const std::string& path, Matrix& features, 
+                                Vector& labels) {
     std::string content;
     if (!read_file(path, content)) {
         return false;
     }
     
+    if (content.size() >= 4 && content.compare(0, 4, "DDSB") == 0) {
+        return deserialize_dataset_binary(content, features, labels);
+    }
+    
     std::stringstream ss(content);
     std::string header;
     ss >> header;
     
     if (header != "DATASET") {
-        connection_->last_error = "Invalid dataset format";
+        set_error("Invalid dataset format");
         return false;
     }
     
@@ -377,6 +457,229 @@ bool HadoopStorage::load_dataset(const std::string& path, Eigen::MatrixXd& featu
     return true;
 }
 
+bool HadoopStorage::save_dataset_binary(const std::string& path, const Matrix& features,
+                                        const Vector& labels) {
+    if (labels.size() != features.rows()) {
+        set_error("Dataset labels do not match feature rows");
+        return false;
+    }
+    
+    BinaryDatasetHeader header;
+    std::memcpy(header.magic, "DDSB", 4);
+    header.version = kBinaryDatasetVersion;
+    header.rows = static_cast<uint64_t>(features.rows());
+    header.cols = static_cast<uint64_t>(features.cols());
+    header.scalar_bytes = sizeof(Scalar);
+    header.reserved = 0;
+    
+    size_t feature_bytes = static_cast<size_t>(features.size()) * sizeof(Scalar);
+    size_t label_bytes = static_cast<size_t>(labels.size()) * sizeof(Scalar);
+    std::vector<char> data(sizeof(header) + feature_bytes + label_bytes);
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), features.data(), feature_bytes);
+    std::memcpy(data.data() + sizeof(header) + feature_bytes, labels.data(), label_bytes);
+    
+    return create_file(path, data);
+}
+
+bool HadoopStorage::deserialize_dataset_binary(const std::string& data, Matrix& features,
+                                               Vector& labels) {
+    BinaryDatasetHeader header;
+    if (data.size() < sizeof(header)) {
+        set_error("Truncated binary dataset header");
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.version != kBinaryDatasetVersion || !supported_scalar_bytes(header.scalar_bytes)) {
+        set_error("Unsupported binary dataset version");
+        return false;
+    }
+    
+    size_t feature_bytes = 0;
+    size_t label_bytes = 0;
+    if (!dense_dataset_bytes(header, data.size() - sizeof(header), feature_bytes, label_bytes)) {
+        set_error("Truncated binary dataset");
+        return false;
+    }
+    
+    features.resize(static_cast<Eigen::Index>(header.rows), static_cast<Eigen::Index>(header.cols));
+    labels.resize(static_cast<Eigen::Index>(header.rows));
+    read_scalars(data.data() + sizeof(header), header.scalar_bytes, features.data(),
+                 static_cast<size_t>(header.rows * header.cols));
+    read_scalars(data.data() + sizeof(header) + feature_bytes, header.scalar_bytes, labels.data(),
+                 static_cast<size_t>(header.rows));
+    return true;
+}
+
+bool HadoopStorage::save_dataset_sparse(const std::string& path, const SparseMatrixCSR& features,
+                                        const Vector& labels) {
+    if (labels.size() != features.rows()) {
+        set_error("Dataset labels do not match feature rows");
+        return false;
+    }
+    
+    BinaryDatasetHeader header;
+    std::memcpy(header.magic, "DDSS", 4);
+    header.version = kBinaryDatasetVersion;
+    header.rows = static_cast<uint64_t>(features.rows());
+    header.cols = static_cast<uint64_t>(features.cols());
+    header.scalar_bytes = sizeof(Scalar);
+    header.reserved = 0;
+    uint64_t nnz = static_cast<uint64_t>(features.nonZeros());
+    
+    size_t outer_bytes = (header.rows + 1) * sizeof(int64_t);
+    size_t inner_bytes = nnz * sizeof(int32_t);
+    size_t value_bytes = nnz * sizeof(Scalar);
+    size_t label_bytes = header.rows * sizeof(Scalar);
+    std::vector<char> data(sizeof(header) + sizeof(nnz) + outer_bytes + inner_bytes + value_bytes + label_bytes);
+    char* out = data.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, &nnz, sizeof(nnz));
+    out += sizeof(nnz);
+    for (Index r = 0; r <= features.rows(); ++r) {
+        int64_t offset = static_cast<int64_t>(features.outerIndexPtr()[r]);
+        std::memcpy(out, &offset, sizeof(offset));
+        out += sizeof(offset);
+    }
+    std::memcpy(out, features.innerIndexPtr(), inner_bytes);
+    out += inner_bytes;
+    std::memcpy(out, features.valuePtr(), value_bytes);
+    out += value_bytes;
+    std::memcpy(out, labels.data(), label_bytes);
+    
+    return create_file(path, data);
+}
+
+bool HadoopStorage::load_dataset_sparse(const std::string& path, SparseMatrixCSR& features,
+                                        Vector& labels, double zero_tolerance) {
+    std::string content;
+    if (!read_file(path, content)) {
+        return false;
+    }
+    
+    if (content.size() >= 4 && content.compare(0, 4, "DDSS") == 0) {
+        return deserialize_dataset_sparse(content, features, labels);
+    }
+    
+    if (content.size() >= 4 && content.compare(0, 4, "DDSB") == 0) {
+        // Convert straight from the file image without a dense intermediate
+        BinaryDatasetHeader header;
+        if (content.size() < sizeof(header)) {
+            set_error("Truncated binary dataset header");
+            return false;
+        }
+        std::memcpy(&header, content.data(), sizeof(header));
+        if (header.version != kBinaryDatasetVersion || !supported_scalar_bytes(header.scalar_bytes)) {
+            set_error("Unsupported binary dataset version");
+            return false;
+        }
+        size_t feature_bytes = 0;
+        size_t label_bytes = 0;
+        if (!dense_dataset_bytes(header, content.size() - sizeof(header), feature_bytes, label_bytes)) {
+            set_error("Truncated binary dataset");
+            return false;
+        }
+        
+        const char* row_data = content.data() + sizeof(header);
+        features.resize(static_cast<Index>(header.rows), static_cast<Index>(header.cols));
+        for (uint64_t r = 0; r < header.rows; ++r) {
+            features.startVec(static_cast<Index>(r));
+            for (uint64_t c = 0; c < header.cols; ++c) {
+                Scalar v = read_scalar(row_data + (r * header.cols + c) * header.scalar_bytes,
+                                       header.scalar_bytes);
+                if (std::abs(v) > zero_tolerance) {
+                    features.insertBack(static_cast<Index>(r), static_cast<Index>(c)) = v;
+                }
+            }
+        }
+        features.finalize();
+        labels.resize(static_cast<Index>(header.rows));
+        read_scalars(row_data + feature_bytes, header.scalar_bytes, labels.data(),
+                     static_cast<size_t>(header.rows));
+        return true;
+    }
+    
+    Matrix dense;
+    if (!load_dataset(path, dense, labels)) {
+        return false;
+    }
+    features = SparseMatrixCSR::fromDense(dense, zero_tolerance);
+    return true;
+}
+
+bool HadoopStorage::deserialize_dataset_sparse(const std::string& data, SparseMatrixCSR& features,
+                                               Vector& labels) {
+    BinaryDatasetHeader header;
+    uint64_t nnz = 0;
+    if (data.size() < sizeof(header) + sizeof(nnz)) {
+        set_error("Truncated sparse dataset header");
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    std::memcpy(&nnz, data.data() + sizeof(header), sizeof(nnz));
+    if (header.version != kBinaryDatasetVersion || !supported_scalar_bytes(header.scalar_bytes)) {
+        set_error("Unsupported sparse dataset version");
+        return false;
+    }
+    
+    if (header.cols > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+        set_error("Sparse dataset has too many columns");
+        return false;
+    }
+    // Bound each count by the bytes present before any section size is multiplied out
+    const uint64_t body = data.size() - sizeof(header) - sizeof(nnz);
+    if (header.rows >= body / sizeof(int64_t) || nnz > body / (sizeof(int32_t) + header.scalar_bytes)) {
+        set_error("Truncated sparse dataset");
+        return false;
+    }
+    size_t outer_bytes = (header.rows + 1) * sizeof(int64_t);
+    size_t inner_bytes = nnz * sizeof(int32_t);
+    size_t value_bytes = nnz * header.scalar_bytes;
+    size_t label_bytes = header.rows * header.scalar_bytes;
+    if (body < outer_bytes + inner_bytes + value_bytes + label_bytes) {
+        set_error("Truncated sparse dataset");
+        return false;
+    }
+    
+    const char* in = data.data() + sizeof(header) + sizeof(nnz);
+    std::vector<Index> outer(header.rows + 1);
+    for (auto& offset : outer) {
+        int64_t value;
+        std::memcpy(&value, in, sizeof(value));
+        offset = static_cast<Index>(value);
+        in += sizeof(value);
+    }
+    if (outer.front() != 0 || static_cast<uint64_t>(outer.back()) != nnz ||
+        !std::is_sorted(outer.begin(), outer.end())) {
+        set_error("Corrupt sparse dataset offsets");
+        return false;
+    }
+    std::vector<int> inner(nnz);
+    std::memcpy(inner.data(), in, inner_bytes);
+    in += inner_bytes;
+    // Columns must lie in [0, cols) and strictly increase within each row
+    for (size_t r = 0; r + 1 < outer.size(); ++r) {
+        for (Index k = outer[r]; k < outer[r + 1]; ++k) {
+            const int col = inner[static_cast<size_t>(k)];
+            if (col < 0 || static_cast<uint64_t>(col) >= header.cols ||
+                (k > outer[r] && col <= inner[static_cast<size_t>(k - 1)])) {
+                set_error("Corrupt sparse dataset column indices");
+                return false;
+            }
+        }
+    }
+    std::vector<Scalar> values(nnz);
+    read_scalars(in, header.scalar_bytes, values.data(), nnz);
+    in += value_bytes;
+    
+    features.resize(static_cast<Index>(header.rows), static_cast<Index>(header.cols));
+    features.assignCompressed(std::move(outer), std::move(inner), std::move(values));
+    labels.resize(static_cast<Index>(header.rows));
+    read_scalars(in, header.scalar_bytes, labels.data(), static_cast<size_t>(header.rows));
+    return true;
+}
+
 void HadoopStorage::set_config(const HadoopConfig& config) {
     *config_ = config;
 }
@@ -400,29 +703,36 @@ size_t HadoopStorage::get_file_size(const std::string& path) {
             return std::filesystem::file_size(local_path);
         }
     } catch (const std::exception& e) {
-        connection_->last_error = "Exception getting file size: " + std::string(e.what());
+        set_error("Exception getting file size: " + std::string(e.what()));
     }
     
     return 0;
 }
 
 std::string HadoopStorage::get_last_error() const {
+    std::lock_guard<std::mutex> lock(connection_->error_mutex);
     return connection_->last_error;
 }
 
 void HadoopStorage::clear_error() {
+    std::lock_guard<std::mutex> lock(connection_->error_mutex);
     connection_->last_error.clear();
 }
 
+void HadoopStorage::set_error(const std::string& message) {
+    std::lock_guard<std::mutex> lock(connection_->error_mutex);
+    connection_->last_error = message;
+}
+
 bool HadoopStorage::ensure_connected() {
     if (!connection_->connected) {
-        connection_->last_error = "Not connected to HDFS";
+        set_error("Not connected to HDFS");
         return false;
     }
     return true;
 }
 
-std::string HadoopStorage::serialize_matrix(const Eigen::MatrixXd& matrix) {
+std::string HadoopStorage::serialize_matrix(const Matrix& matrix) {
     std::stringstream ss;
     ss << "MATRIX\n";
     ss << matrix.rows() << " " << matrix.cols() << "\n";
@@ -438,7 +748,7 @@ std::string HadoopStorage::serialize_matrix(const Eigen::MatrixXd& matrix) {
     return ss.str();
 }
 
-bool HadoopStorage::deserialize_matrix(const std::string& data, Eigen::MatrixXd& matrix) {
+bool HadoopStorage::deserialize_matrix(const std::string& data, Matrix& matrix) {
     std::stringstream ss(data);
     std::string header;
     ss >> header;
@@ -461,7 +771,7 @@ bool HadoopStorage::deserialize_matrix(const std::string& data, Eigen::MatrixXd&
     return true;
 }
 
-std::string HadoopStorage::serialize_vector(const Eigen::VectorXd& vector) {
+std::string HadoopStorage::serialize_vector(const Vector& vector) {
     std::stringstream ss;
     ss << "VECTOR\n";
     ss << vector.size() << "\n";
@@ -475,7 +785,7 @@ std::string HadoopStorage::serialize_vector(const Eigen::VectorXd& vector) {
     return ss.str();
 }
 
-bool HadoopStorage::deserialize_vector(const std::string& data, Eigen::VectorXd& vector) {
+bool HadoopStorage::deserialize_vector(const std::string& data, Vector& vector) {
     std::stringstream ss(data);
     std::string header;
     ss >> header;
@@ -496,6 +806,93 @@ bool HadoopStorage::deserialize_vector(const std::string& data, Eigen::VectorXd&
     return true;
 }
 
+// DatasetStream implementation
+DatasetStream::DatasetStream(std::shared_ptr<HadoopStorage> storage, std::vector<std::string> paths)
+    : storage_(std::move(storage)), paths_(std::move(paths)) {
+}
+
+void DatasetStream::rewind() {
+    file_ = 0;
+    header_loaded_ = false;
+    row_ = 0;
+    rows_read_ = 0;
+    failed_ = false;
+}
+
+bool DatasetStream::open_next_file() {
+    while (file_ < paths_.size()) {
+        const std::string& path = paths_[file_];
+        if (!storage_->read_file_range(path, 0, sizeof(header_), buffer_)) {
+            std::cout << "❌ Cannot read dataset " << path << ": " << storage_->get_last_error() << std::endl;
+            failed_ = true;
+            return false;
+        }
+        std::memcpy(&header_, buffer_.data(), sizeof(header_));
+        if (std::memcmp(header_.magic, "DDSB", 4) != 0 || header_.version != kBinaryDatasetVersion ||
+            !supported_scalar_bytes(header_.scalar_bytes)) {
+            std::cout << "❌ " << path << " is not a dense binary dataset" << std::endl;
+            failed_ = true;
+            return false;
+        }
+        if (cols_ >= 0 && static_cast<Index>(header_.cols) != cols_) {
+            std::cout << "❌ " << path << " has " << header_.cols << " columns, expected " << cols_ << std::endl;
+            failed_ = true;
+            return false;
+        }
+        size_t feature_bytes = 0;
+        size_t label_bytes = 0;
+        const size_t file_bytes = storage_->get_file_size(path);
+        if (file_bytes < sizeof(header_) ||
+            !dense_dataset_bytes(header_, file_bytes - sizeof(header_), feature_bytes, label_bytes)) {
+            std::cout << "❌ " << path << " is truncated" << std::endl;
+            failed_ = true;
+            return false;
+        }
+        cols_ = static_cast<Index>(header_.cols);
+        row_ = 0;
+        if (header_.rows > 0) {
+            header_loaded_ = true;
+            return true;
+        }
+        ++file_;
+    }
+    return false;
+}
+
+bool DatasetStream::next_batch(Index max_rows, Matrix& features, Vector& labels) {
+    if (failed_ || max_rows <= 0) return false;
+    if (!header_loaded_ && !open_next_file()) return false;
+
+    const std::string& path = paths_[file_];
+    const uint64_t count = std::min<uint64_t>(static_cast<uint64_t>(max_rows), header_.rows - row_);
+    const uint64_t row_bytes = header_.cols * header_.scalar_bytes;
+    const uint64_t feature_offset = sizeof(header_) + row_ * row_bytes;
+    const uint64_t label_offset = sizeof(header_) + header_.rows * row_bytes + row_ * header_.scalar_bytes;
+
+    features.resize(static_cast<Index>(count), cols_);
+    labels.resize(static_cast<Index>(count));
+    if (!storage_->read_file_range(path, feature_offset, static_cast<size_t>(count * row_bytes), buffer_)) {
+        std::cout << "❌ Cannot read dataset " << path << ": " << storage_->get_last_error() << std::endl;
+        failed_ = true;
+        return false;
+    }
+    read_scalars(buffer_.data(), header_.scalar_bytes, features.data(), static_cast<size_t>(count * header_.cols));
+    if (!storage_->read_file_range(path, label_offset, static_cast<size_t>(count * header_.scalar_bytes), buffer_)) {
+        std::cout << "❌ Cannot read dataset " << path << ": " << storage_->get_last_error() << std::endl;
+        failed_ = true;
+        return false;
+    }
+    read_scalars(buffer_.data(), header_.scalar_bytes, labels.data(), static_cast<size_t>(count));
+
+    row_ += count;
+    rows_read_ += count;
+    if (row_ == header_.rows) {
+        ++file_;
+        header_loaded_ = false;
+    }
+    return true;
+}
+
 // HadoopJobManager implementation
 HadoopJobManager::HadoopJobManager() 
     : config_(std::make_unique<HadoopConfig>()), initialized_(false) {
@@ -0,0 +1,379 @@
+#include "../../include/testing/benchmark.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dds {
+namespace testing {
+
+namespace {
+
+// Hardware counter group (cycles leads; instructions, cache and branch misses follow)
+class PerfCounterGroup {
+private:
+#ifdef __linux__
+    int fds_[4] = {-1, -1, -1, -1};
+
+    static int open_counter(uint64_t config, int group_fd) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = group_fd == -1 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+#endif
+
+public:
+    PerfCounterGroup() {
+#ifdef __linux__
+        const uint64_t configs[4] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        fds_[0] = open_counter(configs[0], -1);
+        if (fds_[0] < 0) return;
+        for (int i = 1; i < 4; ++i) {
+            fds_[i] = open_counter(configs[i], fds_[0]);
+            if (fds_[i] < 0) {
+                close_all();
+                return;
+            }
+        }
+#endif
+    }
+
+    ~PerfCounterGroup() { close_all(); }
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    bool valid() const {
+#ifdef __linux__
+        return fds_[0] >= 0;
+#else
+        return false;
+#endif
+    }
+
+    void start() {
+#ifdef __linux__
+        if (!valid()) return;
+        ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // Stops counting and stores totals divided by iterations
+    bool stop(size_t iterations, BenchmarkCounters& counters) {
+#ifdef __linux__
+        if (!valid()) return false;
+        ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t values[1 + 4] = {0};
+        if (read(fds_[0], values, sizeof(values)) < static_cast<ssize_t>(sizeof(uint64_t) * 5)) return false;
+        double n = static_cast<double>(std::max<size_t>(iterations, 1));
+        counters.valid = true;
+        counters.cycles = values[1] / n;
+        counters.instructions = values[2] / n;
+        counters.cache_misses = values[3] / n;
+        counters.branch_misses = values[4] / n;
+        return true;
+#else
+        (void)iterations;
+        (void)counters;
+        return false;
+#endif
+    }
+
+private:
+    void close_all() {
+#ifdef __linux__
+        for (int& fd : fds_) {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+#endif
+    }
+};
+
+double median_of(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    double upper = values[mid];
+    if (values.size() % 2 == 1) return upper;
+    double lower = *std::max_element(values.begin(), values.begin() + mid);
+    return (lower + upper) / 2.0;
+}
+
+double z_for_confidence(double confidence) {
+    if (confidence >= 0.99) return 2.576;
+    if (confidence >= 0.95) return 1.960;
+    if (confidence >= 0.90) return 1.645;
+    return 1.282;
+}
+
+std::string json_escape(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+// JSON has no NaN or infinity; such values are written as null
+struct JsonNumber {
+    double value;
+};
+
+std::ostream& operator<<(std::ostream& out, JsonNumber number) {
+    if (std::isfinite(number.value)) return out << number.value;
+    return out << "null";
+}
+
+} // namespace
+
+void BenchmarkState::set_counter(const std::string& name, double value) {
+    for (auto& counter : user_counters_) {
+        if (counter.first == name) {
+            counter.second = value;
+            return;
+        }
+    }
+    user_counters_.emplace_back(name, value);
+}
+
+void BenchmarkSuite::add_benchmark(const std::string& name, std::function<void(BenchmarkState&)> func) {
+    benchmarks_.push_back(BenchmarkCase{name, std::move(func)});
+}
+
+bool BenchmarkSuite::parse_args(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value_of = [&arg](const std::string& prefix) { return arg.substr(prefix.size()); };
+        if (arg.rfind("--filter=", 0) == 0) {
+            config_.filter = value_of("--filter=");
+        } else if (arg.rfind("--json=", 0) == 0) {
+            config_.json_path = value_of("--json=");
+        } else if (arg.rfind("--min-time-ms=", 0) == 0) {
+            config_.min_time = std::chrono::milliseconds(std::stoll(value_of("--min-time-ms=")));
+        } else if (arg.rfind("--warmup-ms=", 0) == 0) {
+            config_.warmup_time = std::chrono::milliseconds(std::stoll(value_of("--warmup-ms=")));
+        } else if (arg.rfind("--samples=", 0) == 0) {
+            config_.samples = std::max<size_t>(3, std::stoul(value_of("--samples=")));
+        } else if (arg == "--no-counters") {
+            config_.capture_counters = false;
+        } else {
+            std::cout << "❌ Unknown benchmark option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t BenchmarkSuite::calibrate(const BenchmarkCase& benchmark, std::chrono::nanoseconds target) {
+    // Prime with zero iterations so fixtures built lazily on first use are not timed
+    BenchmarkState prime(0);
+    benchmark.func(prime);
+
+    size_t iterations = 1;
+    for (;;) {
+        BenchmarkState state(iterations);
+        auto start = std::chrono::steady_clock::now();
+        benchmark.func(state);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        if (elapsed >= target || iterations >= config_.max_iterations) return iterations;
+
+        // Grow geometrically, aiming slightly past the target to converge quickly
+        double ratio = elapsed.count() > 0
+            ? static_cast<double>(target.count()) / static_cast<double>(elapsed.count())
+            : 100.0;
+        double growth = std::clamp(ratio * 1.2, 2.0, 100.0);
+        iterations = std::min(config_.max_iterations,
+                              static_cast<size_t>(std::ceil(iterations * growth)));
+    }
+}
+
+BenchmarkResult BenchmarkSuite::run_benchmark(const BenchmarkCase& benchmark) {
+    BenchmarkResult result;
+    result.name = benchmark.name;
+
+    size_t samples = std::max<size_t>(config_.samples, 3);
+    auto target = std::chrono::duration_cast<std::chrono::nanoseconds>(config_.min_time) / samples;
+    if (target.count() <= 0) target = std::chrono::nanoseconds(1);
+
+    size_t iterations = calibrate(benchmark, target);
+    result.iterations_per_sample = iterations;
+
+    // Warmup at the calibrated size so caches, branch predictors and clocks settle
+    auto warmup_end = std::chrono::steady_clock::now() + config_.warmup_time;
+    while (std::chrono::steady_clock::now() < warmup_end) {
+        BenchmarkState state(iterations);
+        benchmark.func(state);
+    }
+
+    PerfCounterGroup perf;
+    bool counting = config_.capture_counters && perf.valid();
+    BenchmarkState last_state(iterations);
+
+    if (counting) perf.start();
+    for (size_t s = 0; s < samples; ++s) {
+        BenchmarkState state(iterations);
+        auto start = std::chrono::steady_clock::now();
+        benchmark.func(state);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        result.sample_ns.push_back(
+            std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations));
+        if (s + 1 == samples) last_state = std::move(state);
+    }
+    if (counting) perf.stop(iterations * samples, result.counters);
+
+    std::vector<double> sorted = result.sample_ns;
+    std::sort(sorted.begin(), sorted.end());
+    result.median_ns = median_of(sorted);
+    result.mean_ns = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+    result.min_ns = sorted.front();
+
+    std::vector<double> deviations;
+    deviations.reserve(sorted.size());
+    for (double v : sorted) deviations.push_back(std::abs(v - result.median_ns));
+    result.mad_ns = median_of(deviations);
+
+    // Order-statistic interval: ranks n/2 -+ z*sqrt(n)/2
+    double n = static_cast<double>(sorted.size());
+    double half_width = z_for_confidence(config_.confidence) * std::sqrt(n) / 2.0;
+    long lo = static_cast<long>(std::floor(n / 2.0 - half_width));
+    long hi = static_cast<long>(std::ceil(n / 2.0 + half_width));
+    result.ci_low_ns = sorted[static_cast<size_t>(std::clamp<long>(lo, 0, sorted.size() - 1))];
+    result.ci_high_ns = sorted[static_cast<size_t>(std::clamp<long>(hi, 0, sorted.size() - 1))];
+
+    double seconds_per_iteration = result.median_ns * 1e-9;
+    result.items_per_second = seconds_per_iteration > 0.0
+        ? last_state.items_per_iteration_ / seconds_per_iteration : 0.0;
+    result.bytes_per_second = seconds_per_iteration > 0.0
+        ? last_state.bytes_per_iteration_ / seconds_per_iteration : 0.0;
+    result.user_counters = last_state.user_counters_;
+
+    return result;
+}
+
+bool BenchmarkSuite::run_all_benchmarks() {
+    std::cout << "⏱️ Running benchmark suite: " << suite_name_ << std::endl;
+    std::cout << "===========================================" << std::endl;
+
+    results_.clear();
+    for (const auto& benchmark : benchmarks_) {
+        if (!config_.filter.empty() && benchmark.name.find(config_.filter) == std::string::npos) continue;
+        results_.push_back(run_benchmark(benchmark));
+        const auto& r = results_.back();
+        std::cout << std::left << std::setw(40) << r.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << r.median_ns << " ns  ±" << std::setprecision(1) << r.mad_ns
+                  << "  (" << r.iterations_per_sample << " iters x " << r.sample_ns.size() << ")" << std::endl;
+    }
+
+    print_summary();
+
+    if (!config_.json_path.empty()) {
+        return write_json(config_.json_path);
+    }
+    return true;
+}
+
+void BenchmarkSuite::print_summary() const {
+    std::cout << "===========================================" << std::endl;
+    std::cout << "📊 Benchmark Summary for " << suite_name_ << std::endl;
+    for (const auto& r : results_) {
+        std::cout << "• " << r.name << ": median " << std::fixed << std::setprecision(1) << r.median_ns
+                  << " ns [" << r.ci_low_ns << ", " << r.ci_high_ns << "]";
+        if (r.items_per_second > 0.0) {
+            std::cout << ", " << std::setprecision(2) << r.items_per_second / 1e6 << " M items/s";
+        }
+        if (r.bytes_per_second > 0.0) {
+            std::cout << ", " << std::setprecision(2) << r.bytes_per_second / 1e9 << " GB/s";
+        }
+        if (r.counters.valid) {
+            std::cout << ", IPC " << std::setprecision(2) << r.counters.ipc();
+        }
+        for (const auto& counter : r.user_counters) {
+            std::cout << ", " << counter.first << " " << std::setprecision(3) << counter.second;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "===========================================" << std::endl;
+}
+
+std::string BenchmarkSuite::to_json() const {
+    std::ostringstream json;
+    json << std::setprecision(10);
+
+    auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    json << "{\n  \"suite\": \"" << json_escape(suite_name_) << "\",\n";
+    json << "  \"context\": {\"date\": \"" << std::put_time(std::gmtime(&now), "%Y-%m-%dT%H:%M:%SZ")
+         << "\", \"hardware_threads\": " << std::thread::hardware_concurrency()
+         << ", \"samples\": " << config_.samples
+         << ", \"min_time_ms\": " << config_.min_time.count() << "},\n";
+    json << "  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results_.size(); ++i) {
+        const auto& r = results_[i];
+        json << (i == 0 ? "\n" : ",\n");
+        json << "    {\"name\": \"" << json_escape(r.name) << "\""
+             << ", \"iterations\": " << r.iterations_per_sample
+             << ", \"samples\": " << r.sample_ns.size()
+             << ", \"median_ns\": " << JsonNumber{r.median_ns}
+             << ", \"mad_ns\": " << JsonNumber{r.mad_ns}
+             << ", \"mean_ns\": " << JsonNumber{r.mean_ns}
+             << ", \"min_ns\": " << JsonNumber{r.min_ns}
+             << ", \"ci_low_ns\": " << JsonNumber{r.ci_low_ns}
+             << ", \"ci_high_ns\": " << JsonNumber{r.ci_high_ns}
+             << ", \"items_per_second\": " << JsonNumber{r.items_per_second}
+             << ", \"bytes_per_second\": " << JsonNumber{r.bytes_per_second};
+        if (r.counters.valid) {
+            json << ", \"cycles\": " << JsonNumber{r.counters.cycles}
+                 << ", \"instructions\": " << JsonNumber{r.counters.instructions}
+                 << ", \"cache_misses\": " << JsonNumber{r.counters.cache_misses}
+                 << ", \"branch_misses\": " << JsonNumber{r.counters.branch_misses};
+        }
+        for (const auto& counter : r.user_counters) {
+            json << ", \"" << json_escape(counter.first) << "\": " << JsonNumber{counter.second};
+        }
+        json << "}";
+    }
+    json << (results_.empty() ? "]\n}\n" : "\n  ]\n}\n");
+    return json.str();
+}
+
+bool BenchmarkSuite::write_json(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cout << "❌ Failed to open benchmark output: " << path << std::endl;
+        return false;
+    }
+    file << to_json();
+    std::cout << "📝 Benchmark results written to: " << path << std::endl;
+    return true;
+}
+
+} // namespace testing
+} // namespace dds
@@ -1,39 +1,72 @@
 #include "../../include/testing/test_framework.h"
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
 
 namespace dds {
 namespace testing {
 
-void TestSuite::add_test(const std::string& name, std::function<void()> test_func) {
-    tests_.push_back([this, name, test_func]() {
-        TestResult result;
-        result.test_name = name;
-        result.passed = true;
-        result.error_message = "";
-        
-        auto start = std::chrono::high_resolution_clock::now();
-        
+void TestSuite::add_test(const std::string& name, std::function<void()> test_func,
+                         std::chrono::milliseconds timeout) {
+    tests_.push_back(TestCase{name, std::move(test_func), timeout});
+}
+
+TestResult TestSuite::run_test(const TestCase& test) {
+    TestResult result;
+    result.test_name = test.name;
+    result.passed = true;
+    result.timed_out = false;
+    result.error_message = "";
+    
+    auto timeout = test.timeout.count() > 0 ? test.timeout : default_timeout_;
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    if (timeout.count() <= 0) {
         try {
-            test_func();
-            std::cout << "✅ PASS: " << name << std::endl;
+            test.func();
         } catch (const std::exception& e) {
             result.passed = false;
             result.error_message = e.what();
-            std::cout << "❌ FAIL: " << name << " - " << e.what() << std::endl;
         }
+    } else {
+        // The body runs on its own thread so a hung test cannot stall the suite;
+        // everything it touches is owned by the shared task in case it is abandoned
+        auto task = std::make_shared<std::packaged_task<void()>>(test.func);
+        auto outcome = task->get_future();
+        std::thread([task]() { (*task)(); }).detach();
         
-        auto end = std::chrono::high_resolution_clock::now();
-        result.execution_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        
-        results_.push_back(result);
-        
+        if (outcome.wait_for(timeout) == std::future_status::timeout) {
+            result.passed = false;
+            result.timed_out = true;
+            result.error_message = "Timed out after " + std::to_string(timeout.count()) + " ms";
+        } else {
+            try {
+                outcome.get();
+            } catch (const std::exception& e) {
+                result.passed = false;
+                result.error_message = e.what();
+            }
+        }
+    }
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    result.execution_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    
+    {
+        std::lock_guard<std::mutex> lock(output_mutex_);
         if (result.passed) {
-            passed_count_++;
+            std::cout << "✅ PASS: " << test.name << std::endl;
         } else {
-            failed_count_++;
+            std::cout << (result.timed_out ? "⏱️ TIMEOUT: " : "❌ FAIL: ") << test.name
+                      << " - " << result.error_message << std::endl;
         }
-    });
+    }
+    
+    return result;
 }
 
 void TestSuite::run_all_tests() {
@@ -42,10 +75,37 @@ void TestSuite::run_all_tests() {
     
     passed_count_ = 0;
     failed_count_ = 0;
-    results_.clear();
+    results_.assign(tests_.size(), TestResult());
+    
+    size_t workers = parallelism_ == 0 ? std::thread::hardware_concurrency() : parallelism_;
+    workers = std::max<size_t>(1, std::min(workers, tests_.size()));
+    
+    std::atomic<size_t> next_test(0);
+    auto worker = [this, &next_test]() {
+        for (size_t i = next_test++; i < tests_.size(); i = next_test++) {
+            results_[i] = run_test(tests_[i]);
+        }
+    };
+    
+    if (workers <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(workers);
+        for (size_t w = 0; w < workers; ++w) {
+            pool.emplace_back(worker);
+        }
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    }
     
-    for (auto& test : tests_) {
-        test();
+    for (const auto& result : results_) {
+        if (result.passed) {
+            passed_count_++;
+        } else {
+            failed_count_++;
+        }
     }
     
     print_summary();
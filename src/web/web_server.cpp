@@ -2526,11 +2526,11 @@ void WebServer::record_status_code(int status_code) {
 }
 
 void WebServer::record_user_agent(const std::string& user_agent) {
-    user_agent_counts_[user_agent]++;
+    top_user_agents_.offer(user_agent);
 }
 
 void WebServer::record_ip_address(const std::string& ip_address) {
-    ip_address_counts_[ip_address]++;
+    top_ip_addresses_.offer(ip_address);
 }
 
 double WebServer::calculate_endpoint_average_response_time(const std::string& endpoint) {
@@ -2624,13 +2624,9 @@ std::map<int, size_t> WebServer::get_status_code_distribution() {
 std::map<std::string, size_t> WebServer::get_user_agent_distribution(size_t limit) {
     std::lock_guard<std::mutex> lock(analytics_mutex_);
     
-    std::vector<std::pair<std::string, size_t>> agents(user_agent_counts_.begin(), user_agent_counts_.end());
-    std::sort(agents.begin(), agents.end(),
-              [](const auto& a, const auto& b) { return a.second > b.second; });
-    
     std::map<std::string, size_t> result;
-    for (size_t i = 0; i < std::min(limit, agents.size()); ++i) {
-        result[agents[i].first] = agents[i].second;
+    for (const auto& agent : top_user_agents_.top(limit)) {
+        result[agent.key] = agent.count;
     }
     
     return result;
@@ -2639,13 +2635,9 @@ std::map<std::string, size_t> WebServer::get_user_agent_distribution(size_t limi
 std::map<std::string, size_t> WebServer::get_ip_address_distribution(size_t limit) {
     std::lock_guard<std::mutex> lock(analytics_mutex_);
     
-    std::vector<std::pair<std::string, size_t>> ips(ip_address_counts_.begin(), ip_address_counts_.end());
-    std::sort(ips.begin(), ips.end(),
-              [](const auto& a, const auto& b) { return a.second > b.second; });
-    
     std::map<std::string, size_t> result;
-    for (size_t i = 0; i < std::min(limit, ips.size()); ++i) {
-        result[ips[i].first] = ips[i].second;
+    for (const auto& ip : top_ip_addresses_.top(limit)) {
+        result[ip.key] = ip.count;
     }
     
     return result;
@@ -2702,8 +2694,8 @@ void WebServer::reset_analytics() {
     endpoint_request_counts_.clear();
     endpoint_error_counts_.clear();
     status_code_counts_.clear();
-    user_agent_counts_.clear();
-    ip_address_counts_.clear();
+    top_user_agents_.clear();
+    top_ip_addresses_.clear();
     request_timestamps_.clear();
     
     total_requests_ = 0;
@@ -3014,20 +3006,41 @@ bool WebServer::is_rate_limited_by_ip(const std::string& ip) {
     
     std::lock_guard<std::mutex> lock(security_mutex_);
     
-    auto now = std::chrono::steady_clock::now();
-    auto it = ip_rate_limits_.find(ip);
+    if (blocked_ips_.is_blocked(ip)) {
+        return true;
+    }
     
-    if (it != ip_rate_limits_.end()) {
-        auto time_diff = std::chrono::duration_cast<std::chrono::seconds>(now - it->second);
-        if (time_diff.count() < 60) { // 1 minute rate limit
-            return true;
-        }
+    // One request per IP per minute. The windowed sketch stays the same size however
+    // many addresses show up; a hash collision can rarely limit an address early.
+    auto now = std::chrono::steady_clock::now();
+    const uint64_t hash = utils::sketch_hash(ip);
+    if (ip_request_window_.estimate_hash(hash, now) > 0) {
+        return true;
     }
     
-    ip_rate_limits_[ip] = now;
+    ip_request_window_.add_hash(hash, now);
     return false;
 }
 
+bool WebServer::block_ip(const std::string& ip_or_cidr) {
+    std::lock_guard<std::mutex> lock(security_mutex_);
+    if (!blocked_ips_.block(ip_or_cidr)) {
+        std::cout << "❌ IP blocklist is full, could not block: " << ip_or_cidr << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool WebServer::unblock_ip(const std::string& ip_or_cidr) {
+    std::lock_guard<std::mutex> lock(security_mutex_);
+    return blocked_ips_.unblock(ip_or_cidr);
+}
+
+bool WebServer::is_ip_blocked(const std::string& ip) {
+    std::lock_guard<std::mutex> lock(security_mutex_);
+    return blocked_ips_.is_blocked(ip);
+}
+
 void WebServer::log_security_event(const std::string& event, const std::string& ip, const std::string& details) {
     if (!security_enabled_) {
         return;
@@ -0,0 +1,47 @@
+#include "test_common.h"
+#include "testing/benchmark.h"
+#include <limits>
+
+using namespace dds;
+using namespace dds::test;
+using testing::BenchmarkConfig;
+using testing::BenchmarkState;
+using testing::BenchmarkSuite;
+using testing::TestSuite;
+
+namespace {
+
+bool contains(const std::string& text, const std::string& part) { return text.find(part) != std::string::npos; }
+
+} // namespace
+
+int main() {
+    TestSuite suite("benchmark");
+
+    suite.add_test("json_writes_non_finite_as_null", []() {
+        BenchmarkConfig config;
+        config.warmup_time = std::chrono::milliseconds(1);
+        config.min_time = std::chrono::milliseconds(5);
+        config.samples = 3;
+        config.capture_counters = false;
+        BenchmarkSuite benchmarks("json", config);
+        benchmarks.add_benchmark("counters", [](BenchmarkState& state) {
+            volatile double sink = 0.0;
+            for (size_t i = 0; i < state.iterations(); ++i) sink = sink + 1.0;
+            state.set_counter("finite", 1.5);
+            state.set_counter("nan", std::numeric_limits<double>::quiet_NaN());
+            state.set_counter("inf", std::numeric_limits<double>::infinity());
+            state.set_counter("neg_inf", -std::numeric_limits<double>::infinity());
+        });
+        TestSuite::assert_true(benchmarks.run_all_benchmarks(), "run failed");
+        const std::string json = benchmarks.to_json();
+        TestSuite::assert_true(contains(json, "\"finite\": 1.5"), "finite counter missing: " + json);
+        TestSuite::assert_true(contains(json, "\"nan\": null") && contains(json, "\"inf\": null") &&
+                                   contains(json, "\"neg_inf\": null"),
+                               "non-finite counters not written as null: " + json);
+        TestSuite::assert_true(!contains(json, ": nan") && !contains(json, ": inf") && !contains(json, ": -inf"),
+                               "raw non-finite token in JSON: " + json);
+    });
+
+    return run_tests(suite);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+// Shared helpers for the dds_test_* targets: seeded data, reference kernels and a
+// standard main() wrapper around testing::TestSuite.
+
+#include "testing/test_framework.h"
+#include "utils/types.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace dds {
+namespace test {
+
+constexpr uint64_t kTestSeed = 20240611;
+
+// Tolerances for the storage precision: float32 builds store matrices in float
+constexpr bool kFloatStorage = std::is_same<Scalar, float>::value;
+inline double tolerance(double for_double, double for_float) { return kFloatStorage ? for_float : for_double; }
+
+inline Matrix random_matrix(Index rows, Index cols, uint64_t seed = kTestSeed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix m(rows, cols);
+    for (Index i = 0; i < m.size(); ++i) m.data()[i] = static_cast<Scalar>(dist(rng));
+    return m;
+}
+
+// Plain triple loop in double, the reference for every product kernel
+inline Matrix naive_product(const Matrix& a, const Matrix& b) {
+    Matrix c(a.rows(), b.cols());
+    for (Index i = 0; i < a.rows(); ++i) {
+        for (Index j = 0; j < b.cols(); ++j) {
+            double sum = 0.0;
+            for (Index k = 0; k < a.cols(); ++k) sum += static_cast<double>(a(i, k)) * b(k, j);
+            c(i, j) = static_cast<Scalar>(sum);
+        }
+    }
+    return c;
+}
+
+inline Matrix transposed(const Matrix& a) {
+    Matrix t(a.cols(), a.rows());
+    for (Index i = 0; i < a.rows(); ++i) {
+        for (Index j = 0; j < a.cols(); ++j) t(j, i) = a(i, j);
+    }
+    return t;
+}
+
+// Largest absolute elementwise difference; infinite when the shapes differ
+inline double max_abs_diff(const Matrix& a, const Matrix& b) {
+    if (a.rows() != b.rows() || a.cols() != b.cols()) return INFINITY;
+    double worst = 0.0;
+    for (Index i = 0; i < a.size(); ++i) {
+        worst = std::max(worst, std::abs(static_cast<double>(a.data()[i]) - b.data()[i]));
+    }
+    return worst;
+}
+
+// Default stream formatting, so residuals of 1e-13 do not print as 0.000000
+inline std::string format(double value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+inline void expect_near(double expected, double actual, double tolerance, const std::string& what) {
+    testing::TestSuite::assert_true(std::abs(expected - actual) <= tolerance,
+                                    what + ": expected " + format(expected) + " but got " + format(actual) +
+                                        " (tolerance " + format(tolerance) + ")");
+}
+
+// Also fails on NaN
+inline void expect_below(double value, double bound, const std::string& what) {
+    testing::TestSuite::assert_true(value <= bound, what + ": " + format(value) + " exceeds " + format(bound));
+}
+
+// Runs the suite; the exit code is what ctest checks
+inline int run_tests(testing::TestSuite& suite) {
+    suite.run_all_tests();
+    return suite.get_failed_count() == 0 ? 0 : 1;
+}
+
+} // namespace test
+} // namespace dds
@@ -0,0 +1,153 @@
+#include "test_common.h"
+#include "algorithms/cross_validation.h"
+#include <map>
+#include <vector>
+
+using namespace dds;
+using namespace dds::algorithms;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+// Every row validated by exactly one fold and trained on by all the others; each
+// fold's lists sorted, disjoint and together every row. Returns the fold of each row.
+std::vector<int> check_partition(const std::vector<Fold>& folds, int rows, int expected_folds,
+                                 const std::string& what) {
+    TestSuite::assert_true(static_cast<int>(folds.size()) == expected_folds,
+                           what + ": " + std::to_string(folds.size()) + " folds");
+    std::vector<int> fold_of(static_cast<size_t>(rows), -1);
+    for (size_t f = 0; f < folds.size(); ++f) {
+        const Fold& fold = folds[f];
+        const std::string name = what + " fold " + std::to_string(f);
+        TestSuite::assert_true(!fold.validation.empty(), name + " validates nothing");
+        TestSuite::assert_true(std::is_sorted(fold.train.begin(), fold.train.end()) &&
+                                   std::is_sorted(fold.validation.begin(), fold.validation.end()),
+                               name + " lists not sorted");
+        TestSuite::assert_true(fold.train.size() + fold.validation.size() == static_cast<size_t>(rows),
+                               name + " does not cover every row");
+        std::vector<int> in_fold(static_cast<size_t>(rows), 0);
+        for (int r : fold.train) {
+            TestSuite::assert_true(r >= 0 && r < rows, name + " train row out of range");
+            ++in_fold[static_cast<size_t>(r)];
+        }
+        for (int r : fold.validation) {
+            TestSuite::assert_true(r >= 0 && r < rows, name + " validation row out of range");
+            ++in_fold[static_cast<size_t>(r)];
+            TestSuite::assert_true(fold_of[static_cast<size_t>(r)] == -1,
+                                   what + " row " + std::to_string(r) + " validated twice");
+            fold_of[static_cast<size_t>(r)] = static_cast<int>(f);
+        }
+        TestSuite::assert_true(std::all_of(in_fold.begin(), in_fold.end(), [](int n) { return n == 1; }),
+                               name + " repeats or misses a row");
+    }
+    TestSuite::assert_true(std::find(fold_of.begin(), fold_of.end(), -1) == fold_of.end(),
+                           what + " leaves a row unvalidated");
+    return fold_of;
+}
+
+size_t largest_fold(const std::vector<Fold>& folds) {
+    size_t largest = 0;
+    for (const Fold& fold : folds) largest = std::max(largest, fold.validation.size());
+    return largest;
+}
+
+size_t smallest_fold(const std::vector<Fold>& folds) {
+    size_t smallest = SIZE_MAX;
+    for (const Fold& fold : folds) smallest = std::min(smallest, fold.validation.size());
+    return smallest;
+}
+
+} // namespace
+
+int main() {
+    TestSuite suite("cross_validation");
+
+    suite.add_test("kfold_partitions_rows", []() {
+        for (int rows : {10, 97, 1000}) {
+            for (int folds : {2, 3, 7, 10}) {
+                const std::string what = std::to_string(rows) + " rows, " + std::to_string(folds) + " folds";
+                const auto shuffled = kfold_split(rows, folds, true, kTestSeed);
+                check_partition(shuffled, rows, folds, what);
+                TestSuite::assert_true(largest_fold(shuffled) - smallest_fold(shuffled) <= 1, what + " unbalanced");
+
+                // Unshuffled folds are contiguous blocks in row order
+                const auto blocks = kfold_split(rows, folds, false);
+                const std::vector<int> fold_of = check_partition(blocks, rows, folds, what + " unshuffled");
+                TestSuite::assert_true(std::is_sorted(fold_of.begin(), fold_of.end()), what + " not contiguous");
+            }
+        }
+        // The seed alone decides the shuffle
+        const auto a = kfold_split(100, 5, true, 1);
+        const auto b = kfold_split(100, 5, true, 1);
+        const auto c = kfold_split(100, 5, true, 2);
+        TestSuite::assert_true(a[0].validation == b[0].validation, "same seed, different folds");
+        TestSuite::assert_true(a[0].validation != c[0].validation, "different seeds, same folds");
+    });
+
+    // Every fold holds floor or ceil of each label's share, with labels that are not
+    // 0..k-1 and far from balanced
+    suite.add_test("stratified_keeps_label_proportions", []() {
+        const std::vector<std::pair<double, int>> counts = {{7.0, 500}, {-1.0, 300}, {2.5, 37}, {4.0, 3}};
+        int rows = 0;
+        for (const auto& entry : counts) rows += entry.second;
+        Vector labels(rows);
+        // Interleaved, so row order says nothing about the label
+        std::mt19937_64 rng(kTestSeed);
+        std::vector<double> values;
+        for (const auto& entry : counts) values.insert(values.end(), static_cast<size_t>(entry.second), entry.first);
+        std::shuffle(values.begin(), values.end(), rng);
+        for (int r = 0; r < rows; ++r) labels[r] = static_cast<Scalar>(values[static_cast<size_t>(r)]);
+
+        for (int folds : {2, 5, 10}) {
+            const std::string what = std::to_string(folds) + " stratified folds";
+            const auto split = stratified_kfold_split(labels, folds, kTestSeed);
+            check_partition(split, rows, folds, what);
+            TestSuite::assert_true(largest_fold(split) - smallest_fold(split) <= 1, what + " unbalanced");
+            for (size_t f = 0; f < split.size(); ++f) {
+                std::map<double, int> in_fold;
+                for (int r : split[f].validation) ++in_fold[static_cast<double>(labels[r])];
+                for (const auto& entry : counts) {
+                    const int low = entry.second / folds;
+                    const int high = (entry.second + folds - 1) / folds;
+                    const int n = in_fold[entry.first];
+                    TestSuite::assert_true(n >= low && n <= high,
+                                           what + " fold " + std::to_string(f) + " has " + std::to_string(n) +
+                                               " rows of label " + format(entry.first) + ", expected " +
+                                               std::to_string(low) + " to " + std::to_string(high));
+                }
+            }
+        }
+    });
+
+    suite.add_test("group_kfold_keeps_groups_together", []() {
+        // Groups of 1 to 40 rows, rows of a group scattered
+        std::vector<double> values;
+        for (int g = 0; g < 30; ++g) values.insert(values.end(), static_cast<size_t>(1 + (g * 17) % 40), 100.0 + g);
+        std::mt19937_64 rng(kTestSeed);
+        std::shuffle(values.begin(), values.end(), rng);
+        const int rows = static_cast<int>(values.size());
+        Vector groups(rows);
+        for (int r = 0; r < rows; ++r) groups[r] = static_cast<Scalar>(values[static_cast<size_t>(r)]);
+
+        const auto split = group_kfold_split(groups, 4);
+        const std::vector<int> fold_of = check_partition(split, rows, 4, "group folds");
+        std::map<double, int> group_fold;
+        for (int r = 0; r < rows; ++r) {
+            const auto inserted = group_fold.emplace(static_cast<double>(groups[r]), fold_of[static_cast<size_t>(r)]);
+            TestSuite::assert_true(inserted.first->second == fold_of[static_cast<size_t>(r)],
+                                   "group " + format(groups[r]) + " split across folds");
+        }
+        // Largest first into the smallest fold: no fold exceeds another by more than the largest group
+        TestSuite::assert_true(largest_fold(split) - smallest_fold(split) <= 40, "group folds unbalanced");
+        TestSuite::assert_true(group_kfold_split(groups, 31).empty(), "more folds than groups");
+    });
+
+    suite.add_test("invalid_fold_counts", []() {
+        TestSuite::assert_true(kfold_split(10, 1).empty() && kfold_split(10, 11).empty(), "k-fold");
+        TestSuite::assert_true(stratified_kfold_split(Vector::Zero(3), 4).empty(), "stratified");
+        TestSuite::assert_true(!kfold_split(10, 10).empty(), "leave one out");
+    });
+
+    return run_tests(suite);
+}
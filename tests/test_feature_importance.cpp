@@ -0,0 +1,151 @@
+#include "test_common.h"
+#include "algorithms/feature_importance.h"
+#include <vector>
+
+using namespace dds;
+using namespace dds::algorithms;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+// y depends on every feature except the last, which is constant
+void make_regression(Index rows, Index cols, uint64_t seed, Matrix& X, Vector& y) {
+    X = random_matrix(rows, cols, seed);
+    y = Vector(rows);
+    for (Index i = 0; i < rows; ++i) {
+        X(i, cols - 1) = Scalar(0.5);
+        double target = 0.0;
+        for (Index j = 0; j + 1 < cols; ++j) target += (j % 2 == 0 ? 1.0 : -0.5) * X(i, j) * (1.0 + 0.1 * j);
+        y[i] = static_cast<Scalar>(target + 0.8 * X(i, 0) * X(i, 1));
+    }
+}
+
+// Path-dependent expectation of the tree given only the features in mask: unknown
+// features follow both children weighted by their training samples
+double conditional_expectation(const TreeNode* nodes, int32_t index, const Scalar* x, uint32_t mask) {
+    const TreeNode& node = nodes[index];
+    if (node.feature < 0) return node.value;
+    const int32_t left = index + 1;
+    if (mask & (1u << node.feature)) {
+        return conditional_expectation(nodes, x[node.feature] <= node.threshold ? left : node.right, x, mask);
+    }
+    return (nodes[left].weight * conditional_expectation(nodes, left, x, mask) +
+            nodes[node.right].weight * conditional_expectation(nodes, node.right, x, mask)) / node.weight;
+}
+
+// Most distinct features on one root-to-leaf path
+int max_path_features(const TreeNode* nodes, int32_t index, uint32_t mask) {
+    const TreeNode& node = nodes[index];
+    if (node.feature < 0) return __builtin_popcount(mask);
+    const uint32_t with = mask | (1u << node.feature);
+    return std::max(max_path_features(nodes, index + 1, with), max_path_features(nodes, node.right, with));
+}
+
+// Shapley values by enumerating every coalition, O(2^M) per row
+std::vector<double> brute_force_shap(const DecisionTree& tree, const Scalar* x, int features) {
+    std::vector<double> value(size_t(1) << features);
+    for (uint32_t mask = 0; mask < value.size(); ++mask) value[mask] = conditional_expectation(tree.nodes(), 0, x, mask);
+    std::vector<double> factorial(features + 1, 1.0);
+    for (int i = 1; i <= features; ++i) factorial[i] = factorial[i - 1] * i;
+    std::vector<double> phi(features, 0.0);
+    for (int f = 0; f < features; ++f) {
+        for (uint32_t mask = 0; mask < value.size(); ++mask) {
+            if (mask & (1u << f)) continue;
+            const int size = __builtin_popcount(mask);
+            const double weight = factorial[size] * factorial[features - size - 1] / factorial[features];
+            phi[f] += weight * (value[mask | (1u << f)] - value[mask]);
+        }
+    }
+    return phi;
+}
+
+// Largest |sum of SHAP values + expected value - prediction| over the rows
+template <typename Model>
+double additivity_error(const Model& model, const Matrix& X) {
+    const TreeExplainer explainer(model);
+    const Matrix shap = explainer.shap_values(X);
+    double worst = 0.0;
+    for (Index i = 0; i < X.rows(); ++i) {
+        double total = explainer.expected_value();
+        for (Index j = 0; j < X.cols(); ++j) total += shap(i, j);
+        worst = std::max(worst, std::abs(total - model.predict_row(X.data() + i * X.cols())));
+    }
+    return worst;
+}
+
+// Brute force against the explainer on the first rows of X; also checks that the
+// constant last feature gets nothing
+void check_against_brute_force(const DecisionTree& tree, const Matrix& X, Index rows) {
+    const TreeExplainer explainer(tree);
+    const Matrix shap = explainer.shap_values(X);
+    const int features = static_cast<int>(X.cols());
+    double worst = 0.0;
+    for (Index i = 0; i < rows; ++i) {
+        const std::vector<double> expected = brute_force_shap(tree, X.data() + i * X.cols(), features);
+        for (int f = 0; f < features; ++f) worst = std::max(worst, std::abs(expected[f] - shap(i, f)));
+        TestSuite::assert_true(shap(i, features - 1) == 0.0, "unused feature got a SHAP value");
+    }
+    expect_below(worst, tolerance(1e-12, 1e-5), "TreeSHAP vs brute-force Shapley");
+}
+
+} // namespace
+
+int main() {
+    TestSuite suite("feature_importance");
+
+    // Shallow paths go through the precomputed pattern tables
+    suite.add_test("shap_matches_brute_force", []() {
+        Matrix X;
+        Vector y;
+        make_regression(400, 6, 71, X, y);
+        DecisionTree tree(4, 2, 5);
+        tree.fit(X, y);
+        TestSuite::assert_true(max_path_features(tree.nodes(), 0, 0) <= TreeExplainer::kTableFeatures, "path too long");
+        check_against_brute_force(tree, X, 40);
+    });
+
+    // Paths with more than kTableFeatures distinct features are solved per row
+    suite.add_test("shap_long_paths", []() {
+        Matrix X;
+        Vector y;
+        make_regression(1500, 12, 72, X, y);
+        DecisionTree tree(20, 2, 1);
+        tree.fit(X, y);
+        TestSuite::assert_true(max_path_features(tree.nodes(), 0, 0) > TreeExplainer::kTableFeatures,
+                               "no path long enough to skip the tables");
+        check_against_brute_force(tree, X, 10);
+    });
+
+    suite.add_test("shap_additivity", []() {
+        Matrix X;
+        Vector y;
+        make_regression(1000, 8, 73, X, y);
+        const Matrix held_out = random_matrix(300, 8, 74);
+        DecisionTree tree(8);
+        tree.fit(X, y);
+        expect_below(additivity_error(tree, held_out), tolerance(1e-12, 1e-5), "decision tree");
+        RandomForest forest(20, 6);
+        forest.fit(X, y);
+        expect_below(additivity_error(forest, held_out), tolerance(1e-12, 1e-5), "random forest");
+        GradientBoosting boosting(50, 0.1, 3);
+        boosting.fit(X, y);
+        expect_below(additivity_error(boosting, held_out), tolerance(1e-12, 1e-5), "gradient boosting");
+    });
+
+    suite.add_test("permutation_importance_ranks_features", []() {
+        Matrix X;
+        Vector y;
+        make_regression(1000, 5, 75, X, y);
+        GradientBoosting boosting(60, 0.1, 3);
+        boosting.fit(X, y);
+        const PermutationImportance importance = permutation_importance(boosting, X, y, 3, kTestSeed);
+        TestSuite::assert_true(importance.mean.size() == 5, "one importance per feature");
+        TestSuite::assert_true(importance.mean[0] > importance.mean[3], "feature 0 should matter more than 3");
+        expect_below(std::abs(importance.mean[4]), 1e-12, "constant feature importance");
+        TestSuite::assert_true(importance.baseline_loss > 0.0 && importance.mean[0] > importance.baseline_loss,
+                               "shuffling the strongest feature should more than double the loss");
+    });
+
+    return run_tests(suite);
+}
@@ -0,0 +1,127 @@
+#include "test_common.h"
+#include "algorithms/hyperparameter_search.h"
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace dds;
+using namespace dds::algorithms;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+constexpr int kTrials = 27;
+constexpr int kMinBudget = 1;
+constexpr int kMaxBudget = 27;
+constexpr int kEta = 3;
+
+// Synthetic objective: the loss is "quality" plus a term that shrinks with the budget,
+// so configurations rank the same at every budget and the best one is known. Each
+// evaluation's budget is logged per configuration, keyed by its quality.
+struct LoggedObjective {
+    std::mutex mutex;
+    std::map<double, std::vector<int>> budgets;
+
+    TrialObjective objective() {
+        return [this](const HyperParameters& parameters, int budget, const TuningData&) {
+            const double quality = get_parameter(parameters, "quality", 0.0);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                budgets[quality].push_back(budget);
+            }
+            return quality + 1.0 / budget;
+        };
+    }
+};
+
+SearchSpace quality_space() {
+    SearchSpace space;
+    space.add_range("quality", 0.0, 1.0);
+    return space;
+}
+
+const TuningData& tuning_data() {
+    static const TuningData data(random_matrix(40, 3, 1), Vector::Zero(40), random_matrix(10, 3, 2),
+                                 Vector::Zero(10));
+    return data;
+}
+
+HyperparameterSearch make_search(LoggedObjective& logged, SearchStrategy strategy) {
+    HyperparameterSearch search(quality_space(), logged.objective(), strategy);
+    search.set_trials(kTrials);
+    search.set_budget(kMinBudget, kMaxBudget, kEta);
+    search.set_seed(kTestSeed);
+    return search;
+}
+
+int lowest_quality(const HyperparameterSearch& search) {
+    int best = 0;
+    for (const TrialResult& trial : search.results()) {
+        const double quality = get_parameter(trial.parameters, "quality", 0.0);
+        if (quality < get_parameter(search.results()[static_cast<size_t>(best)].parameters, "quality", 0.0)) {
+            best = trial.id;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    TestSuite suite("hyperparameter_search");
+
+    // Pruning stops the losing configurations early but never the best one: it is
+    // promoted through every rung and reported as best, as an exhaustive search finds
+    suite.add_test("asha_keeps_best_configuration", []() {
+        LoggedObjective logged;
+        HyperparameterSearch asha = make_search(logged, SearchStrategy::ASHA);
+        TestSuite::assert_true(asha.run(tuning_data()), "ASHA run failed");
+        const int expected = lowest_quality(asha);
+        TestSuite::assert_true(asha.best() != nullptr && asha.best()->id == expected,
+                               "best is not the lowest-loss configuration " + std::to_string(expected));
+        TestSuite::assert_true(asha.best()->budget == kMaxBudget && !asha.best()->stopped,
+                               "best stopped at budget " + std::to_string(asha.best()->budget));
+
+        LoggedObjective exhaustive_log;
+        HyperparameterSearch exhaustive = make_search(exhaustive_log, SearchStrategy::RANDOM);
+        TestSuite::assert_true(exhaustive.run(tuning_data()), "random run failed");
+        TestSuite::assert_true(exhaustive.best()->id == expected, "random search found another best");
+        expect_near(exhaustive.best()->score, asha.best()->score, 0.0, "best score");
+        TestSuite::assert_true(asha.budget_used() < exhaustive.budget_used() / 3,
+                               "ASHA used " + std::to_string(asha.budget_used()) + " of " +
+                                   std::to_string(exhaustive.budget_used()) + " budget units");
+    });
+
+    // Every configuration starts on the smallest budget and climbs the rungs one at a
+    // time; the results and the budget total match what was actually evaluated
+    suite.add_test("asha_rungs_and_budget_accounting", []() {
+        LoggedObjective logged;
+        HyperparameterSearch asha = make_search(logged, SearchStrategy::ASHA);
+        TestSuite::assert_true(asha.run(tuning_data()), "ASHA run failed");
+        TestSuite::assert_true(logged.budgets.size() == static_cast<size_t>(kTrials), "configurations evaluated");
+        long long total = 0;
+        int at_top = 0;
+        for (const TrialResult& trial : asha.results()) {
+            const std::vector<int>& budgets = logged.budgets[get_parameter(trial.parameters, "quality", 0.0)];
+            const std::string what = "configuration " + std::to_string(trial.id);
+            int expected_budget = kMinBudget;
+            for (int budget : budgets) {
+                TestSuite::assert_true(budget == expected_budget, what + " evaluated out of rung order");
+                expected_budget *= kEta;
+                total += budget;
+            }
+            TestSuite::assert_true(trial.budget == budgets.back() && trial.rung + 1 == static_cast<int>(budgets.size()),
+                                   what + " result is not its last evaluation");
+            expect_near(get_parameter(trial.parameters, "quality", 0.0) + 1.0 / trial.budget, trial.score, 0.0,
+                        what + " score");
+            TestSuite::assert_true(trial.stopped == (trial.budget < kMaxBudget), what + " stopped flag");
+            if (trial.budget == kMaxBudget) ++at_top;
+        }
+        TestSuite::assert_true(total == asha.budget_used(), "budget_used " + std::to_string(asha.budget_used()) +
+                                                                " but evaluated " + std::to_string(total));
+        TestSuite::assert_true(at_top >= 1 && at_top < kTrials / kEta, std::to_string(at_top) + " reached the top");
+    });
+
+    return run_tests(suite);
+}
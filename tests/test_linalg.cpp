@@ -0,0 +1,169 @@
+#include "test_common.h"
+#include "utils/parallel.h"
+
+using namespace dds;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+// Shapes cross the 64/256/256 packing blocks and leave ragged edges, so every
+// panel, slab and leftover-row path of the kernel runs
+constexpr Index kM = 203;
+constexpr Index kK = 301;
+constexpr Index kN = 277;
+
+void check_gemm(Eigen::GemmOp op_a, Eigen::GemmOp op_b) {
+    // Stored shapes so that op(a) is kM x kK and op(b) is kK x kN
+    const Matrix a = op_a == Eigen::Trans ? random_matrix(kK, kM, 1) : random_matrix(kM, kK, 1);
+    const Matrix b = op_b == Eigen::Trans ? random_matrix(kN, kK, 2) : random_matrix(kK, kN, 2);
+    const Matrix expected = naive_product(op_a == Eigen::Trans ? transposed(a) : a,
+                                          op_b == Eigen::Trans ? transposed(b) : b);
+    Matrix c;
+    Eigen::gemm(op_a, op_b, Scalar(1), a, b, Scalar(0), c);
+    expect_below(max_abs_diff(c, expected), tolerance(1e-12, 1e-3), "gemm max error");
+
+    // alpha and beta: c = 2 * op(a) op(b) - 0.5 * c0
+    const Matrix c0 = random_matrix(kM, kN, 3);
+    Matrix scaled = c0;
+    Eigen::gemm(op_a, op_b, Scalar(2), a, b, Scalar(-0.5), scaled);
+    Matrix reference(kM, kN);
+    for (Index i = 0; i < reference.size(); ++i) {
+        reference.data()[i] = static_cast<Scalar>(2.0 * expected.data()[i] - 0.5 * c0.data()[i]);
+    }
+    expect_below(max_abs_diff(scaled, reference), tolerance(1e-12, 2e-3), "gemm alpha/beta max error");
+}
+
+// Largest entry of a^T a - I, for factors with orthonormal columns
+double orthonormality_error(const Matrix& a) {
+    const Matrix gram = naive_product(transposed(a), a);
+    double worst = 0.0;
+    for (Index i = 0; i < gram.rows(); ++i) {
+        for (Index j = 0; j < gram.cols(); ++j) {
+            worst = std::max(worst, std::abs(static_cast<double>(gram(i, j)) - (i == j ? 1.0 : 0.0)));
+        }
+    }
+    return worst;
+}
+
+// ||a - b||_max / ||b||_max
+double relative_error(const Matrix& a, const Matrix& b) {
+    return max_abs_diff(a, b) / std::max(max_abs_diff(b, Matrix::Zero(b.rows(), b.cols())), 1e-300);
+}
+
+// Symmetric positive definite: B^T B + n I
+Matrix spd_matrix(Index n, uint64_t seed) {
+    const Matrix b = random_matrix(n, n, seed);
+    Matrix a = naive_product(transposed(b), b);
+    for (Index i = 0; i < n; ++i) a(i, i) += static_cast<Scalar>(n);
+    return a;
+}
+
+void check_svd(Index rows, Index cols, uint64_t seed) {
+    const Matrix a = random_matrix(rows, cols, seed);
+    Eigen::JacobiSVD<Scalar> svd(a, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    TestSuite::assert_true(svd.info() == Eigen::Success, "SVD did not converge");
+    const Index p = std::min(rows, cols);
+    TestSuite::assert_true(svd.matrixU().rows() == rows && svd.matrixU().cols() == p, "thin U shape");
+    TestSuite::assert_true(svd.matrixV().rows() == cols && svd.matrixV().cols() == p, "thin V shape");
+    Matrix us = svd.matrixU();
+    for (Index i = 0; i < rows; ++i) {
+        for (Index j = 0; j < p; ++j) us(i, j) = static_cast<Scalar>(us(i, j) * svd.singularValues()[j]);
+    }
+    for (Index j = 1; j < p; ++j) {
+        TestSuite::assert_true(svd.singularValues()[j - 1] >= svd.singularValues()[j], "singular values not sorted");
+    }
+    expect_below(relative_error(naive_product(us, transposed(svd.matrixV())), a), tolerance(1e-11, 1e-4),
+                 "U S V^T residual");
+    expect_below(orthonormality_error(svd.matrixU()), tolerance(1e-11, 1e-4), "U^T U - I");
+    expect_below(orthonormality_error(svd.matrixV()), tolerance(1e-11, 1e-4), "V^T V - I");
+}
+
+} // namespace
+
+int main() {
+    TestSuite suite("linalg");
+
+    // ctest runs this suite with DDS_NUM_THREADS=4; without a multi-threaded pool the
+    // products below would never split a panel across workers
+    suite.add_test("pool_has_workers", []() {
+        TestSuite::assert_true(utils::max_threads() > 1, "run with DDS_NUM_THREADS >= 2 to cover threaded kernels");
+    });
+    suite.add_test("gemm_nn", []() { check_gemm(Eigen::NoTrans, Eigen::NoTrans); });
+    suite.add_test("gemm_nt", []() { check_gemm(Eigen::NoTrans, Eigen::Trans); });
+    suite.add_test("gemm_tn", []() { check_gemm(Eigen::Trans, Eigen::NoTrans); });
+    suite.add_test("gemm_tt", []() { check_gemm(Eigen::Trans, Eigen::Trans); });
+
+    suite.add_test("matrix_products", []() {
+        const Matrix a = random_matrix(kM, kK, 4);
+        const Matrix b = random_matrix(kK, kN, 5);
+        const Matrix expected = naive_product(a, b);
+        expect_below(max_abs_diff(a * b, expected), tolerance(1e-12, 1e-3), "A * B");
+        const Matrix at = transposed(a);
+        expect_below(max_abs_diff(at.transpose() * b, expected), tolerance(1e-12, 1e-3), "A^T^T * B");
+        const Matrix bt = transposed(b);
+        expect_below(max_abs_diff(a * bt.transpose(), expected), tolerance(1e-12, 1e-3), "A * B^T^T");
+    });
+
+    suite.add_test("matrix_vector", []() {
+        const Matrix a = random_matrix(4099, kK, 6);
+        const Matrix x = random_matrix(kK, 1, 7);
+        expect_below(max_abs_diff(a * x, naive_product(a, x)), tolerance(1e-12, 1e-3), "A * x");
+    });
+
+    // Factorizations: sizes past the 64-wide panels so the blocked updates run
+
+    suite.add_test("llt_reconstruction", []() {
+        const Matrix a = spd_matrix(150, 8);
+        Eigen::LLT<Scalar> llt(a);
+        TestSuite::assert_true(llt.info() == Eigen::Success, "LLT failed on an SPD matrix");
+        const Matrix& l = llt.matrixL();
+        for (Index i = 0; i < l.rows(); ++i) {
+            for (Index j = i + 1; j < l.cols(); ++j) TestSuite::assert_true(l(i, j) == Scalar(0), "L not lower triangular");
+        }
+        expect_below(relative_error(naive_product(l, transposed(l)), a), tolerance(1e-12, 1e-5), "L L^T residual");
+        const Matrix b = random_matrix(150, 3, 9);
+        expect_below(relative_error(naive_product(a, llt.solve(b)), b), tolerance(1e-11, 1e-4), "LLT solve residual");
+        Eigen::LLT<Scalar> indefinite(random_matrix(70, 70, 10));
+        TestSuite::assert_true(indefinite.info() == Eigen::NumericalIssue, "LLT accepted an indefinite matrix");
+    });
+
+    suite.add_test("qr_reconstruction", []() {
+        const Matrix a = random_matrix(180, 130, 11);
+        Eigen::HouseholderQR<Scalar> qr(a);
+        const Matrix q = qr.householderQ();
+        const Matrix r = qr.matrixR();
+        expect_below(relative_error(naive_product(q, r), a), tolerance(1e-12, 1e-5), "Q R residual");
+        expect_below(orthonormality_error(q), tolerance(1e-12, 1e-5), "Q^T Q - I");
+        // Least squares: the residual is orthogonal to the columns of A
+        const Matrix b = random_matrix(180, 1, 12);
+        const Matrix x = qr.solve(b);
+        Matrix residual = naive_product(a, x);
+        for (Index i = 0; i < residual.size(); ++i) residual.data()[i] -= b.data()[i];
+        const Matrix normal = naive_product(transposed(a), residual);
+        expect_below(max_abs_diff(normal, Matrix::Zero(130, 1)), tolerance(1e-10, 1e-3), "A^T (A x - b)");
+    });
+
+    suite.add_test("eigensolver_reconstruction", []() {
+        const Index n = 140;
+        const Matrix b = random_matrix(n, n, 13);
+        Matrix a = b;
+        for (Index i = 0; i < n; ++i) {
+            for (Index j = 0; j < n; ++j) a(i, j) = static_cast<Scalar>(0.5 * (b(i, j) + b(j, i)));
+        }
+        Eigen::SelfAdjointEigenSolver<Scalar> eig(a);
+        TestSuite::assert_true(eig.info() == Eigen::Success, "eigensolver did not converge");
+        const Matrix& v = eig.eigenvectors();
+        Matrix v_lambda = v;
+        for (Index i = 0; i < n; ++i) {
+            for (Index j = 0; j < n; ++j) v_lambda(i, j) = static_cast<Scalar>(v(i, j) * eig.eigenvalues()[j]);
+        }
+        expect_below(relative_error(naive_product(a, v), v_lambda), tolerance(1e-11, 1e-4), "A V - V Lambda");
+        expect_below(orthonormality_error(v), tolerance(1e-12, 1e-5), "V^T V - I");
+    });
+
+    suite.add_test("svd_tall_reconstruction", []() { check_svd(160, 90, 14); });
+    suite.add_test("svd_wide_reconstruction", []() { check_svd(70, 120, 15); });
+
+    return run_tests(suite);
+}
@@ -0,0 +1,231 @@
+#include "test_common.h"
+#include "algorithms/logistic_regression.h"
+#include <random>
+#include <vector>
+
+using namespace dds;
+using namespace dds::algorithms;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+constexpr Index kRows = 600;
+constexpr Index kCols = 6;
+
+// Labels drawn from a logistic (softmax for more classes) model on random features,
+// so the classes overlap and the unpenalized optimum is finite
+void make_classification(int classes, uint64_t seed, Matrix& X, Vector& y) {
+    X = random_matrix(kRows, kCols, seed);
+    const Matrix w = random_matrix(classes, kCols, seed + 1);
+    std::mt19937_64 rng(seed + 2);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    y = Vector(kRows);
+    for (Index i = 0; i < kRows; ++i) {
+        std::vector<double> p(static_cast<size_t>(classes));
+        double total = 0.0;
+        for (int c = 0; c < classes; ++c) {
+            double z = 0.0;
+            for (Index j = 0; j < kCols; ++j) z += 2.0 * w(c, j) * X(i, j);
+            p[static_cast<size_t>(c)] = std::exp(z);
+            total += p[static_cast<size_t>(c)];
+        }
+        double u = uniform(rng) * total;
+        int label = 0;
+        while (label + 1 < classes && u >= p[static_cast<size_t>(label)]) u -= p[static_cast<size_t>(label++)];
+        y[i] = static_cast<Scalar>(label);
+    }
+}
+
+// Gradient of the mean log-loss (no penalty) for one output row, in double: binary
+// models (one row) against class 1, otherwise softmax, or each class against the rest
+// when one_vs_rest. Entry kCols is the bias.
+std::vector<double> loss_gradient(const LogisticRegressionParams& params, const Matrix& X, const Vector& y,
+                                  Index output, bool one_vs_rest) {
+    const Index outputs = params.weights.rows();
+    std::vector<double> gradient(static_cast<size_t>(kCols + 1), 0.0);
+    std::vector<double> z(static_cast<size_t>(outputs));
+    for (Index i = 0; i < X.rows(); ++i) {
+        for (Index c = 0; c < outputs; ++c) {
+            double m = params.bias[c];
+            for (Index j = 0; j < kCols; ++j) m += static_cast<double>(params.weights(c, j)) * X(i, j);
+            z[static_cast<size_t>(c)] = m;
+        }
+        double p;
+        if (outputs == 1 || one_vs_rest) {
+            p = 1.0 / (1.0 + std::exp(-z[static_cast<size_t>(output)]));
+        } else {
+            const double top = *std::max_element(z.begin(), z.end());
+            double total = 0.0;
+            for (double m : z) total += std::exp(m - top);
+            p = std::exp(z[static_cast<size_t>(output)] - top) / total;
+        }
+        const int positive = outputs == 1 ? 1 : static_cast<int>(output);
+        const double residual = p - (static_cast<int>(y[i]) == positive ? 1.0 : 0.0);
+        for (Index j = 0; j < kCols; ++j) gradient[static_cast<size_t>(j)] += residual * X(i, j);
+        gradient[static_cast<size_t>(kCols)] += residual;
+    }
+    for (double& g : gradient) g /= static_cast<double>(X.rows());
+    return gradient;
+}
+
+// Binary unpenalized optimum by Newton's method with a dense solve, the reference
+// both solvers must reach
+std::vector<double> newton_reference(const Matrix& X, const Vector& y) {
+    const Index n = kCols + 1;
+    std::vector<double> theta(static_cast<size_t>(n), 0.0);
+    for (int iteration = 0; iteration < 50; ++iteration) {
+        std::vector<double> g(static_cast<size_t>(n), 0.0), h(static_cast<size_t>(n * n), 0.0);
+        for (Index i = 0; i < X.rows(); ++i) {
+            std::vector<double> x(static_cast<size_t>(n), 1.0);
+            for (Index j = 0; j < kCols; ++j) x[static_cast<size_t>(j)] = X(i, j);
+            double z = 0.0;
+            for (Index j = 0; j < n; ++j) z += theta[static_cast<size_t>(j)] * x[static_cast<size_t>(j)];
+            const double p = 1.0 / (1.0 + std::exp(-z));
+            for (Index a = 0; a < n; ++a) {
+                g[static_cast<size_t>(a)] += (p - y[i]) * x[static_cast<size_t>(a)];
+                for (Index b = 0; b < n; ++b) {
+                    h[static_cast<size_t>(a * n + b)] += p * (1.0 - p) * x[static_cast<size_t>(a)] *
+                                                         x[static_cast<size_t>(b)];
+                }
+            }
+        }
+        // Gaussian elimination with partial pivoting on h * step = g
+        for (Index k = 0; k < n; ++k) {
+            Index pivot = k;
+            for (Index r = k + 1; r < n; ++r) {
+                if (std::abs(h[static_cast<size_t>(r * n + k)]) > std::abs(h[static_cast<size_t>(pivot * n + k)])) {
+                    pivot = r;
+                }
+            }
+            for (Index c = 0; c < n; ++c) {
+                std::swap(h[static_cast<size_t>(k * n + c)], h[static_cast<size_t>(pivot * n + c)]);
+            }
+            std::swap(g[static_cast<size_t>(k)], g[static_cast<size_t>(pivot)]);
+            for (Index r = k + 1; r < n; ++r) {
+                const double f = h[static_cast<size_t>(r * n + k)] / h[static_cast<size_t>(k * n + k)];
+                for (Index c = k; c < n; ++c) {
+                    h[static_cast<size_t>(r * n + c)] -= f * h[static_cast<size_t>(k * n + c)];
+                }
+                g[static_cast<size_t>(r)] -= f * g[static_cast<size_t>(k)];
+            }
+        }
+        for (Index k = n - 1; k >= 0; --k) {
+            double s = g[static_cast<size_t>(k)];
+            for (Index c = k + 1; c < n; ++c) s -= h[static_cast<size_t>(k * n + c)] * g[static_cast<size_t>(c)];
+            g[static_cast<size_t>(k)] = s / h[static_cast<size_t>(k * n + k)];
+        }
+        for (Index j = 0; j < n; ++j) theta[static_cast<size_t>(j)] -= g[static_cast<size_t>(j)];
+    }
+    return theta;
+}
+
+LogisticRegressionParams make_params(double strength, double tol) {
+    return LogisticRegressionParams{Matrix(), Vector(), 0.0, 5000, tol, strength > 0.0, strength, 0};
+}
+
+double coefficient_error(const LogisticRegressionParams& params, const std::vector<double>& reference) {
+    double worst = std::abs(params.bias[0] - reference[static_cast<size_t>(kCols)]);
+    for (Index j = 0; j < kCols; ++j) {
+        worst = std::max(worst, std::abs(params.weights(0, j) - reference[static_cast<size_t>(j)]));
+    }
+    return worst;
+}
+
+// Coefficients are stored as Scalar, so float builds round the optimum
+const double kStationary = tolerance(1e-8, 1e-5);
+
+// L1 optimality: zero coefficients have |gradient| <= strength, nonzero ones have
+// gradient = -strength * sign; the unpenalized bias has zero gradient. Returns the
+// number of zero coefficients.
+int check_l1_kkt(const LogisticRegressionParams& params, const Matrix& X, const Vector& y, double strength,
+                 bool one_vs_rest, const std::string& what) {
+    int zeros = 0;
+    for (Index c = 0; c < params.weights.rows(); ++c) {
+        const std::vector<double> g = loss_gradient(params, X, y, c, one_vs_rest);
+        const std::string output = what + " output " + std::to_string(c);
+        expect_below(std::abs(g[static_cast<size_t>(kCols)]), kStationary, output + " bias gradient");
+        for (Index j = 0; j < kCols; ++j) {
+            const double w = params.weights(c, j);
+            const double gj = g[static_cast<size_t>(j)];
+            const std::string coefficient = output + " coefficient " + std::to_string(j);
+            if (w == 0.0) {
+                ++zeros;
+                expect_below(std::abs(gj), strength + kStationary, coefficient + " (zero) gradient");
+            } else {
+                expect_below(std::abs(gj + (w > 0.0 ? strength : -strength)), kStationary,
+                             coefficient + " subgradient");
+            }
+        }
+    }
+    return zeros;
+}
+
+} // namespace
+
+int main() {
+    TestSuite suite("logistic");
+
+    // Without a penalty L-BFGS and coordinate descent both land on the Newton optimum
+    suite.add_test("binary_solvers_reach_newton_optimum", []() {
+        Matrix X;
+        Vector y;
+        make_classification(2, 1, X, y);
+        const std::vector<double> reference = newton_reference(X, y);
+        for (LogisticSolver solver : {LogisticSolver::LBFGS, LogisticSolver::COORDINATE_DESCENT}) {
+            const std::string name = solver == LogisticSolver::LBFGS ? "L-BFGS" : "coordinate descent";
+            LogisticRegression model(make_params(0.0, 1e-10), LogisticPenalty::L2, solver);
+            TestSuite::assert_true(model.fit(X, y) && model.converged(), name + " did not converge");
+            expect_below(coefficient_error(model.params(), reference), tolerance(1e-7, 1e-5), name + " vs Newton");
+        }
+    });
+
+    // L2: the penalized gradient, loss gradient + strength * W, vanishes at the optimum
+    suite.add_test("lbfgs_l2_stationary", []() {
+        const double strength = 0.05;
+        for (int classes : {2, 3}) {
+            Matrix X;
+            Vector y;
+            make_classification(classes, 3 + static_cast<uint64_t>(classes), X, y);
+            LogisticRegression model(make_params(strength, 1e-10), LogisticPenalty::L2, LogisticSolver::LBFGS);
+            TestSuite::assert_true(model.fit(X, y) && model.converged(), "L-BFGS did not converge");
+            const LogisticRegressionParams& params = model.params();
+            for (Index c = 0; c < params.weights.rows(); ++c) {
+                const std::vector<double> g = loss_gradient(params, X, y, c, false);
+                const std::string what = std::to_string(classes) + " classes output " + std::to_string(c);
+                expect_below(std::abs(g[static_cast<size_t>(kCols)]), kStationary, what + " bias gradient");
+                for (Index j = 0; j < kCols; ++j) {
+                    expect_below(std::abs(g[static_cast<size_t>(j)] + strength * params.weights(c, j)), kStationary,
+                                 what + " coefficient " + std::to_string(j));
+                }
+            }
+        }
+    });
+
+    // L1 by coordinate descent satisfies the subgradient conditions, and is sparse
+    suite.add_test("coordinate_descent_l1_kkt", []() {
+        const double strength = 0.04;
+        Matrix X;
+        Vector y;
+        make_classification(2, 7, X, y);
+        LogisticRegression model(make_params(strength, 1e-10), LogisticPenalty::L1);
+        TestSuite::assert_true(model.fit(X, y) && model.converged(), "coordinate descent did not converge");
+        const int zeros = check_l1_kkt(model.params(), X, y, strength, false, "dense");
+        TestSuite::assert_true(zeros > 0 && zeros < kCols, std::to_string(zeros) + " zero coefficients");
+
+        // The CSR path reaches the same optimum
+        LogisticRegression sparse(make_params(strength, 1e-10), LogisticPenalty::L1);
+        TestSuite::assert_true(sparse.fit(SparseMatrixCSR::fromDense(X), y), "sparse fit failed");
+        check_l1_kkt(sparse.params(), X, y, strength, false, "sparse");
+        expect_below(max_abs_diff(sparse.params().weights, model.params().weights), tolerance(1e-7, 1e-5),
+                     "sparse vs dense coefficients");
+
+        // One versus rest: each class's problem on its own
+        make_classification(3, 9, X, y);
+        LogisticRegression multi(make_params(strength, 1e-10), LogisticPenalty::L1);
+        TestSuite::assert_true(multi.fit(X, y) && multi.converged(), "one versus rest did not converge");
+        check_l1_kkt(multi.params(), X, y, strength, true, "one versus rest");
+    });
+
+    return run_tests(suite);
+}
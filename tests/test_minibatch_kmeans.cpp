@@ -0,0 +1,185 @@
+#include "test_common.h"
+#include "algorithms/minibatch_kmeans.h"
+#include <random>
+#include <vector>
+
+using namespace dds;
+using namespace dds::algorithms;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+constexpr int kClusters = 5;
+constexpr Index kDims = 4;
+constexpr Index kRows = 6000;
+constexpr Index kBatch = 600;         // More than one block, so batches split across the workers
+
+// Gaussian blobs (sd 0.4) around random centers in [-5, 5]^d, rows shuffled; the
+// centers are returned for seeding the reference
+Matrix make_blobs(uint64_t seed, Matrix& centers) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uniform(-5.0, 5.0);
+    std::normal_distribution<double> noise(0.0, 0.4);
+    centers = Matrix(kClusters, kDims);
+    for (Index i = 0; i < centers.size(); ++i) centers.data()[i] = static_cast<Scalar>(uniform(rng));
+    Matrix X(kRows, kDims);
+    for (Index i = 0; i < kRows; ++i) {
+        const Index c = static_cast<Index>(rng() % kClusters);
+        for (Index j = 0; j < kDims; ++j) X(i, j) = static_cast<Scalar>(centers(c, j) + noise(rng));
+    }
+    return X;
+}
+
+Matrix rows_of(const Matrix& X, Index begin, Index end) {
+    return X.block(begin, 0, end - begin, X.cols());
+}
+
+int nearest(const Matrix& centroids, const Matrix& X, Index i) {
+    int best = 0;
+    double best_distance = INFINITY;
+    for (Index c = 0; c < centroids.rows(); ++c) {
+        double distance = 0.0;
+        for (Index j = 0; j < X.cols(); ++j) {
+            const double diff = static_cast<double>(X(i, j)) - centroids(c, j);
+            distance += diff * diff;
+        }
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = static_cast<int>(c);
+        }
+    }
+    return best;
+}
+
+double squared_distance(const Matrix& a, Index i, const Matrix& b, Index k) {
+    double total = 0.0;
+    for (Index j = 0; j < a.cols(); ++j) {
+        const double diff = static_cast<double>(a(i, j)) - b(k, j);
+        total += diff * diff;
+    }
+    return total;
+}
+
+// Full-batch Lloyd iterations in double until no row changes cluster: the full
+// k-means solution the mini-batch model should approach
+Matrix lloyd(const Matrix& X, Matrix centroids) {
+    std::vector<int> assignment(static_cast<size_t>(X.rows()), -1);
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        bool changed = false;
+        std::vector<double> sums(static_cast<size_t>(kClusters * kDims), 0.0);
+        std::vector<double> sizes(static_cast<size_t>(kClusters), 0.0);
+        for (Index i = 0; i < X.rows(); ++i) {
+            const int c = nearest(centroids, X, i);
+            changed = changed || c != assignment[static_cast<size_t>(i)];
+            assignment[static_cast<size_t>(i)] = c;
+            for (Index j = 0; j < kDims; ++j) sums[static_cast<size_t>(c * kDims + j)] += X(i, j);
+            sizes[static_cast<size_t>(c)] += 1.0;
+        }
+        for (Index c = 0; c < kClusters; ++c) {
+            for (Index j = 0; j < kDims; ++j) {
+                centroids(c, j) = static_cast<Scalar>(sums[static_cast<size_t>(c * kDims + j)] /
+                                                      sizes[static_cast<size_t>(c)]);
+            }
+        }
+        if (!changed) break;
+    }
+    return centroids;
+}
+
+double mean_inertia(const Matrix& X, const Matrix& centroids) {
+    double total = 0.0;
+    for (Index i = 0; i < X.rows(); ++i) total += squared_distance(X, i, centroids, nearest(centroids, X, i));
+    return total / static_cast<double>(X.rows());
+}
+
+// Each reference centroid's distance to the nearest learned one, and that every
+// learned centroid is the nearest to exactly one reference centroid
+double match_centroids(const Matrix& reference, const Matrix& learned, const std::string& what) {
+    std::vector<int> used(static_cast<size_t>(learned.rows()), 0);
+    double worst = 0.0;
+    for (Index c = 0; c < reference.rows(); ++c) {
+        const int match = nearest(learned, reference, c);
+        ++used[static_cast<size_t>(match)];
+        worst = std::max(worst, std::sqrt(squared_distance(reference, c, learned, match)));
+    }
+    TestSuite::assert_true(std::all_of(used.begin(), used.end(), [](int n) { return n == 1; }),
+                           what + ": learned centroids do not match the clusters one to one");
+    return worst;
+}
+
+} // namespace
+
+int main() {
+    TestSuite suite("minibatch_kmeans");
+
+    // Each update leaves every centroid the running mean of the rows it has taken:
+    // (count * old + sum of its new rows) / (count + new rows)
+    suite.add_test("partial_fit_running_mean", []() {
+        Matrix centers;
+        const Matrix X = make_blobs(1, centers);
+        MiniBatchKMeans model(kClusters, kBatch, kTestSeed);
+        TestSuite::assert_true(model.partial_fit(rows_of(X, 0, kBatch)), "first batch");
+        for (Index start = kBatch; start < 4 * kBatch; start += kBatch) {
+            const Matrix before = model.centroids();
+            const std::vector<double> counts = model.counts();
+            const Matrix batch = rows_of(X, start, start + kBatch);
+            std::vector<double> sums(static_cast<size_t>(kClusters * kDims), 0.0);
+            std::vector<double> sizes(static_cast<size_t>(kClusters), 0.0);
+            for (Index i = 0; i < kBatch; ++i) {
+                const int c = nearest(before, batch, i);
+                for (Index j = 0; j < kDims; ++j) sums[static_cast<size_t>(c * kDims + j)] += batch(i, j);
+                sizes[static_cast<size_t>(c)] += 1.0;
+            }
+            TestSuite::assert_true(model.partial_fit(batch), "batch");
+            double total = 0.0;
+            for (Index c = 0; c < kClusters; ++c) {
+                const double count = counts[static_cast<size_t>(c)] + sizes[static_cast<size_t>(c)];
+                expect_near(count, model.counts()[static_cast<size_t>(c)], 0.0, "count " + std::to_string(c));
+                total += model.counts()[static_cast<size_t>(c)];
+                for (Index j = 0; j < kDims; ++j) {
+                    const double expected = (counts[static_cast<size_t>(c)] * before(c, j) +
+                                             sums[static_cast<size_t>(c * kDims + j)]) / count;
+                    expect_near(expected, model.centroids()(c, j), tolerance(1e-12, 1e-5),
+                                "centroid " + std::to_string(c));
+                }
+            }
+            expect_near(static_cast<double>(start + kBatch), total, 0.0, "rows counted");
+        }
+        TestSuite::assert_true(model.batches() == 4, "batches");
+    });
+
+    // Streamed a batch at a time, a few passes end near the full-batch optimum
+    suite.add_test("partial_fit_converges_near_full_kmeans", []() {
+        Matrix centers;
+        const Matrix X = make_blobs(2, centers);
+        const Matrix reference = lloyd(X, centers);
+        const double optimum = mean_inertia(X, reference);
+
+        MiniBatchKMeans model(kClusters, kBatch, kTestSeed);
+        for (int epoch = 0; epoch < 3; ++epoch) {
+            for (Index start = 0; start < kRows; start += kBatch) {
+                TestSuite::assert_true(model.partial_fit(rows_of(X, start, start + kBatch)), "batch");
+            }
+        }
+        expect_below(model.inertia(X), optimum * 1.01, "mini-batch inertia against the full k-means optimum");
+        expect_near(mean_inertia(X, model.centroids()), model.inertia(X), tolerance(1e-9, 1e-4) * optimum,
+                    "inertia()");
+        expect_below(match_centroids(reference, model.centroids(), "partial_fit"), 0.05, "centroid distance");
+        TestSuite::assert_true(model.predict(X).size() == static_cast<size_t>(kRows), "predict");
+        const std::vector<int> labels = model.predict(X);
+        for (Index i = 0; i < kRows; i += 97) {
+            TestSuite::assert_true(labels[static_cast<size_t>(i)] == nearest(model.centroids(), X, i),
+                                   "predict row " + std::to_string(i));
+        }
+
+        // fit() over the same rows in memory gets there too
+        MiniBatchKMeans fitted(kClusters, kBatch, kTestSeed);
+        fitted.set_max_epochs(3);
+        TestSuite::assert_true(fitted.fit(X), "fit");
+        expect_below(fitted.inertia(X), optimum * 1.01, "fit() inertia against the full k-means optimum");
+        expect_below(match_centroids(reference, fitted.centroids(), "fit"), 0.05, "fit() centroid distance");
+    });
+
+    return run_tests(suite);
+}
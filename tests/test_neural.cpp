@@ -0,0 +1,706 @@
+#include "test_common.h"
+#include "algorithms/advanced_algorithms.h"
+#include "algorithms/model_format.h"
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+
+using namespace dds;
+using namespace dds::algorithms;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+// 16 inputs -> 32 RELU -> dropout -> 3 LINEAR
+std::unique_ptr<NeuralNetwork> dropout_network() {
+    auto network = std::make_unique<NeuralNetwork>(0.01, 32);
+    network->add_layer(std::make_unique<DenseLayer>(16, 32, ActivationType::RELU));
+    network->add_dropout_layer(0.5);
+    network->add_dense_layer(3, ActivationType::LINEAR);
+    return network;
+}
+
+// Three well separated Gaussian clusters in 4 features, labels 0..2 in one column
+void make_clusters(Index rows, Matrix& X, Matrix& labels) {
+    std::mt19937_64 rng(kTestSeed);
+    std::normal_distribution<double> noise(0.0, 0.3);
+    X = Matrix(rows, 4);
+    labels = Matrix(rows, 1);
+    for (Index i = 0; i < rows; ++i) {
+        const int label = static_cast<int>(i % 3);
+        for (Index j = 0; j < 4; ++j) X(i, j) = static_cast<Scalar>((j == label ? 2.0 : 0.0) + noise(rng));
+        labels(i, 0) = static_cast<Scalar>(label);
+    }
+}
+
+double accuracy(const Matrix& probabilities, const Matrix& labels) {
+    Index correct = 0;
+    for (Index i = 0; i < probabilities.rows(); ++i) {
+        const Scalar* row = probabilities.data() + i * probabilities.cols();
+        correct += std::max_element(row, row + probabilities.cols()) - row == static_cast<Index>(labels(i, 0));
+    }
+    return static_cast<double>(correct) / static_cast<double>(probabilities.rows());
+}
+
+double probe_loss(NeuralLayer& layer, const Matrix& input, const Matrix& probe) {
+    const Matrix output = layer.forward(input);
+    double loss = 0.0;
+    for (Index i = 0; i < output.size(); ++i) loss += static_cast<double>(output.data()[i]) * probe.data()[i];
+    return loss;
+}
+
+// Central differences of sum(forward(input) .* probe) against backward(probe), for
+// the input and every parameter; the largest difference relative to the largest
+// analytic gradient
+double gradient_check_error(NeuralLayer& layer, Matrix input) {
+    const Matrix output = layer.forward(input);
+    const Matrix probe = random_matrix(output.rows(), output.cols(), 21);
+    layer.zero_gradients();
+    const Matrix input_gradient = layer.backward(probe);
+    std::vector<ParameterView> parameters;
+    layer.collect_parameters(parameters);
+    // Forward passes below may reuse the gradient buffers' neighbours; copy first
+    std::vector<std::vector<double>> analytic;
+    for (const auto& view : parameters) analytic.emplace_back(view.gradients, view.gradients + view.size);
+
+    const double h = kFloatStorage ? 1e-2 : 1e-5;
+    auto numeric = [&](Scalar& value) {
+        const Scalar saved = value;
+        value = static_cast<Scalar>(saved + h);
+        const double up = probe_loss(layer, input, probe);
+        value = static_cast<Scalar>(saved - h);
+        const double down = probe_loss(layer, input, probe);
+        value = saved;
+        return (up - down) / (2.0 * h);
+    };
+    double worst = 0.0;
+    double scale = 0.0;
+    for (Index i = 0; i < input.size(); ++i) {
+        worst = std::max(worst, std::abs(numeric(input.data()[i]) - input_gradient.data()[i]));
+        scale = std::max(scale, std::abs(static_cast<double>(input_gradient.data()[i])));
+    }
+    for (size_t p = 0; p < parameters.size(); ++p) {
+        for (size_t i = 0; i < parameters[p].size; ++i) {
+            worst = std::max(worst, std::abs(numeric(parameters[p].values[i]) - analytic[p][i]));
+            scale = std::max(scale, std::abs(analytic[p][i]));
+        }
+    }
+    return worst / std::max(scale, 1e-300);
+}
+
+// Every parameter uniform in [-scale, scale], biases included, so no term is zero
+void randomize_parameters(NeuralLayer& layer, double scale, uint64_t seed) {
+    std::vector<ParameterView> parameters;
+    layer.collect_parameters(parameters);
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(-scale, scale);
+    for (const auto& view : parameters) {
+        for (size_t i = 0; i < view.size; ++i) view.values[i] = static_cast<Scalar>(dist(rng));
+    }
+}
+
+// Direct convolution in double: NHWC samples, weights out_channels x (kh, kw, c)
+Matrix naive_convolution(const Matrix& input, const Matrix& weights, const Vector& biases, int channels,
+                         int height, int width, int kernel, int stride, int padding) {
+    const int out_h = (height + 2 * padding - kernel) / stride + 1;
+    const int out_w = (width + 2 * padding - kernel) / stride + 1;
+    const int filters = static_cast<int>(weights.rows());
+    Matrix output(input.rows(), static_cast<Index>(out_h) * out_w * filters);
+    for (Index s = 0; s < input.rows(); ++s) {
+        for (int oy = 0; oy < out_h; ++oy) {
+            for (int ox = 0; ox < out_w; ++ox) {
+                for (int o = 0; o < filters; ++o) {
+                    double sum = biases[o];
+                    for (int ky = 0; ky < kernel; ++ky) {
+                        for (int kx = 0; kx < kernel; ++kx) {
+                            const int y = oy * stride - padding + ky;
+                            const int x = ox * stride - padding + kx;
+                            if (y < 0 || y >= height || x < 0 || x >= width) continue;
+                            for (int c = 0; c < channels; ++c) {
+                                sum += static_cast<double>(input(s, (y * width + x) * channels + c)) *
+                                       weights(o, (ky * kernel + kx) * channels + c);
+                            }
+                        }
+                    }
+                    output(s, (oy * out_w + ox) * filters + o) = static_cast<Scalar>(sum);
+                }
+            }
+        }
+    }
+    return output;
+}
+
+Matrix parameter_matrix(NeuralLayer& layer, size_t index, Index rows, Index cols) {
+    std::vector<ParameterView> parameters;
+    layer.collect_parameters(parameters);
+    Matrix values(rows, cols);
+    std::copy_n(parameters[index].values, parameters[index].size, values.data());
+    return values;
+}
+
+std::vector<char> read_bytes(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_bytes(const std::string& path, const std::vector<char>& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// One step of each optimizer in double, written from the published update rules
+struct ReferenceOptimizer {
+    OptimizerType type;
+    double lr, momentum, rho, beta1, beta2, epsilon, weight_decay;
+    bool nesterov;
+    std::vector<double> first, second;
+    long long t = 0;
+
+    void step(std::vector<double>& p, const std::vector<double>& g, bool decay) {
+        if (first.empty()) {
+            first.assign(p.size(), 0.0);
+            second.assign(p.size(), 0.0);
+        }
+        ++t;
+        const double wd = decay ? weight_decay : 0.0;
+        for (size_t i = 0; i < p.size(); ++i) {
+            const double grad = type == OptimizerType::ADAMW ? g[i] : g[i] + wd * p[i];
+            switch (type) {
+                case OptimizerType::SGD:
+                    p[i] -= lr * grad;
+                    break;
+                case OptimizerType::MOMENTUM:
+                    first[i] = momentum * first[i] + grad;
+                    p[i] -= lr * (nesterov ? grad + momentum * first[i] : first[i]);
+                    break;
+                case OptimizerType::RMSPROP:
+                    second[i] = rho * second[i] + (1.0 - rho) * grad * grad;
+                    p[i] -= lr * grad / (std::sqrt(second[i]) + epsilon);
+                    break;
+                case OptimizerType::ADAM:
+                case OptimizerType::ADAMW: {
+                    if (type == OptimizerType::ADAMW) p[i] *= 1.0 - lr * wd;
+                    first[i] = beta1 * first[i] + (1.0 - beta1) * grad;
+                    second[i] = beta2 * second[i] + (1.0 - beta2) * grad * grad;
+                    const double m_hat = first[i] / (1.0 - std::pow(beta1, static_cast<double>(t)));
+                    const double v_hat = second[i] / (1.0 - std::pow(beta2, static_cast<double>(t)));
+                    p[i] -= lr * m_hat / (std::sqrt(v_hat) + epsilon);
+                    break;
+                }
+            }
+        }
+    }
+};
+
+template <typename T>
+std::vector<char> patched(std::vector<char> bytes, size_t offset, T value) {
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+    return bytes;
+}
+
+} // namespace
+
+int main() {
+    TestSuite suite("neural");
+
+    suite.add_test("dense_after_dropout_keeps_width", []() {
+        auto network = dropout_network();
+        const Matrix output = network->predict(random_matrix(10, 16));
+        TestSuite::assert_true(output.rows() == 10 && output.cols() == 3, "predict returned the wrong shape");
+        // A DropoutLayer built without a width is skipped when sizing the next layer
+        NeuralNetwork manual(0.01, 32);
+        manual.add_layer(std::make_unique<DenseLayer>(16, 8, ActivationType::RELU));
+        manual.add_layer(std::make_unique<DropoutLayer>(0.5));
+        manual.add_dense_layer(2, ActivationType::LINEAR);
+        const Matrix manual_output = manual.predict(random_matrix(4, 16));
+        TestSuite::assert_true(manual_output.rows() == 4 && manual_output.cols() == 2, "manual dropout broke sizing");
+    });
+
+    suite.add_test("inference_restores_training_mode", []() {
+        auto network = dropout_network();
+        const Matrix X = random_matrix(20, 16, 1);
+        const Matrix y = random_matrix(20, 3, 2);
+        network->set_training(false);
+        network->predict(X);
+        TestSuite::assert_true(!network->is_training(), "predict switched the network to training");
+        network->evaluate(X, y);
+        TestSuite::assert_true(!network->is_training(), "evaluate switched the network to training");
+        network->set_training(true);
+        network->predict(X);
+        network->evaluate(X, y);
+        TestSuite::assert_true(network->is_training(), "inference left training mode off");
+    });
+
+    suite.add_test("inference_skips_dropout", []() {
+        auto network = dropout_network();
+        const Matrix X = random_matrix(20, 16, 3);
+        const Matrix first = network->predict(X);
+        expect_below(max_abs_diff(first, network->predict(X)), 0.0, "repeated predict");
+    });
+
+    // Built only through add_*_layer(), first layer without an input size: fit() has
+    // to size it and every dense layer must start from random weights
+    suite.add_test("added_layers_learn", []() {
+        utils::set_global_seed(kTestSeed);
+        Matrix X, labels;
+        make_clusters(300, X, labels);
+        for (const char* optimizer : {"sgd", "adam"}) {
+            NeuralNetwork network(optimizer == std::string("sgd") ? 0.5 : 0.05, 32);
+            network.set_seed(kTestSeed);
+            network.add_dense_layer(16, ActivationType::RELU);
+            network.add_dense_layer(3, ActivationType::LINEAR);
+            network.add_softmax_cross_entropy_layer();
+            TestSuite::assert_true(network.set_optimizer(optimizer), "unknown optimizer");
+            network.fit(X, labels, 30);
+            const double loss = network.evaluate(X, labels);
+            expect_below(loss, 0.2, std::string(optimizer) + " loss (ln 3 = 1.0986 means no learning)");
+            expect_below(0.95, accuracy(network.predict(X), labels), std::string(optimizer) + " accuracy");
+        }
+    });
+
+    suite.add_test("factory_network_learns", []() {
+        utils::set_global_seed(kTestSeed);
+        const Matrix X = random_matrix(400, 6, 4);
+        Matrix y(400, 1);
+        double mean = 0.0;
+        for (Index i = 0; i < 400; ++i) {
+            y(i, 0) = static_cast<Scalar>(1.0 + X(i, 0) - 0.5 * X(i, 3));
+            mean += y(i, 0) / 400.0;
+        }
+        double variance = 0.0;
+        for (Index i = 0; i < 400; ++i) variance += (y(i, 0) - mean) * (y(i, 0) - mean) / 400.0;
+        auto network = ModelFactory::create_neural_network({16, 1}, 0.05);
+        network->set_seed(kTestSeed);
+        network->set_optimizer("adam");
+        network->fit(X, y, 60);
+        // From predict() itself: a network that cannot run returns an empty matrix
+        const Matrix predictions = network->predict(X);
+        TestSuite::assert_true(predictions.rows() == 400 && predictions.cols() == 1, "predict returned the wrong shape");
+        double mse = 0.0;
+        for (Index i = 0; i < 400; ++i) mse += (predictions(i, 0) - y(i, 0)) * (predictions(i, 0) - y(i, 0)) / 400.0;
+        expect_below(mse, 0.1 * variance, "MSE against the target variance");
+    });
+
+    // Winograd F(2x2,3x3) against im2col and a direct convolution: odd sizes leave
+    // partial 2x2 tiles, and the wide case spans several tile and channel blocks
+    suite.add_test("winograd_matches_im2col", []() {
+        struct Case { int channels, filters, height, width, padding; };
+        for (const Case& c : {Case{5, 7, 13, 11, 1}, Case{5, 7, 13, 11, 0}, Case{16, 40, 20, 20, 1}}) {
+            utils::set_global_seed(kTestSeed);
+            ConvLayer layer(c.channels, c.filters, c.height, c.width, 3, 3, 1, c.padding, ActivationType::LINEAR);
+            layer.initialize_weights(1.0);
+            TestSuite::assert_true(layer.winograd_applicable(), "3x3 stride 1 should use Winograd");
+            const Matrix input = random_matrix(3, static_cast<Index>(c.height) * c.width * c.channels, 31);
+            const Matrix winograd = layer.forward(input);
+            layer.set_winograd(false);
+            const Matrix im2col = layer.forward(input);
+            const Index patch = 9 * c.channels;
+            Vector biases(c.filters);
+            const Matrix bias_column = parameter_matrix(layer, 1, c.filters, 1);
+            for (int o = 0; o < c.filters; ++o) biases[o] = bias_column(o, 0);
+            const Matrix direct = naive_convolution(input, parameter_matrix(layer, 0, c.filters, patch), biases,
+                                                    c.channels, c.height, c.width, 3, 1, c.padding);
+            const std::string shape = std::to_string(c.channels) + "->" + std::to_string(c.filters) + " pad " +
+                                      std::to_string(c.padding);
+            expect_below(max_abs_diff(im2col, direct), tolerance(1e-13, 1e-5), "im2col vs direct, " + shape);
+            expect_below(max_abs_diff(winograd, im2col), tolerance(1e-13, 1e-5), "Winograd vs im2col, " + shape);
+        }
+    });
+
+    suite.add_test("conv_gradients", []() {
+        utils::set_global_seed(kTestSeed);
+        const double bound = tolerance(1e-9, 1e-3);
+        // Winograd forward, padded
+        ConvLayer winograd(3, 4, 7, 6, 3, 3, 1, 1, ActivationType::TANH);
+        winograd.initialize_weights(1.0);
+        expect_below(gradient_check_error(winograd, random_matrix(2, 7 * 6 * 3, 41)), bound, "3x3 Winograd conv");
+        // im2col forward, strided, non-square kernel footprint from padding
+        ConvLayer strided(3, 5, 9, 8, 3, 3, 2, 1, ActivationType::TANH);
+        strided.initialize_weights(1.0);
+        expect_below(gradient_check_error(strided, random_matrix(2, 9 * 8 * 3, 42)), bound, "3x3 stride 2 conv");
+        auto series = ConvLayer::conv1d(4, 3, 15, 5, 1, 2, ActivationType::TANH);
+        series->initialize_weights(1.0);
+        expect_below(gradient_check_error(*series, random_matrix(3, 15 * 4, 43)), bound, "1D conv");
+    });
+
+    // BPTT through every step: each hidden state or only the last one, a batch large
+    // enough to split across workers
+    suite.add_test("recurrent_gradients", []() {
+        const double bound = tolerance(1e-9, 1e-3);
+        for (bool sequences : {true, false}) {
+            const std::string mode = sequences ? " (sequences)" : " (last state)";
+            LSTMLayer lstm(3, 4, 6, sequences);
+            randomize_parameters(lstm, 0.6, 51);
+            expect_below(gradient_check_error(lstm, random_matrix(5, 6 * 3, 52)), bound, "LSTM" + mode);
+            GRULayer gru(3, 4, 6, sequences);
+            randomize_parameters(gru, 0.6, 53);
+            expect_below(gradient_check_error(gru, random_matrix(5, 6 * 3, 54)), bound, "GRU" + mode);
+        }
+    });
+
+    // A truncation window as long as the sequence cuts nothing
+    suite.add_test("recurrent_truncation", []() {
+        LSTMLayer full(3, 4, 6, true);
+        randomize_parameters(full, 0.6, 55);
+        const Matrix input = random_matrix(5, 6 * 3, 56);
+        const Matrix probe = random_matrix(5, 6 * 4, 57);
+        full.forward(input);
+        const Matrix expected = full.backward(probe);
+        const Matrix expected_recurrent = full.get_recurrent_gradients();
+        full.set_truncation(6);
+        full.forward(input);
+        expect_below(max_abs_diff(full.backward(probe), expected), 0.0, "input gradient with a full window");
+        expect_below(max_abs_diff(full.get_recurrent_gradients(), expected_recurrent), 0.0,
+                     "recurrent gradient with a full window");
+        full.set_truncation(2);
+        full.forward(input);
+        full.backward(probe);
+        TestSuite::assert_true(max_abs_diff(full.get_recurrent_gradients(), expected_recurrent) > 0.0,
+                               "truncation to 2 steps changed nothing");
+    });
+
+    // Folding must not change inference: train so the running statistics and gamma,
+    // beta move away from their initial values, then compare predict() before and after
+    suite.add_test("batch_norm_fold", []() {
+        utils::set_global_seed(kTestSeed);
+        NeuralNetwork network(0.05, 32);
+        network.set_seed(kTestSeed);
+        network.add_layer(std::make_unique<DenseLayer>(8, 16, ActivationType::LINEAR));
+        network.add_batch_norm_layer(ActivationType::RELU);
+        network.add_dense_layer(12, ActivationType::LINEAR);
+        network.add_batch_norm_layer(ActivationType::TANH);
+        network.add_dense_layer(6, ActivationType::RELU);
+        network.add_batch_norm_layer();                     // After RELU: not foldable
+        network.add_dense_layer(3, ActivationType::LINEAR);
+        const Matrix X = random_matrix(256, 8, 61);
+        network.fit(X, random_matrix(256, 3, 62), 5);
+
+        const Matrix reference = network.predict(X);
+        const size_t layers = network.layer_count();
+        TestSuite::assert_true(network.fold_batch_norm() == 2, "expected two foldable batch norms");
+        TestSuite::assert_true(network.layer_count() == layers - 2, "folded batch norms not removed");
+        const Matrix folded = network.predict(X);
+        expect_below(max_abs_diff(folded, reference) / max_abs_diff(reference, Matrix::Zero(256, 3)),
+                     tolerance(1e-14, 1e-5), "folded vs unfolded predict, relative");
+        TestSuite::assert_true(network.fold_batch_norm() == 0, "second fold found more batch norms");
+    });
+
+    suite.add_test("batch_norm_gradients", []() {
+        for (ActivationType activation : {ActivationType::LINEAR, ActivationType::TANH}) {
+            BatchNormLayer layer(5, 0.1, 1e-5, activation);
+            randomize_parameters(layer, 1.0, 63);
+            expect_below(gradient_check_error(layer, random_matrix(7, 5, 64)), tolerance(1e-9, 1e-3),
+                         "batch norm gradient");
+        }
+    });
+
+    // The fused kernels against the textbook update rules in double, over several steps
+    // so the moments matter. The first tensor is large enough to be split across
+    // workers and takes weight decay; the bias-like second one takes none.
+    suite.add_test("optimizer_matches_reference", []() {
+        constexpr size_t kLarge = 40000;
+        constexpr size_t kSmall = 37;
+        constexpr int kSteps = 6;
+        struct Case { const char* name; OptimizerType type; bool nesterov; };
+        const Case cases[] = {
+            {"sgd", OptimizerType::SGD, false},
+            {"momentum", OptimizerType::MOMENTUM, false},
+            {"nesterov", OptimizerType::MOMENTUM, true},
+            {"rmsprop", OptimizerType::RMSPROP, false},
+            {"adam", OptimizerType::ADAM, false},
+            {"adamw", OptimizerType::ADAMW, false},
+        };
+        for (const Case& test_case : cases) {
+            Optimizer optimizer(test_case.type, 0.01);
+            optimizer.set_momentum(0.8, test_case.nesterov);
+            optimizer.set_rho(0.95);
+            optimizer.set_betas(0.85, 0.995);
+            optimizer.set_epsilon(1e-6);
+            optimizer.set_weight_decay(0.05);
+            ReferenceOptimizer large_reference{test_case.type, 0.01, 0.8, 0.95, 0.85, 0.995, 1e-6, 0.05,
+                                               test_case.nesterov, {}, {}};
+            ReferenceOptimizer small_reference = large_reference;
+
+            Matrix large = random_matrix(static_cast<Index>(kLarge), 1, 71);
+            Matrix small = random_matrix(static_cast<Index>(kSmall), 1, 72);
+            std::vector<double> expected_large(large.data(), large.data() + kLarge);
+            std::vector<double> expected_small(small.data(), small.data() + kSmall);
+            for (int step = 0; step < kSteps; ++step) {
+                const Matrix large_gradient = random_matrix(static_cast<Index>(kLarge), 1, 100 + step);
+                const Matrix small_gradient = random_matrix(static_cast<Index>(kSmall), 1, 200 + step);
+                optimizer.step({{large.data(), large_gradient.data(), kLarge, true},
+                                {small.data(), small_gradient.data(), kSmall, false}});
+                large_reference.step(expected_large,
+                                     std::vector<double>(large_gradient.data(), large_gradient.data() + kLarge), true);
+                small_reference.step(expected_small,
+                                     std::vector<double>(small_gradient.data(), small_gradient.data() + kSmall), false);
+            }
+            double worst = 0.0;
+            for (size_t i = 0; i < kLarge; ++i) worst = std::max(worst, std::abs(large.data()[i] - expected_large[i]));
+            for (size_t i = 0; i < kSmall; ++i) worst = std::max(worst, std::abs(small.data()[i] - expected_small[i]));
+            expect_below(worst, tolerance(1e-12, 1e-5), std::string(test_case.name) + " parameters");
+            TestSuite::assert_true(optimizer.get_step_count() == kSteps, "step count");
+        }
+    });
+
+    // The fused p - y gradient against central differences of the fused loss, and the
+    // loss against log-sum-exp in double, for label columns, label vectors and soft
+    // targets. 150 rows span three ragged loss chunks; row 0 is shifted by 100, past
+    // where exp overflows in float.
+    suite.add_test("softmax_cross_entropy_gradient", []() {
+        constexpr Index kRows = 150;
+        constexpr Index kClasses = 7;
+        Matrix logits = random_matrix(kRows, kClasses, 81);
+        for (Index i = 0; i < logits.size(); ++i) logits.data()[i] *= Scalar(4);
+        for (Index j = 0; j < kClasses; ++j) logits(0, j) += Scalar(100);
+        std::vector<int> labels(static_cast<size_t>(kRows));
+        Matrix label_column(kRows, 1);
+        Matrix soft = random_matrix(kRows, kClasses, 82);
+        for (Index r = 0; r < kRows; ++r) {
+            labels[static_cast<size_t>(r)] = static_cast<int>((r * 5 + 3) % kClasses);
+            label_column(r, 0) = static_cast<Scalar>(labels[static_cast<size_t>(r)]);
+            double total = 0.0;
+            for (Index j = 0; j < kClasses; ++j) total += soft(r, j) = std::abs(soft(r, j)) + Scalar(0.1);
+            for (Index j = 0; j < kClasses; ++j) soft(r, j) = static_cast<Scalar>(soft(r, j) / total);
+        }
+
+        SoftmaxCrossEntropyLayer layer(static_cast<int>(kClasses));
+        struct Targets { const char* name; std::function<double(const Matrix&)> loss; const Matrix& y; };
+        Matrix one_hot = Matrix::Zero(kRows, kClasses);
+        for (Index r = 0; r < kRows; ++r) one_hot(r, labels[static_cast<size_t>(r)]) = Scalar(1);
+        const Targets cases[] = {
+            {"label column", [&](const Matrix& z) { return layer.loss(z, label_column); }, one_hot},
+            {"label vector", [&](const Matrix& z) { return layer.loss(z, labels); }, one_hot},
+            {"soft targets", [&](const Matrix& z) { return layer.loss(z, soft); }, soft},
+        };
+        for (const Targets& targets : cases) {
+            double expected_loss = 0.0;
+            for (Index r = 0; r < kRows; ++r) {
+                double max = logits(r, 0);
+                for (Index j = 1; j < kClasses; ++j) max = std::max(max, static_cast<double>(logits(r, j)));
+                double sum = 0.0;
+                for (Index j = 0; j < kClasses; ++j) sum += std::exp(logits(r, j) - max);
+                for (Index j = 0; j < kClasses; ++j) {
+                    expected_loss -= targets.y(r, j) * (logits(r, j) - max - std::log(sum)) / kRows;
+                }
+            }
+            const double loss = targets.loss(logits);
+            expect_near(expected_loss, loss, tolerance(1e-12, 1e-5) * std::abs(expected_loss),
+                        std::string(targets.name) + " loss");
+            const Matrix analytic = layer.get_logit_gradient();
+            TestSuite::assert_true(analytic.rows() == kRows && analytic.cols() == kClasses, "gradient shape");
+
+            const double h = kFloatStorage ? 1e-2 : 1e-5;
+            double worst = 0.0;
+            double scale = 0.0;
+            Matrix z = logits;
+            for (Index i = 0; i < z.size(); ++i) {
+                const Scalar saved = z.data()[i];
+                z.data()[i] = static_cast<Scalar>(saved + h);
+                const double up = targets.loss(z);
+                z.data()[i] = static_cast<Scalar>(saved - h);
+                const double down = targets.loss(z);
+                z.data()[i] = saved;
+                const double numeric = (up - down) / (static_cast<double>(static_cast<Scalar>(saved + h)) -
+                                                      static_cast<Scalar>(saved - h));
+                worst = std::max(worst, std::abs(numeric - analytic.data()[i]));
+                scale = std::max(scale, std::abs(static_cast<double>(analytic.data()[i])));
+            }
+            expect_below(worst / scale, tolerance(1e-7, 1e-4), std::string(targets.name) + " gradient, relative");
+        }
+    });
+
+    // The planned workspace step against the Matrix path (fresh matrices through each
+    // layer's forward() and backward()) from the same initial weights and dropout
+    // streams: every batch loss and the trained predictions must agree. Batches of
+    // 32, then 20, then 48 rows reuse and then outgrow the plan.
+    suite.add_test("workspace_matches_matrix_path", []() {
+        const Matrix X = random_matrix(48, 12, 91);
+        Matrix classes(48, 1);
+        for (Index i = 0; i < 48; ++i) classes(i, 0) = static_cast<Scalar>(i % 3);
+        const Matrix regression = random_matrix(48, 2, 92);
+        auto build = [](bool classifier, bool use_workspace) {
+            utils::set_global_seed(kTestSeed);
+            auto network = std::make_unique<NeuralNetwork>(0.05, 32);
+            network->set_seed(kTestSeed);
+            network->add_layer(std::make_unique<DenseLayer>(12, 24, ActivationType::RELU));
+            if (classifier) {
+                network->add_batch_norm_layer(ActivationType::TANH);
+                network->add_dropout_layer(0.3);
+                network->add_dense_layer(3, ActivationType::LINEAR);
+                network->add_softmax_cross_entropy_layer();
+            } else {
+                network->add_dropout_layer(0.3);
+                network->add_dense_layer(2, ActivationType::LINEAR);
+                network->set_loss_function("mse");
+            }
+            network->set_optimizer("adam");
+            network->set_use_workspace(use_workspace);
+            return network;
+        };
+        for (bool classifier : {true, false}) {
+            const std::string name = classifier ? "classifier" : "regression";
+            const Matrix& y = classifier ? classes : regression;
+            auto planned = build(classifier, true);
+            auto matrices = build(classifier, false);
+            for (Index rows : {32, 32, 20, 48, 48}) {
+                const Matrix batch_x = X.block(0, 0, rows, X.cols());
+                const Matrix batch_y = y.block(0, 0, rows, y.cols());
+                const double planned_loss = planned->train_batch(batch_x, batch_y);
+                const double matrix_loss = matrices->train_batch(batch_x, batch_y);
+                expect_near(matrix_loss, planned_loss, tolerance(1e-12, 1e-5) * std::abs(matrix_loss),
+                            name + " batch loss");
+            }
+            TestSuite::assert_true(planned->workspace_bytes() > 0 && matrices->workspace_bytes() == 0,
+                                   name + " did not take the expected paths");
+            const Matrix expected = matrices->predict(X);
+            expect_below(max_abs_diff(planned->predict(X), expected), tolerance(1e-12, 1e-5), name + " predictions");
+        }
+    });
+
+    // Rounding x and w to int8 with scales s_x and s_w moves each term of x . w by at
+    // most |x| s_w / 2 + |w| s_x / 2 + 3 s_x s_w / 4, so every int8 output must lie
+    // within the sum of those of the fp32 one. 70 rows and 37 outputs leave partial
+    // row blocks and a tail after the four-output kernel; 300 inputs are zero-padded.
+    suite.add_test("int8_dense_error_bound", []() {
+        constexpr Index kIn = 300;
+        constexpr Index kOut = 37;
+        DenseLayer layer(static_cast<int>(kIn), static_cast<int>(kOut), ActivationType::LINEAR);
+        randomize_parameters(layer, 0.5, 93);
+        const Matrix X = random_matrix(70, kIn, 94);
+        const Matrix reference = layer.forward(X);
+        layer.quantize(Scalar(1));
+        layer.set_training(false);
+        const Matrix quantized = layer.forward(X);
+        TestSuite::assert_true(layer.is_quantized() && quantized.rows() == 70 && quantized.cols() == kOut,
+                               "int8 path did not run");
+
+        const Matrix& W = layer.get_weights();
+        const double s_x = 1.0 / 127.0;
+        double largest_error = 0.0;
+        double worst_ratio = 0.0;
+        for (Index j = 0; j < kOut; ++j) {
+            double w_max = 0.0;
+            for (Index k = 0; k < kIn; ++k) w_max = std::max(w_max, std::abs(static_cast<double>(W(j, k))));
+            const double s_w = w_max / 127.0;
+            for (Index r = 0; r < X.rows(); ++r) {
+                double bound = 0.0;
+                for (Index k = 0; k < kIn; ++k) {
+                    bound += std::abs(X(r, k)) * s_w / 2 + std::abs(W(j, k)) * s_x / 2 + 0.75 * s_x * s_w;
+                }
+                const double error = std::abs(static_cast<double>(quantized(r, j)) - reference(r, j));
+                // Float storage adds its own rounding of the ~300-term fp32 sum
+                bound += tolerance(1e-12, 1e-5) * (1.0 + std::abs(static_cast<double>(reference(r, j))));
+                largest_error = std::max(largest_error, error);
+                worst_ratio = std::max(worst_ratio, error / bound);
+            }
+        }
+        expect_below(worst_ratio, 1.0, "int8 error over its bound");
+        TestSuite::assert_true(largest_error > 0.0, "int8 output identical to fp32; quantization not applied");
+
+        layer.dequantize();
+        expect_below(max_abs_diff(layer.forward(X), reference), 0.0, "dequantized output");
+    });
+
+    // End to end on a trained classifier: class probabilities within 0.02 of fp32 and
+    // the same predicted class for at least 99% of rows; dequantize() restores fp32
+    suite.add_test("int8_network_predictions", []() {
+        utils::set_global_seed(kTestSeed);
+        Matrix X, labels;
+        make_clusters(600, X, labels);
+        NeuralNetwork network(0.05, 32);
+        network.set_seed(kTestSeed);
+        network.add_dense_layer(32, ActivationType::RELU);
+        network.add_dense_layer(16, ActivationType::RELU);
+        network.add_dense_layer(3, ActivationType::LINEAR);
+        network.add_softmax_cross_entropy_layer();
+        network.set_optimizer("adam");
+        network.fit(X, labels, 10);
+        const Matrix reference = network.predict(X);
+
+        TestSuite::assert_true(network.quantize(X) == 3, "expected three quantized dense layers");
+        const Matrix quantized = network.predict(X);
+        expect_below(max_abs_diff(quantized, reference), 0.02, "int8 probability error");
+        Index agree = 0;
+        for (Index i = 0; i < X.rows(); ++i) {
+            const Scalar* a = reference.data() + i * 3;
+            const Scalar* b = quantized.data() + i * 3;
+            agree += std::max_element(a, a + 3) - a == std::max_element(b, b + 3) - b;
+        }
+        expect_below(0.99, static_cast<double>(agree) / X.rows(), "int8 top-1 agreement");
+        const QuantizationReport report = network.quantization_report(X, labels);
+        expect_near(report.reference_loss, report.quantized_loss, 0.01, "int8 loss");
+
+        network.dequantize();
+        expect_below(max_abs_diff(network.predict(X), reference), 0.0, "dequantized predictions");
+    });
+
+    // A saved network mapped back in predicts exactly what it did before saving, and
+    // a file with a bad header or missing bytes is refused without touching the network
+    suite.add_test("model_file_round_trip", []() {
+        utils::set_global_seed(kTestSeed);
+        Matrix X, labels;
+        make_clusters(300, X, labels);
+        NeuralNetwork network(0.05, 32);
+        network.set_seed(kTestSeed);
+        network.add_dense_layer(16, ActivationType::RELU);
+        network.add_batch_norm_layer();
+        network.add_dropout_layer(0.2);
+        network.add_dense_layer(3, ActivationType::LINEAR);
+        network.add_softmax_cross_entropy_layer();
+        network.set_optimizer("adam");
+        network.fit(X, labels, 5);
+        const Matrix expected = network.predict(X);
+
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                                ("dds_test_neural_model_" + std::to_string(kTestSeed));
+        std::filesystem::create_directories(directory);
+        const std::string path = (directory / "network.ddsm").string();
+        TestSuite::assert_true(network.save_model(path), "save failed");
+        NeuralNetwork loaded;
+        TestSuite::assert_true(loaded.load_model(path), "load failed");
+        TestSuite::assert_true(loaded.layer_count() == network.layer_count(), "layer count changed");
+        const Matrix actual = loaded.predict(X);
+        TestSuite::assert_true(actual.rows() == expected.rows() && actual.cols() == expected.cols() &&
+                                   std::memcmp(actual.data(), expected.data(), sizeof(Scalar) * expected.size()) == 0,
+                               "loaded predictions differ, max " + format(max_abs_diff(actual, expected)));
+
+        // Field offsets of ModelFileHeader and of the first ModelSection after it
+        const std::vector<char> bytes = read_bytes(path);
+        const size_t first_section = sizeof(ModelFileHeader);
+        const size_t section_offset = first_section + offsetof(ModelSection, offset);
+        uint64_t payload = 0;
+        std::memcpy(&payload, bytes.data() + section_offset, sizeof(payload));
+        // The file ends in at most one alignment unit of padding; cut into the tensors
+        std::vector<char> truncated(bytes.begin(), bytes.end() - 2 * kModelSectionAlignment);
+        const std::vector<std::pair<std::string, std::vector<char>>> corrupt = {
+            {"magic", patched(bytes, 0, 'X')},
+            {"version", patched(bytes, offsetof(ModelFileHeader, version), kModelFormatVersion + 1)},
+            {"scalar width", patched(bytes, offsetof(ModelFileHeader, scalar_bytes),
+                                     static_cast<uint32_t>(kFloatStorage ? sizeof(double) : sizeof(float)))},
+            {"kind", patched(bytes, offsetof(ModelFileHeader, kind), static_cast<uint32_t>(ModelKind::RANDOM_FOREST))},
+            {"section alignment", patched(bytes, section_offset, payload + 8)},
+            {"section past the end", patched(bytes, section_offset, static_cast<uint64_t>(bytes.size() + 64) & ~uint64_t(63))},
+            {"truncated", truncated},
+            {"truncated with its size field", patched(truncated, offsetof(ModelFileHeader, file_size),
+                                                       static_cast<uint64_t>(truncated.size()))},
+            {"truncated header", std::vector<char>(bytes.begin(), bytes.begin() + 16)},
+        };
+        for (const auto& [what, contents] : corrupt) {
+            const std::string bad = (directory / "bad.ddsm").string();
+            write_bytes(bad, contents);
+            TestSuite::assert_true(!loaded.load_model(bad), "loaded a model with a corrupt " + what);
+            const Matrix after = loaded.predict(X);
+            TestSuite::assert_true(std::memcmp(after.data(), expected.data(), sizeof(Scalar) * expected.size()) == 0,
+                                   "failed load of " + what + " changed the network");
+        }
+        std::filesystem::remove_all(directory);
+    });
+
+    return run_tests(suite);
+}
@@ -0,0 +1,144 @@
+#include "test_common.h"
+#include "utils/random.h"
+#include <vector>
+
+using namespace dds;
+using namespace dds::test;
+using testing::TestSuite;
+using utils::Philox4x32;
+using utils::RandomStream;
+
+namespace {
+
+std::string hex(uint32_t word) {
+    char text[11];
+    std::snprintf(text, sizeof(text), "0x%08x", word);
+    return text;
+}
+
+// counter words (c0, c1, c2, c3) and key words (k0, k1) as in the Random123 tables
+void check_known_answer(const uint32_t counter[4], const uint32_t key[2], const uint32_t expected[4]) {
+    const uint64_t lo = (static_cast<uint64_t>(counter[1]) << 32) | counter[0];
+    const uint64_t hi = (static_cast<uint64_t>(counter[3]) << 32) | counter[2];
+    const uint64_t k = (static_cast<uint64_t>(key[1]) << 32) | key[0];
+    uint32_t out[4];
+    Philox4x32::generate(lo, hi, k, out);
+    for (int i = 0; i < 4; ++i) {
+        TestSuite::assert_true(out[i] == expected[i], "word " + std::to_string(i) + ": expected " + hex(expected[i]) +
+                                                          " but got " + hex(out[i]));
+    }
+}
+
+} // namespace
+
+int main() {
+    TestSuite suite("random");
+
+    // Philox4x32-10 known-answer vectors from Random123 (kat_vectors)
+    suite.add_test("philox_known_answers", []() {
+        const uint32_t zero[4] = {0, 0, 0, 0};
+        const uint32_t zero_key[2] = {0, 0};
+        const uint32_t zero_out[4] = {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8};
+        check_known_answer(zero, zero_key, zero_out);
+
+        const uint32_t ones[4] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+        const uint32_t ones_key[2] = {0xffffffff, 0xffffffff};
+        const uint32_t ones_out[4] = {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd};
+        check_known_answer(ones, ones_key, ones_out);
+
+        const uint32_t pi[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+        const uint32_t pi_key[2] = {0xa4093822, 0x299f31d0};
+        const uint32_t pi_out[4] = {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1};
+        check_known_answer(pi, pi_key, pi_out);
+    });
+
+    // The batched path across a partial batch matches one block at a time
+    suite.add_test("philox_batches_match_blocks", []() {
+        const size_t count = 3 * Philox4x32::kBatch + 5;
+        std::vector<uint32_t> batched(4 * count);
+        Philox4x32::generate_blocks(0xfffffffffffffff0ULL, count, 7, 0x1234, batched.data());
+        for (size_t b = 0; b < count; ++b) {
+            uint32_t single[4];
+            Philox4x32::generate(0xfffffffffffffff0ULL + b, 7, 0x1234, single);
+            for (int i = 0; i < 4; ++i) {
+                TestSuite::assert_true(batched[4 * b + i] == single[i], "block " + std::to_string(b) + " differs");
+            }
+        }
+    });
+
+    suite.add_test("stream_positions", []() {
+        RandomStream stream(kTestSeed, 3);
+        std::vector<uint32_t> words(50);
+        for (auto& word : words) word = stream.next_u32();
+        TestSuite::assert_true(stream.position() == 50, "position does not count words");
+        for (uint64_t position : {0, 3, 4, 17, 49}) {
+            stream.seek(position);
+            TestSuite::assert_true(stream.next_u32() == words[position], "seek " + std::to_string(position));
+        }
+        RandomStream same(kTestSeed, 3);
+        TestSuite::assert_true(same.next_u64() == ((static_cast<uint64_t>(words[0]) << 32) | words[1]), "next_u64");
+        // Forks are reproducible and independent of each other and of the parent
+        const uint32_t child = stream.fork(1).next_u32();
+        TestSuite::assert_true(child == RandomStream(kTestSeed, 3).fork(1).next_u32(), "fork not reproducible");
+        TestSuite::assert_true(child != stream.fork(2).next_u32() && child != words[0], "forks overlap");
+    });
+
+    // ctest runs this suite with DDS_NUM_THREADS=4: the parallel fills have to give the
+    // values the scalar draws give from the same position
+    suite.add_test("fills_match_scalar_draws", []() {
+        const size_t n = 100003;
+        RandomStream fill_stream(kTestSeed);
+        std::vector<double> uniforms(n);
+        fill_stream.fill_uniform(uniforms.data(), n);
+        std::vector<uint32_t> indices(n);
+        fill_stream.fill_below(indices.data(), n, 1000u);
+
+        RandomStream scalar(kTestSeed);
+        for (size_t i = 0; i < n; ++i) {
+            if (uniforms[i] != scalar.uniform()) {
+                TestSuite::assert_true(false, "fill_uniform differs at " + std::to_string(i));
+            }
+        }
+        // Each fill starts at the next block boundary
+        scalar.seek((scalar.position() + 3) / 4 * 4);
+        for (size_t i = 0; i < n; ++i) {
+            if (indices[i] != scalar.below(1000u)) {
+                TestSuite::assert_true(false, "fill_below differs at " + std::to_string(i));
+            }
+        }
+        TestSuite::assert_true(fill_stream.position() == (scalar.position() + 3) / 4 * 4, "fills left another position");
+    });
+
+    suite.add_test("bernoulli_bits_match_values", []() {
+        const size_t n = 64 * 300 + 17;
+        std::vector<uint8_t> values(n);
+        RandomStream(kTestSeed, 5).fill_bernoulli(values.data(), n, 0.3);
+        std::vector<uint64_t> bits((n + 63) / 64);
+        RandomStream(kTestSeed, 5).fill_bernoulli_bits(bits.data(), n, 0.3);
+        size_t ones = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const bool bit = (bits[i / 64] >> (i % 64)) & 1;
+            TestSuite::assert_true(bit == (values[i] == 1), "bit " + std::to_string(i) + " differs from the value");
+            ones += bit;
+        }
+        TestSuite::assert_true((bits.back() >> (n % 64)) == 0, "bits past n are set");
+        // Binomial(n, 0.3): 5 standard deviations
+        const double sd = std::sqrt(n * 0.3 * 0.7);
+        expect_near(n * 0.3, static_cast<double>(ones), 5.0 * sd, "ones");
+    });
+
+    suite.add_test("normal_moments", []() {
+        const size_t n = 200000;
+        std::vector<double> samples(n);
+        RandomStream(kTestSeed, 9).fill_normal(samples.data(), n, 2.0, 3.0);
+        double mean = 0.0;
+        for (double x : samples) mean += x / n;
+        double variance = 0.0;
+        for (double x : samples) variance += (x - mean) * (x - mean) / n;
+        // Standard errors: 3 / sqrt(n) for the mean, about 9 sqrt(2 / n) for the variance
+        expect_near(2.0, mean, 5.0 * 3.0 / std::sqrt(n), "mean");
+        expect_near(9.0, variance, 5.0 * 9.0 * std::sqrt(2.0 / n), "variance");
+    });
+
+    return run_tests(suite);
+}
@@ -0,0 +1,290 @@
+#include "test_common.h"
+#include "security/security_auditor.h"
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+using namespace dds;
+using namespace dds::security;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Fresh directory under the system temp path, removed with everything in it
+struct TempDirectory {
+    fs::path path;
+    explicit TempDirectory(const std::string& name)
+        : path(fs::temp_directory_path() / ("dds_test_security_" + name + "_" + std::to_string(kTestSeed))) {
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~TempDirectory() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+};
+
+const std::chrono::system_clock::time_point kEpoch = std::chrono::system_clock::time_point(std::chrono::hours(480000));
+
+// Event i: one of 7 users, one of 5 IPs, a type by i % 3 and one second apart
+SecurityEvent make_event(int i) {
+    static const SecurityEventType types[] = {SecurityEventType::LOGIN_FAILURE, SecurityEventType::DATA_ACCESS,
+                                              SecurityEventType::CONFIGURATION_CHANGE};
+    return SecurityEvent{types[i % 3],
+                         i % 10 == 0 ? SecuritySeverity::HIGH : SecuritySeverity::LOW,
+                         "user" + std::to_string(i % 7),
+                         "10.0.0." + std::to_string(i % 5),
+                         "/resource/" + std::to_string(i),
+                         "event " + std::to_string(i),
+                         "test-agent",
+                         kEpoch + std::chrono::seconds(i),
+                         false};
+}
+
+// Small segments and commit groups, so the tests roll over several segments
+AuditLogConfig small_config(const std::string& directory = "") {
+    AuditLogConfig config;
+    config.directory = directory;
+    config.segment_max_bytes = 2048;
+    config.max_segments = 0;
+    config.staging_stripes = 4;
+    config.group_commit_events = 16;
+    return config;
+}
+
+size_t files_in(const fs::path& directory) {
+    size_t count = 0;
+    for (const auto& entry : fs::directory_iterator(directory)) {
+        (void)entry;
+        ++count;
+    }
+    return count;
+}
+
+// Every index against the events that were appended
+void check_contents(AuditLog& log, int events) {
+    TestSuite::assert_true(log.size() == static_cast<size_t>(events),
+                           "size " + std::to_string(log.size()) + " != " + std::to_string(events));
+    for (int user = 0; user < 7; ++user) {
+        const auto found = log.query_by_user("user" + std::to_string(user));
+        TestSuite::assert_true(found.size() == static_cast<size_t>((events - user + 6) / 7), "user index count");
+        for (const auto& event : found) {
+            TestSuite::assert_true(event.user_id == "user" + std::to_string(user), "user index returned another user");
+        }
+    }
+    TestSuite::assert_true(log.query_by_ip("10.0.0.3").size() == static_cast<size_t>((events - 3 + 4) / 5),
+                           "ip index count");
+    TestSuite::assert_true(log.count_by_type(SecurityEventType::DATA_ACCESS) == static_cast<size_t>((events - 1 + 2) / 3),
+                           "type index count");
+    TestSuite::assert_true(log.count_by_severity(SecuritySeverity::HIGH) == static_cast<size_t>((events + 9) / 10),
+                           "severity index count");
+
+    // Seconds [40, 59]: whole records with their fields intact. Commits are in time
+    // order per group only, so concurrent appends may interleave across groups
+    auto range = log.query_time_range(kEpoch + std::chrono::seconds(40), kEpoch + std::chrono::seconds(59));
+    std::sort(range.begin(), range.end(),
+              [](const SecurityEvent& a, const SecurityEvent& b) { return a.timestamp < b.timestamp; });
+    TestSuite::assert_true(range.size() == 20, "time range returned " + std::to_string(range.size()) + " events");
+    for (size_t i = 0; i < range.size(); ++i) {
+        const SecurityEvent expected = make_event(40 + static_cast<int>(i));
+        TestSuite::assert_true(range[i].timestamp == expected.timestamp && range[i].resource == expected.resource &&
+                                   range[i].description == expected.description &&
+                                   range[i].user_agent == expected.user_agent,
+                               "time range record " + std::to_string(i) + " does not round-trip");
+    }
+    const AuditLogStats stats = log.get_stats();
+    TestSuite::assert_true(stats.segments_skipped > 0, "time range query scanned every segment");
+}
+
+} // namespace
+
+int main() {
+    TestSuite suite("security");
+
+    suite.add_test("auditor_persists_to_its_directory", []() {
+        TempDirectory directory("auditor");
+        {
+            SecurityAuditor auditor(directory.path.string());
+            TestSuite::assert_true(auditor.is_log_open() && auditor.is_enabled(), "auditor log did not open");
+            auditor.set_brute_force_threshold(5);
+            for (int i = 0; i < 6; ++i) auditor.log_login_attempt("mallory", "192.0.2.7", false);
+            auditor.log_login_attempt("alice", "198.51.100.1", true);
+            TestSuite::assert_true(auditor.get_total_events() == 9, "expected 6 failures, 2 brute force alerts, 1 success");
+            TestSuite::assert_true(auditor.is_brute_force_attack("192.0.2.7"), "brute force not detected");
+            TestSuite::assert_true(!auditor.is_brute_force_attack("198.51.100.1"), "successful login flagged");
+            TestSuite::assert_true(auditor.get_events_by_type(SecurityEventType::BRUTE_FORCE_ATTEMPT).size() == 2,
+                                   "brute force events not logged");
+        }
+        TestSuite::assert_true(files_in(directory.path) > 0, "the auditor wrote no segment files");
+        SecurityAuditor reopened(directory.path.string());
+        TestSuite::assert_true(reopened.get_total_events() == 9, "events not recovered from the directory");
+    });
+
+    suite.add_test("auditor_reports_open_failure", []() {
+        TempDirectory directory("blocked");
+        // A regular file where the log directory should be
+        const fs::path blocked = directory.path / "not_a_directory";
+        std::fclose(std::fopen(blocked.string().c_str(), "w"));
+        SecurityAuditor auditor(blocked.string());
+        TestSuite::assert_true(!auditor.is_log_open(), "log opened over a regular file");
+        TestSuite::assert_true(!auditor.is_enabled(), "auditing left enabled without a log");
+        auditor.log_login_attempt("mallory", "192.0.2.7", false);
+        auditor.enable();
+        TestSuite::assert_true(!auditor.is_enabled() && auditor.get_total_events() == 0, "events staged without a log");
+    });
+
+    // Full stripes wake the writer thread; nothing is committed by append() itself
+    suite.add_test("in_memory_writer_commits", []() {
+        AuditLogConfig config = small_config();
+        config.group_commit_interval = std::chrono::milliseconds(1);
+        AuditLog log(config);
+        TestSuite::assert_true(log.open() && log.is_open(), "open failed");
+        for (int i = 0; i < 100; ++i) log.append(make_event(i));
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (log.get_stats().staged_events > 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        const AuditLogStats stats = log.get_stats();
+        TestSuite::assert_true(stats.staged_events == 0 && stats.total_events == 100, "writer did not commit the stripes");
+    });
+
+    suite.add_test("in_memory_log_indexes", []() {
+        AuditLog log(small_config());
+        TestSuite::assert_true(log.open(), "open failed");
+        for (int i = 0; i < 300; ++i) log.append(make_event(i));
+        check_contents(log, 300);
+        TestSuite::assert_true(log.get_stats().segment_count > 3, "events did not roll over segments");
+        TestSuite::assert_true(log.mark_investigated(42), "mark_investigated missed a live record");
+        const auto marked = log.query_time_range(kEpoch + std::chrono::seconds(42), kEpoch + std::chrono::seconds(42));
+        TestSuite::assert_true(marked.size() == 1 && marked[0].investigated, "investigated flag not returned");
+    });
+
+    suite.add_test("concurrent_appends", []() {
+        AuditLog log(small_config());
+        log.open();
+        constexpr int kThreads = 4;
+        constexpr int kPerThread = 250;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&log, t]() {
+                for (int i = t; i < kThreads * kPerThread; i += kThreads) log.append(make_event(i));
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        check_contents(log, kThreads * kPerThread);
+    });
+
+    suite.add_test("retention_bounds_segments", []() {
+        AuditLogConfig config = small_config();
+        config.max_segments = 3;
+        AuditLog log(config);
+        log.open();
+        for (int i = 0; i < 1000; ++i) log.append(make_event(i));
+        log.flush();
+        const AuditLogStats stats = log.get_stats();
+        TestSuite::assert_true(stats.segment_count <= 3, "more segments than max_segments");
+        TestSuite::assert_true(log.size() < 1000 && log.size() > 0, "retention kept every event or none");
+        // The newest events survive retirement
+        TestSuite::assert_true(log.query_by_user(make_event(999).user_id).back().resource == make_event(999).resource,
+                               "newest event retired");
+        TestSuite::assert_true(!log.mark_investigated(0), "retired record still addressable");
+    });
+
+    suite.add_test("persistent_log_recovers", []() {
+        TempDirectory directory("log");
+        const std::string path = directory.path.string();
+        {
+            AuditLog log(small_config(path));
+            TestSuite::assert_true(log.open(), "open failed");
+            for (int i = 0; i < 200; ++i) log.append(make_event(i));
+        }
+        TestSuite::assert_true(files_in(directory.path) > 3, "no segment files written");
+        {
+            AuditLog log(small_config(path));
+            TestSuite::assert_true(log.open(), "reopen failed");
+            check_contents(log, 200);
+            for (int i = 200; i < 300; ++i) log.append(make_event(i));
+        }
+        AuditLog log(small_config(path));
+        log.open();
+        check_contents(log, 300);
+    });
+
+    suite.add_test("torn_tail_drops_last_record", []() {
+        TempDirectory directory("torn");
+        const std::string path = directory.path.string();
+        {
+            AuditLog log(small_config(path));
+            log.open();
+            for (int i = 0; i < 100; ++i) log.append(make_event(i));
+        }
+        // The newest non-empty segment ends with record 99; cut into it
+        fs::path newest;
+        for (const auto& entry : fs::directory_iterator(directory.path)) {
+            if (fs::file_size(entry.path()) > 0 && (newest.empty() || entry.path() > newest)) newest = entry.path();
+        }
+        fs::resize_file(newest, fs::file_size(newest) - 3);
+        AuditLog log(small_config(path));
+        log.open();
+        TestSuite::assert_true(log.size() == 99, "expected 99 records, got " + std::to_string(log.size()));
+        const auto last = log.query_time_range(kEpoch + std::chrono::seconds(98), kEpoch + std::chrono::seconds(99));
+        TestSuite::assert_true(last.size() == 1 && last[0].resource == make_event(98).resource,
+                               "torn record returned or intact record lost");
+    });
+
+    // An unreadable record is skipped without shifting the ids of the ones after it
+    suite.add_test("for_each_pairs_ids_with_events", []() {
+        TempDirectory directory("corrupt");
+        AuditLog log(small_config(directory.path.string()));
+        log.open();
+        for (int i = 0; i < 10; ++i) log.append(make_event(i));
+        log.flush();
+        // Records are a u32 length then the payload, whose first byte is the type
+        const fs::path first = directory.path / "segment_00000000.log";
+        std::FILE* file = std::fopen(first.string().c_str(), "r+b");
+        TestSuite::assert_true(file != nullptr, "first segment missing");
+        long offset = 0;
+        for (int record = 0; record < 4; ++record) {
+            uint32_t length = 0;
+            std::fseek(file, offset, SEEK_SET);
+            TestSuite::assert_true(std::fread(&length, sizeof(length), 1, file) == 1, "short segment");
+            offset += static_cast<long>(sizeof(length) + length);
+        }
+        std::fseek(file, offset + static_cast<long>(sizeof(uint32_t)), SEEK_SET);
+        std::fputc(0xFF, file);
+        std::fclose(file);
+
+        std::vector<uint64_t> ids;
+        log.for_each([&](uint64_t id, const SecurityEvent& event) {
+            TestSuite::assert_true(event.resource == make_event(static_cast<int>(id)).resource,
+                                   "record " + std::to_string(id) + " paired with another event");
+            ids.push_back(id);
+        });
+        TestSuite::assert_true(ids.size() == 9 && std::find(ids.begin(), ids.end(), 4) == ids.end(),
+                               "corrupt record visited or others lost");
+    });
+
+    // Events a failed segment could not take are staged again, not dropped
+    suite.add_test("segment_failure_restages", []() {
+        TempDirectory directory("vanishing");
+        AuditLog log(small_config(directory.path.string()));
+        log.open();
+        fs::remove_all(directory.path);
+        for (int i = 0; i < 300; ++i) log.append(make_event(i));
+        log.flush();
+        TestSuite::assert_true(log.get_stats().staged_events > 0, "events past the failed segment were not restaged");
+        TestSuite::assert_true(log.size() == 300, "events lost when the segment failed to open");
+        fs::create_directories(directory.path);
+        log.flush();
+        const AuditLogStats stats = log.get_stats();
+        TestSuite::assert_true(stats.staged_events == 0 && stats.total_events == 300, "restaged events not committed");
+        const auto last = log.query_time_range(kEpoch + std::chrono::seconds(299), kEpoch + std::chrono::seconds(299));
+        TestSuite::assert_true(last.size() == 1 && last[0].resource == make_event(299).resource, "newest event unreadable");
+    });
+
+    return run_tests(suite);
+}
@@ -0,0 +1,213 @@
+#include "test_common.h"
+#include "security/threat_scorer.h"
+#include "utils/sketches.h"
+#include <unordered_map>
+#include <vector>
+
+using namespace dds;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+// Zipf-like stream: key i drawn with weight 1 / (i + 1), so a few keys are heavy
+// and most are rare, the shape the scorer sees from source addresses
+std::vector<std::string> skewed_stream(size_t length, size_t keys, uint64_t seed) {
+    std::vector<double> weights(keys);
+    for (size_t i = 0; i < keys; ++i) weights[i] = 1.0 / static_cast<double>(i + 1);
+    std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+    std::mt19937_64 rng(seed);
+    std::vector<std::string> stream(length);
+    for (auto& key : stream) key = "10." + std::to_string(pick(rng));
+    return stream;
+}
+
+std::unordered_map<std::string, uint64_t> exact_counts(const std::vector<std::string>& stream) {
+    std::unordered_map<std::string, uint64_t> counts;
+    for (const auto& key : stream) ++counts[key];
+    return counts;
+}
+
+const std::chrono::system_clock::time_point kStart = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+
+} // namespace
+
+int main() {
+    TestSuite suite("sketches");
+
+    // Count-min: never under, and over by more than e N / width for at most e^-depth
+    // of the keys
+    suite.add_test("count_min_error_bound", []() {
+        const auto stream = skewed_stream(200000, 20000, 1);
+        const auto counts = exact_counts(stream);
+        utils::CountMinSketch sketch(1024, 4);
+        for (const auto& key : stream) sketch.add(key);
+        const double bound = std::exp(1.0) * static_cast<double>(stream.size()) / static_cast<double>(sketch.width());
+        size_t over_bound = 0;
+        for (const auto& [key, count] : counts) {
+            const uint32_t estimate = sketch.estimate(key);
+            TestSuite::assert_true(estimate >= count, "count-min undercounted " + key);
+            over_bound += static_cast<double>(estimate - count) > bound;
+        }
+        const double failure_rate = static_cast<double>(over_bound) / static_cast<double>(counts.size());
+        expect_below(failure_rate, std::exp(-4.0), "share of keys past e N / width");
+        TestSuite::assert_true(sketch.estimate("absent") <= bound, "unseen key estimated past the bound");
+    });
+
+    suite.add_test("windowed_count_min_expires", []() {
+        // 60 s in 6 slices of 10 s; kStart sits on a slice boundary
+        utils::WindowedCountMinSketch sketch(std::chrono::seconds(60), 6, 256, 4);
+        for (int i = 0; i < 40; ++i) sketch.add("burst", kStart + std::chrono::seconds(i % 10));
+        for (int i = 0; i < 25; ++i) sketch.add("later", kStart + std::chrono::seconds(30));
+        TestSuite::assert_true(sketch.estimate("burst", kStart + std::chrono::seconds(59)) == 40, "burst lost inside the window");
+        TestSuite::assert_true(sketch.estimate("burst", kStart + std::chrono::seconds(60)) == 0, "burst outlived the window");
+        TestSuite::assert_true(sketch.estimate("later", kStart + std::chrono::seconds(60)) == 25, "later slice expired early");
+        // Adding into a wrapped slice clears what it held
+        sketch.add("later", kStart + std::chrono::seconds(90));
+        TestSuite::assert_true(sketch.estimate("later", kStart + std::chrono::seconds(90)) == 1, "reused slice kept old counts");
+
+        // The bound holds for the sum of the live slices
+        const auto stream = skewed_stream(60000, 5000, 2);
+        utils::WindowedCountMinSketch windowed(std::chrono::seconds(60), 6, 1024, 4);
+        for (size_t i = 0; i < stream.size(); ++i) {
+            windowed.add(stream[i], kStart + std::chrono::milliseconds(i % 60000));
+        }
+        const auto counts = exact_counts(stream);
+        const double bound = std::exp(1.0) * static_cast<double>(stream.size()) / 1024.0;
+        size_t over_bound = 0;
+        for (const auto& [key, count] : counts) {
+            const uint32_t estimate = windowed.estimate(key, kStart + std::chrono::milliseconds(59999));
+            TestSuite::assert_true(estimate >= count, "windowed count-min undercounted " + key);
+            over_bound += static_cast<double>(estimate - count) > bound;
+        }
+        expect_below(static_cast<double>(over_bound) / static_cast<double>(counts.size()), std::exp(-4.0),
+                     "share of keys past e N / width");
+    });
+
+    // Space-Saving with k counters: count - error <= true <= count, every key above
+    // N / k is monitored and the counts sum to N
+    suite.add_test("space_saving_guarantees", []() {
+        const auto stream = skewed_stream(100000, 10000, 3);
+        const auto counts = exact_counts(stream);
+        utils::SpaceSaving<> summary(100);
+        for (const auto& key : stream) summary.offer(key);
+        uint64_t total = 0;
+        for (const auto& entry : summary.top(summary.size())) {
+            const uint64_t truth = counts.at(entry.key);
+            TestSuite::assert_true(entry.count - entry.error <= truth && truth <= entry.count,
+                                   "count bounds do not hold for " + entry.key);
+            total += entry.count;
+        }
+        TestSuite::assert_true(total == stream.size(), "monitored counts do not sum to the stream length");
+        const uint64_t threshold = stream.size() / summary.capacity();
+        expect_below(static_cast<double>(summary.min_count()), static_cast<double>(threshold), "minimum count");
+        for (const auto& [key, count] : counts) {
+            if (count > threshold) TestSuite::assert_true(summary.find(key) != nullptr, "heavy hitter " + key + " dropped");
+        }
+        const auto top = summary.top(3);
+        TestSuite::assert_true(top.size() == 3 && top[0].key == "10.0" && top[1].key == "10.1" && top[2].key == "10.2",
+                               "heaviest keys out of order");
+
+        // Decay halves counts and error bounds together
+        const uint64_t before = summary.find("10.0")->count;
+        summary.decay();
+        TestSuite::assert_true(summary.find("10.0")->count == before / 2, "decay did not halve the count");
+    });
+
+    suite.add_test("cuckoo_filter_membership", []() {
+        utils::CuckooFilter filter(10000);
+        std::vector<std::string> members;
+        for (int i = 0; i < 9500; ++i) {
+            std::string key = "member-" + std::to_string(i);
+            if (filter.insert(key)) members.push_back(std::move(key));
+        }
+        expect_below(9500.0 * 0.99, static_cast<double>(members.size()), "inserts accepted at 95% load");
+        TestSuite::assert_true(filter.size() == members.size(), "size does not match the accepted inserts");
+        for (const auto& key : members) TestSuite::assert_true(filter.contains(key), "false negative for " + key);
+
+        // 16-bit fingerprints, two 4-slot buckets: about 8 / 65536 at full load
+        size_t false_positives = 0;
+        for (int i = 0; i < 200000; ++i) false_positives += filter.contains("absent-" + std::to_string(i));
+        expect_below(static_cast<double>(false_positives) / 200000.0, 2.0 * 8.0 / 65536.0, "false positive rate");
+
+        for (size_t i = 0; i < members.size(); i += 2) TestSuite::assert_true(filter.erase(members[i]), "erase failed");
+        for (size_t i = 1; i < members.size(); i += 2) {
+            TestSuite::assert_true(filter.contains(members[i]), "erase removed a neighbour of " + members[i]);
+        }
+    });
+
+    suite.add_test("ip_blocklist_ranges", []() {
+        utils::IpBlocklist blocklist(1024);
+        TestSuite::assert_true(blocklist.block("10.1.2.3/8"), "host bits in a range rejected");
+        blocklist.block("192.168.1.0/24");
+        blocklist.block("203.0.113.5");
+        blocklist.block("2001:db8::1");
+        TestSuite::assert_true(blocklist.range_count() == 2 && blocklist.address_count() == 2, "wrong entry counts");
+        TestSuite::assert_true(blocklist.is_blocked("10.0.0.0") && blocklist.is_blocked("10.255.255.255"), "/8 edges");
+        TestSuite::assert_true(!blocklist.is_blocked("9.255.255.255") && !blocklist.is_blocked("11.0.0.0"), "outside /8");
+        TestSuite::assert_true(blocklist.is_blocked("192.168.1.0") && blocklist.is_blocked("192.168.1.255"), "/24 edges");
+        TestSuite::assert_true(!blocklist.is_blocked("192.168.0.255") && !blocklist.is_blocked("192.168.2.0"), "outside /24");
+        TestSuite::assert_true(blocklist.is_blocked("203.0.113.5") && !blocklist.is_blocked("203.0.113.6"), "single address");
+        TestSuite::assert_true(blocklist.is_blocked("2001:db8::1"), "non-IPv4 address");
+        TestSuite::assert_true(!blocklist.is_blocked("not an address"), "garbage blocked");
+
+        TestSuite::assert_true(blocklist.unblock("10.0.0.0/8") && !blocklist.is_blocked("10.1.2.3"), "unblock range");
+        TestSuite::assert_true(blocklist.unblock("203.0.113.5") && !blocklist.is_blocked("203.0.113.5"), "unblock address");
+        blocklist.block("0.0.0.0/0");
+        TestSuite::assert_true(blocklist.is_blocked("8.8.8.8"), "/0 did not cover everything");
+    });
+
+    // Single addresses are exact: no false positives, and unblock() only removes
+    // what was blocked
+    suite.add_test("ip_blocklist_addresses_exact", []() {
+        utils::IpBlocklist blocklist(1000);
+        for (int i = 0; i < 1000; ++i) {
+            TestSuite::assert_true(blocklist.block("10." + std::to_string(i / 256) + "." + std::to_string(i % 256) + ".1"),
+                                   "block rejected below capacity");
+        }
+        TestSuite::assert_true(!blocklist.block("192.0.2.1"), "block accepted past capacity");
+        TestSuite::assert_true(blocklist.block("10.0.0.1"), "re-blocking a blocked address failed at capacity");
+        for (int i = 0; i < 65536; ++i) {
+            const std::string other = "172.16." + std::to_string(i / 256) + "." + std::to_string(i % 256);
+            TestSuite::assert_true(!blocklist.is_blocked(other), "false positive for " + other);
+            TestSuite::assert_true(!blocklist.unblock(other), "unblocked an address that was never blocked");
+        }
+        TestSuite::assert_true(blocklist.address_count() == 1000, "unblocking absent addresses removed entries");
+        for (int i = 0; i < 1000; ++i) {
+            TestSuite::assert_true(blocklist.is_blocked("10." + std::to_string(i / 256) + "." + std::to_string(i % 256) + ".1"),
+                                   "blocked address lost");
+        }
+        TestSuite::assert_true(blocklist.unblock("10.0.0.1") && !blocklist.is_blocked("10.0.0.1") &&
+                                   blocklist.is_blocked("10.0.1.1"), "unblock removed the wrong address");
+        TestSuite::assert_true(!blocklist.unblock("10.0.0.1"), "unblocked the same address twice");
+    });
+
+    suite.add_test("threat_scorer_window", []() {
+        security::ThreatScorerConfig config;
+        config.window = std::chrono::seconds(60);
+        config.window_slices = 6;
+        security::ThreatScorer scorer(config);
+        const auto now = std::chrono::system_clock::now();
+        // Failures from two windows ago are not counted
+        for (int i = 0; i < 9; ++i) scorer.record_login_failure("198.51.100.9", now - std::chrono::minutes(2));
+        for (int i = 0; i < 7; ++i) scorer.record_login_failure("192.0.2.1", now);
+        for (int i = 0; i < 3; ++i) scorer.record_login_failure("192.0.2.2", now);
+        TestSuite::assert_true(scorer.login_failures("192.0.2.1") == 7, "failures in the window");
+        TestSuite::assert_true(scorer.login_failures("198.51.100.9") == 0, "expired failures counted");
+        const auto failing = scorer.top_login_failures(5);
+        TestSuite::assert_true(failing.size() == 2 && failing[0].first == "192.0.2.1" && failing[1].second == 3,
+                               "top failing sources wrong");
+
+        // Risk is severity weighted (HIGH = 7) and capped at 100
+        security::SecurityEvent event{security::SecurityEventType::UNAUTHORIZED_ACCESS, security::SecuritySeverity::HIGH,
+                                      "mallory", "192.0.2.1", "", "", "", now, false};
+        for (int i = 0; i < 3; ++i) scorer.record_event(event);
+        TestSuite::assert_true(scorer.risk_score("192.0.2.1") == 21, "risk is not the weighted sum");
+        for (int i = 0; i < 20; ++i) scorer.record_event(event);
+        TestSuite::assert_true(scorer.risk_score("192.0.2.1") == 100, "risk not capped");
+        const auto threat = scorer.assess("192.0.2.1");
+        TestSuite::assert_true(threat.event_count == 23 && threat.event_pattern.size() == 1, "assessment counts");
+    });
+
+    return run_tests(suite);
+}
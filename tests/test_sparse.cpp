@@ -0,0 +1,188 @@
+#include "test_common.h"
+#include "algorithms/advanced_algorithms.h"
+#include <random>
+#include <vector>
+
+using namespace dds;
+using namespace dds::algorithms;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+// Large enough that the products split across the pool's workers
+constexpr Index kRows = 311;
+constexpr Index kCols = 157;
+constexpr Index kRhsCols = 33;
+
+// About 5% nonzeros, with rows 0 and kRows - 1 and columns 0, 40 and kCols - 1
+// left empty so the offset runs of every kernel see zero-length vectors
+Matrix sparse_dense(Index rows, Index cols, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+    std::bernoulli_distribution keep(0.05);
+    Matrix a = Matrix::Zero(rows, cols);
+    for (Index i = 1; i + 1 < rows; ++i) {
+        for (Index j = 1; j + 1 < cols; ++j) {
+            if (j != 40 && keep(rng)) a(i, j) = static_cast<Scalar>(value(rng));
+        }
+    }
+    return a;
+}
+
+Matrix column(const Vector& v) {
+    Matrix m(v.size(), 1);
+    for (Index i = 0; i < v.size(); ++i) m(i, 0) = v[i];
+    return m;
+}
+
+// Every outer vector strictly increasing in its inner indices
+template<typename Sparse>
+bool inner_sorted(const Sparse& s) {
+    for (Index o = 0; o < s.outerSize(); ++o) {
+        for (Index p = s.outerIndexPtr()[o] + 1; p < s.outerIndexPtr()[o + 1]; ++p) {
+            if (s.innerIndexPtr()[p] <= s.innerIndexPtr()[p - 1]) return false;
+        }
+    }
+    return true;
+}
+
+const double kProductTolerance = tolerance(1e-12, 1e-4);
+
+} // namespace
+
+int main() {
+    TestSuite suite("sparse");
+
+    suite.add_test("spmv", []() {
+        const Matrix a = sparse_dense(kRows, kCols, 1);
+        const Matrix x_column = random_matrix(kCols, 1, 2);
+        Vector x(kCols);
+        for (Index i = 0; i < kCols; ++i) x[i] = x_column(i, 0);
+        const Matrix expected = naive_product(a, x_column);
+        const SparseMatrixCSR csr = SparseMatrixCSR::fromDense(a);
+        const SparseMatrixCSC csc = SparseMatrixCSC::fromDense(a);
+        expect_below(max_abs_diff(column(csr * x), expected), kProductTolerance, "CSR * x");
+        expect_below(max_abs_diff(column(csc * x), expected), kProductTolerance, "CSC * x");
+        expect_below(max_abs_diff(csr * x_column, expected), kProductTolerance, "CSR * one column");
+    });
+
+    suite.add_test("spmm", []() {
+        const Matrix a = sparse_dense(kRows, kCols, 3);
+        const SparseMatrixCSR csr = SparseMatrixCSR::fromDense(a);
+        const SparseMatrixCSC csc = SparseMatrixCSC::fromDense(a);
+        const Matrix b = random_matrix(kCols, kRhsCols, 4);
+        const Matrix expected = naive_product(a, b);
+        expect_below(max_abs_diff(csr * b, expected), kProductTolerance, "CSR * B");
+        expect_below(max_abs_diff(csc * b, expected), kProductTolerance, "CSC * B");
+
+        // A^T * G and A * W^T as the dense layer uses them
+        const Matrix g = random_matrix(kRows, kRhsCols, 5);
+        const Matrix expected_tn = naive_product(transposed(a), g);
+        expect_below(max_abs_diff(csr.transposeMultiply(g), expected_tn), kProductTolerance, "CSR^T * G");
+        expect_below(max_abs_diff(csc.transposeMultiply(g), expected_tn), kProductTolerance, "CSC^T * G");
+        const Matrix w = random_matrix(kRhsCols, kCols, 6);
+        const Matrix expected_nt = naive_product(a, transposed(w));
+        expect_below(max_abs_diff(csr.multiplyTransposed(w), expected_nt), kProductTolerance, "CSR * W^T");
+        expect_below(max_abs_diff(csc.multiplyTransposed(w), expected_nt), kProductTolerance, "CSC * W^T");
+
+        // Dense on the left, plain and transposed in place
+        const Matrix d = random_matrix(kRhsCols, kRows, 7);
+        const Matrix expected_dense = naive_product(d, a);
+        expect_below(max_abs_diff(d * csr, expected_dense), kProductTolerance, "D * CSR");
+        expect_below(max_abs_diff(d * csc, expected_dense), kProductTolerance, "D * CSC");
+        expect_below(max_abs_diff(g.transpose() * csr, transposed(expected_tn)), kProductTolerance, "G^T * CSR");
+        expect_below(max_abs_diff(g.transpose() * csc, transposed(expected_tn)), kProductTolerance, "G^T * CSC");
+    });
+
+    suite.add_test("csr_csc_conversion", []() {
+        const Matrix a = sparse_dense(kRows, kCols, 8);
+        const SparseMatrixCSR csr = SparseMatrixCSR::fromDense(a);
+        const SparseMatrixCSC csc(csr);
+        const SparseMatrixCSR back(csc);
+        TestSuite::assert_true(csc.nonZeros() == csr.nonZeros() && back.nonZeros() == csr.nonZeros(), "nnz changed");
+        TestSuite::assert_true(inner_sorted(csc) && inner_sorted(back), "inner indices out of order");
+        expect_below(max_abs_diff(csc.toDense(), a), 0.0, "CSR -> CSC");
+        expect_below(max_abs_diff(back.toDense(), a), 0.0, "CSR -> CSC -> CSR");
+        for (Index o = 0; o <= kRows; ++o) {
+            TestSuite::assert_true(back.outerIndexPtr()[o] == csr.outerIndexPtr()[o], "row offsets changed");
+        }
+        // The empty rows and columns keep zero-length runs
+        TestSuite::assert_true(csr.outerIndexPtr()[1] == 0 && csc.outerIndexPtr()[1] == 0, "first vector not empty");
+        TestSuite::assert_true(csc.outerIndexPtr()[41] == csc.outerIndexPtr()[40], "column 40 not empty");
+        expect_below(max_abs_diff(csr.transpose().toDense(), transposed(a)), 0.0, "transpose");
+    });
+
+    suite.add_test("triplets_merge_duplicates", []() {
+        const Matrix a = sparse_dense(kRows, kCols, 9);
+        // Each entry split into two parts and the whole list shuffled, plus cancelling
+        // pairs at positions that are zero in a
+        std::vector<Triplet> triplets;
+        Matrix expected = a;
+        for (Index i = 0; i < kRows; ++i) {
+            for (Index j = 0; j < kCols; ++j) {
+                if (a(i, j) == Scalar(0)) continue;
+                triplets.emplace_back(i, j, a(i, j) * Scalar(0.25));
+                triplets.emplace_back(i, j, a(i, j) - a(i, j) * Scalar(0.25));
+                expected(i, j) = a(i, j) * Scalar(0.25) + (a(i, j) - a(i, j) * Scalar(0.25));
+            }
+        }
+        triplets.emplace_back(5, 40, Scalar(1));
+        triplets.emplace_back(5, 40, Scalar(-1));
+        std::mt19937_64 rng(kTestSeed);
+        std::shuffle(triplets.begin(), triplets.end(), rng);
+
+        SparseMatrixCSR csr(kRows, kCols);
+        csr.setFromTriplets(triplets.begin(), triplets.end());
+        SparseMatrixCSC csc(kRows, kCols);
+        csc.setFromTriplets(triplets.begin(), triplets.end());
+        // One stored entry per distinct position; the cancelled pair stays as an explicit zero
+        const Index distinct = SparseMatrixCSR::fromDense(a).nonZeros() + 1;
+        TestSuite::assert_true(csr.nonZeros() == distinct, "CSR nnz " + std::to_string(csr.nonZeros()));
+        TestSuite::assert_true(csc.nonZeros() == distinct, "CSC nnz " + std::to_string(csc.nonZeros()));
+        TestSuite::assert_true(inner_sorted(csr) && inner_sorted(csc), "inner indices out of order");
+        expect_below(max_abs_diff(csr.toDense(), expected), 0.0, "CSR from triplets");
+        expect_below(max_abs_diff(csc.toDense(), expected), 0.0, "CSC from triplets");
+        for (Index i = 0; i < kRows; i += 7) {
+            for (Index j = 0; j < kCols; j += 3) {
+                TestSuite::assert_true(csr.coeff(i, j) == expected(i, j) && csc.coeff(i, j) == expected(i, j),
+                                       "coeff(" + std::to_string(i) + ", " + std::to_string(j) + ")");
+            }
+        }
+    });
+
+    suite.add_test("empty_matrix_products", []() {
+        const SparseMatrixCSR empty(kRows, kCols);
+        const Matrix product = empty * random_matrix(kCols, kRhsCols, 10);
+        expect_below(max_abs_diff(product, Matrix::Zero(kRows, kRhsCols)), 0.0, "empty * B");
+        const SparseMatrixCSC no_rows = SparseMatrixCSC::fromDense(Matrix::Zero(0, kCols));
+        TestSuite::assert_true((no_rows * random_matrix(kCols, 2, 11)).rows() == 0, "0-row product");
+    });
+
+    // A CSR batch through a dense layer gives what its densified copy gives, for the
+    // activations and for the weight and bias gradients of the following backward
+    suite.add_test("dense_layer_sparse_input", []() {
+        const Matrix x = sparse_dense(kRows, kCols, 12);
+        const SparseMatrixCSR x_sparse = SparseMatrixCSR::fromDense(x);
+        const Matrix gradient = random_matrix(kRows, kRhsCols, 13);
+        for (ActivationType activation : {ActivationType::RELU, ActivationType::TANH, ActivationType::LINEAR}) {
+            DenseLayer dense_path(kCols, kRhsCols, activation);
+            dense_path.initialize_weights(0.5);
+            DenseLayer sparse_path = dense_path;
+            const Matrix expected = dense_path.forward(x);
+            const Matrix actual = sparse_path.forward(x_sparse);
+            expect_below(max_abs_diff(actual, expected), kProductTolerance, "forward");
+
+            dense_path.backward(gradient);
+            const Matrix input_gradient = sparse_path.backward(gradient);
+            TestSuite::assert_true(input_gradient.size() == 0, "sparse input got a gradient");
+            expect_below(max_abs_diff(sparse_path.get_gradients(), dense_path.get_gradients()),
+                         kProductTolerance, "weight gradients");
+            expect_below(max_abs_diff(column(sparse_path.get_bias_gradients()),
+                                      column(dense_path.get_bias_gradients())),
+                         kProductTolerance, "bias gradients");
+        }
+    });
+
+    return run_tests(suite);
+}
@@ -0,0 +1,210 @@
+#include "test_common.h"
+#include "storage/hadoop_storage.h"
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace dds;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// The stub keeps files under ./hdfs_stub, so each test runs in a scratch directory
+struct ScratchDirectory {
+    fs::path path;
+    fs::path previous;
+    explicit ScratchDirectory(const std::string& name)
+        : path(fs::temp_directory_path() / ("dds_test_storage_" + name + "_" + std::to_string(kTestSeed))),
+          previous(fs::current_path()) {
+        fs::remove_all(path);
+        fs::create_directories(path);
+        fs::current_path(path);
+    }
+    ~ScratchDirectory() {
+        std::error_code ec;
+        fs::current_path(previous, ec);
+        fs::remove_all(path, ec);
+    }
+};
+
+// Byte offsets in the dataset formats: rows and cols in the header, then the
+// sparse nnz and the row offsets that follow it
+constexpr size_t kRowsOffset = 8;
+constexpr size_t kColsOffset = 16;
+constexpr size_t kSparseOuterOffset = sizeof(storage::BinaryDatasetHeader) + sizeof(uint64_t);
+
+// A copy of src at dst with `value` written over the bytes at offset
+template <typename T>
+void write_patched(storage::HadoopStorage& storage, const std::string& src, const std::string& dst,
+                   size_t offset, T value) {
+    std::vector<char> data;
+    TestSuite::assert_true(storage.read_file(src, data), storage.get_last_error());
+    TestSuite::assert_true(offset + sizeof(value) <= data.size(), "patch past the end of " + src);
+    std::memcpy(data.data() + offset, &value, sizeof(value));
+    TestSuite::assert_true(storage.create_file(dst, data), storage.get_last_error());
+}
+
+void expect_load_error(storage::HadoopStorage& storage, const std::string& path, const std::string& error) {
+    SparseMatrixCSR features;
+    Vector labels;
+    storage.clear_error();
+    TestSuite::assert_true(!storage.load_dataset_sparse(path, features, labels), path + " loaded");
+    TestSuite::assert_true(storage.get_last_error() == error, path + ": " + storage.get_last_error());
+}
+
+} // namespace
+
+int main() {
+    TestSuite suite("storage");
+
+    suite.add_test("binary_dataset_round_trip", []() {
+        ScratchDirectory scratch("round_trip");
+        storage::HadoopStorage storage;
+        TestSuite::assert_true(storage.connect(), "connect failed");
+        const Matrix X = random_matrix(50, 7, 1);
+        const Matrix y_column = random_matrix(50, 1, 2);
+        Vector y(50);
+        for (Index i = 0; i < 50; ++i) y[i] = y_column(i, 0);
+        TestSuite::assert_true(storage.save_dataset_binary("data/part-0", X, y), "save failed");
+        Matrix loaded;
+        Vector labels;
+        TestSuite::assert_true(storage.load_dataset("data/part-0", loaded, labels), storage.get_last_error());
+        expect_below(max_abs_diff(loaded, X), 0.0, "features");
+        TestSuite::assert_true(labels.size() == 50 && labels[49] == y[49], "labels");
+        TestSuite::assert_true(!storage.load_dataset("data/missing", loaded, labels), "loaded a missing file");
+        TestSuite::assert_true(storage.get_last_error() == "File not found: data/missing", storage.get_last_error());
+        storage.clear_error();
+        TestSuite::assert_true(storage.get_last_error().empty(), "clear_error kept the message");
+    });
+
+    // Shard writers share one storage; failures on several threads at once must leave
+    // one whole message, never a torn or freed string
+    suite.add_test("concurrent_errors", []() {
+        ScratchDirectory scratch("errors");
+        auto storage = std::make_shared<storage::HadoopStorage>();
+        storage->connect();
+        constexpr int kThreads = 8;
+        std::vector<std::thread> threads;
+        std::vector<int> torn(kThreads, 0);
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&storage, &torn, t]() {
+                std::string content;
+                for (int i = 0; i < 2000; ++i) {
+                    storage->read_file("missing/shard-" + std::to_string(t) + "-" + std::to_string(i), content);
+                    const std::string error = storage->get_last_error();
+                    // Empty when another thread just cleared it
+                    if (!error.empty() && error.rfind("File not found: missing/shard-", 0) != 0) ++torn[t];
+                    if (i % 100 == 0) storage->clear_error();
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        int total = 0;
+        for (int count : torn) total += count;
+        TestSuite::assert_true(total == 0, std::to_string(total) + " unexpected error messages");
+        const std::string last = storage->get_last_error();
+        TestSuite::assert_true(last.empty() || last.rfind("File not found: missing/shard-", 0) == 0, "torn message: " + last);
+    });
+
+    suite.add_test("sparse_dataset_round_trip", []() {
+        ScratchDirectory scratch("sparse_round_trip");
+        storage::HadoopStorage storage;
+        TestSuite::assert_true(storage.connect(), "connect failed");
+        // Row 1 and column 3 are empty
+        Matrix X = Matrix::Zero(4, 5);
+        X(0, 0) = 1.5; X(0, 2) = -2.0; X(2, 4) = 3.0; X(3, 1) = 0.25; X(3, 2) = 4.0;
+        Vector y = Vector::Zero(4);
+        y[0] = 1; y[2] = 1;
+        TestSuite::assert_true(storage.save_dataset_sparse("data/sparse", SparseMatrixCSR::fromDense(X), y),
+                               storage.get_last_error());
+        SparseMatrixCSR loaded;
+        Vector labels;
+        TestSuite::assert_true(storage.load_dataset_sparse("data/sparse", loaded, labels), storage.get_last_error());
+        TestSuite::assert_true(loaded.nonZeros() == 5, "nnz " + std::to_string(loaded.nonZeros()));
+        expect_below(max_abs_diff(loaded.toDense(), X), 0.0, "features");
+        TestSuite::assert_true(labels.size() == 4 && labels[2] == 1, "labels");
+    });
+
+    // Every count in a sparse file is checked against the bytes present and the
+    // matrix shape before a matrix is built from it
+    suite.add_test("sparse_dataset_rejects_corruption", []() {
+        ScratchDirectory scratch("sparse_corrupt");
+        storage::HadoopStorage storage;
+        TestSuite::assert_true(storage.connect(), "connect failed");
+        Matrix X = Matrix::Zero(4, 5);
+        X(0, 0) = 1.5; X(0, 2) = -2.0; X(2, 4) = 3.0; X(3, 1) = 0.25; X(3, 2) = 4.0;
+        Vector y = Vector::Zero(4);
+        TestSuite::assert_true(storage.save_dataset_sparse("data/sparse", SparseMatrixCSR::fromDense(X), y),
+                               storage.get_last_error());
+        const size_t inner_offset = kSparseOuterOffset + 5 * sizeof(int64_t);
+
+        write_patched(storage, "data/sparse", "bad/rows", kRowsOffset, uint64_t(1) << 62);
+        expect_load_error(storage, "bad/rows", "Truncated sparse dataset");
+        write_patched(storage, "data/sparse", "bad/cols", kColsOffset, uint64_t(1) << 40);
+        expect_load_error(storage, "bad/cols", "Sparse dataset has too many columns");
+        write_patched(storage, "data/sparse", "bad/nnz", sizeof(storage::BinaryDatasetHeader), ~uint64_t(0));
+        expect_load_error(storage, "bad/nnz", "Truncated sparse dataset");
+        // Row 1 would end past the end of the values
+        write_patched(storage, "data/sparse", "bad/offsets", kSparseOuterOffset + sizeof(int64_t), int64_t(6));
+        expect_load_error(storage, "bad/offsets", "Corrupt sparse dataset offsets");
+        // Rows 0 and 1 would swap their ends
+        write_patched(storage, "data/sparse", "bad/descending", kSparseOuterOffset + 2 * sizeof(int64_t), int64_t(1));
+        expect_load_error(storage, "bad/descending", "Corrupt sparse dataset offsets");
+        write_patched(storage, "data/sparse", "bad/column", inner_offset, int32_t(5));
+        expect_load_error(storage, "bad/column", "Corrupt sparse dataset column indices");
+        write_patched(storage, "data/sparse", "bad/negative", inner_offset, int32_t(-1));
+        expect_load_error(storage, "bad/negative", "Corrupt sparse dataset column indices");
+        // Row 0 holds columns 0 and 2; a repeated column is not valid CSR
+        write_patched(storage, "data/sparse", "bad/duplicate", inner_offset + sizeof(int32_t), int32_t(0));
+        expect_load_error(storage, "bad/duplicate", "Corrupt sparse dataset column indices");
+
+        std::vector<char> data;
+        TestSuite::assert_true(storage.read_file("data/sparse", data), storage.get_last_error());
+        data.pop_back();
+        TestSuite::assert_true(storage.create_file("bad/truncated", data), storage.get_last_error());
+        expect_load_error(storage, "bad/truncated", "Truncated sparse dataset");
+    });
+
+    // A dense header whose rows * cols overflows must not wrap into a small size
+    suite.add_test("dense_dataset_rejects_oversized_header", []() {
+        ScratchDirectory scratch("dense_corrupt");
+        auto storage = std::make_shared<storage::HadoopStorage>();
+        TestSuite::assert_true(storage->connect(), "connect failed");
+        const Matrix X = random_matrix(8, 4, 3);
+        const Vector y = Vector::Zero(8);
+        TestSuite::assert_true(storage->save_dataset_binary("data/dense", X, y), storage->get_last_error());
+        // 2^62 rows of 4 float64 columns wraps to 0 bytes in 64 bits
+        write_patched(*storage, "data/dense", "bad/dense", kRowsOffset, uint64_t(1) << 62);
+
+        Matrix features;
+        Vector labels;
+        TestSuite::assert_true(!storage->load_dataset("bad/dense", features, labels), "dense load accepted it");
+        TestSuite::assert_true(storage->get_last_error() == "Truncated binary dataset", storage->get_last_error());
+        expect_load_error(*storage, "bad/dense", "Truncated binary dataset");
+
+        storage::DatasetStream stream(storage, {"data/dense", "bad/dense"});
+        TestSuite::assert_true(stream.next_batch(16, features, labels) && features.rows() == 8, "first file");
+        TestSuite::assert_true(!stream.next_batch(16, features, labels) && stream.failed(), "streamed it");
+    });
+
+    suite.add_test("read_file_range_reports_errors", []() {
+        ScratchDirectory scratch("range");
+        storage::HadoopStorage storage;
+        TestSuite::assert_true(storage.connect(), "connect failed");
+        TestSuite::assert_true(storage.create_file("data/small", std::string("0123456789")), "create failed");
+        std::vector<char> data;
+        TestSuite::assert_true(storage.read_file_range("data/small", 2, 3, data), storage.get_last_error());
+        TestSuite::assert_true(std::string(data.begin(), data.end()) == "234", "range contents");
+        TestSuite::assert_true(!storage.read_file_range("data/small", 8, 3, data), "read past the end");
+        TestSuite::assert_true(storage.get_last_error() == "Short read from data/small", storage.get_last_error());
+        TestSuite::assert_true(!storage.read_file_range("data/missing", 0, 1, data), "read a missing file");
+        TestSuite::assert_true(storage.get_last_error() == "File not found: data/missing", storage.get_last_error());
+    });
+
+    return run_tests(suite);
+}
@@ -0,0 +1,152 @@
+#include "test_common.h"
+#include "algorithms/advanced_algorithms.h"
+#include <vector>
+
+using namespace dds;
+using namespace dds::algorithms;
+using namespace dds::test;
+using testing::TestSuite;
+
+namespace {
+
+constexpr int kDepth = 3;
+constexpr double kRate = 0.2;
+
+// Smooth target with an interaction and noise, so boosting keeps finding splits
+void make_regression(Index rows, uint64_t seed, Matrix& X, Vector& y) {
+    X = random_matrix(rows, 5, seed);
+    const Matrix noise = random_matrix(rows, 1, seed + 1);
+    y = Vector(rows);
+    for (Index i = 0; i < rows; ++i) {
+        y[i] = static_cast<Scalar>(2.0 * X(i, 0) - X(i, 1) * X(i, 2) + 0.5 * std::sin(3.0 * X(i, 3)) +
+                                   0.1 * noise(i, 0));
+    }
+}
+
+// predictions += rate * tree(X), in the same arithmetic as the running cache
+void add_tree(const DecisionTree& tree, const Matrix& X, Vector& predictions) {
+    for (Index i = 0; i < X.rows(); ++i) {
+        predictions[i] += static_cast<Scalar>(kRate * tree.predict_row(X.data() + i * X.cols()));
+    }
+}
+
+double mse(const Vector& y, const Vector& predictions) {
+    double total = 0.0;
+    for (Index i = 0; i < y.size(); ++i) total += (y[i] - predictions[i]) * (y[i] - predictions[i]);
+    return total / static_cast<double>(y.size());
+}
+
+double max_abs_diff(const Vector& a, const Vector& b) {
+    if (a.size() != b.size()) return INFINITY;
+    double worst = 0.0;
+    for (Index i = 0; i < a.size(); ++i) worst = std::max(worst, std::abs(static_cast<double>(a[i]) - b[i]));
+    return worst;
+}
+
+// Rebuilds the ensemble round by round from full predictions through every tree so
+// far: each tree must be the one fitted to those residuals (so the training cache
+// never drifted), and each validation score the MSE of the full validation predictions
+void check_against_repredict(const GradientBoosting& model, const Matrix& X, const Vector& y, const Matrix& X_val,
+                             const Vector& y_val) {
+    const Scalar base = static_cast<Scalar>(model.base_prediction());
+    Vector predictions(X.rows());
+    Vector validation(X_val.rows());
+    std::fill_n(predictions.data(), predictions.size(), base);
+    std::fill_n(validation.data(), validation.size(), base);
+    const auto& scores = model.validation_scores();
+    for (size_t k = 0; k < model.tree_count(); ++k) {
+        Vector residuals(y.size());
+        for (Index i = 0; i < y.size(); ++i) residuals[i] = y[i] - predictions[i];
+        DecisionTree refit(kDepth);
+        refit.fit(X, residuals);
+        const DecisionTree& tree = model.get_tree(k);
+        expect_below(max_abs_diff(tree.predict(X), refit.predict(X)), 0.0, "tree " + std::to_string(k));
+        add_tree(tree, X, predictions);
+        add_tree(tree, X_val, validation);
+        expect_near(mse(y_val, validation), scores[k], tolerance(1e-12, 1e-5) * scores[k],
+                    "validation score " + std::to_string(k));
+    }
+}
+
+} // namespace
+
+int main() {
+    TestSuite suite("trees");
+
+    suite.add_test("boosting_cache_matches_repredict", []() {
+        Matrix X, X_val;
+        Vector y, y_val;
+        make_regression(400, 1, X, y);
+        make_regression(150, 3, X_val, y_val);
+        GradientBoosting model(25, kRate, kDepth);
+        model.fit(X, y, X_val, y_val);
+        TestSuite::assert_true(model.tree_count() == 25 && model.validation_scores().size() == 25, "rounds");
+        check_against_repredict(model, X, y, X_val, y_val);
+
+        Vector expected(X_val.rows());
+        std::fill_n(expected.data(), expected.size(), static_cast<Scalar>(model.base_prediction()));
+        for (size_t k = 0; k < model.tree_count(); ++k) add_tree(model.get_tree(k), X_val, expected);
+        expect_below(max_abs_diff(model.predict(X_val), expected), tolerance(1e-12, 1e-5), "predict");
+    });
+
+    // With a row list only those rows are cached and trained on
+    suite.add_test("boosting_row_subset_cache", []() {
+        Matrix X, X_val;
+        Vector y, y_val;
+        make_regression(400, 5, X, y);
+        make_regression(150, 7, X_val, y_val);
+        std::vector<int> rows;
+        for (int i = 0; i < 400; ++i) {
+            if (i % 3 != 0) rows.push_back(i);
+        }
+        GradientBoosting model(20, kRate, kDepth);
+        model.fit(X, y, rows);
+        // fit(rows) records no validation scores; score the same rows refitted here
+        GradientBoosting scored(20, kRate, kDepth);
+        Matrix X_rows(static_cast<Index>(rows.size()), X.cols());
+        Vector y_rows(static_cast<Index>(rows.size()));
+        for (size_t i = 0; i < rows.size(); ++i) {
+            for (Index j = 0; j < X.cols(); ++j) X_rows(static_cast<Index>(i), j) = X(rows[i], j);
+            y_rows[static_cast<Index>(i)] = y[rows[i]];
+        }
+        scored.fit(X_rows, y_rows, X_val, y_val);
+        // The base mean is summed in another order, so not bit for bit
+        expect_below(max_abs_diff(model.predict(X_val), scored.predict(X_val)), tolerance(1e-12, 1e-5),
+                     "row list vs gathered rows");
+        check_against_repredict(scored, X_rows, y_rows, X_val, y_val);
+
+        // And the row-list model itself against residuals on its rows only
+        Vector predictions(X.rows());
+        std::fill_n(predictions.data(), predictions.size(), static_cast<Scalar>(model.base_prediction()));
+        for (size_t k = 0; k < model.tree_count(); ++k) {
+            Vector residuals(y.size());
+            for (Index i = 0; i < y.size(); ++i) residuals[i] = y[i] - predictions[i];
+            DecisionTree refit(kDepth);
+            refit.fit(X, residuals, rows);
+            expect_below(max_abs_diff(model.get_tree(k).predict(X), refit.predict(X)), 0.0,
+                         "row-list tree " + std::to_string(k));
+            add_tree(model.get_tree(k), X, predictions);
+        }
+    });
+
+    // Early stopping keeps the trees up to the best validation score and no more
+    suite.add_test("boosting_early_stopping_keeps_best", []() {
+        Matrix X, X_val;
+        Vector y, y_val;
+        make_regression(120, 9, X, y);
+        make_regression(120, 11, X_val, y_val);
+        GradientBoosting model(300, 0.5, 6);
+        model.set_early_stopping(5);
+        model.fit(X, y, X_val, y_val);
+        const auto& scores = model.validation_scores();
+        TestSuite::assert_true(scores.size() < 300, "deep trees at rate 0.5 should overfit and stop early");
+        const size_t best = static_cast<size_t>(std::min_element(scores.begin(), scores.end()) - scores.begin());
+        TestSuite::assert_true(model.tree_count() == best + 1, "kept " + std::to_string(model.tree_count()) +
+                                                                   " trees, best round " + std::to_string(best + 1));
+        TestSuite::assert_true(scores.size() == best + 1 + 5, "stopped after " + std::to_string(scores.size()));
+        expect_near(scores[best], mse(y_val, model.predict(X_val)), tolerance(1e-12, 1e-5) * scores[best],
+                    "kept model's validation MSE");
+    });
+
+    return run_tests(suite);
+}
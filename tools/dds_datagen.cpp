@@ -0,0 +1,72 @@
+// dds_datagen - write synthetic datasets at scale through HadoopStorage
+//
+//   dds_datagen --kind=blobs --rows=10000000 --features=64 --output=datagen/blobs
+//
+// Options: --kind=regression|classification|blobs|sparse_categorical --rows= --features=
+//          --rows-per-shard= --threads= --seed= --output= --text --noise= --classes=
+//          --centers= --cluster-std= --outliers= --cardinality= --zipf=
+
+#include "datagen/data_generator.h"
+#include <iostream>
+#include <string>
+#include <memory>
+
+using namespace dds;
+
+int main(int argc, char** argv) {
+    datagen::DataGenConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+
+        try {
+            if (key == "--kind") {
+                if (!datagen::DataGenerator::kind_from_string(value, config.kind)) {
+                    std::cout << "❌ Unknown dataset kind: " << value << std::endl;
+                    return 2;
+                }
+            } else if (key == "--rows") {
+                config.rows = std::stoull(value);
+            } else if (key == "--features") {
+                config.features = std::stoull(value);
+            } else if (key == "--rows-per-shard") {
+                config.rows_per_shard = std::stoull(value);
+            } else if (key == "--threads") {
+                config.threads = std::stoull(value);
+            } else if (key == "--seed") {
+                config.seed = std::stoull(value);
+            } else if (key == "--output") {
+                config.output_path = value;
+            } else if (key == "--text") {
+                config.binary = false;
+            } else if (key == "--noise") {
+                config.noise = std::stod(value);
+            } else if (key == "--classes") {
+                config.num_classes = std::stoi(value);
+            } else if (key == "--centers") {
+                config.num_centers = std::stoi(value);
+            } else if (key == "--cluster-std") {
+                config.cluster_std = std::stod(value);
+            } else if (key == "--outliers") {
+                config.outlier_fraction = std::stod(value);
+            } else if (key == "--cardinality") {
+                config.cardinality = std::stoull(value);
+            } else if (key == "--zipf") {
+                config.zipf_exponent = std::stod(value);
+            } else {
+                std::cout << "❌ Unknown option: " << arg << std::endl;
+                return 2;
+            }
+        } catch (const std::exception&) {
+            std::cout << "❌ Invalid value for " << key << ": " << value << std::endl;
+            return 2;
+        }
+    }
+
+    auto storage = std::make_shared<storage::HadoopStorage>();
+    datagen::DataGenerator generator(storage, config);
+    return generator.generate() ? 0 : 1;
+}
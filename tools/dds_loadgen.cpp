@@ -0,0 +1,114 @@
+// dds_loadgen - open-loop HTTP load generator for WebServer endpoints
+//
+//   dds_loadgen --port=8080 --rps=2000 --duration=30 --target=GET:/api/health
+//               --target=POST:/api/jobs:3 --body='{"type":"kmeans"}'
+//
+// Options: --host= --port= --rps= --duration= --warmup= --connections= --timeout-ms=
+//          --uniform --seed= --target=METHOD:PATH[:WEIGHT] (repeatable) --body=
+//          --header=Name:Value --json=FILE
+
+#include "loadtest/http_load_generator.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+
+using namespace dds;
+
+namespace {
+
+bool parse_target(const std::string& spec, loadtest::LoadTarget& target) {
+    size_t first = spec.find(':');
+    if (first == std::string::npos) return false;
+    target.method = spec.substr(0, first);
+    std::string rest = spec.substr(first + 1);
+    size_t last = rest.rfind(':');
+    if (last != std::string::npos && last > 0 && rest.find_first_not_of("0123456789.", last + 1) == std::string::npos) {
+        target.weight = std::stod(rest.substr(last + 1));
+        rest = rest.substr(0, last);
+    }
+    target.path = rest.empty() ? "/" : rest;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    loadtest::LoadTestConfig config;
+    std::string body;
+    std::map<std::string, std::string> headers;
+    std::string json_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+
+        try {
+            if (key == "--host") {
+                config.host = value;
+            } else if (key == "--port") {
+                config.port = std::stoi(value);
+            } else if (key == "--rps") {
+                config.requests_per_second = std::stod(value);
+            } else if (key == "--duration") {
+                config.duration = std::chrono::seconds(std::stoll(value));
+            } else if (key == "--warmup") {
+                config.warmup = std::chrono::seconds(std::stoll(value));
+            } else if (key == "--connections") {
+                config.connections = std::stoull(value);
+            } else if (key == "--timeout-ms") {
+                config.timeout = std::chrono::milliseconds(std::stoll(value));
+            } else if (key == "--uniform") {
+                config.poisson_arrivals = false;
+            } else if (key == "--seed") {
+                config.seed = std::stoull(value);
+            } else if (key == "--target") {
+                loadtest::LoadTarget target;
+                if (!parse_target(value, target)) {
+                    std::cout << "❌ Target must be METHOD:PATH[:WEIGHT]: " << value << std::endl;
+                    return 2;
+                }
+                config.targets.push_back(target);
+            } else if (key == "--body") {
+                body = value;
+            } else if (key == "--header") {
+                size_t colon = value.find(':');
+                if (colon == std::string::npos) {
+                    std::cout << "❌ Header must be Name:Value: " << value << std::endl;
+                    return 2;
+                }
+                headers[value.substr(0, colon)] = value.substr(colon + 1);
+            } else if (key == "--json") {
+                json_path = value;
+            } else {
+                std::cout << "❌ Unknown option: " << arg << std::endl;
+                return 2;
+            }
+        } catch (const std::exception&) {
+            std::cout << "❌ Invalid value for " << key << ": " << value << std::endl;
+            return 2;
+        }
+    }
+
+    // Body and headers apply to every target that sends one
+    if (config.targets.empty()) config.targets.push_back(loadtest::LoadTarget());
+    for (auto& target : config.targets) {
+        target.headers.insert(headers.begin(), headers.end());
+        if (target.method == "POST" || target.method == "PUT") target.body = body;
+    }
+
+    loadtest::HttpLoadGenerator generator(config);
+    loadtest::LoadTestReport report = generator.run();
+    report.print();
+
+    if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        if (!out) {
+            std::cout << "❌ Cannot write " << json_path << std::endl;
+            return 1;
+        }
+        out << report.to_json();
+    }
+    return report.completed > 0 ? 0 : 1;
+}